@@ -45,6 +45,11 @@
   * @brief Constant declaring total blocks in DB file (for the given DB_FILE size)
  */
 #define DB_FILE_BLOCKS_NUM (1024 * 1024 * DB_FILE_SIZE / sizeof(AK_block))
+/**
+  * @def SPARSE_DB_FILE
+  * @brief Constant declaring whether new blocks are left as holes of a sparse DB file until they are first written (1) or written out when the DB file grows (0)
+ */
+#define SPARSE_DB_FILE (iniparser_getint(AK_config,"general:sparse_db_file",1))
 /**
   * @def INITIAL_EXTENT_SIZE
   * @brief Constant declaring initial extent size in blocks
@@ -75,6 +80,31 @@
  * @brief Constant declaring the path of archivelog folder
 */
 #define ARCHIVELOG_PATH (iniparser_getstring(AK_config, "redolog:archivelog_folder", "./archivelog"))
+/**
+  * @def CACHE_MEMORY_BLOCKS
+  * @brief Constant declaring the number of blocks kept in the DB cache (buffer pool)
+ */
+#define CACHE_MEMORY_BLOCKS (iniparser_getint(AK_config,"cache:max_cache_memory",MAX_CACHE_MEMORY))
+/**
+ * @def HASH_JOIN_MEMORY
+ * @brief Constant declaring the memory budget in KB for the build side of a hash join, larger inputs are partitioned into temp segments
+ */
+#define HASH_JOIN_MEMORY (iniparser_getint(AK_config,"join:hash_join_memory",4096))
+/**
+ * @def SORT_MEMORY
+ * @brief Constant declaring the memory budget in KB for the sorted runs of an external merge sort
+ */
+#define SORT_MEMORY (iniparser_getint(AK_config,"sort:sort_memory",4096))
+/**
+ * @def HASH_AGGREGATION_MEMORY
+ * @brief Constant declaring the memory budget in KB for the groups of a hash aggregation, rows of other groups are spilled into temp segments
+ */
+#define HASH_AGGREGATION_MEMORY (iniparser_getint(AK_config,"aggregation:hash_aggregation_memory",4096))
+/**
+ * @def HASH_SET_MEMORY
+ * @brief Constant declaring the memory budget in KB for the rows of a hash based UNION, INTERSECT or EXCEPT, larger inputs are partitioned into temp segments
+ */
+#define HASH_SET_MEMORY (iniparser_getint(AK_config,"set:hash_set_memory",4096))
 /**
  * @def MAX_REDO_LOG_MEMORY
  * @brief The maximum size of REDO log memory
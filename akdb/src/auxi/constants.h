@@ -78,7 +78,7 @@
 #define MAX_QUERY_LIB_MEMORY 255
 /**
   * @def MAX_CACHE_MEMORY
-  * @brief Constant declaring the maximum size of DB cache memory
+  * @brief Constant declaring the default size of DB cache memory (in blocks), see CACHE_MEMORY_BLOCKS
  */
 #define MAX_CACHE_MEMORY 255
 /**
@@ -97,21 +97,6 @@
  * @brief Constant declaring the maximum number of attributes to handle in relation equivalence function
  */
 #define MAX_TOKENS 255
-/**
- * @def MAX_MAIN_BUCKETS
- * @brief Constant declaring the maximum number of main buckets
-*/
-#define MAX_MAIN_BUCKETS 512
-/**
- * @def MAIN_BUCKET_SIZE
- * @brief Constant declaring the size of main buckets
-*/
-#define MAIN_BUCKET_SIZE 4
-/**
- * @def HASH_BUCKET_SIZE
- * @brief Constant declaring the size of hash buckets
-*/
-#define HASH_BUCKET_SIZE 4
 /**
  * @def NUMBER_OF_KEYS
  * @brief Constant declaring the number of buckets in hash table
@@ -327,26 +312,16 @@
  * @brief Constant indicating 'select' operation
  */
 #define SELECT 3
+/**
+ * @def BULK_INSERT
+ * @brief Constant indicating a block of rows written by a bulk load
+ */
+#define BULK_INSERT 4
 /**
  * @def FIND
  * @brief Constant indicating that the operation to be performed is 'search'
  */
 #define FIND 2
-/**
- * @def INFO_BUCKET
- * @brief Constant declaring the type of bucket as "info bucket" when inserting bucket to block
-*/
-#define INFO_BUCKET 0
-/**
- * @def MAIN_BUCKET
- * @brief Constant declaring the type of bucket as "main bucket" when inserting bucket to block
-*/
-#define MAIN_BUCKET 1
-/**
- * @def HASH_BUCKET
- * @brief Constant declaring the type of bucket as "hash bucket" when inserting bucket to block
-*/
-#define HASH_BUCKET 2
 /**
  * @def SHARED_LOCK
  * @brief Constant declaring the type of lock as SHARED LOCK
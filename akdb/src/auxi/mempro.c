@@ -163,7 +163,8 @@ void AK_debmod_sample_state(AK_debmod_state* ds) {
 /**
 * @author Marin Rukavina, Mislav Bozicevic
 * @param ds debug mode state
-* @brief Reserves ds for use [private function]
+* @brief Reserves ds for use [private function]. The calling thread holds the critical
+*        section until AK_debmod_leave_critical_sec, other threads block instead of spinning.
 * @return void
 */
 void AK_debmod_enter_critical_sec(AK_debmod_state* ds){
@@ -174,14 +175,7 @@ void AK_debmod_enter_critical_sec(AK_debmod_state* ds){
 #ifdef __linux__
     pthread_mutex_lock(&AK_debmod_critical_section);
 #endif
-    while (ds->ready != 1); /* wait loop */
     ds->ready = 0;
-#ifdef _WIN32
-    LeaveCriticalSection(&ds->critical_section);
-#endif
-#ifdef __linux__
-    pthread_mutex_unlock(&AK_debmod_critical_section);
-#endif
 }
 
 /**
@@ -192,6 +186,12 @@ void AK_debmod_enter_critical_sec(AK_debmod_state* ds){
 */
 void AK_debmod_leave_critical_sec(AK_debmod_state* ds){
     ds->ready = 1; /* AK_DEBMOD_STATE can be used again */
+#ifdef _WIN32
+    LeaveCriticalSection(&ds->critical_section);
+#endif
+#ifdef __linux__
+    pthread_mutex_unlock(&AK_debmod_critical_section);
+#endif
 }
 
 /**
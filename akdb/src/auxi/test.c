@@ -42,3 +42,13 @@ void TEST_output_results(TestResult result) {
 	printf( RED "TEST: %i of %i tests FAILED.\n" RESET , result.testFailed, result.testFailed + result.testSucceded);
 }
 
+
+/**
+ * @brief Returns a monotonic timestamp in milliseconds, used by benchmarks to time their phases.
+ * @return current time in milliseconds
+ */
+double TEST_time_ms() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
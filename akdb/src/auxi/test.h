@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <time.h>
 
 /**
 * This structure is used so tests can report the amount of successful tests.
@@ -56,4 +57,10 @@ TestResult TEST_result(int successfulAmount, int failedAmount);
  */
 void TEST_output_results(TestResult result);
 
+/**
+ * @brief Returns a monotonic timestamp in milliseconds, used by benchmarks to time their phases.
+ * @return current time in milliseconds
+ */
+double TEST_time_ms();
+
 #endif
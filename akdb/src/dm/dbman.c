@@ -24,8 +24,30 @@
 //      solution is to (#define false 0) and (#define true !false) in this header, or even better in the constants
 //      header
 #include "dbman.h"
+#include "page.h"
+#include "../mm/memoman.h"
 pthread_mutex_t fileLockMutex = PTHREAD_MUTEX_INITIALIZER;
 
+/**
+ * @var AK_db_fd
+ * @brief Descriptor of the DB file shared by all block reads and writes, -1 while the file is closed.
+ * Blocks are transferred with pread/pwrite, so threads never share a file position.
+ */
+static int AK_db_fd = -1;
+
+/**
+ * @var AK_allocationbit_disk
+ * @brief Copy of the allocation table as it was last written to the DB file. AK_blocktable_flush writes only the
+ * pages that differ from it.
+ */
+static AK_blocktable *AK_allocationbit_disk = NULL;
+
+/**
+ * @var AK_blocktable_batch
+ * @brief Depth of AK_blocktable_batch_begin calls, flushes are deferred while it is not 0
+ */
+static int AK_blocktable_batch = 0;
+
 
 /**
 * @author Markus Schatten
@@ -59,7 +81,7 @@ AK_init_db_file(int size)
     printf("AK_init_db_file: size db file %d. --- %d ---- %d\n", sizeOfFile, AK_ALLOCATION_TABLE_SIZE, AK_allocationbit->last_initialized);
     
     
-    if (sizeOfFile > AK_ALLOCATION_TABLE_SIZE)
+    if (sizeOfFile > AK_PAGES_OFFSET)
       {
         printf("AK_init_db_file: Already initialized.\n");
         fclose(db);
@@ -68,9 +90,12 @@ AK_init_db_file(int size)
         return (EXIT_SUCCESS);
       }
 
-    printf("AK_init_db_file: Initializing DB file..."
-	   "\nPlease be patient, this can take several minutes depending "
-	   "on disk performance.\n");
+    if (SPARSE_DB_FILE)
+      printf("AK_init_db_file: Initializing sparse DB file...\n");
+    else
+      printf("AK_init_db_file: Initializing DB file..."
+	     "\nPlease be patient, this can take several minutes depending "
+	     "on disk performance.\n");
 
     if(AK_allocate_blocks(db, AK_init_block(), 0, MAX_BLOCK_INIT_NUM) != EXIT_SUCCESS)
       {
@@ -90,6 +115,304 @@ AK_init_db_file(int size)
 }
 
 
+/**
+ * @var AK_free_runs
+ * @brief Free-run summary tree of the bit-table. Node 1 is the root, the children of node i are 2i and 2i + 1 and
+ * every leaf describes one word of AK_ALLOCATION_WORD_BITS blocks.
+ */
+static AK_free_run AK_free_runs[4 * AK_ALLOCATION_WORDS];
+
+/**
+ * @var AK_free_runs_leaves
+ * @brief Number of leaves of AK_free_runs, a power of two
+ */
+static int AK_free_runs_leaves = 0;
+
+/**
+ * @var AK_free_runs_limit
+ * @brief last_initialized of the allocation table AK_free_runs was built for, -1 if it has to be built again
+ */
+static int AK_free_runs_limit = -1;
+
+/**
+ * @brief  Function that returns a word of the bit-table with a bit set for every free initialized block
+ * @param word index of the word
+ * @return free blocks of the word
+ */
+static unsigned long long
+AK_free_word(int word)
+{
+  unsigned long long free_bits = 0;
+  int first = word * AK_ALLOCATION_WORD_BITS, slot = BITSLOT(first), i;
+  int limit = AK_allocationbit->last_initialized;
+
+  if (limit > DB_FILE_BLOCKS_NUM_EX)
+    limit = DB_FILE_BLOCKS_NUM_EX;
+  if (first >= limit)
+    return 0;
+
+  for (i = 0; i < AK_ALLOCATION_WORD_BITS / CHAR_BIT && slot + i < BITNSLOTS(DB_FILE_BLOCKS_NUM_EX); i++)
+    free_bits |= (unsigned long long) AK_allocationbit->bittable[slot + i] << (i * CHAR_BIT);
+  free_bits = ~free_bits;
+
+  if (limit - first < AK_ALLOCATION_WORD_BITS)
+    free_bits &= (1ULL << (limit - first)) - 1;
+  return free_bits;
+}
+
+/**
+ * @brief  Function that describes the free runs of one word of the bit-table
+ * @param *run leaf of the free-run summary tree
+ * @param free_bits free blocks of the word
+ */
+static void
+AK_free_run_leaf(AK_free_run *run, unsigned long long free_bits)
+{
+  unsigned long long bits = free_bits;
+
+  run->length = AK_ALLOCATION_WORD_BITS;
+  run->free = __builtin_popcountll(free_bits);
+  run->prefix = ~free_bits ? __builtin_ctzll(~free_bits) : AK_ALLOCATION_WORD_BITS;
+  run->suffix = ~free_bits ? __builtin_clzll(~free_bits) : AK_ALLOCATION_WORD_BITS;
+  for (run->longest = 0; bits; run->longest++)
+    bits &= bits << 1;
+}
+
+/**
+ * @brief  Function that describes the free runs of a node of the free-run summary tree from its children
+ * @param node index of the node
+ */
+static void
+AK_free_run_join(int node)
+{
+  AK_free_run *run = &AK_free_runs[node], *left = &AK_free_runs[2 * node], *right = &AK_free_runs[2 * node + 1];
+
+  run->length = left->length + right->length;
+  run->free = left->free + right->free;
+  run->prefix = left->prefix == left->length ? left->length + right->prefix : left->prefix;
+  run->suffix = right->suffix == right->length ? right->length + left->suffix : right->suffix;
+  run->longest = left->suffix + right->prefix;
+  if (left->longest > run->longest)
+    run->longest = left->longest;
+  if (right->longest > run->longest)
+    run->longest = right->longest;
+}
+
+/**
+ * @brief  Function that builds the free-run summary tree if the bit-table was read or grew since it was built
+ */
+static void
+AK_free_runs_prepare()
+{
+  int i, words, limit = AK_allocationbit->last_initialized;
+
+  if (AK_free_runs_limit == limit)
+    return;
+
+  if (limit > DB_FILE_BLOCKS_NUM_EX)
+    limit = DB_FILE_BLOCKS_NUM_EX;
+  words = (limit + AK_ALLOCATION_WORD_BITS - 1) / AK_ALLOCATION_WORD_BITS;
+  for (AK_free_runs_leaves = 1; AK_free_runs_leaves < words; AK_free_runs_leaves *= 2)
+    ;
+
+  for (i = 0; i < AK_free_runs_leaves; i++)
+    AK_free_run_leaf(&AK_free_runs[AK_free_runs_leaves + i], AK_free_word(i));
+  for (i = AK_free_runs_leaves - 1; i > 0; i--)
+    AK_free_run_join(i);
+
+  AK_free_runs_limit = AK_allocationbit->last_initialized;
+}
+
+/**
+ * @brief  Function that marks a block as used or free in the bit-table and in the free-run summary tree
+ * @param address address of the block
+ * @param used 1 if the block is used, 0 if it is free
+ */
+static void
+AK_blocktable_mark(int address, int used)
+{
+  int node;
+
+  if (used)
+    BITSET(AK_allocationbit->bittable, address);
+  else
+    BITCLEAR(AK_allocationbit->bittable, address);
+
+  if (AK_free_runs_limit != AK_allocationbit->last_initialized
+      || address < 0 || address / AK_ALLOCATION_WORD_BITS >= AK_free_runs_leaves)
+    return;
+
+  node = AK_free_runs_leaves + address / AK_ALLOCATION_WORD_BITS;
+  AK_free_run_leaf(&AK_free_runs[node], AK_free_word(address / AK_ALLOCATION_WORD_BITS));
+  for (node /= 2; node > 0; node /= 2)
+    AK_free_run_join(node);
+}
+
+/**
+ * @brief  Function that looks for a run of free blocks inside one word of the bit-table
+ * @param free_bits free blocks of the word
+ * @param start address of the first block of the word
+ * @param from address of the first block the run may start at
+ * @param num length of the run
+ * @param *run length of the free run that ends right before the word, updated to the one that ends with it
+ * @return address of the first block of the run, FREE_INT if it does not end in this word
+ */
+static int
+AK_free_word_find(unsigned long long free_bits, int start, int from, int num, int *run)
+{
+  unsigned long long shifted;
+  int bit = 0, skip, length;
+
+  if (from > start)
+    free_bits &= ~0ULL << (from - start);
+
+  while (bit < AK_ALLOCATION_WORD_BITS)
+    {
+      shifted = free_bits >> bit;
+      if (!shifted)
+	{
+	  *run = 0;
+	  return FREE_INT;
+	}
+      skip = __builtin_ctzll(shifted);
+      if (skip)
+	{
+	  *run = 0;
+	  bit += skip;
+	  shifted >>= skip;
+	}
+      length = ~shifted ? __builtin_ctzll(~shifted) : AK_ALLOCATION_WORD_BITS;
+      if (length > AK_ALLOCATION_WORD_BITS - bit)
+	length = AK_ALLOCATION_WORD_BITS - bit;
+      if (*run + length >= num)
+	return start + bit - *run;
+      *run += length;
+      bit += length;
+    }
+  return FREE_INT;
+}
+
+/**
+ * @brief  Function that finds the first run of free blocks in a subtree of the free-run summary tree. Subtrees
+ * whose runs are all too short are skipped, leaves are searched a word at a time.
+ * @param node index of the node
+ * @param start address of the first block of the node
+ * @param from address of the first block the run may start at
+ * @param num length of the run
+ * @param *run length of the free run that ends right before the node, updated to the one that ends with it
+ * @return address of the first block of the run, FREE_INT if it does not end in this subtree
+ */
+static int
+AK_free_runs_find(int node, int start, int from, int num, int *run)
+{
+  AK_free_run *range = &AK_free_runs[node];
+  int found;
+
+  if (start + range->length <= from)
+    return FREE_INT;
+
+  if (start >= from)
+    {
+      if (*run + range->prefix >= num)
+	return start - *run;
+      if (range->longest < num)
+	{
+	  *run = range->prefix == range->length ? *run + range->length : range->suffix;
+	  return FREE_INT;
+	}
+    }
+
+  if (node >= AK_free_runs_leaves)
+    return AK_free_word_find(AK_free_word(node - AK_free_runs_leaves), start, from, num, run);
+
+  found = AK_free_runs_find(2 * node, start, from, num, run);
+  if (found != FREE_INT)
+    return found;
+  return AK_free_runs_find(2 * node + 1, start + range->length / 2, from, num, run);
+}
+
+/**
+ * @brief  Function that finds the first run of free blocks for allocationSEQUENCE
+ * @param fromWhere 0 to search from the start of the table, otherwise the run has to start at or after the
+ * last allocated block, which has to be free
+ * @param numRequestedBlocks length of the run
+ * @return address of the first block of the run, FREE_INT if there is none
+ */
+static int
+AK_allocation_sequence(int fromWhere, int numRequestedBlocks)
+{
+  int from = 0, run = 0;
+
+  if (fromWhere)
+    {
+      from = AK_allocationbit->last_allocated;
+      if (from < 0 || numRequestedBlocks > (AK_allocationbit->last_initialized - from)
+	  || BITTEST(AK_allocationbit->bittable, from))
+	return FREE_INT;
+    }
+
+  AK_free_runs_prepare();
+  if (AK_free_runs[1].longest < numRequestedBlocks)
+    return FREE_INT;
+  return AK_free_runs_find(1, 0, from, numRequestedBlocks, &run);
+}
+
+/**
+ * @brief  Function that finds the first free initialized block at or after an address
+ * @param address address to start from
+ * @return address of the free block, FREE_INT if there is none
+ */
+static int
+AK_next_free_block(int address)
+{
+  unsigned long long free_bits;
+  int word, limit = AK_allocationbit->last_initialized;
+
+  if (address < 0)
+    address = 0;
+  if (limit > DB_FILE_BLOCKS_NUM_EX)
+    limit = DB_FILE_BLOCKS_NUM_EX;
+
+  for (word = address / AK_ALLOCATION_WORD_BITS; word * AK_ALLOCATION_WORD_BITS < limit; word++)
+    {
+      free_bits = AK_free_word(word);
+      if (word == address / AK_ALLOCATION_WORD_BITS)
+	free_bits &= ~0ULL << (address % AK_ALLOCATION_WORD_BITS);
+      if (free_bits)
+	return word * AK_ALLOCATION_WORD_BITS + __builtin_ctzll(free_bits);
+    }
+  return FREE_INT;
+}
+
+/**
+ * @brief  Function that finds the last free initialized block at or before an address
+ * @param address address to start from
+ * @return address of the free block, FREE_INT if there is none
+ */
+static int
+AK_prev_free_block(int address)
+{
+  unsigned long long free_bits;
+  int word;
+
+  if (address >= AK_allocationbit->last_initialized)
+    address = AK_allocationbit->last_initialized - 1;
+  if (address >= DB_FILE_BLOCKS_NUM_EX)
+    address = DB_FILE_BLOCKS_NUM_EX - 1;
+  if (address < 0)
+    return FREE_INT;
+
+  for (word = address / AK_ALLOCATION_WORD_BITS; word >= 0; word--)
+    {
+      free_bits = AK_free_word(word);
+      if (word == address / AK_ALLOCATION_WORD_BITS && address % AK_ALLOCATION_WORD_BITS != AK_ALLOCATION_WORD_BITS - 1)
+	free_bits &= (1ULL << (address % AK_ALLOCATION_WORD_BITS + 1)) - 1;
+      if (free_bits)
+	return word * AK_ALLOCATION_WORD_BITS + AK_ALLOCATION_WORD_BITS - 1 - __builtin_clzll(free_bits);
+    }
+  return FREE_INT;
+}
+
 /**
  * @author dv
  * @param allocationSet Pointer to array which will be filled and represent the allocation set
@@ -99,226 +422,100 @@ AK_init_db_file(int size)
  * @param mode Defines how to obtain set of indexes to AK_free addresses
  * @param target Has meaning just if mode is AROUND: set will be as close as possible to the requested target address
  * from both sides
- * @brief  Function prepare demanded sets from allocation table
+ * @brief  Function prepare demanded sets from allocation table. Runs of free blocks are found with the free-run
+ * summary tree, the other modes walk the free blocks a word of the bit-table at a time.
  * @return the first element of the allocation set
  */
 int
 AK_get_allocation_set(int* allocationSet, int fromWhere, int gaplength, int numRequestedBlocks, AK_allocation_set_mode mode, int target)
 {
-  register int i = 0, j = 0, k = 0;
-  int num_free_blocks_bitmap = 0,
-      tmp = 0, tmpb = 0;
-  int lastInitilizedBlock = AK_allocationbit->last_initialized;
-  int freeBlocksMap[lastInitilizedBlock];
+  int i, k = 0, block, up, down, last_up, last_down;
   AK_PRO;
 
   if (gaplength < 1)
     gaplength = 1;
- 
+
   for (i = 0; i < numRequestedBlocks; i++)
     allocationSet[i] = FREE_INT;
-  for (i = 0; i < lastInitilizedBlock; i++)
-    freeBlocksMap[i] = FREE_INT;
-  for (i = 0; i < lastInitilizedBlock; i++)
-    if (!BITTEST(AK_allocationbit->bittable, i))
-      freeBlocksMap[num_free_blocks_bitmap++] = i;
 
-  if (num_free_blocks_bitmap < numRequestedBlocks)
+  AK_free_runs_prepare();
+  if (numRequestedBlocks < 1 || AK_free_runs[1].free < numRequestedBlocks)
     {
       AK_EPI;
-      return allocationSet[0];
+      return FREE_INT;
     }
 
   switch (mode)
     {
     case allocationSEQUENCE:
-      if (fromWhere)
-	{
-	  if (numRequestedBlocks > (lastInitilizedBlock - AK_allocationbit->last_allocated))
-	    {
-	      AK_EPI;
-	      return allocationSet[0];
-	    }
-	  for (i = 0; i < num_free_blocks_bitmap; ++i)
-	    {
-	      if (freeBlocksMap[i] == AK_allocationbit->last_allocated)
-		break;
-	    }
-	}
-      else
-	i = 0;
+      block = AK_allocation_sequence(fromWhere, numRequestedBlocks);
+      for (i = 0; block != FREE_INT && i < numRequestedBlocks; i++)
+	allocationSet[k++] = block + i;
+      break;
 
-      int hasEnoughSequentialBlocks = 0; //todo: set this to false; when #define true/false is included
-      int startBlockIndex           = i; //todo: i is too vague, the whole function should use more clear variables.
-      int freeBlockIndex;
-      while( !hasEnoughSequentialBlocks &&
-	     (startBlockIndex < num_free_blocks_bitmap - numRequestedBlocks + 1))
-	{
-	  hasEnoughSequentialBlocks = 1;
-	  for (freeBlockIndex = startBlockIndex; freeBlockIndex < startBlockIndex + numRequestedBlocks; ++freeBlockIndex)
-	    {
-	      if(  (freeBlocksMap[freeBlockIndex] == (freeBlocksMap[freeBlockIndex + 1] - 1)) ||
-		  ((freeBlocksMap[freeBlockIndex] == (freeBlocksMap[freeBlockIndex - 1] + 1))
-		    &&
-		   (freeBlockIndex  == (startBlockIndex + numRequestedBlocks - 1))) )
-		continue;
-	      
-	      hasEnoughSequentialBlocks = 0; //todo: set this to false; when #define true/false is included
-	      startBlockIndex = freeBlockIndex+1;
-	      break;
-	    }
-	}
-      if(hasEnoughSequentialBlocks)
-	{
-	  int setIndex = 0;
-	  for (freeBlockIndex = startBlockIndex; freeBlockIndex < startBlockIndex + numRequestedBlocks; ++freeBlockIndex)
-	    allocationSet[setIndex++] = freeBlocksMap[freeBlockIndex];
-	}
-      
-      AK_EPI;
-      return allocationSet[0];
-	  
     case allocationUPPER:
-      k = 0; j = 0; i = 0;
-      tmp = freeBlocksMap[0];
-
-      while (i < num_free_blocks_bitmap)
+      if (gaplength == 1)
 	{
-	  if (freeBlocksMap[i] != FREE_INT && (gaplength >= abs(freeBlocksMap[i] - tmp)))
-	    {
-	      tmp = freeBlocksMap[i];
-	      allocationSet[k++] = freeBlocksMap[i++];
-	    }
-	  else
-	    i++;
-
-	if (i == (num_free_blocks_bitmap - 1) || k == numRequestedBlocks)
+	  block = AK_allocation_sequence(0, numRequestedBlocks);
+	  for (i = 0; block != FREE_INT && i < numRequestedBlocks; i++)
+	    allocationSet[k++] = block + i;
 	  break;
-
-	if (k && (gaplength < abs(freeBlocksMap[i] - allocationSet[k - 1])))
-	  {
-	    k = 0;
-	    for (j = 0; j < numRequestedBlocks; j++)allocationSet[j] = FREE_INT;
-	    tmp = freeBlocksMap[i];
-	  }
-      }
-      if (numRequestedBlocks != k)
-	{
-	  for (i = 0; i < numRequestedBlocks; i++)
-	    allocationSet[i] = FREE_INT;
-	  
-	  AK_EPI;
-	  return allocationSet[0];
 	}
-      
-      AK_EPI;
-      return allocationSet[0];
-      
-    case allocationLOWER:
-      k = 0; j = 0;
-      i = num_free_blocks_bitmap - 1;
-      if (num_free_blocks_bitmap<numRequestedBlocks)
+      //a gap longer than gaplength starts the set again
+      for (block = AK_next_free_block(0); block != FREE_INT && k < numRequestedBlocks; block = AK_next_free_block(block + 1))
 	{
-	  AK_EPI;
-	  return allocationSet[0];
-	  break;
+	  if (k && block - allocationSet[k - 1] > gaplength)
+	    k = 0;
+	  allocationSet[k++] = block;
 	}
+      break;
 
-      tmp = freeBlocksMap[i];
-
-      while (i >= 0)
+    case allocationLOWER:
+      for (block = AK_prev_free_block(AK_allocationbit->last_initialized - 1); block != FREE_INT && k < numRequestedBlocks;
+	   block = AK_prev_free_block(block - 1))
 	{
-	if (freeBlocksMap[i] != FREE_INT && (gaplength >= abs(freeBlocksMap[i] - tmp)))
-	  {
-	    tmp = freeBlocksMap[i];
-	    allocationSet[k++] = freeBlocksMap[i--];
-	  }
-	else
-	  i--;
-
-	if (i == -1 || k == numRequestedBlocks)
-	  break;
-
-	if (k && (gaplength < abs(freeBlocksMap[i] - allocationSet[k - 1])))
-	  {
+	  if (k && allocationSet[k - 1] - block > gaplength)
 	    k = 0;
-	    for (j = 0; j < numRequestedBlocks; j++)
-	      allocationSet[j] = FREE_INT;
-	    tmp = freeBlocksMap[i];
-	  }
-	}
-      if (numRequestedBlocks != k)
-	{
-	  for (i = 0; i < numRequestedBlocks; i++)
-	    allocationSet[i] = FREE_INT;
-	  AK_EPI;
-	  return allocationSet[0];
+	  allocationSet[k++] = block;
 	}
+      break;
 
-      AK_EPI;
-      return allocationSet[0];
-      
     case allocationAROUND:
+      if (target < 0 || target >= AK_allocationbit->last_initialized || BITTEST(AK_allocationbit->bittable, target))
+	break;
 
-      for (i = 0; i < num_free_blocks_bitmap; i++)
-	if (freeBlocksMap[i] == target)
-	  break;
-      
-      if ((i + 1) == num_free_blocks_bitmap)
-	{
-	  AK_EPI;
-	  return allocationSet[0];
-	}
-      k = 0; j = i - 1;
-      tmp  = freeBlocksMap[i];
-      tmpb = freeBlocksMap[j];
-
-      while (numRequestedBlocks)
+      //take blocks above and below the target in turns until a gap stops both sides
+      allocationSet[k++] = last_up = last_down = target;
+      up = AK_next_free_block(target + 1);
+      down = AK_prev_free_block(target - 1);
+      while (k < numRequestedBlocks && (up != FREE_INT || down != FREE_INT))
 	{
-	if ((i < num_free_blocks_bitmap) && (freeBlocksMap[i] != FREE_INT) && (gaplength >= abs(freeBlocksMap[i] - tmp)))
-	  {
-	    allocationSet[k++] = freeBlocksMap[i];
-	    numRequestedBlocks--;
-	    tmp = freeBlocksMap[i];
-	    i++;
-	  }
-	else
-	  i = num_free_blocks_bitmap;
-
-	if ((j >= 0) && (freeBlocksMap[j] != FREE_INT) && (gaplength >= abs(freeBlocksMap[j] - tmpb)))
-	  {
-	    allocationSet[k++] = freeBlocksMap[j];
-	    numRequestedBlocks--;
-	    tmpb = freeBlocksMap[j];
-	    j--;
-	  }
-	else
-	  j = -1;
-
-	if ((i >= num_free_blocks_bitmap) && j<0 && numRequestedBlocks>0)
-	  {
-	    for (i = 0; i < numRequestedBlocks; i++)
-	      allocationSet[i] = FREE_INT;
-	    AK_EPI;
-	    return allocationSet[0];
-	  }
-      }
+	  if (up != FREE_INT && up - last_up <= gaplength)
+	    {
+	      allocationSet[k++] = last_up = up;
+	      up = AK_next_free_block(up + 1);
+	    }
+	  else
+	    up = FREE_INT;
 
-      if (numRequestedBlocks != 0)
-	{
-	  for (i = 0; i < numRequestedBlocks; i++)
-	    allocationSet[i] = FREE_INT;
-	  AK_EPI;
-	  return allocationSet[0];
+	  if (k < numRequestedBlocks && down != FREE_INT && last_down - down <= gaplength)
+	    {
+	      allocationSet[k++] = last_down = down;
+	      down = AK_prev_free_block(down - 1);
+	    }
+	  else
+	    down = FREE_INT;
 	}
-      
-      AK_EPI;
-      return allocationSet[0];
-      
+      break;
+
     case allocationNOMODE:
       ;
     }
 
+  if (k != numRequestedBlocks)
+    for (i = 0; i < numRequestedBlocks; i++)
+      allocationSet[i] = FREE_INT;
+
   AK_EPI;
   return allocationSet[0];
 }
@@ -405,38 +602,174 @@ AK_blocktable_dump(int verbosity)
 }
 
 /**
- * @author dv
- * @brief  Function flushes bitmask table to the disk
+ * @brief  Function that writes a range of the allocation table to the DB file, through the shared descriptor when it
+ * is open
+ * @param **file DB file opened by an earlier call of the same flush, NULL if none
+ * @param offset offset of the range in the allocation table and in the file
+ * @param length length of the range
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int
+AK_blocktable_write(FILE **file, size_t offset, size_t length)
+{
+  if (AK_db_fd >= 0)
+    return AK_page_transfer(AK_db_fd, 1, (char *) AK_allocationbit + offset, length, (off_t) offset);
+
+  if (*file == NULL && (*file = fopen(DB_FILE, "rb+")) == NULL)
+    {
+      printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
+      return EXIT_ERROR;
+    }
+  if (fseek(*file, offset, SEEK_SET) != 0 || AK_fwrite((char *) AK_allocationbit + offset, length, 1, *file) != 1)
+    return EXIT_ERROR;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @author dv, updated to write only changed pages
+ * @brief  Function flushes bitmask table to the disk. The table is written in pages of AK_ALLOCATION_PAGE_SIZE bytes
+ * and only the pages that changed since the last flush are written, adjacent ones together. Flushes are deferred
+ * between AK_blocktable_batch_begin and AK_blocktable_batch_end.
  * @return EXIT_SUCCESS if the file has been written to the disk, EXIT_ERROR otherwise
  */
 int
 AK_blocktable_flush()
 {
+  FILE *file = NULL;
+  size_t first, last, offset, length;
+  int page, run = -1, all = 0;
   AK_PRO;
-  if ((db = fopen(DB_FILE, "rb+")) == NULL)
+
+  pthread_mutex_lock(&fileLockMutex);
+  if (AK_blocktable_batch > 0)
     {
-      printf("AK_allocationbit: ERROR. Cannot open db file %s.\n", DB_FILE);
+      pthread_mutex_unlock(&fileLockMutex);
       AK_EPI;
-      exit(EXIT_ERROR);
+      return EXIT_SUCCESS;
+    }
+  if (AK_allocationbit_disk == NULL)
+    {
+      //nothing is known about the file, every page is written
+      AK_allocationbit_disk = (AK_blocktable *) AK_malloc(sizeof(AK_blocktable));
+      all = 1;
     }
 
-  pthread_mutex_lock(&fileLockMutex);
-  if (AK_fwrite(AK_allocationbit, AK_ALLOCATION_TABLE_SIZE, 1, db) != 1)
+  for (page = 0; page <= (int) AK_ALLOCATION_TABLE_PAGES; page++)
     {
-      printf("AK_allocationbit: ERROR. Cannot write bit vector \n");
-      AK_EPI;
-      exit(EXIT_ERROR);
+      offset = (size_t) page * AK_ALLOCATION_PAGE_SIZE;
+      length = (offset + AK_ALLOCATION_PAGE_SIZE > AK_ALLOCATION_TABLE_SIZE) ? AK_ALLOCATION_TABLE_SIZE - offset : AK_ALLOCATION_PAGE_SIZE;
+      if (page < (int) AK_ALLOCATION_TABLE_PAGES
+	  && (all || memcmp((char *) AK_allocationbit + offset, (char *) AK_allocationbit_disk + offset, length) != 0))
+	{
+	  if (run < 0)
+	    run = page;
+	  continue;
+	}
+      if (run < 0)
+	continue;
+
+      //pages run..page-1 changed
+      first = (size_t) run * AK_ALLOCATION_PAGE_SIZE;
+      last = (offset < AK_ALLOCATION_TABLE_SIZE) ? offset : AK_ALLOCATION_TABLE_SIZE;
+      if (AK_blocktable_write(&file, first, last - first) == EXIT_ERROR)
+	{
+	  printf("AK_allocationbit: ERROR. Cannot write bit vector \n");
+	  pthread_mutex_unlock(&fileLockMutex);
+	  AK_EPI;
+	  exit(EXIT_ERROR);
+	}
+      memcpy((char *) AK_allocationbit_disk + first, (char *) AK_allocationbit + first, last - first);
+      AK_blocktable_pages_written += page - run;
+      run = -1;
     }
   pthread_mutex_unlock(&fileLockMutex);
 
-  fclose(db);
-  db = NULL;
+  if (file != NULL)
+    fclose(file);
   AK_EPI;
   
   return(EXIT_SUCCESS);
 }
 
+/**
+ * @brief  Function that starts a batch of allocation table updates, AK_blocktable_flush does not write until the
+ * matching AK_blocktable_batch_end
+ */
+void
+AK_blocktable_batch_begin()
+{
+  AK_PRO;
+  pthread_mutex_lock(&fileLockMutex);
+  AK_blocktable_batch++;
+  pthread_mutex_unlock(&fileLockMutex);
+  AK_EPI;
+}
+
+/**
+ * @brief  Function that ends a batch of allocation table updates and writes the pages the batch changed
+ */
+void
+AK_blocktable_batch_end()
+{
+  AK_PRO;
+  pthread_mutex_lock(&fileLockMutex);
+  if (AK_blocktable_batch > 0)
+    AK_blocktable_batch--;
+  pthread_mutex_unlock(&fileLockMutex);
+  AK_blocktable_flush();
+  AK_EPI;
+}
 
+/**
+ * @brief  Function that determines the free-space map class of a block. A block is full once AK_find_AK_free_space
+ * would no longer choose it for an insert.
+ * @param block block
+ * @return AK_FSM_EMPTY, AK_FSM_PARTIAL or AK_FSM_FULL
+ */
+int
+AK_fsm_fill_class(AK_block *block)
+{
+  int fill_class;
+  AK_PRO;
+  if (block->AK_free_space >= MAX_FREE_SPACE_SIZE || block->last_tuple_dict_id >= MAX_LAST_TUPLE_DICT_SIZE_TO_USE)
+    fill_class = AK_FSM_FULL;
+  else if (block->AK_free_space == 0 && block->last_tuple_dict_id == 0)
+    fill_class = AK_FSM_EMPTY;
+  else
+    fill_class = AK_FSM_PARTIAL;
+  AK_EPI;
+  return fill_class;
+}
+
+/**
+ * @brief  Function that records the fill class of a block in the free-space map. The map is written to disk with
+ * the rest of the allocation table by AK_blocktable_flush.
+ * @param block block whose rows have changed
+ */
+void
+AK_fsm_update(AK_block *block)
+{
+  AK_PRO;
+  if (block->address >= 0 && block->address < DB_FILE_BLOCKS_NUM_EX)
+    AK_allocationbit->fsm[block->address] = AK_fsm_fill_class(block);
+  AK_EPI;
+}
+
+/**
+ * @brief  Function that reads the fill class of a block from the free-space map
+ * @param address block address
+ * @return AK_FSM_EMPTY, AK_FSM_PARTIAL or AK_FSM_FULL
+ */
+int
+AK_fsm_get(int address)
+{
+  int fill_class = AK_FSM_FULL;
+  AK_PRO;
+  if (address >= 0 && address < DB_FILE_BLOCKS_NUM_EX)
+    fill_class = AK_allocationbit->fsm[address];
+  AK_EPI;
+  return fill_class;
+}
 
 /**
  * @author Domagoj Šitum
@@ -493,6 +826,9 @@ AK_blocktable_get()
       AK_EPI;
       exit(EXIT_ERROR);
     }
+  if (AK_allocationbit_disk != NULL)
+    memcpy(AK_allocationbit_disk, AK_allocationbit, AK_ALLOCATION_TABLE_SIZE);
+  AK_free_runs_limit = -1;
   pthread_mutex_unlock(&fileLockMutex);
   
   fclose(db);
@@ -544,7 +880,7 @@ fsize(FILE *fp)
 int
 AK_init_allocation_table()
 {
-  int i, fileSizeBytes;
+  int fileSizeBytes;
   AK_PRO;
   if ((AK_allocationbit = (AK_blocktable *)AK_malloc(sizeof(AK_blocktable))) == NULL)
     {
@@ -568,11 +904,9 @@ AK_init_allocation_table()
   pthread_mutex_lock(&fileLockMutex);
   if (fileSizeBytes == 0)
     {
-      for (i = 0; i < DB_FILE_BLOCKS_NUM; i++)
-	{
-	  BITCLEAR(AK_allocationbit->bittable, i);
-	  AK_allocationbit->allocationtable[i] = 0xFFFFFFFF;	    
-	}
+      memset(AK_allocationbit->bittable, 0, sizeof(AK_allocationbit->bittable));
+      memset(AK_allocationbit->allocationtable, 0xFF, sizeof(AK_allocationbit->allocationtable));
+      memset(AK_allocationbit->fsm, AK_FSM_EMPTY, sizeof(AK_allocationbit->fsm));
       AK_allocationbit->last_allocated   = 0;
       AK_allocationbit->last_initialized = 0;
       AK_allocationbit->prepared         = 0;
@@ -595,6 +929,10 @@ AK_init_allocation_table()
 
   fclose(db);
   db = NULL;
+  if (AK_allocationbit_disk == NULL)
+    AK_allocationbit_disk = (AK_blocktable *) AK_malloc(sizeof(AK_blocktable));
+  memcpy(AK_allocationbit_disk, AK_allocationbit, AK_ALLOCATION_TABLE_SIZE);
+  AK_free_runs_limit = -1;
   pthread_mutex_unlock(&fileLockMutex);
 
   AK_EPI;
@@ -909,17 +1247,97 @@ AK_print_block(AK_block * block, int num, char* gg, FILE *fpp)
   AK_EPI;
 }
 
+/**
+ * @brief  Function that checks whether an encoded block is the free block a blank page reads as, so that writing
+ * it can be left to the first real write of the block
+ * @param page encoded block
+ * @return 1 if the block is blank, 0 otherwise
+ */
+static int
+AK_block_is_blank(unsigned char *page)
+{
+  unsigned char blank_page[AK_PAGE_SIZE];
+  AK_block *blank = (AK_block *) AK_malloc(sizeof(AK_block));
+  int result;
+
+  memset(blank_page, 0, AK_PAGE_SIZE);
+  result = AK_page_decode(&AK_db_catalog, blank_page, blank) == EXIT_SUCCESS;
+  blank->address = ((AK_page_header *) page)->address;
+  result = result && AK_page_encode(&AK_db_catalog, blank, blank_page) == EXIT_SUCCESS
+    && memcmp(page, blank_page, AK_PAGE_SIZE) == 0;
+
+  AK_free(blank);
+  return result;
+}
+
 /**
 * @author Markus Schatten , rearranged by dv
 * @brief  Function that allocates new blocks by placing them to appropriate place
-* and then updates the last initialized index
+* and then updates the last initialized index. With SPARSE_DB_FILE, free blocks past the end of the file are not
+* written, the file is only extended and they stay holes until their first write.
 * @return EXIT_SUCCESS if the file has been written to disk, EXIT_ERROR otherwise
 */
 int
 AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
 {
   register int i = 0;
+  unsigned char page[AK_PAGE_SIZE];
+  struct stat stats;
   AK_PRO;
+  /// every new block is the same page, only the address differs
+  block->address = FromWhere;
+  if (AK_open_db_file() == EXIT_ERROR || AK_page_encode(&AK_db_catalog, block, page) == EXIT_ERROR)
+    {
+      printf("AK_init_db_file: ERROR. Cannot prepare new blocks.\n");
+      AK_EPI;
+      return EXIT_ERROR;
+    }
+
+  if (SPARSE_DB_FILE && AK_block_is_blank(page))
+    {
+      if (db != NULL)
+	fclose(db);
+
+      pthread_mutex_lock(&fileLockMutex);
+      if (fstat(AK_db_fd, &stats) != 0)
+	{
+	  printf("AK_init_db_file: ERROR. Cannot stat db file %s.\n", DB_FILE);
+	  pthread_mutex_unlock(&fileLockMutex);
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+
+      /// pages that are already in the file may hold old blocks and are written, the rest become holes
+      for (i = FromWhere; i < FromWhere + HowMany && AK_page_offset(i) < stats.st_size; i++)
+	{
+	  ((AK_page_header *) page)->address = i;
+	  if (AK_page_transfer(AK_db_fd, 1, page, AK_PAGE_SIZE, AK_page_offset(i)) == EXIT_ERROR)
+	    {
+	      printf("AK_init_db_file: ERROR. Cannot write block %d\n", i);
+	      pthread_mutex_unlock(&fileLockMutex);
+	      AK_EPI;
+	      return EXIT_ERROR;
+	    }
+	}
+
+      i = FromWhere + HowMany;
+      if (AK_page_offset(i) > stats.st_size && ftruncate(AK_db_fd, AK_page_offset(i)) != 0)
+	{
+	  printf("AK_init_db_file: ERROR. Cannot extend db file %s.\n", DB_FILE);
+	  pthread_mutex_unlock(&fileLockMutex);
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      pthread_mutex_unlock(&fileLockMutex);
+
+      AK_allocationbit->last_initialized = i;
+      AK_allocate_block_activity_modes();
+      AK_blocktable_flush();
+      printf("AK_allocationbit->last_initialized %d\n", AK_allocationbit->last_initialized);
+      AK_EPI;
+      return (EXIT_SUCCESS);
+    }
+
   if (db == NULL)
     {
       if ((db = fopen(DB_FILE, "rb+")) == NULL)
@@ -931,7 +1349,7 @@ AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
     }
     
     pthread_mutex_lock(&fileLockMutex);
-    if (fseek(db, AK_ALLOCATION_TABLE_SIZE + FromWhere * sizeof(AK_block), SEEK_SET) != 0)
+    if (fseek(db, AK_page_offset(FromWhere), SEEK_SET) != 0)
       {
 	printf("AK_allocationbit: ERROR. Cannot set position to move for AK_blocktable \n");
 	AK_EPI;
@@ -941,8 +1359,9 @@ AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
     for (i = FromWhere; i < FromWhere + HowMany; i++)
       {
         block->address = i;
+        ((AK_page_header *) page)->address = i;
 	
-        if (AK_fwrite(block, sizeof (*block), 1, db) != 1)
+        if (AK_fwrite(page, AK_PAGE_SIZE, 1, db) != 1)
 	  {
 	    printf("AK_init_db_file: ERROR. Cannot write block %d\n", i);
 	    AK_EPI;
@@ -962,6 +1381,69 @@ AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
     return (EXIT_SUCCESS);
 }
 
+/**
+ * @brief  Function opens the shared descriptor of the DB file if it is not already open.
+ * It is called from AK_init_disk_manager and lazily from AK_read_block/AK_write_block.
+ * @return EXIT_SUCCESS if the descriptor is open, EXIT_ERROR otherwise
+ */
+int
+AK_open_db_file()
+{
+  int fd;
+  AK_PRO;
+  if (AK_db_fd >= 0)
+    {
+      AK_EPI;
+      return EXIT_SUCCESS;
+    }
+
+  pthread_mutex_lock(&fileLockMutex);
+  if (AK_db_fd < 0)
+    {
+      if ((fd = open(DB_FILE, O_RDWR)) < 0)
+	{
+	  printf("AK_open_db_file: ERROR. Cannot open db file %s: %s\n", DB_FILE, strerror(errno));
+	  pthread_mutex_unlock(&fileLockMutex);
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      if (AK_schema_catalog_open(&AK_db_catalog, fd) == EXIT_ERROR)
+	{
+	  close(fd);
+	  pthread_mutex_unlock(&fileLockMutex);
+	  AK_EPI;
+	  return EXIT_ERROR;
+	}
+      AK_db_fd = fd;
+    }
+  pthread_mutex_unlock(&fileLockMutex);
+
+  AK_EPI;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function closes the shared descriptor of the DB file. The next block access reopens it.
+ * @return EXIT_SUCCESS if the descriptor was closed or was not open, EXIT_ERROR otherwise
+ */
+int
+AK_close_db_file()
+{
+  int result = EXIT_SUCCESS;
+  AK_PRO;
+  pthread_mutex_lock(&fileLockMutex);
+  if (AK_db_fd >= 0)
+    {
+      AK_schema_catalog_close(&AK_db_catalog);
+      if (close(AK_db_fd) != 0)
+	result = EXIT_ERROR;
+      AK_db_fd = -1;
+    }
+  pthread_mutex_unlock(&fileLockMutex);
+  AK_EPI;
+  return result;
+}
+
 /**
 * @var test_lastCharacterWritten
 * @brief This variable is used only when TEST_MODE is ON!
@@ -990,8 +1472,8 @@ int test_threadSafeBlockAccessSucceeded = 1;
 /**
  * @author Markus Schatten, updated by dv and Domagoj Šitum (thread-safe enabled)
  * @brief  Function that reads a block at a given address (block number less than db_file_size).
- * New block is allocated. Database file is opened. Position is set to provided address block.
- * At the end function reads file from that position. Completely thread-safe.
+ * New block is allocated and filled with a positional read on the shared DB file descriptor.
+ * Completely thread-safe.
  * @param address block number (address)
  * @return pointer to block allocated in memory
  */
@@ -1011,13 +1493,12 @@ AK_read_block(int address)
       exit(EXIT_ERROR);
     }
     
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_read_block: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
       exit(EXIT_ERROR);
-    } 
+    }
 
   pthread_mutex_lock(&AK_block_activity_info[address].block_lock);
   // first we check if the block is already locked for writing by another thread
@@ -1043,26 +1524,22 @@ AK_read_block(int address)
       AK_block_activity_info[address].locked_for_reading = true;
     }
     
-  // now we can safely write block to the disk
-    
-  // first we have to set position in file for reading new block
-  if (fseek(database, address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_read_block: ERROR. Cannot set position to provided address block %d.\n", address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-  //ERROR: a value of type "void *" cannot be used to initialize an entity of type "AK_block *"   
+  // now we can safely read block from the disk
   AK_block * block = AK_malloc(sizeof(AK_block));
+  unsigned char page[AK_PAGE_SIZE];
 
-  // then we simply read block from the disk
-  if (AK_fread(block, sizeof(AK_block), 1, database) == 0)
+  // the page is read with a single positional read on the shared descriptor and unpacked into the block
+  if (AK_page_transfer(AK_db_fd, 0, page, AK_PAGE_SIZE, AK_page_offset(address)) == EXIT_ERROR
+      || AK_page_decode(&AK_db_catalog, page, block) == EXIT_ERROR)
     {
       printf("AK_read_block: ERROR. Cannot read block %d.\n", address);
 	  AK_free(block);
       AK_EPI;
       exit(EXIT_ERROR);
     }
+  // a block that has never been written is a hole of the sparse DB file and reads as a free block
+  if (AK_page_is_blank(page))
+    block->address = address;
     
   // block of code below is used only for testing purposes!
   // it is executed only when testMode is ON 
@@ -1090,7 +1567,6 @@ AK_read_block(int address)
   if (AK_block_activity_info[address].thread_holding_lock == &thread_id) {
     pthread_mutex_unlock(&AK_block_activity_info[address].block_lock);
   }
-  fclose(database);
     
   AK_EPI;
   return block;
@@ -1098,8 +1574,8 @@ AK_read_block(int address)
 
 /**
 * @author Markus Schatten, updated by Domagoj Šitum (thread-safe enabled)
-* @brief  Function that writes a block to the DB file. Database file is opened. Position is set to provided address block. Block is
-  written to provided address. Completely thread-safe.
+* @brief  Function that writes a block to the DB file. Block is written to provided address with a positional write
+  on the shared DB file descriptor. Completely thread-safe.
 * @param block poiner to block allocated in memory to write
 * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
 */
@@ -1111,9 +1587,9 @@ AK_write_block(AK_block * block)
   int true = 1, false = 0;
   int locked_for_reading = false, locked_for_writing = false, address;
   int thread_id;
+  unsigned char page[AK_PAGE_SIZE];
 
-  FILE * database;
-  if ((database = fopen(DB_FILE, "rb+")) == NULL)
+  if (AK_open_db_file() == EXIT_ERROR)
     {
       printf("AK_write_block: ERROR. Cannot open db file %s.\n", DB_FILE);
       AK_EPI;
@@ -1163,18 +1639,9 @@ AK_write_block(AK_block * block)
       test_lastCharacterWritten = block->data[0];
     }
     
-  // now we can safely write it to the disk
-
-  // first we have to set position in file for new block writing
-  if (fseek(database, block->address * sizeof(AK_block)+AK_ALLOCATION_TABLE_SIZE, SEEK_SET) != 0)
-    {
-      printf("AK_write_block: ERROR. Cannot set position to provided address block %d.\n", block->address);
-      AK_EPI;
-      exit(EXIT_ERROR);
-    }
-
-  // then we simply write block to the disk
-  if (AK_fwrite(block, sizeof (*block), 1, database) != 1)
+  // now we can safely write it to the disk as a page with a single positional write
+  if (AK_page_encode(&AK_db_catalog, block, page) == EXIT_ERROR
+      || AK_page_transfer(AK_db_fd, 1, page, AK_PAGE_SIZE, AK_page_offset(address)) == EXIT_ERROR)
     {
       printf("AK_write_block: ERROR. Cannot write block at provided address %d.\n", block->address);
       AK_EPI;
@@ -1193,8 +1660,6 @@ AK_write_block(AK_block * block)
       pthread_mutex_unlock(&AK_block_activity_info[address].block_lock);
     }
     
-  fclose(database);
-    
   AK_EPI;
   return (EXIT_SUCCESS);
 }
@@ -1236,6 +1701,7 @@ AK_copy_header(AK_header *header, int* blockSet, int blockSetSize)
       
       if (AK_write_block(block) == EXIT_SUCCESS)
 	{
+	  AK_cache_refresh_block(block);
 	  num_blocks++;
 	}
       
@@ -1331,7 +1797,8 @@ AK_get_extent(int start_address, int desired_size, AK_allocation_set_mode* mode,
   //still haven't saved what happened to the allocation table
   for (i = 0; i < desired_size; i++)
     {
-      BITSET(AK_allocationbit->bittable, blocknum[i]);
+      AK_blocktable_mark(blocknum[i], 1);
+      AK_allocationbit->fsm[blocknum[i]] = AK_FSM_EMPTY;
       if (i < (desired_size - 1))AK_allocationbit->allocationtable[blocknum[i]] = blocknum[i + 1];
     }
   AK_allocationbit->allocationtable[blocknum[i - 1]] = blocknum[0];
@@ -1500,7 +1967,8 @@ AK_new_extent(int start_address, int old_size, int extent_type, AK_header *heade
 
   for (i = 0; i < requested_space_in_blocks; i++)
     {
-      BITSET(AK_allocationbit->bittable, allocation_set[i]);
+      AK_blocktable_mark(allocation_set[i], 1);
+      AK_allocationbit->fsm[allocation_set[i]] = AK_FSM_EMPTY;
       if (i < (requested_space_in_blocks - 1))
 	AK_allocationbit->allocationtable[allocation_set[i]] = allocation_set[i + 1];
     }
@@ -1659,6 +2127,65 @@ AK_insert_entry(AK_block* block_address, int type, void* entry_data, int i)
   AK_EPI;
 }
 
+/**
+ * @brief  Function returns the type of a tuple entry of a block. Together with AK_tuple_size, AK_tuple_data and
+ * AK_tuple_copy it is the way to read tuples without knowing how a block is laid out.
+ * @param block block
+ * @param id index of the entry
+ * @return type of the entry, FREE_INT if the entry has never been used
+ */
+int
+AK_tuple_type(AK_block *block, int id)
+{
+  return block->tuple_dict[id].type;
+}
+
+/**
+ * @brief  Function returns the size of a tuple entry of a block
+ * @param block block
+ * @param id index of the entry
+ * @return size of the entry, 0 if the entry has been deleted, FREE_INT if it has never been used
+ */
+int
+AK_tuple_size(AK_block *block, int id)
+{
+  return block->tuple_dict[id].size;
+}
+
+/**
+ * @brief  Function returns the value of a tuple entry of a block
+ * @param block block
+ * @param id index of the entry
+ * @return pointer to the value inside the block
+ */
+unsigned char *
+AK_tuple_data(AK_block *block, int id)
+{
+  return block->data + block->tuple_dict[id].address;
+}
+
+/**
+ * @brief  Function copies the value of a tuple entry of a block and terminates it with '\0'
+ * @param block block
+ * @param id index of the entry
+ * @param data buffer of at least the size of the entry plus one
+ * @return size of the copied value, 0 if the entry is empty
+ */
+int
+AK_tuple_copy(AK_block *block, int id, char *data)
+{
+  int size = block->tuple_dict[id].size;
+
+  if (size <= 0)
+    {
+      data[0] = '\0';
+      return 0;
+    }
+  memcpy(data, block->data + block->tuple_dict[id].address, size);
+  data[size] = '\0';
+  return size;
+}
+
 /**
  * @author Matija Novak
  * @brief  Function that initialises the sytem table catalog and writes the result in first (0) block in db_file. Catalog block,
@@ -2451,14 +2978,15 @@ AK_delete_block(int address)
     memcpy(block->tuple_dict, tuple_dict, sizeof (*tuple_dict));
     memcpy(block->data, data, sizeof (*data));
 
-    BITCLEAR(AK_allocationbit->bittable, address);
+    AK_blocktable_mark(address, 0);
+    AK_allocationbit->fsm[address] = AK_FSM_EMPTY;
     if (address == AK_allocationbit->last_allocated)
       AK_allocationbit->last_allocated = address - 1;
     AK_blocktable_flush();
-    AK_blocktable_get();
 
     if (AK_write_block(block) == EXIT_SUCCESS)
       {
+        AK_cache_refresh_block(block);
 		/* added block deallocation, seems no more needed. All positive tests passed. For your convenvenience, I added comment here... Elvis Popovic, 10.05.2018.*/
 		AK_free(block);
         AK_EPI;
@@ -2474,7 +3002,7 @@ AK_delete_block(int address)
  * @author Dejan Sambolić
  * @brief  Function that deletes an extent between the first and the last block
  * @param begin address of extent's first block
- * @param end address of extent's last block
+ * @param end address one past the extent's last block, as kept in the end_address of the system catalog
  * @return EXIT_SUCCESS if extent has been successfully deleted, EXIT_ERROR otherwise
  */
 int
@@ -2482,15 +3010,18 @@ AK_delete_extent(int begin, int end)
 {
   int address;
   AK_PRO;
-  for (address = begin; address < end + 1; address++)
+  AK_blocktable_batch_begin();
+  for (address = begin; address < end; address++)
     {
       if (AK_delete_block(address) == EXIT_ERROR)
 	{
+	  AK_blocktable_batch_end();
 	  AK_EPI;
 	  return EXIT_ERROR;
         }
       AK_allocationbit->allocationtable[address] = 0xFFFFFFFF;
     }
+  AK_blocktable_batch_end();
   AK_EPI;
   return (EXIT_SUCCESS);
 }
@@ -2508,7 +3039,7 @@ AK_delete_segment(char * name, int type)
   table_addresses *addresses;
   AK_PRO;
 
-  addresses = (table_addresses*)AK_get_segment_addresses(name);
+  addresses = AK_get_segment_addresses_by_type(name, type);
   for (;addresses->address_from[i] != 0; ++i)
     {
       if (AK_delete_extent(addresses->address_from[i], addresses->address_to[i]) == EXIT_ERROR)
@@ -2551,6 +3082,7 @@ AK_delete_segment(char * name, int type)
   AK_Update_Existing_Element(TYPE_VARCHAR, name, system_table, "name", row_root);
   AK_delete_row(row_root);
   AK_free(row_root);
+  AK_catalog_invalidate(name);
 
   AK_EPI;
   return EXIT_SUCCESS;
@@ -2575,6 +3107,12 @@ AK_init_disk_manager()
     
   AK_allocate_block_activity_modes();
 
+  if (AK_open_db_file() == EXIT_ERROR)
+    {
+      AK_EPI;
+      exit(EXIT_ERROR);
+    }
+
   if (AK_allocationbit->prepared == 31)
     {
       printf("\n\tDisk manager has been initialized at %s\n\n", asctime(localtime(&AK_allocationbit->ltime)));
@@ -2684,6 +3222,236 @@ TestResult AK_allocationtable_test()
     return TEST_result(success,failed);
 }
 
+/**
+ * @brief  Function for testing the incremental flush of the allocation table. Allocates and deletes extents, checks
+ * that each one writes only a few pages of the allocation table and that the table on disk matches the one in memory.
+ * @return test result
+ */
+TestResult AK_blocktable_flush_test()
+{
+  int success = 0, failed = 0, i, num_extents = 10, size = INITIAL_EXTENT_SIZE;
+  int start[10];
+  unsigned long before, pages;
+  AK_blocktable *disk;
+  FILE *file;
+  AK_header header[2] = {
+    {TYPE_INT, "a", {0}, {{'\0'}}, {{'\0'}}},
+    {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+  AK_PRO;
+
+  //a flush without changes writes nothing
+  AK_blocktable_flush();
+  before = AK_blocktable_pages_written;
+  AK_blocktable_flush();
+  if (AK_blocktable_pages_written == before)
+    success++;
+  else
+    {
+      printf("AK_blocktable_flush_test: ERROR. Unchanged allocation table was written.\n");
+      failed++;
+    }
+
+  before = AK_blocktable_pages_written;
+  for (i = 0; i < num_extents; i++)
+    start[i] = AK_new_extent(1, 0, SEGMENT_TYPE_TABLE, header);
+  pages = AK_blocktable_pages_written - before;
+  printf("\n%d extents allocated: %lu of %d allocation table pages written (%lu instead of %lu bytes)\n",
+	 num_extents, pages, (int) AK_ALLOCATION_TABLE_PAGES, pages * AK_ALLOCATION_PAGE_SIZE,
+	 (unsigned long) num_extents * AK_ALLOCATION_TABLE_SIZE);
+  if (pages > 0 && pages * 4 < num_extents * AK_ALLOCATION_TABLE_PAGES)
+    success++;
+  else
+    {
+      printf("AK_blocktable_flush_test: ERROR. Extent allocation wrote %lu pages.\n", pages);
+      failed++;
+    }
+
+  before = AK_blocktable_pages_written;
+  for (i = 0; i < num_extents; i++)
+    if (start[i] != EXIT_ERROR)
+      AK_delete_extent(start[i], start[i] + size);
+  pages = AK_blocktable_pages_written - before;
+  printf("%d extents deleted: %lu allocation table pages written\n\n", num_extents, pages);
+
+  disk = (AK_blocktable *) AK_malloc(sizeof(AK_blocktable));
+  if ((file = fopen(DB_FILE, "rb")) != NULL && AK_fread(disk, AK_ALLOCATION_TABLE_SIZE, 1, file) == 1
+      && memcmp(disk, AK_allocationbit, AK_ALLOCATION_TABLE_SIZE) == 0)
+    success++;
+  else
+    {
+      printf("AK_blocktable_flush_test: ERROR. Allocation table on disk differs from the one in memory.\n");
+      failed++;
+    }
+  if (file != NULL)
+    fclose(file);
+  AK_free(disk);
+
+  AK_EPI;
+  return TEST_result(success, failed);
+}
+
+/**
+ * @brief  Function that finds a run of free blocks for allocationSEQUENCE the way AK_get_allocation_set did before
+ * the free-run summary tree: it lists every free block and compares windows of the list. Kept as the reference for
+ * AK_allocation_set_test.
+ * @param fromWhere 0 to search from the start of the table, otherwise from the last allocated block
+ * @param numRequestedBlocks length of the run
+ * @return address of the first block of the run, FREE_INT if there is none
+ */
+static int
+AK_allocation_sequence_scan(int fromWhere, int numRequestedBlocks)
+{
+  int lastInitilizedBlock = AK_allocationbit->last_initialized;
+  int freeBlocksMap[lastInitilizedBlock + 1];
+  int num_free_blocks_bitmap = 0, i, startBlockIndex = 0, freeBlockIndex;
+
+  for (i = 0; i < lastInitilizedBlock; i++)
+    if (!BITTEST(AK_allocationbit->bittable, i))
+      freeBlocksMap[num_free_blocks_bitmap++] = i;
+  freeBlocksMap[num_free_blocks_bitmap] = FREE_INT;
+
+  if (num_free_blocks_bitmap < numRequestedBlocks)
+    return FREE_INT;
+
+  if (fromWhere)
+    {
+      if (numRequestedBlocks > (lastInitilizedBlock - AK_allocationbit->last_allocated))
+	return FREE_INT;
+      for (startBlockIndex = 0; startBlockIndex < num_free_blocks_bitmap; startBlockIndex++)
+	if (freeBlocksMap[startBlockIndex] == AK_allocationbit->last_allocated)
+	  break;
+    }
+
+  for (; startBlockIndex <= num_free_blocks_bitmap - numRequestedBlocks; startBlockIndex = freeBlockIndex + 1)
+    {
+      for (freeBlockIndex = startBlockIndex; freeBlockIndex < startBlockIndex + numRequestedBlocks - 1; freeBlockIndex++)
+	if (freeBlocksMap[freeBlockIndex + 1] != freeBlocksMap[freeBlockIndex] + 1)
+	  break;
+      if (freeBlockIndex == startBlockIndex + numRequestedBlocks - 1)
+	return freeBlocksMap[startBlockIndex];
+    }
+  return FREE_INT;
+}
+
+/**
+ * @brief  Function for testing and benchmarking AK_get_allocation_set. The whole bit-table of a DB_FILE_SIZE_EX MB
+ * file is filled to about 90% with runs of used and free blocks, then the same extents are allocated by listing
+ * the free blocks and with the free-run summary tree. Both have to pick the same blocks, and every mode has to
+ * return a set of free blocks that respects the gap length. The allocation table is restored at the end.
+ * @return test result
+ */
+TestResult AK_allocation_set_test()
+{
+  int success = 0, failed = 0, i, j, k, n, pass, round, block, gap, mode, ok;
+  int num_rounds = 20, num_extents = 64, max_extent = 16;
+  int found[2][64], set[17];
+  double start, elapsed[2];
+  AK_blocktable *saved = (AK_blocktable *) AK_malloc(sizeof(AK_blocktable));
+  unsigned char *bits = (unsigned char *) AK_malloc(sizeof(AK_allocationbit->bittable));
+  AK_allocation_set_mode modes[3] = { allocationUPPER, allocationLOWER, allocationAROUND };
+  const char *mode_name[3] = { "UPPER", "LOWER", "AROUND" };
+  AK_PRO;
+
+  memcpy(saved, AK_allocationbit, sizeof(AK_blocktable));
+  AK_allocationbit->last_initialized = DB_FILE_BLOCKS_NUM_EX;
+  AK_allocationbit->last_allocated = 0;
+
+  // used runs of 1 to 152 blocks and free runs of 1 to 16 blocks, about 90% of the table is used
+  srand(1);
+  for (block = 0; block < DB_FILE_BLOCKS_NUM_EX; )
+    {
+      for (k = 1 + rand() % 152; k > 0 && block < DB_FILE_BLOCKS_NUM_EX; k--, block++)
+	BITSET(AK_allocationbit->bittable, block);
+      for (k = 1 + rand() % max_extent; k > 0 && block < DB_FILE_BLOCKS_NUM_EX; k--, block++)
+	BITCLEAR(AK_allocationbit->bittable, block);
+    }
+  memcpy(bits, AK_allocationbit->bittable, sizeof(AK_allocationbit->bittable));
+  AK_free_runs_limit = -1;
+  AK_free_runs_prepare();
+  printf("\n%d blocks, %.1f%% used\n", DB_FILE_BLOCKS_NUM_EX,
+	 100.0 - 100.0 * AK_free_runs[1].free / DB_FILE_BLOCKS_NUM_EX);
+
+  // pass 0 lists the free blocks on every allocation, pass 1 uses the free-run summary tree
+  for (pass = 0; pass < 2; pass++)
+    {
+      start = TEST_time_ms();
+      for (round = 0; round < num_rounds; round++)
+	{
+	  memcpy(AK_allocationbit->bittable, bits, sizeof(AK_allocationbit->bittable));
+	  AK_free_runs_limit = -1;
+	  for (i = 0; i < num_extents; i++)
+	    {
+	      n = 2 + i % (max_extent - 1);
+	      block = pass ? AK_allocation_sequence(0, n) : AK_allocation_sequence_scan(0, n);
+	      for (j = 0; block != FREE_INT && j < n; j++)
+		AK_blocktable_mark(block + j, 1);
+	      found[pass][i] = block;
+	    }
+	}
+      elapsed[pass] = TEST_time_ms() - start;
+    }
+
+  printf("%d extents of 2 to %d blocks (extents/s)\n", num_rounds * num_extents, max_extent);
+  printf("%-14s %14s %8s\n", "free list", "free-run tree", "speedup");
+  printf("%-14.0f %14.0f %7.1fx\n", num_rounds * num_extents / (elapsed[0] / 1000.0),
+	 num_rounds * num_extents / (elapsed[1] / 1000.0), elapsed[0] / (elapsed[1] > 0 ? elapsed[1] : 0.001));
+
+  if (memcmp(found[0], found[1], sizeof(found[0])) == 0)
+    success++;
+  else
+    {
+      printf("AK_allocation_set_test: ERROR. The free-run tree picked other blocks than the free list.\n");
+      failed++;
+    }
+
+  // allocationSEQUENCE from the last allocated block
+  memcpy(AK_allocationbit->bittable, bits, sizeof(AK_allocationbit->bittable));
+  AK_free_runs_limit = -1;
+  AK_allocationbit->last_allocated = AK_next_free_block(DB_FILE_BLOCKS_NUM_EX / 2);
+  block = AK_get_allocation_set(set, 1, 0, 4, allocationSEQUENCE, 0);
+  if (block == AK_allocation_sequence_scan(1, 4) && block >= AK_allocationbit->last_allocated && set[3] == block + 3)
+    success++;
+  else
+    {
+      printf("AK_allocation_set_test: ERROR. SEQUENCE from block %d returned %d.\n",
+	     AK_allocationbit->last_allocated, block);
+      failed++;
+    }
+
+  // the other modes return free blocks that are at most gap blocks apart
+  for (mode = 0; mode < 3; mode++)
+    for (gap = 1; gap <= 8; gap *= 2)
+      {
+	n = 12;
+	AK_get_allocation_set(set, 0, gap, n, modes[mode], AK_next_free_block(DB_FILE_BLOCKS_NUM_EX / 3));
+	ok = set[0] != FREE_INT;
+	for (i = 0; ok && i < n; i++)
+	  {
+	    ok = set[i] >= 0 && !BITTEST(AK_allocationbit->bittable, set[i]);
+	    for (j = 0; ok && j < i; j++)
+	      ok = set[j] != set[i];
+	    if (ok && i > 0 && modes[mode] != allocationAROUND)
+	      ok = abs(set[i] - set[i - 1]) <= gap;
+	    if (ok && modes[mode] == allocationAROUND)
+	      ok = abs(set[i] - set[0]) <= n * gap;
+	  }
+	if (ok)
+	  success++;
+	else
+	  {
+	    printf("AK_allocation_set_test: ERROR. %s with gap %d returned a wrong set.\n", mode_name[mode], gap);
+	    failed++;
+	  }
+      }
+
+  memcpy(AK_allocationbit, saved, sizeof(AK_blocktable));
+  AK_free_runs_limit = -1;
+  AK_free(bits);
+  AK_free(saved);
+  AK_EPI;
+  return TEST_result(success, failed);
+}
+
 /**
  * @author Domagoj Šitum
  * @brief This function tests thread safe reading and writing to blocks.
@@ -2801,3 +3569,225 @@ void* AK_write_block_for_testing(void *block)
     AK_EPI;
     return 0;
 }
+
+/**
+ * @brief Reads a block the way AK_read_block did before the shared descriptor was introduced:
+ * the DB file is opened, positioned and closed for every single block. Used only as the
+ * baseline in AK_block_io_benchmark.
+ * @param address block number (address)
+ * @param block buffer the block is read into
+ * @return EXIT_SUCCESS if the block has been read, EXIT_ERROR otherwise
+ */
+static int
+AK_read_block_reopening(int address, AK_block *block)
+{
+  FILE *database;
+  unsigned char page[AK_PAGE_SIZE];
+  int result = EXIT_SUCCESS;
+
+  if ((database = fopen(DB_FILE, "rb")) == NULL)
+    return EXIT_ERROR;
+  if (fseek(database, AK_page_offset(address), SEEK_SET) != 0
+      || AK_fread(page, AK_PAGE_SIZE, 1, database) != 1
+      || AK_page_decode(&AK_db_catalog, page, block) == EXIT_ERROR)
+    result = EXIT_ERROR;
+  else if (AK_page_is_blank(page))
+    block->address = address;
+  fclose(database);
+  return result;
+}
+
+/**
+ * @brief Microbenchmark for block I/O. Sequential and random block reads are timed on the old
+ * open/seek/read/close path, on a bare positional read of the page from the shared descriptor and on the
+ * whole AK_read_block call (which also pays for unpacking the page, block allocation, locking and AK_PRO/AK_EPI).
+ * Every block read by AK_read_block must be identical to the one read by the old path.
+ * @return TestResult
+ */
+TestResult AK_block_io_benchmark()
+{
+  int i, pass, address, success = 0, failed = 0;
+  int num_blocks = AK_allocationbit->last_initialized;
+  int num_reads = 4 * num_blocks;
+  int *addresses;
+  double start, elapsed[2][3];
+  AK_block *block, *reference = (AK_block *) AK_malloc(sizeof(AK_block));
+  unsigned char page[AK_PAGE_SIZE];
+  const char *pattern_name[2] = { "sequential", "random" };
+  AK_PRO;
+
+  if (num_blocks <= 0 || AK_open_db_file() == EXIT_ERROR)
+    {
+      printf("AK_block_io_benchmark: no initialized blocks to read.\n");
+      AK_free(reference);
+      AK_EPI;
+      return TEST_result(0, 1);
+    }
+
+  // pass 0 reads blocks in address order, pass 1 reads the same number of blocks at random
+  addresses = (int *) AK_malloc(num_reads * sizeof(int));
+  srand(time(NULL));
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      for (i = 0; i < num_reads; i++)
+	addresses[i] = pass ? rand() % num_blocks : i % num_blocks;
+
+      start = TEST_time_ms();
+      for (i = 0; i < num_reads; i++)
+	{
+	  if (AK_read_block_reopening(addresses[i], reference) == EXIT_ERROR)
+	    {
+	      printf("AK_block_io_benchmark: ERROR. Cannot read block %d.\n", addresses[i]);
+	      failed++;
+	      break;
+	    }
+	}
+      elapsed[pass][0] = TEST_time_ms() - start;
+
+      start = TEST_time_ms();
+      for (i = 0; i < num_reads; i++)
+	AK_page_transfer(AK_db_fd, 0, page, AK_PAGE_SIZE, AK_page_offset(addresses[i]));
+      elapsed[pass][1] = TEST_time_ms() - start;
+
+      start = TEST_time_ms();
+      for (i = 0; i < num_reads; i++)
+	AK_free(AK_read_block(addresses[i]));
+      elapsed[pass][2] = TEST_time_ms() - start;
+    }
+
+  // both paths have to see the same bytes
+  for (address = 0; address < num_blocks; address++)
+    {
+      block = AK_read_block(address);
+      if (AK_read_block_reopening(address, reference) == EXIT_ERROR
+	  || memcmp(block, reference, sizeof(AK_block)) != 0)
+	{
+	  printf("AK_block_io_benchmark: block %d differs between read paths.\n", address);
+	  failed++;
+	}
+      else
+	success++;
+      AK_free(block);
+    }
+
+  printf("\n%d reads of %d-byte pages over %d initialized blocks (blocks/s)\n", num_reads, AK_PAGE_SIZE, num_blocks);
+  printf("%-12s %14s %14s %14s\n", "pattern", "reopen", "pread", "AK_read_block");
+  for (pass = 0; pass < 2; pass++)
+    printf("%-12s %14.0f %14.0f %14.0f\n", pattern_name[pass],
+	   num_reads / (elapsed[pass][0] / 1000.0),
+	   num_reads / (elapsed[pass][1] / 1000.0),
+	   num_reads / (elapsed[pass][2] / 1000.0));
+
+  AK_free(addresses);
+  AK_free(reference);
+  AK_EPI;
+  return TEST_result(success, failed);
+}
+
+/**
+ * @brief Function that starts the engine on a new DB file in a child process of AK_startup_benchmark. The disk
+ * manager and the memory manager are initialized as in main, then the system catalog and a block that has not been
+ * written yet are read back.
+ * @param file name of the new DB file
+ * @param sparse value of SPARSE_DB_FILE
+ * @param out pipe the result is written to
+ */
+static void
+AK_startup_child(char *file, int sparse, int out)
+{
+  AK_startup_result result;
+  AK_block *block;
+  struct stat stats;
+  double start;
+
+  AK_close_db_file();
+  iniparser_set(AK_config, "general:db_file", file);
+  iniparser_set(AK_config, "general:sparse_db_file", sparse ? "1" : "0");
+  remove(file);
+
+  start = TEST_time_ms();
+  result.ok = AK_init_disk_manager() == EXIT_SUCCESS && AK_memoman_init() == EXIT_SUCCESS;
+  result.elapsed = TEST_time_ms() - start;
+
+  if (result.ok)
+    {
+      block = AK_read_block(0);
+      result.ok = block->type == BLOCK_TYPE_NORMAL && block->last_tuple_dict_id > 0;
+      AK_free(block);
+      block = AK_read_block(AK_allocationbit->last_initialized - 1);
+      result.ok = result.ok && block->type == BLOCK_TYPE_FREE && block->address == AK_allocationbit->last_initialized - 1;
+      AK_free(block);
+    }
+
+  result.size = result.allocated = 0;
+  if (stat(file, &stats) == 0)
+    {
+      result.size = stats.st_size;
+      result.allocated = (long long) stats.st_blocks * 512;
+    }
+
+  fflush(stdout);
+  if (write(out, &result, sizeof(result)) != sizeof(result))
+    _exit(EXIT_FAILURE);
+  _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Startup-time benchmark. A new database is created and the engine started twice in child processes, once
+ * writing every new block of the DB file and once leaving new blocks as holes of a sparse file. Both databases have
+ * to come up with a readable system catalog and free blocks where nothing was written.
+ * @return TestResult
+ */
+TestResult AK_startup_benchmark()
+{
+  int success = 0, failed = 0, sparse, channel[2], status;
+  char file[64];
+  const char *mode_name[2] = { "written", "sparse" };
+  AK_startup_result result[2];
+  pid_t child;
+  AK_PRO;
+
+  for (sparse = 0; sparse < 2; sparse++)
+    {
+      sprintf(file, "startup_benchmark_%d.db", (int) getpid());
+      memset(&result[sparse], 0, sizeof(AK_startup_result));
+
+      fflush(stdout);
+      if (pipe(channel) != 0 || (child = fork()) < 0)
+	{
+	  printf("AK_startup_benchmark: ERROR. Cannot start a child process.\n");
+	  failed++;
+	  continue;
+	}
+      if (child == 0)
+	{
+	  close(channel[0]);
+	  AK_startup_child(file, sparse, channel[1]);
+	}
+
+      close(channel[1]);
+      if (read(channel[0], &result[sparse], sizeof(AK_startup_result)) != sizeof(AK_startup_result))
+	result[sparse].ok = 0;
+      close(channel[0]);
+      waitpid(child, &status, 0);
+      remove(file);
+
+      if (result[sparse].ok && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+	success++;
+      else
+	{
+	  printf("AK_startup_benchmark: ERROR. Startup on a new %s DB file failed.\n", mode_name[sparse]);
+	  failed++;
+	}
+    }
+
+  printf("\nStartup on a new database (disk and memory manager, system catalog)\n");
+  printf("%-10s %12s %14s %14s\n", "DB file", "time (ms)", "size (KB)", "on disk (KB)");
+  for (sparse = 0; sparse < 2; sparse++)
+    printf("%-10s %12.1f %14lld %14lld\n", mode_name[sparse], result[sparse].elapsed,
+	   result[sparse].size / 1024, result[sparse].allocated / 1024);
+
+  AK_EPI;
+  return TEST_result(success, failed);
+}
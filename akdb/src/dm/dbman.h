@@ -31,6 +31,8 @@ of Kalashnikov DB
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "../auxi/mempro.h"
 
 
@@ -48,6 +50,22 @@ of Kalashnikov DB
 #define BITNSLOTS(nb)   ((int)(nb + CHAR_BIT - 1) / CHAR_BIT)
 #define SEGMENTLENGTH() (BITNSLOTS(DB_FILE_BLOCKS_NUM) + 2*sizeof(int))
 
+/**
+ * @def AK_FSM_EMPTY
+ * @brief free-space map class of a block without rows (also of free blocks)
+ */
+#define AK_FSM_EMPTY 0
+/**
+ * @def AK_FSM_PARTIAL
+ * @brief free-space map class of a block that has rows and can take more
+ */
+#define AK_FSM_PARTIAL 1
+/**
+ * @def AK_FSM_FULL
+ * @brief free-space map class of a block that AK_find_AK_free_space no longer chooses
+ */
+#define AK_FSM_FULL 2
+
 
 /**
  * @author Markus Schatten
@@ -144,12 +162,43 @@ typedef struct {
 typedef struct {
     unsigned int allocationtable[DB_FILE_BLOCKS_NUM_EX];
     unsigned char bittable[BITNSLOTS(DB_FILE_BLOCKS_NUM_EX)];
+    /// free-space map, fill class of every block (AK_FSM_EMPTY, AK_FSM_PARTIAL or AK_FSM_FULL)
+    unsigned char fsm[DB_FILE_BLOCKS_NUM_EX];
     int last_allocated;
     int last_initialized;
     int prepared;
     time_t ltime;
 }AK_blocktable;
 
+/**
+ * @def AK_ALLOCATION_WORD_BITS
+ * @brief Number of blocks of the bit-table that are searched at once
+ */
+#define AK_ALLOCATION_WORD_BITS 64
+
+/**
+ * @def AK_ALLOCATION_WORDS
+ * @brief Number of words of the bit-table
+ */
+#define AK_ALLOCATION_WORDS ((DB_FILE_BLOCKS_NUM_EX + AK_ALLOCATION_WORD_BITS - 1) / AK_ALLOCATION_WORD_BITS)
+
+/**
+ * @struct AK_free_run
+ * @brief Structure that defines a node of the free-run summary tree, a range of the bit-table described by its
+ * free runs
+ */
+typedef struct {
+    /// number of blocks in the range
+    int length;
+    /// free blocks at the start and at the end of the range
+    int prefix;
+    int suffix;
+    /// longest run of free blocks in the range
+    int longest;
+    /// number of free blocks in the range
+    int free;
+} AK_free_run;
+
 /**
  * @author dv
  * @var AK_allocationbit
@@ -166,6 +215,24 @@ AK_blocktable *AK_allocationbit;
  */
 #define AK_ALLOCATION_TABLE_SIZE sizeof(AK_blocktable)
 
+/**
+ * @def AK_ALLOCATION_PAGE_SIZE
+ * @brief Size of a page of the allocation table, the unit in which AK_blocktable_flush writes it
+ */
+#define AK_ALLOCATION_PAGE_SIZE 512
+
+/**
+ * @def AK_ALLOCATION_TABLE_PAGES
+ * @brief Number of pages of the allocation table
+ */
+#define AK_ALLOCATION_TABLE_PAGES ((AK_ALLOCATION_TABLE_SIZE + AK_ALLOCATION_PAGE_SIZE - 1) / AK_ALLOCATION_PAGE_SIZE)
+
+/**
+ * @var AK_blocktable_pages_written
+ * @brief Number of allocation table pages written by AK_blocktable_flush
+ */
+unsigned long AK_blocktable_pages_written;
+
 
 /**
  * @author dv
@@ -236,6 +303,20 @@ AK_block_activity *AK_block_activity_info;
  */
 AK_synchronization_info* dbmanFileLock;
 
+/**
+ * @struct AK_startup_result
+ * @brief Structure that defines the result of a startup on a new DB file, sent from the child process of
+ * AK_startup_benchmark
+ */
+typedef struct {
+    int ok;
+    /// startup time in ms
+    double elapsed;
+    /// size of the DB file and the space it takes on disk (in bytes)
+    long long size;
+    long long allocated;
+} AK_startup_result;
+
 int AK_print_block(AK_block * block, int num, char* gg, FILE *fpp);
 TestResult AK_allocationbit_test();
 TestResult AK_allocationtable_test();
@@ -248,20 +329,35 @@ AK_block *  AK_init_block();
 int AK_allocationtable_dump(int zz);
 void AK_blocktable_dump(int zz);
 int AK_blocktable_flush();
+void AK_blocktable_batch_begin();
+void AK_blocktable_batch_end();
+TestResult AK_blocktable_flush_test();
+TestResult AK_allocation_set_test();
+int AK_fsm_fill_class(AK_block *block);
+void AK_fsm_update(AK_block *block);
+int AK_fsm_get(int address);
 // void AK_allocate_array_currently_accessed_blocks(); // ne postoji nikakva implementacija
 TestResult AK_thread_safe_block_access_test();
 void* AK_read_block_for_testing(void *address);
 void* AK_write_block_for_testing(void *block);
+TestResult AK_block_io_benchmark();
+TestResult AK_startup_benchmark();
 int AK_blocktable_get();
 int fsize(FILE *fp);
 int AK_init_allocation_table();
 int AK_init_db_file(int size);
+int AK_open_db_file();
+int AK_close_db_file();
 AK_block * AK_read_block(int address);
 int AK_write_block(AK_block * block);
 int AK_new_extent(int start_address, int old_size, int extent_type, AK_header *header);
 int AK_new_segment(char * name, int type, AK_header *header);
 AK_header * AK_create_header(char * name, int type, int integrity, char * constr_name, char * contr_code);
 void AK_insert_entry(AK_block * block_address, int type, void * entry_data, int i);
+int AK_tuple_type(AK_block *block, int id);
+int AK_tuple_size(AK_block *block, int id);
+unsigned char *AK_tuple_data(AK_block *block, int id);
+int AK_tuple_copy(AK_block *block, int id, char *data);
 int AK_init_system_tables_catalog(int relation, int attribute, int index, int view, int sequence, int function, int function_arguments,
     int trigger, int trigger_conditions, int db, int db_obj, int user, int group, int user_group, int user_right, int group_right, int constraint, int constraintNull, int constraintCheck, int constraintUnique, int reference);
 void AK_memset_int(void *block, int value, size_t num);
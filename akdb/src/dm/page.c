@@ -0,0 +1,743 @@
+/**
+@file page.c Defines functions of the on-disk page format
+*/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/*
+ * A block is kept in memory as AK_block, but written to the DB file as a page of AK_PAGE_SIZE bytes:
+ *
+ *   AK_page_header | AK_page_slot[num_slots] | data[data_size] | unused
+ *
+ * Slots and data past the last used entry are not stored, they are FREE_INT and FREE_CHAR in every block.
+ * The attribute definitions (AK_header[MAX_ATTRIBUTES]) are the same for all blocks of a table, so they are
+ * stored once in the schema catalog between the allocation table and the first page, and the page only holds
+ * the index of its schema. Schemas are packed with PackBits, since most of an AK_header is padding.
+ */
+
+#include "page.h"
+
+/**
+ * @brief Upper bound of a packed schema (in bytes)
+ */
+#define AK_SCHEMA_PACKED_MAX (sizeof(AK_header) * MAX_ATTRIBUTES + sizeof(AK_header) * MAX_ATTRIBUTES / 128 + 1)
+
+/**
+ * @brief  Function transfers a buffer between memory and a file at the given offset with positional reads and
+ * writes. Short transfers and interrupted calls are retried until the buffer is complete.
+ * @param fd file descriptor
+ * @param writing 1 to write the buffer to the file, 0 to read it
+ * @param buffer memory buffer
+ * @param size size of the buffer
+ * @param offset byte offset in the file
+ * @return EXIT_SUCCESS if the whole buffer has been transferred, EXIT_ERROR otherwise
+ */
+int AK_page_transfer(int fd, int writing, void *buffer, size_t size, off_t offset)
+{
+    char *position = (char *) buffer;
+    ssize_t done;
+
+    while (size > 0)
+    {
+        if (writing)
+            done = pwrite(fd, position, size, offset);
+        else
+            done = pread(fd, position, size, offset);
+
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            return EXIT_ERROR;
+
+        position += done;
+        offset += done;
+        size -= done;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function returns the position of a page in the DB file
+ * @param address block number (address)
+ * @return byte offset of the page
+ */
+off_t AK_page_offset(int address)
+{
+    return AK_PAGES_OFFSET + (off_t) address * AK_PAGE_SIZE;
+}
+
+/**
+ * @brief  Function packs the attribute definitions of a block with PackBits. A control byte below 128 is
+ * followed by that many plus one literal bytes, a control byte above 128 repeats the next byte 257 minus
+ * control times.
+ * @param header attribute definitions (MAX_ATTRIBUTES of them)
+ * @param packed buffer of at least AK_SCHEMA_PACKED_MAX bytes
+ * @return size of the packed schema
+ */
+static int AK_schema_pack(AK_header *header, unsigned char *packed)
+{
+    unsigned char *bytes = (unsigned char *) header;
+    int size = sizeof(AK_header) * MAX_ATTRIBUTES;
+    int i = 0, start, run, packed_size = 0;
+
+    while (i < size)
+    {
+        for (run = 1; i + run < size && run < 128 && bytes[i + run] == bytes[i]; run++)
+            ;
+
+        if (run > 1)
+        {
+            packed[packed_size++] = 257 - run;
+            packed[packed_size++] = bytes[i];
+            i += run;
+            continue;
+        }
+
+        /// literal bytes run until the next repeated byte
+        start = i;
+        while (i < size && i - start < 128 && (i + 1 == size || bytes[i] != bytes[i + 1]))
+            i++;
+        packed[packed_size++] = i - start - 1;
+        memcpy(packed + packed_size, bytes + start, i - start);
+        packed_size += i - start;
+    }
+    return packed_size;
+}
+
+/**
+ * @brief  Function unpacks attribute definitions packed with AK_schema_pack
+ * @param packed packed schema
+ * @param packed_size size of the packed schema
+ * @param header attribute definitions (MAX_ATTRIBUTES of them)
+ * @return EXIT_SUCCESS if exactly MAX_ATTRIBUTES headers were unpacked, EXIT_ERROR otherwise
+ */
+static int AK_schema_unpack(unsigned char *packed, int packed_size, AK_header *header)
+{
+    unsigned char *bytes = (unsigned char *) header;
+    int size = sizeof(AK_header) * MAX_ATTRIBUTES;
+    int i = 0, length, unpacked = 0;
+
+    while (i < packed_size)
+    {
+        if (packed[i] < 128)
+        {
+            length = packed[i] + 1;
+            if (i + 1 + length > packed_size || unpacked + length > size)
+                return EXIT_ERROR;
+            memcpy(bytes + unpacked, packed + i + 1, length);
+            i += 1 + length;
+        }
+        else if (packed[i] > 128)
+        {
+            length = 257 - packed[i];
+            if (i + 1 >= packed_size || unpacked + length > size)
+                return EXIT_ERROR;
+            memset(bytes + unpacked, packed[i + 1], length);
+            i += 2;
+        }
+        else
+        {
+            i++;
+            continue;
+        }
+        unpacked += length;
+    }
+    return unpacked == size ? EXIT_SUCCESS : EXIT_ERROR;
+}
+
+/**
+ * @brief  FNV-1a hash of a packed schema
+ * @param packed packed schema
+ * @param packed_size size of the packed schema
+ * @return hash value
+ */
+static unsigned int AK_schema_hash(unsigned char *packed, int packed_size)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < packed_size; i++)
+        hash = (hash ^ packed[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief  Function adds a packed schema to the in-memory part of the catalog. The caller holds the catalog lock.
+ * @param catalog schema catalog
+ * @param packed packed schema
+ * @param packed_size size of the packed schema
+ * @return index of the schema, EXIT_ERROR if it cannot be unpacked
+ */
+static int AK_schema_add(AK_schema_catalog *catalog, unsigned char *packed, int packed_size)
+{
+    int id = catalog->num_schemas;
+    AK_header *header = (AK_header *) AK_malloc(sizeof(AK_header) * MAX_ATTRIBUTES);
+
+    if (AK_schema_unpack(packed, packed_size, header) == EXIT_ERROR)
+    {
+        printf("AK_schema_add: ERROR. Schema %d is damaged.\n", id);
+        AK_free(header);
+        return EXIT_ERROR;
+    }
+
+    catalog->schema[id] = header;
+    catalog->packed[id] = (unsigned char *) AK_malloc(packed_size);
+    memcpy(catalog->packed[id], packed, packed_size);
+    catalog->packed_size[id] = packed_size;
+    catalog->hash[id] = AK_schema_hash(packed, packed_size);
+    catalog->num_schemas++;
+    return id;
+}
+
+/**
+ * @brief  Function opens the schema catalog of a DB file. A file that ends with the allocation table gets an
+ * empty catalog, otherwise the stored schemas are loaded.
+ * @param catalog schema catalog
+ * @param fd descriptor of the DB file
+ * @return EXIT_SUCCESS if the catalog is open, EXIT_ERROR if the file is not in the page format
+ */
+int AK_schema_catalog_open(AK_schema_catalog *catalog, int fd)
+{
+    AK_schema_catalog_header header;
+    struct stat info;
+    unsigned char *area;
+    int position, packed_size;
+    AK_PRO;
+
+    pthread_mutex_init(&catalog->lock, NULL);
+    catalog->fd = fd;
+    catalog->num_schemas = 0;
+    catalog->schema_bytes = 0;
+
+    if (fstat(fd, &info) != 0)
+    {
+        printf("AK_schema_catalog_open: ERROR. Cannot stat db file: %s\n", strerror(errno));
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (info.st_size <= AK_SCHEMA_CATALOG_OFFSET)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, AK_PAGE_MAGIC, sizeof(header.magic));
+        header.page_size = AK_PAGE_SIZE;
+        if (AK_page_transfer(fd, 1, &header, sizeof(header), AK_SCHEMA_CATALOG_OFFSET) == EXIT_ERROR)
+        {
+            printf("AK_schema_catalog_open: ERROR. Cannot write schema catalog.\n");
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    if (AK_page_transfer(fd, 0, &header, sizeof(header), AK_SCHEMA_CATALOG_OFFSET) == EXIT_ERROR
+        || memcmp(header.magic, AK_PAGE_MAGIC, sizeof(header.magic)) != 0 || header.page_size != AK_PAGE_SIZE)
+    {
+        printf("AK_schema_catalog_open: ERROR. DB file is not in the %d-byte page format. "
+               "Convert it with: akdb convert <old file> <new file>\n", AK_PAGE_SIZE);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    area = (unsigned char *) AK_malloc(header.schema_bytes + 1);
+    if (AK_page_transfer(fd, 0, area, header.schema_bytes, AK_SCHEMA_AREA_OFFSET) == EXIT_ERROR)
+    {
+        printf("AK_schema_catalog_open: ERROR. Cannot read %d schemas.\n", header.num_schemas);
+        AK_free(area);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    /// the area holds the schemas one after another, each prefixed by its packed size
+    for (position = 0; catalog->num_schemas < header.num_schemas; position += packed_size)
+    {
+        memcpy(&packed_size, area + position, sizeof(int));
+        position += sizeof(int);
+        if (AK_schema_add(catalog, area + position, packed_size) == EXIT_ERROR)
+        {
+            AK_free(area);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+    catalog->schema_bytes = header.schema_bytes;
+
+    AK_free(area);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function releases the memory of a schema catalog
+ * @param catalog schema catalog
+ */
+void AK_schema_catalog_close(AK_schema_catalog *catalog)
+{
+    int i;
+    AK_PRO;
+    for (i = 0; i < catalog->num_schemas; i++)
+    {
+        AK_free(catalog->schema[i]);
+        AK_free(catalog->packed[i]);
+    }
+    catalog->num_schemas = 0;
+    catalog->schema_bytes = 0;
+    catalog->fd = -1;
+    pthread_mutex_destroy(&catalog->lock);
+    AK_EPI;
+}
+
+/**
+ * @brief  Function returns the index of the given attribute definitions in the schema catalog. Definitions that
+ * are not in the catalog yet are appended to it and written to the DB file.
+ * @param catalog schema catalog
+ * @param header attribute definitions (MAX_ATTRIBUTES of them)
+ * @return index of the schema, EXIT_ERROR if the catalog is full
+ */
+int AK_schema_find(AK_schema_catalog *catalog, AK_header *header)
+{
+    unsigned char *packed = (unsigned char *) AK_malloc(AK_SCHEMA_PACKED_MAX);
+    int i, id = EXIT_ERROR, packed_size;
+    unsigned int hash;
+    AK_schema_catalog_header catalog_header;
+    AK_PRO;
+
+    packed_size = AK_schema_pack(header, packed);
+    hash = AK_schema_hash(packed, packed_size);
+
+    pthread_mutex_lock(&catalog->lock);
+    for (i = 0; i < catalog->num_schemas; i++)
+    {
+        if (catalog->hash[i] == hash && catalog->packed_size[i] == packed_size
+            && memcmp(catalog->packed[i], packed, packed_size) == 0)
+        {
+            id = i;
+            break;
+        }
+    }
+
+    if (id == EXIT_ERROR)
+    {
+        if (catalog->num_schemas == AK_MAX_SCHEMAS
+            || catalog->schema_bytes + sizeof(int) + packed_size > AK_SCHEMA_AREA_SIZE)
+            printf("AK_schema_find: ERROR. Schema catalog is full (%d schemas).\n", catalog->num_schemas);
+        else
+        {
+            /// the schema is written before the catalog header counts it
+            memset(&catalog_header, 0, sizeof(catalog_header));
+            memcpy(catalog_header.magic, AK_PAGE_MAGIC, sizeof(catalog_header.magic));
+            catalog_header.page_size = AK_PAGE_SIZE;
+            catalog_header.num_schemas = catalog->num_schemas + 1;
+            catalog_header.schema_bytes = catalog->schema_bytes + sizeof(int) + packed_size;
+
+            if (AK_page_transfer(catalog->fd, 1, &packed_size, sizeof(int), AK_SCHEMA_AREA_OFFSET + catalog->schema_bytes) == EXIT_ERROR
+                || AK_page_transfer(catalog->fd, 1, packed, packed_size, AK_SCHEMA_AREA_OFFSET + catalog->schema_bytes + sizeof(int)) == EXIT_ERROR
+                || AK_page_transfer(catalog->fd, 1, &catalog_header, sizeof(catalog_header), AK_SCHEMA_CATALOG_OFFSET) == EXIT_ERROR)
+                printf("AK_schema_find: ERROR. Cannot write schema %d.\n", catalog->num_schemas);
+            else if ((id = AK_schema_add(catalog, packed, packed_size)) != EXIT_ERROR)
+                catalog->schema_bytes = catalog_header.schema_bytes;
+        }
+    }
+    pthread_mutex_unlock(&catalog->lock);
+
+    AK_free(packed);
+    AK_EPI;
+    return id;
+}
+
+/**
+ * @brief  Function writes a block into a page. Slots and data past the last used entry are left out and the
+ * attribute definitions are replaced by their index in the schema catalog.
+ * @param catalog schema catalog of the file the page is written to
+ * @param block block to write
+ * @param page buffer of AK_PAGE_SIZE bytes
+ * @return EXIT_SUCCESS if the block fits into the page, EXIT_ERROR otherwise
+ */
+int AK_page_encode(AK_schema_catalog *catalog, AK_block *block, unsigned char *page)
+{
+    AK_page_header *page_header = (AK_page_header *) page;
+    AK_page_slot *slot = (AK_page_slot *) (page + sizeof(AK_page_header));
+    AK_tuple_dict *tuple;
+    int i, num_slots, data_size, schema;
+    AK_PRO;
+
+    if ((schema = AK_schema_find(catalog, block->header)) == EXIT_ERROR)
+    {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (num_slots = DATA_BLOCK_SIZE; num_slots > 0; num_slots--)
+    {
+        tuple = &block->tuple_dict[num_slots - 1];
+        if (tuple->type != FREE_INT || tuple->address != FREE_INT || tuple->size != FREE_INT)
+            break;
+    }
+    for (data_size = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE; data_size > 0 && block->data[data_size - 1] == FREE_CHAR; data_size--)
+        ;
+
+    if (sizeof(AK_page_header) + num_slots * sizeof(AK_page_slot) + data_size > AK_PAGE_SIZE)
+    {
+        printf("AK_page_encode: ERROR. Block %d does not fit into a page.\n", block->address);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < num_slots; i++)
+    {
+        tuple = &block->tuple_dict[i];
+        if (tuple->type != (short) tuple->type || tuple->address != (short) tuple->address || tuple->size != (short) tuple->size)
+        {
+            printf("AK_page_encode: ERROR. Tuple %d of block %d is out of range.\n", i, block->address);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        slot[i].type = tuple->type;
+        slot[i].address = tuple->address;
+        slot[i].size = tuple->size;
+    }
+
+    page_header->address = block->address;
+    page_header->type = block->type;
+    page_header->chained_with = block->chained_with;
+    page_header->AK_free_space = block->AK_free_space;
+    page_header->last_tuple_dict_id = block->last_tuple_dict_id;
+    page_header->schema = schema;
+    page_header->num_slots = num_slots;
+    page_header->data_size = data_size;
+
+    memcpy(slot + num_slots, block->data, data_size);
+    memset((unsigned char *) (slot + num_slots) + data_size, 0,
+           AK_PAGE_SIZE - sizeof(AK_page_header) - num_slots * sizeof(AK_page_slot) - data_size);
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function checks whether a page has never been written. Blocks of a sparse DB file are holes that read
+ * as zeros until their first write, while a written page always has a non-zero block type, chained_with or
+ * free space.
+ * @param page buffer of AK_PAGE_SIZE bytes
+ * @return 1 if the page is blank, 0 otherwise
+ */
+int AK_page_is_blank(unsigned char *page)
+{
+    static const AK_page_header blank;
+
+    return memcmp(page, &blank, sizeof(AK_page_header)) == 0;
+}
+
+/**
+ * @brief  Function fills a block the way AK_init_block does, for a page that has never been written
+ * @param block block to fill, its address is left 0
+ */
+static void AK_page_free_block(AK_block *block)
+{
+    int i, j;
+
+    memset(block->header, FREE_CHAR, sizeof(block->header));
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+    {
+        block->header[i].type = FREE_INT;
+        for (j = 0; j < MAX_CONSTRAINTS; j++)
+            block->header[i].integrity[j] = FREE_INT;
+    }
+    for (i = 0; i < DATA_BLOCK_SIZE; i++)
+    {
+        block->tuple_dict[i].type = FREE_INT;
+        block->tuple_dict[i].address = FREE_INT;
+        block->tuple_dict[i].size = FREE_INT;
+    }
+    memset(block->data, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE);
+
+    block->address = 0;
+    block->type = BLOCK_TYPE_FREE;
+    block->chained_with = NOT_CHAINED;
+    block->AK_free_space = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE * sizeof(int);
+    block->last_tuple_dict_id = 0;
+}
+
+/**
+ * @brief  Function reads a block from a page written by AK_page_encode. A blank page is a free block.
+ * @param catalog schema catalog of the file the page was read from
+ * @param page buffer of AK_PAGE_SIZE bytes
+ * @param block block to fill
+ * @return EXIT_SUCCESS if the page is valid, EXIT_ERROR otherwise
+ */
+int AK_page_decode(AK_schema_catalog *catalog, unsigned char *page, AK_block *block)
+{
+    AK_page_header *page_header = (AK_page_header *) page;
+    AK_page_slot *slot = (AK_page_slot *) (page + sizeof(AK_page_header));
+    AK_header *schema = NULL;
+    int i;
+    AK_PRO;
+
+    if (AK_page_is_blank(page))
+    {
+        AK_page_free_block(block);
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    pthread_mutex_lock(&catalog->lock);
+    if (page_header->schema >= 0 && page_header->schema < catalog->num_schemas)
+        schema = catalog->schema[page_header->schema];
+    pthread_mutex_unlock(&catalog->lock);
+
+    if (schema == NULL || page_header->num_slots < 0 || page_header->num_slots > DATA_BLOCK_SIZE
+        || page_header->data_size < 0 || page_header->data_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+    {
+        printf("AK_page_decode: ERROR. Page of block %d is damaged.\n", page_header->address);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    block->address = page_header->address;
+    block->type = page_header->type;
+    block->chained_with = page_header->chained_with;
+    block->AK_free_space = page_header->AK_free_space;
+    block->last_tuple_dict_id = page_header->last_tuple_dict_id;
+    memcpy(block->header, schema, sizeof(block->header));
+
+    for (i = 0; i < page_header->num_slots; i++)
+    {
+        block->tuple_dict[i].type = slot[i].type;
+        block->tuple_dict[i].address = slot[i].address;
+        block->tuple_dict[i].size = slot[i].size;
+    }
+    for (; i < DATA_BLOCK_SIZE; i++)
+    {
+        block->tuple_dict[i].type = FREE_INT;
+        block->tuple_dict[i].address = FREE_INT;
+        block->tuple_dict[i].size = FREE_INT;
+    }
+
+    memcpy(block->data, slot + page_header->num_slots, page_header->data_size);
+    memset(block->data + page_header->data_size, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - page_header->data_size);
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function converts a DB file that stores whole AK_block structures into the page format. The allocation
+ * table is copied and every initialized block is written as a page.
+ * @param old_file DB file in the old format
+ * @param new_file DB file to create
+ * @return EXIT_SUCCESS if the file has been converted, EXIT_ERROR otherwise
+ */
+int AK_convert_db_file(char *old_file, char *new_file)
+{
+    int old_fd, new_fd, address, result = EXIT_SUCCESS;
+    char magic[sizeof(AK_PAGE_MAGIC) - 1];
+    AK_blocktable *table;
+    AK_block *block;
+    unsigned char *page;
+    AK_schema_catalog *catalog;
+    AK_PRO;
+
+    if ((old_fd = open(old_file, O_RDONLY)) < 0)
+    {
+        printf("AK_convert_db_file: ERROR. Cannot open %s: %s\n", old_file, strerror(errno));
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    table = (AK_blocktable *) AK_malloc(AK_ALLOCATION_TABLE_SIZE);
+    if (AK_page_transfer(old_fd, 0, table, AK_ALLOCATION_TABLE_SIZE, 0) == EXIT_ERROR)
+    {
+        printf("AK_convert_db_file: ERROR. Cannot read allocation table of %s.\n", old_file);
+        AK_free(table);
+        close(old_fd);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_page_transfer(old_fd, 0, magic, sizeof(magic), AK_SCHEMA_CATALOG_OFFSET) == EXIT_SUCCESS
+        && memcmp(magic, AK_PAGE_MAGIC, sizeof(magic)) == 0)
+    {
+        printf("AK_convert_db_file: %s is already in the page format.\n", old_file);
+        AK_free(table);
+        close(old_fd);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if ((new_fd = open(new_file, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+        printf("AK_convert_db_file: ERROR. Cannot create %s: %s\n", new_file, strerror(errno));
+        AK_free(table);
+        close(old_fd);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    catalog = (AK_schema_catalog *) AK_calloc(1, sizeof(AK_schema_catalog));
+    catalog->fd = -1;
+    block = (AK_block *) AK_malloc(sizeof(AK_block));
+    page = (unsigned char *) AK_malloc(AK_PAGE_SIZE);
+
+    if (AK_page_transfer(new_fd, 1, table, AK_ALLOCATION_TABLE_SIZE, 0) == EXIT_ERROR
+        || AK_schema_catalog_open(catalog, new_fd) == EXIT_ERROR)
+        result = EXIT_ERROR;
+
+    for (address = 0; result == EXIT_SUCCESS && address < table->last_initialized; address++)
+    {
+        if (AK_page_transfer(old_fd, 0, block, sizeof(AK_block), AK_ALLOCATION_TABLE_SIZE + (off_t) address * sizeof(AK_block)) == EXIT_ERROR)
+        {
+            printf("AK_convert_db_file: ERROR. Cannot read block %d of %s.\n", address, old_file);
+            result = EXIT_ERROR;
+        }
+        else if (AK_page_encode(catalog, block, page) == EXIT_ERROR
+                 || AK_page_transfer(new_fd, 1, page, AK_PAGE_SIZE, AK_page_offset(address)) == EXIT_ERROR)
+        {
+            printf("AK_convert_db_file: ERROR. Cannot write block %d to %s.\n", address, new_file);
+            result = EXIT_ERROR;
+        }
+    }
+
+    if (result == EXIT_SUCCESS)
+        printf("AK_convert_db_file: %d blocks with %d schemas converted, %ld bytes instead of %ld.\n",
+               table->last_initialized, catalog->num_schemas, (long) AK_page_offset(table->last_initialized),
+               (long) (AK_ALLOCATION_TABLE_SIZE + (off_t) table->last_initialized * sizeof(AK_block)));
+
+    if (catalog->fd >= 0)
+        AK_schema_catalog_close(catalog);
+    AK_free(catalog);
+    AK_free(block);
+    AK_free(page);
+    AK_free(table);
+    close(new_fd);
+    close(old_fd);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Test of the page format. Every initialized block has to survive encoding and decoding unchanged, a
+ * repeated header must not add a schema and a DB file in the old format has to convert into the same blocks.
+ * @return TestResult
+ */
+TestResult AK_page_test()
+{
+    int address, success = 0, failed = 0, num_schemas, old_fd, new_fd;
+    int num_blocks = AK_allocationbit->last_initialized;
+    char *old_file = "page_test_old.db", *new_file = "page_test_new.db";
+    AK_block *block, *decoded = (AK_block *) AK_malloc(sizeof(AK_block));
+    AK_schema_catalog *catalog;
+    unsigned char *page = (unsigned char *) AK_malloc(AK_PAGE_SIZE);
+    AK_header *header;
+    int integer = 42;
+    AK_PRO;
+
+    printf("\nAK_page_test: %d-byte pages instead of %d-byte blocks, %d schemas for %d blocks\n",
+           AK_PAGE_SIZE, (int) sizeof(AK_block), AK_db_catalog.num_schemas, num_blocks);
+
+    // stored blocks survive the round trip
+    for (address = 0; address < num_blocks; address++)
+    {
+        block = AK_read_block(address);
+        if (AK_page_encode(&AK_db_catalog, block, page) == EXIT_ERROR
+            || AK_page_decode(&AK_db_catalog, page, decoded) == EXIT_ERROR
+            || memcmp(block, decoded, sizeof(AK_block)) != 0)
+        {
+            printf("AK_page_test: block %d changed in the round trip.\n", address);
+            failed++;
+        }
+        else
+            success++;
+        AK_free(block);
+    }
+
+    // a full block fits and a known header is not stored again
+    block = AK_init_block();
+    block->address = 0;
+    block->AK_free_space = 0;
+    header = AK_create_header("page_test", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(&block->header[0], header, sizeof(AK_header));
+    for (address = 0; address < DATA_BLOCK_SIZE; address++)
+        AK_insert_entry(block, TYPE_INT, &integer, address);
+    memset(block->data + block->AK_free_space, 'x', DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - block->AK_free_space);
+
+    AK_page_encode(&AK_db_catalog, block, page);
+    num_schemas = AK_db_catalog.num_schemas;
+    if (AK_page_encode(&AK_db_catalog, block, page) == EXIT_ERROR
+        || AK_page_decode(&AK_db_catalog, page, decoded) == EXIT_ERROR
+        || memcmp(block, decoded, sizeof(AK_block)) != 0 || AK_db_catalog.num_schemas != num_schemas)
+    {
+        printf("AK_page_test: full block changed in the round trip.\n");
+        failed++;
+    }
+    else
+        success++;
+    AK_free(header);
+    AK_free(block);
+
+    // a DB file in the old format converts into the same blocks
+    old_fd = open(old_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    AK_page_transfer(old_fd, 1, AK_allocationbit, AK_ALLOCATION_TABLE_SIZE, 0);
+    for (address = 0; address < num_blocks; address++)
+    {
+        block = AK_read_block(address);
+        AK_page_transfer(old_fd, 1, block, sizeof(AK_block), AK_ALLOCATION_TABLE_SIZE + (off_t) address * sizeof(AK_block));
+        AK_free(block);
+    }
+    close(old_fd);
+
+    if (AK_convert_db_file(old_file, new_file) == EXIT_ERROR || (new_fd = open(new_file, O_RDONLY)) < 0)
+    {
+        printf("AK_page_test: conversion failed.\n");
+        failed++;
+    }
+    else
+    {
+        catalog = (AK_schema_catalog *) AK_calloc(1, sizeof(AK_schema_catalog));
+        if (AK_schema_catalog_open(catalog, new_fd) == EXIT_ERROR)
+            failed++;
+        else
+        {
+            for (address = 0; address < num_blocks; address++)
+            {
+                block = AK_read_block(address);
+                if (AK_page_transfer(new_fd, 0, page, AK_PAGE_SIZE, AK_page_offset(address)) == EXIT_ERROR
+                    || AK_page_decode(catalog, page, decoded) == EXIT_ERROR
+                    || memcmp(block, decoded, sizeof(AK_block)) != 0)
+                {
+                    printf("AK_page_test: converted block %d differs.\n", address);
+                    failed++;
+                }
+                else
+                    success++;
+                AK_free(block);
+            }
+            AK_schema_catalog_close(catalog);
+        }
+        AK_free(catalog);
+        close(new_fd);
+
+        // converting twice is refused
+        if (AK_convert_db_file(new_file, old_file) != EXIT_ERROR)
+            failed++;
+    }
+    remove(old_file);
+    remove(new_file);
+
+    AK_free(decoded);
+    AK_free(page);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
@@ -0,0 +1,143 @@
+/**
+@file page.h Header file that contains defines and data structures of the on-disk page format
+*/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef PAGE
+#define PAGE
+
+#include "dbman.h"
+
+/**
+ * @brief Size of a block on disk (in bytes)
+ */
+#define AK_PAGE_SIZE 8192
+
+/**
+ * @brief Marks a DB file written in the page format
+ */
+#define AK_PAGE_MAGIC "AKPG"
+
+/**
+ * @brief Maximum number of distinct block headers (schemas) in a DB file
+ */
+#define AK_MAX_SCHEMAS 1024
+
+/**
+ * @brief Space reserved for packed schemas (in bytes)
+ */
+#define AK_SCHEMA_AREA_SIZE (1024 * 1024)
+
+/**
+ * @brief Position of the schema catalog, right behind the allocation table
+ */
+#define AK_SCHEMA_CATALOG_OFFSET ((off_t) AK_ALLOCATION_TABLE_SIZE)
+
+/**
+ * @brief Position of the first packed schema
+ */
+#define AK_SCHEMA_AREA_OFFSET (AK_SCHEMA_CATALOG_OFFSET + AK_PAGE_SIZE)
+
+/**
+ * @brief Position of the first page (block 0)
+ */
+#define AK_PAGES_OFFSET (AK_SCHEMA_AREA_OFFSET + AK_SCHEMA_AREA_SIZE)
+
+/**
+ * @struct AK_page_header
+ * @brief Fixed part of a page. The attribute definitions of the block are not stored in the page,
+ * only the index of its schema in the schema catalog.
+ */
+typedef struct {
+    /// block number (address) in DB file
+    int address;
+    /// block type (can be BLOCK_TYPE_FREE, BLOCK_TYPE_NORMAL or BLOCK_TYPE_CHAINED)
+    int type;
+    /// address of chained block; NOT_CHAINED otherwise
+    int chained_with;
+    int AK_free_space;
+    int last_tuple_dict_id;
+    /// index of the block header in the schema catalog
+    int schema;
+    /// number of slots stored in the page, the remaining tuple_dict entries are FREE_INT
+    short num_slots;
+    /// number of data bytes stored in the page, the remaining data is FREE_CHAR
+    short data_size;
+} AK_page_header;
+
+/**
+ * @struct AK_page_slot
+ * @brief Slot of a page, the on-disk form of AK_tuple_dict
+ */
+typedef struct {
+    short type;
+    short address;
+    short size;
+} AK_page_slot;
+
+/**
+ * @struct AK_schema_catalog_header
+ * @brief On-disk header of the schema catalog
+ */
+typedef struct {
+    /// AK_PAGE_MAGIC
+    char magic[4];
+    /// AK_PAGE_SIZE of the file
+    int page_size;
+    /// number of stored schemas
+    int num_schemas;
+    /// bytes used in the schema area
+    int schema_bytes;
+} AK_schema_catalog_header;
+
+/**
+ * @struct AK_schema_catalog
+ * @brief Schema catalog of an open DB file. Every distinct block header is stored once and
+ * pages refer to it by index. Schemas are only appended, so an index stays valid.
+ */
+typedef struct {
+    /// descriptor of the DB file, -1 while the catalog is closed
+    int fd;
+    int num_schemas;
+    int schema_bytes;
+    /// unpacked headers, MAX_ATTRIBUTES per schema
+    AK_header *schema[AK_MAX_SCHEMAS];
+    /// packed headers, as stored in the file
+    unsigned char *packed[AK_MAX_SCHEMAS];
+    int packed_size[AK_MAX_SCHEMAS];
+    unsigned int hash[AK_MAX_SCHEMAS];
+    pthread_mutex_t lock;
+} AK_schema_catalog;
+
+/**
+ * @var AK_db_catalog
+ * @brief Schema catalog of the DB file
+ */
+AK_schema_catalog AK_db_catalog;
+
+int AK_page_transfer(int fd, int writing, void *buffer, size_t size, off_t offset);
+int AK_schema_catalog_open(AK_schema_catalog *catalog, int fd);
+void AK_schema_catalog_close(AK_schema_catalog *catalog);
+int AK_schema_find(AK_schema_catalog *catalog, AK_header *header);
+int AK_page_encode(AK_schema_catalog *catalog, AK_block *block, unsigned char *page);
+int AK_page_is_blank(unsigned char *page);
+int AK_page_decode(AK_schema_catalog *catalog, unsigned char *page, AK_block *block);
+off_t AK_page_offset(int address);
+int AK_convert_db_file(char *old_file, char *new_file);
+TestResult AK_page_test();
+
+#endif
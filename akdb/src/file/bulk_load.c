@@ -0,0 +1,912 @@
+/**
+@file bulk_load.c Provides functions for loading many rows into a table at once
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "bulk_load.h"
+
+/**
+ * @brief  Function that computes the FNV-1a hash of a key
+ * @param *key key bytes
+ * @param length key length
+ * @return hash value
+ */
+static unsigned int AK_bulk_hash(char *key, int length) {
+    unsigned int hash = 2166136261u;
+    int i;
+    for (i = 0; i < length; i++) {
+        hash ^= (unsigned char) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief  Function that tells whether a value is null, null values are stored as the varchar "null" like in AK_insert_row
+ * @return 1 if the value is null, 0 otherwise
+ */
+static int AK_bulk_is_null(int type, int size, char *data) {
+    return type == TYPE_VARCHAR && size == 4 && memcmp(data, "null", 4) == 0;
+}
+
+/**
+ * @brief  Function that builds the key of a UNIQUE constraint from the values of a row
+ * @param *unique UNIQUE constraint
+ * @param *type types of the row values
+ * @param *size sizes of the row values
+ * @param **data row values
+ * @param *key buffer for the key
+ * @return key length, -1 if a key value is null (a null key never violates the constraint)
+ */
+static int AK_bulk_unique_key(AK_bulk_unique *unique, int *type, int *size, char **data, char *key) {
+    int i, a, length = 0;
+    for (i = 0; i < unique->num_attr; i++) {
+        a = unique->attr[i];
+        if (AK_bulk_is_null(type[a], size[a], data[a]))
+            return -1;
+        memcpy(key + length, &size[a], sizeof (int));
+        length += sizeof (int);
+        memcpy(key + length, data[a], size[a]);
+        length += size[a];
+    }
+    return length;
+}
+
+/**
+ * @brief  Function that checks whether a key is in the set of a UNIQUE constraint
+ * @return 1 if the key is in the set, 0 otherwise
+ */
+static int AK_bulk_unique_find(AK_bulk_unique *unique, char *key, int length, unsigned int hash) {
+    int k;
+    for (k = unique->bucket[hash % unique->num_buckets]; k != -1; k = unique->keys[k].next)
+        if (unique->keys[k].hash == hash && unique->keys[k].length == length
+                && memcmp(unique->data + unique->keys[k].offset, key, length) == 0)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief  Function that adds a key to the set of a UNIQUE constraint, the buckets are doubled when the set is full
+ * @return No return value
+ */
+static void AK_bulk_unique_add(AK_bulk_unique *unique, char *key, int length, unsigned int hash) {
+    int k, b;
+    if (unique->num_keys == unique->max_keys) {
+        unique->max_keys *= 2;
+        unique->keys = (AK_bulk_key *) AK_realloc(unique->keys, unique->max_keys * sizeof (AK_bulk_key));
+    }
+    if (unique->num_keys >= unique->num_buckets) {
+        AK_free(unique->bucket);
+        unique->num_buckets *= 2;
+        unique->bucket = (int *) AK_malloc(unique->num_buckets * sizeof (int));
+        memset(unique->bucket, -1, unique->num_buckets * sizeof (int));
+        for (k = 0; k < unique->num_keys; k++) {
+            b = unique->keys[k].hash % unique->num_buckets;
+            unique->keys[k].next = unique->bucket[b];
+            unique->bucket[b] = k;
+        }
+    }
+    while (unique->data_used + length > unique->data_size) {
+        unique->data_size *= 2;
+        unique->data = (char *) AK_realloc(unique->data, unique->data_size);
+    }
+
+    k = unique->num_keys++;
+    memcpy(unique->data + unique->data_used, key, length);
+    unique->keys[k].hash = hash;
+    unique->keys[k].offset = unique->data_used;
+    unique->keys[k].length = length;
+    b = hash % unique->num_buckets;
+    unique->keys[k].next = unique->bucket[b];
+    unique->bucket[b] = k;
+    unique->data_used += length;
+}
+
+/**
+ * @brief  Function that adds a UNIQUE constraint of the table to a bulk load
+ * @param *loader bulk loader
+ * @param *attributes attribute names of the constraint, separated by SEPARATOR
+ * @return No return value
+ */
+static void AK_bulk_load_add_unique(AK_bulk_loader *loader, char *attributes) {
+    char names[MAX_VARCHAR_LENGTH];
+    char *name;
+    int index;
+    AK_bulk_unique *unique;
+
+    if (loader->num_unique == AK_BULK_LOAD_MAX_UNIQUE) {
+        printf("AK_bulk_load_open: ERROR. Table %s has more than %d UNIQUE constraints.\n", loader->table, AK_BULK_LOAD_MAX_UNIQUE);
+        return;
+    }
+    unique = &loader->unique[loader->num_unique];
+    memset(unique, 0, sizeof (AK_bulk_unique));
+    strncpy(names, attributes, MAX_VARCHAR_LENGTH - 1);
+    names[MAX_VARCHAR_LENGTH - 1] = '\0';
+    for (name = strtok(names, SEPARATOR); name != NULL && unique->num_attr < MAX_ATTRIBUTES; name = strtok(NULL, SEPARATOR)) {
+        for (index = 0; index < loader->num_attr; index++)
+            if (strcmp(loader->header[index].att_name, name) == 0)
+                break;
+        if (index == loader->num_attr)
+            return;
+        unique->attr[unique->num_attr++] = index;
+    }
+    if (unique->num_attr == 0)
+        return;
+
+    unique->num_buckets = 1024;
+    unique->bucket = (int *) AK_malloc(unique->num_buckets * sizeof (int));
+    memset(unique->bucket, -1, unique->num_buckets * sizeof (int));
+    unique->max_keys = 1024;
+    unique->keys = (AK_bulk_key *) AK_malloc(unique->max_keys * sizeof (AK_bulk_key));
+    unique->data_size = 16 * 1024;
+    unique->data = (char *) AK_malloc(unique->data_size);
+    loader->num_unique++;
+}
+
+/**
+ * @brief  Function that reads the constraints of the table once: NOT NULL attributes, UNIQUE constraints with the
+ * keys already in the table, and whether the table references another one
+ * @param *loader bulk loader
+ * @return No return value
+ */
+static void AK_bulk_load_constraints(AK_bulk_loader *loader) {
+    AK_table_cursor *cursor;
+    struct list_node *row, *el;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i, u, length;
+    char *data[MAX_ATTRIBUTES];
+    char key[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE + MAX_ATTRIBUTES * sizeof (int)];
+    unsigned int hash;
+
+    cursor = AK_table_cursor_open("AK_constraints_not_null");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (strcmp(AK_GetNth_L2(2, row)->data, loader->table) != 0)
+            continue;
+        for (i = 0; i < loader->num_attr; i++)
+            if (strcmp(loader->header[i].att_name, AK_GetNth_L2(4, row)->data) == 0)
+                loader->not_null[i] = 1;
+    }
+    AK_table_cursor_close(cursor);
+
+    cursor = AK_table_cursor_open("AK_constraints_unique");
+    while ((row = AK_table_cursor_next(cursor)) != NULL)
+        if (strcmp(AK_GetNth_L2(2, row)->data, loader->table) == 0)
+            AK_bulk_load_add_unique(loader, AK_GetNth_L2(4, row)->data);
+    AK_table_cursor_close(cursor);
+
+    cursor = AK_table_cursor_open("AK_reference");
+    while ((row = AK_table_cursor_next(cursor)) != NULL)
+        if (strcmp(row->next->data, loader->table) == 0)
+            loader->has_reference = 1;
+    AK_table_cursor_close(cursor);
+
+    if (loader->num_unique == 0)
+        return;
+
+    //one pass over the table fills the key sets of all UNIQUE constraints
+    cursor = AK_table_cursor_open(loader->table);
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        for (el = AK_First_L2(row), i = 0; el != NULL && i < loader->num_attr; el = el->next, i++) {
+            type[i] = el->type;
+            size[i] = el->size;
+            data[i] = el->data;
+        }
+        if (i < loader->num_attr)
+            continue;
+        for (u = 0; u < loader->num_unique; u++) {
+            length = AK_bulk_unique_key(&loader->unique[u], type, size, data, key);
+            if (length < 0)
+                continue;
+            hash = AK_bulk_hash(key, length);
+            if (!AK_bulk_unique_find(&loader->unique[u], key, length, hash))
+                AK_bulk_unique_add(&loader->unique[u], key, length, hash);
+        }
+    }
+    AK_table_cursor_close(cursor);
+}
+
+/**
+ * @brief  Function that moves the writer of a bulk load behind the last used block of the table, so the rows are
+ * packed into fresh blocks and the blocks AK_insert_row fills are not touched
+ * @param *writer table writer
+ * @return No return value
+ */
+static void AK_bulk_load_seek(AK_table_writer *writer) {
+    int e, b;
+    for (e = 0; e < MAX_EXTENTS_IN_SEGMENT && writer->addresses->address_from[e] != 0; e++)
+        for (b = writer->addresses->address_from[e]; b < writer->addresses->address_to[e]; b++)
+            if (AK_allocationbit->fsm[b] != AK_FSM_EMPTY) {
+                writer->extent = e;
+                writer->block = b + 1;
+            }
+}
+
+/**
+ * @brief  Function that starts a bulk load into a table. The constraints of the table are read once, the rows are
+ * written after the last used block of the table.
+ * @param *table table name
+ * @return bulk loader, NULL if the table does not exist
+ */
+AK_bulk_loader *AK_bulk_load_open(char *table) {
+    AK_bulk_loader *loader;
+    AK_table_writer *writer;
+    AK_PRO;
+
+    writer = AK_table_writer_open(table);
+    if (writer == NULL) {
+        printf("AK_bulk_load_open: ERROR. Table %s does not exist.\n", table);
+        AK_EPI;
+        return NULL;
+    }
+    AK_bulk_load_seek(writer);
+
+    loader = (AK_bulk_loader *) AK_calloc(1, sizeof (AK_bulk_loader));
+    strncpy(loader->table, table, MAX_ATT_NAME - 1);
+    loader->writer = writer;
+    loader->num_attr = writer->num_attr;
+    loader->header = (AK_header *) AK_get_header(table);
+    loader->type = (int *) AK_malloc(AK_BULK_LOAD_BATCH * loader->num_attr * sizeof (int));
+    loader->size = (int *) AK_malloc(AK_BULK_LOAD_BATCH * loader->num_attr * sizeof (int));
+    loader->offset = (int *) AK_malloc(AK_BULK_LOAD_BATCH * loader->num_attr * sizeof (int));
+    loader->buffer_size = AK_BULK_LOAD_BATCH * loader->num_attr * sizeof (double);
+    loader->buffer = (char *) AK_malloc(loader->buffer_size);
+    loader->log_block = -1;
+    loader->log_entry = EXIT_ERROR;
+    AK_bulk_load_constraints(loader);
+    AK_EPI;
+    return loader;
+}
+
+/**
+ * @brief  Function that adds a value to the row being buffered
+ * @param *loader bulk loader
+ * @param i attribute index
+ * @return No return value
+ */
+static void AK_bulk_load_put(AK_bulk_loader *loader, int i, int type, int size, char *data) {
+    int v = loader->num_rows * loader->num_attr + i;
+    while (loader->buffer_used + size > loader->buffer_size) {
+        loader->buffer_size *= 2;
+        loader->buffer = (char *) AK_realloc(loader->buffer, loader->buffer_size);
+    }
+    loader->type[v] = type;
+    loader->size[v] = size;
+    loader->offset[v] = loader->buffer_used;
+    memcpy(loader->buffer + loader->buffer_used, data, size);
+    loader->buffer_used += size;
+}
+
+/**
+ * @brief  Function that checks the constraints of a buffered row and adds its UNIQUE keys when it passes
+ * @param *loader bulk loader
+ * @param r row index in the batch
+ * @return 1 if the row can be written, 0 otherwise
+ */
+static int AK_bulk_load_check(AK_bulk_loader *loader, int r) {
+    int *type = loader->type + r * loader->num_attr;
+    int *size = loader->size + r * loader->num_attr;
+    char *data[MAX_ATTRIBUTES];
+    char key[AK_BULK_LOAD_MAX_UNIQUE][DATA_BLOCK_SIZE * DATA_ENTRY_SIZE + MAX_ATTRIBUTES * sizeof (int)];
+    int length[AK_BULK_LOAD_MAX_UNIQUE];
+    unsigned int hash[AK_BULK_LOAD_MAX_UNIQUE];
+    int i, u, valid = 1;
+    struct list_node *row_root;
+
+    for (i = 0; i < loader->num_attr; i++) {
+        data[i] = loader->buffer + loader->offset[r * loader->num_attr + i];
+        if (loader->not_null[i] && AK_bulk_is_null(type[i], size[i], data[i])) {
+            printf("AK_bulk_load: Row rejected, attribute %s of table %s is NOT NULL.\n", loader->header[i].att_name, loader->table);
+            return 0;
+        }
+    }
+
+    for (u = 0; u < loader->num_unique; u++) {
+        length[u] = AK_bulk_unique_key(&loader->unique[u], type, size, data, key[u]);
+        if (length[u] < 0)
+            continue;
+        hash[u] = AK_bulk_hash(key[u], length[u]);
+        if (AK_bulk_unique_find(&loader->unique[u], key[u], length[u], hash[u])) {
+            printf("AK_bulk_load: Row rejected, it violates a UNIQUE constraint of table %s.\n", loader->table);
+            return 0;
+        }
+    }
+
+    if (loader->has_reference) {
+        row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&row_root);
+        for (i = loader->num_attr - 1; i >= 0; i--) {
+            char value[MAX_VARCHAR_LENGTH];
+            memset(value, '\0', MAX_VARCHAR_LENGTH);
+            memcpy(value, data[i], size[i] < MAX_VARCHAR_LENGTH ? size[i] : MAX_VARCHAR_LENGTH - 1);
+            AK_Insert_New_Element(type[i], value, loader->table, loader->header[i].att_name, row_root);
+        }
+        if (AK_reference_check_entry(row_root) == EXIT_ERROR) {
+            printf("AK_bulk_load: Row rejected, reference integrity violation in table %s.\n", loader->table);
+            valid = 0;
+        }
+        AK_DeleteAll_L3(&row_root);
+        AK_free(row_root);
+        if (!valid)
+            return 0;
+    }
+
+    for (u = 0; u < loader->num_unique; u++)
+        if (length[u] >= 0)
+            AK_bulk_unique_add(&loader->unique[u], key[u], length[u], hash[u]);
+    return 1;
+}
+
+/**
+ * @brief  Function that allocates the extents a batch needs before it is written. The number of blocks is counted by
+ * packing the rows with the limits of the table writer.
+ * @param *loader bulk loader
+ * @param *valid 1 for the rows that are written
+ * @return No return value
+ */
+static void AK_bulk_load_reserve(AK_bulk_loader *loader, char *valid) {
+    AK_table_writer *writer = loader->writer;
+    int needed = 0, available, free_space = 0, id = 0, row_size, r, i, e;
+
+    for (r = 0; r < loader->num_rows; r++) {
+        if (!valid[r])
+            continue;
+        for (row_size = 0, i = 0; i < loader->num_attr; i++)
+            row_size += loader->size[r * loader->num_attr + i];
+        if (needed == 0 || (free_space != 0 && !(free_space < writer->max_free_space && id < writer->max_tuple_dict
+                && free_space + row_size <= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE && id + loader->num_attr <= DATA_BLOCK_SIZE))) {
+            needed++;
+            free_space = 0;
+            id = 0;
+        }
+        free_space += row_size;
+        id += loader->num_attr;
+    }
+
+    while (1) {
+        //blocks after the one being filled
+        available = writer->addresses->address_to[writer->extent] - writer->block - (writer->mem_block != NULL);
+        if (available < 0)
+            available = 0;
+        for (e = writer->extent + 1; e < MAX_EXTENTS_IN_SEGMENT && writer->addresses->address_from[e] != 0; e++)
+            available += writer->addresses->address_to[e] - writer->addresses->address_from[e];
+        if (available >= needed || e == MAX_EXTENTS_IN_SEGMENT)
+            break;
+        if (AK_init_new_extent(loader->table, SEGMENT_TYPE_TABLE) == EXIT_ERROR)
+            break;
+        AK_free(writer->addresses);
+        writer->addresses = (table_addresses *) AK_get_table_addresses(loader->table);
+    }
+}
+
+/**
+ * @brief  Function that validates and writes the buffered rows. Each block gets one redo log entry when the first
+ * row is written to it, the entry is committed when the load moves to the next block.
+ * @param *loader bulk loader
+ * @return EXIT_SUCCESS, EXIT_ERROR if rows could not be written
+ */
+static int AK_bulk_load_flush(AK_bulk_loader *loader) {
+    AK_table_writer *writer = loader->writer;
+    char *valid;
+    char *data[MAX_ATTRIBUTES];
+    int r, i, v, result = EXIT_SUCCESS;
+
+    if (loader->num_rows == 0)
+        return EXIT_SUCCESS;
+
+    valid = (char *) AK_malloc(loader->num_rows);
+    for (r = 0; r < loader->num_rows; r++) {
+        valid[r] = AK_bulk_load_check(loader, r);
+        if (!valid[r])
+            loader->rejected++;
+    }
+    AK_bulk_load_reserve(loader, valid);
+
+    for (r = 0; r < loader->num_rows; r++) {
+        if (!valid[r])
+            continue;
+        v = r * loader->num_attr;
+        for (i = 0; i < loader->num_attr; i++)
+            data[i] = loader->buffer + loader->offset[v + i];
+        if (AK_table_writer_append_values(writer, loader->type + v, loader->size + v, data) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+        if (writer->block != loader->log_block) {
+            if (loader->log_entry != EXIT_ERROR)
+                AK_redolog_commit();
+            loader->log_block = writer->block;
+            loader->log_entry = AK_add_to_redolog_bulk(loader->table, writer->block,
+                    writer->mem_block->block->last_tuple_dict_id - loader->num_attr + 1);
+        }
+        loader->loaded++;
+    }
+
+    AK_free(valid);
+    loader->num_rows = 0;
+    loader->buffer_used = 0;
+    return result;
+}
+
+/**
+ * @brief  Function that ends the row being buffered and writes the batch when it is full
+ * @return EXIT_SUCCESS, EXIT_ERROR if the batch could not be written
+ */
+static int AK_bulk_load_end_row(AK_bulk_loader *loader) {
+    loader->num_rows++;
+    if (loader->num_rows < AK_BULK_LOAD_BATCH)
+        return EXIT_SUCCESS;
+    return AK_bulk_load_flush(loader);
+}
+
+/**
+ * @brief  Function that drops the values of a rejected row from the buffer
+ * @param *loader bulk loader
+ * @param buffer_used buffer position at the start of the row
+ * @return EXIT_WARNING
+ */
+static int AK_bulk_load_reject(AK_bulk_loader *loader, int buffer_used) {
+    loader->buffer_used = buffer_used;
+    loader->rejected++;
+    return EXIT_WARNING;
+}
+
+/**
+ * @brief  Function that adds a row to a bulk load. The row is a list like the ones given to AK_insert_row,
+ * attributes without a value are null.
+ * @param *loader bulk loader
+ * @param *row_root list of elements which contain data of one row
+ * @return EXIT_SUCCESS, EXIT_WARNING if the row was rejected, EXIT_ERROR if the batch could not be written
+ */
+int AK_bulk_load_row(AK_bulk_loader *loader, struct list_node *row_root) {
+    struct list_node *el;
+    int i, size, start = loader->buffer_used, result;
+    AK_PRO;
+
+    for (i = 0; i < loader->num_attr; i++) {
+        for (el = row_root->next; el != NULL; el = el->next)
+            if (el->constraint == 0 && strcmp(el->attribute_name, loader->header[i].att_name) == 0)
+                break;
+        if (el == NULL) {
+            AK_bulk_load_put(loader, i, TYPE_VARCHAR, 4, "null");
+            continue;
+        }
+        if (el->type != loader->header[i].type && !AK_bulk_is_null(el->type, strlen(el->data), el->data)) {
+            printf("AK_bulk_load_row: Row rejected, wrong type of attribute %s of table %s.\n", loader->header[i].att_name, loader->table);
+            result = AK_bulk_load_reject(loader, start);
+            AK_EPI;
+            return result;
+        }
+        switch (el->type) {
+            case TYPE_INT:
+                size = sizeof (int);
+                break;
+            case TYPE_FLOAT:
+            case TYPE_NUMBER:
+                size = sizeof (double);
+                break;
+            case TYPE_VARCHAR:
+                size = strlen(el->data);
+                break;
+            default:
+                size = AK_type_size(el->type, el->data);
+                break;
+        }
+        AK_bulk_load_put(loader, i, el->type, size, el->data);
+    }
+    result = AK_bulk_load_end_row(loader);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that adds a row given as text to a bulk load. Values are converted to the types of the
+ * attributes, an empty value is null.
+ * @param *loader bulk loader
+ * @param **values values in header order
+ * @param num_values number of values
+ * @return EXIT_SUCCESS, EXIT_WARNING if the row was rejected, EXIT_ERROR if the batch could not be written
+ */
+int AK_bulk_load_values(AK_bulk_loader *loader, char **values, int num_values) {
+    int i, start = loader->buffer_used, result, integer;
+    double number;
+    float real;
+    char slot[sizeof (double)], *end;
+    AK_PRO;
+
+    if (num_values != loader->num_attr) {
+        printf("AK_bulk_load_values: Row rejected, it has %d values and table %s has %d attributes.\n", num_values, loader->table, loader->num_attr);
+        result = AK_bulk_load_reject(loader, start);
+        AK_EPI;
+        return result;
+    }
+
+    for (i = 0; i < loader->num_attr; i++) {
+        if (values[i] == NULL || values[i][0] == '\0') {
+            AK_bulk_load_put(loader, i, TYPE_VARCHAR, 4, "null");
+            continue;
+        }
+        end = NULL;
+        switch (loader->header[i].type) {
+            case TYPE_INT:
+                integer = (int) strtol(values[i], &end, 10);
+                AK_bulk_load_put(loader, i, TYPE_INT, sizeof (int), (char *) &integer);
+                break;
+            case TYPE_FLOAT:
+                //a float is kept in a value of AK_type_size(TYPE_FLOAT) bytes like in AK_insert_row
+                real = (float) strtod(values[i], &end);
+                memset(slot, 0, sizeof (double));
+                memcpy(slot, &real, sizeof (float));
+                AK_bulk_load_put(loader, i, TYPE_FLOAT, sizeof (double), slot);
+                break;
+            case TYPE_NUMBER:
+                number = strtod(values[i], &end);
+                AK_bulk_load_put(loader, i, TYPE_NUMBER, sizeof (double), (char *) &number);
+                break;
+            case TYPE_VARCHAR:
+                if (strlen(values[i]) < MAX_VARCHAR_LENGTH) {
+                    AK_bulk_load_put(loader, i, TYPE_VARCHAR, strlen(values[i]), values[i]);
+                    end = "";
+                }
+                break;
+            default:
+                break;
+        }
+        if (end == NULL || *end != '\0' || end == values[i]) {
+            printf("AK_bulk_load_values: Row rejected, wrong value '%s' of attribute %s of table %s.\n", values[i], loader->header[i].att_name, loader->table);
+            result = AK_bulk_load_reject(loader, start);
+            AK_EPI;
+            return result;
+        }
+    }
+    result = AK_bulk_load_end_row(loader);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that writes the buffered rows and ends a bulk load
+ * @param *loader bulk loader, may be NULL
+ * @return number of loaded rows, EXIT_ERROR if rows could not be written
+ */
+int AK_bulk_load_close(AK_bulk_loader *loader) {
+    int result, u;
+    AK_PRO;
+    if (loader == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    result = AK_bulk_load_flush(loader);
+    AK_table_writer_close(loader->writer);
+    if (loader->log_entry != EXIT_ERROR)
+        AK_redolog_commit();
+    if (result != EXIT_ERROR)
+        result = loader->loaded;
+    AK_dbg_messg(LOW, FILE_MAN, "AK_bulk_load_close: %d rows loaded into %s, %d rejected\n", loader->loaded, loader->table, loader->rejected);
+
+    for (u = 0; u < loader->num_unique; u++) {
+        AK_free(loader->unique[u].bucket);
+        AK_free(loader->unique[u].keys);
+        AK_free(loader->unique[u].data);
+    }
+    AK_free(loader->header);
+    AK_free(loader->type);
+    AK_free(loader->size);
+    AK_free(loader->offset);
+    AK_free(loader->buffer);
+    AK_free(loader);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that loads an array of rows into a table
+ * @param *table table name
+ * @param **rows rows as lists like the ones given to AK_insert_row
+ * @param num_rows number of rows
+ * @return number of loaded rows, EXIT_ERROR if the table does not exist or rows could not be written
+ */
+int AK_bulk_load_rows(char *table, struct list_node **rows, int num_rows) {
+    int r, result = EXIT_SUCCESS;
+    AK_PRO;
+    AK_bulk_loader *loader = AK_bulk_load_open(table);
+    if (loader == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (r = 0; r < num_rows && result != EXIT_ERROR; r++)
+        result = AK_bulk_load_row(loader, rows[r]);
+    r = AK_bulk_load_close(loader);
+    AK_EPI;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : r;
+}
+
+/**
+ * @brief  Function that reads one CSV record
+ * @param *stream CSV input
+ * @param delimiter field delimiter
+ * @param fields buffers for the fields
+ * @param *num_fields number of fields read, -1 if a field is too long or there are too many fields
+ * @return 1 if a record was read, 0 at the end of the input
+ */
+static int AK_bulk_load_csv_record(FILE *stream, char delimiter, char fields[][MAX_VARCHAR_LENGTH], int *num_fields) {
+    int c, field = 0, length = 0, quoted = 0, overflow = 0, any = 0;
+
+    while (1) {
+        c = getc(stream);
+        if (c == EOF) {
+            if (!any)
+                return 0;
+            break;
+        }
+        any = 1;
+        if (quoted) {
+            if (c == '"') {
+                c = getc(stream);
+                if (c != '"') {
+                    quoted = 0;
+                    if (c == EOF)
+                        break;
+                    ungetc(c, stream);
+                    continue;
+                }
+            }
+        } else if (c == '"' && length == 0) {
+            quoted = 1;
+            continue;
+        } else if (c == delimiter || c == '\n') {
+            if (field < MAX_ATTRIBUTES)
+                fields[field][length] = '\0';
+            else
+                overflow = 1;
+            field++;
+            length = 0;
+            if (c == '\n')
+                break;
+            continue;
+        } else if (c == '\r') {
+            continue;
+        }
+        if (field < MAX_ATTRIBUTES && length < MAX_VARCHAR_LENGTH - 1)
+            fields[field][length++] = (char) c;
+        else
+            overflow = 1;
+    }
+    if (c == EOF) {
+        if (field < MAX_ATTRIBUTES)
+            fields[field][length] = '\0';
+        else
+            overflow = 1;
+        field++;
+    }
+    *num_fields = overflow ? -1 : field;
+    return 1;
+}
+
+/**
+ * @brief  Function that loads CSV text into a table. Fields may be quoted with double quotes, a quote inside
+ * a quoted field is written twice.
+ * @param *table table name
+ * @param *stream CSV input
+ * @param delimiter field delimiter
+ * @param header 1 if the first line holds the attribute names and is skipped
+ * @return number of loaded rows, EXIT_ERROR if the table does not exist or rows could not be written
+ */
+int AK_bulk_load_csv_stream(char *table, FILE *stream, char delimiter, int header) {
+    char fields[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    char *values[MAX_ATTRIBUTES];
+    int num_fields, i, result = EXIT_SUCCESS, line = 0;
+    AK_PRO;
+
+    AK_bulk_loader *loader = AK_bulk_load_open(table);
+    if (loader == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+        values[i] = fields[i];
+
+    while (result != EXIT_ERROR && AK_bulk_load_csv_record(stream, delimiter, fields, &num_fields)) {
+        line++;
+        if (line == 1 && header)
+            continue;
+        if (num_fields == 1 && fields[0][0] == '\0')
+            continue;
+        if (num_fields < 0) {
+            printf("AK_bulk_load_csv_stream: Row rejected, record %d has a field that is too long or too many fields.\n", line);
+            loader->rejected++;
+            continue;
+        }
+        result = AK_bulk_load_values(loader, values, num_fields);
+    }
+
+    i = AK_bulk_load_close(loader);
+    AK_EPI;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : i;
+}
+
+/**
+ * @brief  Function that loads a CSV file into a table
+ * @param *table table name
+ * @param *file_name name of the CSV file
+ * @param delimiter field delimiter
+ * @param header 1 if the first line holds the attribute names and is skipped
+ * @return number of loaded rows, EXIT_ERROR if the file cannot be read or rows could not be written
+ */
+int AK_bulk_load_csv(char *table, char *file_name, char delimiter, int header) {
+    FILE *stream;
+    int result;
+    AK_PRO;
+    stream = fopen(file_name, "r");
+    if (stream == NULL) {
+        printf("AK_bulk_load_csv: ERROR. Cannot open file %s.\n", file_name);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    result = AK_bulk_load_csv_stream(table, stream, delimiter, header);
+    fclose(stream);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that finds the value of the second attribute of the row whose first attribute is the given integer
+ * @return 1 if the row exists and the value is the expected one, 0 otherwise
+ */
+static int AK_bulk_load_test_value(char *table, int id, char *expected) {
+    AK_table_cursor *cursor = AK_table_cursor_open(table);
+    struct list_node *row;
+    int found = 0;
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (row->next->type == TYPE_INT && *((int *) row->next->data) == id) {
+            found = (strlen(expected) == row->next->next->size && memcmp(row->next->next->data, expected, strlen(expected)) == 0);
+            break;
+        }
+    }
+    AK_table_cursor_close(cursor);
+    return found;
+}
+
+/**
+ * @brief  Function for testing the bulk load. Compares the insert rate of AK_insert_row and of a CSV bulk load of the
+ * same rows, loads rows given as lists with missing values, then loads CSV text into a table with NOT NULL and UNIQUE
+ * constraints.
+ * @return test result
+ */
+TestResult AK_bulk_load_test() {
+    char *insertTable = "bulk_load_insert", *bulkTable = "bulk_load_rows", *csvTable = "bulk_load_csv";
+    char *csvFile = "bulk_load_test.csv";
+    int num_inserts = 300, num_rows = 10000, num_lists = 100;
+    int i, ok = 0, fail = 0, loaded, value;
+    long long sum = 0;
+    double start, insert_rate, bulk_rate;
+    char *values[2];
+    AK_header header[5] = {
+        {TYPE_INT, "a", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "b", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "c", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "d", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    AK_header csvHeader[3] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    AK_bulk_loader *loader;
+    AK_table_cursor *cursor;
+    struct list_node *row, *rows[100];
+    FILE *csv;
+    AK_PRO;
+
+    AK_initialize_new_segment(insertTable, SEGMENT_TYPE_TABLE, header);
+    AK_initialize_new_segment(bulkTable, SEGMENT_TYPE_TABLE, header);
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+
+    start = TEST_time_ms();
+    for (i = 0; i < num_inserts; i++) {
+        AK_DeleteAll_L3(&row_root);
+        AK_Insert_New_Element(TYPE_INT, &i, insertTable, "a", row_root);
+        AK_Insert_New_Element(TYPE_INT, &i, insertTable, "b", row_root);
+        AK_Insert_New_Element(TYPE_INT, &i, insertTable, "c", row_root);
+        AK_Insert_New_Element(TYPE_INT, &i, insertTable, "d", row_root);
+        AK_insert_row(row_root);
+    }
+    insert_rate = num_inserts / ((TEST_time_ms() - start) / 1000.0);
+
+    csv = fopen(csvFile, "w");
+    for (i = 0; i < num_rows; i++)
+        fprintf(csv, "%d,%d,%d,%d\n", i, i, i, i);
+    fclose(csv);
+    start = TEST_time_ms();
+    loaded = AK_bulk_load_csv(bulkTable, csvFile, ',', 0);
+    bulk_rate = num_rows / ((TEST_time_ms() - start) / 1000.0);
+    remove(csvFile);
+    printf("\n%-20s %12s\n", "", "rows/s");
+    printf("%-20s %12.0f\n", "AK_insert_row", insert_rate);
+    printf("%-20s %12.0f\n", "bulk load (CSV)", bulk_rate);
+    printf("speedup: %.1fx\n\n", bulk_rate / insert_rate);
+
+    //rows given as lists go after the loaded ones
+    for (i = 0; i < num_lists; i++) {
+        value = num_rows + i;
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &value, bulkTable, "a", rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &value, bulkTable, "d", rows[i]);
+    }
+    if (loaded == num_rows)
+        loaded += AK_bulk_load_rows(bulkTable, rows, num_lists);
+    for (i = 0; i < num_lists; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+
+    cursor = AK_table_cursor_open(bulkTable);
+    for (value = 0; (row = AK_table_cursor_next(cursor)) != NULL; value++)
+        sum += *((int *) row->next->data);
+    AK_table_cursor_close(cursor);
+    if (loaded == num_rows + num_lists && value == loaded && sum == (long long) loaded * (loaded - 1) / 2)
+        ok++;
+    else {
+        printf("AK_bulk_load_test: ERROR. Loaded %d of %d rows into %s, table has %d rows.\n", loaded, num_rows + num_lists, bulkTable, value);
+        fail++;
+    }
+
+    //CSV with a duplicate key, a null in a NOT NULL attribute and a value of a wrong type
+    AK_initialize_new_segment(csvTable, SEGMENT_TYPE_TABLE, csvHeader);
+    AK_set_constraint_unique(csvTable, "id", "bulk_load_csv_id_unique");
+    AK_set_constraint_not_null(csvTable, "name", "bulk_load_csv_name_not_null");
+    csv = fopen(csvFile, "w");
+    fprintf(csv, "id,name\n1,alpha\n2,\"be\"\"ta\"\n2,gamma\n3,\nx,delta\n4,\"multi, comma\"\n");
+    fclose(csv);
+    loaded = AK_bulk_load_csv(csvTable, csvFile, ',', 1);
+    remove(csvFile);
+    if (loaded == 3 && AK_get_num_records(csvTable) == 3 && AK_bulk_load_test_value(csvTable, 2, "be\"ta")
+            && AK_bulk_load_test_value(csvTable, 4, "multi, comma"))
+        ok++;
+    else {
+        printf("AK_bulk_load_test: ERROR. Wrong CSV load into %s, %d rows loaded.\n", csvTable, loaded);
+        fail++;
+    }
+
+    //keys already in the table are checked as well
+    loader = AK_bulk_load_open(csvTable);
+    values[0] = "1";
+    values[1] = "again";
+    i = AK_bulk_load_values(loader, values, 2);
+    values[0] = "5";
+    values[1] = "epsilon";
+    AK_bulk_load_values(loader, values, 2);
+    loaded = AK_bulk_load_close(loader);
+    if (loaded == 1 && AK_get_num_records(csvTable) == 4 && AK_bulk_load_test_value(csvTable, 5, "epsilon")
+            && AK_bulk_load_test_value(csvTable, 1, "alpha"))
+        ok++;
+    else {
+        printf("AK_bulk_load_test: ERROR. Existing UNIQUE key loaded into %s, %d rows loaded.\n", csvTable, loaded);
+        fail++;
+    }
+    AK_print_table(csvTable);
+
+    AK_delete_constraint_unique(csvTable, "id", "bulk_load_csv_id_unique");
+    AK_delete_constraint_not_null(csvTable, "name", "bulk_load_csv_name_not_null");
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_delete_segment(insertTable, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(bulkTable, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(csvTable, SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
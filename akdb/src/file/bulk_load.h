@@ -0,0 +1,174 @@
+/**
+@file bulk_load.h Header file that provides data structures and functions for loading many rows into a table at once
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BULK_LOAD
+#define BULK_LOAD
+
+#include "../auxi/test.h"
+#include "../mm/memoman.h"
+#include "../dm/dbman.h"
+#include "../rec/redo_log.h"
+#include "../sql/cs/reference.h"
+#include "../sql/cs/unique.h"
+#include "../sql/cs/nnull.h"
+#include "table.h"
+#include "files.h"
+#include "fileio.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @def AK_BULK_LOAD_BATCH
+ * @brief Constant declaring the number of rows that are validated and written together
+ */
+#define AK_BULK_LOAD_BATCH 1024
+
+/**
+ * @def AK_BULK_LOAD_MAX_UNIQUE
+ * @brief Constant declaring the maximum number of UNIQUE constraints of a table checked by a bulk load
+ */
+#define AK_BULK_LOAD_MAX_UNIQUE 8
+
+/**
+ * @struct AK_bulk_key
+ * @brief Structure that defines one key of a UNIQUE constraint kept in memory during a bulk load
+ */
+typedef struct {
+    unsigned int hash;
+    /// next key in the same bucket, -1 at the end
+    int next;
+    /// position of the key bytes in the key buffer
+    int offset;
+    int length;
+} AK_bulk_key;
+
+/**
+ * @struct AK_bulk_unique
+ * @brief Structure that defines a UNIQUE constraint and the set of keys already in the table or in the load
+ */
+typedef struct {
+    int num_attr;
+    int attr[MAX_ATTRIBUTES];
+    int num_buckets;
+    int *bucket;
+    int num_keys;
+    int max_keys;
+    AK_bulk_key *keys;
+    char *data;
+    int data_used;
+    int data_size;
+} AK_bulk_unique;
+
+/**
+ * @struct AK_bulk_loader
+ * @brief Structure that defines a bulk load into a table. Rows are buffered, validated a batch at a time and
+ * packed into fresh blocks with one redo log entry per block.
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    int num_attr;
+    AK_header *header;
+    AK_table_writer *writer;
+    /// 1 for attributes with a NOT NULL constraint
+    int not_null[MAX_ATTRIBUTES];
+    int num_unique;
+    AK_bulk_unique unique[AK_BULK_LOAD_MAX_UNIQUE];
+    /// 1 if the table references another table
+    int has_reference;
+    /// rows of the current batch, num_attr values per row
+    int num_rows;
+    int *type;
+    int *size;
+    int *offset;
+    char *buffer;
+    int buffer_used;
+    int buffer_size;
+    /// block that is being filled and its redo log entry
+    int log_block;
+    int log_entry;
+    int loaded;
+    int rejected;
+} AK_bulk_loader;
+
+/**
+ * @brief  Function that starts a bulk load into a table. The constraints of the table are read once, the rows are
+ * written after the last used block of the table.
+ * @param *table table name
+ * @return bulk loader, NULL if the table does not exist
+ */
+AK_bulk_loader *AK_bulk_load_open(char *table);
+
+/**
+ * @brief  Function that adds a row to a bulk load. The row is a list like the ones given to AK_insert_row,
+ * attributes without a value are null.
+ * @param *loader bulk loader
+ * @param *row_root list of elements which contain data of one row
+ * @return EXIT_SUCCESS, EXIT_WARNING if the row was rejected, EXIT_ERROR if the batch could not be written
+ */
+int AK_bulk_load_row(AK_bulk_loader *loader, struct list_node *row_root);
+
+/**
+ * @brief  Function that adds a row given as text to a bulk load. Values are converted to the types of the
+ * attributes, an empty value is null.
+ * @param *loader bulk loader
+ * @param **values values in header order
+ * @param num_values number of values
+ * @return EXIT_SUCCESS, EXIT_WARNING if the row was rejected, EXIT_ERROR if the batch could not be written
+ */
+int AK_bulk_load_values(AK_bulk_loader *loader, char **values, int num_values);
+
+/**
+ * @brief  Function that writes the buffered rows and ends a bulk load
+ * @param *loader bulk loader, may be NULL
+ * @return number of loaded rows, EXIT_ERROR if rows could not be written
+ */
+int AK_bulk_load_close(AK_bulk_loader *loader);
+
+/**
+ * @brief  Function that loads an array of rows into a table
+ * @param *table table name
+ * @param **rows rows as lists like the ones given to AK_insert_row
+ * @param num_rows number of rows
+ * @return number of loaded rows, EXIT_ERROR if the table does not exist or rows could not be written
+ */
+int AK_bulk_load_rows(char *table, struct list_node **rows, int num_rows);
+
+/**
+ * @brief  Function that loads CSV text into a table. Fields may be quoted with double quotes, a quote inside
+ * a quoted field is written twice.
+ * @param *table table name
+ * @param *stream CSV input
+ * @param delimiter field delimiter
+ * @param header 1 if the first line holds the attribute names and is skipped
+ * @return number of loaded rows, EXIT_ERROR if the table does not exist or rows could not be written
+ */
+int AK_bulk_load_csv_stream(char *table, FILE *stream, char delimiter, int header);
+
+/**
+ * @brief  Function that loads a CSV file into a table
+ * @param *table table name
+ * @param *file_name name of the CSV file
+ * @param delimiter field delimiter
+ * @param header 1 if the first line holds the attribute names and is skipped
+ * @return number of loaded rows, EXIT_ERROR if the file cannot be read or rows could not be written
+ */
+int AK_bulk_load_csv(char *table, char *file_name, char delimiter, int header);
+
+TestResult AK_bulk_load_test();
+
+#endif
@@ -17,6 +17,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 #include "fileio.h"
+#include "idx/btree.h"
+#include "idx/hash.h"
+#include "idx/bitmap.h"
 
 //START SPECIAL FUNCTIONS FOR WORK WITH row_element_structure
 
@@ -116,7 +119,7 @@ int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block)
 
     while (strcmp(temp_block->header[head].att_name, "\0") != 0)
     { //inserting values of the list one by one
-        while (temp_block->tuple_dict[id].size != FREE_INT)
+        while (AK_tuple_size(temp_block, id) != FREE_INT)
         { //searches for AK_free tuple dict, maybe it can be last_tuple_dict_id
             id++;
         }
@@ -156,7 +159,7 @@ int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block)
         temp_block->tuple_dict[id].type = type;
         temp_block->tuple_dict[id].size = AK_type_size(type, entry_data);
 
-        memcpy(entry_data, temp_block->data + temp_block->tuple_dict[id].address, temp_block->tuple_dict[id].size);
+        AK_tuple_copy(temp_block, id, entry_data);
 
         AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data, AK_type_size(type, entry_data));
         head++; //go to next header
@@ -193,39 +196,36 @@ int AK_insert_row(struct list_node *row_root)
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start inserting data\n");
     struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
     char table[MAX_ATT_NAME];
-    table_addresses *table_addresses_return;
 
     memset(table, '\0', MAX_ATT_NAME);
     memcpy(&table, some_element->table, strlen(some_element->table));
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
     int adr_to_write;
-    table_addresses_return = AK_get_table_addresses(table);
-    adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
-    AK_free(table_addresses_return);
+    adr_to_write = AK_find_table_free_space(table);
 
     if (adr_to_write == -1)
         adr_to_write = (int)AK_init_new_extent(table, SEGMENT_TYPE_TABLE);
-    if (strstr(some_element->table, "_bmapIndex"))
-    {
-        table_addresses_return = AK_get_index_addresses(table);
-        adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
-        AK_free(table_addresses_return);
-    }
 
-    if (adr_to_write == 0)
+    if (adr_to_write == 0 || adr_to_write == EXIT_ERROR)
     {
         AK_EPI;
         return EXIT_ERROR;
     }
 
-    table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
     AK_mem_block *mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
 
     int end = (int)AK_insert_row_to_block(row_root, mem_block->block);
+    AK_fsm_update(mem_block->block);
 
     if (end == EXIT_SUCCESS)
+    {
         AK_redolog_commit();
+        //the row takes the last tuples used in the block
+        AK_btree_index_tuple(table, mem_block->block, mem_block->block->last_tuple_dict_id - AK_num_attr(table) + 1);
+        AK_hash_index_tuple(table, mem_block->block, mem_block->block->last_tuple_dict_id - AK_num_attr(table) + 1);
+        AK_bitmap_index_tuple(table, mem_block->block, mem_block->block->last_tuple_dict_id - AK_num_attr(table) + 1);
+    }
 
     AK_mem_block_modify(mem_block, BLOCK_DIRTY);
     AK_EPI;
@@ -266,7 +266,7 @@ void AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         while (strcmp(temp_block->header[head].att_name, "\0") != 0)
         { //going through headers
 
-            some_element = row_root;
+            some_element = (struct list_node *)AK_First_L2(row_root);
             while (some_element)
             {
                 if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
@@ -276,8 +276,7 @@ void AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
                     if (overflow < (temp_block->AK_free_space + 1) && overflow > -1)
                     {
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
+                        AK_tuple_copy(temp_block, i, entry_data);
 
                         // if the data in table isn't equal to data in attribute which is used for search, it won't be updated
                         if (strcmp(entry_data, some_element->data) != 0)
@@ -295,6 +294,8 @@ void AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         if (exists_equal_attrib == 1 && del == 1)
         {
             int j;
+            //bitmap indexes are exact, the row leaves the bitmaps of its old values before it changes
+            AK_bitmap_unindex_tuple(((struct list_node *)AK_First_L2(row_root))->table, temp_block, i - attPlace);
             for (j = i - attPlace; j < i + head - attPlace; j++)
             {
                 AK_DeleteAll_L3(&new_data);
@@ -305,7 +306,7 @@ void AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                     memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
                     memcpy(entry_data, temp_block->data + a, s);
                 }
-                some_element = row_root;
+                some_element = (struct list_node *)AK_First_L2(row_root);
 
                 while (some_element)
                 {
@@ -342,6 +343,10 @@ void AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                     some_element = some_element->next;
                 }
             }
+            //a row updated in place keeps its address, the indexes get entries for its new values
+            AK_btree_index_tuple(((struct list_node *)AK_First_L2(row_root))->table, temp_block, i - attPlace);
+            AK_hash_index_tuple(((struct list_node *)AK_First_L2(row_root))->table, temp_block, i - attPlace);
+            AK_bitmap_index_tuple(((struct list_node *)AK_First_L2(row_root))->table, temp_block, i - attPlace);
         }
         del = 1;
     }
@@ -391,7 +396,7 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
         while (strcmp(temp_block->header[head].att_name, "\0") != 0)
         { //going through headers
-            some_element = row_root;
+            some_element = (struct list_node *)AK_First_L2(row_root);
 
             while (some_element)
             {
@@ -404,9 +409,7 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
                     if ((overflow < (temp_block->AK_free_space + 1)) && (overflow > -1))
                     {
-                        //before there was for loop to clear (check if memset works correct)
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
+                        AK_tuple_copy(temp_block, i, entry_data);
 
                         if (strcmp(entry_data, some_element->data) != 0)
                             del = 0; //if one constraint doesn't metch we dont delete or update
@@ -421,6 +424,7 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
         if ((exists_equal_attrib == 1) && (del == 1))
         {
+            AK_bitmap_unindex_tuple(((struct list_node *)AK_First_L2(row_root))->table, temp_block, i - attPlace);
             for (int j = i - attPlace; j < i + head - attPlace; j++)
             { //delete one row
 
@@ -681,3 +685,95 @@ TestResult AK_fileio_test()
     AK_EPI;
     return TEST_result(ok, fail);
 }
+
+/**
+ * @brief Function for testing the free-space map. Fills a table through AK_insert_row past its first extent and
+ * reports the insert rate and the number of block requests per row as the table grows, which stay flat because
+ * the full blocks are skipped through the map.
+ * @return test result
+ */
+TestResult AK_fsm_test()
+{
+    char *tblName = "fsm_test";
+    int num_rows = 3000, batch = 500;
+    int i, j, ok = 0, fail = 0, full = 0, num_extents = 0, last_block = 0, value;
+    unsigned long requests;
+    double start;
+    AK_header header[5] = {
+        {TYPE_INT, "a", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "b", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "c", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "d", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    table_addresses *addresses;
+    AK_PRO;
+
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    struct list_node *row_root = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+
+    printf("\n%10s %12s %20s\n", "rows", "rows/s", "block requests/row");
+    for (i = 0; i < num_rows; i += batch)
+    {
+        requests = db_cache->hits + db_cache->misses;
+        start = TEST_time_ms();
+        for (j = i; j < i + batch; j++)
+        {
+            AK_DeleteAll_L3(&row_root);
+            AK_Insert_New_Element(TYPE_INT, &j, tblName, "a", row_root);
+            AK_Insert_New_Element(TYPE_INT, &j, tblName, "b", row_root);
+            AK_Insert_New_Element(TYPE_INT, &j, tblName, "c", row_root);
+            AK_Insert_New_Element(TYPE_INT, &j, tblName, "d", row_root);
+            if (AK_insert_row(row_root) != EXIT_SUCCESS)
+                break;
+        }
+        if (j < i + batch)
+        {
+            printf("AK_fsm_test: ERROR. Cannot insert row %d into table %s.\n", j, tblName);
+            fail++;
+            break;
+        }
+        printf("%10d %12.0f %20.1f\n", i + batch, batch / ((TEST_time_ms() - start) / 1000.0),
+               (double)(db_cache->hits + db_cache->misses - requests) / batch);
+    }
+
+    //every block before the last written one is full, and the map knows it
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+    {
+        num_extents++;
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++)
+            if (AK_get_block(j)->block->last_tuple_dict_id > 0)
+                last_block = j;
+    }
+    for (i = 0; i < num_extents; i++)
+        for (j = addresses->address_from[i]; j < addresses->address_to[i] && j < last_block; j++)
+            if (AK_fsm_get(j) == AK_FSM_FULL)
+                full++;
+            else
+                printf("AK_fsm_test: ERROR. Block %d before the last written block %d is not full in the map.\n", j, last_block);
+    AK_free(addresses);
+
+    value = AK_get_num_records(tblName);
+    printf("\nTable %s: %d rows in %d extents, %d full blocks\n", tblName, value, num_extents, full);
+    if (value == num_rows)
+        ok++;
+    else
+    {
+        printf("AK_fsm_test: ERROR. Table %s has %d rows instead of %d.\n", tblName, value, num_rows);
+        fail++;
+    }
+    if (num_extents > 1 && full > 0 && AK_fsm_get(last_block) != AK_FSM_FULL)
+        ok++;
+    else
+    {
+        printf("AK_fsm_test: ERROR. Wrong free-space map of table %s.\n", tblName);
+        fail++;
+    }
+
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
@@ -119,6 +119,7 @@ int AK_delete_row(struct list_node *row_root) ;
 */
 int AK_update_row(struct list_node *row_root);
 TestResult AK_fileio_test();
+TestResult AK_fsm_test();
 
 /**
  *@author Dražen Bandić
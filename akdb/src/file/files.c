@@ -60,6 +60,7 @@ int AK_initialize_new_segment(char *name, int type, AK_header *header) {
         AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
 
         AK_insert_row(row_root);
+        AK_catalog_invalidate(name);
 
         AK_dbg_messg(LOW, FILE_MAN, "AK_init_new_segment__NOTIFICATION: New segment initialized at %d\n", start_address);
 		AK_DeleteAll_L3(&row_root);
@@ -74,15 +75,16 @@ int AK_initialize_new_segment(char *name, int type, AK_header *header) {
 
 /**
  * @author Tomislav Fotak, updated by Matija Šestak (function now uses caching), reused by Lovro Predovan
- * @brief Function that initializes a new segment and writes its start and finish address in system catalog table.
- *  For creting new table, index, temporary table, etc. call this function
+ * @brief Function that initializes a new index segment and writes its start and finish address in the AK_index
+ *  system catalog table
  * @param name segment name
- * @param type segment type
+ * @param table_id obj_id of the indexed table
+ * @param attr_id index of the indexed attribute
  * @param header pointer to header that should be written to the new extent (all blocks)
  * @return start address of new segment
  */
 
-int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK_header *header) {
+int AK_initialize_new_index_segment(char *name, int table_id, int attr_id, AK_header *header) {
 
     int start_address = -1;
     int end_address = INITIAL_EXTENT_SIZE;
@@ -94,7 +96,7 @@ int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK
 
     char *sys_table;
     sys_table = "AK_index";
-    char type = SEGMENT_TYPE_TABLE;
+    char type = SEGMENT_TYPE_INDEX;
 
     if ((start_address = AK_new_segment(name, type, header)) == EXIT_ERROR) {
         AK_dbg_messg(LOW, FILE_MAN, "AK_init_new_segment__ERROR: Cannot initialize segment!\n");
@@ -113,10 +115,11 @@ int AK_initialize_new_index_segment(char *name, char *table_id, int attr_id , AK
         AK_Insert_New_Element(TYPE_VARCHAR, name, sys_table, "name", row_root);
         AK_Insert_New_Element(TYPE_INT, &start_address, sys_table, "start_address", row_root);
         AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
-        AK_Insert_New_Element(TYPE_VARCHAR, table_id, sys_table, "table_id", row_root);
+        AK_Insert_New_Element(TYPE_INT, &table_id, sys_table, "table_id", row_root);
         AK_Insert_New_Element(TYPE_INT, &attr_id, sys_table, "attribute_id", row_root);
 
         AK_insert_row(row_root);
+        AK_catalog_invalidate(name);
 
         AK_dbg_messg(LOW, FILE_MAN, "AK_init_new_segment__NOTIFICATION: New segment initialized at %d\n", start_address);
         AK_EPI;
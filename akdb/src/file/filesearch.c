@@ -17,6 +17,223 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 #include "filesearch.h"
+#include "idx/btree.h"
+
+/**
+  * @brief Function that checks whether a tuple matches all search parameters
+  * @param block block of the tuple
+  * @param i tuple_dict index of the first attribute of the tuple
+  * @param aspParams array of search parameters
+  * @param iNum_search_params number of search parameters
+  * @param aiSearch_attributes indexes of the searched-for attributes
+  * @return 1 if the tuple matches, 0 otherwise
+ */
+static int AK_search_tuple_matches(AK_block *block, int i, search_params *aspParams, int iNum_search_params, int *aiSearch_attributes) {
+    int j, iTupleMatches = 1;
+
+    for (j = 0; j < iNum_search_params && iTupleMatches; j++) {
+        switch (aspParams[j].iSearchType) {
+            case SEARCH_PARTICULAR:
+            {
+                size_t iSearchAttributeValueSize = AK_type_size(block->header[aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
+
+                if (block->tuple_dict[i + aiSearch_attributes[j]].size != iSearchAttributeValueSize
+                        || memcmp(block->data + block->tuple_dict[i + aiSearch_attributes[j]].address, aspParams[j].pData_lower, iSearchAttributeValueSize)) {
+                    iTupleMatches = 0;
+                }
+            }
+                break;
+
+            case SEARCH_RANGE:
+            {
+
+                switch (block->tuple_dict[i + aiSearch_attributes[j]].type) {
+                    case TYPE_INT:
+                    case TYPE_DATE:
+                    case TYPE_DATETIME:
+                    case TYPE_TIME:
+                    {
+                        int iAttributeValue = *((int *) (block->data + block->tuple_dict[i + aiSearch_attributes[j]].address));
+                        if (iAttributeValue < *((int *) aspParams[j].pData_lower)
+                                || iAttributeValue > *((int *) aspParams[j].pData_upper)) {
+                            iTupleMatches = 0;
+                        }
+                    }
+                        break;
+
+                    case TYPE_FLOAT:
+                    case TYPE_NUMBER:
+                        if (*((double *) (block->data + block->tuple_dict[i + aiSearch_attributes[j]].address)) < *((double *) aspParams[j].pData_lower)
+                                || *((double *) (block->data + block->tuple_dict[i + aiSearch_attributes[j]].address)) > *((double *) aspParams[j].pData_upper)) {
+                            iTupleMatches = 0;
+                        }
+                        break;
+
+                    default: // other types unsupported
+                        iTupleMatches = 0;
+                }
+            }
+                break;
+
+            case SEARCH_ALL: // iTupleMatches is already == 1, no action needed
+                break;
+
+            case SEARCH_NULL:
+            {
+                size_t iSearchAttributeValueSize = AK_type_size(block->header[aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
+
+                if (block->tuple_dict[i + aiSearch_attributes[j]].type != TYPE_VARCHAR
+                        || iSearchAttributeValueSize != strlen("NULL")
+                        || memcmp(block->data + block->tuple_dict[i + aiSearch_attributes[j]].address, "NULL", strlen("NULL")))
+                    iTupleMatches = 0;
+            }
+                break;
+
+            default:
+                iTupleMatches = 0;
+        }
+    }
+
+    return iTupleMatches;
+}
+
+/**
+  * @brief Function that adds a tuple address to a search result
+  * @param srResult search result
+  * @param iBlock block of the tuple
+  * @param i tuple_dict index of the first attribute of the tuple
+  * @return No return value
+ */
+static void AK_search_add_tuple(search_result *srResult, int iBlock, int i) {
+    srResult->iNum_tuple_addresses++;
+    srResult->aiTuple_addresses = (int *) AK_realloc(srResult->aiTuple_addresses, srResult->iNum_tuple_addresses * sizeof (int));
+
+    if (srResult->aiTuple_addresses == NULL) {
+        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiTuple_addresses, iteration %d.\n", i);
+        exit(EXIT_ERROR);
+    }
+
+    srResult->aiBlocks = (int *) AK_realloc(srResult->aiBlocks, srResult->iNum_tuple_addresses * sizeof (int));
+    if (srResult->aiBlocks == NULL) {
+        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiBlocks, iteration %d.\n", i);
+        exit(EXIT_ERROR);
+    }
+
+    srResult->aiTuple_addresses[srResult->iNum_tuple_addresses - 1] = i;
+    srResult->aiBlocks[srResult->iNum_tuple_addresses - 1] = iBlock;
+}
+
+/**
+  * @brief Function that compares row addresses by block and tuple, used to sort the rows found in a B+tree index
+  * @param a first row address
+  * @param b second row address
+  * @return negative value, zero or positive value if a is before, equal to or after b
+ */
+static int AK_search_compare_rows(const void *a, const void *b) {
+    const struct_add *x = a, *y = b;
+    if (x->addBlock != y->addBlock)
+        return (x->addBlock > y->addBlock) - (x->addBlock < y->addBlock);
+    return (x->indexTd > y->indexTd) - (x->indexTd < y->indexTd);
+}
+
+/**
+  * @brief Function that searches a relation through a B+tree index on one of the searched-for attributes. The first
+           SEARCH_PARTICULAR or SEARCH_RANGE parameter on an indexed attribute narrows the rows read, every row found
+           is checked against all parameters since the index may still hold entries of deleted or changed rows.
+  * @param szRelation relation name
+  * @param aspParams array of search parameters
+  * @param iNum_search_params number of search parameters
+  * @param srResult search result the matched tuples are added to, in block and tuple order
+  * @return EXIT_SUCCESS, EXIT_WARNING if no parameter can use an index
+ */
+static int AK_search_index(char *szRelation, search_params *aspParams, int iNum_search_params, search_result *srResult) {
+    AK_header *header;
+    AK_btree_range range;
+    AK_mem_block *mem_block;
+    struct_add *rows = NULL;
+    char indexName[MAX_VARCHAR_LENGTH];
+    unsigned char lower[AK_BTREE_MAX_VALUE], upper[AK_BTREE_MAX_VALUE];
+    int *aiSearch_attributes;
+    int iNum_attributes, i, j, type, size, lower_length, upper_length, num_rows;
+
+    if ((header = AK_get_header(szRelation)) == NULL)
+        return EXIT_WARNING;
+    for (iNum_attributes = 0; iNum_attributes < MAX_ATTRIBUTES && header[iNum_attributes].att_name[0] != FREE_CHAR; iNum_attributes++)
+        ;
+
+    aiSearch_attributes = (int *) AK_malloc(iNum_search_params * sizeof (int));
+    for (j = 0; j < iNum_search_params; j++) {
+        for (i = 0; i < iNum_attributes && strcmp(header[i].att_name, aspParams[j].szAttribute); i++)
+            ;
+        /// the scan returns an empty result for unknown attributes
+        if (i == iNum_attributes) {
+            AK_free(aiSearch_attributes);
+            AK_free(header);
+            return EXIT_WARNING;
+        }
+        aiSearch_attributes[j] = i;
+    }
+
+    lower_length = upper_length = EXIT_ERROR;
+    for (j = 0; j < iNum_search_params; j++) {
+        type = header[aiSearch_attributes[j]].type;
+        if (AK_btree_find_index(szRelation, aiSearch_attributes[j], indexName) != EXIT_SUCCESS)
+            continue;
+
+        if (aspParams[j].iSearchType == SEARCH_PARTICULAR) {
+            size = AK_type_size(type, (char *) aspParams[j].pData_lower);
+            lower_length = upper_length = AK_btree_encode_value(type, (char *) aspParams[j].pData_lower, size, lower);
+            memcpy(upper, lower, AK_BTREE_MAX_VALUE);
+        } else if (aspParams[j].iSearchType == SEARCH_RANGE && type != TYPE_FLOAT && type != TYPE_VARCHAR) {
+            /// the scan compares FLOAT attributes as doubles, so only types stored as they are compared can use the index
+            size = (type == TYPE_NUMBER) ? sizeof (double) : sizeof (int);
+            lower_length = AK_btree_encode_value(type, (char *) aspParams[j].pData_lower, size, lower);
+            upper_length = AK_btree_encode_value(type, (char *) aspParams[j].pData_upper, size, upper);
+        }
+        if (lower_length != EXIT_ERROR && upper_length != EXIT_ERROR)
+            break;
+        lower_length = upper_length = EXIT_ERROR;
+    }
+
+    if (j >= iNum_search_params) {
+        AK_free(aiSearch_attributes);
+        AK_free(header);
+        return EXIT_WARNING;
+    }
+
+    AK_btree_range_init(&range);
+    AK_btree_range_lower(&range, lower, lower_length, 1);
+    AK_btree_range_upper(&range, upper, upper_length, 1);
+    if ((num_rows = AK_btree_search_range(indexName, &range, &rows)) == EXIT_ERROR) {
+        AK_free(aiSearch_attributes);
+        AK_free(header);
+        return EXIT_WARNING;
+    }
+
+    srResult->iNum_tuple_attributes = iNum_attributes;
+    srResult->iNum_search_attributes = iNum_search_params;
+    srResult->aiSearch_attributes = aiSearch_attributes;
+
+    qsort(rows, num_rows, sizeof (struct_add), AK_search_compare_rows);
+    for (i = 0; i < num_rows; i++) {
+        if (i > 0 && AK_search_compare_rows(&rows[i - 1], &rows[i]) == 0)
+            continue;
+        if (rows[i].indexTd < 0 || rows[i].indexTd + iNum_attributes > DATA_BLOCK_SIZE)
+            continue;
+
+        mem_block = AK_get_block(rows[i].addBlock);
+        /// entries of deleted rows stay in the index
+        if (mem_block->block->tuple_dict[rows[i].indexTd].type == FREE_INT
+                || mem_block->block->tuple_dict[rows[i].indexTd].size <= 0)
+            continue;
+        if (AK_search_tuple_matches(mem_block->block, rows[i].indexTd, aspParams, iNum_search_params, aiSearch_attributes))
+            AK_search_add_tuple(srResult, rows[i].addBlock, rows[i].indexTd);
+    }
+
+    AK_free(rows);
+    AK_free(header);
+    return EXIT_SUCCESS;
+}
 
 /**
   * @author Miroslav Policki
@@ -38,7 +255,6 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int
     int iBlock;
     AK_mem_block *mem_block = NULL, tmp;
     int i, j, k;
-    int iTupleMatches;
     search_result srResult;
     table_addresses *taAddresses;
 
@@ -52,6 +268,12 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int
         return srResult;
     }
 
+    /// a B+tree index on one of the attributes narrows the blocks read
+    if (AK_search_index(szRelation, aspParams, iNum_search_params, &srResult) == EXIT_SUCCESS) {
+        AK_EPI;
+        return srResult;
+    }
+
     taAddresses = AK_get_table_addresses(szRelation);
 
     /// iterate through all the blocks
@@ -94,98 +316,8 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int
 
             /// in every tuple, for all required attributes, compare attribute value with searched-for value and store matched tuple addresses
             for (i = 0; i < DATA_BLOCK_SIZE && mem_block->block->tuple_dict[i].type != FREE_INT; i += srResult.iNum_tuple_attributes) {
-                iTupleMatches = 1;
-
-                for (j = 0; j < iNum_search_params && iTupleMatches; j++) {
-                    switch (aspParams[j].iSearchType) {
-                        case SEARCH_PARTICULAR:
-                        {
-                            size_t iSearchAttributeValueSize = AK_type_size(mem_block->block->header[srResult.aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
-
-                            if (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].size != iSearchAttributeValueSize
-                                    || memcmp(mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address, aspParams[j].pData_lower, iSearchAttributeValueSize)) {
-                                iTupleMatches = 0;
-                            }
-                        }
-                            break;
-
-                        case SEARCH_RANGE:
-                        {
-
-                            switch (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].type) {
-                                case TYPE_INT:
-                                case TYPE_DATE:
-                                case TYPE_DATETIME:
-                                case TYPE_TIME:
-                                {
-                                    int iAttributeValue = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address));
-                                    if (iAttributeValue < *((int *) aspParams[j].pData_lower)
-                                            || iAttributeValue > *((int *) aspParams[j].pData_upper)) {
-                                        iTupleMatches = 0;
-                                    }
-                                }
-                                    break;
-
-                                case TYPE_FLOAT:
-                                case TYPE_NUMBER:
-                                    if (*((double *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address)) < *((double *) aspParams[j].pData_lower)
-                                            || *((double *) (mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address)) > *((double *) aspParams[j].pData_upper)) {
-                                        iTupleMatches = 0;
-                                    }
-                                    break;
-
-                                default: // other types unsupported
-                                    iTupleMatches = 0;
-                            }
-                        }
-                            break;
-
-                        case SEARCH_ALL: // iTupleMatches is already == 1, no action needed
-                            break;
-
-                        case SEARCH_NULL:
-                        {
-                            size_t iSearchAttributeValueSize = AK_type_size(mem_block->block->header[srResult.aiSearch_attributes[j]].type, (char *) aspParams[j].pData_lower);
-
-                            if (mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].type != TYPE_VARCHAR
-                                    || iSearchAttributeValueSize != strlen("NULL")
-                                    || memcmp(mem_block->block->data + mem_block->block->tuple_dict[i + srResult.aiSearch_attributes[j]].address, "NULL", strlen("NULL")))
-                                iTupleMatches = 0;
-                        }
-                            break;
-
-                        default:
-                            iTupleMatches = 0;
-                    }
-                }
-
-                if (iTupleMatches) {
-                    /*if(DEBUG) {
-                        printf("AK_realloc(srResult.aiTuple_addresses = %p, srResult.iNum_tuple_addresses++ * sizeof(int) = %d)\n", srResult.aiTuple_addresses, (srResult.iNum_tuple_addresses + 1) * sizeof(int));
-                        if(srResult.iNum_tuple_addresses == 7)
-                            puts("8");
-                    }*/
-                    srResult.iNum_tuple_addresses++;
-                    srResult.aiTuple_addresses = (int *) AK_realloc(srResult.aiTuple_addresses, srResult.iNum_tuple_addresses * sizeof (int));
-
-                    if (srResult.aiTuple_addresses == NULL) {
-                        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiTuple_addresses, iteration %d.\n", i);
-                        AK_EPI;
-                        exit(EXIT_ERROR);
-                    }
-
-                    /*if(DEBUG)
-                        puts("AK_realloc srResult.aiBlocks");*/
-                    srResult.aiBlocks = (int *) AK_realloc(srResult.aiBlocks, srResult.iNum_tuple_addresses * sizeof (int));
-                    if (srResult.aiBlocks == NULL) {
-                        printf("AK_search_unsorted: ERROR. Cannot AK_reallocate srResult.aiBlocks, iteration %d.\n", i);
-                        AK_EPI;
-                        exit(EXIT_ERROR);
-                    }
-
-                    srResult.aiTuple_addresses[srResult.iNum_tuple_addresses - 1] = i;
-                    srResult.aiBlocks[srResult.iNum_tuple_addresses - 1] = iBlock;
-                }
+                if (AK_search_tuple_matches(mem_block->block, i, aspParams, iNum_search_params, srResult.aiSearch_attributes))
+                    AK_search_add_tuple(&srResult, iBlock, i);
             }
         }
     }
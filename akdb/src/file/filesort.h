@@ -26,19 +26,50 @@
 #include "files.h"
 #include "fileio.h"
 #include "../auxi/mempro.h"
+#include "../rel/iterator.h"
+
 /**
-  * @def DATA_ROW_SIZE
-  * @brief Constatnt declaring size of data to be compared
-  */
+ * @def AK_SORT_MAX_FAN_IN
+ * @brief Constant declaring the maximum number of sorted runs merged in one pass
+ */
+#define AK_SORT_MAX_FAN_IN 16
 
-#define DATA_ROW_SIZE 200
 /**
-  * @def DATA_TUPLE_SIZE
-  * @brief Constant declaring size of data to be copied
-  */
+ * @def AK_SORT_ARENA_CHUNK
+ * @brief Constant declaring the size of the memory chunks the rows of a sorted run are copied into
+ */
+#define AK_SORT_ARENA_CHUNK (256 * 1024)
 
-#define DATA_TUPLE_SIZE 500
+/**
+ * @struct AK_sort_keys
+ * @brief Structure that defines the sort key of a table: attribute indexes in the order of precedence and their directions
+ */
+typedef struct {
+    int num_keys;
+    int column[MAX_ATTRIBUTES];
+    /// 1 for DESC, 0 for ASC
+    int descending[MAX_ATTRIBUTES];
+} AK_sort_keys;
 
+/**
+ * @struct AK_sort_value
+ * @brief Structure that defines one value of a row kept in memory while sorting
+ */
+typedef struct {
+    int type;
+    int size;
+    char *data;
+} AK_sort_value;
+
+/**
+ * @struct AK_sort_chunk
+ * @brief Structure that defines a memory chunk the rows of a sorted run are copied into
+ */
+typedef struct AK_sort_chunk {
+    struct AK_sort_chunk *next;
+    long used;
+    char data[AK_SORT_ARENA_CHUNK];
+} AK_sort_chunk;
 
 /**
  * @author Unknown
@@ -61,14 +92,60 @@ int AK_get_header_number(AK_block *iBlock, char *attribute_name);
  */
 int AK_get_num_of_tuples(AK_block *iBlock);
 
+/**
+ * @brief  Function that compares two values of the same type. Numbers are compared by value, other types by their bytes
+ *         (dates are stored as ISO strings, so this orders them by time). Values need not be terminated by '\0'.
+ * @param type type of the values
+ * @param data1 first value
+ * @param size1 size of the first value
+ * @param data2 second value
+ * @param size2 size of the second value
+ * @return negative value, zero or positive value if the first value is less than, equal to or greater than the second
+ */
+int AK_sort_compare_values(int type, char *data1, int size1, char *data2, int size2);
+
+/**
+ * @brief  Function that resolves a list of sort attributes. Every TYPE_ATTRIBS element names an attribute of the table and
+ *         can be followed by a TYPE_OPERATOR element "ASC" or "DESC", ASC is the default.
+ * @param tblName table name
+ * @param attributes list of sort attributes
+ * @param keys resolved sort key
+ * @return EXIT_SUCCESS, EXIT_ERROR if an attribute does not exist in the table
+ */
+int AK_sort_keys_from_list(char *tblName, struct list_node *attributes, AK_sort_keys *keys);
+
+/**
+ * @brief  Function that sorts a table into a new table with an external merge sort. Rows are read into memory until the
+ *         memory budget is used, sorted and written to a temp segment (a sorted run). The runs are merged AK_SORT_MAX_FAN_IN at a
+ *         time until one merge writes the destination table. An input that fits the budget is sorted in memory. The sort is
+ *         stable.
+ * @param srcTable name of the table to sort
+ * @param destTable name of the sorted table, it is created with the header of the source table
+ * @param keys sort key
+ * @param memory memory budget for a sorted run in bytes
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_external_sort(char *srcTable, char *destTable, AK_sort_keys *keys, int memory);
+
 /**
  * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @brief Function that sorts a segment with an external merge sort in the memory budget set by sort:sort_memory
+ * @param srcTable name of the table to sort
+ * @param destTable name of the sorted table, it is created with the header of the source table
+ * @param attributes list of sort attributes, see AK_sort_keys_from_list
+ * @return EXIT_SUCCESS or EXIT_ERROR
  */
 int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes);
 
+/**
+ * @brief Function that sorts the rows of an operator. The input is drained when the operator is opened; rows that do not
+ *        fit sort:sort_memory are sorted by AK_external_sort through temp tables.
+ * @param input input operator, freed with the sort
+ * @param attributes list of sort attributes, see AK_sort_keys_from_list
+ * @return operator, NULL if input is NULL or an attribute does not exist
+ */
+AK_iterator *AK_sort_iterator(AK_iterator *input, struct list_node *attributes);
+
 /**
  * @author Unknown
  * @brief Function that resets block
@@ -80,8 +157,9 @@ void AK_reset_block(AK_block * block);
 /**
   * @author Bakoš Nikola
   * @version v1.0
-  * @brief Function that sorts the given block
+  * @brief Function that sorts the rows of the given block in memory by an attribute
   * @param iBlock block to be sorted
+  * @param atr_name name of the attribute to sort by
   * @return No return value
  */
 void AK_block_sort(AK_block * iBlock, char * atr_name);
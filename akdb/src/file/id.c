@@ -35,14 +35,13 @@ int AK_get_id() {
 	 * then check all rows of table AK_sequence (for(i=0; i<num_rec; i++)) and update a row which contains objectID (AK_GetNth_L2(2, row), value in column 
 	 * name must be objectID) or create a row which will contain objectID*/
 	
-	int num_rec = AK_get_num_records("AK_sequence");
+	AK_table_cursor *cursor = AK_table_cursor_open("AK_sequence");
+	struct list_node *row = AK_table_cursor_next(cursor);
 	
-    if(num_rec > 0) {
-    	struct list_node *row = AK_get_row(0, "AK_sequence");
+    if(row != NULL) {
 		struct list_node *attribute = AK_GetNth_L2(3, row);
 		memcpy(&current_value, &attribute->data, attribute->size);
-		AK_DeleteAll_L3(&row);
-		AK_free(row);
+		AK_table_cursor_close(cursor);
 		
         current_value++;
 		AK_Update_Existing_Element(TYPE_INT, &obj_id, "AK_sequence", "obj_id", row_root);
@@ -60,6 +59,7 @@ int AK_get_id() {
     }
     else
     {
+		AK_table_cursor_close(cursor);
 		AK_Insert_New_Element(TYPE_INT, &obj_id, "AK_sequence", "obj_id", row_root);
 		AK_Insert_New_Element(TYPE_VARCHAR, "objectID", "AK_sequence", "name", row_root);
 		current_value = ID_START_VALUE;
@@ -86,21 +86,16 @@ char AK_get_table_id(char *tableName) {
     char *table = "AK_relation";
     int result = 0;
 
-    int num_rows = AK_get_num_records(table);
-    int a;
+    AK_table_cursor *cursor = AK_table_cursor_open(table);
+    struct list_node *row;
 
-    if(num_rows==0){
-        return result;
-    }
-
-    for (a = 0; a < num_rows; a++) {
-        struct list_node *el;
-        el = AK_get_tuple(a, 1,table);
-        if (strcmp(tableName, el->data)==0) {
-            result = AK_tuple_to_string(AK_get_tuple(a, 0,table));
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (strcmp(tableName, AK_GetNth_L2(2, row)->data)==0) {
+            result = AK_tuple_to_string(AK_GetNth_L2(1, row));
             break;
         }
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return result;
 }
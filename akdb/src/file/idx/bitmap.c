@@ -18,798 +18,2258 @@
  17 */
 
 #include "bitmap.h"
-#include "../../auxi/iniparser.h"
+#include "hash.h"
+#include "../../rel/selection.h"
+
+/// writers of all bitmap indexes are serialized, readers only take latches
+static pthread_mutex_t AK_bitmap_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/// bitmap indexes found in AK_index, reloaded when the catalog changes
+static AK_bitmap_index AK_bitmap_indexes[AK_BITMAP_MAX_INDEXES];
+static int AK_bitmap_num_indexes = -1;
+static unsigned long AK_bitmap_indexes_version;
+static pthread_mutex_t AK_bitmap_indexes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/// operations of AK_bitmap_combine
+#define AK_BITMAP_AND 0
+#define AK_BITMAP_OR 1
+#define AK_BITMAP_ANDNOT 2
+
+/// comparison of AK_bitmap_values that takes every value
+#define AK_BITMAP_ALL -1
+
+/// size of the dictionary entry of the rows whose value is of another type than the attribute
+#define AK_BITMAP_OTHER -1
 
 /**
-  @author Saša Vukšić
-  @brief Function that examines whether list L contains operator ele
-  @param L list of elements
-  @param ele operator to be found in list
-  @return 1 if operator ele is found in list, otherwise 0
+ * @brief Function that finds the container of a key in a bitmap
+ * @param bitmap bitmap
+ * @param key container key
+ * @return index of the container, -(index it would be inserted at) - 1 if there is none
  */
-  int AK_If_ExistOp(struct list_node *L, char *ele)
-  {
-    struct list_node *Currentelement_op;
-    AK_PRO;
-    Currentelement_op = L->next;
-    while (Currentelement_op)
-    {
-        if (strcmp(Currentelement_op->attribute_name, ele) == 0)
-        {
-            AK_EPI;
+static int AK_bitmap_find_container(AK_bitmap *bitmap, unsigned int key) {
+    int low = 0, high = bitmap->count - 1, middle;
+
+    //row ids mostly come in order, so the last container is tried first
+    if (bitmap->count > 0 && bitmap->containers[high].key < key)
+        return -bitmap->count - 1;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (bitmap->containers[middle].key < key)
+            low = middle + 1;
+        else if (bitmap->containers[middle].key > key)
+            high = middle - 1;
+        else
+            return middle;
+    }
+    return -low - 1;
+}
+
+/**
+ * @brief Function that finds a value in the array of an array container
+ * @return index of the value, -(index it would be inserted at) - 1 if it is not there
+ */
+static int AK_bitmap_find_low(unsigned short *array, int count, unsigned short value) {
+    int low = 0, high = count - 1, middle;
+
+    if (count > 0 && array[high] < value)
+        return -count - 1;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (array[middle] < value)
+            low = middle + 1;
+        else if (array[middle] > value)
+            high = middle - 1;
+        else
+            return middle;
+    }
+    return -low - 1;
+}
+
+/**
+ * @brief Function that makes room for a container in a bitmap
+ * @param bitmap bitmap
+ * @param position index of the new container
+ * @param key key of the new container
+ * @return the new empty array container
+ */
+static AK_bitmap_container *AK_bitmap_insert_container(AK_bitmap *bitmap, int position, unsigned int key) {
+    AK_bitmap_container *container;
+
+    if (bitmap->count == bitmap->capacity) {
+        bitmap->capacity = bitmap->capacity ? 2 * bitmap->capacity : 4;
+        bitmap->containers = (AK_bitmap_container *) AK_realloc(bitmap->containers, bitmap->capacity * sizeof (AK_bitmap_container));
+    }
+    container = bitmap->containers + position;
+    memmove(container + 1, container, (bitmap->count - position) * sizeof (AK_bitmap_container));
+    bitmap->count++;
+    memset(container, 0, sizeof (AK_bitmap_container));
+    container->key = key;
+    return container;
+}
+
+/**
+ * @brief Function that frees the array or bitset of a container
+ */
+static void AK_bitmap_free_container(AK_bitmap_container *container) {
+    if (container->array != NULL)
+        AK_free(container->array);
+    if (container->bits != NULL)
+        AK_free(container->bits);
+    container->array = NULL;
+    container->bits = NULL;
+    container->capacity = 0;
+}
+
+/**
+ * @brief Function that turns an array container into a bitset container
+ */
+static void AK_bitmap_to_bitset(AK_bitmap_container *container) {
+    unsigned long long *bits = (unsigned long long *) AK_calloc(AK_BITMAP_CHUNK_WORDS, sizeof (unsigned long long));
+    int i;
+
+    for (i = 0; i < container->cardinality; i++)
+        bits[container->array[i] >> 6] |= 1ULL << (container->array[i] & 63);
+    AK_bitmap_free_container(container);
+    container->bits = bits;
+}
+
+/**
+ * @brief Function that turns a bitset container into an array container
+ */
+static void AK_bitmap_to_array(AK_bitmap_container *container) {
+    unsigned short *array = (unsigned short *) AK_malloc((container->cardinality + 1) * sizeof (unsigned short));
+    unsigned long long word;
+    int count = 0, i;
+
+    for (i = 0; i < AK_BITMAP_CHUNK_WORDS; i++)
+        for (word = container->bits[i]; word != 0; word &= word - 1)
+            array[count++] = i * 64 + __builtin_ctzll(word);
+    AK_bitmap_free_container(container);
+    container->array = array;
+    container->capacity = container->cardinality + 1;
+}
+
+/**
+ * @brief Function that gives a container the representation its cardinality calls for: an array of up to
+ * AK_BITMAP_ARRAY_MAX values, a bitset otherwise
+ */
+static void AK_bitmap_normalize(AK_bitmap_container *container) {
+    if (container->bits != NULL && container->cardinality <= AK_BITMAP_ARRAY_MAX)
+        AK_bitmap_to_array(container);
+    else if (container->bits == NULL && container->cardinality > AK_BITMAP_ARRAY_MAX)
+        AK_bitmap_to_bitset(container);
+}
+
+AK_bitmap *AK_bitmap_new() {
+    return (AK_bitmap *) AK_calloc(1, sizeof (AK_bitmap));
+}
+
+void AK_bitmap_free(AK_bitmap *bitmap) {
+    int i;
+
+    if (bitmap == NULL)
+        return;
+    for (i = 0; i < bitmap->count; i++)
+        AK_bitmap_free_container(bitmap->containers + i);
+    if (bitmap->containers != NULL)
+        AK_free(bitmap->containers);
+    AK_free(bitmap);
+}
+
+int AK_bitmap_add(AK_bitmap *bitmap, unsigned int row) {
+    unsigned int key = row >> AK_BITMAP_CHUNK_BITS;
+    unsigned short low = row & (AK_BITMAP_CHUNK_SIZE - 1);
+    AK_bitmap_container *container;
+    int position;
+
+    if ((position = AK_bitmap_find_container(bitmap, key)) < 0)
+        container = AK_bitmap_insert_container(bitmap, -position - 1, key);
+    else
+        container = bitmap->containers + position;
+
+    if (container->bits == NULL) {
+        if ((position = AK_bitmap_find_low(container->array, container->cardinality, low)) >= 0)
+            return 0;
+        if (container->cardinality == AK_BITMAP_ARRAY_MAX)
+            AK_bitmap_to_bitset(container);
+        else {
+            position = -position - 1;
+            if (container->cardinality == container->capacity) {
+                container->capacity = container->capacity ? 2 * container->capacity : 4;
+                container->array = (unsigned short *) AK_realloc(container->array, container->capacity * sizeof (unsigned short));
+            }
+            memmove(container->array + position + 1, container->array + position,
+                (container->cardinality - position) * sizeof (unsigned short));
+            container->array[position] = low;
+            container->cardinality++;
             return 1;
         }
-        Currentelement_op = (struct list_node *) Currentelement_op->next;
     }
-    AK_EPI;
-    return 0;
+    if (container->bits[low >> 6] & (1ULL << (low & 63)))
+        return 0;
+    container->bits[low >> 6] |= 1ULL << (low & 63);
+    container->cardinality++;
+    return 1;
+}
+
+int AK_bitmap_remove(AK_bitmap *bitmap, unsigned int row) {
+    unsigned short low = row & (AK_BITMAP_CHUNK_SIZE - 1);
+    AK_bitmap_container *container;
+    int index, position;
+
+    if ((index = AK_bitmap_find_container(bitmap, row >> AK_BITMAP_CHUNK_BITS)) < 0)
+        return 0;
+    container = bitmap->containers + index;
+    if (container->bits != NULL) {
+        if (!(container->bits[low >> 6] & (1ULL << (low & 63))))
+            return 0;
+        container->bits[low >> 6] &= ~(1ULL << (low & 63));
+        container->cardinality--;
+        AK_bitmap_normalize(container);
+    } else {
+        if ((position = AK_bitmap_find_low(container->array, container->cardinality, low)) < 0)
+            return 0;
+        memmove(container->array + position, container->array + position + 1,
+            (container->cardinality - position - 1) * sizeof (unsigned short));
+        container->cardinality--;
+    }
+    if (container->cardinality == 0) {
+        AK_bitmap_free_container(container);
+        memmove(container, container + 1, (bitmap->count - index - 1) * sizeof (AK_bitmap_container));
+        bitmap->count--;
+    }
+    return 1;
+}
+
+int AK_bitmap_contains(AK_bitmap *bitmap, unsigned int row) {
+    unsigned short low = row & (AK_BITMAP_CHUNK_SIZE - 1);
+    AK_bitmap_container *container;
+    int index;
+
+    if ((index = AK_bitmap_find_container(bitmap, row >> AK_BITMAP_CHUNK_BITS)) < 0)
+        return 0;
+    container = bitmap->containers + index;
+    if (container->bits != NULL)
+        return (container->bits[low >> 6] >> (low & 63)) & 1;
+    return AK_bitmap_find_low(container->array, container->cardinality, low) >= 0;
 }
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that reads table on which we create index and call functions for creating index
-           Elements that will be in index are put in list indexLista and headerAttributes. According to those elements new indexes
-           are created.
+ * @brief Function that appends a container to a bitmap, an empty one is freed instead
+ * @param bitmap bitmap, its last container has a lower key
+ * @param container container, owned by the bitmap afterwards
+ */
+static void AK_bitmap_append(AK_bitmap *bitmap, AK_bitmap_container *container) {
+    if (container->cardinality == 0) {
+        AK_bitmap_free_container(container);
+        return;
+    }
+    if (bitmap->count == bitmap->capacity) {
+        bitmap->capacity = bitmap->capacity ? 2 * bitmap->capacity : 4;
+        bitmap->containers = (AK_bitmap_container *) AK_realloc(bitmap->containers, bitmap->capacity * sizeof (AK_bitmap_container));
+    }
+    bitmap->containers[bitmap->count++] = *container;
+}
 
- * @param tblName name of table
- * @param attributes list of attributes on which we will create indexes
- * @return No return value
- * */
- void AK_create_Index_Table(char *tblName, struct list_node *attributes)
- {
-    int num_attr;
-    int i, j, k;
+/**
+ * @brief Function that copies a container
+ */
+static void AK_bitmap_copy_container(AK_bitmap_container *source, AK_bitmap_container *copy) {
+    *copy = *source;
+    if (source->bits != NULL) {
+        copy->bits = (unsigned long long *) AK_malloc(AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+        memcpy(copy->bits, source->bits, AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+    } else {
+        copy->capacity = source->cardinality;
+        copy->array = (unsigned short *) AK_malloc((source->cardinality + 1) * sizeof (unsigned short));
+        memcpy(copy->array, source->array, source->cardinality * sizeof (unsigned short));
+    }
+}
 
-    table_addresses *addresses;
-    AK_header *temp_head;
-    int temp_int;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
+/**
+ * @brief Function that gives the bitset of a container, an array is expanded into a buffer
+ * @param container container
+ * @param buffer buffer of AK_BITMAP_CHUNK_WORDS words
+ * @return the bitset
+ */
+static unsigned long long *AK_bitmap_bitset(AK_bitmap_container *container, unsigned long long *buffer) {
+    int i;
 
-    struct list_node *some_element;
-    struct list_node *e, *ee;
-    struct list_node *headerAtributes;
-    int br;
-    char * indexName;
-    int indexed_attr_position;
+    if (container->bits != NULL)
+        return container->bits;
+    memset(buffer, 0, AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+    for (i = 0; i < container->cardinality; i++)
+        buffer[container->array[i] >> 6] |= 1ULL << (container->array[i] & 63);
+    return buffer;
+}
 
+/**
+ * @brief Function that combines two containers with the same key. Two arrays are merged, an array is filtered
+ * through a bitset, and two bitsets are combined word by word.
+ * @param a first container
+ * @param b second container
+ * @param operation AK_BITMAP_AND, AK_BITMAP_OR or AK_BITMAP_ANDNOT
+ * @param result set to the new container
+ */
+static void AK_bitmap_combine_containers(AK_bitmap_container *a, AK_bitmap_container *b, int operation, AK_bitmap_container *result) {
+    unsigned long long buffer_a[AK_BITMAP_CHUNK_WORDS], buffer_b[AK_BITMAP_CHUNK_WORDS], *x, *y;
+    AK_bitmap_container *filtered = NULL, *filter = NULL;
+    int i = 0, j = 0, count = 0, keep, w;
+
+    memset(result, 0, sizeof (AK_bitmap_container));
+    result->key = a->key;
+
+    if (a->bits == NULL && b->bits == NULL) {
+        result->capacity = (operation == AK_BITMAP_OR) ? a->cardinality + b->cardinality : a->cardinality;
+        result->array = (unsigned short *) AK_malloc((result->capacity + 1) * sizeof (unsigned short));
+        while (i < a->cardinality && j < b->cardinality) {
+            if (a->array[i] < b->array[j]) {
+                if (operation != AK_BITMAP_AND)
+                    result->array[count++] = a->array[i];
+                i++;
+            } else if (a->array[i] > b->array[j]) {
+                if (operation == AK_BITMAP_OR)
+                    result->array[count++] = b->array[j];
+                j++;
+            } else {
+                if (operation != AK_BITMAP_ANDNOT)
+                    result->array[count++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+        if (operation != AK_BITMAP_AND)
+            while (i < a->cardinality)
+                result->array[count++] = a->array[i++];
+        if (operation == AK_BITMAP_OR)
+            while (j < b->cardinality)
+                result->array[count++] = b->array[j++];
+        result->cardinality = count;
+        AK_bitmap_normalize(result);
+        return;
+    }
 
-    AK_header t_header[ MAX_ATTRIBUTES ];
-    AK_header t_headerr[ MAX_ATTRIBUTES ];
-    AK_header* tempHeader;
+    //an array is filtered when the result cannot have more values than it has
+    if (operation == AK_BITMAP_AND && a->bits == NULL) {
+        filtered = a;
+        filter = b;
+    } else if (operation == AK_BITMAP_AND && b->bits == NULL) {
+        filtered = b;
+        filter = a;
+    } else if (operation == AK_BITMAP_ANDNOT && a->bits == NULL) {
+        filtered = a;
+        filter = b;
+    }
+    if (filtered != NULL) {
+        result->capacity = filtered->cardinality;
+        result->array = (unsigned short *) AK_malloc((result->capacity + 1) * sizeof (unsigned short));
+        for (i = 0; i < filtered->cardinality; i++) {
+            keep = (filter->bits[filtered->array[i] >> 6] >> (filtered->array[i] & 63)) & 1;
+            if (keep != (operation == AK_BITMAP_ANDNOT))
+                result->array[count++] = filtered->array[i];
+        }
+        result->cardinality = count;
+        return;
+    }
 
-    AK_PRO;
+    x = AK_bitmap_bitset(a, buffer_a);
+    y = AK_bitmap_bitset(b, buffer_b);
+    result->bits = (unsigned long long *) AK_malloc(AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+    for (w = 0; w < AK_BITMAP_CHUNK_WORDS; w++) {
+        result->bits[w] = (operation == AK_BITMAP_AND) ? x[w] & y[w] : (operation == AK_BITMAP_OR) ? x[w] | y[w] : x[w] & ~y[w];
+        count += __builtin_popcountll(result->bits[w]);
+    }
+    result->cardinality = count;
+    AK_bitmap_normalize(result);
+}
 
-    addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    num_attr = AK_num_attr(tblName);
-    temp_head = (AK_header *) AK_get_header(tblName);
-    headerAtributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
-
-
-    for (i = 0; i < num_attr; i++)
-    {
-        some_element = AK_First_L2(attributes);
-        while (some_element != 0)
-        {
-            if (strcmp((temp_head + i)->att_name, some_element->attribute_name) == 0)
-            {
-                indexed_attr_position = i;
-                AK_Init_L3(&headerAtributes);
-                br = 0;
-
-                while (addresses->address_from[ br ] != 0)
-                {
-                    for (j = addresses->address_from[ br ]; j < addresses->address_to[ br ]; j++)
-                    {
-                        AK_block *temp = (AK_block*) AK_read_block(j);
-                        for (k = i; k < DATA_BLOCK_SIZE; k = k + num_attr)
-                        {
-                            if (temp->tuple_dict[ k ].size > 0)
-                            {
-                                switch (temp->tuple_dict[ k ].type)
-                                {
-
-
-                                    case TYPE_INT:
-                                    memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                                     temp->tuple_dict[k].size);
-                                    temp_int = sprintf(temp_char, "%d", temp_int);
-
-                                    ee = (struct list_node *) AK_First_L2(headerAtributes);
-                                    if (ee == 0)
-                                    {
-                                        AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, headerAtributes);
-                                    }
-                                    else
-                                    {
-                                        if (AK_If_ExistOp(headerAtributes, temp_char) == 0)
-                                        {
-                                            ee = (struct list_node *) AK_End_L2(headerAtributes);
-                                            AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, ee);
-                                        }
-                                    }
-                                    //printf("TEMP %-10s \n", temp_char);
-                                    break;
-
-                                //FLOAT VALUES ARE USUALLY NOT BEING INDEXED
-                                    case TYPE_FLOAT:
-                                    break;
-
-
-                                    case TYPE_VARCHAR:
-                                    memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                                     temp->tuple_dict[k].size);
-                                    temp_char[ temp->tuple_dict[k].size ] = '\0';
-
-                                    ee = (struct list_node *) AK_First_L2(headerAtributes);
-                                    if (ee == 0)
-                                    {
-                                        AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, headerAtributes);
-                                    }
-                                    else
-                                    {
-                                        if (AK_If_ExistOp(headerAtributes, temp_char) == 0)
-                                        {
-                                            ee = (struct list_node *) AK_End_L2(headerAtributes);
-                                            AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, ee);
-                                        }
-                                    }
-                                    break;
-                                }
-
-                            }
-                        }
-                    }
-                    br++;
-                }
+/**
+ * @brief Function that combines two bitmaps container by container
+ * @param a first bitmap
+ * @param b second bitmap
+ * @param operation AK_BITMAP_AND, AK_BITMAP_OR or AK_BITMAP_ANDNOT
+ * @return new bitmap
+ */
+static AK_bitmap *AK_bitmap_combine(AK_bitmap *a, AK_bitmap *b, int operation) {
+    AK_bitmap *result = AK_bitmap_new();
+    AK_bitmap_container container;
+    int i = 0, j = 0;
+
+    while (i < a->count || j < b->count) {
+        if (j == b->count || (i < a->count && a->containers[i].key < b->containers[j].key)) {
+            if (operation != AK_BITMAP_AND) {
+                AK_bitmap_copy_container(a->containers + i, &container);
+                AK_bitmap_append(result, &container);
+            }
+            i++;
+        } else if (i == a->count || b->containers[j].key < a->containers[i].key) {
+            if (operation == AK_BITMAP_OR) {
+                AK_bitmap_copy_container(b->containers + j, &container);
+                AK_bitmap_append(result, &container);
+            }
+            j++;
+        } else {
+            AK_bitmap_combine_containers(a->containers + i, b->containers + j, operation, &container);
+            AK_bitmap_append(result, &container);
+            i++;
+            j++;
+        }
+        if (operation == AK_BITMAP_AND && (i == a->count || j == b->count))
+            break;
+    }
+    return result;
+}
 
+AK_bitmap *AK_bitmap_and(AK_bitmap *a, AK_bitmap *b) {
+    return AK_bitmap_combine(a, b, AK_BITMAP_AND);
+}
 
-                //PART WHERE WE CHECK EVERY ATTRIBUTE
-                int brr;
-                int z;
-                char inde[50];
-                int startAddress;
-                switch ((temp_head + i)->type)
-                {
-                    case TYPE_VARCHAR:
-                    brr = 2; //3 First two places are reserved for block and row pointers
-                    e = (struct list_node *) AK_First_L2(headerAtributes);
-                    while (e != 0)
-                    {
-                        tempHeader = (AK_header*) AK_create_header(e->attribute_name, TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
-                        memcpy(t_header + brr, tempHeader, sizeof ( AK_header));
-                        e = (struct list_node *) AK_Next_L2(e);
-                        brr++;
-                    }
-                    //ADDITIONAL ATTRIBTE IS PRESENT FOR BLOCK ADDRESS
-                    tempHeader = (AK_header*) AK_create_header("addBlock", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_header, tempHeader, sizeof ( AK_header));
-                    tempHeader = (AK_header*) AK_create_header("indexTd", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_header + 1, tempHeader, sizeof ( AK_header));
-
-                    for (z = brr; z < MAX_ATTRIBUTES; z++)
-                    {
-                        memcpy(t_header + z, "\0", sizeof ( "\0"));
-                    }
-
-                    //INITIALIZATION OF NEW HEADER FILE
-                    strcpy(inde, tblName);
-                    indexName = strcat(inde, (temp_head + i)->att_name);
-                    indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_header);
-
-
-                    if (startAddress != EXIT_ERROR)
-                    {
-                        printf("\nINDEX %s CREATED!\n", indexName);
-                        //funtion that fills index with attribute values
-                        AK_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
-                    }
-
-                    break;
-
-                    case TYPE_INT:
-                    brr = 2; //3 First two places are reserved for block and row pointers
-
-                    tempHeader = (AK_header*) AK_create_header("addBlock", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_headerr, tempHeader, sizeof ( AK_header));
-
-                    tempHeader = (AK_header*) AK_create_header("indexTd", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_headerr + 1, tempHeader, sizeof ( AK_header));
-
-                    e = (struct list_node *) AK_First_L2(headerAtributes);
-                    while (e != 0)
-                    {
-                        tempHeader = (AK_header*) AK_create_header(e->attribute_name, TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                        memcpy(t_headerr + brr, tempHeader, sizeof ( AK_header));
-                        e = (struct list_node *) AK_Next_L2(e);
-                        brr++;
-                    }
-
-
-                    for (z = brr; z < MAX_ATTRIBUTES; z++)
-                    {
-                        memcpy(t_headerr + z, "\0", sizeof ( "\0"));
-                    }
-
-                    strcpy(inde, tblName);
-                    indexName = strcat(inde, (temp_head + i)->att_name);
-                    indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_headerr);
-                    if (startAddress != EXIT_ERROR)
-                    {
-                        printf("\nINDEX %s CREATED!\n", indexName);
-                        AK_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
-                    }
-                    break;
-                }
+AK_bitmap *AK_bitmap_or(AK_bitmap *a, AK_bitmap *b) {
+    return AK_bitmap_combine(a, b, AK_BITMAP_OR);
+}
+
+AK_bitmap *AK_bitmap_andnot(AK_bitmap *a, AK_bitmap *b) {
+    return AK_bitmap_combine(a, b, AK_BITMAP_ANDNOT);
+}
+
+int AK_bitmap_cardinality(AK_bitmap *bitmap) {
+    int count = 0, i;
 
+    for (i = 0; i < bitmap->count; i++)
+        count += bitmap->containers[i].cardinality;
+    return count;
+}
+
+int AK_bitmap_rows(AK_bitmap *bitmap, struct_add **rows) {
+    AK_bitmap_container *container;
+    unsigned long long word;
+    unsigned int row;
+    int count = 0, i, j;
+
+    *rows = (struct_add *) AK_malloc((AK_bitmap_cardinality(bitmap) + 1) * sizeof (struct_add));
+    for (i = 0; i < bitmap->count; i++) {
+        container = bitmap->containers + i;
+        row = container->key << AK_BITMAP_CHUNK_BITS;
+        if (container->bits == NULL)
+            for (j = 0; j < container->cardinality; j++) {
+                (*rows)[count].addBlock = (row | container->array[j]) / DATA_BLOCK_SIZE;
+                (*rows)[count].indexTd = (row | container->array[j]) % DATA_BLOCK_SIZE;
+                count++;
             }
-            some_element = (struct list_node *) AK_Next_L2(some_element);
-        }
+        else
+            for (j = 0; j < AK_BITMAP_CHUNK_WORDS; j++)
+                for (word = container->bits[j]; word != 0; word &= word - 1) {
+                    (*rows)[count].addBlock = (row | (j * 64 + __builtin_ctzll(word))) / DATA_BLOCK_SIZE;
+                    (*rows)[count].indexTd = (row | (j * 64 + __builtin_ctzll(word))) % DATA_BLOCK_SIZE;
+                    count++;
+                }
     }
+    return count;
+}
 
-    AK_DeleteAll_L3(&headerAtributes);
-    AK_free(headerAtributes);
-    AK_free(tempHeader);
-    AK_free(temp_head);
-    AK_EPI;
+/**
+ * @brief Function that releases a block pinned and latched by the bitmap index functions
+ * @param mem_block block
+ */
+static void AK_bitmap_release(AK_mem_block *mem_block) {
+    AK_unlatch_block(mem_block);
+    AK_unpin_block(mem_block);
+}
 
+/**
+ * @brief Function that reads the list of bitmap indexes from AK_index. Called while AK_bitmap_indexes_lock is held.
+ */
+static void AK_bitmap_load_indexes() {
+    unsigned long version = AK_catalog_version();
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_index");
+    struct list_node *row, *name, *start, *table_id;
+    AK_mem_block *mem_block;
+    AK_bitmap_meta *meta;
+    AK_bitmap_index *index;
+    int address;
+
+    AK_bitmap_num_indexes = 0;
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL && AK_bitmap_num_indexes < AK_BITMAP_MAX_INDEXES) {
+        name = AK_First_L2(row)->next;
+        start = name->next;
+        table_id = start->next->next;
+        //rows of later extents do not name the table
+        if (table_id->type != TYPE_INT || start->type != TYPE_INT)
+            continue;
+        memcpy(&address, start->data, sizeof (int));
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        meta = (AK_bitmap_meta *) mem_block->block->data;
+        if (meta->magic == AK_BITMAP_MAGIC) {
+            index = AK_bitmap_indexes + AK_bitmap_num_indexes++;
+            strncpy(index->name, name->data, MAX_VARCHAR_LENGTH - 1);
+            index->name[MAX_VARCHAR_LENGTH - 1] = '\0';
+            index->table_id = meta->table_id;
+            index->attribute = meta->attribute;
+            index->type = meta->type;
+            index->meta = address;
+        }
+        AK_bitmap_release(mem_block);
+    }
+    AK_table_cursor_close(cursor);
+    AK_bitmap_indexes_version = version;
 }
 
+/**
+ * @brief Function that copies the bitmap indexes of a table
+ * @param tblName table name
+ * @param indexes buffer of AK_BITMAP_MAX_INDEXES indexes
+ * @return number of indexes
+ */
+static int AK_bitmap_table_indexes(char *tblName, AK_bitmap_index *indexes) {
+    int i, count = 0, table_id;
+
+    pthread_mutex_lock(&AK_bitmap_indexes_lock);
+    if (AK_bitmap_num_indexes < 0 || AK_bitmap_indexes_version != AK_catalog_version())
+        AK_bitmap_load_indexes();
+    if (AK_bitmap_num_indexes > 0) {
+        table_id = AK_get_table_obj_id(tblName);
+        for (i = 0; i < AK_bitmap_num_indexes; i++)
+            if (AK_bitmap_indexes[i].table_id == table_id)
+                indexes[count++] = AK_bitmap_indexes[i];
+    }
+    pthread_mutex_unlock(&AK_bitmap_indexes_lock);
+    return count;
+}
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that loads index table with the value of particulary atribute
- * @param tblName source table
- * @param tblNameIndex new name of index table
- * @param attributeName attribute on which we make index
- * @param positionTbl position of attribute in header of table
- * @param numAtributes number of attributes in table
- * @param headerIndex header of index table
- * @return No return value
+ * @brief Function that finds the meta block of an index in the list of bitmap indexes
+ * @param indexName name of the index
+ * @return block address, 0 if the index is not in the list
  */
- void AK_create_Index(char *tblName, char *tblNameIndex, char *attributeName, int positionTbl, int numAtributes, AK_header *headerIndex)
- {
+static int AK_bitmap_meta_address(char *indexName) {
+    int address = 0, i;
+
+    pthread_mutex_lock(&AK_bitmap_indexes_lock);
+    if (AK_bitmap_num_indexes < 0 || AK_bitmap_indexes_version != AK_catalog_version())
+        AK_bitmap_load_indexes();
+    for (i = 0; i < AK_bitmap_num_indexes && address == 0; i++)
+        if (strcmp(AK_bitmap_indexes[i].name, indexName) == 0)
+            address = AK_bitmap_indexes[i].meta;
+    pthread_mutex_unlock(&AK_bitmap_indexes_lock);
+    return address;
+}
 
+/**
+ * @brief Function that pins and latches the meta block of a bitmap index
+ * @param indexName name of the index
+ * @param mode latch mode
+ * @return meta block, NULL if the index does not exist
+ */
+static AK_mem_block *AK_bitmap_pin_meta(char *indexName, int mode) {
     table_addresses *addresses;
-    AK_block *temp;
+    AK_mem_block *mem_block;
+    int address;
+
+    //an index that is being created is not in the list yet
+    if ((address = AK_bitmap_meta_address(indexName)) == 0) {
+        addresses = AK_get_index_addresses(indexName);
+        address = addresses->address_from[0];
+        AK_free(addresses);
+    }
+    if (address == 0)
+        return NULL;
+    mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, mode);
+    if (((AK_bitmap_meta *) mem_block->block->data)->magic != AK_BITMAP_MAGIC) {
+        AK_bitmap_release(mem_block);
+        return NULL;
+    }
+    return mem_block;
+}
 
-    int i, j, k;
-    int temp_int;
-    int temp_indexTd;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
-    i = 0;
-    struct list_node *row_root;
+/**
+ * @brief Function that pins the meta block of a built index for a change. Called while AK_bitmap_write_lock is held.
+ * @param indexName name of the index
+ * @return meta block, pinned but not latched; NULL if the index does not exist or is being built
+ */
+static AK_mem_block *AK_bitmap_pin_built(char *indexName) {
+    AK_mem_block *meta_block = AK_bitmap_pin_meta(indexName, AK_LATCH_SHARED);
+
+    if (meta_block == NULL)
+        return NULL;
+    AK_unlatch_block(meta_block);
+    if (!((AK_bitmap_meta *) meta_block->block->data)->built) {
+        AK_unpin_block(meta_block);
+        return NULL;
+    }
+    return meta_block;
+}
 
-    AK_PRO;
+/**
+ * @brief Function that sets the tuple dictionary of a block holding bitmap index data, so the block does not look
+ * empty to the functions that read blocks of a segment
+ * @param block block
+ * @param size bytes used
+ */
+static void AK_bitmap_set_block_size(AK_block *block, int size) {
+    memset(block->tuple_dict, 0, sizeof (block->tuple_dict));
+    block->tuple_dict[0].type = TYPE_INTERNAL;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = size;
+    block->AK_free_space = size;
+    block->last_tuple_dict_id = 0;
+}
 
-    addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    temp = (AK_block*) AK_read_block(addresses->address_from[0]);
-
-    while (addresses->address_from[ i ] != 0)
-    {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-        {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = positionTbl; k < DATA_BLOCK_SIZE; k = k + numAtributes)
-            {
-
-                if (temp->tuple_dict[ k ].size > 0)
-                {
-                    switch (temp->tuple_dict[ k ].type)
-                    {
-
-                        case TYPE_INT:
-                            memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                             temp->tuple_dict[k].size);
-                            temp_int = sprintf(temp_char, "%d", temp_int);
-                            row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-                            AK_Init_L3(&row_root);
-                            temp_indexTd = k - positionTbl;
-
-                            AK_Insert_New_Element(TYPE_INT, &(temp->address), tblNameIndex, "addBlock", row_root);
-                            AK_Insert_New_Element(TYPE_INT, &temp_indexTd, tblNameIndex, "indexTd", row_root);
-                            //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-                            AK_Insert_New_Element(TYPE_VARCHAR, "1", tblNameIndex, temp_char, row_root);
-
-                            AK_insert_row(row_root);
-                            AK_DeleteAll_L3(&row_root);
-                            AK_free(row_root);
-                        break;
-
-
-                        case TYPE_FLOAT:
-                        break;
-
-                        case TYPE_VARCHAR:
-                            memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                             temp->tuple_dict[k].size);
-                            temp_char[ temp->tuple_dict[k].size ] = '\0';
-                            row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-                            AK_Init_L3(&row_root);
-                            temp_indexTd = k - positionTbl;
-
-                            AK_Insert_New_Element(TYPE_INT, &(temp->address), tblNameIndex, "addBlock", row_root);
-                            AK_Insert_New_Element(TYPE_INT, &temp_indexTd, tblNameIndex, "indexTd", row_root);
-                            AK_Insert_New_Element(TYPE_VARCHAR, "1", tblNameIndex, temp_char, row_root);
-
-                            AK_insert_row(row_root);
-
-
-                            AK_DeleteAll_L3(&row_root);
-                            AK_free(row_root);
-                        break;
-                    }
-                }
-            }
+/**
+ * @brief Function that gives the number of bytes a container takes in a page
+ */
+static int AK_bitmap_container_bytes(AK_bitmap_container *container) {
+    if (container->cardinality > AK_BITMAP_ARRAY_MAX)
+        return sizeof (AK_bitmap_page_container) + AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long);
+    return sizeof (AK_bitmap_page_container) + ((container->cardinality * (int) sizeof (unsigned short) + 3) & ~3);
+}
+
+/**
+ * @brief Function that counts how many containers from the first one fit into a page
+ */
+static int AK_bitmap_page_fit(AK_bitmap_container *containers, int count) {
+    int used = 0, i;
+
+    for (i = 0; i < count && used + AK_bitmap_container_bytes(containers + i) <= AK_BITMAP_PAGE_SIZE - (int) sizeof (AK_bitmap_page); i++)
+        used += AK_bitmap_container_bytes(containers + i);
+    return i;
+}
+
+/**
+ * @brief Function that writes containers into a pinned and exclusively latched block
+ * @param mem_block block
+ * @param containers containers that fit into a page
+ * @param count number of containers
+ * @param next next page of the bitmap
+ */
+static void AK_bitmap_write_page(AK_mem_block *mem_block, AK_bitmap_container *containers, int count, int next) {
+    AK_bitmap_page *page = (AK_bitmap_page *) mem_block->block->data;
+    AK_bitmap_page_container header;
+    char *data = (char *) (page + 1);
+    int used = 0, i;
+
+    for (i = 0; i < count; i++) {
+        header.key = containers[i].key;
+        header.cardinality = containers[i].cardinality;
+        memcpy(data + used, &header, sizeof (header));
+        if (containers[i].bits != NULL)
+            memcpy(data + used + sizeof (header), containers[i].bits, AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+        else
+            memcpy(data + used + sizeof (header), containers[i].array, containers[i].cardinality * sizeof (unsigned short));
+        used += AK_bitmap_container_bytes(containers + i);
+    }
+    page->count = count;
+    page->next = next;
+    page->used = used;
+    AK_bitmap_set_block_size(mem_block->block, sizeof (AK_bitmap_page) + used);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @brief Function that writes containers into a block
+ */
+static void AK_bitmap_write_new_page(int address, AK_bitmap_container *containers, int count, int next) {
+    AK_mem_block *mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    AK_bitmap_write_page(mem_block, containers, count, next);
+    AK_bitmap_release(mem_block);
+}
+
+/**
+ * @brief Function that appends the containers of a latched page to a bitmap, the page holds higher keys than the
+ * bitmap
+ * @param block block of the page
+ * @param bitmap bitmap
+ * @return next page
+ */
+static int AK_bitmap_read_page(AK_block *block, AK_bitmap *bitmap) {
+    AK_bitmap_page *page = (AK_bitmap_page *) block->data;
+    AK_bitmap_page_container header;
+    AK_bitmap_container container;
+    char *data = (char *) (page + 1);
+    int used = 0, i;
+
+    for (i = 0; i < page->count; i++) {
+        memcpy(&header, data + used, sizeof (header));
+        memset(&container, 0, sizeof (container));
+        container.key = header.key;
+        container.cardinality = header.cardinality;
+        if (header.cardinality > AK_BITMAP_ARRAY_MAX) {
+            container.bits = (unsigned long long *) AK_malloc(AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+            memcpy(container.bits, data + used + sizeof (header), AK_BITMAP_CHUNK_WORDS * sizeof (unsigned long long));
+        } else {
+            container.capacity = header.cardinality;
+            container.array = (unsigned short *) AK_malloc((header.cardinality + 1) * sizeof (unsigned short));
+            memcpy(container.array, data + used + sizeof (header), header.cardinality * sizeof (unsigned short));
         }
-        i++;
+        used += AK_bitmap_container_bytes(&container);
+        AK_bitmap_append(bitmap, &container);
     }
+    return page->next;
+}
 
-    AK_free(addresses);
-    AK_free(temp);
-    // AK_free(t_header);
-    AK_EPI;
+/**
+ * @brief Function that reads the bitmap of a value from its pages
+ * @param first first page
+ * @return bitmap
+ */
+static AK_bitmap *AK_bitmap_read_chain(int first) {
+    AK_bitmap *bitmap = AK_bitmap_new();
+    AK_mem_block *mem_block;
+    int address = first;
+
+    while (address != 0) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        address = AK_bitmap_read_page(mem_block->block, bitmap);
+        AK_bitmap_release(mem_block);
+    }
+    return bitmap;
 }
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that gets adresses of the particuliar attribute from bitmap index. It fetches addresses of indexes and header
-          of index table.  Using while loop it goes through index and gets necessary data. That data is put in a list called
-          add_root.
- * @param indexName name of index
- * @param attribute name of attribute
- * @return list of adresses
- **/
- list_ad* AK_get_attribute(char *indexName, char *attribute)
- {
-    int num_attr;
-    int i, j, k;
-
-    //start and end addresses of segment's
+ * @brief Function that makes sure count blocks can be taken from an index segment without adding an extent. Extents
+ * are added here, while the meta block is not latched, because adding one writes AK_index and that reloads the
+ * lists of indexes, which latch every meta block. Called while AK_bitmap_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @param count number of blocks
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_bitmap_reserve(char *indexName, AK_mem_block *meta_block, int count) {
+    AK_bitmap_meta *meta = (AK_bitmap_meta *) meta_block->block->data;
     table_addresses *addresses;
-    AK_header *temp_head;
-    int temp_int;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
-    float temp_float;
-    int b, br = 0;
-    int addBlock, indexTd;
-    list_ad *add_root;
-    AK_PRO;
+    int start, i;
+
+    while (meta->num_free + meta->extent_end - meta->next_block < count) {
+        if ((start = AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        addresses = AK_get_index_addresses(indexName);
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+            if (addresses->address_from[i] == start)
+                break;
+        if (i == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[i] == 0
+                || meta->num_free + addresses->address_to[i] - start < count) {
+            AK_free(addresses);
+            return EXIT_ERROR;
+        }
+        //what is left of the previous extent stays unused
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->next_block = start;
+        meta->extent_end = addresses->address_to[i];
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
+        AK_free(addresses);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that takes a block reserved by AK_bitmap_reserve, a freed page first
+ * @param meta exclusively latched meta block
+ * @return block address
+ */
+static int AK_bitmap_take_block(AK_bitmap_meta *meta) {
+    AK_mem_block *mem_block;
+    int address;
+
+    if (meta->free_page != 0) {
+        address = meta->free_page;
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        meta->free_page = ((AK_bitmap_page *) mem_block->block->data)->next;
+        AK_bitmap_release(mem_block);
+        meta->num_free--;
+    } else
+        address = meta->next_block++;
+    meta->num_pages++;
+    return address;
+}
+
+/**
+ * @brief Function that puts an emptied page on the free list
+ * @param meta exclusively latched meta block
+ * @param mem_block pinned and exclusively latched page
+ */
+static void AK_bitmap_free_page(AK_bitmap_meta *meta, AK_mem_block *mem_block) {
+    AK_bitmap_page *page = (AK_bitmap_page *) mem_block->block->data;
+
+    page->count = 0;
+    page->used = 0;
+    page->next = meta->free_page;
+    AK_bitmap_set_block_size(mem_block->block, sizeof (AK_bitmap_page));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    meta->free_page = mem_block->block->address;
+    meta->num_free++;
+    meta->num_pages--;
+}
+
+/**
+ * @brief Function that takes a block while an index is built
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @return block address, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_bitmap_build_block(char *indexName, AK_mem_block *meta_block) {
+    int address;
+
+    if (AK_bitmap_reserve(indexName, meta_block, 1) == EXIT_ERROR)
+        return EXIT_ERROR;
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    address = AK_bitmap_take_block((AK_bitmap_meta *) meta_block->block->data);
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    return address;
+}
+
+/**
+ * @brief Function that checks whether values of a type can be indexed. FLOAT values are compared by their first
+ * bytes only, so equal values need not have equal bytes.
+ */
+static int AK_bitmap_type_supported(int type) {
+    return type == TYPE_INT || type == TYPE_NUMBER || type == TYPE_VARCHAR || type == TYPE_DATE || type == TYPE_DATETIME
+        || type == TYPE_TIME;
+}
+
+/**
+ * @brief Function that copies a value in the form it is kept in the dictionary: strings without the terminating
+ * '\0', a number zero as positive zero
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @param value buffer of MAX_VARCHAR_LENGTH bytes
+ * @return size of the copy
+ */
+static int AK_bitmap_canonical(int type, int size, char *data, char *value) {
+    double number;
+
+    switch (type) {
+        case TYPE_INT:
+            memcpy(value, data, sizeof (int));
+            return sizeof (int);
+        case TYPE_NUMBER:
+            memcpy(&number, data, sizeof (double));
+            if (number == 0)
+                number = 0;
+            memcpy(value, &number, sizeof (double));
+            return sizeof (double);
+        default:
+            size = strnlen(data, size < MAX_VARCHAR_LENGTH ? size : MAX_VARCHAR_LENGTH);
+            memcpy(value, data, size);
+            return size;
+    }
+}
+
+/**
+ * @brief Function that compares two values of a type the way compiled expressions compare them
+ * @return negative value, zero or positive value if a is less than, equal to or greater than b
+ */
+static int AK_bitmap_compare_values(int type, char *a, int a_size, char *b, int b_size) {
+    int ia, ib, result;
+    double da, db;
+
+    switch (type) {
+        case TYPE_INT:
+            memcpy(&ia, a, sizeof (int));
+            memcpy(&ib, b, sizeof (int));
+            return (ia > ib) - (ia < ib);
+        case TYPE_NUMBER:
+            memcpy(&da, a, sizeof (double));
+            memcpy(&db, b, sizeof (double));
+            return (da > db) - (da < db);
+        default:
+            result = memcmp(a, b, a_size < b_size ? a_size : b_size);
+            return result ? result : a_size - b_size;
+    }
+}
+
+/**
+ * @brief Function that gives the number of bytes an entry of the value dictionary takes
+ */
+static int AK_bitmap_value_bytes(int size) {
+    return sizeof (AK_bitmap_value) + ((size > 0) ? (size + 3) & ~3 : 0);
+}
+
+/**
+ * @brief Function that finds a value in the dictionary of a bitmap index
+ * @param meta latched meta block
+ * @param size size of the value, AK_BITMAP_OTHER for the entry of the rows holding a value of another type
+ * @param data value
+ * @param page set to the dictionary page holding the value
+ * @param offset set to the offset of its entry in the page
+ * @param entry set to a copy of the entry
+ * @return 1 if the value was found, 0 otherwise
+ */
+static int AK_bitmap_find_value(AK_bitmap_meta *meta, int size, char *data, int *page, int *offset, AK_bitmap_value *entry) {
+    AK_mem_block *mem_block;
+    AK_bitmap_page *header;
+    char *entries;
+    int address = meta->dictionary, found = 0, used, i;
+
+    while (address != 0 && !found) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        header = (AK_bitmap_page *) mem_block->block->data;
+        entries = (char *) (header + 1);
+        for (i = 0, used = 0; i < header->count && !found; i++) {
+            memcpy(entry, entries + used, sizeof (AK_bitmap_value));
+            if (entry->size == size && (size <= 0 || memcmp(entries + used + sizeof (AK_bitmap_value), data, size) == 0)) {
+                *page = address;
+                *offset = used;
+                found = 1;
+            } else
+                used += AK_bitmap_value_bytes(entry->size);
+        }
+        address = header->next;
+        AK_bitmap_release(mem_block);
+    }
+    return found;
+}
 
-    addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    num_attr = AK_num_index_attr(indexName);
-    temp_head = (AK_header *) AK_get_index_header(indexName);
+/**
+ * @brief Function that writes an entry of the value dictionary back to its page
+ */
+static void AK_bitmap_set_value(int page, int offset, AK_bitmap_value *entry) {
+    AK_mem_block *mem_block = AK_pin_block(page);
 
-    add_root = (list_ad *) AK_malloc(sizeof (list_ad));
-    AK_InitializelistAd(add_root);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    memcpy(mem_block->block->data + sizeof (AK_bitmap_page) + offset, entry, sizeof (AK_bitmap_value));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_bitmap_release(mem_block);
+}
 
-    for (b = 0; b < num_attr; b++)
-    {
-        if (strcmp((temp_head + b)->att_name, attribute) == 0)
-        {
-            br = b;
+/**
+ * @brief Function that appends a value to the dictionary, a page is added when the last one is full. Needs one
+ * reserved block.
+ * @param meta exclusively latched meta block
+ * @param entry entry of the value
+ * @param data value
+ * @param page set to the dictionary page of the entry
+ * @param offset set to the offset of the entry in the page
+ */
+static void AK_bitmap_add_value(AK_bitmap_meta *meta, AK_bitmap_value *entry, char *data, int *page, int *offset) {
+    AK_mem_block *mem_block = NULL;
+    AK_bitmap_page *header;
+    int bytes = AK_bitmap_value_bytes(entry->size), address = meta->last_dictionary;
+
+    if (address != 0) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        header = (AK_bitmap_page *) mem_block->block->data;
+        if (header->used + bytes > AK_BITMAP_PAGE_SIZE - (int) sizeof (AK_bitmap_page)) {
+            header->next = AK_bitmap_take_block(meta);
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            address = header->next;
+            AK_bitmap_release(mem_block);
+            mem_block = NULL;
         }
+    } else
+        address = meta->dictionary = AK_bitmap_take_block(meta);
+    if (mem_block == NULL) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        memset(mem_block->block->data, 0, sizeof (AK_bitmap_page));
+        meta->last_dictionary = address;
     }
-    AK_free(temp_head);
-    i = 0;
-
-    while (addresses->address_from[ i ] != 0)
-    {
-
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-        {
-
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = br; k < DATA_BLOCK_SIZE; k = k + num_attr)
-            {
-                if (temp->tuple_dict[ k ].size > 0)
-                {
-
-                    switch (temp->tuple_dict[ k ].type)
-                    {
-                        case TYPE_INT:
-                        memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-                        break;
-                        case TYPE_FLOAT:
-                        memcpy(&temp_float, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-                        printf("float: %-10.2f", temp_float);
-                        break;
-
-                        case TYPE_VARCHAR:
-                        memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-
-                        memcpy(&addBlock, &(temp->data[ temp->tuple_dict[ k - br ].address]),
-                         temp->tuple_dict[0].size);
-
-                        memcpy(&indexTd, &(temp->data[ temp->tuple_dict[ k - (br - 1) ].address]),
-                         temp->tuple_dict[1].size);
-
-                        temp_char[ temp->tuple_dict[k].size ] = '\0';
-
-                        if (strcmp(temp_char, "1") == 0)
-                        {             
-                            AK_Insert_NewelementAd(addBlock, indexTd, attribute, add_root);
-                        }
-                        break;
-                    }
-                    if ((k + 1) % num_attr == 0)
-                        printf("\n");
+    header = (AK_bitmap_page *) mem_block->block->data;
+    memcpy((char *) (header + 1) + header->used, entry, sizeof (AK_bitmap_value));
+    if (entry->size > 0)
+        memcpy((char *) (header + 1) + header->used + sizeof (AK_bitmap_value), data, entry->size);
+    *page = address;
+    *offset = header->used;
+    header->count++;
+    header->used += bytes;
+    AK_bitmap_set_block_size(mem_block->block, sizeof (AK_bitmap_page) + header->used);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_bitmap_release(mem_block);
+    if (entry->size != AK_BITMAP_OTHER)
+        meta->num_values++;
+}
+
+/**
+ * @brief Function that adds a row id to or removes it from the bitmap of a value. Only the page holding the
+ * container of the row id is rewritten: a page that overflows is split in two, an emptied one is freed. Needs one
+ * reserved block.
+ * @param meta exclusively latched meta block
+ * @param first first page of the bitmap, updated
+ * @param row row id
+ * @param add 1 to add the row id, 0 to remove it
+ * @return 1 if the bitmap changed, 0 otherwise
+ */
+static int AK_bitmap_change_chain(AK_bitmap_meta *meta, int *first, unsigned int row, int add) {
+    unsigned int key = row >> AK_BITMAP_CHUNK_BITS;
+    AK_bitmap *bitmap = AK_bitmap_new();
+    AK_bitmap_page_container header;
+    AK_mem_block *mem_block;
+    int address = *first, previous = 0, next, changed, fit;
+
+    if (address == 0) {
+        if (add) {
+            AK_bitmap_add(bitmap, row);
+            *first = AK_bitmap_take_block(meta);
+            AK_bitmap_write_new_page(*first, bitmap->containers, bitmap->count, 0);
+        }
+        AK_bitmap_free(bitmap);
+        return add;
+    }
+
+    //the container belongs to the last page whose first key is not above the key
+    for (;;) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        next = ((AK_bitmap_page *) mem_block->block->data)->next;
+        AK_bitmap_release(mem_block);
+        if (next == 0)
+            break;
+        mem_block = AK_pin_block(next);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        memcpy(&header, mem_block->block->data + sizeof (AK_bitmap_page), sizeof (header));
+        AK_bitmap_release(mem_block);
+        if (header.key > key)
+            break;
+        previous = address;
+        address = next;
+    }
+
+    mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    next = AK_bitmap_read_page(mem_block->block, bitmap);
+    changed = add ? AK_bitmap_add(bitmap, row) : AK_bitmap_remove(bitmap, row);
+    if (changed && bitmap->count == 0) {
+        if (previous == 0)
+            *first = next;
+        else {
+            AK_mem_block *previous_block = AK_pin_block(previous);
+            AK_latch_block(previous_block, AK_LATCH_EXCLUSIVE);
+            ((AK_bitmap_page *) previous_block->block->data)->next = next;
+            AK_mem_block_modify(previous_block, BLOCK_DIRTY);
+            AK_bitmap_release(previous_block);
+        }
+        AK_bitmap_free_page(meta, mem_block);
+    } else if (changed) {
+        if ((fit = AK_bitmap_page_fit(bitmap->containers, bitmap->count)) < bitmap->count) {
+            //the containers that no longer fit go to a new page after this one
+            int split = AK_bitmap_take_block(meta);
+            AK_bitmap_write_new_page(split, bitmap->containers + fit, bitmap->count - fit, next);
+            next = split;
+        }
+        AK_bitmap_write_page(mem_block, bitmap->containers, fit, next);
+    }
+    AK_bitmap_release(mem_block);
+    AK_bitmap_free(bitmap);
+    return changed;
+}
+
+/**
+ * @brief Function that adds a row to or removes it from the bitmap of a value in an index. A row holding a value of
+ * another type than the attribute goes to the entry of such rows.
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @param row row id
+ * @param add 1 to add the row, 0 to remove it
+ * @return 1 if the index changed, 0 if not, EXIT_ERROR if the index does not exist
+ */
+static int AK_bitmap_change(char *indexName, int type, int size, char *data, unsigned int row, int add) {
+    char value[MAX_VARCHAR_LENGTH];
+    AK_mem_block *meta_block;
+    AK_bitmap_meta *meta;
+    AK_bitmap_value entry;
+    int page = 0, offset, changed = 0;
+
+    pthread_mutex_lock(&AK_bitmap_write_lock);
+    if ((meta_block = AK_bitmap_pin_built(indexName)) == NULL) {
+        pthread_mutex_unlock(&AK_bitmap_write_lock);
+        return EXIT_ERROR;
+    }
+    //a new dictionary page and a split page at most
+    if (AK_bitmap_reserve(indexName, meta_block, 2) == EXIT_ERROR) {
+        AK_unpin_block(meta_block);
+        pthread_mutex_unlock(&AK_bitmap_write_lock);
+        return EXIT_ERROR;
+    }
+    meta = (AK_bitmap_meta *) meta_block->block->data;
+    size = (type == meta->type) ? AK_bitmap_canonical(type, size, data, value) : AK_BITMAP_OTHER;
+
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    if (!AK_bitmap_find_value(meta, size, value, &page, &offset, &entry) && add) {
+        entry.first = 0;
+        entry.cardinality = 0;
+        entry.size = size;
+        AK_bitmap_add_value(meta, &entry, value, &page, &offset);
+    }
+    //a value keeps its entry when its last row goes, so the dictionary only grows
+    if (page != 0 && (changed = AK_bitmap_change_chain(meta, &entry.first, row, add))) {
+        entry.cardinality += add ? 1 : -1;
+        meta->num_rows += add ? 1 : -1;
+        AK_bitmap_set_value(page, offset, &entry);
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    }
+    AK_unlatch_block(meta_block);
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_bitmap_write_lock);
+    return changed;
+}
+
+/**
+ * @brief Function that writes a bitmap to new pages while an index is built
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @param bitmap bitmap
+ * @return first page, EXIT_ERROR if a block could not be taken
+ */
+static int AK_bitmap_build_chain(char *indexName, AK_mem_block *meta_block, AK_bitmap *bitmap) {
+    int first, address, next, from, fit;
+
+    if ((first = address = AK_bitmap_build_block(indexName, meta_block)) == EXIT_ERROR)
+        return EXIT_ERROR;
+    for (from = 0; from < bitmap->count; from += fit) {
+        fit = AK_bitmap_page_fit(bitmap->containers + from, bitmap->count - from);
+        next = 0;
+        if (from + fit < bitmap->count && (next = AK_bitmap_build_block(indexName, meta_block)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        AK_bitmap_write_new_page(address, bitmap->containers + from, fit, next);
+        address = next;
+    }
+    return first;
+}
+
+/**
+ * @brief Function that builds a bitmap index out of the rows of its table. The bitmaps of all values are collected
+ * in memory, in a hash table of the values, and each is written once. Called while AK_bitmap_write_lock is held.
+ * @param indexName name of the index
+ * @param tblName table name
+ * @param meta_block pinned meta block, not latched
+ * @return number of rows, EXIT_ERROR if a block could not be taken
+ */
+static int AK_bitmap_build(char *indexName, char *tblName, AK_mem_block *meta_block) {
+    AK_bitmap_meta *meta = (AK_bitmap_meta *) meta_block->block->data;
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *row, *el;
+    AK_bitmap **bitmaps;
+    AK_bitmap_value entry;
+    char value[MAX_VARCHAR_LENGTH], **values;
+    int *sizes, *slots, capacity = 64, num_values = 0, count = 0, result = EXIT_SUCCESS, size, slot, page, offset, i;
+
+    slots = (int *) AK_malloc(2 * capacity * sizeof (int));
+    memset(slots, -1, 2 * capacity * sizeof (int));
+    sizes = (int *) AK_malloc(capacity * sizeof (int));
+    values = (char **) AK_malloc(capacity * sizeof (char *));
+    bitmaps = (AK_bitmap **) AK_malloc(capacity * sizeof (AK_bitmap *));
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL) {
+        for (el = AK_First_L2(row), i = 0; el != NULL && i < meta->attribute; el = el->next, i++)
+            ;
+        if (el == NULL)
+            continue;
+        size = (el->type == meta->type) ? AK_bitmap_canonical(el->type, el->size, el->data, value) : AK_BITMAP_OTHER;
+        //open addressing with linear probing, the table is kept at most half full
+        slot = AK_hash_bytes(value, size > 0 ? size : 0, size) & (2 * capacity - 1);
+        while (slots[slot] >= 0 && (sizes[slots[slot]] != size || (size > 0 && memcmp(values[slots[slot]], value, size) != 0)))
+            slot = (slot + 1) & (2 * capacity - 1);
+        if (slots[slot] < 0) {
+            if (num_values == capacity) {
+                capacity *= 2;
+                sizes = (int *) AK_realloc(sizes, capacity * sizeof (int));
+                values = (char **) AK_realloc(values, capacity * sizeof (char *));
+                bitmaps = (AK_bitmap **) AK_realloc(bitmaps, capacity * sizeof (AK_bitmap *));
+                AK_free(slots);
+                slots = (int *) AK_malloc(2 * capacity * sizeof (int));
+                memset(slots, -1, 2 * capacity * sizeof (int));
+                for (i = 0; i < num_values; i++) {
+                    slot = AK_hash_bytes(values[i], sizes[i] > 0 ? sizes[i] : 0, sizes[i]) & (2 * capacity - 1);
+                    while (slots[slot] >= 0)
+                        slot = (slot + 1) & (2 * capacity - 1);
+                    slots[slot] = i;
                 }
+                slot = AK_hash_bytes(value, size > 0 ? size : 0, size) & (2 * capacity - 1);
+                while (slots[slot] >= 0)
+                    slot = (slot + 1) & (2 * capacity - 1);
             }
+            sizes[num_values] = size;
+            values[num_values] = (char *) AK_malloc(size > 0 ? size : 1);
+            memcpy(values[num_values], value, size > 0 ? size : 0);
+            bitmaps[num_values] = AK_bitmap_new();
+            slots[slot] = num_values++;
         }
-        i++;
+        AK_bitmap_add(bitmaps[slots[slot]], AK_BITMAP_ROW_ID(cursor->block, cursor->tuple - cursor->num_attr));
+        count++;
+    }
+    AK_table_cursor_close(cursor);
+
+    for (i = 0; i < num_values && result != EXIT_ERROR; i++) {
+        entry.size = sizes[i];
+        entry.cardinality = AK_bitmap_cardinality(bitmaps[i]);
+        if ((entry.first = AK_bitmap_build_chain(indexName, meta_block, bitmaps[i])) == EXIT_ERROR
+                || AK_bitmap_reserve(indexName, meta_block, 1) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        AK_bitmap_add_value(meta, &entry, values[i], &page, &offset);
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
+    }
+    for (i = 0; i < num_values; i++) {
+        AK_free(values[i]);
+        AK_bitmap_free(bitmaps[i]);
     }
+    AK_free(values);
+    AK_free(bitmaps);
+    AK_free(sizes);
+    AK_free(slots);
+    if (result == EXIT_ERROR)
+        return EXIT_ERROR;
+
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    meta->num_rows = count;
+    meta->built = 1;
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    return count;
+}
+
+int AK_create_bitmap_index(char *tblName, char *attribute, char *indexName) {
+    AK_header *t_header, i_header[MAX_ATTRIBUTES], *temp;
+    table_addresses *addresses;
+    AK_mem_block *meta_block;
+    AK_bitmap_meta *meta;
+    int num_attr, table_id, start, count, type, i;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0 || (t_header = AK_get_header(tblName)) == NULL) {
+        printf("AK_create_bitmap_index: ERROR. Table %s does not exist.\n", tblName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < num_attr && strcmp(t_header[i].att_name, attribute) != 0; i++)
+        ;
+    if (i == num_attr) {
+        printf("AK_create_bitmap_index: ERROR. Attribute %s does not exist in table %s.\n", attribute, tblName);
+        AK_free(t_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (!AK_bitmap_type_supported(type = t_header[i].type)) {
+        printf("AK_create_bitmap_index: ERROR. Attributes of type %d cannot be indexed.\n", type);
+        AK_free(t_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memset(i_header, 0, sizeof (i_header));
+    temp = (AK_header *) AK_create_header(t_header[i].att_name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header, temp, sizeof (AK_header));
+    AK_free(temp);
+    AK_free(t_header);
+    addresses = AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    if (start != 0) {
+        printf("AK_create_bitmap_index: ERROR. Index %s already exists.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    table_id = AK_get_table_obj_id(tblName);
+    pthread_mutex_lock(&AK_bitmap_write_lock);
+    if ((start = AK_initialize_new_index_segment(indexName, table_id, i, i_header)) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_bitmap_write_lock);
+        printf("AK_create_bitmap_index: ERROR. Cannot create the segment of index %s.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = AK_get_index_addresses(indexName);
+
+    //the meta block is the first block of the segment, lookups fail until the build is done
+    meta_block = AK_pin_block(start);
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    memset(meta_block->block->data, 0, sizeof (AK_bitmap_meta));
+    meta = (AK_bitmap_meta *) meta_block->block->data;
+    meta->magic = AK_BITMAP_MAGIC;
+    meta->table_id = table_id;
+    meta->attribute = i;
+    meta->type = type;
+    meta->next_block = start + 1;
+    meta->extent_end = addresses->address_to[0];
+    AK_bitmap_set_block_size(meta_block->block, sizeof (AK_bitmap_meta));
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    AK_free(addresses);
+
+    count = AK_bitmap_build(indexName, tblName, meta_block);
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_bitmap_write_lock);
+
+    if (count == EXIT_ERROR) {
+        printf("AK_create_bitmap_index: ERROR. Cannot build index %s.\n", indexName);
+        AK_delete_bitmap_index(indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(HIGH, INDICES, "AK_create_bitmap_index: index %s on %s has %d rows\n", indexName, tblName, count);
     AK_EPI;
-    return add_root;
-    AK_free(add_root);
+    return EXIT_SUCCESS;
 }
 
+void AK_create_Index_Table(char *tblName, struct list_node *attributes) {
+    struct list_node *attribute;
+    char indexName[MAX_VARCHAR_LENGTH];
+    AK_PRO;
 
-/**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that prints the list of adresses
- * @param list list of adresses
- * @return No return value
- **/
- void AK_print_Att_Test(list_ad *list)
- {
-    element_ad ele;
+    for (attribute = AK_First_L2(attributes); attribute != NULL; attribute = attribute->next) {
+        snprintf(indexName, MAX_VARCHAR_LENGTH, "%s%s_bmapIndex", tblName, attribute->attribute_name);
+        AK_create_bitmap_index(tblName, attribute->attribute_name, indexName);
+    }
+    AK_EPI;
+}
+
+int AK_delete_bitmap_index(char *indexName) {
+    int result;
+    AK_PRO;
+    pthread_mutex_lock(&AK_bitmap_write_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_mutex_unlock(&AK_bitmap_write_lock);
+    AK_EPI;
+    return result;
+}
+
+int AK_get_bitmap_info(char *indexName, AK_bitmap_meta *meta) {
+    AK_mem_block *mem_block;
     AK_PRO;
-    ele = AK_Get_First_elementAd(list);
 
-    while (ele != 0)
-    {
-        printf("Attribute : %s Block address: %i Index position: %i\n",ele->attName,ele->add.addBlock,ele->add.indexTd);
-        ele = AK_Get_Next_elementAd(ele);
+    if ((mem_block = AK_bitmap_pin_meta(indexName, AK_LATCH_SHARED)) == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
     }
+    memcpy(meta, mem_block->block->data, sizeof (AK_bitmap_meta));
+    AK_bitmap_release(mem_block);
     AK_EPI;
+    return EXIT_SUCCESS;
 }
 
-/**
- * @author Saša Vukšić
- * @brief Function that fetches the values from the bitmap index if there is one for a given table.
- * It should be started when we are making selection on the table with bitmap index.
- * @param tableName name of table
- * @param attributeValue value of attribute
- * @return list of adresses
- **/
- list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue)
- {
-    list_ad *list;
-    char inde[50];
-    char *indexName;
+int AK_bitmap_find_index(char *tblName, int attribute, char *indexName) {
+    AK_bitmap_index indexes[AK_BITMAP_MAX_INDEXES];
+    int count, i;
     AK_PRO;
 
-    list = (list_ad *) AK_malloc(sizeof (list_ad));
-    AK_InitializelistAd(list);
-    strcpy(inde, tableName);
-    indexName = strcat(inde, attributeName);
-    indexName = strcat(indexName, "_bmapIndex");
+    count = AK_bitmap_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++)
+        if (indexes[i].attribute == attribute) {
+            strcpy(indexName, indexes[i].name);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+    AK_EPI;
+    return EXIT_WARNING;
+}
 
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[ 0 ] == 0)
-    {
-        printf("There is no index for table: %s on attribute: %s", tableName, attributeName);
+/**
+ * @brief Function that checks a comparison of two values
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE
+ * @param result result of AK_bitmap_compare_values
+ * @return 1 if the comparison holds, 0 otherwise
+ */
+static int AK_bitmap_comparison_holds(int comparison, int result) {
+    switch (comparison) {
+        case AK_EXPR_EQ:
+            return result == 0;
+        case AK_EXPR_NE:
+            return result != 0;
+        case AK_EXPR_LT:
+            return result < 0;
+        case AK_EXPR_GT:
+            return result > 0;
+        case AK_EXPR_LE:
+            return result <= 0;
+        default:
+            return result >= 0;
     }
-    else
-    {
-        list = AK_get_attribute(indexName, attributeValue);
+}
+
+/**
+ * @brief Function that unites the bitmaps of the values of an index that compare to a value as asked. The meta block
+ * stays latched while the pages are read, so no writer changes them meanwhile.
+ * @param indexName name of index
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE, AK_BITMAP_ALL for every value
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @param others NULL to leave out the rows holding a value of another type, otherwise they are added and it is set
+ * to 1 if there are such rows
+ * @return bitmap, NULL if the index does not exist or the value is not of the type of the attribute
+ */
+static AK_bitmap *AK_bitmap_values(char *indexName, int comparison, int type, int size, char *data, int *others) {
+    char value[MAX_VARCHAR_LENGTH], *entries;
+    AK_mem_block *meta_block, *mem_block;
+    AK_bitmap *result, *bitmap, *united;
+    AK_bitmap_meta *meta;
+    AK_bitmap_page *header;
+    AK_bitmap_value entry;
+    int address, next, used, i;
+
+    if ((meta_block = AK_bitmap_pin_meta(indexName, AK_LATCH_SHARED)) == NULL)
+        return NULL;
+    meta = (AK_bitmap_meta *) meta_block->block->data;
+    if (!meta->built || (comparison != AK_BITMAP_ALL && type != meta->type)) {
+        AK_bitmap_release(meta_block);
+        return NULL;
+    }
+    if (comparison != AK_BITMAP_ALL)
+        size = AK_bitmap_canonical(type, size, data, value);
+    if (others != NULL)
+        *others = 0;
+
+    result = AK_bitmap_new();
+    for (address = meta->dictionary; address != 0; address = next) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        header = (AK_bitmap_page *) mem_block->block->data;
+        entries = (char *) (header + 1);
+        for (i = 0, used = 0; i < header->count; i++, used += AK_bitmap_value_bytes(entry.size)) {
+            memcpy(&entry, entries + used, sizeof (AK_bitmap_value));
+            if (entry.cardinality == 0)
+                continue;
+            if (entry.size == AK_BITMAP_OTHER) {
+                if (others == NULL)
+                    continue;
+                *others = 1;
+            } else if (comparison != AK_BITMAP_ALL && !AK_bitmap_comparison_holds(comparison,
+                    AK_bitmap_compare_values(type, entries + used + sizeof (AK_bitmap_value), entry.size, value, size)))
+                continue;
+            bitmap = AK_bitmap_read_chain(entry.first);
+            united = AK_bitmap_or(result, bitmap);
+            AK_bitmap_free(result);
+            AK_bitmap_free(bitmap);
+            result = united;
+        }
+        next = header->next;
+        AK_bitmap_release(mem_block);
     }
+    AK_bitmap_release(meta_block);
+    return result;
+}
+
+AK_bitmap *AK_bitmap_get(char *indexName, int type, int size, char *data) {
+    AK_bitmap *bitmap;
+    AK_PRO;
+    bitmap = AK_bitmap_values(indexName, AK_EXPR_EQ, type, size, data, NULL);
     AK_EPI;
-    return list;
+    return bitmap;
+}
+
+AK_bitmap *AK_bitmap_compare(char *indexName, int comparison, int type, int size, char *data) {
+    AK_bitmap *bitmap;
+    AK_PRO;
+    bitmap = AK_bitmap_values(indexName, comparison, type, size, data, NULL);
+    AK_EPI;
+    return bitmap;
 }
 
 /**
- * @author Saša Vukšić
- * @brief Function that updates the index, only on values that alredy exist. 
- * If there is no value in bitmap index or bitmap index on this value, warning is showed to the user. Otherwise, bitmap index is updated with new attribute value.
- * @param addBlock adress of block
- * @param addTD adress of tuple dict
- * @param tableName name of table
- * @param attributeName name of attribute
- * @param attributeValue value of atribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
- **/
- void AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue)
- {
-    char inde[50];
-    char *indexName;
-    int b, num_attr, k, j;
-    int i = 0;
-    int temp_adr_block;
-    int temp_adr_Td;
-    int pos;
-    int posNew = -1;
+ * @brief Function that reads the rows of a comparison of an attribute with a constant from a bitmap index
+ * @param indexes bitmap indexes of the table
+ * @param count number of indexes
+ * @param attribute attribute instruction
+ * @param constant constant instruction
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE
+ * @param t_header header of the table
+ * @param exact set to 0 if rows holding a value of another type were added
+ * @return bitmap holding every row that may satisfy the comparison, NULL if no index answers it
+ */
+static AK_bitmap *AK_bitmap_leaf(AK_bitmap_index *indexes, int count, AK_expression_instruction *attribute,
+        AK_expression_instruction *constant, int comparison, AK_header *t_header, int *exact) {
+    AK_bitmap *bitmap;
+    int others, i;
+
+    if (attribute->opcode != AK_EXPR_ATTRIBUTE || constant->opcode != AK_EXPR_CONSTANT || attribute->column >= MAX_ATTRIBUTES
+            || constant->type != t_header[attribute->column].type)
+        return NULL;
+    for (i = 0; i < count && indexes[i].attribute != attribute->column; i++)
+        ;
+    if (i == count || (bitmap = AK_bitmap_values(indexes[i].name, comparison, constant->type, constant->size, constant->data,
+            &others)) == NULL)
+        return NULL;
+    if (others)
+        *exact = 0;
+    return bitmap;
+}
+
+AK_bitmap *AK_bitmap_evaluate(char *tblName, AK_compiled_expression *compiled, AK_header *t_header, int *exact) {
+    AK_bitmap_index indexes[AK_BITMAP_MAX_INDEXES];
+    AK_expression_instruction *op, *a, *b;
+    AK_bitmap **stack, *lower, *upper, *result;
+    int count, num_results = 0, known = 1, comparison, i;
     AK_PRO;
-    strcpy(inde, tableName);
-    indexName = strcat(inde, attributeName);
-    indexName = strcat(indexName, "_bmapIndex");
-
-    AK_header *temp_head = AK_get_index_header(indexName);
-    num_attr = AK_num_index_attr(indexName);
-
-    for (i = 0; i < num_attr; i++)
-    {
-        if (strcmp((temp_head + i)->att_name, attributeValue) == 0)
-        {
-            pos = i;
+
+    if (exact != NULL)
+        *exact = 0;
+    if ((count = AK_bitmap_table_indexes(tblName, indexes)) == 0) {
+        AK_EPI;
+        return NULL;
+    }
+    //a NULL on the stack is a result no index knows, which may be true for any row
+    stack = (AK_bitmap **) AK_calloc(compiled->num_instructions + 1, sizeof (AK_bitmap *));
+    for (i = 0; i < compiled->num_instructions; i++) {
+        op = compiled->instructions + i;
+        switch (op->opcode) {
+            case AK_EXPR_COMPARE:
+                a = op - 2;
+                b = op - 1;
+                comparison = op->comparison;
+                if (a->opcode == AK_EXPR_CONSTANT) {
+                    a = op - 1;
+                    b = op - 2;
+                    comparison = (comparison == AK_EXPR_LT) ? AK_EXPR_GT : (comparison == AK_EXPR_GT) ? AK_EXPR_LT
+                        : (comparison == AK_EXPR_LE) ? AK_EXPR_GE : (comparison == AK_EXPR_GE) ? AK_EXPR_LE : comparison;
+                }
+                if ((stack[num_results++] = AK_bitmap_leaf(indexes, count, a, b, comparison, t_header, &known)) == NULL)
+                    known = 0;
+                break;
+            case AK_EXPR_BETWEEN:
+                lower = AK_bitmap_leaf(indexes, count, op - 3, op - 2, AK_EXPR_GE, t_header, &known);
+                upper = (lower != NULL) ? AK_bitmap_leaf(indexes, count, op - 3, op - 1, AK_EXPR_LE, t_header, &known) : NULL;
+                stack[num_results++] = (upper != NULL) ? AK_bitmap_and(lower, upper) : NULL;
+                if (upper == NULL)
+                    known = 0;
+                AK_bitmap_free(lower);
+                AK_bitmap_free(upper);
+                break;
+            case AK_EXPR_MATCH:
+                stack[num_results++] = NULL;
+                known = 0;
+                break;
+            case AK_EXPR_AND:
+                num_results--;
+                //a side no index knows leaves the other side, a superset of the rows
+                if (stack[num_results - 1] != NULL && stack[num_results] != NULL) {
+                    result = AK_bitmap_and(stack[num_results - 1], stack[num_results]);
+                    AK_bitmap_free(stack[num_results - 1]);
+                    AK_bitmap_free(stack[num_results]);
+                    stack[num_results - 1] = result;
+                } else if (stack[num_results - 1] == NULL)
+                    stack[num_results - 1] = stack[num_results];
+                break;
+            case AK_EXPR_OR:
+                num_results--;
+                if (stack[num_results - 1] != NULL && stack[num_results] != NULL)
+                    result = AK_bitmap_or(stack[num_results - 1], stack[num_results]);
+                else
+                    result = NULL;
+                AK_bitmap_free(stack[num_results - 1]);
+                AK_bitmap_free(stack[num_results]);
+                stack[num_results - 1] = result;
+                break;
         }
     }
+    result = (num_results == 1) ? stack[0] : NULL;
+    for (i = 1; i < num_results; i++)
+        AK_bitmap_free(stack[i]);
+    if (num_results > 1)
+        AK_bitmap_free(stack[0]);
+    AK_free(stack);
+    if (exact != NULL)
+        *exact = known && result != NULL;
+    AK_EPI;
+    return result;
+}
 
-    i = 0;
-    for (i = 0; i < num_attr; i++)
-    {
-            if (strcmp((temp_head + i)->att_name, attributeValue) == 0)
-            {
-                posNew = i;
-            }
-        }
+int AK_bitmap_count(char *tblName, struct list_node *expr) {
+    AK_header *t_header = (AK_header *) AK_get_header(tblName);
+    AK_compiled_expression *compiled;
+    AK_bitmap *bitmap = NULL;
+    int count = EXIT_WARNING, exact;
+    AK_PRO;
 
-        if (posNew == -1)
-        {
-            printf("Update is posible ONLY for existing values! \n");
-            AK_EPI;
-            exit(1);
-        }
+    if (t_header == NULL) {
+        AK_EPI;
+        return EXIT_WARNING;
+    }
+    if ((compiled = AK_compile_expression(expr, t_header, AK_num_attr(tblName))) != NULL)
+        bitmap = AK_bitmap_evaluate(tblName, compiled, t_header, &exact);
+    if (bitmap != NULL && exact)
+        count = AK_bitmap_cardinality(bitmap);
+    AK_bitmap_free(bitmap);
+    AK_free_compiled_expression(compiled);
+    AK_free(t_header);
+    AK_EPI;
+    return count;
+}
 
-        table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-        if (addresses->address_from[ 0 ] == 0)
-        {
-            printf("There is no index for table : %s on attribute: %s", tableName, attributeName);
+/**
+ * @brief Function that counts the rows holding the values of an index that compare to a value as asked, from the
+ * cardinalities kept in the dictionary, without reading the bitmaps
+ * @param indexName name of index
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @param num_rows set to the number of indexed rows
+ * @return number of rows, rows holding a value of another type included; EXIT_ERROR if the index cannot answer
+ */
+static int AK_bitmap_values_count(char *indexName, int comparison, int type, int size, char *data, int *num_rows) {
+    char value[MAX_VARCHAR_LENGTH], *entries;
+    AK_mem_block *meta_block, *mem_block;
+    AK_bitmap_meta *meta;
+    AK_bitmap_page *header;
+    AK_bitmap_value entry;
+    int address, next, used, i, count = 0;
+
+    if ((meta_block = AK_bitmap_pin_meta(indexName, AK_LATCH_SHARED)) == NULL)
+        return EXIT_ERROR;
+    meta = (AK_bitmap_meta *) meta_block->block->data;
+    if (!meta->built || type != meta->type) {
+        AK_bitmap_release(meta_block);
+        return EXIT_ERROR;
+    }
+    size = AK_bitmap_canonical(type, size, data, value);
+    *num_rows = meta->num_rows;
+    for (address = meta->dictionary; address != 0; address = next) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        header = (AK_bitmap_page *) mem_block->block->data;
+        entries = (char *) (header + 1);
+        for (i = 0, used = 0; i < header->count; i++, used += AK_bitmap_value_bytes(entry.size)) {
+            memcpy(&entry, entries + used, sizeof (AK_bitmap_value));
+            if (entry.size == AK_BITMAP_OTHER || AK_bitmap_comparison_holds(comparison,
+                    AK_bitmap_compare_values(type, entries + used + sizeof (AK_bitmap_value), entry.size, value, size)))
+                count += entry.cardinality;
         }
-        else
-        {
-            for (b = 0; b < num_attr; b++)
-            {
-                if (strcmp((temp_head + b)->att_name, attributeValue) == 0)
-                {
-                    i = 0;
-                    while (addresses->address_from[ i ] != 0)
-                    {
-                        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-                        {
-                            AK_block *temp = (AK_block*) AK_read_block(j);
-
-                            for (k = 0; k < DATA_BLOCK_SIZE; k = k + num_attr)
-                            {
-                                if (temp->tuple_dict[ k ].size > 0)
-                                {
-                                    memcpy(&temp_adr_block, &(temp->data[ temp->tuple_dict[ k ].address]), temp->tuple_dict[k].size);
-                                    memcpy(&temp_adr_Td, &(temp->data[ temp->tuple_dict[ k + 1 ].address]), temp->tuple_dict[k + 1].size);
-                                    printf("%i vs.%i, %i vs %i\n",temp_adr_block,addBlock,temp_adr_Td,addTd);
-
-                                    if ((temp_adr_block == addBlock) && (temp_adr_Td == addTd))
-                                    {
-                                        printf( "Block address: %d, Td address: %d segment:%i \n", temp_adr_block, temp_adr_Td, temp->address );
-
-                                        memcpy(&(temp->data[ temp->tuple_dict[ k + pos ].address]), "n", 1);
-                                        memset(&(temp->data[ temp->tuple_dict[ k + posNew ].address]), 0, 4);
-                                        memcpy(&(temp->data[ temp->tuple_dict[ k + posNew ].address]), "1", 1);                                
-                                        
-					AK_PRO;
-
-                                        AK_write_block(temp);
-                                    }
-                                }
-                            }
-
-                        }
-                        i++;
-                    }
+        next = header->next;
+        AK_bitmap_release(mem_block);
+    }
+    AK_bitmap_release(meta_block);
+    return count;
+}
+
+/**
+ * @brief Function that estimates the rows of a comparison of an attribute with a constant from a bitmap index
+ * @param indexes bitmap indexes of the table
+ * @param count number of indexes
+ * @param attribute attribute instruction
+ * @param constant constant instruction
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE
+ * @param t_header header of the table
+ * @param num_rows raised to the number of rows of the index
+ * @return number of rows, -1 if no index answers the comparison
+ */
+static double AK_bitmap_leaf_estimate(AK_bitmap_index *indexes, int count, AK_expression_instruction *attribute,
+        AK_expression_instruction *constant, int comparison, AK_header *t_header, int *num_rows) {
+    int rows, indexed, i;
+
+    if (attribute->opcode != AK_EXPR_ATTRIBUTE || constant->opcode != AK_EXPR_CONSTANT || attribute->column >= MAX_ATTRIBUTES
+            || constant->type != t_header[attribute->column].type)
+        return -1;
+    for (i = 0; i < count && indexes[i].attribute != attribute->column; i++)
+        ;
+    if (i == count || (rows = AK_bitmap_values_count(indexes[i].name, comparison, constant->type, constant->size,
+            constant->data, &indexed)) == EXIT_ERROR)
+        return -1;
+    if (indexed > *num_rows)
+        *num_rows = indexed;
+    return rows;
+}
+
+int AK_bitmap_estimate(char *tblName, AK_compiled_expression *compiled, AK_header *t_header, int *num_rows) {
+    AK_bitmap_index indexes[AK_BITMAP_MAX_INDEXES];
+    AK_expression_instruction *op, *a, *b;
+    double *stack, lower, upper, all;
+    int count, num_results = 0, comparison, i, rows = 0;
+    AK_PRO;
+
+    *num_rows = 0;
+    if ((count = AK_bitmap_table_indexes(tblName, indexes)) == 0) {
+        AK_EPI;
+        return EXIT_WARNING;
+    }
+    //the same walk as AK_bitmap_evaluate on counts: -1 is a result no index knows, sides of AND and OR are taken
+    //as independent once the number of rows is known
+    stack = (double *) AK_calloc(compiled->num_instructions + 1, sizeof (double));
+    for (i = 0; i < compiled->num_instructions; i++) {
+        op = compiled->instructions + i;
+        switch (op->opcode) {
+            case AK_EXPR_COMPARE:
+                a = op - 2;
+                b = op - 1;
+                comparison = op->comparison;
+                if (a->opcode == AK_EXPR_CONSTANT) {
+                    a = op - 1;
+                    b = op - 2;
+                    comparison = (comparison == AK_EXPR_LT) ? AK_EXPR_GT : (comparison == AK_EXPR_GT) ? AK_EXPR_LT
+                        : (comparison == AK_EXPR_LE) ? AK_EXPR_GE : (comparison == AK_EXPR_GE) ? AK_EXPR_LE : comparison;
                 }
-            }
+                stack[num_results++] = AK_bitmap_leaf_estimate(indexes, count, a, b, comparison, t_header, &rows);
+                break;
+            case AK_EXPR_BETWEEN:
+                lower = AK_bitmap_leaf_estimate(indexes, count, op - 3, op - 2, AK_EXPR_GE, t_header, &rows);
+                upper = (lower >= 0) ? AK_bitmap_leaf_estimate(indexes, count, op - 3, op - 1, AK_EXPR_LE, t_header, &rows) : -1;
+                //both bounds cover every row of the range and the rows of either side of it
+                stack[num_results++] = (upper >= 0) ? lower + upper - rows : -1;
+                if (upper >= 0 && stack[num_results - 1] < 0)
+                    stack[num_results - 1] = 0;
+                break;
+            case AK_EXPR_MATCH:
+                stack[num_results++] = -1;
+                break;
+            case AK_EXPR_AND:
+                num_results--;
+                if (stack[num_results - 1] >= 0 && stack[num_results] >= 0)
+                    stack[num_results - 1] = (rows > 0) ? stack[num_results - 1] * stack[num_results] / rows : 0;
+                else if (stack[num_results - 1] < 0)
+                    stack[num_results - 1] = stack[num_results];
+                break;
+            case AK_EXPR_OR:
+                num_results--;
+                if (stack[num_results - 1] >= 0 && stack[num_results] >= 0) {
+                    all = stack[num_results - 1] + stack[num_results];
+                    stack[num_results - 1] = all - ((rows > 0) ? stack[num_results - 1] * stack[num_results] / rows : 0);
+                } else
+                    stack[num_results - 1] = -1;
+                break;
         }
-        printf("Index %s updated for %s table\n",indexName,tableName);
-        AK_EPI;
     }
+    lower = (num_results == 1) ? stack[0] : -1;
+    AK_free(stack);
+    *num_rows = rows;
+    AK_EPI;
+    if (lower < 0)
+        return EXIT_WARNING;
+    return (int) (lower + 0.5);
+}
 
 /**
- * @author Saša Vukšić
- * @brief Function that writes the new value in block when index is updated
- * @param block block to write on
- * @return EXIT_SUCESS when write operation is successful, otherwise EXIT_ERROR
- **/
+ * @brief Function that finds the bitmap index of an attribute given by name and parses a value of the attribute
+ * @param tableName name of table
+ * @param attributeName name of attribute
+ * @param text value as text, may be NULL
+ * @param indexName set to the name of the index
+ * @param type set to the type of the attribute
+ * @param value buffer of MAX_VARCHAR_LENGTH bytes the value is parsed into
+ * @return size of the value, EXIT_ERROR if there is no index
+ */
+static int AK_bitmap_parse(char *tableName, char *attributeName, char *text, char *indexName, int *type, char *value) {
+    AK_header *t_header = (AK_header *) AK_get_header(tableName);
+    int num_attr = AK_num_attr(tableName), number, i;
+    double real;
+
+    if (t_header == NULL)
+        return EXIT_ERROR;
+    for (i = 0; i < num_attr && strcmp(t_header[i].att_name, attributeName) != 0; i++)
+        ;
+    if (i == num_attr || AK_bitmap_find_index(tableName, i, indexName) != EXIT_SUCCESS) {
+        AK_free(t_header);
+        return EXIT_ERROR;
+    }
+    *type = t_header[i].type;
+    AK_free(t_header);
+    if (text == NULL)
+        return 0;
+    switch (*type) {
+        case TYPE_INT:
+            number = atoi(text);
+            memcpy(value, &number, sizeof (int));
+            return sizeof (int);
+        case TYPE_NUMBER:
+            real = atof(text);
+            memcpy(value, &real, sizeof (double));
+            return sizeof (double);
+        default:
+            i = strnlen(text, MAX_VARCHAR_LENGTH - 1);
+            memcpy(value, text, i);
+            return i;
+    }
+}
 
-//TODO: Check the method uses and possibly delete unused code
-/* int AK_write_block(AK_block * block)
- {
-    //Legacy method -> not really working
+list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue) {
+    list_ad *list = (list_ad *) AK_malloc(sizeof (list_ad));
+    char indexName[MAX_VARCHAR_LENGTH], value[MAX_VARCHAR_LENGTH];
+    element_ad last = list;
+    AK_bitmap *bitmap = NULL;
+    struct_add *rows;
+    int type, size, count, i;
     AK_PRO;
-    //Method for updating should be implemented or reused some existing one...waiting for feedback
-    if ((db = fopen(DB_FILE, "r+")) == NULL)
-    {
-        printf("AK_write_block: ERROR. Cannot open db file %s.\n", DB_FILE);
+
+    AK_InitializelistAd(list);
+    if ((size = AK_bitmap_parse(tableName, attributeName, attributeValue, indexName, &type, value)) == EXIT_ERROR
+            || (bitmap = AK_bitmap_get(indexName, type, size, value)) == NULL) {
+        printf("There is no index for table: %s on attribute: %s\n", tableName, attributeName);
         AK_EPI;
-        exit(EXIT_ERROR);
+        return list;
     }
-    if (fseek(db, block->address * sizeof ( AK_block), SEEK_SET) != 0)
-    {
-        printf("AK_write_block: ERROR. Cannot set position to provided address block %d.\n", block->address);
-        AK_EPI;
-        exit(EXIT_ERROR);
+    count = AK_bitmap_rows(bitmap, &rows);
+    for (i = 0; i < count; i++) {
+        AK_Insert_NewelementAd(rows[i].addBlock, rows[i].indexTd, attributeName, last);
+        last = last->next;
     }
-    if (AK_fwrite(block, sizeof ( *block), 1, db) == 1)
-    {
-        fclose(db);
-        AK_dbg_messg(MIDDLE, INDICES, "AK_write_block: Written block at address %d\n", block->address * sizeof ( AK_block));
-        printf("AK_write_block: Written block at address %i items written: %i\n", block->address * sizeof ( AK_block),AK_fwrite(block, sizeof ( *block), 1, db));
-        AK_EPI;
-        return ( EXIT_SUCCESS);
+    AK_free(rows);
+    AK_bitmap_free(bitmap);
+    AK_EPI;
+    return list;
+}
+
+void AK_print_Att_Test(list_ad *list) {
+    element_ad ele;
+    AK_PRO;
+    for (ele = AK_Get_First_elementAd(list); ele != 0; ele = AK_Get_Next_elementAd(ele))
+        printf("Attribute : %s Block address: %i Index position: %i\n", ele->attName, ele->add.addBlock, ele->add.indexTd);
+    AK_EPI;
+}
 
+int AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue) {
+    char indexName[MAX_VARCHAR_LENGTH], value[MAX_VARCHAR_LENGTH], newValue[MAX_VARCHAR_LENGTH];
+    unsigned int row = AK_BITMAP_ROW_ID(addBlock, addTd);
+    int type, size, newSize, result;
+    AK_PRO;
+
+    if ((size = AK_bitmap_parse(tableName, attributeName, attributeValue, indexName, &type, value)) == EXIT_ERROR) {
+        printf("AK_update: ERROR. There is no bitmap index on %s.%s.\n", tableName, attributeName);
+        AK_EPI;
+        return EXIT_ERROR;
     }
-    else
-    {
-        printf("AK_write_block: ERROR. Cannot write block at provided address %d.\n", block->address);
+    newSize = AK_bitmap_parse(tableName, attributeName, newAttributeValue, indexName, &type, newValue);
+    if ((result = AK_bitmap_change(indexName, type, size, value, row, 0)) != 1) {
+        printf("AK_update: WARNING. Row %d/%d is not indexed under value %s.\n", addBlock, addTd, attributeValue);
         AK_EPI;
-        exit(EXIT_ERROR);
+        return (result == EXIT_ERROR) ? EXIT_ERROR : EXIT_WARNING;
     }
-    }*/
+    AK_bitmap_change(indexName, type, newSize, newValue, row, 1);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
+int AK_add_to_bitmap_index(char *tableName, char *attributeName) {
+    char indexName[MAX_VARCHAR_LENGTH], value[MAX_VARCHAR_LENGTH];
+    AK_table_cursor *cursor;
+    struct list_node *row, *el;
+    AK_bitmap *indexed;
+    unsigned int id;
+    int type, others, added = 0, i;
+    AK_PRO;
+
+    if (AK_bitmap_parse(tableName, attributeName, NULL, indexName, &type, value) == EXIT_ERROR
+            || (indexed = AK_bitmap_values(indexName, AK_BITMAP_ALL, type, 0, NULL, &others)) == NULL) {
+        printf("AK_add_to_bitmap_index: ERROR. There is no bitmap index on %s.%s.\n", tableName, attributeName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    cursor = AK_table_cursor_open(tableName);
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL) {
+        id = AK_BITMAP_ROW_ID(cursor->block, cursor->tuple - cursor->num_attr);
+        if (AK_bitmap_contains(indexed, id))
+            continue;
+        for (el = AK_First_L2(row), i = 0; el != NULL && strcmp(el->attribute_name, attributeName) != 0; el = el->next, i++)
+            ;
+        if (el != NULL && AK_bitmap_change(indexName, el->type, el->size, el->data, id, 1) == 1)
+            added++;
+    }
+    AK_table_cursor_close(cursor);
+    AK_bitmap_free(indexed);
+    AK_EPI;
+    return added;
+}
 
 /**
- * @author Lovro Predovan
- * @brief Function that updates the index. Function deletes and recreates the index values again if different number of params is detected 
- * @param tableName name of table
- * @param attributeName name of attribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
- **/
- void AK_add_to_bitmap_index(char *tableName, char *attributeName)
- {
-    char inde[50];
-    char *tblNameIndex;
-    int tbl_num_rows, idx_num_rows;
+ * @brief Function that adds a row to or removes it from the bitmap indexes of its table
+ * @param tblName table name
+ * @param type types of the values of the row
+ * @param size sizes of the values of the row
+ * @param data values of the row
+ * @param row row id
+ * @param add 1 to add the row, 0 to remove it
+ */
+static void AK_bitmap_change_row(char *tblName, int *type, int *size, char **data, unsigned int row, int add) {
+    AK_bitmap_index indexes[AK_BITMAP_MAX_INDEXES];
+    char values[AK_BITMAP_MAX_INDEXES][MAX_VARCHAR_LENGTH];
+    int sizes[AK_BITMAP_MAX_INDEXES], count, attribute, i;
+
+    //the values are copied before any index is changed, they may point into a cached block
+    count = AK_bitmap_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++) {
+        attribute = indexes[i].attribute;
+        //tuples of a row that was moved or deleted are cleared
+        if (attribute >= MAX_ATTRIBUTES || (type[attribute] == TYPE_INTERNAL && size[attribute] == 0)) {
+            sizes[i] = EXIT_ERROR;
+            continue;
+        }
+        sizes[i] = AK_bitmap_canonical(type[attribute], size[attribute], data[attribute], values[i]);
+    }
+    for (i = 0; i < count; i++)
+        if (sizes[i] != EXIT_ERROR)
+            AK_bitmap_change(indexes[i].name, type[indexes[i].attribute], sizes[i], values[i], row, add);
+}
 
+void AK_bitmap_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple) {
     AK_PRO;
-    strcpy(inde, tableName);
-    tblNameIndex = strcat(inde, attributeName);
-    tblNameIndex = strcat(tblNameIndex, "_bmapIndex");
-
-    idx_num_rows = AK_get_index_num_records(tblNameIndex);
-    tbl_num_rows = AK_get_num_records(tableName);
-
-    //This may not be the best method but it's damn effective one
-    if(tbl_num_rows > idx_num_rows){
-        AK_delete_bitmap_index(tblNameIndex);
-        struct list_node *att_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-        AK_Init_L3(&att_root);
-        AK_Insert_New_Element(TYPE_VARCHAR, attributeName, tableName, attributeName, att_root);
-        AK_create_Index_Table(tableName, att_root);
-    }
-    printf("Index %s updated for %s table\n",tblNameIndex,tableName);
+    AK_bitmap_change_row(tblName, type, size, data, AK_BITMAP_ROW_ID(block, tuple), 1);
     AK_EPI;
 }
 
-
 /**
- * @author Saša Vukšić
- * @brief Function that tests printing header of table
- * @param tblName name of table who's header we are printing
-   @return No return value
- **/
-   void AK_print_Header_Test(char* tblName)
-   {
-    AK_header *temp_head;
+ * @brief Function that reads the values of a row stored in a block
+ */
+static void AK_bitmap_tuple_values(AK_block *block, int tuple, int *type, int *size, char **data) {
     int i;
-    int num_attr;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        if (block->header[i].att_name[0] != '\0' && tuple + i < DATA_BLOCK_SIZE) {
+            type[i] = AK_tuple_type(block, tuple + i);
+            size[i] = AK_tuple_size(block, tuple + i);
+            data[i] = (char *) AK_tuple_data(block, tuple + i);
+        } else {
+            type[i] = TYPE_INTERNAL;
+            size[i] = 0;
+            data[i] = NULL;
+        }
+    }
+}
+
+void AK_bitmap_index_tuple(char *tblName, AK_block *block, int tuple) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
     AK_PRO;
-    temp_head = AK_get_header(tblName);
-    num_attr = AK_num_attr(tblName);
-    printf("Number of attributes in header: %d", num_attr);
-    printf("\n");
-    for (i = 0; i < num_attr; i++)
-        printf("%-10s", (temp_head + i)->att_name);
-    printf("\n----------------------------------------------\n");
-    AK_free(temp_head);
+    AK_bitmap_tuple_values(block, tuple, type, size, data);
+    AK_bitmap_change_row(tblName, type, size, data, AK_BITMAP_ROW_ID(block->address, tuple), 1);
     AK_EPI;
 }
 
-/**
- * @author Lovro Predovan
- * @brief Function that deletes bitmap index based on the name of index
- * @param Bitmap index table name
-   @return No return value
- **/
-   void AK_delete_bitmap_index(char *indexName) {
+void AK_bitmap_unindex_tuple(char *tblName, AK_block *block, int tuple) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+    AK_bitmap_tuple_values(block, tuple, type, size, data);
+    AK_bitmap_change_row(tblName, type, size, data, AK_BITMAP_ROW_ID(block->address, tuple), 0);
     AK_EPI;
 }
 
-
+/**
+ * @brief Function that writes rows of ids, colors and sizes for the bitmap index test
+ * @param tblName table name
+ * @param num_rows number of rows
+ */
+static void AK_bitmap_test_rows(char *tblName, int num_rows) {
+    AK_header header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "color", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "size", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    int type[3] = {TYPE_INT, TYPE_VARCHAR, TYPE_INT}, size[3] = {sizeof (int), 0, sizeof (int)}, id, value;
+    char *data[3], color[MAX_VARCHAR_LENGTH];
+    AK_table_writer *writer;
+
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    writer = AK_table_writer_open(tblName);
+    for (id = 0; id < num_rows; id++) {
+        sprintf(color, "color%d", id % 20);
+        value = id % 7;
+        data[0] = (char *) &id;
+        data[1] = color;
+        data[2] = (char *) &value;
+        size[1] = strlen(color);
+        AK_table_writer_append_values(writer, type, size, data);
+    }
+    AK_table_writer_close(writer);
+}
 
 /**
- * @author Saša Vukšić updated by Lovro Predovan
- * @brief Function that creates test table and makes index on test table,
-    also prints original tables indexes tables and indexes, tests updating into tables
- * @return No return value
- * */
- TestResult AK_bitmap_test()
- {
-    int id_prof;
-    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+ * @brief Function that counts the rows of a bitmap whose id satisfies a condition on the colors and sizes of the
+ * test rows, and checks that no other row is in it
+ * @param bitmap bitmap
+ * @param num_rows number of test rows
+ * @param test 0 for color3, 1 for color3 or size 2, 2 for size 2 and color other than color9, 3 for ids of sizes
+ * 1 to 3 and colors below color5
+ * @return number of rows, -1 if a row that does not satisfy the condition is in the bitmap
+ */
+static int AK_bitmap_test_check(AK_bitmap *bitmap, int num_rows, int test) {
+    struct_add *rows;
+    int count, satisfied = 0, id, i;
+    char color[MAX_VARCHAR_LENGTH];
+    AK_mem_block *mem_block;
+
+    count = AK_bitmap_rows(bitmap, &rows);
+    for (i = 0; i < count; i++) {
+        mem_block = AK_get_block(rows[i].addBlock);
+        memcpy(&id, AK_tuple_data(mem_block->block, rows[i].indexTd), sizeof (int));
+        sprintf(color, "color%d", id % 20);
+        if ((test == 0 && id % 20 == 3) || (test == 1 && (id % 20 == 3 || id % 7 == 2))
+                || (test == 2 && id % 7 == 2 && id % 20 != 9) || (test == 3 && id % 7 >= 1 && id % 7 <= 3 && strcmp(color, "color5") < 0))
+            satisfied++;
+    }
+    AK_free(rows);
+    return (satisfied == count) ? count : -1;
+}
 
+/**
+ * @brief Function that gives the number of test rows satisfying a condition of AK_bitmap_test_check
+ */
+static int AK_bitmap_test_expected(int num_rows, int test) {
+    char color[MAX_VARCHAR_LENGTH];
+    int count = 0, id;
+
+    for (id = 0; id < num_rows; id++) {
+        sprintf(color, "color%d", id % 20);
+        if ((test == 0 && id % 20 == 3) || (test == 1 && (id % 20 == 3 || id % 7 == 2))
+                || (test == 2 && id % 7 == 2 && id % 20 != 9) || (test == 3 && id % 7 >= 1 && id % 7 <= 3 && strcmp(color, "color5") < 0))
+            count++;
+    }
+    return count;
+}
 
+TestResult AK_bitmap_test() {
+    char *tblName = "bitmap_test", *colorIndex = "bitmap_testcolor_bmapIndex", *sizeIndex = "bitmap_testsize_bmapIndex";
+    int num_rows = 5000, ok = 0, fail = 0, counts[4], i, id, value, low, high;
+    AK_header *t_header = NULL;
+    struct list_node *attributes, *expr, *row;
+    AK_compiled_expression *compiled;
+    AK_bitmap *a, *b, *c, *bitmap;
+    AK_bitmap_meta meta;
+    AK_access_path path[2];
+    list_ad *list;
+    element_ad ele;
     AK_PRO;
-    printf("\n********** BITMAP INDEX TEST **********\n\n");
-
-    //INDEXED TABLE
-    char *tblName = "assistant";
-
-    //CREATING BITMAP INDEXES ON ATTRIBUTES FIRSTNAME AND TEL
-    struct list_node *att_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&att_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "firstname", tblName, "firstname", att_root);
-    
-
-    struct list_node *some_element;
-    some_element = (struct list_node *) AK_First_L2(att_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "tel", tblName, "tel", some_element);
-    AK_create_Index_Table(tblName, att_root);
-
-
-    AK_print_table(tblName);
-    AK_print_table("AK_index");
-
-    printf("\n************Index tables******************\n\n");
-    AK_print_index_table("assistantfirstname_bmapIndex");
-    AK_print_index_table("assistanttel_bmapIndex");
-
-    printf("Bitmap index tables should be now visible\n");
-
-
-    //Test value that doesn't passes
-    printf("\n\n************Printing non existing index table******************\n\n");
-    AK_print_index_table("assistanrandom_bmapIndex");
-    printf("\n\n***************************************\n\n");
-
-
-    printf("\n\n************Updating table indexes******************\n\n");
-    AK_Init_L3(&row_root);
-    id_prof = 35890;
-    AK_DeleteAll_L3(&row_root);
-    AK_Insert_New_Element(TYPE_INT, &id_prof, tblName, "id_prof", row_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "Miran", tblName, "firstname", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "Zlatović", tblName, "lastname", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_INT, "042390858", tblName, "tel", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "miran.zlatovic@foi.hr", tblName, "email", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "www.foi.hr/nastavnici/zlatovic.miran/index.html", tblName, "web_page", row_root);
-    AK_insert_row(row_root);
-    AK_DeleteAll_L3(&row_root);
-    AK_free(row_root);
-
-    AK_add_to_bitmap_index(tblName, "firstname");
-
-    AK_print_table(tblName);
-    AK_print_index_table("assistantfirstname_bmapIndex");
-    
-    printf("\n\n************Searching index locations******************\n\n");
-    AK_print_Att_Test(AK_get_Attribute(tblName,"firstname","Markus"));
-    AK_print_Att_Test(AK_get_Attribute(tblName,"tel","858928176"));
-    
-     printf("\n\n************Deleting bitmap index******************\n\n");
-    AK_delete_bitmap_index("assistantfirstname_bmapIndex");
-
-    AK_print_table("AK_index");
-
-
-    printf("\n\n********** BITMAP INDEX TEST END**********\n\n");
-    printf("\n\n BITMAP INDEX TEST PASSED\n\n");
+
+    //sparse and dense containers, the dense ones are bitsets
+    a = AK_bitmap_new();
+    b = AK_bitmap_new();
+    for (i = 0; i < 10000; i++)
+        AK_bitmap_add(a, 3 * i);
+    for (i = 0; i < 10000; i++)
+        AK_bitmap_add(b, 100000 + 5 * i);
+    AK_bitmap_add(b, 0);
+    AK_bitmap_add(b, 3);
+    AK_bitmap_add(b, 4);
+    c = AK_bitmap_and(a, b);
+    bitmap = AK_bitmap_or(a, b);
+    counts[0] = AK_bitmap_cardinality(c);
+    counts[1] = AK_bitmap_cardinality(bitmap);
+    AK_bitmap_free(c);
+    AK_bitmap_free(bitmap);
+    c = AK_bitmap_andnot(b, a);
+    counts[2] = AK_bitmap_cardinality(c);
+    //only 0 and 3 are in both
+    if (a->count == 1 && a->containers[0].bits != NULL && counts[0] == 2 && counts[1] == 20001 && counts[2] == 10001
+            && AK_bitmap_contains(c, 4) && !AK_bitmap_contains(c, 3)
+            && AK_bitmap_remove(a, 3) && !AK_bitmap_remove(a, 3) && !AK_bitmap_contains(a, 3))
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Bitmap operations returned %d, %d and %d row ids.\n", counts[0], counts[1], counts[2]);
+        fail++;
+    }
+    for (i = 0; i < 10000; i++)
+        AK_bitmap_remove(a, 3 * i);
+    if (a->count == 0 && AK_bitmap_cardinality(a) == 0)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. %d row ids are left in an emptied bitmap.\n", AK_bitmap_cardinality(a));
+        fail++;
+    }
+    AK_bitmap_free(a);
+    AK_bitmap_free(b);
+    AK_bitmap_free(c);
+
+    AK_bitmap_test_rows(tblName, num_rows);
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_Insert_New_Element(TYPE_VARCHAR, "color", tblName, "color", attributes);
+    AK_Insert_New_Element(TYPE_VARCHAR, "size", tblName, "size", attributes);
+    AK_create_Index_Table(tblName, attributes);
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    if (AK_get_bitmap_info(colorIndex, &meta) == EXIT_SUCCESS && meta.built && meta.num_values == 20 && meta.num_rows == num_rows
+            && AK_get_bitmap_info(sizeIndex, &meta) == EXIT_SUCCESS && meta.num_values == 7 && meta.num_rows == num_rows)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Indexes of %s were not built.\n", tblName);
+        fail++;
+    }
+    printf("index %s: %d values of %d rows in %d pages\n", sizeIndex, meta.num_values, meta.num_rows, meta.num_pages);
+
+    bitmap = AK_bitmap_get(colorIndex, TYPE_VARCHAR, strlen("color3"), "color3");
+    if (bitmap != NULL && AK_bitmap_test_check(bitmap, num_rows, 0) == num_rows / 20)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Bitmap of color3 is wrong.\n");
+        fail++;
+    }
+    AK_bitmap_free(bitmap);
+
+    //expressions are answered by the bitmaps and counted without reading the table
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    value = 2;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color3", sizeof ("color3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "size", sizeof ("size"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &value, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr);
+    counts[0] = AK_bitmap_count(tblName, expr);
+    AK_selection(tblName, "bitmap_test_sel_or", expr);
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &value, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "size", sizeof ("size"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color9", sizeof ("color9"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<>", sizeof ("<>"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    counts[1] = AK_bitmap_count(tblName, expr);
+    AK_selection(tblName, "bitmap_test_sel_ne", expr);
+    AK_DeleteAll_L3(&expr);
+    low = 1;
+    high = 3;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "size", sizeof ("size"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &low, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &high, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color5", sizeof ("color5"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    counts[2] = AK_bitmap_count(tblName, expr);
+    t_header = (AK_header *) AK_get_header(tblName);
+    compiled = AK_compile_expression(expr, t_header, AK_num_attr(tblName));
+    bitmap = AK_bitmap_evaluate(tblName, compiled, t_header, &i);
+    counts[3] = (bitmap != NULL && i) ? AK_bitmap_test_check(bitmap, num_rows, 3) : -1;
+    AK_bitmap_free(bitmap);
+    AK_free_compiled_expression(compiled);
+    AK_selection(tblName, "bitmap_test_sel_range", expr);
+    printf("bitmap counts: %d, %d and %d rows\n", counts[0], counts[1], counts[2]);
+    if (counts[0] == AK_bitmap_test_expected(num_rows, 1) && AK_get_num_records("bitmap_test_sel_or") == counts[0]
+            && counts[1] == AK_bitmap_test_expected(num_rows, 2) && AK_get_num_records("bitmap_test_sel_ne") == counts[1]
+            && counts[2] == AK_bitmap_test_expected(num_rows, 3) && counts[3] == counts[2]
+            && AK_get_num_records("bitmap_test_sel_range") == counts[2])
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Bitmap counts and selections do not match the rows.\n");
+        fail++;
+    }
+
+    //a conjunct no index answers leaves a superset, which is not counted
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &high, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color3", sizeof ("color3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_selection(tblName, "bitmap_test_sel_superset", expr);
+    if (AK_bitmap_count(tblName, expr) == EXIT_WARNING && AK_get_num_records("bitmap_test_sel_superset") == num_rows / 20 - 1)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Selection with a conjunct no index answers returned %d rows.\n",
+            AK_get_num_records("bitmap_test_sel_superset"));
+        fail++;
+    }
+
+    //the bitmaps are read for a value of a twentieth of the rows, not for all values but one
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color3", sizeof ("color3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_selection_explain(tblName, expr, &path[0]);
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color9", sizeof ("color9"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<>", sizeof ("<>"), expr);
+    AK_selection_explain(tblName, expr, &path[1]);
+    if (path[0].method == AK_ACCESS_BITMAP && path[0].estimated_rows == num_rows / 20 && path[0].table_rows == num_rows
+            && path[1].method == AK_ACCESS_SCAN)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Selections chose access paths %d and %d.\n", path[0].method, path[1].method);
+        fail++;
+    }
+
+    //inserts, updates and deletes through fileio keep the bitmaps exact
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "color", sizeof ("color"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "color3", sizeof ("color3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    id = num_rows;
+    value = 3;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "color3", tblName, "color", row);
+    AK_Insert_New_Element(TYPE_INT, &value, tblName, "size", row);
+    AK_insert_row(row);
+    AK_DeleteAll_L3(&row);
+    counts[0] = AK_bitmap_count(tblName, expr);
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "color4", tblName, "color", row);
+    AK_update_row(row);
+    AK_DeleteAll_L3(&row);
+    counts[1] = AK_bitmap_count(tblName, expr);
+    list = AK_get_Attribute(tblName, "color", "color4");
+    for (ele = AK_Get_First_elementAd(list), counts[3] = 0; ele != 0; ele = AK_Get_Next_elementAd(ele))
+        counts[3]++;
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row);
+    AK_delete_row(row);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    counts[2] = AK_bitmap_count(tblName, expr);
+    AK_get_bitmap_info(sizeIndex, &meta);
+    if (counts[0] == num_rows / 20 + 1 && counts[1] == num_rows / 20 && counts[2] == num_rows / 20
+            && counts[3] == num_rows / 20 + 1 && meta.num_rows == num_rows)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. color3 counts after insert, update and delete were %d, %d and %d.\n",
+            counts[0], counts[1], counts[2]);
+        fail++;
+    }
+    while ((ele = AK_Get_First_elementAd(list)) != 0)
+        AK_Delete_elementAd(ele, list);
+    AK_free(list);
+
+    //a row moved to another value and back through the index functions, rows are only added once
+    list = AK_get_Attribute(tblName, "color", "color7");
+    ele = AK_Get_First_elementAd(list);
+    counts[0] = (ele != 0) ? AK_update(ele->add.addBlock, ele->add.indexTd, tblName, "color", "color7", "color8") : EXIT_ERROR;
+    counts[1] = AK_bitmap_count(tblName, expr);
+    counts[2] = (ele != 0) ? AK_update(ele->add.addBlock, ele->add.indexTd, tblName, "color", "color7", "color8") : EXIT_ERROR;
+    if (ele != 0)
+        AK_update(ele->add.addBlock, ele->add.indexTd, tblName, "color", "color8", "color7");
+    if (counts[0] == EXIT_SUCCESS && counts[1] == num_rows / 20 && counts[2] == EXIT_WARNING
+            && AK_add_to_bitmap_index(tblName, "color") == 0)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Updates through the index functions returned %d and %d.\n", counts[0], counts[2]);
+        fail++;
+    }
+    while ((ele = AK_Get_First_elementAd(list)) != 0)
+        AK_Delete_elementAd(ele, list);
+    AK_free(list);
+
+    AK_delete_bitmap_index(sizeIndex);
+    if (AK_get_bitmap_info(sizeIndex, &meta) == EXIT_ERROR && AK_bitmap_find_index(tblName, 2, colorIndex) == EXIT_WARNING)
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Index %s was not dropped.\n", sizeIndex);
+        fail++;
+    }
+
+    //the index on assistant stays for the DROP INDEX test
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_Insert_New_Element(TYPE_VARCHAR, "firstname", "assistant", "firstname", attributes);
+    AK_Insert_New_Element(TYPE_VARCHAR, "tel", "assistant", "tel", attributes);
+    AK_create_Index_Table("assistant", attributes);
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    if (AK_get_bitmap_info("assistantfirstname_bmapIndex", &meta) == EXIT_SUCCESS && meta.num_rows == AK_get_num_records("assistant"))
+        ok++;
+    else {
+        printf("AK_bitmap_test: ERROR. Indexes of assistant were not built.\n");
+        fail++;
+    }
+
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+    AK_free(t_header);
     AK_EPI;
-    return TEST_result(0,0);
+    return TEST_result(ok, fail);
 }
@@ -27,22 +27,244 @@
 #include "../../file/fileio.h"
 #include "../../file/files.h"
 #include "../../auxi/mempro.h"
+#include "../../rel/expression_check.h"
+#include <pthread.h>
 
 /**
-  @author Saša Vukšić
-  @brief Function that examines whether list L contains operator ele
-  @param L list of elements
-  @param ele operator to be found in list
-  @return 1 if operator ele is found in list, otherwise 0
+ * @def AK_BITMAP_MAGIC
+ * @brief Constant declaring the value that marks the meta block of a bitmap index
  */
-int AK_If_ExistOp(struct list_node *L, char *ele);
+#define AK_BITMAP_MAGIC 0x426d7049
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that reads table on which we create index and call functions for creating index
-           Elements that will be in index are put in list indexLista and headerAttributes. According to those elements new indexes
-           are created.
+ * @def AK_BITMAP_PAGE_SIZE
+ * @brief Constant declaring the number of bytes of a block a bitmap index page can use
+ */
+#define AK_BITMAP_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+
+/**
+ * @def AK_BITMAP_CHUNK_BITS
+ * @brief Constant declaring the number of low bits of a row id a container holds, the bits above are its key. A
+ * bitset container of 2^15 rows fits into one page.
+ */
+#define AK_BITMAP_CHUNK_BITS 15
+
+/**
+ * @def AK_BITMAP_CHUNK_SIZE
+ * @brief Constant declaring the number of row ids a container covers
+ */
+#define AK_BITMAP_CHUNK_SIZE (1 << AK_BITMAP_CHUNK_BITS)
+
+/**
+ * @def AK_BITMAP_CHUNK_WORDS
+ * @brief Constant declaring the number of 64-bit words of a bitset container
+ */
+#define AK_BITMAP_CHUNK_WORDS (AK_BITMAP_CHUNK_SIZE / 64)
+
+/**
+ * @def AK_BITMAP_ARRAY_MAX
+ * @brief Constant declaring the largest number of rows of an array container, an array of more rows takes more
+ * room than a bitset
+ */
+#define AK_BITMAP_ARRAY_MAX (AK_BITMAP_CHUNK_SIZE / 16)
+
+/**
+ * @def AK_BITMAP_MAX_INDEXES
+ * @brief Constant declaring the maximum number of bitmap indexes kept in the list of indexes
+ */
+#define AK_BITMAP_MAX_INDEXES 64
+
+/**
+ * @def AK_BITMAP_ROW_ID
+ * @brief Macro that gives the row id of the row at a tuple dictionary index of a block
+ */
+#define AK_BITMAP_ROW_ID(block, tuple) ((unsigned int) (block) * DATA_BLOCK_SIZE + (unsigned int) (tuple))
+
+/**
+ * @struct AK_bitmap_container
+ * @brief Structure that defines the rows of a bitmap whose row ids share the bits above AK_BITMAP_CHUNK_BITS. Up
+ * to AK_BITMAP_ARRAY_MAX rows are kept in a sorted array, more in a bitset.
+ */
+typedef struct {
+    /// row id >> AK_BITMAP_CHUNK_BITS
+    unsigned int key;
+    int cardinality;
+    /// sorted low bits of the row ids of an array container, NULL for a bitset
+    unsigned short *array;
+    int capacity;
+    /// AK_BITMAP_CHUNK_WORDS words of a bitset container, NULL for an array
+    unsigned long long *bits;
+} AK_bitmap_container;
+
+/**
+ * @struct AK_bitmap
+ * @brief Structure that defines a compressed bitmap of row ids, its containers are sorted by key
+ */
+typedef struct {
+    int count;
+    int capacity;
+    AK_bitmap_container *containers;
+} AK_bitmap;
+
+/**
+ * @struct AK_bitmap_meta
+ * @brief Structure that defines the meta block of a bitmap index, the first block of its segment
+ */
+typedef struct {
+    /// AK_BITMAP_MAGIC
+    int magic;
+    /// obj_id of the indexed table
+    int table_id;
+    /// index and type of the indexed attribute
+    int attribute;
+    int type;
+    /// 1 once the build is done, lookups fail before that
+    int built;
+    /// number of distinct values and of indexed rows
+    int num_values;
+    int num_rows;
+    /// first and last page of the value dictionary
+    int dictionary;
+    int last_dictionary;
+    int num_pages;
+    /// pages freed by deletes, chained through their next page
+    int free_page;
+    int num_free;
+    /// next unused block of the segment and the end of its extent
+    int next_block;
+    int extent_end;
+} AK_bitmap_meta;
+
+/**
+ * @struct AK_bitmap_page
+ * @brief Structure that starts a page of a bitmap index. A dictionary page is followed by AK_bitmap_value entries, a
+ * page of a value by AK_bitmap_page_container headers, each followed by its array or bitset.
+ */
+typedef struct {
+    /// number of values or containers
+    int count;
+    /// next page of the dictionary or of the value, 0 for the last page
+    int next;
+    /// bytes used after the page header
+    int used;
+} AK_bitmap_page;
+
+/**
+ * @struct AK_bitmap_value
+ * @brief Structure that defines an entry of the value dictionary, it is followed by the value padded to 4 bytes
+ */
+typedef struct {
+    /// first page of the bitmap of the value, 0 if no row holds the value
+    int first;
+    int cardinality;
+    int size;
+} AK_bitmap_value;
 
+/**
+ * @struct AK_bitmap_page_container
+ * @brief Structure that starts a container stored in a page, an array is padded to 4 bytes
+ */
+typedef struct {
+    unsigned int key;
+    int cardinality;
+} AK_bitmap_page_container;
+
+/**
+ * @struct AK_bitmap_index
+ * @brief Structure that defines a bitmap index found in the system catalog
+ */
+typedef struct {
+    char name[MAX_VARCHAR_LENGTH];
+    int table_id;
+    int attribute;
+    int type;
+    /// address of the meta block
+    int meta;
+} AK_bitmap_index;
+
+/**
+ * @brief Function that creates an empty bitmap
+ * @return bitmap
+ */
+AK_bitmap *AK_bitmap_new();
+
+/**
+ * @brief Function that frees a bitmap
+ * @param bitmap bitmap, may be NULL
+ */
+void AK_bitmap_free(AK_bitmap *bitmap);
+
+/**
+ * @brief Function that adds a row id to a bitmap
+ * @param bitmap bitmap
+ * @param row row id
+ * @return 1 if the row id was added, 0 if it was in the bitmap
+ */
+int AK_bitmap_add(AK_bitmap *bitmap, unsigned int row);
+
+/**
+ * @brief Function that removes a row id from a bitmap
+ * @param bitmap bitmap
+ * @param row row id
+ * @return 1 if the row id was removed, 0 if it was not in the bitmap
+ */
+int AK_bitmap_remove(AK_bitmap *bitmap, unsigned int row);
+
+/**
+ * @brief Function that checks whether a bitmap holds a row id
+ * @param bitmap bitmap
+ * @param row row id
+ * @return 1 if it does, 0 otherwise
+ */
+int AK_bitmap_contains(AK_bitmap *bitmap, unsigned int row);
+
+/**
+ * @brief Function that intersects two bitmaps
+ * @return new bitmap
+ */
+AK_bitmap *AK_bitmap_and(AK_bitmap *a, AK_bitmap *b);
+
+/**
+ * @brief Function that unites two bitmaps
+ * @return new bitmap
+ */
+AK_bitmap *AK_bitmap_or(AK_bitmap *a, AK_bitmap *b);
+
+/**
+ * @brief Function that gives the row ids of the first bitmap that are not in the second one
+ * @return new bitmap
+ */
+AK_bitmap *AK_bitmap_andnot(AK_bitmap *a, AK_bitmap *b);
+
+/**
+ * @brief Function that counts the row ids of a bitmap
+ * @param bitmap bitmap
+ * @return number of row ids
+ */
+int AK_bitmap_cardinality(AK_bitmap *bitmap);
+
+/**
+ * @brief Function that gives the addresses of the rows of a bitmap in block order
+ * @param bitmap bitmap
+ * @param rows set to an array of row addresses the caller frees
+ * @return number of rows
+ */
+int AK_bitmap_rows(AK_bitmap *bitmap, struct_add **rows);
+
+/**
+ * @author Saša Vukšić, rewritten as a compressed bitmap index
+ * @brief Function that creates a bitmap index on an attribute. The index keeps a dictionary of the distinct values
+ * of the attribute and a compressed bitmap of the rows of each value in its own segment.
+ * @param tblName name of table
+ * @param attribute name of the indexed attribute
+ * @param indexName name of index
+ * @return EXIT_SUCCESS, EXIT_ERROR if the attribute cannot be indexed or the index cannot be built
+ */
+int AK_create_bitmap_index(char *tblName, char *attribute, char *indexName);
+
+/**
+ * @author Saša Vukšić, Lovro Predovan
+ * @brief Function that creates a bitmap index named <table><attribute>_bmapIndex on each attribute of a list
  * @param tblName name of table
  * @param attributes list of attributes on which we will create indexes
  * @return No return value
@@ -50,104 +272,159 @@ int AK_If_ExistOp(struct list_node *L, char *ele);
 void AK_create_Index_Table(char *tblName, struct list_node *attributes);
 
 /**
- * @author Saša Vukšić
- * @brief Function that tests printing header of table
- * @param tblName name of table who's header we are printing
-   @return No return value
+ * @author Lovro Predovan
+ * @brief Function that deletes bitmap index based on the name of index
+ * @param indexName bitmap index name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment could not be deleted
  **/
-void AK_print_Header_Test(char* tblName);
+int AK_delete_bitmap_index(char *indexName);
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that loads index table with the value of particulary atribute
- * @param tblName source table
- * @param tblNameIndex new name of index table
- * @param attributeName attribute on which we make index
- * @param positionTbl position of attribute in header of table
- * @param numAtributes number of attributes in table
- * @param headerIndex header of index table
- * @return No return value
+ * @brief Function that copies the meta block of a bitmap index
+ * @param indexName name of index
+ * @param meta copy of the meta block
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index does not exist
  */
-void AK_create_Index(char *tblName, char *tblNameIndex, char *attributeName, int positionTbl, int numAtributes, AK_header *headerIndex);
+int AK_get_bitmap_info(char *indexName, AK_bitmap_meta *meta);
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that gets adresses of the particuliar attribute from bitmap index. It fetches addresses of indexes and header
-          of index table.  Using while loop it goes through index and gets necessary data. That data is put in a list called
-          add_root.
+ * @brief Function that finds a bitmap index on an attribute of a table
+ * @param tblName table name
+ * @param attribute index of the attribute
+ * @param indexName buffer of MAX_VARCHAR_LENGTH characters the index name is copied to
+ * @return EXIT_SUCCESS, EXIT_WARNING if there is no such index
+ */
+int AK_bitmap_find_index(char *tblName, int attribute, char *indexName);
+
+/**
+ * @brief Function that reads the bitmap of the rows holding a value
  * @param indexName name of index
- * @param attribute name of attribute
- * @return list of adresses
- **/
-list_ad* AK_get_attribute(char *indexName, char *attribute);
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @return bitmap, empty if no row holds the value; NULL if the index does not exist
+ */
+AK_bitmap *AK_bitmap_get(char *indexName, int type, int size, char *data);
 
+/**
+ * @brief Function that unites the bitmaps of the values that compare to a constant as asked
+ * @param indexName name of index
+ * @param comparison AK_EXPR_EQ ... AK_EXPR_GE
+ * @param type type of the constant
+ * @param size size of the constant
+ * @param data constant
+ * @return bitmap, NULL if the index does not exist or the constant is not of the type of the attribute
+ */
+AK_bitmap *AK_bitmap_compare(char *indexName, int comparison, int type, int size, char *data);
 
-void AK_create_List_Address_Test();
+/**
+ * @brief Function that evaluates a compiled expression with the bitmap indexes of a table. Comparisons of an indexed
+ * attribute with a constant of its type are read from the indexes, AND and OR are done on the bitmaps. A conjunct
+ * no index answers leaves a superset of the rows.
+ * @param tblName table name
+ * @param compiled compiled expression
+ * @param t_header header of the table
+ * @param exact set to 1 if the bitmap holds exactly the rows satisfying the expression, may be NULL
+ * @return bitmap, NULL if the indexes do not narrow the rows down
+ */
+AK_bitmap *AK_bitmap_evaluate(char *tblName, AK_compiled_expression *compiled, AK_header *t_header, int *exact);
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that prints the list of adresses
- * @param list list of adresses
- * @return No return value
- **/
-void AK_print_Att_Test(list_ad *list);
+ * @brief Function that counts the rows of a table satisfying an expression by the cardinality of bitmaps, for
+ * COUNT(*) with a WHERE clause the bitmap indexes answer
+ * @param tblName table name
+ * @param expr list with posfix notation of the logical expression
+ * @return number of rows, EXIT_WARNING if the indexes cannot answer the expression
+ */
+int AK_bitmap_count(char *tblName, struct list_node *expr);
+
+/**
+ * @brief Function that estimates the rows of a table satisfying an expression from the cardinalities of the values
+ * in the bitmap indexes, without reading a bitmap. Conjuncts and disjuncts are taken as independent.
+ * @param tblName table name
+ * @param compiled compiled expression
+ * @param t_header header of the table
+ * @param num_rows set to the number of rows of the indexes, 0 if the table has none
+ * @return estimated number of rows, EXIT_WARNING if the indexes do not narrow the rows down
+ */
+int AK_bitmap_estimate(char *tblName, AK_compiled_expression *compiled, AK_header *t_header, int *num_rows);
 
 /**
  * @author Saša Vukšić
  * @brief Function that fetches the values from the bitmap index if there is one for a given table.
  * It should be started when we are making selection on the table with bitmap index.
  * @param tableName name of table
- * @param attributeValue value of attribute
+ * @param attributeName name of the indexed attribute
+ * @param attributeValue value of attribute as text
  * @return list of adresses
  **/
 list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue);
 
+/**
+ * @author Saša Vukšić, Lovro Predovan
+ * @brief Function that prints the list of adresses
+ * @param list list of adresses
+ * @return No return value
+ **/
+void AK_print_Att_Test(list_ad *list);
+
 /**
  * @author Saša Vukšić
- * @brief Function that updates the index, only on values that alredy exist. 
- * If there is no value in bitmap index or bitmap index on this value, warning is showed to the user. Otherwise, bitmap index is updated with new attribute value.
+ * @brief Function that moves a row from the bitmap of its old value to the bitmap of its new value
  * @param addBlock adress of block
- * @param addTD adress of tuple dict
+ * @param addTd adress of tuple dict
  * @param tableName name of table
  * @param attributeName name of attribute
- * @param attributeValue value of atribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
+ * @param attributeValue old value of the attribute as text
+ * @param newAttributeValue new value of the attribute as text
+ * @return EXIT_SUCCESS, EXIT_WARNING if the row was not indexed under the old value, EXIT_ERROR if there is no index
  **/
-void AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue);
+int AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue);
 
 /**
- * @author Saša Vukšić
- * @brief Function that writes the new value in block when index is updated
- * @param block block to write on
- * @return EXIT_SUCESS when write operation is successful, otherwise EXIT_ERROR
+ * @author Lovro Predovan
+ * @brief Function that adds the rows of a table that are not in the bitmap index of an attribute, rows written while
+ * the index was not maintained
+ * @param tableName name of table
+ * @param attributeName name of attribute
+ * @return number of rows added, EXIT_ERROR if there is no index
  **/
-int AK_write_block(AK_block * block);
+int AK_add_to_bitmap_index(char *tableName, char *attributeName);
 
 /**
- * @author Saša Vukšić updated by Lovro Predovan
- * @brief Function that creates test table and makes index on test table,
-    also prints original tables indexes tables and indexes, tests updating into tables
- * @return No return value
- * */
-TestResult AK_bitmap_test();
+  * @brief Function that adds a row to the bitmap indexes of its table
+  * @param tblName table name
+  * @param type types of the values of the row
+  * @param size sizes of the values of the row
+  * @param data values of the row
+  * @param block address of the block of the row
+  * @param tuple tuple dictionary index of the first value of the row
+ */
+void AK_bitmap_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple);
 
 /**
- * @author Lovro Predovan
- * @brief Function that deletes bitmap index based on the name of index
- * @param Bitmap index table name
-   @return No return value
- **/
-void AK_delete_bitmap_index(char *indexName);
+  * @brief Function that adds a row stored in a block to the bitmap indexes of its table
+  * @param tblName table name
+  * @param block block of the row
+  * @param tuple tuple dictionary index of the first value of the row
+ */
+void AK_bitmap_index_tuple(char *tblName, AK_block *block, int tuple);
 
 /**
- * @author Lovro Predovan
- * @brief Function that updates the index. Function deletes and recreates the index values again if different number of params is detected 
- * @param tableName name of table
- * @param attributeName name of attribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
- **/
-void AK_add_to_bitmap_index(char *tableName, char *attributeName);
+  * @brief Function that removes a row stored in a block from the bitmap indexes of its table, called before the row
+  * is deleted or changed
+  * @param tblName table name
+  * @param block block of the row
+  * @param tuple tuple dictionary index of the first value of the row
+ */
+void AK_bitmap_unindex_tuple(char *tblName, AK_block *block, int tuple);
+
+/**
+ * @author Saša Vukšić updated by Lovro Predovan, rewritten for the compressed bitmap index
+ * @brief Function that tests bitmap indexes: building, set operations, selections, COUNT(*) and maintenance on
+ * insert, update and delete
+ * @return test result
+ * */
+TestResult AK_bitmap_test();
 
 #endif
@@ -6,747 +6,1597 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
 #include "btree.h"
+#include "../filesearch.h"
+#include "../../rel/selection.h"
+
+/// serializes the changes of all B+tree indexes, lookups only take block latches
+static pthread_mutex_t AK_btree_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/// keys of the node being changed, used while AK_btree_write_lock is held
+static AK_btree_entry AK_btree_entries[AK_BTREE_MAX_ENTRIES + 1];
+static unsigned char AK_btree_entry_keys[(AK_BTREE_MAX_ENTRIES + 1) * AK_BTREE_MAX_KEY];
+
+/// bytes of a node that are used, lowered by the test to get trees with more levels out of fewer rows
+static int AK_btree_node_size = AK_BTREE_NODE_SIZE;
+
+/// B+tree indexes found in AK_index, reloaded when the catalog changes; -1 until they are loaded
+static AK_btree_index AK_btree_indexes[AK_BTREE_MAX_INDEXES];
+static int AK_btree_num_indexes = -1;
+static unsigned long AK_btree_indexes_version;
+static pthread_mutex_t AK_btree_indexes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Function that stores an int in big-endian byte order, so the bytes compare like the unsigned value
+ * @param value value
+ * @param key buffer of 4 bytes
+ */
+static void AK_btree_put_int(unsigned int value, unsigned char *key) {
+    key[0] = value >> 24;
+    key[1] = value >> 16;
+    key[2] = value >> 8;
+    key[3] = value;
+}
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
-  * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
-  * @param indexName - name of the index
- */
-/* 
-NOTES: 1. For now we assume that table is sorted on attribute on which we are
-creating index. We should check that with filesort.c and include it in this function.
-That file had some errors, so I couldn't test it. 2.working with multiple blocks
-*/
-int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName){
-	int i,n,exist;
-	table_addresses *addresses;
-	int num_attr;
-	AK_PRO;
-	addresses = (table_addresses*) AK_get_table_addresses(tblName);
-	num_attr = AK_num_attr(tblName);
-
-	while(addresses->address_from[ i ]){
-		printf("\nAddress of the TABLE is from %u to %u \n",(addresses->address_from[ i ]),(addresses->address_to[ i ]));
-		i++;
-	}
-	AK_header *table_header = (AK_header *)AK_get_header(tblName);
-    	struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-	AK_header i_header[ MAX_ATTRIBUTES ];
-	AK_header* temp;
-    	n = 0;
-	while (attribute != 0) {
-		exist = 0;
-		for (i = 0; i < num_attr; i++) {
-		    if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-			printf("Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			exist = 1;
-			temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-			memcpy(i_header + n, temp, sizeof ( AK_header));
-			n++;
-			if ((table_header)->type != TYPE_INT) {
-			    printf("Unsupported data type for bree index! Only int!");
-			    AK_EPI;
-			    return EXIT_ERROR;
-			}
-		    }
-		}
-		if (!exist) {
-		    printf("Attribute %s does not exists in table", attribute->data);
-		    AK_EPI;
-		    return EXIT_ERROR;
-		}
-		attribute = attribute->next;
-	} 
-	memset(i_header + n, 0, MAX_ATTRIBUTES - n);
-
-	int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-	if (startAddress != EXIT_ERROR)
-		printf("\nINDEX %s CREATED!\n", indexName);
-        int r;
-	table_addresses *addIndex = (table_addresses*) AK_get_index_addresses(indexName);
-	while(addIndex->address_from[ r ]){
-		printf("\nAddress of the INDEX is from %u to %u \n",(addIndex->address_from[ r ]),(addIndex->address_to[ r ]));
-		r++;
-	}
-	AK_block *block = (AK_block*) AK_read_block(startAddress);
-	int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	int number_el = AK_get_num_records(tblName);			
-	root_info *rootEl = (root_info*) AK_malloc(sizeof(root_info));
-
-	//number of LEAFS--------------------B=3---------------number_leaf
-	float x = (float) number_el;
-	float y = x/B;
-	int number_leaf = 0;
-	while(y > 0){
-		y = y - 1;
-		number_leaf = number_leaf + 1;
-	}//instead of ceil function
-	rootEl->level[0] = number_leaf;
-
-	//number of NODES (level above leafs)--------(B+1)-----number_node
-	float m = (float) number_leaf;
-	float node = m/(B+1);
-	int number_node = 0;
-	while(node > 0){
-		node = node - 1;
-		number_node = number_node + 1;
-	}//instead of ceil function
-	rootEl->level[1] = number_node;
-
-	//number of NODES (remaining nodes)---------(B+1)------number_node
-	float temp_one = (float) number_node;
-	int temp_two = 0;
-	int lvl = 2;
-	int go = 1;
-	while(go == 1){
-		node = temp_one/(B+1);
-		temp_two = 0;
-		while(node > 0){
-			node = node - 1;
-			temp_two = temp_two + 1;
-		}
-		rootEl->level[lvl] = temp_two;
-		lvl++;
-		number_node = number_node + temp_two;
-		temp_one = (float) temp_two;
-		if(temp_two == 1)
-			go = 0;
-	}
-	//writing root_info
-	rootEl->root = number_leaf + number_node;
-	memcpy(block->data, rootEl, sizeof(root_info));
-	block->tuple_dict[0].address = 0;
-	block->tuple_dict[0].type = BLOCK_TYPE_NORMAL;
-    	block->tuple_dict[0].size = sizeof (root_info);
-	block->AK_free_space += sizeof (root_info);
-	block->last_tuple_dict_id = 0;
-	AK_write_block(block);
-	//writting leafs
-	int id,lf,b,help=0,elements=0;
-	int help_two[number_el];
-	for(lf=1;lf<=(rootEl->level[0]);lf++){
-		btree_node *leaf = (btree_node*) AK_malloc(sizeof(btree_node));
-		i=0;
-		AK_block *temp = (AK_block*) AK_read_block(addresses->address_from[ i ]);
-
-		for(b=0;b<B;b++){
-			if(elements<number_el){
-				leaf->pointers[b].addBlock = addresses->address_from[ i ];
-				leaf->pointers[b].indexTd = help;
-				void *tem = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void));
-	      		        memcpy(tem, &(temp->data[temp->tuple_dict[help].address]), sizeof (int));
-				leaf->values[b] = *((int *) tem);
-				help_two[elements] = leaf->values[b];
-				help += num_attr;
-				elements++;
-			}else{
-				leaf->values[b] = -1;
-				elements++;
-			}
-		}
-		if(lf<(rootEl->level[0])){
-			leaf->pointers[B].addBlock = addresses->address_from[ i ];
-			leaf->pointers[B].indexTd = lf+1;
-		}	
-		memcpy(&block->data[block->AK_free_space], leaf, sizeof(btree_node));    
-		id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		AK_write_block(block);
-	}
-	//writting nodes
-	int no=1,v=1,d,e=0,f,h,offset,diff,skip=1,check;
-	while(no==1){
-		check=0;
-		offset=1;
-		for(h=0;h<e;h++)////instead of pow function
-			offset = offset*(B+1); 
-		diff = offset * B;//difference WITHIN node
-		offset = offset * B + 1;
-		for(d=0;d<(rootEl->level[v]);d++){
-			btree_node *nodes = (btree_node*) AK_malloc(sizeof(btree_node));
-			for(f=0;f<B;f++){
-				if((offset-1)<number_el){
-					nodes->values[f] = help_two[offset-1];
-				}else{
-					nodes->values[f] = -1;
-				}
-				offset += diff;//difference WITHIN node
-			}
-			offset += diff;//difference BETWEEN nodes is doubled
-			for(f=0;f<=B;f++){
-					if(check<(rootEl->level[v-1])){
-						nodes->pointers[f].indexTd = skip;
-						nodes->pointers[f].addBlock = adr_to_write;
-						skip++;
-						check++;
-					}	
-			}
-			memcpy(&block->data[block->AK_free_space], nodes, sizeof(btree_node)); 
-			id = block->last_tuple_dict_id + 1;
-			block->tuple_dict[id].address = block->AK_free_space;
-			block->tuple_dict[id].type = NODE;
-			block->AK_free_space += sizeof(btree_node);
-			block->last_tuple_dict_id = id;
-			AK_write_block(block);
-		}		
-		e++;
-		if(rootEl->level[v] == 1)
-			no = 0;
-		v++;
-	}
-	printf("B tree created succesfully.");
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-
-int AK_btree_delete(char *indexName){
+ * @brief Function that reads an int stored by AK_btree_put_int
+ * @param key 4 bytes
+ * @return value
+ */
+static unsigned int AK_btree_get_int(const unsigned char *key) {
+    return ((unsigned int) key[0] << 24) | ((unsigned int) key[1] << 16) | ((unsigned int) key[2] << 8) | key[3];
+}
+
+int AK_btree_encode_value(int type, const char *data, int size, unsigned char *key) {
+    unsigned long long bits;
+    double number;
+    float single;
+    int integer, length;
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+
+    switch (type) {
+        case TYPE_VARCHAR:
+            length = (size < MAX_VARCHAR_LENGTH) ? size : MAX_VARCHAR_LENGTH;
+            length = strnlen(data, length);
+            memcpy(key, data, length);
+            //the terminator keeps a value lower than the values it is a prefix of
+            key[length] = 0;
+            AK_EPI;
+            return length + 1;
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+            if (size != sizeof (int))
+                break;
+            memcpy(&integer, data, sizeof (int));
+            AK_btree_put_int((unsigned int) integer ^ 0x80000000u, key);
+            AK_EPI;
+            return sizeof (int);
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            if (size == sizeof (double))
+                memcpy(&number, data, sizeof (double));
+            else if (size == sizeof (float)) {
+                memcpy(&single, data, sizeof (float));
+                number = single;
+            } else
+                break;
+            memcpy(&bits, &number, sizeof (double));
+            //negative values are ordered backwards, so all their bits are flipped
+            bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+            AK_btree_put_int(bits >> 32, key);
+            AK_btree_put_int(bits, key + 4);
+            AK_EPI;
+            return sizeof (double);
+    }
     AK_EPI;
+    return EXIT_ERROR;
+}
+
+int AK_btree_compare(const unsigned char *a, int a_length, const unsigned char *b, int b_length) {
+    int result = memcmp(a, b, (a_length < b_length) ? a_length : b_length);
+    return result != 0 ? result : a_length - b_length;
+}
+
+void AK_btree_range_init(AK_btree_range *range) {
+    range->lower_length = -1;
+    range->lower_inclusive = 1;
+    range->upper_length = -1;
+    range->upper_inclusive = 1;
+}
+
+void AK_btree_range_lower(AK_btree_range *range, const unsigned char *value, int length, int inclusive) {
+    int result = (range->lower_length < 0) ? 1 : AK_btree_compare(value, length, range->lower, range->lower_length);
+    if (result > 0 || (result == 0 && !inclusive)) {
+        memcpy(range->lower, value, length);
+        range->lower_length = length;
+        range->lower_inclusive = inclusive;
+    }
+}
+
+void AK_btree_range_upper(AK_btree_range *range, const unsigned char *value, int length, int inclusive) {
+    int result = (range->upper_length < 0) ? -1 : AK_btree_compare(value, length, range->upper, range->upper_length);
+    if (result < 0 || (result == 0 && !inclusive)) {
+        memcpy(range->upper, value, length);
+        range->upper_length = length;
+        range->upper_inclusive = inclusive;
+    }
 }
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
- */
-void AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo){
-	int contin = 1;
-        AK_PRO;
-	if((searchValue == endRange) || (endRange <= 0)){
-		endRange = 0;
-		contin = 0;
-	}
-	if(searchValue > endRange){
-		int help = *searchValue;
-		searchValue = endRange;
-		endRange = &help;
-	}
-
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	AK_block *block = (AK_block*) AK_read_block(adr_to_read);
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-
-	int address= block->tuple_dict[root->root].address;
-	int type = block->tuple_dict[root->root].type; //node == 1, leaf == 0
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*searchValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		
-		}
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-	}
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[address],sizeof(btree_node));
-	int f,found = 0,idNext;
-	for(f=0;f<B;f++){
-		if(*searchValue == (temp->values[f])){
-			found = 1;
-		}
-		if((found == 1) && (temp->values[f] <= *endRange) && (*endRange > 0)) {
-			printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);	
-			if(*toDo == 1){
-				temp->values[f] = -1;
-				temp->pointers[f].addBlock = 0;
-				temp->pointers[f].indexTd = 0;
-				memcpy(&block->data[address],temp,sizeof(btree_node));
-				AK_write_block(block);
-				printf("\n Value deleted!");
-			}
-		}
-		idNext=temp->pointers[B].indexTd;
-	}
-	if(found == 0){
-		printf("\n Value not found!");
-	}
-	while(contin == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[block->tuple_dict[idNext].address],sizeof(btree_node));
-		for(f=0;f<B;f++){
-			if((temp->values[f]) <= *endRange){
-				printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);
-				if(*toDo == 1){
-					temp->values[f] = -1;
-					temp->pointers[f].addBlock = 0;
-					temp->pointers[f].indexTd = 0;
-					memcpy(&block->data[idNext],temp,sizeof(btree_node));
-					printf("\n Value deleted!");
-				}
-			}else
-				contin = 0;
-		idNext=temp->pointers[B].indexTd;
-		AK_write_block(block);
-		}
-	}
-	AK_EPI;
-}
-
-//TODO: Add description of the function AK_btree_insert as well as params
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock){
-	AK_PRO;
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	AK_block *block = (AK_block*) AK_read_block(adr_to_read);
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-	int insertPath[ORDER];//id of the selected node, iP[0] root
-	int insertIndexPath[ORDER];//index of a pointer selected in node, iIP[0] is index selected in root
-	int address = block->tuple_dict[root->root].address;
-	insertPath[0] = root->root;
-	int type = block->tuple_dict[root->root].type;
-	int inc=1;
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*insertValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		}
-		insertIndexPath[inc-1] = goTo;
-		insertPath[inc] = temp->pointers[goTo].indexTd;
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-		if(type == 1){
-			inc++;
-		}//node == 1, leaf == 0
-	}
-	int j;
-	int destinationAddress = block->tuple_dict[insertPath[inc]].address;
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[destinationAddress],sizeof(btree_node));
-	int AK_freeSpace = 0;
-	for(j=0;j<B;j++){
-		if(temp->values[j] == -1){
-			AK_freeSpace++;
-		}
-	}
-	int inserted = 0,increase=0;
-	btree_node *temp_help = (btree_node*) AK_malloc(sizeof(btree_node));
-	memset(temp_help,0,sizeof(btree_node));
-	if(AK_freeSpace != 0){ //we have FREE space in LEAF
-		for(j=0;j<B;j++){
-			if(inserted == 0){
-				if(*insertValue < temp->values[increase]){
-					temp_help->values[j] = *insertValue;
-					temp_help->pointers[j].indexTd = *insertTd;
-					temp_help->pointers[j].addBlock = *insertBlock;
-					inserted = 1;	
-				}else{
-					if(temp->values[increase] == -1){
-						temp_help->values[j] = *insertValue;
-						temp_help->pointers[j].indexTd = *insertTd;
-						temp_help->pointers[j].addBlock = *insertBlock;
-						inserted = 1;
-					}else{
-						temp_help->values[j] = temp->values[increase];
-						temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-						temp_help->pointers[j].addBlock = temp->pointers[increase].addBlock;
-						increase++;
-					}
-				}
-			}else{
-				temp_help->values[j] = temp->values[increase];
-				temp_help->pointers[j] = temp->pointers[increase];
-				increase++;
-			}	
-		}
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node));
-		AK_write_block(block);
-		printf("\nNew value is added in leaf with available space");	
-	}else{//we have to SPLIT the LEAF
-		btree_node *temp_help_two = (btree_node*) AK_malloc(sizeof(btree_node));
-		memset(temp_help_two,0,sizeof(btree_node));
-		int stop=0;
-		int numberElementsFirst,numberElementsSecond;
-		int numberPointersFirst,numberPointersSecond;
-		int amount = B % 2;
-		if(amount == 0){//uneven number of pointers (B+1)%2 = 1
-			//we need to insert B+1 elements in two leafs -> 4+1=3+2
-			numberElementsFirst = (B/2) + 1; //B=4,(4/2)+1=3 elements in first leaf
-			numberElementsSecond = B/2; //B=4,(4/2)=2 elements in second leaf
-			numberPointersFirst = (B + 2)/2;  //B=4, (B+1+1)/2 = 3 pointers in first LEAF
-			numberPointersSecond = (B + 2)/2; //B=4, (B+1+1)/2 = 3 pointers in second LEAF
-		}else{//even number of pointers (B+1)%2 = 0
-			//we need to insert B+1 elements in two leafs -> 3+1=2+2
-			numberElementsFirst = (B + 1)/2; //B=3,(3+1)/2=2 elements in first leaf
-			numberElementsSecond = (B + 1)/2; //B=3,(3+1)/2=2 elements in second leaf 
-			numberPointersFirst = ((B + 1)/2) + 1; //B=3, ((3+1)/2)+1= 3 pointers in first leaf
-			numberPointersSecond = (B + 1)/2; //B=3 (3+1)/2=2 pointers in second leaf			
-		}
-		for(j=0;j<B;j++){
-			if(stop == 0){
-				if(inserted == 0){
-					if(*insertValue < temp->values[increase]){
-						temp_help->values[j] = *insertValue;
-						temp_help->pointers[j].indexTd = *insertTd;
-						temp_help->pointers[j].addBlock = *insertBlock;
-						inserted = 1;
-					}else{
-						temp_help->values[j] = temp->values[increase];
-						temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-						temp_help->pointers[j].addBlock = temp->pointers[increase].addBlock;
-						increase++;
-					}
-				}else{
-					temp_help->values[j] = temp->values[increase];
-					temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-					temp_help->pointers[j].addBlock = temp->pointers[increase].addBlock;
-					increase++;	
-				}
-				if((j+1)==numberElementsFirst)
-					stop = 1;
-			}else{
-				temp_help->values[j] = -1;
-				temp_help->pointers[j].indexTd = 0;
-				temp_help->pointers[j].addBlock = 0;
-			}
-		}
-		temp_help->pointers[B].indexTd = block->last_tuple_dict_id + 1; //points to new leaf
-		temp_help->pointers[B].addBlock = adr_to_read; //update when fix multiple blocks
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node)); 
-		stop = 0;
-		for(j=0;j<B;j++){
-			if(stop == 0){
-				if(inserted == 0){
-					if(*insertValue < temp->values[increase]){
-						temp_help_two->values[j] = *insertValue;
-						temp_help_two->pointers[j].indexTd = *insertTd;
-						temp_help_two->pointers[j].addBlock = *insertBlock;
-						inserted = 1;
-					}else{
-						temp_help_two->values[j] = temp->values[increase];
-						temp_help_two->pointers[j].indexTd = temp->pointers[increase].indexTd;
-						temp_help_two->pointers[j].addBlock = temp->pointers[increase].addBlock;
-						increase++;
-					}
-				}else{
-					temp_help_two->values[j] = temp->values[increase];
-					temp_help_two->pointers[j].indexTd = temp->pointers[increase].indexTd;
-					temp_help_two->pointers[j].addBlock = temp->pointers[increase].addBlock;
-					increase++;	
-				}
-				if((j+1)==numberElementsSecond)
-					stop = 1;
-			}else{
-				temp_help_two->values[j] = -1;
-				temp_help_two->pointers[j].indexTd = 0;
-				temp_help_two->pointers[j].addBlock = 0;
-			}		
-		}
-		temp_help_two->pointers[B].indexTd = temp->pointers[B].indexTd; //points to next leaf
-		temp_help_two->pointers[B].addBlock = temp->pointers[B].addBlock;
-		memcpy(&block->data[block->AK_free_space], temp_help_two, sizeof(btree_node)); 
-		int id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		//update root_info->level[0] number of leafs
-		root->level[0]++;
-		memcpy(&block->data[0],root,sizeof(root_info));
-		AK_write_block(block);
-		//checking nodes above 
-		int pathIndex = inc - 1;
-		int nodeAddress = block->tuple_dict[insertPath[pathIndex]].address;
-		int pointerIndex = insertIndexPath[pathIndex];
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[nodeAddress],sizeof(btree_node));
-
-		int firstValue = temp_help->values[0];
-		int secondValue = temp_help_two->values[0];//secondValue > firstValue
-		int firstPointer = insertPath[inc]; //pointer to original leaf
-		int secondPointer = id; //pointer to new leaf
-		memset(temp_help,0,sizeof(btree_node));
-
-		int AK_freePointer = 0;
-		for(j=0;j<B;j++){
-			if(temp->values[j] == -1)
-				AK_freePointer = 1;
-		}
-		int startSecond = 0, copyNode = 1,skip = 1;
-		increase = 0;
-		if(AK_freePointer == 1){//in node above we have FREE POINTER to insert NEW LEAF
-			temp_help->pointers[0].indexTd = temp->pointers[0].indexTd;
-			if(pointerIndex == 0){
-				startSecond = 1;
-				copyNode = 0;
-				skip = 0;
-			}
-			for(j=1;j<=B;j++){
-				if((copyNode == 1) && (j != pointerIndex)){
-					temp_help->values[j-1] = temp->values[increase];
-					temp_help->pointers[j].indexTd = temp->pointers[increase+1].indexTd;
-					increase++;
-				}
-				if(startSecond == 1){
-					temp_help->values[j-1] = secondValue;
-					temp_help->pointers[j].indexTd = secondPointer;
-					if(skip == 1){
-						increase++;
-					}
-					startSecond = 0;
-					copyNode = 1;
-				}
-				if(j == pointerIndex){
-					temp_help->values[j-1] = firstValue;
-					temp_help->pointers[j].indexTd = firstPointer;
-					startSecond = 1;
-					copyNode = 0;
-				}
-			}
-			memset(&block->data[nodeAddress],0,sizeof(btree_node));
-			memcpy(&block->data[nodeAddress],temp_help,sizeof(btree_node)); 
-			AK_write_block(block);
-			printf("\nNew value is added in new leaf. Node above had available space.");
-		}else{//spliting nodes
-			int nodeIncrease,nodeInserted,helpAddress,helpType,nodeAboveAddress;
-			int again = 1,newRoot=0,updateIdx = 1;
-			btree_node *temp_node_one = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *temp_node_two = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *value_help = (btree_node*) AK_malloc(sizeof(btree_node));
-			
-			while(again == 1){
-				memset(temp_node_one,0,sizeof(btree_node));
-				memset(temp_node_two,0,sizeof(btree_node));
-				memset(value_help,0,sizeof(btree_node));
-
-				nodeIncrease = 0;
-				nodeInserted = 0;
-				helpType=NODE;
-				//pointers for first node
-				for(j=0;j<numberPointersFirst;j++){
-					if((j==(pointerIndex+1)) && (nodeInserted == 0)){
-						temp_node_one->pointers[j].indexTd = secondPointer;
-						temp_node_one->pointers[j].addBlock = 0;//update when fixing blocks
-						nodeInserted = 1;
-					}
-					else{
-						temp_node_one->pointers[j].indexTd = temp->pointers[nodeIncrease].indexTd;
-						temp_node_one->pointers[j].addBlock = temp->pointers[nodeIncrease].addBlock;
-						nodeIncrease++;
-					}
-				}
-				//values for first node
-				for(j=0;j<B;j++){
-					if(temp_node_one->pointers[j+1].indexTd != 0){
-						helpAddress = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].address;
-						helpType = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].type;
-						memset(value_help,0,sizeof(btree_node));
-						memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-						while(helpType == NODE){
-							helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-							helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-							memset(value_help,0,sizeof(btree_node));
-							memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-						}
-						temp_node_one->values[j] = value_help->values[0];
-					}
-				}
-				//pointers for second node
-				for(j=0;j<numberPointersSecond;j++){
-					if((nodeIncrease == (pointerIndex+1)) && (nodeInserted == 0))  {
-						temp_node_two->pointers[j].indexTd = secondPointer;
-						temp_node_two->pointers[j].addBlock = 0;//update when fixing blocks
-					}else{
-						temp_node_two->pointers[j].indexTd = temp->pointers[nodeIncrease].indexTd;
-						temp_node_two->pointers[j].addBlock = temp->pointers[nodeIncrease].addBlock;
-						nodeIncrease++;
-					}
-				}
-				//values for second node
-				for(j=0;j<B;j++){
-					if(temp_node_two->pointers[j+1].indexTd != 0){
-						helpAddress = block->tuple_dict[temp_node_two->pointers[j+1].indexTd].address;
-						helpType = block->tuple_dict[temp_node_two->pointers[j+1].indexTd].type;
-						memset(value_help,0,sizeof(btree_node));
-						memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-						while(helpType == NODE){
-							helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-							helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-							memset(value_help,0,sizeof(btree_node));
-							memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-						}
-						temp_node_two->values[j] = value_help->values[0];
-					}
-				}
-				memset(&block->data[block->tuple_dict[insertPath[pathIndex]].address],0,sizeof(btree_node));
-				memcpy(&block->data[block->tuple_dict[insertPath[pathIndex]].address],temp_node_one,sizeof(btree_node)); 
-				memcpy(&block->data[block->AK_free_space],temp_node_two,sizeof(btree_node)); 
-				id = block->last_tuple_dict_id + 1;
-				block->tuple_dict[id].address = block->AK_free_space;
-				block->tuple_dict[id].type = NODE;
-				block->AK_free_space += sizeof(btree_node);
-				block->last_tuple_dict_id = id;
-
-				root->level[updateIdx]++;
-				memcpy(&block->data[0],root,sizeof(root_info));
-				updateIdx++;
-				AK_write_block(block);
-
-				firstPointer = insertPath[pathIndex]; 
-				secondPointer = id;
-
-				if(newRoot == 1){
-					again = 0;
-					memset(temp,0,sizeof(btree_node));
-					temp->pointers[0].indexTd = firstPointer;
-					temp->pointers[1].indexTd = secondPointer;
-					
-					helpAddress = block->tuple_dict[secondPointer].address;
-					helpType = block->tuple_dict[secondPointer].type;
-					memset(value_help,0,sizeof(btree_node));
-					memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-					while(helpType == NODE){
-						helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-						helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-						memset(value_help,0,sizeof(btree_node));
-						memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-					}
-					temp->values[0] = value_help->values[0];
-					printf("\nNew value is added and tree is updated! New root added, so order of the tree increased!");
-					memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-					id = block->last_tuple_dict_id + 1;
-					block->tuple_dict[id].address = block->AK_free_space;
-					block->tuple_dict[id].type = NODE;
-					block->AK_free_space += sizeof(btree_node);
-					block->last_tuple_dict_id = id;
-
-					root->level[updateIdx] = 1;
-					root->root = id;
-					memcpy(&block->data[0],root,sizeof(root_info));
-					AK_write_block(block);					
-				}else{
-					//get above node !
-					pathIndex = pathIndex - 1; //0, insertPath[0] = 13 (root)
-					nodeAboveAddress = block->tuple_dict[insertPath[pathIndex]].address;
-
-					memset(temp,0,sizeof(btree_node));
-					memcpy(temp,&block->data[nodeAboveAddress],sizeof(btree_node));
-					for(j=0;j<B;j++){
-						if(temp->values[j] == -1)
-							AK_freePointer = 1;
-					}
-					if(AK_freePointer == 1){
-						again = 0;
-						increase = 0;
-						memset(temp_help,0,sizeof(btree_node));
-						for(j=0;j<=B;j++){
-							if(j == (insertIndexPath[pathIndex]+1)){
-								temp_help->pointers[j].indexTd = secondPointer;
-							}else{
-								temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-								increase++;
-							}	
-						}
-						for(j=0;j<B;j++){
-							if(temp_help->pointers[j+1].indexTd != 0){
-								helpAddress = block->tuple_dict[temp_help->pointers[j+1].indexTd].address;
-								helpType = block->tuple_dict[temp_help->pointers[j+1].indexTd].type;
-								memset(value_help,0,sizeof(btree_node));
-								memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-								while(helpType == NODE){
-									helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-									helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-									memset(value_help,0,sizeof(btree_node));
-									memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-								}
-								temp_help->values[j] = value_help->values[0];
-							}
-						}
-						memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-						id = block->last_tuple_dict_id + 1;
-						block->tuple_dict[id].address = block->AK_free_space;
-						block->tuple_dict[id].type = NODE;
-						block->AK_free_space += sizeof(btree_node);
-						block->last_tuple_dict_id = id;
-						AK_write_block(block);	
-					}else{//if root is full->new root...
-						if(root->root == insertPath[pathIndex])
-							newRoot = 1;
-						else
-							again = 1;
-					}
-				}
-			}
-			if(newRoot != 1)
-				printf("\nNew value is added and tree is updated!");
-		}
-	}
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-//TODO: Add description of the function AK_btree_test as well as params 
-TestResult AK_btree_test() {
-	char *tblName = "student";
-	char *indexName = "student_btree_index";
-	AK_PRO;
-	struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
-	AK_Init_L3(&att_list);
-	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
-
-	AK_btree_create(tblName, att_list, indexName);
-	printf("\n\n---------------------------");
-	printf("\nInserting new value...\n");
-	int iv=39123;
-	int ii=101;
-	int ib=301;
-	int *insertValue = &iv; //insert in leaf with available space
-	//int *insertValue = 35901; //insert in full leaf -> new leaf, full node above - split
-	int *insertTd = &ii;
-	int *insertBlock = &ib;
-	AK_btree_insert(indexName,insertValue,insertTd,insertBlock);
-	//use insert function for 39123 and again for 39000 to test spliting leaf with AK_free space above
-	//insertValue = 39000; //insert in full leaf -> new leaf, AK_free space in node above
-	//AK_btree_insert(indexName,insertValue,insertTd,insertBlock);
-	printf("\n\n---------------------------");
-	printf("\nSearching value...\n");
-	int sv=35906;
-	int er=35916;
-	int td=0;
-	int *searchValue = &sv;
-	int *endRange = &er;
-	//int *endRange = 0;
-	int *toDo = &td;//0 search, 1 delete
-	AK_btree_search_delete(indexName, searchValue, endRange, toDo);
-	AK_EPI;
-	return TEST_result(0,0);
+ * @brief Function that returns the maximum length of a key of an index
+ * @param type type of the indexed attribute
+ * @return maximum length of the encoded value and the row address
+ */
+static int AK_btree_max_key(int type) {
+    switch (type) {
+        case TYPE_VARCHAR:
+            return AK_BTREE_MAX_KEY;
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            return sizeof (double) + AK_BTREE_ROW_SIZE;
+    }
+    return sizeof (int) + AK_BTREE_ROW_SIZE;
+}
+
+/**
+ * @brief Function that builds a key out of an encoded value and a row address
+ * @param value encoded value
+ * @param length length of the value
+ * @param row row address
+ * @param key buffer of AK_BTREE_MAX_KEY bytes
+ * @return length of the key
+ */
+static int AK_btree_make_key(const unsigned char *value, int length, struct_add *row, unsigned char *key) {
+    memcpy(key, value, length);
+    AK_btree_put_int(row->addBlock, key + length);
+    AK_btree_put_int(row->indexTd, key + length + 4);
+    return length + AK_BTREE_ROW_SIZE;
+}
+
+/**
+ * @brief Function that returns the offsets of the entries of a node
+ * @param node node
+ * @return offsets of the entries from the start of the node
+ */
+static unsigned short *AK_btree_offsets(AK_btree_node *node) {
+    return (unsigned short *) ((unsigned char *) node + sizeof (AK_btree_node) + node->prefix);
+}
+
+/**
+ * @brief Function that returns the suffix of an entry of a node
+ * @param node node
+ * @param i index of the entry
+ * @param length set to the length of the suffix
+ * @return bytes of the key after the prefix
+ */
+static unsigned char *AK_btree_suffix(AK_btree_node *node, int i, int *length) {
+    unsigned short offset;
+    unsigned char *entry;
+
+    //the offsets follow the prefix, so they are not aligned
+    memcpy(&offset, AK_btree_offsets(node) + i, sizeof (unsigned short));
+    entry = (unsigned char *) node + offset;
+    *length = entry[0];
+    return entry + 1;
+}
+
+/**
+ * @brief Function that returns the child of an entry of an inner node
+ * @param node inner node
+ * @param i index of the entry
+ * @return child address
+ */
+static int AK_btree_entry_child(AK_btree_node *node, int i) {
+    int length, child;
+    unsigned char *suffix = AK_btree_suffix(node, i, &length);
+    memcpy(&child, suffix + length, sizeof (int));
+    return child;
+}
+
+/**
+ * @brief Function that copies the full key of an entry of a node
+ * @param node node
+ * @param i index of the entry
+ * @param key buffer of AK_BTREE_MAX_KEY bytes
+ * @return length of the key
+ */
+static int AK_btree_entry_key(AK_btree_node *node, int i, unsigned char *key) {
+    int length;
+    unsigned char *suffix = AK_btree_suffix(node, i, &length);
+    memcpy(key, (unsigned char *) node + sizeof (AK_btree_node), node->prefix);
+    memcpy(key + node->prefix, suffix, length);
+    return node->prefix + length;
+}
+
+/**
+ * @brief Function that compares an entry of a node with a key
+ * @param node node
+ * @param i index of the entry
+ * @param key key
+ * @param length length of the key
+ * @return negative value, zero or positive value if the entry is lower than, equal to or greater than the key
+ */
+static int AK_btree_node_compare(AK_btree_node *node, int i, const unsigned char *key, int length) {
+    int suffix_length, result, prefix = node->prefix;
+    unsigned char *suffix;
+
+    result = memcmp((unsigned char *) node + sizeof (AK_btree_node), key, (prefix < length) ? prefix : length);
+    if (result != 0)
+        return result;
+    //every entry is at least as long as the prefix
+    if (length < prefix)
+        return 1;
+    suffix = AK_btree_suffix(node, i, &suffix_length);
+    return AK_btree_compare(suffix, suffix_length, key + prefix, length - prefix);
+}
+
+/**
+ * @brief Function that finds the first entry of a node greater than or equal to a key
+ * @param node node
+ * @param key key
+ * @param length length of the key
+ * @param upper 1 to find the first entry greater than the key instead
+ * @return index of the entry, the number of entries if there is none
+ */
+static int AK_btree_node_search(AK_btree_node *node, const unsigned char *key, int length, int upper) {
+    int low = 0, high = node->count, middle, result;
+    while (low < high) {
+        middle = (low + high) / 2;
+        result = AK_btree_node_compare(node, middle, key, length);
+        if (result < 0 || (upper && result == 0))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Function that returns the child of an inner node a key belongs to
+ * @param node inner node
+ * @param key key
+ * @param length length of the key
+ * @return child address
+ */
+static int AK_btree_node_child(AK_btree_node *node, const unsigned char *key, int length) {
+    int i = AK_btree_node_search(node, key, length, 1);
+    return (i == 0) ? node->child : AK_btree_entry_child(node, i - 1);
+}
+
+/**
+ * @brief Function that returns the length of the prefix two entries share
+ * @param a first entry
+ * @param b second entry
+ * @return length of the common prefix
+ */
+static int AK_btree_lcp(const AK_btree_entry *a, const AK_btree_entry *b) {
+    int i, length = (a->length < b->length) ? a->length : b->length;
+    for (i = 0; i < length && a->key[i] == b->key[i]; i++)
+        ;
+    return i;
+}
+
+/**
+ * @brief Function that returns the number of bytes a node holding a run of entries takes. The entries share the
+ * prefix of the first and the last one, because they are sorted.
+ * @param entries entries
+ * @param sums sums[i] is the total length of the keys of entries[0] to entries[i - 1]
+ * @param from index of the first entry
+ * @param to index after the last entry
+ * @param inner 1 for inner nodes
+ * @return bytes of the node
+ */
+static int AK_btree_node_bytes(AK_btree_entry *entries, int *sums, int from, int to, int inner) {
+    int count = to - from, prefix;
+    if (count == 0)
+        return sizeof (AK_btree_node);
+    prefix = (count == 1) ? entries[from].length : AK_btree_lcp(entries + from, entries + to - 1);
+    return sizeof (AK_btree_node) + prefix + count * (sizeof (unsigned short) + 1 + (inner ? sizeof (int) : 0))
+        + sums[to] - sums[from] - count * prefix;
+}
+
+/**
+ * @brief Function that writes entries into the node of a block
+ * @param block block
+ * @param level level of the node, 0 for leaves
+ * @param next right sibling
+ * @param child child holding the keys lower than the first entry, 0 for leaves
+ * @param entries entries in key order
+ * @param count number of entries
+ */
+static void AK_btree_write_node(AK_block *block, int level, int next, int child, AK_btree_entry *entries, int count) {
+    AK_btree_node *node = (AK_btree_node *) block->data;
+    unsigned char *bytes = block->data;
+    unsigned short *offsets, offset;
+    int i, prefix, size;
+
+    prefix = (count == 0) ? 0 : (count == 1) ? entries[0].length : AK_btree_lcp(entries, entries + count - 1);
+    node->level = level;
+    node->count = count;
+    node->prefix = prefix;
+    node->next = next;
+    node->child = child;
+    if (count > 0)
+        memcpy(bytes + sizeof (AK_btree_node), entries[0].key, prefix);
+    offsets = AK_btree_offsets(node);
+    size = sizeof (AK_btree_node) + prefix + count * sizeof (unsigned short);
+    for (i = 0; i < count; i++) {
+        offset = size;
+        memcpy(offsets + i, &offset, sizeof (unsigned short));
+        bytes[size] = entries[i].length - prefix;
+        memcpy(bytes + size + 1, entries[i].key + prefix, entries[i].length - prefix);
+        size += 1 + entries[i].length - prefix;
+        if (level > 0) {
+            memcpy(bytes + size, &entries[i].child, sizeof (int));
+            size += sizeof (int);
+        }
+    }
+    node->size = size;
+    memset(bytes + size, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - size);
+
+    //the node is one entry of the block, so the block does not look empty to the rest of the system
+    memset(block->tuple_dict, 0, sizeof (block->tuple_dict));
+    block->tuple_dict[0].type = TYPE_INTERNAL;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = size;
+    block->AK_free_space = size;
+    block->last_tuple_dict_id = 0;
+}
+
+/**
+ * @brief Function that decodes the entries of a node into the scratch entries of the writers
+ * @param node node
+ * @return number of entries
+ */
+static int AK_btree_read_entries(AK_btree_node *node) {
+    int i;
+    for (i = 0; i < node->count; i++) {
+        AK_btree_entries[i].key = AK_btree_entry_keys + i * AK_BTREE_MAX_KEY;
+        AK_btree_entries[i].length = AK_btree_entry_key(node, i, AK_btree_entries[i].key);
+        AK_btree_entries[i].child = (node->level > 0) ? AK_btree_entry_child(node, i) : 0;
+    }
+    return node->count;
+}
+
+/**
+ * @brief Function that finds the index a node is split at. The index is the one that keeps the larger half as
+ * small as possible, so both halves fit even if the new key shortened the prefix of the node.
+ * @param entries entries of the node
+ * @param count number of entries
+ * @param inner 1 for inner nodes, whose entry at the split index moves up to the parent
+ * @return index of the first entry of the right node
+ */
+static int AK_btree_split_point(AK_btree_entry *entries, int count, int inner) {
+    static int sums[AK_BTREE_MAX_ENTRIES + 2];
+    int i, left, right, larger, best = 1, best_size = -1;
+
+    sums[0] = 0;
+    for (i = 0; i < count; i++)
+        sums[i + 1] = sums[i] + entries[i].length;
+    for (i = 1; i < count - (inner ? 1 : 0); i++) {
+        left = AK_btree_node_bytes(entries, sums, 0, i, inner);
+        right = AK_btree_node_bytes(entries, sums, i + (inner ? 1 : 0), count, inner);
+        larger = (left > right) ? left : right;
+        if (best_size < 0 || larger < best_size) {
+            best_size = larger;
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Function that pins and latches the meta block of an index
+ * @param indexName name of the index
+ * @param mode latch mode
+ * @return meta block, NULL if the index does not exist
+ */
+static AK_mem_block *AK_btree_pin_meta(char *indexName, int mode) {
+    table_addresses *addresses = AK_get_index_addresses(indexName);
+    AK_mem_block *mem_block;
+    int address = addresses->address_from[0];
+
+    AK_free(addresses);
+    if (address == 0)
+        return NULL;
+    mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, mode);
+    if (((AK_btree_meta *) mem_block->block->data)->magic != AK_BTREE_MAGIC) {
+        AK_unlatch_block(mem_block);
+        AK_unpin_block(mem_block);
+        return NULL;
+    }
+    return mem_block;
+}
+
+/**
+ * @brief Function that releases a block pinned and latched by the B+tree functions
+ * @param mem_block block
+ */
+static void AK_btree_release(AK_mem_block *mem_block) {
+    AK_unlatch_block(mem_block);
+    AK_unpin_block(mem_block);
+}
+
+/**
+ * @brief Function that takes a free block of an index segment for a new node. A new extent is added when the
+ * segment is full. Called while AK_btree_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @return block address, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_btree_allocate(char *indexName, AK_mem_block *meta_block) {
+    AK_btree_meta *meta = (AK_btree_meta *) meta_block->block->data;
+    table_addresses *addresses;
+    int address, start, i;
+
+    if (meta->next_block >= meta->extent_end) {
+        if ((start = AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        addresses = AK_get_index_addresses(indexName);
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+            if (addresses->address_from[i] == start)
+                break;
+        if (i == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[i] == 0) {
+            AK_free(addresses);
+            return EXIT_ERROR;
+        }
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->next_block = start;
+        meta->extent_end = addresses->address_to[i];
+        AK_unlatch_block(meta_block);
+        AK_free(addresses);
+    }
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    address = meta->next_block++;
+    meta->num_nodes++;
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    return address;
+}
+
+/**
+ * @brief Function that writes a node into a block nobody else can reach yet
+ * @param address block address
+ * @param level level of the node
+ * @param next right sibling
+ * @param child first child of an inner node
+ * @param entries entries
+ * @param count number of entries
+ */
+static void AK_btree_write_new_node(int address, int level, int next, int child, AK_btree_entry *entries, int count) {
+    AK_mem_block *mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    AK_btree_write_node(mem_block->block, level, next, child, entries, count);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_btree_release(mem_block);
+}
+
+/**
+ * @brief Function that reads the list of B+tree indexes from AK_index. Called while AK_btree_indexes_lock is held.
+ */
+static void AK_btree_load_indexes() {
+    unsigned long version = AK_catalog_version();
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_index");
+    struct list_node *row, *name, *start, *table_id;
+    AK_mem_block *mem_block;
+    AK_btree_meta *meta;
+    AK_btree_index *index;
+    int address;
+
+    AK_btree_num_indexes = 0;
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL && AK_btree_num_indexes < AK_BTREE_MAX_INDEXES) {
+        name = AK_First_L2(row)->next;
+        start = name->next;
+        table_id = start->next->next;
+        //rows of later extents do not name the table
+        if (table_id->type != TYPE_INT || start->type != TYPE_INT)
+            continue;
+        memcpy(&address, start->data, sizeof (int));
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        meta = (AK_btree_meta *) mem_block->block->data;
+        if (meta->magic == AK_BTREE_MAGIC) {
+            index = AK_btree_indexes + AK_btree_num_indexes++;
+            strncpy(index->name, name->data, MAX_VARCHAR_LENGTH - 1);
+            index->name[MAX_VARCHAR_LENGTH - 1] = '\0';
+            index->table_id = meta->table_id;
+            index->attribute = meta->attribute;
+            index->type = meta->type;
+            index->meta = address;
+        }
+        AK_btree_release(mem_block);
+    }
+    AK_table_cursor_close(cursor);
+    AK_btree_indexes_version = version;
+}
+
+/**
+ * @brief Function that copies the B+tree indexes of a table
+ * @param tblName table name
+ * @param indexes buffer of AK_BTREE_MAX_INDEXES indexes
+ * @return number of indexes
+ */
+static int AK_btree_table_indexes(char *tblName, AK_btree_index *indexes) {
+    int i, count = 0, table_id;
+
+    pthread_mutex_lock(&AK_btree_indexes_lock);
+    if (AK_btree_num_indexes < 0 || AK_btree_indexes_version != AK_catalog_version())
+        AK_btree_load_indexes();
+    if (AK_btree_num_indexes > 0) {
+        table_id = AK_get_table_obj_id(tblName);
+        for (i = 0; i < AK_btree_num_indexes; i++)
+            if (AK_btree_indexes[i].table_id == table_id)
+                indexes[count++] = AK_btree_indexes[i];
+    }
+    pthread_mutex_unlock(&AK_btree_indexes_lock);
+    return count;
+}
+
+int AK_btree_find_index(char *tblName, int attribute, char *indexName) {
+    AK_btree_index indexes[AK_BTREE_MAX_INDEXES];
+    int count, i;
+    AK_PRO;
+
+    count = AK_btree_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++)
+        if (indexes[i].attribute == attribute) {
+            strcpy(indexName, indexes[i].name);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+    AK_EPI;
+    return EXIT_WARNING;
+}
+
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta) {
+    AK_mem_block *mem_block;
+    AK_PRO;
+
+    if ((mem_block = AK_btree_pin_meta(indexName, AK_LATCH_SHARED)) == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memcpy(meta, mem_block->block->data, sizeof (AK_btree_meta));
+    AK_btree_release(mem_block);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that compares two entries, used to sort the keys of a bulk build
+ */
+static int AK_btree_entry_compare(const void *a, const void *b) {
+    const AK_btree_entry *x = a, *y = b;
+    return AK_btree_compare(x->key, x->length, y->key, y->length);
+}
+
+/**
+ * @brief Function that builds a B+tree bottom up out of sorted keys. Every level is packed from left to right to
+ * AK_BTREE_FILL percent of a node; the first level that fits one node is written into the root block.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block
+ * @param items sorted keys
+ * @param count number of keys
+ * @return height of the tree, EXIT_ERROR if a node could not be allocated
+ */
+static int AK_btree_build(char *indexName, AK_mem_block *meta_block, AK_btree_entry *items, int count) {
+    AK_btree_meta *meta = (AK_btree_meta *) meta_block->block->data;
+    AK_btree_entry *parents;
+    unsigned char *separators, *item_keys = NULL;
+    int *sums = AK_malloc((count + 1) * sizeof (int));
+    int level = 0, inner, from, to, nodes, address, pending = 0, pending_from = 0, pending_to = 0, limit, i, length;
+
+    limit = AK_btree_node_size * AK_BTREE_FILL / 100;
+    while (1) {
+        inner = (level > 0);
+        sums = AK_realloc(sums, (count + 1) * sizeof (int));
+        sums[0] = 0;
+        for (i = 0; i < count; i++)
+            sums[i + 1] = sums[i] + items[i].length;
+
+        //the first key of an inner node is not stored, it becomes the child of the node
+        if (AK_btree_node_bytes(items, sums, inner, count, inner) <= AK_btree_node_size) {
+            AK_btree_write_new_node(meta->root, level, 0, inner ? items[0].child : 0, items + inner, count - inner);
+            break;
+        }
+
+        parents = AK_malloc(count * sizeof (AK_btree_entry));
+        separators = AK_malloc(count * AK_BTREE_MAX_KEY);
+        nodes = 0;
+        for (from = 0; from < count; from = to) {
+            to = from + 1 + inner;
+            if (to > count)
+                to = count;
+            while (to < count && AK_btree_node_bytes(items, sums, from + inner, to + 1, inner) <= limit)
+                to++;
+            if ((address = AK_btree_allocate(indexName, meta_block)) == EXIT_ERROR) {
+                if (level > 0) {
+                    AK_free(items);
+                    AK_free(item_keys);
+                }
+                AK_free(parents);
+                AK_free(separators);
+                AK_free(sums);
+                return EXIT_ERROR;
+            }
+            //a node is written once the address of its right sibling is known
+            if (nodes > 0)
+                AK_btree_write_new_node(pending, level, address, inner ? items[pending_from].child : 0,
+                    items + pending_from + inner, pending_to - pending_from - inner);
+
+            //a leaf separator is cut after the first byte that tells it from the last key of the left node
+            parents[nodes].key = separators + nodes * AK_BTREE_MAX_KEY;
+            if (!inner && from > 0) {
+                length = AK_btree_lcp(items + from - 1, items + from) + 1;
+                memcpy(parents[nodes].key, items[from].key, length);
+                parents[nodes].length = length;
+            } else {
+                memcpy(parents[nodes].key, items[from].key, items[from].length);
+                parents[nodes].length = items[from].length;
+            }
+            parents[nodes].child = address;
+            nodes++;
+            pending = address;
+            pending_from = from;
+            pending_to = to;
+        }
+        AK_btree_write_new_node(pending, level, 0, inner ? items[pending_from].child : 0,
+            items + pending_from + inner, pending_to - pending_from - inner);
+
+        if (level > 0) {
+            AK_free(items);
+            AK_free(item_keys);
+        }
+        items = parents;
+        item_keys = separators;
+        count = nodes;
+        level++;
+    }
+    if (level > 0) {
+        AK_free(items);
+        AK_free(item_keys);
+    }
+    AK_free(sums);
+    return level + 1;
+}
+
+/**
+ * @brief Function that sets the tuple dictionary of a block holding B+tree data, so the block does not look empty
+ * to the functions that read blocks of a segment
+ * @param block block
+ * @param size bytes used
+ */
+static void AK_btree_set_block_size(AK_block *block, int size) {
+    memset(block->tuple_dict, 0, sizeof (block->tuple_dict));
+    block->tuple_dict[0].type = TYPE_INTERNAL;
+    block->tuple_dict[0].address = 0;
+    block->tuple_dict[0].size = size;
+    block->AK_free_space = size;
+    block->last_tuple_dict_id = 0;
+}
+
+/**
+ * @brief Function that copies the separator of a split leaf: the first key of the right node, cut after the first
+ * byte that tells it from the last key of the left node
+ * @param left last key of the left node
+ * @param right first key of the right node
+ * @param separator buffer of AK_BTREE_MAX_KEY bytes
+ * @return length of the separator
+ */
+static int AK_btree_separator(AK_btree_entry *left, AK_btree_entry *right, unsigned char *separator) {
+    int length = AK_btree_lcp(left, right) + 1;
+    memmove(separator, right->key, length);
+    return length;
+}
+
+/**
+ * @brief Function that pins and latches the leaf a key belongs to. Every node is latched before its parent is
+ * released, so the path cannot change under the lookup.
+ * @param root address of the root
+ * @param key key
+ * @param length length of the key
+ * @return leaf, latched shared
+ */
+static AK_mem_block *AK_btree_find_leaf(int root, const unsigned char *key, int length) {
+    AK_mem_block *mem_block = AK_pin_block(root), *child;
+    AK_btree_node *node;
+
+    AK_latch_block(mem_block, AK_LATCH_SHARED);
+    node = (AK_btree_node *) mem_block->block->data;
+    while (node->level > 0) {
+        child = AK_pin_block(AK_btree_node_child(node, key, length));
+        AK_latch_block(child, AK_LATCH_SHARED);
+        AK_btree_release(mem_block);
+        mem_block = child;
+        node = (AK_btree_node *) mem_block->block->data;
+    }
+    return mem_block;
+}
+
+/**
+ * @brief Function that returns the root of a built index
+ * @param indexName name of the index
+ * @return root address, EXIT_ERROR if the index does not exist or is being built
+ */
+static int AK_btree_root(char *indexName) {
+    AK_mem_block *meta_block = AK_btree_pin_meta(indexName, AK_LATCH_SHARED);
+    AK_btree_meta *meta;
+    int root = EXIT_ERROR;
+
+    if (meta_block == NULL)
+        return EXIT_ERROR;
+    meta = (AK_btree_meta *) meta_block->block->data;
+    if (meta->height > 0)
+        root = meta->root;
+    AK_btree_release(meta_block);
+    return root;
+}
+
+int AK_btree_search_range(char *indexName, AK_btree_range *range, struct_add **rows) {
+    unsigned char start[AK_BTREE_MAX_KEY + 1], key[AK_BTREE_MAX_KEY];
+    AK_mem_block *mem_block, *sibling;
+    AK_btree_node *node;
+    int root, start_length = 0, length, count = 0, capacity = 64, result, i, done = 0;
+    AK_PRO;
+
+    *rows = NULL;
+    if ((root = AK_btree_root(indexName)) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (range->lower_length >= 0) {
+        memcpy(start, range->lower, range->lower_length);
+        start_length = range->lower_length;
+        //past every row address of the value itself
+        if (!range->lower_inclusive) {
+            memset(start + start_length, 0xFF, AK_BTREE_ROW_SIZE + 1);
+            start_length += AK_BTREE_ROW_SIZE + 1;
+        }
+    }
+
+    *rows = (struct_add *) AK_malloc(capacity * sizeof (struct_add));
+    mem_block = AK_btree_find_leaf(root, start, start_length);
+    node = (AK_btree_node *) mem_block->block->data;
+    i = AK_btree_node_search(node, start, start_length, 0);
+    while (1) {
+        for (; i < node->count; i++) {
+            length = AK_btree_entry_key(node, i, key);
+            if (range->upper_length >= 0) {
+                result = AK_btree_compare(key, length - AK_BTREE_ROW_SIZE, range->upper, range->upper_length);
+                if (result > 0 || (result == 0 && !range->upper_inclusive)) {
+                    done = 1;
+                    break;
+                }
+            }
+            if (count == capacity) {
+                capacity *= 2;
+                *rows = (struct_add *) AK_realloc(*rows, capacity * sizeof (struct_add));
+            }
+            (*rows)[count].addBlock = AK_btree_get_int(key + length - AK_BTREE_ROW_SIZE);
+            (*rows)[count].indexTd = AK_btree_get_int(key + length - AK_BTREE_ROW_SIZE + 4);
+            count++;
+        }
+        if (done || node->next == 0)
+            break;
+        sibling = AK_pin_block(node->next);
+        AK_latch_block(sibling, AK_LATCH_SHARED);
+        AK_btree_release(mem_block);
+        mem_block = sibling;
+        node = (AK_btree_node *) mem_block->block->data;
+        i = 0;
+    }
+    AK_btree_release(mem_block);
+    AK_EPI;
+    return count;
+}
+
+int AK_btree_search(char *indexName, unsigned char *value, int length, struct_add **rows) {
+    AK_btree_range range;
+    int count;
+    AK_PRO;
+
+    if (length < 0 || length > AK_BTREE_MAX_VALUE) {
+        *rows = NULL;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_btree_range_init(&range);
+    AK_btree_range_lower(&range, value, length, 1);
+    AK_btree_range_upper(&range, value, length, 1);
+    count = AK_btree_search_range(indexName, &range, rows);
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @brief Function that inserts a key into an index. Nodes are latched exclusively from the root down, the latches
+ * above a node that cannot split are released. A full node is split in two and its separator is inserted into the
+ * parent, a full root moves its entries into two new nodes so the root stays in its block. Called while
+ * AK_btree_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @param key key
+ * @param length length of the key
+ * @return EXIT_SUCCESS, EXIT_WARNING if the key is already in the index, EXIT_ERROR if a node could not be allocated
+ */
+static int AK_btree_insert_key(char *indexName, AK_mem_block *meta_block, unsigned char *key, int length) {
+    static unsigned char separator[AK_BTREE_MAX_KEY];
+    static int sums[AK_BTREE_MAX_ENTRIES + 2];
+    AK_btree_meta *meta = (AK_btree_meta *) meta_block->block->data;
+    AK_btree_entry *entries = AK_btree_entries, entry;
+    AK_mem_block *path[AK_BTREE_MAX_HEIGHT], *mem_block;
+    AK_btree_node *node;
+    int depth = 0, max_entry, count, position, split, level, next, child, left, right, result = EXIT_SUCCESS, i;
+
+    max_entry = sizeof (unsigned short) + 1 + AK_btree_max_key(meta->type) + sizeof (int);
+    path[depth++] = AK_pin_block(meta->root);
+    AK_latch_block(path[0], AK_LATCH_EXCLUSIVE);
+    node = (AK_btree_node *) path[0]->block->data;
+    while (node->level > 0) {
+        mem_block = AK_pin_block(AK_btree_node_child(node, key, length));
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        node = (AK_btree_node *) mem_block->block->data;
+        //a shorter prefix adds its length to every entry, so a node is safe only if it takes that and one more entry
+        if (node->size + node->count * node->prefix + max_entry <= AK_btree_node_size)
+            while (depth > 0)
+                AK_btree_release(path[--depth]);
+        path[depth++] = mem_block;
+    }
+
+    position = AK_btree_node_search(node, key, length, 0);
+    if (position < node->count && AK_btree_node_compare(node, position, key, length) == 0) {
+        while (depth > 0)
+            AK_btree_release(path[--depth]);
+        return EXIT_WARNING;
+    }
+
+    entry.key = key;
+    entry.length = length;
+    entry.child = 0;
+    for (i = depth - 1; i >= 0; i--) {
+        mem_block = path[i];
+        node = (AK_btree_node *) mem_block->block->data;
+        level = node->level;
+        next = node->next;
+        child = node->child;
+        count = AK_btree_read_entries(node);
+        position = AK_btree_node_search(node, entry.key, entry.length, 1);
+        memmove(entries + position + 1, entries + position, (count - position) * sizeof (AK_btree_entry));
+        entries[position] = entry;
+        count++;
+
+        sums[0] = 0;
+        for (split = 0; split < count; split++)
+            sums[split + 1] = sums[split] + entries[split].length;
+        if (AK_btree_node_bytes(entries, sums, 0, count, level > 0) <= AK_btree_node_size) {
+            AK_btree_write_node(mem_block->block, level, next, child, entries, count);
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            break;
+        }
+
+        split = AK_btree_split_point(entries, count, level > 0);
+        if (mem_block->block->address == meta->root) {
+            if (meta->height >= AK_BTREE_MAX_HEIGHT || (left = AK_btree_allocate(indexName, meta_block)) == EXIT_ERROR
+                    || (right = AK_btree_allocate(indexName, meta_block)) == EXIT_ERROR) {
+                result = EXIT_ERROR;
+                break;
+            }
+            if (level == 0) {
+                AK_btree_write_new_node(right, 0, 0, 0, entries + split, count - split);
+                AK_btree_write_new_node(left, 0, right, 0, entries, split);
+                entry.length = AK_btree_separator(entries + split - 1, entries + split, separator);
+            } else {
+                AK_btree_write_new_node(right, level, 0, entries[split].child, entries + split + 1, count - split - 1);
+                AK_btree_write_new_node(left, level, right, child, entries, split);
+                memmove(separator, entries[split].key, entries[split].length);
+                entry.length = entries[split].length;
+            }
+            entry.key = separator;
+            entry.child = right;
+            AK_btree_write_node(mem_block->block, level + 1, 0, left, &entry, 1);
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+            meta->height++;
+            AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+            AK_unlatch_block(meta_block);
+            break;
+        }
+
+        //the parent of a node that can split is still latched
+        if (i == 0 || (right = AK_btree_allocate(indexName, meta_block)) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+        //the right node is written first, lookups reach it through the left one
+        if (level == 0) {
+            AK_btree_write_new_node(right, 0, next, 0, entries + split, count - split);
+            AK_btree_write_node(mem_block->block, 0, right, 0, entries, split);
+            entry.length = AK_btree_separator(entries + split - 1, entries + split, separator);
+        } else {
+            AK_btree_write_new_node(right, level, next, entries[split].child, entries + split + 1, count - split - 1);
+            AK_btree_write_node(mem_block->block, level, right, child, entries, split);
+            memmove(separator, entries[split].key, entries[split].length);
+            entry.length = entries[split].length;
+        }
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        entry.key = separator;
+        entry.child = right;
+    }
+
+    while (depth > 0)
+        AK_btree_release(path[--depth]);
+    if (result == EXIT_SUCCESS) {
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->num_entries++;
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
+    }
+    return result;
+}
+
+/**
+ * @brief Function that pins the meta block of a built index for a change. Called while AK_btree_write_lock is held.
+ * @param indexName name of the index
+ * @return meta block, pinned but not latched; NULL if the index does not exist or is being built
+ */
+static AK_mem_block *AK_btree_pin_built(char *indexName) {
+    AK_mem_block *meta_block = AK_btree_pin_meta(indexName, AK_LATCH_SHARED);
+
+    if (meta_block == NULL)
+        return NULL;
+    AK_unlatch_block(meta_block);
+    if (((AK_btree_meta *) meta_block->block->data)->height == 0) {
+        AK_unpin_block(meta_block);
+        return NULL;
+    }
+    return meta_block;
+}
+
+int AK_btree_insert(char *indexName, unsigned char *value, int length, struct_add *row) {
+    unsigned char key[AK_BTREE_MAX_KEY];
+    AK_mem_block *meta_block;
+    int result = EXIT_ERROR;
+    AK_PRO;
+
+    if (length < 0 || length > AK_BTREE_MAX_VALUE) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    length = AK_btree_make_key(value, length, row, key);
+    pthread_mutex_lock(&AK_btree_write_lock);
+    if ((meta_block = AK_btree_pin_built(indexName)) != NULL) {
+        result = AK_btree_insert_key(indexName, meta_block, key, length);
+        AK_unpin_block(meta_block);
+    }
+    pthread_mutex_unlock(&AK_btree_write_lock);
+    if (result == EXIT_ERROR)
+        printf("AK_btree_insert: ERROR. Cannot insert into index %s.\n", indexName);
+    AK_EPI;
+    return result;
+}
+
+int AK_btree_delete_entry(char *indexName, unsigned char *value, int length, struct_add *row) {
+    unsigned char key[AK_BTREE_MAX_KEY];
+    AK_mem_block *meta_block, *mem_block, *child;
+    AK_btree_meta *meta;
+    AK_btree_node *node;
+    int position, count, level, next, result = EXIT_WARNING;
+    AK_PRO;
+
+    if (length < 0 || length > AK_BTREE_MAX_VALUE) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    length = AK_btree_make_key(value, length, row, key);
+    pthread_mutex_lock(&AK_btree_write_lock);
+    if ((meta_block = AK_btree_pin_built(indexName)) == NULL) {
+        pthread_mutex_unlock(&AK_btree_write_lock);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    meta = (AK_btree_meta *) meta_block->block->data;
+
+    //nodes are never merged, so only the leaf changes
+    mem_block = AK_pin_block(meta->root);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    node = (AK_btree_node *) mem_block->block->data;
+    while (node->level > 0) {
+        child = AK_pin_block(AK_btree_node_child(node, key, length));
+        AK_latch_block(child, AK_LATCH_EXCLUSIVE);
+        AK_btree_release(mem_block);
+        mem_block = child;
+        node = (AK_btree_node *) mem_block->block->data;
+    }
+    position = AK_btree_node_search(node, key, length, 0);
+    if (position < node->count && AK_btree_node_compare(node, position, key, length) == 0) {
+        level = node->level;
+        next = node->next;
+        count = AK_btree_read_entries(node);
+        memmove(AK_btree_entries + position, AK_btree_entries + position + 1, (count - position - 1) * sizeof (AK_btree_entry));
+        AK_btree_write_node(mem_block->block, level, next, 0, AK_btree_entries, count - 1);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        result = EXIT_SUCCESS;
+    }
+    AK_btree_release(mem_block);
+
+    if (result == EXIT_SUCCESS) {
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->num_entries--;
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
+    }
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_btree_write_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief Function that reads the keys of a table for a bulk build
+ * @param tblName table name
+ * @param attribute index of the indexed attribute
+ * @param type type of the indexed attribute
+ * @param keys set to the buffer holding the keys, allocated with AK_malloc
+ * @param count set to the number of keys
+ * @return keys in table order, allocated with AK_malloc
+ */
+static AK_btree_entry *AK_btree_read_keys(char *tblName, int attribute, int type, unsigned char **keys, int *count) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    AK_btree_entry *items;
+    struct list_node *row, *el;
+    struct_add address;
+    int capacity = 1024, used = 0, length, l, i;
+
+    items = (AK_btree_entry *) AK_malloc(capacity * sizeof (AK_btree_entry));
+    *keys = (unsigned char *) AK_malloc(capacity * AK_btree_max_key(type));
+    *count = 0;
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL) {
+        for (el = AK_First_L2(row), l = 0; l < attribute; l++)
+            el = el->next;
+        if (el->type != type)
+            continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            items = (AK_btree_entry *) AK_realloc(items, capacity * sizeof (AK_btree_entry));
+            *keys = (unsigned char *) AK_realloc(*keys, capacity * AK_btree_max_key(type));
+        }
+        if ((length = AK_btree_encode_value(type, el->data, el->size, *keys + used)) == EXIT_ERROR)
+            continue;
+        address.addBlock = cursor->block;
+        address.indexTd = cursor->tuple - cursor->num_attr;
+        AK_btree_put_int(address.addBlock, *keys + used + length);
+        AK_btree_put_int(address.indexTd, *keys + used + length + 4);
+        //the buffer may still move, so the offset of the key is kept until all keys are read
+        items[*count].child = used;
+        items[*count].length = length + AK_BTREE_ROW_SIZE;
+        used += items[*count].length;
+        (*count)++;
+    }
+    AK_table_cursor_close(cursor);
+
+    for (i = 0; i < *count; i++) {
+        items[i].key = *keys + items[i].child;
+        items[i].child = 0;
+    }
+    return items;
+}
+
+int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName) {
+    struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
+    AK_header *t_header, i_header[MAX_ATTRIBUTES], *temp;
+    table_addresses *addresses;
+    AK_mem_block *meta_block;
+    AK_btree_meta *meta;
+    AK_btree_entry *items;
+    unsigned char *keys;
+    int num_attr, i, type, start, count, height;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    if (attribute == NULL || num_attr <= 0 || (t_header = AK_get_header(tblName)) == NULL) {
+        printf("AK_btree_create: ERROR. Table %s does not exist.\n", tblName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < num_attr && strcmp(t_header[i].att_name, attribute->data) != 0; i++)
+        ;
+    if (i == num_attr) {
+        printf("AK_btree_create: ERROR. Attribute %s does not exist in table %s.\n", attribute->data, tblName);
+        AK_free(t_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    type = t_header[i].type;
+    if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER && type != TYPE_VARCHAR && type != TYPE_DATE
+            && type != TYPE_DATETIME && type != TYPE_TIME) {
+        printf("AK_btree_create: ERROR. Attributes of type %d cannot be indexed.\n", type);
+        AK_free(t_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    if (start != 0) {
+        printf("AK_btree_create: ERROR. Index %s already exists.\n", indexName);
+        AK_free(t_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(i_header, 0, sizeof (i_header));
+    temp = (AK_header *) AK_create_header(t_header[i].att_name, type, FREE_INT, FREE_CHAR, FREE_CHAR);
+    memcpy(i_header, temp, sizeof (AK_header));
+    AK_free(temp);
+    AK_free(t_header);
+
+    pthread_mutex_lock(&AK_btree_write_lock);
+    if ((start = AK_initialize_new_index_segment(indexName, AK_get_table_obj_id(tblName), i, i_header)) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_btree_write_lock);
+        printf("AK_btree_create: ERROR. Cannot create the segment of index %s.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = AK_get_index_addresses(indexName);
+
+    //the meta block is the first block of the segment and the root the second one
+    meta_block = AK_pin_block(start);
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    memset(meta_block->block->data, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE);
+    meta = (AK_btree_meta *) meta_block->block->data;
+    meta->magic = AK_BTREE_MAGIC;
+    meta->table_id = AK_get_table_obj_id(tblName);
+    meta->attribute = i;
+    meta->type = type;
+    meta->root = start + 1;
+    meta->height = 0;
+    meta->num_nodes = 1;
+    meta->num_entries = 0;
+    meta->next_block = start + 2;
+    meta->extent_end = addresses->address_to[0];
+    AK_btree_set_block_size(meta_block->block, sizeof (AK_btree_meta));
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    AK_free(addresses);
+
+    items = AK_btree_read_keys(tblName, i, type, &keys, &count);
+    qsort(items, count, sizeof (AK_btree_entry), AK_btree_entry_compare);
+    height = AK_btree_build(indexName, meta_block, items, count);
+    AK_free(items);
+    AK_free(keys);
+
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    if (height != EXIT_ERROR) {
+        meta->height = height;
+        meta->num_entries = count;
+    }
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_btree_write_lock);
+
+    if (height == EXIT_ERROR) {
+        printf("AK_btree_create: ERROR. Cannot build index %s.\n", indexName);
+        AK_btree_delete(indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(HIGH, INDICES, "AK_btree_create: index %s on %s has %d entries in %d levels\n", indexName, tblName, count, height);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+int AK_btree_delete(char *indexName) {
+    int result;
+    AK_PRO;
+    pthread_mutex_lock(&AK_btree_write_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_mutex_unlock(&AK_btree_write_lock);
+    AK_EPI;
+    return result;
+}
+
+void AK_btree_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple) {
+    AK_btree_index indexes[AK_BTREE_MAX_INDEXES];
+    unsigned char values[AK_BTREE_MAX_INDEXES][AK_BTREE_MAX_VALUE];
+    int lengths[AK_BTREE_MAX_INDEXES], count, attribute, i;
+    struct_add row;
+    AK_PRO;
+
+    count = AK_btree_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++) {
+        attribute = indexes[i].attribute;
+        lengths[i] = (attribute < MAX_ATTRIBUTES && type[attribute] == indexes[i].type)
+            ? AK_btree_encode_value(type[attribute], data[attribute], size[attribute], values[i]) : EXIT_ERROR;
+    }
+    row.addBlock = block;
+    row.indexTd = tuple;
+    for (i = 0; i < count; i++)
+        if (lengths[i] != EXIT_ERROR)
+            AK_btree_insert(indexes[i].name, values[i], lengths[i], &row);
+    AK_EPI;
 }
 
+void AK_btree_index_tuple(char *tblName, AK_block *block, int tuple) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i;
+    char *data[MAX_ATTRIBUTES];
+    AK_PRO;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        if (block->header[i].att_name[0] != '\0' && tuple + i < DATA_BLOCK_SIZE) {
+            type[i] = AK_tuple_type(block, tuple + i);
+            size[i] = AK_tuple_size(block, tuple + i);
+            data[i] = (char *) AK_tuple_data(block, tuple + i);
+        } else {
+            type[i] = FREE_INT;
+            size[i] = 0;
+            data[i] = NULL;
+        }
+    }
+    AK_btree_index_row(tblName, type, size, data, block->address, tuple);
+    AK_EPI;
+}
+
+/// set when the writer of AK_btree_test is done, the reader threads stop then
+static volatile int AK_btree_test_stop;
+
+/**
+ * @brief Function that reads the value of the first attribute of a row
+ * @param row row address
+ * @return integer value
+ */
+static int AK_btree_test_row_id(struct_add *row) {
+    AK_mem_block *mem_block = AK_get_block(row->addBlock);
+    int value;
+    memcpy(&value, AK_tuple_data(mem_block->block, row->indexTd), sizeof (int));
+    return value;
+}
+
+/**
+ * @brief Function that searches an INT index for a range of values
+ * @param indexName name of the index
+ * @param low lowest value
+ * @param low_inclusive 1 if low is in the range
+ * @param high highest value
+ * @param high_inclusive 1 if high is in the range
+ * @param rows set to the addresses of the rows
+ * @return number of rows, EXIT_ERROR if the index does not exist
+ */
+static int AK_btree_test_range(char *indexName, int low, int low_inclusive, int high, int high_inclusive, struct_add **rows) {
+    unsigned char value[AK_BTREE_MAX_VALUE];
+    AK_btree_range range;
+    int length;
+
+    AK_btree_range_init(&range);
+    length = AK_btree_encode_value(TYPE_INT, (char *) &low, sizeof (int), value);
+    AK_btree_range_lower(&range, value, length, low_inclusive);
+    length = AK_btree_encode_value(TYPE_INT, (char *) &high, sizeof (int), value);
+    AK_btree_range_upper(&range, value, length, high_inclusive);
+    return AK_btree_search_range(indexName, &range, rows);
+}
+
+/**
+ * @brief Function run by the reader threads of AK_btree_test. The ranges it scans hold 100 rows of the table, the
+ * other thread adds entries with made up addresses into the same leaves. Every scan has to find the 100 rows and
+ * the added entries in the order of their values.
+ * @param failed number of failed scans
+ */
+static void *AK_btree_test_reader(void *failed) {
+    struct_add *rows;
+    int scans = 0, low, count, found, last, i;
+
+    while (!AK_btree_test_stop || scans < 10) {
+        low = (scans * 37) % 1900;
+        count = AK_btree_test_range("btree_test_stress", low, 1, low + 99, 1, &rows);
+        found = 0;
+        last = low;
+        for (i = 0; i < count; i++)
+            if (rows[i].addBlock < 1000000)
+                found++;
+            else if (rows[i].addBlock - 1000000 < last || rows[i].addBlock - 1000000 > low + 99)
+                found = -1000000;
+            else
+                last = rows[i].addBlock - 1000000;
+        if (found != 100)
+            (*(int *) failed)++;
+        AK_free(rows);
+        scans++;
+    }
+    return NULL;
+}
+
+/**
+  * @brief Function for testing B+tree indexes. A table is indexed on an integer and on a varchar attribute, the
+  * indexes are checked with point and range lookups, rows written later have to show up in them, the selection
+  * and AK_search_unsorted results have to match a scan, and lookups run concurrently with inserts into a tree with
+  * small nodes.
+  * @return test result
+  */
+TestResult AK_btree_test() {
+    char *tblName = "btree_test", *idIndex = "btree_test_id", *cityIndex = "btree_test_city", *stressIndex = "btree_test_stress";
+    int num_rows = 2000, num_inserts = 2000, num_readers = 4;
+    AK_header header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "city", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    int type[3] = {TYPE_INT, TYPE_VARCHAR, TYPE_VARCHAR}, size[3];
+    char *data[3], name[MAX_VARCHAR_LENGTH], city[MAX_VARCHAR_LENGTH];
+    unsigned char value[AK_BTREE_MAX_VALUE];
+    int ok = 0, fail = 0, i, id, count, length, expected, failed[4] = {0, 0, 0, 0}, inserted = 0, height;
+    double start, index_time, scan_time;
+    AK_access_path path;
+    AK_table_writer *writer;
+    AK_btree_meta meta;
+    struct_add *rows, row;
+    struct list_node *attributes, *row_root, *expr;
+    pthread_t readers[4];
+    search_params params;
+    search_result result;
+    AK_PRO;
+
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    writer = AK_table_writer_open(tblName);
+    for (i = 0; i < num_rows; i++) {
+        id = (i * 7919) % num_rows;
+        sprintf(name, "name%d", id);
+        sprintf(city, "city%d", i % 10);
+        data[0] = (char *) &id;
+        data[1] = name;
+        data[2] = city;
+        size[0] = sizeof (int);
+        size[1] = strlen(name);
+        size[2] = strlen(city);
+        AK_table_writer_append_values(writer, type, size, data);
+    }
+    AK_table_writer_close(writer);
+
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), attributes);
+    AK_btree_create(tblName, attributes, idIndex);
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "city", sizeof ("city"), attributes);
+    AK_btree_create(tblName, attributes, cityIndex);
+
+    if (AK_btree_get_meta(idIndex, &meta) == EXIT_SUCCESS && meta.num_entries == num_rows && meta.height >= 2 && meta.num_nodes > 2
+            && AK_btree_get_meta(cityIndex, &meta) == EXIT_SUCCESS && meta.num_entries == num_rows)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Indexes of %s were not built.\n", tblName);
+        fail++;
+    }
+    AK_btree_get_meta(idIndex, &meta);
+    printf("index %s: %d entries, %d levels, %d nodes\n", idIndex, meta.num_entries, meta.height, meta.num_nodes);
+
+    //point lookups
+    for (i = 0, expected = 0; i < num_rows; i += 37) {
+        length = AK_btree_encode_value(TYPE_INT, (char *) &i, sizeof (int), value);
+        count = AK_btree_search(idIndex, value, length, &rows);
+        if (count == 1 && AK_btree_test_row_id(rows) == i)
+            expected++;
+        AK_free(rows);
+    }
+    id = num_rows;
+    length = AK_btree_encode_value(TYPE_INT, (char *) &id, sizeof (int), value);
+    count = AK_btree_search(idIndex, value, length, &rows);
+    AK_free(rows);
+    if (expected == (num_rows + 36) / 37 && count == 0)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Point lookups found %d of %d rows.\n", expected, (num_rows + 36) / 37);
+        fail++;
+    }
+
+    //ranges with inclusive and exclusive bounds come back in key order
+    count = AK_btree_test_range(idIndex, 100, 1, 200, 1, &rows);
+    for (i = 0, expected = 0; i < count; i++)
+        if (AK_btree_test_row_id(rows + i) == 100 + i)
+            expected++;
+    AK_free(rows);
+    if (count == 101 && expected == 101 && AK_btree_test_range(idIndex, 100, 0, 200, 0, &rows) == 99
+            && AK_btree_test_row_id(rows) == 101)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Range [100, 200] returned %d rows, %d in order.\n", count, expected);
+        fail++;
+    }
+    AK_free(rows);
+
+    length = AK_btree_encode_value(TYPE_VARCHAR, "city3", strlen("city3"), value);
+    count = AK_btree_search(cityIndex, value, length, &rows);
+    AK_free(rows);
+    if (count == num_rows / 10)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Index %s found %d rows of city3.\n", cityIndex, count);
+        fail++;
+    }
+
+    //rows written by AK_insert_row and by a table writer are indexed
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    id = 5000;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", tblName, "name", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "city3", tblName, "city", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    writer = AK_table_writer_open(tblName);
+    id = 5001;
+    data[0] = (char *) &id;
+    data[1] = "written";
+    data[2] = "city4";
+    size[1] = strlen(data[1]);
+    size[2] = strlen(data[2]);
+    AK_table_writer_append_values(writer, type, size, data);
+    AK_table_writer_close(writer);
+    count = AK_btree_test_range(idIndex, 5000, 1, 5001, 1, &rows);
+    if (count == 2 && AK_btree_test_row_id(rows) == 5000 && AK_btree_test_row_id(rows + 1) == 5001
+            && AK_btree_search(cityIndex, value, AK_btree_encode_value(TYPE_VARCHAR, "city3", 5, value), &rows) == num_rows / 10 + 1)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Inserted rows found %d times in %s.\n", count, idIndex);
+        fail++;
+    }
+    AK_free(rows);
+
+    //selection and AK_search_unsorted take the index
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    id = 777;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    start = TEST_time_ms();
+    AK_selection(tblName, "btree_test_sel_index", expr);
+    index_time = TEST_time_ms() - start;
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name777", sizeof ("name777"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    start = TEST_time_ms();
+    AK_selection(tblName, "btree_test_sel_scan", expr);
+    scan_time = TEST_time_ms() - start;
+    printf("\nselection of one row of %d: %.1f ms with the index, %.1f ms with a scan\n\n", num_rows, index_time, scan_time);
+
+    AK_DeleteAll_L3(&expr);
+    id = 100;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">=", sizeof (">="), expr);
+    id = 300;
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "city", sizeof ("city"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "city3", sizeof ("city3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_selection(tblName, "btree_test_sel_range", expr);
+    //the equality on city is expected to narrow the rows down more than the range of id
+    AK_selection_explain(tblName, expr, &path);
+    for (i = 0, expected = 0; i < num_rows; i++)
+        if ((i * 7919) % num_rows >= 100 && (i * 7919) % num_rows < 300 && i % 10 == 3)
+            expected++;
+    if (AK_get_num_records("btree_test_sel_index") == 1 && AK_get_num_records("btree_test_sel_scan") == 1
+            && AK_get_num_records("btree_test_sel_range") == expected)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Selections returned %d, %d and %d rows instead of 1, 1 and %d.\n",
+            AK_get_num_records("btree_test_sel_index"), AK_get_num_records("btree_test_sel_scan"),
+            AK_get_num_records("btree_test_sel_range"), expected);
+        fail++;
+    }
+    if (path.method == AK_ACCESS_BTREE && strcmp(path.index, cityIndex) == 0)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Range selection chose access path %d of %s.\n", path.method, path.index);
+        fail++;
+    }
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+
+    params.szAttribute = "id";
+    id = 1990;
+    expected = 5001;
+    params.pData_lower = &id;
+    params.pData_upper = &expected;
+    params.iSearchType = SEARCH_RANGE;
+    result = AK_search_unsorted(tblName, &params, 1);
+    count = result.iNum_tuple_addresses;
+    AK_deallocate_search_result(result);
+    params.szAttribute = "city";
+    params.pData_lower = "city3";
+    params.iSearchType = SEARCH_PARTICULAR;
+    result = AK_search_unsorted(tblName, &params, 1);
+    if (count == 12 && result.iNum_tuple_addresses == num_rows / 10 + 1)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. AK_search_unsorted found %d and %d rows instead of 12 and %d.\n", count,
+            result.iNum_tuple_addresses, num_rows / 10 + 1);
+        fail++;
+    }
+    AK_deallocate_search_result(result);
+
+    //lookups run while entries are added to a tree with small nodes
+    AK_btree_node_size = 200;
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), attributes);
+    AK_btree_create(tblName, attributes, stressIndex);
+    AK_btree_get_meta(stressIndex, &meta);
+    height = meta.height;
+    AK_btree_test_stop = 0;
+    for (i = 0; i < num_readers; i++)
+        pthread_create(&readers[i], NULL, AK_btree_test_reader, &failed[i]);
+    for (i = 0; i < num_inserts; i++) {
+        id = (i * 7) % num_rows;
+        row.addBlock = 1000000 + id;
+        row.indexTd = i;
+        length = AK_btree_encode_value(TYPE_INT, (char *) &id, sizeof (int), value);
+        if (AK_btree_insert(stressIndex, value, length, &row) == EXIT_SUCCESS)
+            inserted++;
+    }
+    AK_btree_test_stop = 1;
+    for (i = 0; i < num_readers; i++)
+        pthread_join(readers[i], NULL);
+    AK_btree_node_size = AK_BTREE_NODE_SIZE;
+    AK_btree_get_meta(stressIndex, &meta);
+    count = AK_btree_test_range(stressIndex, 0, 1, num_rows - 1, 1, &rows);
+    AK_free(rows);
+    printf("index %s: %d entries, %d levels (%d before the inserts), %d nodes\n", stressIndex, meta.num_entries, meta.height, height, meta.num_nodes);
+    if (inserted == num_inserts && meta.num_entries == num_rows + 2 + num_inserts && count == num_rows + num_inserts
+            && meta.height >= 3 && failed[0] + failed[1] + failed[2] + failed[3] == 0)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. %d entries inserted, %d found, %d failed lookups.\n", inserted, count,
+            failed[0] + failed[1] + failed[2] + failed[3]);
+        fail++;
+    }
+
+    //deleted entries are gone, the index is dropped with its segment
+    id = 0;
+    length = AK_btree_encode_value(TYPE_INT, (char *) &id, sizeof (int), value);
+    AK_btree_search(idIndex, value, length, &rows);
+    row = rows[0];
+    AK_free(rows);
+    if (AK_btree_delete_entry(idIndex, value, length, &row) == EXIT_SUCCESS && AK_btree_search(idIndex, value, length, &rows) == 0
+            && AK_btree_delete_entry(idIndex, value, length, &row) == EXIT_WARNING)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Entry of %d was not deleted.\n", id);
+        fail++;
+    }
+    AK_free(rows);
+
+    AK_btree_delete(idIndex);
+    AK_btree_delete(cityIndex);
+    AK_btree_delete(stressIndex);
+    if (AK_btree_get_meta(idIndex, &meta) == EXIT_ERROR && AK_btree_find_index(tblName, 0, name) == EXIT_WARNING)
+        ok++;
+    else {
+        printf("AK_btree_test: ERROR. Index %s was not dropped.\n", idIndex);
+        fail++;
+    }
+
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    AK_free(row_root);
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
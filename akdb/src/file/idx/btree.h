@@ -6,12 +6,12 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
@@ -20,73 +20,293 @@
 #ifndef BTREE
 #define BTREE
 
-#define B 3
-//order of the tree 6 - it can be lowered to usual 4-5 IF the B is increased!
-#define ORDER 6
-//now we have place for ((B+1)^(0RDER-1))*B = ((3+1)^(6-1))*3 = (4^5)*3 = 1024*3 = 3072 elements
-
-//types for tuple_dict
-#define LEAF 0
-#define NODE 1
-
 #include "../../auxi/test.h"
 #include "index.h"
 #include "../../file/table.h"
 #include "../../auxi/constants.h"
 #include "../../auxi/configuration.h"
 #include "../../auxi/mempro.h"
+#include <pthread.h>
 
-typedef struct{
-	//B values
-	int values[B];
-	/*
-	B + 1 pointers
-	IF type == 1 -> it points to other B+1 nodes/leafs
-	IF type == 0 -> first B points to addresses in tblName
-	and last pointer points to the next leaf (rangeSearch)
-	*/
-	struct_add pointers[B+1];
-}btree_node;
+/**
+ * @def AK_BTREE_MAGIC
+ * @brief Constant marking the first block of a B+tree index segment
+ */
+#define AK_BTREE_MAGIC 0x42547265
 
-/*
-root_info->level[index] represents the number of nodes in 
-that level from leafs to root, where root is always 1 (root doesn't
-have to be on index 5 - if order of the tree is 3 it can be on 2 so we
-distinct root lvl by value == 1). This is just theoretical representation
-of the full usage of the array for B=3 and 0=6.
-
-index|	     0 |       1 |       2 |       3 |       4 |       5 |
-value| (B+1)^5 | (B+1)^4 | (B+1)^3 | (B+1)^2 | (B+1)^1 | (B+1)^0 |
-level|   leaf  |         |         |         |         |   root  |
-*/
-typedef struct{
-	//tuple_dic[ID] of the root node in the block
-	int root;
-	//array size of the 0RDER
-	int level[ORDER]; 
-}root_info;
-
-
-/**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
-  * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
-  * @param indexName - name of the index
+/**
+ * @def AK_BTREE_NODE_SIZE
+ * @brief Constant declaring the size of a B+tree node in bytes, a node takes the data area of one block
+ */
+#define AK_BTREE_NODE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+
+/**
+ * @def AK_BTREE_MAX_VALUE
+ * @brief Constant declaring the maximum length of an encoded attribute value (a varchar and its terminator)
+ */
+#define AK_BTREE_MAX_VALUE (MAX_VARCHAR_LENGTH + 1)
+
+/**
+ * @def AK_BTREE_ROW_SIZE
+ * @brief Constant declaring the length of the encoded row address appended to the value of a key
+ */
+#define AK_BTREE_ROW_SIZE 8
+
+/**
+ * @def AK_BTREE_MAX_KEY
+ * @brief Constant declaring the maximum length of a key
+ */
+#define AK_BTREE_MAX_KEY (AK_BTREE_MAX_VALUE + AK_BTREE_ROW_SIZE)
+
+/**
+ * @def AK_BTREE_MAX_ENTRIES
+ * @brief Constant declaring the maximum number of entries of a node. Keys are unique, so at most one of them is
+ * stored without bytes after the prefix and every other entry takes at least four bytes.
+ */
+#define AK_BTREE_MAX_ENTRIES (AK_BTREE_NODE_SIZE / 4 + 2)
+
+/**
+ * @def AK_BTREE_MAX_HEIGHT
+ * @brief Constant declaring the maximum number of levels of a B+tree
+ */
+#define AK_BTREE_MAX_HEIGHT 16
+
+/**
+ * @def AK_BTREE_FILL
+ * @brief Constant declaring how full (in percent) a bulk build packs the nodes, the rest is left for inserts
+ */
+#define AK_BTREE_FILL 90
+
+/**
+ * @def AK_BTREE_MAX_INDEXES
+ * @brief Constant declaring the maximum number of B+tree indexes kept in the list used to maintain them
+ */
+#define AK_BTREE_MAX_INDEXES 64
+
+/**
+ * @struct AK_btree_meta
+ * @brief Structure stored in the first block of a B+tree index segment
+ */
+typedef struct {
+    /// AK_BTREE_MAGIC
+    int magic;
+    /// obj_id of the indexed table
+    int table_id;
+    /// index and type of the indexed attribute
+    int attribute;
+    int type;
+    /// address of the root node; the root never moves, a root split moves its entries into two new nodes
+    int root;
+    /// number of levels, 0 while the index is being built
+    int height;
+    int num_nodes;
+    int num_entries;
+    /// next unused block of the segment and the end of its extent
+    int next_block;
+    int extent_end;
+} AK_btree_meta;
+
+/**
+ * @struct AK_btree_node
+ * @brief Structure that starts a B+tree node. It is followed by the prefix shared by all keys of the node, the
+ * offsets of the entries and the entries. An entry holds the length and the bytes of its key after the prefix,
+ * an entry of an inner node also the address of the child holding the keys from that key on.
+ */
+typedef struct {
+    /// 0 for leaves
+    short level;
+    short count;
+    /// length of the prefix shared by all keys
+    short prefix;
+    /// number of bytes used
+    short size;
+    /// right sibling on the same level, 0 for the last node
+    int next;
+    /// inner nodes: child holding the keys lower than the first key
+    int child;
+} AK_btree_node;
+
+/**
+ * @struct AK_btree_entry
+ * @brief Structure that defines a key of a node while the node is being changed or built
+ */
+typedef struct {
+    unsigned char *key;
+    int length;
+    /// child holding the keys from this key on, 0 in leaves
+    int child;
+} AK_btree_entry;
+
+/**
+ * @struct AK_btree_range
+ * @brief Structure that defines the bounds of a range search over encoded values
+ */
+typedef struct {
+    unsigned char lower[AK_BTREE_MAX_VALUE];
+    /// -1 if there is no lower bound
+    int lower_length;
+    int lower_inclusive;
+    unsigned char upper[AK_BTREE_MAX_VALUE];
+    /// -1 if there is no upper bound
+    int upper_length;
+    int upper_inclusive;
+} AK_btree_range;
+
+/**
+ * @struct AK_btree_index
+ * @brief Structure that defines a B+tree index found in the system catalog
+ */
+typedef struct {
+    char name[MAX_VARCHAR_LENGTH];
+    int table_id;
+    int attribute;
+    int type;
+    /// address of the meta block
+    int meta;
+} AK_btree_index;
+
+/**
+ * @brief Function that encodes an attribute value into the byte string a B+tree stores. Byte strings compare
+ * with memcmp in the order of the values, so keys of every type are compared the same way.
+ * @param type type of the value (TYPE_INT, TYPE_FLOAT, TYPE_NUMBER, TYPE_VARCHAR, TYPE_DATE, TYPE_DATETIME or TYPE_TIME)
+ * @param data value as stored in a block
+ * @param size size of the value
+ * @param key buffer of AK_BTREE_MAX_VALUE bytes
+ * @return length of the encoded value, EXIT_ERROR if the type cannot be indexed
+ */
+int AK_btree_encode_value(int type, const char *data, int size, unsigned char *key);
+
+/**
+ * @brief Function that compares two keys or encoded values
+ * @param a first key
+ * @param a_length length of the first key
+ * @param b second key
+ * @param b_length length of the second key
+ * @return negative value, zero or positive value if a is lower than, equal to or greater than b
+ */
+int AK_btree_compare(const unsigned char *a, int a_length, const unsigned char *b, int b_length);
+
+/**
+ * @brief Function that initializes a range without bounds
+ * @param range range
+ */
+void AK_btree_range_init(AK_btree_range *range);
+
+/**
+ * @brief Function that narrows the lower bound of a range, a bound lower than the current one is ignored
+ * @param range range
+ * @param value encoded value
+ * @param length length of the value
+ * @param inclusive 1 if the value itself is in the range
+ */
+void AK_btree_range_lower(AK_btree_range *range, const unsigned char *value, int length, int inclusive);
+
+/**
+ * @brief Function that narrows the upper bound of a range, a bound greater than the current one is ignored
+ * @param range range
+ * @param value encoded value
+ * @param length length of the value
+ * @param inclusive 1 if the value itself is in the range
+ */
+void AK_btree_range_upper(AK_btree_range *range, const unsigned char *value, int length, int inclusive);
+
+/**
+  * @author Anđelko Spevec, rewritten as a disk-paged B+tree
+  * @brief Function that creates a B+tree index on an attribute of a table. The rows are read once, sorted and
+  * packed into leaves from left to right, the inner levels are built on top of them.
+  * @param tblName name of the table on which we are creating index
+  * @param attributes list whose first element is the attribute on which we are creating index
+  * @param indexName name of the index
+  * @return EXIT_SUCCESS, EXIT_ERROR if the attribute does not exist or its type cannot be indexed
  */
 int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName);
+
+/**
+  * @brief Function that drops a B+tree index
+  * @param indexName name of the index
+  * @return EXIT_SUCCESS, EXIT_ERROR if the segment could not be deleted
+ */
 int AK_btree_delete(char *indexName);
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
+  * @brief Function that inserts an entry into a B+tree index. Nodes are latched exclusively from the root down and
+  * released as soon as a node below them has room for a split, so lookups run past the parts not being changed.
+  * @param indexName name of the index
+  * @param value encoded value
+  * @param length length of the value
+  * @param row address of the row
+  * @return EXIT_SUCCESS, EXIT_WARNING if the entry is already in the index, EXIT_ERROR if the index does not exist
+ */
+int AK_btree_insert(char *indexName, unsigned char *value, int length, struct_add *row);
+
+/**
+  * @brief Function that deletes an entry from a B+tree index. Nodes are not merged, an empty leaf stays in the tree.
+  * @param indexName name of the index
+  * @param value encoded value
+  * @param length length of the value
+  * @param row address of the row
+  * @return EXIT_SUCCESS, EXIT_WARNING if the entry is not in the index, EXIT_ERROR if the index does not exist
+ */
+int AK_btree_delete_entry(char *indexName, unsigned char *value, int length, struct_add *row);
+
+/**
+  * @brief Function that searches a B+tree index for a range of values. Lookups latch the nodes shared, a node is
+  * released only after its child or right sibling has been latched. Entries of rows that were deleted or changed
+  * later are not removed, the caller checks the rows it reads.
+  * @param indexName name of the index
+  * @param range range of encoded values
+  * @param rows set to the addresses of the rows in the order of the values, allocated with AK_malloc
+  * @return number of rows, EXIT_ERROR if the index does not exist or is being built
+ */
+int AK_btree_search_range(char *indexName, AK_btree_range *range, struct_add **rows);
+
+/**
+  * @brief Function that searches a B+tree index for a value
+  * @param indexName name of the index
+  * @param value encoded value
+  * @param length length of the value
+  * @param rows set to the addresses of the rows, allocated with AK_malloc
+  * @return number of rows, EXIT_ERROR if the index does not exist or is being built
+ */
+int AK_btree_search(char *indexName, unsigned char *value, int length, struct_add **rows);
+
+/**
+  * @brief Function that copies the meta block of a B+tree index
+  * @param indexName name of the index
+  * @param meta copy of the meta block
+  * @return EXIT_SUCCESS, EXIT_ERROR if the index does not exist
  */
-void AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo);
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock);
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta);
+
+/**
+  * @brief Function that finds a B+tree index on an attribute of a table
+  * @param tblName table name
+  * @param attribute index of the attribute
+  * @param indexName buffer of MAX_VARCHAR_LENGTH characters the index name is copied to
+  * @return EXIT_SUCCESS, EXIT_WARNING if the attribute is not indexed
+ */
+int AK_btree_find_index(char *tblName, int attribute, char *indexName);
+
+/**
+  * @brief Function that adds a row written to a table to the B+tree indexes of the table. The values are
+  * encoded before any index is changed, so they may point into a cached block.
+  * @param tblName table name
+  * @param type types of the values in header order
+  * @param size sizes of the values
+  * @param data values
+  * @param block address of the block the row is in
+  * @param tuple tuple_dict index of the first attribute of the row
+ */
+void AK_btree_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple);
+
+/**
+  * @brief Function that adds a row of a block to the B+tree indexes of the table
+  * @param tblName table name
+  * @param block block the row is in
+  * @param tuple tuple_dict index of the first attribute of the row
+ */
+void AK_btree_index_tuple(char *tblName, AK_block *block, int tuple);
+
 TestResult AK_btree_test();
 
 #endif
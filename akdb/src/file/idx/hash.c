@@ -6,12 +6,12 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
@@ -19,623 +19,1498 @@
 
 
 #include "hash.h"
+#include "../../rel/selection.h"
+#include "../../rel/nat_join.h"
+
+/// writers of all hash indexes are serialized, lookups only take latches
+static pthread_mutex_t AK_hash_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/// hash indexes found in AK_index, reloaded when the catalog changes
+static AK_hash_index AK_hash_indexes[AK_HASH_MAX_INDEXES];
+static int AK_hash_num_indexes = -1;
+static unsigned long AK_hash_indexes_version;
+static pthread_mutex_t AK_hash_indexes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/// primes of XXH64
+#define AK_HASH_PRIME1 11400714785074694791ULL
+#define AK_HASH_PRIME2 14029467366897019727ULL
+#define AK_HASH_PRIME3 1609587929392839161ULL
+#define AK_HASH_PRIME4 9650029242287828579ULL
+#define AK_HASH_PRIME5 2870177450012600261ULL
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
+ * @brief Function that rotates a 64-bit value to the left
  */
-int AK_elem_hash_value(struct list_node *elem) {
-    int type = elem->type, value = 0, i = 0;
-    char temp_char[MAX_VARCHAR_LENGTH];
-    AK_PRO;
-    switch (type) {
-        case TYPE_INT:
-            memcpy(&value, elem->data, elem->size);
-            break;
-        case TYPE_VARCHAR:
-            memcpy(temp_char, elem->data, elem->size);
-            temp_char[ elem->size ] = '\0';
-            do {
-                value += (int) temp_char[i++];
-            } while (temp_char[i]);
-            break;
-    }
-    AK_EPI;
-    return value;
+static unsigned long long AK_hash_rotl(unsigned long long x, int r) {
+    return (x << r) | (x >> (64 - r));
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+ * @brief Function that reads 8 bytes as a little-endian value
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type) {
-    int size, id;
-    AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 0;
-    add->indexTd = 0;
+static unsigned long long AK_hash_read64(const unsigned char *p) {
+    return (unsigned long long) p[0] | ((unsigned long long) p[1] << 8) | ((unsigned long long) p[2] << 16)
+        | ((unsigned long long) p[3] << 24) | ((unsigned long long) p[4] << 32) | ((unsigned long long) p[5] << 40)
+        | ((unsigned long long) p[6] << 48) | ((unsigned long long) p[7] << 56);
+}
+
+/**
+ * @brief Function that mixes 8 bytes of input into an XXH64 accumulator
+ */
+static unsigned long long AK_hash_round(unsigned long long acc, unsigned long long input) {
+    acc += input * AK_HASH_PRIME2;
+    return AK_hash_rotl(acc, 31) * AK_HASH_PRIME1;
+}
+
+/**
+ * @brief Function that merges an XXH64 accumulator into the hash
+ */
+static unsigned long long AK_hash_merge(unsigned long long hash, unsigned long long acc) {
+    hash ^= AK_hash_round(0, acc);
+    return hash * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+}
+
+unsigned long long AK_hash_bytes(const void *data, int size, unsigned long long seed) {
+    const unsigned char *p = (const unsigned char *) data, *end = p + size;
+    unsigned long long hash, v1, v2, v3, v4;
+
+    if (size >= 32) {
+        v1 = seed + AK_HASH_PRIME1 + AK_HASH_PRIME2;
+        v2 = seed + AK_HASH_PRIME2;
+        v3 = seed;
+        v4 = seed - AK_HASH_PRIME1;
+        do {
+            v1 = AK_hash_round(v1, AK_hash_read64(p));
+            v2 = AK_hash_round(v2, AK_hash_read64(p + 8));
+            v3 = AK_hash_round(v3, AK_hash_read64(p + 16));
+            v4 = AK_hash_round(v4, AK_hash_read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+        hash = AK_hash_rotl(v1, 1) + AK_hash_rotl(v2, 7) + AK_hash_rotl(v3, 12) + AK_hash_rotl(v4, 18);
+        hash = AK_hash_merge(hash, v1);
+        hash = AK_hash_merge(hash, v2);
+        hash = AK_hash_merge(hash, v3);
+        hash = AK_hash_merge(hash, v4);
+    } else
+        hash = seed + AK_HASH_PRIME5;
+    hash += (unsigned long long) size;
 
-    int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-    if (adr_to_write == -1)
-        adr_to_write = (int) AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX);
-    if (adr_to_write == 0){
-	AK_EPI;
-        return add;
+    for (; p + 8 <= end; p += 8) {
+        hash ^= AK_hash_round(0, AK_hash_read64(p));
+        hash = AK_hash_rotl(hash, 27) * AK_HASH_PRIME1 + AK_HASH_PRIME4;
+    }
+    if (p + 4 <= end) {
+        hash ^= ((unsigned long long) p[0] | ((unsigned long long) p[1] << 8) | ((unsigned long long) p[2] << 16)
+            | ((unsigned long long) p[3] << 24)) * AK_HASH_PRIME1;
+        hash = AK_hash_rotl(hash, 23) * AK_HASH_PRIME2 + AK_HASH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= *p * AK_HASH_PRIME5;
+        hash = AK_hash_rotl(hash, 11) * AK_HASH_PRIME1;
     }
 
-    AK_block *block = (AK_block*) AK_read_block(adr_to_write);
+    hash ^= hash >> 33;
+    hash *= AK_HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= AK_HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
 
-    AK_dbg_messg(HIGH, INDICES, "insert_bucket_to_block: Position to write (tuple_dict_index) %d\n", adr_to_write);
+unsigned long long AK_hash_key(int num_keys, int *type, int *size, char **data) {
+    unsigned long long hash = 0;
+    const char *value;
+    double number;
+    float single;
+    int k, length;
 
-    switch (type) {
-        case MAIN_BUCKET:
-            size = sizeof (main_bucket);
-            break;
-        case HASH_BUCKET:
-            size = sizeof (hash_bucket);
-            break;
+    //every value seeds the hash of the next one, so the values are not interchangeable
+    for (k = 0; k < num_keys; k++) {
+        value = data[k];
+        length = size[k];
+        if (type[k] == TYPE_VARCHAR)
+            length = strnlen(value, length);
+        else if (type[k] == TYPE_FLOAT && length >= (int) sizeof (float)) {
+            //FLOAT values are compared by the float their first bytes hold
+            memcpy(&single, value, sizeof (float));
+            if (single == 0)
+                single = 0;
+            value = (const char *) &single;
+            length = sizeof (float);
+        } else if (type[k] == TYPE_NUMBER && length == sizeof (double)) {
+            memcpy(&number, value, sizeof (double));
+            if (number == 0)
+                number = 0;
+            value = (const char *) &number;
+        }
+        hash = AK_hash_bytes(value, length, hash);
     }
-    id = block->last_tuple_dict_id + 1;
-    memcpy(&block->data[block->AK_free_space], data, size);
-    block->tuple_dict[id].address = block->AK_free_space;
-    block->AK_free_space += size;
-    block->tuple_dict[id].type = type;
-    block->tuple_dict[id].size = size;
-    block->last_tuple_dict_id = id;
-    AK_write_block(block);
-
-    add->addBlock = adr_to_write;
-    add->indexTd = id;
-    AK_EPI;
-    return add;
+    return hash;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+ * @brief Function that releases a block pinned and latched by the hash index functions
+ * @param mem_block block
  */
-void AK_update_bucket_in_block(struct_add *add, char *data) {
-    AK_PRO;
-    AK_block *block = (AK_block*) AK_read_block(add->addBlock);
-    int address = block->tuple_dict[add->indexTd].address;
-    int size = block->tuple_dict[add->indexTd].size;
-    memcpy(&block->data[address], data, size);
-    AK_write_block(block);
-    AK_EPI;
+static void AK_hash_release(AK_mem_block *mem_block) {
+    AK_unlatch_block(mem_block);
+    AK_unpin_block(mem_block);
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
-  * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+ * @brief Function that reads the list of hash indexes from AK_index. Called while AK_hash_indexes_lock is held.
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = modulo;
-    info->main_bucket_num = main_bucket_num;
-    info->hash_bucket_num = hash_bucket_num;
-
-    memcpy(block->data, info, sizeof (hash_info));
+static void AK_hash_load_indexes() {
+    unsigned long version = AK_catalog_version();
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_index");
+    struct list_node *row, *name, *start, *table_id;
+    AK_mem_block *mem_block;
+    AK_hash_meta *meta;
+    AK_hash_index *index;
+    int address;
+
+    AK_hash_num_indexes = 0;
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL && AK_hash_num_indexes < AK_HASH_MAX_INDEXES) {
+        name = AK_First_L2(row)->next;
+        start = name->next;
+        table_id = start->next->next;
+        //rows of later extents do not name the table
+        if (table_id->type != TYPE_INT || start->type != TYPE_INT)
+            continue;
+        memcpy(&address, start->data, sizeof (int));
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        meta = (AK_hash_meta *) mem_block->block->data;
+        if (meta->magic == AK_HASH_MAGIC) {
+            index = AK_hash_indexes + AK_hash_num_indexes++;
+            strncpy(index->name, name->data, MAX_VARCHAR_LENGTH - 1);
+            index->name[MAX_VARCHAR_LENGTH - 1] = '\0';
+            index->table_id = meta->table_id;
+            index->num_keys = meta->num_keys;
+            memcpy(index->keys, meta->keys, sizeof (index->keys));
+            memcpy(index->types, meta->types, sizeof (index->types));
+            index->meta = address;
+        }
+        AK_hash_release(mem_block);
+    }
+    AK_table_cursor_close(cursor);
+    AK_hash_indexes_version = version;
+}
+
+/**
+ * @brief Function that copies the hash indexes of a table
+ * @param tblName table name
+ * @param indexes buffer of AK_HASH_MAX_INDEXES indexes
+ * @return number of indexes
+ */
+static int AK_hash_table_indexes(char *tblName, AK_hash_index *indexes) {
+    int i, count = 0, table_id;
+
+    pthread_mutex_lock(&AK_hash_indexes_lock);
+    if (AK_hash_num_indexes < 0 || AK_hash_indexes_version != AK_catalog_version())
+        AK_hash_load_indexes();
+    if (AK_hash_num_indexes > 0) {
+        table_id = AK_get_table_obj_id(tblName);
+        for (i = 0; i < AK_hash_num_indexes; i++)
+            if (AK_hash_indexes[i].table_id == table_id)
+                indexes[count++] = AK_hash_indexes[i];
+    }
+    pthread_mutex_unlock(&AK_hash_indexes_lock);
+    return count;
+}
+
+/**
+ * @brief Function that finds the meta block of an index in the list of hash indexes
+ * @param indexName name of the index
+ * @return block address, 0 if the index is not in the list
+ */
+static int AK_hash_meta_address(char *indexName) {
+    int address = 0, i;
+
+    pthread_mutex_lock(&AK_hash_indexes_lock);
+    if (AK_hash_num_indexes < 0 || AK_hash_indexes_version != AK_catalog_version())
+        AK_hash_load_indexes();
+    for (i = 0; i < AK_hash_num_indexes && address == 0; i++)
+        if (strcmp(AK_hash_indexes[i].name, indexName) == 0)
+            address = AK_hash_indexes[i].meta;
+    pthread_mutex_unlock(&AK_hash_indexes_lock);
+    return address;
+}
+
+/**
+ * @brief Function that pins and latches the meta block of a hash index
+ * @param indexName name of the index
+ * @param mode latch mode
+ * @return meta block, NULL if the index does not exist
+ */
+static AK_mem_block *AK_hash_pin_meta(char *indexName, int mode) {
+    table_addresses *addresses;
+    AK_mem_block *mem_block;
+    int address;
+
+    //an index that is being created is not in the list yet
+    if ((address = AK_hash_meta_address(indexName)) == 0) {
+        addresses = AK_get_index_addresses(indexName);
+        address = addresses->address_from[0];
+        AK_free(addresses);
+    }
+    if (address == 0)
+        return NULL;
+    mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, mode);
+    if (((AK_hash_meta *) mem_block->block->data)->magic != AK_HASH_MAGIC) {
+        AK_unlatch_block(mem_block);
+        AK_unpin_block(mem_block);
+        return NULL;
+    }
+    return mem_block;
+}
+
+/**
+ * @brief Function that sets the tuple dictionary of a block holding hash index data, so the block does not look
+ * empty to the functions that read blocks of a segment
+ * @param block block
+ * @param size bytes used
+ */
+static void AK_hash_set_block_size(AK_block *block, int size) {
+    memset(block->tuple_dict, 0, sizeof (block->tuple_dict));
+    block->tuple_dict[0].type = TYPE_INTERNAL;
     block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    AK_write_block(block);
-    AK_EPI;
+    block->tuple_dict[0].size = size;
+    block->AK_free_space = size;
+    block->last_tuple_dict_id = 0;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
-  * @param indexName name of index
-  * @return info bucket with info data for hash index
+ * @brief Function that writes a bucket page into a pinned and exclusively latched block
+ * @param mem_block block
+ * @param entries entries, they may already be in the page
+ * @param count number of entries
+ * @param next next page of the bucket
  */
-hash_info* AK_get_hash_info(char *indexName) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    memset(info, 0, sizeof (hash_info));
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-	AK_EPI;
-        return info;
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    memcpy(info, block->data, sizeof (hash_info));
-    AK_EPI;
-    return info;
+static void AK_hash_write_page(AK_mem_block *mem_block, AK_hash_entry *entries, int count, int next) {
+    AK_hash_page *page = (AK_hash_page *) mem_block->block->data;
+
+    page->count = count;
+    page->next = next;
+    if (count > 0)
+        memmove(page + 1, entries, count * sizeof (AK_hash_entry));
+    AK_hash_set_block_size(mem_block->block, sizeof (AK_hash_page) + count * sizeof (AK_hash_entry));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @brief Function that writes a bucket page into a block
+ * @param address block address
+ * @param entries entries
+ * @param count number of entries
+ * @param next next page of the bucket
+ */
+static void AK_hash_write_new_page(int address, AK_hash_entry *entries, int count, int next) {
+    AK_mem_block *mem_block = AK_pin_block(address);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    AK_hash_write_page(mem_block, entries, count, next);
+    AK_hash_release(mem_block);
+}
+
+/**
+ * @brief Function that computes the bucket of a hash
+ * @param meta meta block
+ * @param hash hash of the key
+ * @return bucket number
+ */
+static int AK_hash_bucket(AK_hash_meta *meta, unsigned int hash) {
+    unsigned int bucket = hash & ((1u << meta->level) - 1);
+
+    if ((int) bucket < meta->split)
+        bucket = hash & ((2u << meta->level) - 1);
+    return bucket;
+}
+
+/**
+ * @brief Function that reads the address of the primary page of a bucket from the directory
+ * @param meta latched meta block
+ * @param bucket bucket number
+ * @return block address
+ */
+static int AK_hash_directory_get(AK_hash_meta *meta, int bucket) {
+    AK_mem_block *mem_block = AK_pin_block(meta->directory[bucket / AK_HASH_DIRECTORY_ENTRIES]);
+    int address;
+
+    AK_latch_block(mem_block, AK_LATCH_SHARED);
+    address = ((int *) mem_block->block->data)[bucket % AK_HASH_DIRECTORY_ENTRIES];
+    AK_hash_release(mem_block);
+    return address;
+}
+
+/**
+ * @brief Function that sets the address of the primary page of a bucket in the directory
+ * @param meta exclusively latched meta block
+ * @param bucket bucket number
+ * @param address block address
+ */
+static void AK_hash_directory_set(AK_hash_meta *meta, int bucket, int address) {
+    AK_mem_block *mem_block = AK_pin_block(meta->directory[bucket / AK_HASH_DIRECTORY_ENTRIES]);
+
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    ((int *) mem_block->block->data)[bucket % AK_HASH_DIRECTORY_ENTRIES] = address;
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    AK_hash_release(mem_block);
+}
+
+/**
+ * @brief Function that makes sure count blocks can be taken from an index segment without adding an extent. Extents
+ * are added here, while the meta block is not latched, because adding one writes AK_index and that reloads the
+ * list of indexes, which latches every meta block. Called while AK_hash_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @param count number of blocks
+ * @return EXIT_SUCCESS, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_hash_reserve(char *indexName, AK_mem_block *meta_block, int count) {
+    AK_hash_meta *meta = (AK_hash_meta *) meta_block->block->data;
+    table_addresses *addresses;
+    int start, i;
+
+    while (meta->num_free + meta->extent_end - meta->next_block < count) {
+        if ((start = AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX)) == EXIT_ERROR)
+            return EXIT_ERROR;
+        addresses = AK_get_index_addresses(indexName);
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+            if (addresses->address_from[i] == start)
+                break;
+        if (i == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[i] == 0
+                || meta->num_free + addresses->address_to[i] - start < count) {
+            AK_free(addresses);
+            return EXIT_ERROR;
+        }
+        //what is left of the previous extent stays unused
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->next_block = start;
+        meta->extent_end = addresses->address_to[i];
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
+        AK_free(addresses);
+    }
+    return EXIT_SUCCESS;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
-  * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+ * @brief Function that takes a block reserved by AK_hash_reserve, a page freed by a split first
+ * @param meta exclusively latched meta block
+ * @return block address
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n) {
-    int i = 0, j = 0, k = 0, counter = 0, end = 0;
+static int AK_hash_take_block(AK_hash_meta *meta) {
+    AK_mem_block *mem_block;
+    int address;
+
+    if (meta->free_page != 0) {
+        address = meta->free_page;
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        meta->free_page = ((AK_hash_page *) mem_block->block->data)->next;
+        AK_hash_release(mem_block);
+        meta->num_free--;
+    } else
+        address = meta->next_block++;
+    meta->num_pages++;
+    return address;
+}
+
+/**
+ * @brief Function that takes a block while an index is built
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @return block address, EXIT_ERROR if the segment cannot grow
+ */
+static int AK_hash_build_block(char *indexName, AK_mem_block *meta_block) {
+    int address;
+
+    if (AK_hash_reserve(indexName, meta_block, 1) == EXIT_ERROR)
+        return EXIT_ERROR;
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    address = AK_hash_take_block((AK_hash_meta *) meta_block->block->data);
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    return address;
+}
+
+int AK_hash_find_index(char *tblName, int *usable, char *indexName, int *keys) {
+    AK_hash_index indexes[AK_HASH_MAX_INDEXES];
+    int count, best = -1, i, k;
+    AK_PRO;
+
+    count = AK_hash_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++) {
+        for (k = 0; k < indexes[i].num_keys && usable[indexes[i].keys[k]]; k++)
+            ;
+        if (k == indexes[i].num_keys && (best < 0 || indexes[i].num_keys > indexes[best].num_keys))
+            best = i;
+    }
+    if (best < 0) {
+        AK_EPI;
+        return EXIT_WARNING;
+    }
+    strcpy(indexName, indexes[best].name);
+    memcpy(keys, indexes[best].keys, indexes[best].num_keys * sizeof (int));
+    AK_EPI;
+    return indexes[best].num_keys;
+}
+
+int AK_get_hash_info(char *indexName, AK_hash_meta *meta) {
+    AK_mem_block *mem_block;
+    AK_PRO;
+
+    if ((mem_block = AK_hash_pin_meta(indexName, AK_LATCH_SHARED)) == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memcpy(meta, mem_block->block->data, sizeof (AK_hash_meta));
+    AK_hash_release(mem_block);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+int AK_hash_probe(char *indexName, int *type, int *size, char **data, struct_add **rows) {
+    AK_mem_block *meta_block, *mem_block;
+    AK_hash_meta *meta;
+    AK_hash_page *page;
+    AK_hash_entry *entries;
+    unsigned int hash;
+    int capacity = 16, count = 0, address, i;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 301;
-    add->indexTd = 2;
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    while (addresses->address_from[i]) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                if (temp->tuple_dict[k].type == MAIN_BUCKET) {
-                    if (n == counter) {
-                        add->addBlock = j;
-                        add->indexTd = k;
-                        end = 1;
-                        break;
-                    }
-                    counter++;
-                }
+
+    *rows = NULL;
+    if ((meta_block = AK_hash_pin_meta(indexName, AK_LATCH_SHARED)) == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    meta = (AK_hash_meta *) meta_block->block->data;
+    if (!meta->built) {
+        AK_hash_release(meta_block);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    hash = (unsigned int) AK_hash_key(meta->num_keys, type, size, data);
+
+    //the meta block stays latched, so no split moves the entries while the bucket is read
+    *rows = (struct_add *) AK_malloc(capacity * sizeof (struct_add));
+    address = AK_hash_directory_get(meta, AK_hash_bucket(meta, hash));
+    while (address != 0) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        page = (AK_hash_page *) mem_block->block->data;
+        entries = (AK_hash_entry *) (page + 1);
+        for (i = 0; i < page->count; i++) {
+            if (entries[i].hash != hash)
+                continue;
+            if (count == capacity) {
+                capacity *= 2;
+                *rows = (struct_add *) AK_realloc(*rows, capacity * sizeof (struct_add));
             }
-            if (end) break;
+            (*rows)[count++] = entries[i].row;
         }
-        i++;
+        address = page->next;
+        AK_hash_release(mem_block);
     }
+    AK_hash_release(meta_block);
     AK_EPI;
-    return add;
-    AK_free(add);
+    return count;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+ * @brief Function that pins the meta block of a built index for a change. Called while AK_hash_write_lock is held.
+ * @param indexName name of the index
+ * @return meta block, pinned but not latched; NULL if the index does not exist or is being built
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
-    int i, address, size, hash_AK_free_space = 0;
-    AK_PRO;
-    struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-    hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0)
-        printf("Hash index does not exist!\n");
-    else {
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        if (info->main_bucket_num == 0) {
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                temp_main_bucket->element[i].value = i;
-                memset(&temp_main_bucket->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            main_add = AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
+static AK_mem_block *AK_hash_pin_built(char *indexName) {
+    AK_mem_block *meta_block = AK_hash_pin_meta(indexName, AK_LATCH_SHARED);
 
-            temp_hash_bucket->bucket_level = MAIN_BUCKET_SIZE;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket->element[i].value = -1;
-            }
-            memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
+    if (meta_block == NULL)
+        return NULL;
+    AK_unlatch_block(meta_block);
+    if (!((AK_hash_meta *) meta_block->block->data)->built) {
+        AK_unpin_block(meta_block);
+        return NULL;
+    }
+    return meta_block;
+}
 
-                memcpy(&temp_main_bucket->element[i].add, hash_add, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-            AK_change_hash_info(indexName, MAIN_BUCKET_SIZE, 1, MAIN_BUCKET_SIZE);
+/**
+ * @brief Function that splits the next bucket in line. Its entries are divided between it and the new bucket
+ * 2^level + split by one more bit of the hash; pages the bucket no longer needs are put on the free list.
+ * Called while AK_hash_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ */
+static void AK_hash_split(char *indexName, AK_mem_block *meta_block) {
+    AK_hash_meta *meta = (AK_hash_meta *) meta_block->block->data;
+    AK_hash_entry *entries, *moved;
+    AK_mem_block *mem_block;
+    AK_hash_page *page;
+    int *pages, capacity = 4, num_pages = 0, count = 0, num_stay = 0, num_move = 0, bucket, address, next, mask, i, p;
+
+    bucket = (1 << meta->level) + meta->split;
+    if (bucket >= AK_HASH_MAX_DIRECTORY * AK_HASH_DIRECTORY_ENTRIES)
+        return;
+
+    //only writers change the bucket, so it is read before the meta block is latched
+    pages = (int *) AK_malloc(capacity * sizeof (int));
+    entries = (AK_hash_entry *) AK_malloc(capacity * AK_HASH_PAGE_ENTRIES * sizeof (AK_hash_entry));
+    address = AK_hash_directory_get(meta, meta->split);
+    while (address != 0) {
+        if (num_pages == capacity) {
+            capacity *= 2;
+            pages = (int *) AK_realloc(pages, capacity * sizeof (int));
+            entries = (AK_hash_entry *) AK_realloc(entries, capacity * AK_HASH_PAGE_ENTRIES * sizeof (AK_hash_entry));
         }
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == -1) {
-                hash_AK_free_space = 1;
-                temp_hash_bucket->element[i].value = hashValue;
-                memcpy(&temp_hash_bucket->element[i].add, add, sizeof (struct_add));
-                memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-                AK_update_bucket_in_block(hash_add, data);
+        pages[num_pages++] = address;
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        page = (AK_hash_page *) mem_block->block->data;
+        memcpy(entries + count, page + 1, page->count * sizeof (AK_hash_entry));
+        count += page->count;
+        address = page->next;
+        AK_hash_release(mem_block);
+    }
+
+    //the new bucket needs at most as many pages as the split one has, and a directory block may be added
+    if (num_pages == 0 || AK_hash_reserve(indexName, meta_block, num_pages + 1) == EXIT_ERROR) {
+        AK_free(pages);
+        AK_free(entries);
+        return;
+    }
+
+    mask = (2u << meta->level) - 1;
+    moved = (AK_hash_entry *) AK_malloc((count + 1) * sizeof (AK_hash_entry));
+    for (i = 0; i < count; i++) {
+        if ((int) (entries[i].hash & mask) == meta->split)
+            entries[num_stay++] = entries[i];
+        else
+            moved[num_move++] = entries[i];
+    }
+
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    if (bucket % AK_HASH_DIRECTORY_ENTRIES == 0) {
+        address = AK_hash_take_block(meta);
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        memset(mem_block->block->data, 0, AK_HASH_PAGE_SIZE);
+        AK_hash_set_block_size(mem_block->block, AK_HASH_PAGE_SIZE);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        AK_hash_release(mem_block);
+        meta->directory[meta->num_directory++] = address;
+    }
+
+    //the split bucket keeps its first pages, the rest go to the free list
+    for (p = 0; p < num_pages; p++) {
+        i = p * AK_HASH_PAGE_ENTRIES;
+        if (p == 0 || i < num_stay) {
+            next = (p + 1 < num_pages && i + AK_HASH_PAGE_ENTRIES < num_stay) ? pages[p + 1] : 0;
+            AK_hash_write_new_page(pages[p], entries + i, (num_stay - i < AK_HASH_PAGE_ENTRIES) ? num_stay - i
+                : AK_HASH_PAGE_ENTRIES, next);
+        } else {
+            AK_hash_write_new_page(pages[p], NULL, 0, meta->free_page);
+            meta->free_page = pages[p];
+            meta->num_free++;
+            meta->num_pages--;
+        }
+    }
+
+    address = AK_hash_take_block(meta);
+    AK_hash_directory_set(meta, bucket, address);
+    for (i = 0; i == 0 || i < num_move; i += AK_HASH_PAGE_ENTRIES) {
+        next = (i + AK_HASH_PAGE_ENTRIES < num_move) ? AK_hash_take_block(meta) : 0;
+        AK_hash_write_new_page(address, moved + i, (num_move - i < AK_HASH_PAGE_ENTRIES) ? num_move - i
+            : AK_HASH_PAGE_ENTRIES, next);
+        address = next;
+    }
+
+    meta->split++;
+    if (meta->split == 1 << meta->level) {
+        meta->level++;
+        meta->split = 0;
+    }
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+
+    AK_free(pages);
+    AK_free(entries);
+    AK_free(moved);
+}
+
+/**
+ * @brief Function that adds an entry to the last page of its bucket with room for it, a new overflow page when all
+ * pages are full. Called while AK_hash_write_lock is held.
+ * @param indexName name of the index
+ * @param meta_block pinned meta block, not latched
+ * @param entry entry
+ * @return EXIT_SUCCESS, EXIT_WARNING if the entry is already in the index, EXIT_ERROR if no page could be added
+ */
+static int AK_hash_insert_entry(char *indexName, AK_mem_block *meta_block, AK_hash_entry *entry) {
+    AK_hash_meta *meta = (AK_hash_meta *) meta_block->block->data;
+    AK_mem_block *mem_block;
+    AK_hash_page *page;
+    AK_hash_entry *entries;
+    int address, last = 0, target = 0, full, i;
+
+    if (AK_hash_reserve(indexName, meta_block, 1) == EXIT_ERROR)
+        return EXIT_ERROR;
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    address = AK_hash_directory_get(meta, AK_hash_bucket(meta, entry->hash));
+    while (address != 0) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        page = (AK_hash_page *) mem_block->block->data;
+        entries = (AK_hash_entry *) (page + 1);
+        for (i = 0; i < page->count; i++)
+            if (entries[i].hash == entry->hash && entries[i].row.addBlock == entry->row.addBlock
+                    && entries[i].row.indexTd == entry->row.indexTd)
                 break;
-            }
+        if (i < page->count) {
+            AK_hash_release(mem_block);
+            AK_unlatch_block(meta_block);
+            return EXIT_WARNING;
         }
-        if (hash_AK_free_space == 0) {
-
-            if (temp_hash_bucket->bucket_level == info->modulo) {
-                //adding new main buckets
-                for (i = 0; i < info->main_bucket_num; i++) {
-                    main_add = AK_get_nth_main_bucket_add(indexName, i);
-                    AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-                    address = temp_block->tuple_dict[main_add->indexTd].address;
-                    size = temp_block->tuple_dict[main_add->indexTd].size;
-                    memcpy(data, &temp_block->data[address], size);
-                    AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
-                }
-                AK_change_hash_info(indexName, info->modulo * 2, info->main_bucket_num * 2, info->hash_bucket_num);
-                info = AK_get_hash_info(indexName);
-            }
-            int hash_bucket_id2 = (hash_bucket_id + info->modulo / 2) % info->modulo;
-            int main_bucket_id2 = (int) (hash_bucket_id2 / MAIN_BUCKET_SIZE);
-
-            //swapping hash bucket id's
-            if (hash_bucket_id2 < hash_bucket_id) {
-                int temp = hash_bucket_id;
-                hash_bucket_id = hash_bucket_id2;
-                hash_bucket_id2 = temp;
-                temp = main_bucket_id;
-                main_bucket_id = main_bucket_id2;
-                main_bucket_id2 = temp;
-            }
+        if (page->count < AK_HASH_PAGE_ENTRIES)
+            target = address;
+        last = address;
+        address = page->next;
+        AK_hash_release(mem_block);
+    }
 
-            hash_bucket *temp_hash_bucket2 = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-            temp_hash_bucket2->bucket_level = temp_hash_bucket->bucket_level * 2;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket2->element[i].value = -1;
-                memset(&temp_hash_bucket2->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(data, temp_hash_bucket2, sizeof (hash_bucket));
-            AK_update_bucket_in_block(hash_add, data);
-
-            main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id2);
-            temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-            address = temp_block->tuple_dict[main_add->indexTd].address;
-            size = temp_block->tuple_dict[main_add->indexTd].size;
-            memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-            hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-            memcpy(&temp_main_bucket->element[hash_bucket_id2 % MAIN_BUCKET_SIZE].add, hash_add, sizeof (struct_add));
-            memcpy(data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-
-            AK_change_hash_info(indexName, info->modulo, info->main_bucket_num, info->hash_bucket_num + 1);
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                int value = temp_hash_bucket->element[i].value;
-                memcpy(main_add, &temp_hash_bucket->element[i].add, sizeof (struct_add));
-                AK_insert_in_hash_index(indexName, value, main_add);
+    if (target == 0) {
+        target = AK_hash_take_block(meta);
+        AK_hash_write_new_page(target, NULL, 0, 0);
+        mem_block = AK_pin_block(last);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        ((AK_hash_page *) mem_block->block->data)->next = target;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        AK_hash_release(mem_block);
+    }
+    mem_block = AK_pin_block(target);
+    AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+    page = (AK_hash_page *) mem_block->block->data;
+    ((AK_hash_entry *) (page + 1))[page->count] = *entry;
+    AK_hash_write_page(mem_block, (AK_hash_entry *) (page + 1), page->count + 1, page->next);
+    AK_hash_release(mem_block);
+
+    meta->num_entries++;
+    full = (long long) meta->num_entries * 100 > (long long) ((1 << meta->level) + meta->split) * AK_HASH_PAGE_ENTRIES * AK_HASH_FILL;
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+
+    if (full)
+        AK_hash_split(indexName, meta_block);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that inserts an entry whose hash is already known into a hash index
+ * @param indexName name of the index
+ * @param entry entry
+ * @return EXIT_SUCCESS, EXIT_WARNING if the entry is already in the index, EXIT_ERROR otherwise
+ */
+static int AK_hash_insert_hash(char *indexName, AK_hash_entry *entry) {
+    AK_mem_block *meta_block;
+    int result = EXIT_ERROR;
+
+    pthread_mutex_lock(&AK_hash_write_lock);
+    if ((meta_block = AK_hash_pin_built(indexName)) != NULL) {
+        result = AK_hash_insert_entry(indexName, meta_block, entry);
+        AK_unpin_block(meta_block);
+    }
+    pthread_mutex_unlock(&AK_hash_write_lock);
+    if (result == EXIT_ERROR)
+        printf("AK_hash_insert: ERROR. Cannot insert into index %s.\n", indexName);
+    return result;
+}
+
+int AK_hash_insert(char *indexName, int *type, int *size, char **data, struct_add *row) {
+    AK_hash_meta *meta;
+    AK_mem_block *meta_block;
+    AK_hash_entry entry;
+    int result;
+    AK_PRO;
+
+    if ((meta_block = AK_hash_pin_meta(indexName, AK_LATCH_SHARED)) == NULL) {
+        printf("AK_hash_insert: ERROR. Index %s does not exist.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    meta = (AK_hash_meta *) meta_block->block->data;
+    entry.hash = (unsigned int) AK_hash_key(meta->num_keys, type, size, data);
+    AK_hash_release(meta_block);
+    entry.row = *row;
+    result = AK_hash_insert_hash(indexName, &entry);
+    AK_EPI;
+    return result;
+}
+
+int AK_hash_delete_entry(char *indexName, int *type, int *size, char **data, struct_add *row) {
+    AK_mem_block *meta_block, *mem_block;
+    AK_hash_meta *meta;
+    AK_hash_page *page;
+    AK_hash_entry *entries;
+    unsigned int hash;
+    int address, i, result = EXIT_WARNING;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_hash_write_lock);
+    if ((meta_block = AK_hash_pin_built(indexName)) == NULL) {
+        pthread_mutex_unlock(&AK_hash_write_lock);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    meta = (AK_hash_meta *) meta_block->block->data;
+    hash = (unsigned int) AK_hash_key(meta->num_keys, type, size, data);
+
+    //buckets are never merged, so only the page of the entry changes
+    address = AK_hash_directory_get(meta, AK_hash_bucket(meta, hash));
+    while (address != 0 && result != EXIT_SUCCESS) {
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        page = (AK_hash_page *) mem_block->block->data;
+        entries = (AK_hash_entry *) (page + 1);
+        for (i = 0; i < page->count; i++) {
+            if (entries[i].hash == hash && entries[i].row.addBlock == row->addBlock && entries[i].row.indexTd == row->indexTd) {
+                entries[i] = entries[page->count - 1];
+                AK_hash_write_page(mem_block, entries, page->count - 1, page->next);
+                result = EXIT_SUCCESS;
+                break;
             }
-            AK_insert_in_hash_index(indexName, hashValue, add);
         }
+        address = page->next;
+        AK_hash_release(mem_block);
+    }
+
+    if (result == EXIT_SUCCESS) {
+        AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+        meta->num_entries--;
+        AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+        AK_unlatch_block(meta_block);
     }
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_hash_write_lock);
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+ * @brief Function that builds a hash index out of the rows of its table. The number of buckets is the smallest power
+ * of two that keeps them AK_HASH_FILL percent full, the entries are sorted by bucket and written bucket by bucket.
+ * Called while AK_hash_write_lock is held.
+ * @param indexName name of the index
+ * @param tblName table name
+ * @param meta_block pinned meta block, not latched
+ * @return number of entries, EXIT_ERROR if a block could not be taken
  */
-//Error: expected a ')'
-struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete) {
+static int AK_hash_build(char *indexName, char *tblName, AK_mem_block *meta_block) {
+    AK_hash_meta *meta = (AK_hash_meta *) meta_block->block->data;
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *row, *el, *values[MAX_ATTRIBUTES];
+    AK_hash_entry *entries, *sorted;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int *ends, *primary, capacity = 1024, count = 0, level = 0, num_directory, buckets, address, next, from, b, i, k;
+    AK_mem_block *mem_block;
+
+    entries = (AK_hash_entry *) AK_malloc(capacity * sizeof (AK_hash_entry));
+    while (cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL) {
+        for (el = AK_First_L2(row), i = 0; el != NULL && i < MAX_ATTRIBUTES; el = el->next, i++)
+            values[i] = el;
+        for (k = 0; k < meta->num_keys && meta->keys[k] < i && values[meta->keys[k]]->type == meta->types[k]; k++) {
+            type[k] = values[meta->keys[k]]->type;
+            size[k] = values[meta->keys[k]]->size;
+            data[k] = values[meta->keys[k]]->data;
+        }
+        if (k < meta->num_keys)
+            continue;
+        if (count == capacity) {
+            capacity *= 2;
+            entries = (AK_hash_entry *) AK_realloc(entries, capacity * sizeof (AK_hash_entry));
+        }
+        entries[count].hash = (unsigned int) AK_hash_key(meta->num_keys, type, size, data);
+        entries[count].row.addBlock = cursor->block;
+        entries[count].row.indexTd = cursor->tuple - cursor->num_attr;
+        count++;
+    }
+    AK_table_cursor_close(cursor);
+
+    while ((long long) (1 << level) * AK_HASH_PAGE_ENTRIES * AK_HASH_FILL < (long long) count * 100
+            && (2 << level) <= AK_HASH_MAX_DIRECTORY * AK_HASH_DIRECTORY_ENTRIES)
+        level++;
+    buckets = 1 << level;
+
+    //counting sort by bucket, ends[b] is where the entries of bucket b end
+    ends = (int *) AK_calloc(buckets, sizeof (int));
+    for (i = 0; i < count; i++)
+        ends[entries[i].hash & (buckets - 1)]++;
+    for (b = 1; b < buckets; b++)
+        ends[b] += ends[b - 1];
+    sorted = (AK_hash_entry *) AK_malloc((count + 1) * sizeof (AK_hash_entry));
+    for (i = count - 1; i >= 0; i--)
+        sorted[--ends[entries[i].hash & (buckets - 1)]] = entries[i];
+    for (b = 0; b < buckets; b++)
+        ends[b] = (b + 1 < buckets) ? ends[b + 1] : count;
+    AK_free(entries);
+
+    num_directory = (buckets + AK_HASH_DIRECTORY_ENTRIES - 1) / AK_HASH_DIRECTORY_ENTRIES;
+    primary = (int *) AK_calloc(num_directory * AK_HASH_DIRECTORY_ENTRIES, sizeof (int));
+    for (b = 0, from = 0; b < buckets; from = ends[b++]) {
+        if ((address = AK_hash_build_block(indexName, meta_block)) == EXIT_ERROR)
+            break;
+        primary[b] = address;
+        for (i = from; i == from || i < ends[b]; i += AK_HASH_PAGE_ENTRIES) {
+            next = 0;
+            if (i + AK_HASH_PAGE_ENTRIES < ends[b] && (next = AK_hash_build_block(indexName, meta_block)) == EXIT_ERROR)
+                break;
+            AK_hash_write_new_page(address, sorted + i, (ends[b] - i < AK_HASH_PAGE_ENTRIES) ? ends[b] - i
+                : AK_HASH_PAGE_ENTRIES, next);
+            address = next;
+        }
+        if (next == EXIT_ERROR)
+            break;
+    }
+    AK_free(sorted);
+    AK_free(ends);
+    if (b < buckets) {
+        AK_free(primary);
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < num_directory; i++) {
+        if ((address = AK_hash_build_block(indexName, meta_block)) == EXIT_ERROR) {
+            AK_free(primary);
+            return EXIT_ERROR;
+        }
+        mem_block = AK_pin_block(address);
+        AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+        memcpy(mem_block->block->data, primary + i * AK_HASH_DIRECTORY_ENTRIES, AK_HASH_DIRECTORY_ENTRIES * sizeof (int));
+        AK_hash_set_block_size(mem_block->block, AK_HASH_PAGE_SIZE);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        AK_hash_release(mem_block);
+        meta->directory[i] = address;
+    }
+    AK_free(primary);
+
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    meta->level = level;
+    meta->split = 0;
+    meta->num_entries = count;
+    meta->num_directory = num_directory;
+    meta->built = 1;
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    return count;
+}
+
+int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
+    struct list_node *attribute = (attributes != NULL) ? (struct list_node *) AK_First_L2(attributes) : NULL;
+    AK_header *t_header, i_header[MAX_ATTRIBUTES], *temp;
+    table_addresses *addresses;
+    AK_mem_block *meta_block;
+    AK_hash_meta *meta;
+    int keys[MAX_ATTRIBUTES], types[MAX_ATTRIBUTES], num_keys = 0, num_attr, table_id, start, count, i;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    memset(add, 0, sizeof (struct_add));
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0) {
-        printf("Hash index does not exist!\n");
+
+    num_attr = AK_num_attr(tblName);
+    if (attribute == NULL || num_attr <= 0 || (t_header = AK_get_header(tblName)) == NULL) {
+        printf("AK_create_hash_index: ERROR. Table %s does not exist.\n", tblName);
         AK_EPI;
-        return add;
-    } else {
-        int hashValue = 0, address, size, i, j, k, found, match;
-        struct list_node *temp_elem;
-        temp_elem = AK_First_L2(values);
-        while (temp_elem) {
-            hashValue += AK_elem_hash_value(temp_elem);
-            temp_elem = AK_Next_L2(temp_elem);
+        return EXIT_ERROR;
+    }
+    memset(i_header, 0, sizeof (i_header));
+    for (; attribute != NULL; attribute = attribute->next) {
+        for (i = 0; i < num_attr && strcmp(t_header[i].att_name, attribute->data) != 0; i++)
+            ;
+        if (i == num_attr || num_keys == MAX_ATTRIBUTES) {
+            printf("AK_create_hash_index: ERROR. Attribute %s does not exist in table %s.\n", attribute->data, tblName);
+            AK_free(t_header);
+            AK_EPI;
+            return EXIT_ERROR;
         }
-        struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-        hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == hashValue) {
-                AK_block *temp_table_block = (AK_block*) AK_read_block(temp_hash_bucket->element[i].add.addBlock);
-                j = 0;
-                while (strcmp(temp_block->header[j].att_name, "\0")) {
-                    k = 0;
-                    found = 0;
-                    while (strcmp(temp_table_block->header[k].att_name, "\0")) {
-                        if (strcmp(temp_block->header[j].att_name, temp_table_block->header[k].att_name) == 0) {
-                            found = 1;
-                            match = 0;
-                            int indexTd = temp_hash_bucket->element[i].add.indexTd + k;
-                            int record_address = temp_table_block->tuple_dict[indexTd].address;
-                            int record_size = temp_table_block->tuple_dict[indexTd].size;
-                            int record_type = temp_table_block->tuple_dict[indexTd].type;
-                            memcpy(data, &temp_table_block->data[record_address], record_size);
-                            temp_elem = (struct list_node *)AK_First_L2(values);
-                            while (temp_elem) {
-                                if (temp_elem->type == record_type && memcmp(data, &temp_elem->data, record_size) == 0)
-                                    match = 1;
-                                temp_elem = temp_elem->next;
-                            }
-                            break;
-                        }
-                        k++;
-                    }
-                    if (found == 0 || match == 0) break;
-                    j++;
-                }
-                if (match) {
-                    int addBlock = temp_hash_bucket->element[i].add.addBlock;
-                    int indexTd = temp_hash_bucket->element[i].add.indexTd;
-                    //Error: expected an expression
-                    if (delete==1) {
-                        temp_hash_bucket->element[i].value = -1;
-                        memcpy(data, temp_hash_bucket, sizeof (hash_bucket));
-                        AK_update_bucket_in_block(hash_add, data);
-                    } else
-                        AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", addBlock, indexTd);
-                    add->addBlock = addBlock;
-                    add->indexTd = indexTd;
-                    break;
-                }
-            }
+        if (t_header[i].type != TYPE_INT && t_header[i].type != TYPE_FLOAT && t_header[i].type != TYPE_NUMBER
+                && t_header[i].type != TYPE_VARCHAR && t_header[i].type != TYPE_DATE && t_header[i].type != TYPE_DATETIME
+                && t_header[i].type != TYPE_TIME) {
+            printf("AK_create_hash_index: ERROR. Attributes of type %d cannot be indexed.\n", t_header[i].type);
+            AK_free(t_header);
+            AK_EPI;
+            return EXIT_ERROR;
         }
+        keys[num_keys] = i;
+        types[num_keys] = t_header[i].type;
+        temp = (AK_header *) AK_create_header(t_header[i].att_name, t_header[i].type, FREE_INT, FREE_CHAR, FREE_CHAR);
+        memcpy(i_header + num_keys, temp, sizeof (AK_header));
+        AK_free(temp);
+        num_keys++;
     }
+    AK_free(t_header);
+    addresses = AK_get_index_addresses(indexName);
+    start = addresses->address_from[0];
+    AK_free(addresses);
+    if (start != 0) {
+        printf("AK_create_hash_index: ERROR. Index %s already exists.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    table_id = AK_get_table_obj_id(tblName);
+    pthread_mutex_lock(&AK_hash_write_lock);
+    if ((start = AK_initialize_new_index_segment(indexName, table_id, keys[0], i_header)) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_hash_write_lock);
+        printf("AK_create_hash_index: ERROR. Cannot create the segment of index %s.\n", indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = AK_get_index_addresses(indexName);
+
+    //the meta block is the first block of the segment, lookups fail until the build is done
+    meta_block = AK_pin_block(start);
+    AK_latch_block(meta_block, AK_LATCH_EXCLUSIVE);
+    memset(meta_block->block->data, 0, sizeof (AK_hash_meta));
+    meta = (AK_hash_meta *) meta_block->block->data;
+    meta->magic = AK_HASH_MAGIC;
+    meta->table_id = table_id;
+    meta->num_keys = num_keys;
+    memcpy(meta->keys, keys, num_keys * sizeof (int));
+    memcpy(meta->types, types, num_keys * sizeof (int));
+    meta->next_block = start + 1;
+    meta->extent_end = addresses->address_to[0];
+    AK_hash_set_block_size(meta_block->block, sizeof (AK_hash_meta));
+    AK_mem_block_modify(meta_block, BLOCK_DIRTY);
+    AK_unlatch_block(meta_block);
+    AK_free(addresses);
+
+    count = AK_hash_build(indexName, tblName, meta_block);
+    AK_unpin_block(meta_block);
+    pthread_mutex_unlock(&AK_hash_write_lock);
+
+    if (count == EXIT_ERROR) {
+        printf("AK_create_hash_index: ERROR. Cannot build index %s.\n", indexName);
+        AK_delete_hash_index(indexName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_dbg_messg(HIGH, INDICES, "AK_create_hash_index: index %s on %s has %d entries\n", indexName, tblName, count);
     AK_EPI;
-    return add;
+    return EXIT_SUCCESS;
 }
 
-/**
-  * @author Mislav Čakarić
-  * @brief Function that fetches a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return address structure with data where the record is in table
- 
- */
-struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values) {
+int AK_delete_hash_index(char *indexName) {
+    int result;
     AK_PRO;
-    struct_add* ret = AK_find_delete_in_hash_index(indexName, values, FIND);
+    pthread_mutex_lock(&AK_hash_write_lock);
+    result = AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
+    pthread_mutex_unlock(&AK_hash_write_lock);
     AK_EPI;
-    return ret;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that deletes a record from the hash index
-  * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return No return value
- 
+ * @brief Function that checks whether a row holds a key, the values have to be of the same type, size and bytes
+ * @param row row address
+ * @param num_keys number of key attributes
+ * @param keys indexes of the key attributes
+ * @param type types of the key values
+ * @param size sizes of the key values
+ * @param data key values
+ * @return 1 if the row holds the key, 0 otherwise
  */
-void AK_delete_in_hash_index(char *indexName, struct list_node *values) {
-    AK_PRO;
-    AK_find_delete_in_hash_index(indexName, values, DELETE);
-    AK_EPI;
+static int AK_hash_row_matches(struct_add *row, int num_keys, int *keys, int *type, int *size, char **data) {
+    AK_mem_block *mem_block;
+    AK_block *block;
+    int matches = 1, tuple, length, k;
+
+    if (row->indexTd < 0 || row->addBlock <= 0)
+        return 0;
+    mem_block = AK_pin_block(row->addBlock);
+    AK_latch_block(mem_block, AK_LATCH_SHARED);
+    block = mem_block->block;
+    for (k = 0; k < num_keys && matches; k++) {
+        tuple = row->indexTd + keys[k];
+        length = (type[k] == TYPE_VARCHAR) ? (int) strnlen(data[k], size[k]) : size[k];
+        matches = tuple < DATA_BLOCK_SIZE && block->tuple_dict[tuple].type == type[k] && block->tuple_dict[tuple].size == length
+            && memcmp(block->data + block->tuple_dict[tuple].address, data[k], length) == 0;
+    }
+    AK_hash_release(mem_block);
+    return matches;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
-  * @param indexName name of index
-  * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
+ * @brief Function that finds the row of a list of key values in a hash index
+ * @param indexName name of index
+ * @param values list of the key values in key order
+ * @param row set to the address of the first row found
+ * @param type set to the types of the key values
+ * @param size set to the sizes of the key values
+ * @param data set to the key values
+ * @return EXIT_SUCCESS, EXIT_WARNING if no row holds the key, EXIT_ERROR if the index does not exist
  */
-int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
-    int i, j, k, l, n, exist, hashValue;
-    AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    int num_attr = AK_num_attr(tblName);
-    AK_header *table_header = (AK_header *)AK_get_header(tblName);
-
-    AK_header i_header[ MAX_ATTRIBUTES ];
-    AK_header* temp;
-
-    struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-    n = 0;
-    while (attribute != 0) {
-        exist = 0;
-        for (i = 0; i < num_attr; i++) {
-            if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-				AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-                exist = 1;
-                temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-                memcpy(i_header + n, temp, sizeof ( AK_header));
-                n++;
-                if ((table_header + 1)->type != TYPE_VARCHAR && (table_header + 1)->type != TYPE_INT) {
-                    printf("Unsupported data type for hash index! Only int and varchar!");
-                    AK_EPI;
-                    return EXIT_ERROR;
-                }
-            }
-        }
-        if (!exist) {
-            printf("Atribut %s ne postoji u tablici", attribute->data);
-            AK_EPI;
-            return EXIT_ERROR;
+static int AK_hash_find_row(char *indexName, struct list_node *values, struct_add *row, int *type, int *size, char **data) {
+    struct list_node *value = (struct list_node *) AK_First_L2(values);
+    struct_add *rows;
+    AK_hash_meta meta;
+    int result = EXIT_WARNING, count, i, k;
+
+    if (AK_get_hash_info(indexName, &meta) == EXIT_ERROR)
+        return EXIT_ERROR;
+    for (k = 0; k < meta.num_keys && value != NULL; k++, value = value->next) {
+        type[k] = value->type;
+        size[k] = value->size;
+        data[k] = value->data;
+    }
+    if (k < meta.num_keys || (count = AK_hash_probe(indexName, type, size, data, &rows)) == EXIT_ERROR)
+        return EXIT_ERROR;
+    for (i = 0; i < count && result != EXIT_SUCCESS; i++) {
+        if (AK_hash_row_matches(rows + i, meta.num_keys, meta.keys, type, size, data)) {
+            *row = rows[i];
+            result = EXIT_SUCCESS;
         }
-        attribute = attribute->next;
     }
-    memset(i_header + n, 0, MAX_ATTRIBUTES - n);
+    AK_free(rows);
+    return result;
+}
 
-    int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-    if (startAddress != EXIT_ERROR)
-        printf("\nINDEX %s CREATED!\n", indexName);
+struct_add *AK_find_in_hash_index(char *indexName, struct list_node *values) {
+    struct_add *add = (struct_add *) AK_malloc(sizeof (struct_add));
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    AK_PRO;
 
-    AK_block *block = (AK_block*) AK_read_block(startAddress);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = 4;
-    info->main_bucket_num = 0;
-    info->hash_bucket_num = 0;
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    block->AK_free_space += sizeof (hash_info);
-    block->last_tuple_dict_id = 0;
-    AK_write_block(block);
+    if (AK_hash_find_row(indexName, values, add, type, size, data) != EXIT_SUCCESS) {
+        add->addBlock = 0;
+        add->indexTd = 0;
+    }
+    AK_EPI;
+    return add;
+}
+
+void AK_delete_in_hash_index(char *indexName, struct list_node *values) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    struct_add row;
+    AK_PRO;
 
-    struct list_node *temp_elem;
+    if (AK_hash_find_row(indexName, values, &row, type, size, data) == EXIT_SUCCESS)
+        AK_hash_delete_entry(indexName, type, size, data, &row);
+    AK_EPI;
+}
 
-    char data[ MAX_VARCHAR_LENGTH ];
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&row);
-    i = 0;
-    n = 0;
-    while (addresses->address_from[ i ]) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                n++;
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                for (l = 0; l < num_attr; l++) {
-                    int type = temp->tuple_dict[ k + l ].type;
-                    int size = temp->tuple_dict[ k + l ].size;
-                    int address = temp->tuple_dict[ k + l ].address;
-                    memcpy(data, &(temp->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row);
-                }
-                /* *************** */
-                hashValue = 0;
-                attribute = (struct list_node *) AK_First_L2(attributes);
-                while (attribute) {
-
-                    for (l = 0; l < num_attr; l++) {
-                        if (strcmp((table_header + l)->att_name, attribute->data) == 0)
-                            break;
-                    }
-                    temp_elem = AK_GetNth_L2(l, row);
-                    hashValue += AK_elem_hash_value(temp_elem);
-
-                    attribute = attribute->next;
-                }
-                AK_dbg_messg(HIGH, INDICES, "Insert in hash index %d. record\n", n);
-                struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-                add->addBlock = j;
-                add->indexTd = k;
-                AK_insert_in_hash_index(indexName, hashValue, add);
-                AK_DeleteAll_L3(&row);
-                /* *************** */
-            }
+void AK_hash_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple) {
+    AK_hash_index indexes[AK_HASH_MAX_INDEXES];
+    AK_hash_entry entries[AK_HASH_MAX_INDEXES];
+    int key_type[MAX_ATTRIBUTES], key_size[MAX_ATTRIBUTES], valid[AK_HASH_MAX_INDEXES], count, attribute, i, k;
+    char *key_data[MAX_ATTRIBUTES];
+    AK_PRO;
+
+    //the keys are hashed before any index is changed, the values may point into a cached block
+    count = AK_hash_table_indexes(tblName, indexes);
+    for (i = 0; i < count; i++) {
+        for (k = 0; k < indexes[i].num_keys; k++) {
+            attribute = indexes[i].keys[k];
+            if (attribute >= MAX_ATTRIBUTES || type[attribute] != indexes[i].types[k])
+                break;
+            key_type[k] = type[attribute];
+            key_size[k] = size[attribute];
+            key_data[k] = data[attribute];
         }
-        i++;
+        valid[i] = (k == indexes[i].num_keys);
+        entries[i].hash = valid[i] ? (unsigned int) AK_hash_key(k, key_type, key_size, key_data) : 0;
+        entries[i].row.addBlock = block;
+        entries[i].row.indexTd = tuple;
     }
+    for (i = 0; i < count; i++)
+        if (valid[i])
+            AK_hash_insert_hash(indexes[i].name, entries + i);
     AK_EPI;
-    return EXIT_SUCCESS;
 }
 
-void AK_delete_hash_index(char *indexName) {
+void AK_hash_index_tuple(char *tblName, AK_block *block, int tuple) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], i;
+    char *data[MAX_ATTRIBUTES];
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        if (block->header[i].att_name[0] != '\0' && tuple + i < DATA_BLOCK_SIZE) {
+            type[i] = AK_tuple_type(block, tuple + i);
+            size[i] = AK_tuple_size(block, tuple + i);
+            data[i] = (char *) AK_tuple_data(block, tuple + i);
+        } else {
+            type[i] = FREE_INT;
+            size[i] = 0;
+            data[i] = NULL;
+        }
+    }
+    AK_hash_index_row(tblName, type, size, data, block->address, tuple);
     AK_EPI;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that tests hash index
-  * @return No return value 
+ * @brief Function that reads the value of the first attribute of a row
+ * @param row row address
+ * @return integer value
+ */
+static int AK_hash_test_row_id(struct_add *row) {
+    AK_mem_block *mem_block = AK_get_block(row->addBlock);
+    int value;
+    memcpy(&value, AK_tuple_data(mem_block->block, row->indexTd), sizeof (int));
+    return value;
+}
+
+/**
+ * @brief Function that looks an id up in a hash index on the first attribute and checks the rows it returns
+ * @param indexName name of the index
+ * @param id id
+ * @param row set to the address of the row holding the id
+ * @return number of rows holding the id
+ */
+static int AK_hash_test_lookup(char *indexName, int id, struct_add *row) {
+    int type = TYPE_INT, size = sizeof (int), key = 0, count, found = 0, i;
+    char *data = (char *) &id;
+    struct_add *rows;
+
+    if ((count = AK_hash_probe(indexName, &type, &size, &data, &rows)) == EXIT_ERROR)
+        return 0;
+    for (i = 0; i < count; i++)
+        if (AK_hash_row_matches(rows + i, 1, &key, &type, &size, &data)) {
+            *row = rows[i];
+            found++;
+        }
+    AK_free(rows);
+    return found;
+}
+
+/**
+ * @brief Function that writes rows of ids, names and cities for the hash index tests
+ * @param tblName table name
+ * @param from first id
+ * @param count number of rows
+ * @param create 1 if the table has to be created, 2 if it has to be created with other names of the varchar
+ * attributes, so it can be joined with the first kind of table
+ */
+static void AK_hash_test_rows(char *tblName, int from, int count, int create) {
+    AK_header header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "city", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    int type[3] = {TYPE_INT, TYPE_VARCHAR, TYPE_VARCHAR}, size[3], id;
+    char *data[3], name[MAX_VARCHAR_LENGTH], city[MAX_VARCHAR_LENGTH];
+    AK_table_writer *writer;
 
+    if (create == 2) {
+        strcpy(header[1].att_name, "label");
+        strcpy(header[2].att_name, "place");
+    }
+    if (create)
+        AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    writer = AK_table_writer_open(tblName);
+    for (id = from; id < from + count; id++) {
+        sprintf(name, "name%d", id);
+        sprintf(city, "city%d", id % 10);
+        data[0] = (char *) &id;
+        data[1] = name;
+        data[2] = city;
+        size[0] = sizeof (int);
+        size[1] = strlen(name);
+        size[2] = strlen(city);
+        AK_table_writer_append_values(writer, type, size, data);
+    }
+    AK_table_writer_close(writer);
+}
+
+/**
+  * @author Mislav Čakarić, rewritten for the linear hash index
+  * @brief Function that tests hash indexes. A table is indexed on an integer and on two varchar attributes; every row
+  * has to be found, rows written later have to be found after the buckets they went to were split, and selections and
+  * joins on the keys have to take the indexes and return what a scan returns.
+  * @return test result
  */
 TestResult AK_hash_test() {
-    char *tblName = "student";
-    char *indexName = "student_hash_index";
-    //AK_print_table("AK_relation");
+    char *tblName = "hash_test", *idIndex = "hash_test_id", *cityIndex = "hash_test_city_name", *joinTable = "hash_test_join";
+    int num_rows = 3000, ok = 0, fail = 0, found, buckets, i, id, usable[MAX_ATTRIBUTES];
+    int type[2] = {TYPE_VARCHAR, TYPE_VARCHAR}, size[2];
+    char *data[2], name[MAX_VARCHAR_LENGTH];
+    struct list_node *attributes, *values, *row, *expr, *el;
+    AK_table_cursor *cursor;
+    struct_add *add, address;
+    AK_hash_meta meta;
+    AK_access_path path;
     AK_PRO;
-    struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&att_list);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
 
-    AK_create_hash_index(tblName, att_list, indexName);
+    //XXH64 reference values, and the values of a key are hashed in order
+    data[0] = "listen";
+    data[1] = "silent";
+    size[0] = size[1] = 6;
+    if (AK_hash_bytes("", 0, 0) == 0xEF46DB3751D8E999ULL && AK_hash_bytes("abc", 3, 0) == 0x44BC2CF5AD770999ULL
+            && AK_hash_key(1, type, size, data) != AK_hash_key(1, type, size, data + 1)
+            && AK_hash_key(2, type, size, data) != AK_hash_key(2, type, size, (char *[]) {"silent", "listen"}))
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Hash values are wrong.\n");
+        fail++;
+    }
+
+    AK_hash_test_rows(tblName, 0, num_rows, 1);
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), attributes);
+    AK_create_hash_index(tblName, attributes, idIndex);
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "city", sizeof ("city"), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), attributes);
+    AK_create_hash_index(tblName, attributes, cityIndex);
+
+    AK_get_hash_info(idIndex, &meta);
+    buckets = (1 << meta.level) + meta.split;
+    printf("index %s: %d entries in %d buckets, %d pages\n", idIndex, meta.num_entries, buckets, meta.num_pages);
+    if (meta.built && meta.num_entries == num_rows && (long long) buckets * AK_HASH_PAGE_ENTRIES * AK_HASH_FILL >= num_rows * 100LL
+            && AK_get_hash_info(cityIndex, &meta) == EXIT_SUCCESS && meta.num_entries == num_rows && meta.num_keys == 2)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Indexes of %s were not built.\n", tblName);
+        fail++;
+    }
+
+    for (i = 0, found = 0; i < num_rows; i++)
+        if (AK_hash_test_lookup(idIndex, i, &address) == 1 && AK_hash_test_row_id(&address) == i)
+            found++;
+    if (found == num_rows && AK_hash_test_lookup(idIndex, -1, &address) == 0)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Lookups found %d of %d rows.\n", found, num_rows);
+        fail++;
+    }
+
+    //rows written later go to buckets that are split as the index grows
+    AK_hash_test_rows(tblName, num_rows, num_rows, 0);
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    id = 2 * num_rows;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", tblName, "name", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "city3", tblName, "city", row);
+    AK_insert_row(row);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    AK_get_hash_info(idIndex, &meta);
+    printf("index %s: %d entries in %d buckets after the inserts, %d pages\n", idIndex, meta.num_entries,
+        (1 << meta.level) + meta.split, meta.num_pages);
+    for (i = 0, found = 0; i <= 2 * num_rows; i++)
+        if (AK_hash_test_lookup(idIndex, i, &address) == 1 && AK_hash_test_row_id(&address) == i)
+            found++;
+    if (found == 2 * num_rows + 1 && meta.num_entries == 2 * num_rows + 1 && (1 << meta.level) + meta.split > buckets)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. %d of %d rows found after the buckets were split.\n", found, 2 * num_rows + 1);
+        fail++;
+    }
+
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "city3", sizeof ("city3"), values);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name4513", sizeof ("name4513"), values);
+    add = AK_find_in_hash_index(cityIndex, values);
+    AK_DeleteAll_L3(&values);
+    if (add->addBlock != 0 && AK_hash_test_row_id(add) == 4513)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Row of city3 and name4513 was not found in %s.\n", cityIndex);
+        fail++;
+    }
+    AK_free(add);
 
-    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    //selections on the keys take the indexes
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    id = 777;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_selection(tblName, "hash_test_sel_id", expr);
+    AK_selection_explain(tblName, expr, &path);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "city", sizeof ("city"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "city8", sizeof ("city8"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_selection(tblName, "hash_test_sel_none", expr);
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name33", sizeof ("name33"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "city", sizeof ("city"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "city3", sizeof ("city3"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    AK_selection(tblName, "hash_test_sel_city", expr);
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+    if (AK_get_num_records("hash_test_sel_id") == 1 && AK_get_num_records("hash_test_sel_none") == 0
+            && AK_get_num_records("hash_test_sel_city") == 1)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Selections returned %d, %d and %d rows instead of 1, 0 and 1.\n",
+            AK_get_num_records("hash_test_sel_id"), AK_get_num_records("hash_test_sel_none"),
+            AK_get_num_records("hash_test_sel_city"));
+        fail++;
+    }
+    if (path.method == AK_ACCESS_HASH && strcmp(path.index, idIndex) == 0)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Selection on id chose access path %d of %s.\n", path.method, path.index);
+        fail++;
+    }
+
+    //a join on the indexed key probes the index with the rows of the smaller table
+    AK_hash_test_rows(joinTable, 5990, 20, 2);
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), attributes);
+    AK_join(joinTable, tblName, "hash_test_joined", attributes);
+    if (AK_get_num_records("hash_test_joined") == 11)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Join returned %d rows instead of 11.\n", AK_get_num_records("hash_test_joined"));
+        fail++;
+    }
+
+    //entries are found once, deleted entries are gone
+    address.addBlock = 1000000;
+    address.indexTd = 7;
+    id = 123456;
+    data[0] = (char *) &id;
+    type[0] = TYPE_INT;
+    size[0] = sizeof (int);
+    found = AK_hash_insert(idIndex, type, size, data, &address) == EXIT_SUCCESS
+        && AK_hash_insert(idIndex, type, size, data, &address) == EXIT_WARNING;
+    i = AK_hash_probe(idIndex, type, size, data, &add);
+    AK_free(add);
+    if (found && i == 1 && AK_hash_delete_entry(idIndex, type, size, data, &address) == EXIT_SUCCESS
+            && AK_hash_probe(idIndex, type, size, data, &add) == 0
+            && AK_hash_delete_entry(idIndex, type, size, data, &address) == EXIT_WARNING)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Entry of %d was not inserted and deleted.\n", id);
+        fail++;
+    }
+    AK_free(add);
+
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&values);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "city9", sizeof ("city9"), values);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name9", sizeof ("name9"), values);
+    AK_delete_in_hash_index(cityIndex, values);
+    add = AK_find_in_hash_index(cityIndex, values);
+    AK_DeleteAll_L3(&values);
+    if (add->addBlock == 0 && AK_get_hash_info(cityIndex, &meta) == EXIT_SUCCESS && meta.num_entries == 2 * num_rows)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Row of city9 and name9 was not deleted from %s.\n", cityIndex);
+        fail++;
+    }
+    AK_free(add);
 
-    //AK_delete_hash_index(indexName);
-
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info = AK_get_hash_info(indexName);
-    printf("Main buckets:%d, Hash buckets:%d, Modulo:%d\n", info->main_bucket_num, info->hash_bucket_num, info->modulo);
-
-    //AK_delete_hash_index(indexName);
-    AK_print_table("AK_relation");
-    AK_print_table("AK_index");
-
-    printf("Hash index search test:\n");
-    int i, num_rec = AK_get_num_records(tblName);
-    for (i = 0; i < num_rec; i++) {
-        row = AK_get_row(i, tblName);
-        struct list_node *value = AK_GetNth_L2(0, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        struct_add *add = AK_find_in_hash_index(indexName, values);
+    AK_delete_hash_index(idIndex);
+    AK_delete_hash_index(cityIndex);
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+        usable[i] = 1;
+    if (AK_get_hash_info(idIndex, &meta) == EXIT_ERROR && AK_hash_find_index(tblName, usable, name, usable) == EXIT_WARNING)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. Index %s was not dropped.\n", idIndex);
+        fail++;
+    }
+
+    //the index on student stays for the DROP INDEX test
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), attributes);
+    AK_create_hash_index("student", attributes, "student_hash_index");
+    cursor = AK_table_cursor_open("student");
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    for (num_rows = 0, found = 0; cursor != NULL && (row = AK_table_cursor_next(cursor)) != NULL; num_rows++) {
+        el = (struct list_node *) AK_First_L2(row);
+        AK_InsertAtEnd_L3(el->type, el->data, el->size, values);
+        AK_InsertAtEnd_L3(el->next->type, el->next->data, el->next->size, values);
+        add = AK_find_in_hash_index("student_hash_index", values);
+        if (add->addBlock != 0)
+            found++;
+        AK_free(add);
         AK_DeleteAll_L3(&values);
-        if (add->addBlock && add->indexTd)
-            printf("Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
     }
-    printf("hash_test: Present!\n");
+    AK_table_cursor_close(cursor);
+    if (num_rows > 0 && found == num_rows)
+        ok++;
+    else {
+        printf("AK_hash_test: ERROR. %d of %d rows of student found in student_hash_index.\n", found, num_rows);
+        fail++;
+    }
+    AK_free(values);
+
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
     AK_EPI;
-    return TEST_result(0,0);
+    return TEST_result(ok, fail);
 }
 
+TestResult AK_hash_benchmark() {
+    char *tblName = "hash_bench", *indexName = "hash_bench_id";
+    int num_rows = 10000, num_lookups = 10000, ok = 0, fail = 0, found, i;
+    double start, build_time, lookup_time, join_index_time, join_hash_time;
+    struct list_node *attributes;
+    struct_add address;
+    int joined_index, joined_hash;
+    AK_PRO;
+
+    AK_hash_test_rows(tblName, 0, num_rows, 1);
+    AK_hash_test_rows("hash_bench_probe", 0, 200, 2);
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), attributes);
+
+    start = TEST_time_ms();
+    AK_create_hash_index(tblName, attributes, indexName);
+    build_time = TEST_time_ms() - start;
+
+    start = TEST_time_ms();
+    for (i = 0, found = 0; i < num_lookups; i++)
+        found += AK_hash_test_lookup(indexName, (i * 7919) % num_rows, &address);
+    lookup_time = TEST_time_ms() - start;
+
+    //the same join with the index and with a hash table built in memory
+    start = TEST_time_ms();
+    AK_join("hash_bench_probe", tblName, "hash_bench_join_index", attributes);
+    join_index_time = TEST_time_ms() - start;
+    joined_index = AK_get_num_records("hash_bench_join_index");
+    AK_delete_hash_index(indexName);
+    start = TEST_time_ms();
+    AK_join("hash_bench_probe", tblName, "hash_bench_join_hash", attributes);
+    join_hash_time = TEST_time_ms() - start;
+    joined_hash = AK_get_num_records("hash_bench_join_hash");
+
+    printf("\nhash index on %d rows built in %.1f ms\n", num_rows, build_time);
+    printf("%d lookups in %.1f ms (%.0f lookups/s)\n", num_lookups, lookup_time,
+        lookup_time > 0 ? num_lookups * 1000.0 / lookup_time : 0.0);
+    printf("join of 200 rows with %d rows: %.1f ms probing the index, %.1f ms with a hash join\n\n", num_rows,
+        join_index_time, join_hash_time);
+
+    if (found == num_lookups)
+        ok++;
+    else {
+        printf("AK_hash_benchmark: ERROR. %d of %d lookups found their row.\n", found, num_lookups);
+        fail++;
+    }
+    if (joined_index == 200 && joined_hash == 200)
+        ok++;
+    else {
+        printf("AK_hash_benchmark: ERROR. Joins returned %d and %d rows instead of 200.\n", joined_index, joined_hash);
+        fail++;
+    }
+
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
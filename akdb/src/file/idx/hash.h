@@ -27,170 +27,256 @@
 #include "../../auxi/configuration.h"
 #include "../files.h"
 #include "../../auxi/mempro.h"
+#include <pthread.h>
 
 /**
- * @author Unknown
- * @struct hash_info
- * @brief Structure for defining a hash info element
-*/
+ * @def AK_HASH_MAGIC
+ * @brief Constant marking the first block of a hash index segment
+ */
+#define AK_HASH_MAGIC 0x48736849
+
+/**
+ * @def AK_HASH_PAGE_SIZE
+ * @brief Constant declaring the size of a bucket page in bytes, a page takes the data area of one block
+ */
+#define AK_HASH_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+
+/**
+ * @def AK_HASH_DIRECTORY_ENTRIES
+ * @brief Constant declaring the number of bucket addresses held by one directory block
+ */
+#define AK_HASH_DIRECTORY_ENTRIES (AK_HASH_PAGE_SIZE / (int) sizeof (int))
+
+/**
+ * @def AK_HASH_MAX_DIRECTORY
+ * @brief Constant declaring the maximum number of directory blocks, the addresses are kept in the meta block
+ */
+#define AK_HASH_MAX_DIRECTORY 1024
+
+/**
+ * @def AK_HASH_FILL
+ * @brief Constant declaring how full (in percent) the buckets are on average before the next one is split
+ */
+#define AK_HASH_FILL 75
+
+/**
+ * @def AK_HASH_MAX_INDEXES
+ * @brief Constant declaring the maximum number of hash indexes kept in the list used to maintain them
+ */
+#define AK_HASH_MAX_INDEXES 64
+
+/**
+ * @struct AK_hash_meta
+ * @brief Structure stored in the first block of a hash index segment. The index is a linear hash table: bucket b of
+ * the 2^level + split buckets holds the keys whose hash ends in b, taken modulo 2^(level+1) for the buckets below
+ * split, which have already been split in this round, and modulo 2^level for the others.
+ */
 typedef struct {
-	/// modulo value for hash function
-    int modulo;
-    /// bucket number
-    int main_bucket_num;
-    /// hash bucket number
-    int hash_bucket_num;
-} hash_info;
+    /// AK_HASH_MAGIC
+    int magic;
+    /// obj_id of the indexed table
+    int table_id;
+    /// indexes and types of the key attributes
+    int num_keys;
+    int keys[MAX_ATTRIBUTES];
+    int types[MAX_ATTRIBUTES];
+    int level;
+    /// next bucket to split
+    int split;
+    /// 1 once the bulk build is done, lookups fail before that
+    int built;
+    int num_entries;
+    int num_pages;
+    /// overflow pages freed by splits, chained through their next page
+    int free_page;
+    int num_free;
+    /// next unused block of the segment and the end of its extent
+    int next_block;
+    int extent_end;
+    /// blocks holding the addresses of the primary pages of the buckets
+    int num_directory;
+    int directory[AK_HASH_MAX_DIRECTORY];
+} AK_hash_meta;
 
 /**
- * @author Unknown
- * @struct bucket_elem
- * @brief Structure for defining a single bucket element
+ * @struct AK_hash_page
+ * @brief Structure that starts a bucket page, it is followed by the entries
  */
 typedef struct {
-	/// bucket element hash value
-    unsigned int value;
-    /// bucket element address values
-    struct_add add;
-} bucket_elem;
+    int count;
+    /// next overflow page of the bucket, 0 for the last page
+    int next;
+} AK_hash_page;
 
 /**
- * @author Unknown
- * @struct main_bucket
- * @brief Structure for defining main bucket for table hashing
+ * @struct AK_hash_entry
+ * @brief Structure that defines an entry of a bucket page: the low 32 bits of the key hash and the row address
  */
 typedef struct {
-	/// main bucket array of bucket_elem elements
-    bucket_elem element[MAIN_BUCKET_SIZE];
-} main_bucket;
+    unsigned int hash;
+    struct_add row;
+} AK_hash_entry;
 
 /**
- * @author Unknown
- * @struct hash_bucket
- * @brief Structure for hash bucket for table hashing
+ * @def AK_HASH_PAGE_ENTRIES
+ * @brief Constant declaring the number of entries of a bucket page
+ */
+#define AK_HASH_PAGE_ENTRIES ((AK_HASH_PAGE_SIZE - (int) sizeof (AK_hash_page)) / (int) sizeof (AK_hash_entry))
+
+/**
+ * @struct AK_hash_index
+ * @brief Structure that defines a hash index found in the system catalog
  */
 typedef struct {
-	/// hash bucket level
-    int bucket_level;
-    /// hash bucket array of bucket_elem elements
-    bucket_elem element[HASH_BUCKET_SIZE];
-} hash_bucket;
+    char name[MAX_VARCHAR_LENGTH];
+    int table_id;
+    int num_keys;
+    int keys[MAX_ATTRIBUTES];
+    int types[MAX_ATTRIBUTES];
+    /// address of the meta block
+    int meta;
+} AK_hash_index;
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
+  * @brief Function that hashes a byte string with XXH64
+  * @param data bytes
+  * @param size number of bytes
+  * @param seed seed, a different seed gives an unrelated hash
+  * @return 64-bit hash
  */
-int AK_elem_hash_value(struct list_node *elem);
+unsigned long long AK_hash_bytes(const void *data, int size, unsigned long long seed);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+  * @brief Function that hashes the key of a row. Values are equal when they have the same size and bytes, floating
+  * point zeros are hashed as positive zero.
+  * @param num_keys number of key values
+  * @param type types of the values
+  * @param size sizes of the values
+  * @param data values
+  * @return hash of the key
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type);
+unsigned long long AK_hash_key(int num_keys, int *type, int *size, char **data);
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+  * @author Mislav Čakarić, rewritten as a linear hash index
+  * @brief Function that creates a hash index. The rows are read once and written bucket by bucket into as many buckets
+  * as keep them AK_HASH_FILL percent full, later inserts split one bucket at a time.
+  * @param tblName name of table for which the index is being created
+  * @param attributes list of attributes over which the index is being created
+  * @param indexName name of index
+  * @return EXIT_SUCCESS, EXIT_ERROR if an attribute does not exist or the index cannot be built
  */
-void AK_update_bucket_in_block(struct_add *add, char *data);
+int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
+  * @brief Function that drops a hash index
   * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+  * @return EXIT_SUCCESS, EXIT_ERROR if the segment could not be deleted
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num);
+int AK_delete_hash_index(char *indexName);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
+  * @brief Function that copies the meta block of a hash index
   * @param indexName name of index
-  * @return info bucket with info data for hash index
+  * @param meta copy of the meta block
+  * @return EXIT_SUCCESS, EXIT_ERROR if the index does not exist
  */
-hash_info* AK_get_hash_info(char *indexName);
+int AK_get_hash_info(char *indexName, AK_hash_meta *meta);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
+  * @brief Function that finds a hash index of a table whose key attributes are all usable, the one with the most
+  * key attributes is taken
+  * @param tblName table name
+  * @param usable MAX_ATTRIBUTES flags, nonzero for the attributes values are known for
+  * @param indexName buffer of MAX_VARCHAR_LENGTH characters the index name is copied to
+  * @param keys buffer of MAX_ATTRIBUTES elements the key attributes are copied to in key order
+  * @return number of key attributes, EXIT_WARNING if no index can be used
+ */
+int AK_hash_find_index(char *tblName, int *usable, char *indexName, int *keys);
+
+/**
+  * @brief Function that looks a key up in a hash index. Every row whose key has the same hash is returned, rows
+  * that were deleted or changed since they were indexed too, so the caller checks the rows it reads.
   * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+  * @param type types of the key values in key order
+  * @param size sizes of the key values
+  * @param data key values
+  * @param rows set to the addresses of the rows, allocated with AK_malloc
+  * @return number of rows, EXIT_ERROR if the index does not exist or is being built
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n);
+int AK_hash_probe(char *indexName, int *type, int *size, char **data, struct_add **rows);
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+  * @brief Function that inserts an entry into a hash index. When the buckets get fuller than AK_HASH_FILL percent
+  * on average the next bucket in line is split.
+  * @param indexName name of index
+  * @param type types of the key values in key order
+  * @param size sizes of the key values
+  * @param data key values
+  * @param row address of the row
+  * @return EXIT_SUCCESS, EXIT_WARNING if the entry is already in the index, EXIT_ERROR if the index does not exist
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add);
+int AK_hash_insert(char *indexName, int *type, int *size, char **data, struct_add *row);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
+  * @brief Function that deletes an entry from a hash index
   * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+  * @param type types of the key values in key order
+  * @param size sizes of the key values
+  * @param data key values
+  * @param row address of the row
+  * @return EXIT_SUCCESS, EXIT_WARNING if the entry is not in the index, EXIT_ERROR if the index does not exist
  */
-struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete);
+int AK_hash_delete_entry(char *indexName, int *type, int *size, char **data, struct_add *row);
 
 /**
   * @author Mislav Čakarić
   * @brief Function that fetches a record from the hash index
   * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
-  * @return address structure with data where the record is in table
- 
+  * @param values list of the key values in key order
+  * @return address structure with data where the record is in table, zeros if there is none
  */
-struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values);
+struct_add *AK_find_in_hash_index(char *indexName, struct list_node *values);
 
 /**
   * @author Mislav Čakarić
   * @brief Function that deletes a record from the hash index
   * @param indexName name of index
-  * @param values list of values (one row) to search in hash index
+  * @param values list of the key values in key order
   * @return No return value
- 
  */
 void AK_delete_in_hash_index(char *indexName, struct list_node *values);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
-  * @param indexName name of index
-  * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
+  * @brief Function that adds a row written to a table to the hash indexes of the table
+  * @param tblName table name
+  * @param type types of the values in header order
+  * @param size sizes of the values
+  * @param data values
+  * @param block address of the block the row is in
+  * @param tuple tuple_dict index of the first attribute of the row
  */
-int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
-void AK_delete_hash_index(char *indexName) ;
+void AK_hash_index_row(char *tblName, int *type, int *size, char **data, int block, int tuple);
+
+/**
+  * @brief Function that adds a row of a block to the hash indexes of the table
+  * @param tblName table name
+  * @param block block the row is in
+  * @param tuple tuple_dict index of the first attribute of the row
+ */
+void AK_hash_index_tuple(char *tblName, AK_block *block, int tuple);
 
 /**
   * @author Mislav Čakarić
   * @brief Function that tests hash index
-  * @return No return value 
-
+  * @return No return value
  */
 TestResult AK_hash_test();
 
+/**
+  * @brief Function that measures how long building a hash index takes and how many lookups per second it serves
+  * @return test result
+ */
+TestResult AK_hash_benchmark();
+
 #endif
@@ -97,20 +97,19 @@ int AK_sequence_remove(char *name){
  * @return current_value or EXIT_ERROR
  */
 int AK_sequence_current_value(char *name){
-    int i = 0;
     int current_value = -1;
-    int num_rows = AK_get_num_records("AK_sequence");
     
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *)AK_get_row(i, "AK_sequence")) != NULL){
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_sequence");
+    while ((row = AK_table_cursor_next(cursor)) != NULL){
         if (strcmp(get_row_attr_data(1,row), name) == 0) {
             memcpy(&current_value, get_row_attr_data(2,row), sizeof (int));
 	    break;
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
     
     if (current_value == -1){
 	AK_EPI;
@@ -128,7 +127,6 @@ int AK_sequence_current_value(char *name){
  */
 int AK_sequence_next_value(char *name){
     int next_value ;
-    int i = 0;
     int obj_id;
     int current_value = -1;
     int increment;
@@ -139,7 +137,8 @@ int AK_sequence_next_value(char *name){
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *)AK_get_row(i, "AK_sequence")) != NULL){
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_sequence");
+    while ((row = AK_table_cursor_next(cursor)) != NULL){
         if(strcmp( get_row_attr_data(1,row) ,name) == 0) {
         memcpy(&obj_id, get_row_attr_data(0,row), sizeof (int));
         memcpy(&current_value, get_row_attr_data(2,row), sizeof (int));
@@ -149,8 +148,8 @@ int AK_sequence_next_value(char *name){
         memcpy(&cycle, get_row_attr_data(6,row), sizeof (int));
         break;
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
    
 
     if (current_value == -1){
@@ -214,16 +213,16 @@ int AK_sequence_get_id(char *name){
     struct list_node * row;
     AK_PRO;
 	
-	while ((row = (struct list_node *)AK_get_row(i, "AK_sequence")) != NULL) {
+	AK_table_cursor *cursor = AK_table_cursor_open("AK_sequence");
+	while ((row = AK_table_cursor_next(cursor)) != NULL) {
 		if (strcmp( get_row_attr_data(1,row) ,name) == 0) {
 			i = (int) * get_row_attr_data(0,row);
-			AK_free(row);
+			AK_table_cursor_close(cursor);
 			AK_EPI;
 			return i;
 		}
-		i++;
 	}
-	AK_free(row);
+	AK_table_cursor_close(cursor);
 	AK_EPI;
 	return EXIT_ERROR;
 }
@@ -18,6 +18,9 @@
  */
 
 #include "../file/table.h"
+#include "../file/idx/btree.h"
+#include "../file/idx/hash.h"
+#include "../file/idx/bitmap.h"
 
 //TODO: Add description of the function
 AK_create_table_parameter* AK_create_create_table_parameter(int type, char* name) {
@@ -92,31 +95,15 @@ void AK_temp_create_table(char *table, AK_header *header, int type_segment) {
 
 /**
  * @author Matija Šestak.
- * @brief  Functions that determines the number of attributes in the table
- * <ol>
- * <li>Read addresses of extents</li>
- * <li>If there is no extents in the table, return EXIT_WARNING</li>
- * <li>else read the first block</li>
- * <li>while  header tuple exists in the block, increment num_attr</li>
- * </ol>
+ * @brief  Functions that determines the number of attributes in the table. The header of the first block is
+ * taken from the catalog cache.
  * @param  * tblName table name
- * @return number of attributes in the table
+ * @return number of attributes in the table, EXIT_WARNING if there is no extents in the table
  */
 int AK_num_attr(char * tblName) {
-    int num_attr = 0;
+    int num_attr;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    if (addresses->address_from[0] == 0)
-        num_attr = -2;
-    else {
-        AK_mem_block *temp_block = (AK_mem_block*) AK_get_block(addresses->address_from[0]);
-
-        while (strcmp(temp_block->block->header[num_attr].att_name, "\0") != 0) {
-            num_attr++;
-        }
-
-    }
-    AK_free(addresses);
+    num_attr = AK_catalog_get_num_attr(tblName);
     AK_EPI;
     return num_attr;
 }
@@ -153,7 +140,7 @@ int AK_get_num_records(char *tblName) {
             if (temp->block->last_tuple_dict_id == 0)
                 break;
             for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->block->tuple_dict[ k ].size > 0) {
+                if (AK_tuple_size(temp->block, k) > 0) {
                     num_rec++;
                 }
             }
@@ -169,30 +156,17 @@ AK_free(addresses);
 
 /**
  * @author Matija Šestak.
- * @brief  Function that fetches the table header
- * <ol>
- * <li>Read addresses of extents</li>
- * <li>If there is no extents in the table, return 0</li>
- * <li>else read the first block</li>
- * <li>allocate array</li>
- * <li>copy table header to the array</li>
- * </ol>
+ * @brief  Function that fetches the table header. The header of the first block is copied from the catalog cache.
  * @param  *tblName table name
- * @result array of table header
+ * @result array of table header, 0 if there is no extents in the table
  */
 AK_header *AK_get_header(char *tblName) {
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    if (addresses->address_from[0] == 0){
+    AK_header *head = AK_catalog_get_header(tblName);
+    if (head == NULL){
         AK_EPI;
         return EXIT_WARNING + 2;
     }
-    AK_mem_block *temp = (AK_mem_block*) AK_get_block(addresses->address_from[0]);
-
-    int num_attr = AK_num_attr(tblName);
-    AK_header *head = (AK_header*) AK_calloc(num_attr, sizeof (AK_header));
-    memcpy(head, temp->block->header, num_attr * sizeof (AK_header));
-	AK_free(addresses);
     AK_EPI;
     return head;
 }
@@ -227,27 +201,15 @@ char *AK_get_attr_name(char *tblName, int index) {
  * @return zero-based index
  */
 int AK_get_attr_index(char *tblName, char *attrName) {
+    int index;
     AK_PRO;
     if (tblName == NULL || attrName == NULL){
         AK_EPI;
         return EXIT_WARNING;
     }
-    int num_attr = AK_num_attr(tblName);
-    AK_header *header = AK_get_header(tblName);
-    int index = 0;
-    while (index < num_attr) 
-	{
-        if (strcmp(attrName, (header + index)->att_name) == 0)
-		{
-			AK_free(header);
-            AK_EPI;
-            return index;
-        }
-        index++;
-    }
-	AK_free(header);
+    index = AK_catalog_get_attr_index(tblName, attrName);
     AK_EPI;
-    return EXIT_WARNING;
+    return index;
 }
 
 /**
@@ -277,13 +239,9 @@ struct list_node *AK_get_column(int num, char *tblName) {
             AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
             if (temp->block->last_tuple_dict_id == 0) break;
             for (k = num; k < DATA_BLOCK_SIZE; k += num_attr) {
-                if (temp->block->tuple_dict[k].type != FREE_INT) {
-                    int type = temp->block->tuple_dict[k].type;
-                    int size = temp->block->tuple_dict[k].size;
-                    int address = temp->block->tuple_dict[k].address;
-                    memcpy(data, &(temp->block->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row_root);
+                if (AK_tuple_type(temp->block, k) != FREE_INT) {
+                    int size = AK_tuple_copy(temp->block, k, data);
+                    AK_InsertAtEnd_L3(AK_tuple_type(temp->block, k), data, size, row_root);
                 }
             }
         }
@@ -318,16 +276,12 @@ struct list_node *AK_get_row(int num, char * tblName) {
             if (temp->block->last_tuple_dict_id == 0)
                 break;
             for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                if (temp->block->tuple_dict[k].size > 0)
+                if (AK_tuple_size(temp->block, k) > 0)
                     counter++;
                 if (counter == num) {
                     for (l = 0; l < num_attr; l++) {
-                        int type = temp->block->tuple_dict[k + l].type;
-                        int size = temp->block->tuple_dict[k + l].size;
-                        int address = temp->block->tuple_dict[k + l].address;
-                        memcpy(data, &(temp->block->data[address]), size);
-                        data[size] = '\0';
-                        AK_InsertAtEnd_L3(type, data, size, row_root);
+                        int size = AK_tuple_copy(temp->block, k + l, data);
+                        AK_InsertAtEnd_L3(AK_tuple_type(temp->block, k + l), data, size, row_root);
                     }
                     AK_free(addresses);
                     AK_EPI;
@@ -354,10 +308,10 @@ struct list_node *AK_get_row(int num, char * tblName) {
  */
 struct list_node *AK_get_tuple(int row, int column, char *tblName) {
     AK_PRO;
-    int num_rows = AK_get_num_records(tblName);
     int num_attr = AK_num_attr(tblName);
 
-    if (row >= num_rows || column >= num_attr){
+    /// a row past the end of the table is not found by the scan below
+    if (row < 0 || column < 0 || column >= num_attr){
         AK_EPI;
         return NULL;
     }
@@ -380,17 +334,13 @@ struct list_node *AK_get_tuple(int row, int column, char *tblName) {
             if (temp->block->last_tuple_dict_id == 0) break;
             for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) 
 			{
-                if (temp->block->tuple_dict[k].size > 0)
+                if (AK_tuple_size(temp->block, k) > 0)
                     counter++;
                 if (counter == row) 
 				{
 					struct list_node *next;
-                    int type = temp->block->tuple_dict[ k + column ].type;
-                    int size = temp->block->tuple_dict[ k + column ].size;
-                    int address = temp->block->tuple_dict[ k + column ].address;
-                    memcpy(data, &(temp->block->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row_root);
+                    int size = AK_tuple_copy(temp->block, k + column, data);
+                    AK_InsertAtEnd_L3(AK_tuple_type(temp->block, k + column), data, size, row_root);
                     AK_free(addresses);
 					next = AK_First_L2(row_root); //store next
 					AK_free(row_root); //now we can free base
@@ -410,6 +360,315 @@ struct list_node *AK_get_tuple(int row, int column, char *tblName) {
     return NULL;
 }
 
+/**
+ * @brief  Function that moves a cursor to the next block of the table. The pin on the current block is released
+ * and the next block is pinned.
+ * @param *cursor table cursor
+ * @param next_extent 1 to skip the rest of the current extent, 0 to move to the next block
+ * @return No return value
+ */
+static void AK_table_cursor_advance(AK_table_cursor *cursor, int next_extent) {
+    table_addresses *addresses = cursor->addresses;
+
+    if (cursor->mem_block != NULL)
+        AK_unpin_block(cursor->mem_block);
+    cursor->mem_block = NULL;
+    cursor->tuple = 0;
+
+    if (!next_extent && cursor->block + 1 < addresses->address_to[cursor->extent]) {
+        cursor->block++;
+    } else {
+        /// the remaining blocks of an extent are empty once a block without tuples is reached
+        do {
+            cursor->extent++;
+            if (cursor->extent >= MAX_EXTENTS_IN_SEGMENT || addresses->address_from[cursor->extent] == 0)
+                return;
+        } while (addresses->address_from[cursor->extent] >= addresses->address_to[cursor->extent]);
+        cursor->block = addresses->address_from[cursor->extent];
+    }
+
+    cursor->mem_block = AK_pin_block(cursor->block);
+    if (cursor->mem_block == NULL)
+        printf("AK_table_cursor_next: ERROR. Cannot read block %d.\n", cursor->block);
+}
+
+/**
+ * @brief  Function that opens a forward cursor over the rows of a table. The cursor reads every block of the table
+ * once, in extent order, and keeps the block it is positioned in pinned in the cache.
+ * @param *tblName table name
+ * @return table cursor, NULL if the table has no extents
+ */
+AK_table_cursor *AK_table_cursor_open(char *tblName) {
+    AK_PRO;
+    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return NULL;
+    }
+
+    AK_table_cursor *cursor = (AK_table_cursor *) AK_calloc(1, sizeof (AK_table_cursor));
+    cursor->addresses = addresses;
+    cursor->extent = 0;
+    cursor->block = addresses->address_from[0];
+    cursor->tuple = 0;
+    cursor->mem_block = AK_pin_block(cursor->block);
+    if (cursor->mem_block == NULL) {
+        printf("AK_table_cursor_open: ERROR. Cannot read block %d.\n", cursor->block);
+        AK_free(addresses);
+        AK_free(cursor);
+        AK_EPI;
+        return NULL;
+    }
+
+    while (cursor->num_attr < MAX_ATTRIBUTES && strcmp(cursor->mem_block->block->header[cursor->num_attr].att_name, "\0") != 0)
+        cursor->num_attr++;
+
+    /// the row list is allocated once and refilled by every AK_table_cursor_next
+    struct list_node *last;
+    int i;
+    cursor->row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&cursor->row);
+    last = cursor->row;
+    for (i = 0; i < cursor->num_attr; i++) {
+        last->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+        last = last->next;
+        last->next = NULL;
+    }
+    AK_EPI;
+    return cursor;
+}
+
+/**
+ * @brief  Function that fetches the next row of a table cursor. The returned list belongs to the cursor: it is
+ * overwritten by the next call and freed by AK_table_cursor_close, so the caller must not free it.
+ * @param *cursor table cursor, may be NULL
+ * @return row values list, NULL when there are no more rows
+ */
+struct list_node *AK_table_cursor_next(AK_table_cursor *cursor) {
+    AK_PRO;
+    if (cursor == NULL || cursor->num_attr == 0) {
+        AK_EPI;
+        return NULL;
+    }
+
+    while (cursor->mem_block != NULL) {
+        AK_mem_block *mem_block = cursor->mem_block;
+        AK_block *block = mem_block->block;
+
+        AK_latch_block(mem_block, AK_LATCH_SHARED);
+        if (block->last_tuple_dict_id == 0) {
+            AK_unlatch_block(mem_block);
+            AK_table_cursor_advance(cursor, 1);
+            continue;
+        }
+
+        while (cursor->tuple + cursor->num_attr <= DATA_BLOCK_SIZE) {
+            int k = cursor->tuple;
+            cursor->tuple += cursor->num_attr;
+
+            if (AK_tuple_size(block, k) > 0) {
+                struct list_node *el = cursor->row->next;
+                int l;
+                for (l = 0; l < cursor->num_attr; l++, el = el->next) {
+                    el->type = AK_tuple_type(block, k + l);
+                    el->size = AK_tuple_copy(block, k + l, el->data);
+                }
+                AK_unlatch_block(mem_block);
+                AK_EPI;
+                return cursor->row;
+            }
+        }
+        AK_unlatch_block(mem_block);
+        AK_table_cursor_advance(cursor, 0);
+    }
+    AK_EPI;
+    return NULL;
+}
+
+/**
+ * @brief  Function that closes a table cursor, releases its block and frees the row list
+ * @param *cursor table cursor, may be NULL
+ * @return No return value
+ */
+void AK_table_cursor_close(AK_table_cursor *cursor) {
+    AK_PRO;
+    if (cursor != NULL) {
+        if (cursor->mem_block != NULL)
+            AK_unpin_block(cursor->mem_block);
+        AK_DeleteAll_L3(&cursor->row);
+        AK_free(cursor->row);
+        AK_free(cursor->addresses);
+        AK_free(cursor);
+    }
+    AK_EPI;
+}
+
+/**
+ * @brief  Function that opens a sequential writer on a table. It is meant for tables that are filled by a single
+ * operation (operator results, temp segments), rows skip the redo log and the reference check done by AK_insert_row.
+ * @param *tblName table name
+ * @return table writer, NULL if the table has no extents
+ */
+AK_table_writer *AK_table_writer_open(char *tblName) {
+    AK_PRO;
+    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return NULL;
+    }
+
+    AK_table_writer *writer = (AK_table_writer *) AK_calloc(1, sizeof (AK_table_writer));
+    strncpy(writer->table, tblName, MAX_ATT_NAME - 1);
+    writer->addresses = addresses;
+    writer->extent = 0;
+    writer->block = addresses->address_from[0];
+    writer->num_attr = AK_num_attr(tblName);
+    writer->max_free_space = MAX_FREE_SPACE_SIZE;
+    writer->max_tuple_dict = MAX_LAST_TUPLE_DICT_SIZE_TO_USE;
+    writer->mem_block = NULL;
+    AK_EPI;
+    return writer;
+}
+
+/**
+ * @brief  Function that moves a table writer to its next block, allocating a new extent after the last one
+ * @param *writer table writer
+ * @return EXIT_SUCCESS, EXIT_ERROR if no block is available
+ */
+static int AK_table_writer_next_block(AK_table_writer *writer) {
+    if (writer->mem_block != NULL) {
+        AK_fsm_update(writer->mem_block->block);
+        AK_mem_block_modify(writer->mem_block, BLOCK_DIRTY);
+        AK_unpin_block(writer->mem_block);
+        writer->mem_block = NULL;
+        writer->block++;
+    }
+
+    while (writer->block >= writer->addresses->address_to[writer->extent]) {
+        writer->extent++;
+        if (writer->extent >= MAX_EXTENTS_IN_SEGMENT)
+            return EXIT_ERROR;
+        if (writer->addresses->address_from[writer->extent] == 0) {
+            if (AK_init_new_extent(writer->table, SEGMENT_TYPE_TABLE) == EXIT_ERROR)
+                return EXIT_ERROR;
+            AK_free(writer->addresses);
+            writer->addresses = (table_addresses*) AK_get_table_addresses(writer->table);
+            if (writer->addresses->address_from[writer->extent] == 0)
+                return EXIT_ERROR;
+        }
+        writer->block = writer->addresses->address_from[writer->extent];
+    }
+
+    writer->mem_block = AK_pin_block(writer->block);
+    return (writer->mem_block == NULL) ? EXIT_ERROR : EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that appends a row given as arrays of values to a table. A new extent is allocated when the last block is full.
+ * @param *writer table writer
+ * @param *type types of the values in header order
+ * @param *size sizes of the values
+ * @param **data values
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row could not be written
+ */
+int AK_table_writer_append_values(AK_table_writer *writer, int *type, int *size, char **data) {
+    AK_block *block;
+    int row_size = 0, id, l;
+    AK_PRO;
+
+    for (l = 0; l < writer->num_attr; l++)
+        row_size += size[l];
+    if (row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE) {
+        printf("AK_table_writer_append: ERROR. Row does not fit table %s.\n", writer->table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    while (1) {
+        if (writer->mem_block == NULL && AK_table_writer_next_block(writer) == EXIT_ERROR) {
+            printf("AK_table_writer_append: ERROR. Cannot get a block for table %s.\n", writer->table);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        block = writer->mem_block->block;
+        id = (block->AK_free_space == 0) ? 0 : block->last_tuple_dict_id + 1;
+
+        //a block takes rows while AK_insert_row would still choose it and the row fits
+        if (block->AK_free_space == 0 || (block->AK_free_space < writer->max_free_space && id < writer->max_tuple_dict
+                && block->AK_free_space + row_size <= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE && id + writer->num_attr <= DATA_BLOCK_SIZE))
+            break;
+        if (AK_table_writer_next_block(writer) == EXIT_ERROR) {
+            printf("AK_table_writer_append: ERROR. Cannot get a block for table %s.\n", writer->table);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
+    AK_latch_block(writer->mem_block, AK_LATCH_EXCLUSIVE);
+    for (l = 0; l < writer->num_attr; l++) {
+        memcpy(block->data + block->AK_free_space, data[l], size[l]);
+        block->tuple_dict[id + l].address = block->AK_free_space;
+        block->tuple_dict[id + l].type = type[l];
+        block->tuple_dict[id + l].size = size[l];
+        block->AK_free_space += size[l];
+    }
+    block->last_tuple_dict_id = id + writer->num_attr - 1;
+    AK_unlatch_block(writer->mem_block);
+    AK_btree_index_row(writer->table, type, size, data, writer->block, id);
+    AK_hash_index_row(writer->table, type, size, data, writer->block, id);
+    AK_bitmap_index_row(writer->table, type, size, data, writer->block, id);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that appends a row to a table. A new extent is allocated when the last block is full.
+ * @param *writer table writer
+ * @param *row row values in header order, like the rows returned by AK_table_cursor_next
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row could not be written
+ */
+int AK_table_writer_append(AK_table_writer *writer, struct list_node *row) {
+    struct list_node *el;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], l, result;
+    char *data[MAX_ATTRIBUTES];
+    AK_PRO;
+
+    for (el = AK_First_L2(row), l = 0; el != NULL && l < writer->num_attr; el = el->next, l++) {
+        type[l] = el->type;
+        size[l] = el->size;
+        data[l] = el->data;
+    }
+    if (l < writer->num_attr) {
+        printf("AK_table_writer_append: ERROR. Row does not fit table %s.\n", writer->table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    result = AK_table_writer_append_values(writer, type, size, data);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that closes a table writer and releases its block
+ * @param *writer table writer, may be NULL
+ * @return No return value
+ */
+void AK_table_writer_close(AK_table_writer *writer) {
+    AK_PRO;
+    if (writer != NULL) {
+        if (writer->mem_block != NULL) {
+            AK_fsm_update(writer->mem_block->block);
+            AK_mem_block_modify(writer->mem_block, BLOCK_DIRTY);
+            AK_unpin_block(writer->mem_block);
+        }
+        AK_free(writer->addresses);
+        AK_free(writer);
+    }
+    AK_EPI;
+}
+
 /**
  * @author Matija Šestak.
  * @brief  Function that converts tuple value to string
@@ -521,6 +780,38 @@ void AK_print_row(int col_len[], struct list_node *row) {
     AK_EPI;
 }
 
+/**
+ * @brief  Function that widens the column lengths to the longest value of each column, in one pass over the table
+ * @param *tblName table name
+ * @param len[] lengths of the columns, initialized with the attribute name lengths
+ * @return No return value
+ */
+static void AK_table_column_widths(char *tblName, int len[]) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *row, *el;
+    int i, length;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        for (i = 0, el = row->next; el != NULL; i++, el = el->next) {
+            switch (el->type) {
+                case TYPE_INT:
+                    length = AK_chars_num_from_number(*((int *) el->data), 10);
+                    break;
+                case TYPE_FLOAT:
+                    length = AK_chars_num_from_number(*((float *) el->data), 10);
+                    break;
+                case TYPE_VARCHAR:
+                default:
+                    length = el->size;
+                    break;
+            }
+            if (len[i] < length)
+                len[i] = length;
+        }
+    }
+    AK_table_cursor_close(cursor);
+}
+
 /**
  * @author Jurica Hlevnjak
  * @brief Function that examines whether there is a table with the name "tblName" in the system catalog (AK_relation)
@@ -568,7 +859,7 @@ void AK_print_table(char *tblName) {
     } else {
         AK_header *head = AK_get_header(tblName);
 
-        int i, j, k, l;
+        int i, k;
         int num_attr = AK_num_attr(tblName);
         int num_rows = AK_get_num_records(tblName);
         int len[num_attr]; //max length for each attribute in row
@@ -580,42 +871,9 @@ void AK_print_table(char *tblName) {
             len[i] = strlen((head + i)->att_name);
         }
 
-        //for each header attribute iterate through all table rows and check if
-        //there is longer element than previously longest and store it in array
-        for (i = 0; i < num_attr; i++) {
-            for (j = 0; j < num_rows; j++) 
-			{
-                struct list_node *el = AK_get_tuple(j, i, tblName);
-                switch (el->type) 
-				{
-                    case TYPE_INT:
-                        length = AK_chars_num_from_number(*((int *) (el)->data), 10);
-                        if (len[i] < length) 
-						{
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_FLOAT:
-                        length = AK_chars_num_from_number(*((float *) (el)->data), 10);
-                        if (len[i] < length) 
-						{
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_VARCHAR:
-                    default:
-                        if (len[i] < el->size) 
-						{
-                            len[i] = el->size;
-                        }
-                        break;
-                }
-				//we don't need this linked list anymore (starting from tupple first to the end
-				//see comment above in function AK_get_tuple - Elvis Popovic
-				AK_DeleteAll_L3(&el);
-				AK_free(el);
-            }
-        }
+        //iterate through all table rows and check if there is longer element
+        //than previously longest and store it in array
+        AK_table_column_widths(tblName, len);
         //num_attr is number of char | + space in printf
         //set offset to change the box size
         length = 0;
@@ -652,33 +910,14 @@ void AK_print_table(char *tblName) {
             printf("\n");
             AK_print_row_spacer(len, length);
 
-            struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-            AK_Init_L3(&row_root);
-
-            i = 0;
-            int type, size, address;
+            AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+            struct list_node *row_root;
 
-            while (addresses->address_from[i] != 0) {
-                for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-                    AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
-                    if (temp->block->last_tuple_dict_id == 0)
-                        break;
-                    for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                        if (temp->block->tuple_dict[k].size > 0 /*&& k / num_attr < num_rows*/) {
-                            for (l = 0; l < num_attr; l++) {
-                                type = temp->block->tuple_dict[k + l].type;
-                                size = temp->block->tuple_dict[k + l].size;
-                                address = temp->block->tuple_dict[k + l].address;
-                                AK_InsertAtEnd_L3(type, &temp->block->data[address], size, row_root);
-                            }
-                            AK_print_row(len, row_root);
-                            AK_print_row_spacer(len, length);
-                            AK_DeleteAll_L3(&row_root);
-                        }
-                    }
-                }
-                i++;
+            while ((row_root = AK_table_cursor_next(cursor)) != NULL) {
+                AK_print_row(len, row_root);
+                AK_print_row_spacer(len, length);
             }
+            AK_table_cursor_close(cursor);
 
             printf("\n");
             t = clock() - t;
@@ -688,7 +927,6 @@ void AK_print_table(char *tblName) {
             } else {
                 printf("%i rows found, duration: %f s\n", num_rows, ((double) t) / CLOCKS_PER_SEC);
             }
-        AK_free(row_root);
         }
 
 AK_free(addresses);
@@ -825,7 +1063,7 @@ void AK_print_table_to_file(char *tblName) {
     } else {
         AK_header *head = AK_get_header(tblName);
 
-        int i, j, k, l;
+        int i, k;
         int num_attr = AK_num_attr(tblName);
         int num_rows = AK_get_num_records(tblName);
         int len[num_attr]; //max length for each attribute in row
@@ -836,33 +1074,9 @@ void AK_print_table_to_file(char *tblName) {
             len[i] = strlen((head + i)->att_name);
         }
 
-        //for each header attribute iterate through all table rows and check if
-        //there is longer element than previously longest and store it in array
-        for (i = 0; i < num_attr; i++) {
-            for (j = 0; j < num_rows; j++) {
-                struct list_node *el = AK_get_tuple(j, i, tblName);
-                switch (el->type) {
-                    case TYPE_INT:
-                        length = AK_chars_num_from_number(*((int *) (el)->data), 10);
-                        if (len[i] < length) {
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_FLOAT:
-                        length = AK_chars_num_from_number(*((float *) (el)->data), 10);
-                        if (len[i] < length) {
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_VARCHAR:
-                    default:
-                        if (len[i] < el->size) {
-                            len[i] = el->size;
-                        }
-                        break;
-                }
-            }
-        }
+        //iterate through all table rows and check if there is longer element
+        //than previously longest and store it in array
+        AK_table_column_widths(tblName, len);
         //num_attr is number of char | + space in printf
         //set offset to change the box size
         length = 0;
@@ -897,33 +1111,14 @@ void AK_print_table_to_file(char *tblName) {
             fprintf(fp, "\n");
             fclose(fp);
             AK_print_row_spacer_to_file(len, length);
-            struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-            AK_Init_L3(&row_root);
+            AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+            struct list_node *row_root;
 
-            i = 0;
-            int type, size, address;
-
-            while (addresses->address_from[i] != 0) {
-                for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-                    AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
-                    if (temp->block->last_tuple_dict_id == 0)
-                        break;
-                    for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                        if (temp->block->tuple_dict[k].size > 0) {
-                            for (l = 0; l < num_attr; l++) {
-                                type = temp->block->tuple_dict[k + l].type;
-                                size = temp->block->tuple_dict[k + l].size;
-                                address = temp->block->tuple_dict[k + l].address;
-                                AK_InsertAtEnd_L3(type, &(temp->block->data[address]), size, row_root);
-                            }
-                            AK_print_row_to_file(len, row_root);
-                            AK_print_row_spacer_to_file(len, length);
-                            AK_DeleteAll_L3(&row_root);
-                        }
-                    }
-                }
-                i++;
+            while ((row_root = AK_table_cursor_next(cursor)) != NULL) {
+                AK_print_row_to_file(len, row_root);
+                AK_print_row_spacer_to_file(len, length);
             }
+            AK_table_cursor_close(cursor);
             fp = fopen(FILEPATH, "a");
             fprintf(fp, "\n");
         }
@@ -954,22 +1149,9 @@ int AK_table_empty(char *tblName) {
  * @return obj_id of the table or EXIT_ERROR if there is no table with that name
  */
 int AK_get_table_obj_id(char *table) {
-    int i = 0, table_id = -1;
-    struct list_node *row;
-
-    i = 0;
+    int table_id;
     AK_PRO;
-    while ((row = AK_get_row(i, "AK_relation")) != NULL) {
-        if (strcmp(row->next->next->data, table) == 0) {
-            memcpy(&table_id, row->next->data, sizeof (int));
-            break;
-        }
-        i++;
-    }
-    if (table_id == -1){
-        AK_EPI;
-        return EXIT_ERROR;
-    }
+    table_id = AK_catalog_get_obj_id(table);
     AK_EPI;
     return table_id;
 }
@@ -1043,7 +1225,7 @@ int AK_rename(char *old_table_name, char *old_attr, char *new_table_name, char *
         //SEARCH FOR ALL BLOCKS IN SEGMENT
         i = 0;
         while (adresses->address_from[i]) {
-            for (j = adresses->address_from[i]; j <= adresses->address_to[i]; j++) {
+            for (j = adresses->address_from[i]; j < adresses->address_to[i]; j++) {
                 tab_addresses[num_blocks] = j;
                 num_blocks++;
             }
@@ -1103,6 +1285,8 @@ int AK_rename(char *old_table_name, char *old_attr, char *new_table_name, char *
   AK_delete_row(row_root);
   AK_free(row_root);
     }
+    AK_catalog_invalidate(old_table_name);
+    AK_catalog_invalidate(new_table_name);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -1219,3 +1403,244 @@ TestResult AK_op_rename_test() {
     }
 
 }
+
+/**
+ * @brief Benchmark for full table scans. A one-column table is filled up to 100000 rows and read at
+ * growing sizes once with AK_get_row(i) for i = 0..n and once with a table cursor. The AK_get_row loop
+ * is too slow to run to the end, so the time of sampled rows spread over the table is extrapolated to
+ * all n rows. Rows read by both paths have to match the row number that was written.
+ * @return TestResult
+ */
+TestResult AK_table_cursor_benchmark()
+{
+    char *tblName = "cursor_benchmark";
+    int sizes[] = { 12500, 25000, 50000, 100000 };
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    int num_samples = 200;
+    int i, s, n = 0, value, extent = 0, block, success = 0, failed = 0;
+    double start, get_row_ms[num_sizes], cursor_ms[num_sizes];
+    AK_header header[2] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    struct list_node *row_root, *row;
+    table_addresses *addresses;
+    AK_table_cursor *cursor;
+    AK_mem_block *mem_block;
+    AK_PRO;
+
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR) {
+        printf("AK_table_cursor_benchmark: Cannot create table %s.\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    addresses = AK_get_table_addresses(tblName);
+    block = addresses->address_from[0];
+
+    for (s = 0; s < num_sizes; s++) {
+        // rows are written straight into the blocks, AK_insert_row would dominate the benchmark
+        while (n < sizes[s]) {
+            if (block >= addresses->address_to[extent]) {
+                extent++;
+                if (extent >= MAX_EXTENTS_IN_SEGMENT || addresses->address_from[extent] == 0) {
+                    if (AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE) == EXIT_ERROR)
+                        break;
+                    AK_free(addresses);
+                    addresses = AK_get_table_addresses(tblName);
+                }
+                block = addresses->address_from[extent];
+                continue;
+            }
+            mem_block = AK_pin_block(block);
+            if (mem_block == NULL)
+                break;
+            while (n < sizes[s] && mem_block->block->last_tuple_dict_id + 1 < DATA_BLOCK_SIZE) {
+                AK_DeleteAll_L3(&row_root);
+                AK_Insert_New_Element(TYPE_INT, &n, tblName, "id", row_root);
+                AK_insert_row_to_block(row_root, mem_block->block);
+                n++;
+            }
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            AK_unpin_block(mem_block);
+            block++;
+        }
+        if (n < sizes[s]) {
+            printf("AK_table_cursor_benchmark: Cannot fill table %s past %d rows.\n", tblName, n);
+            failed++;
+            num_sizes = s;
+            break;
+        }
+
+        start = TEST_time_ms();
+        for (i = 0; i < num_samples; i++) {
+            row = AK_get_row((int) ((long) i * n / num_samples), tblName);
+            memcpy(&value, AK_First_L2(row)->data, sizeof (int));
+            if (value == (int) ((long) i * n / num_samples))
+                success++;
+            else
+                failed++;
+            AK_DeleteAll_L3(&row);
+            AK_free(row);
+        }
+        get_row_ms[s] = (TEST_time_ms() - start) / num_samples * n;
+
+        start = TEST_time_ms();
+        i = 0;
+        cursor = AK_table_cursor_open(tblName);
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
+            memcpy(&value, AK_First_L2(row)->data, sizeof (int));
+            if (value != i)
+                break;
+            i++;
+        }
+        AK_table_cursor_close(cursor);
+        cursor_ms[s] = TEST_time_ms() - start;
+        if (i == n)
+            success++;
+        else {
+            printf("AK_table_cursor_benchmark: Cursor read %d of %d rows.\n", i, n);
+            failed++;
+        }
+    }
+
+    printf("\nFull scan of table %s (ms)\n", tblName);
+    printf("%10s %22s %14s\n", "rows", "AK_get_row (estimate)", "cursor");
+    for (s = 0; s < num_sizes; s++)
+        printf("%10d %22.0f %14.1f\n", sizes[s], get_row_ms[s], cursor_ms[s]);
+
+    AK_free(addresses);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
+
+/**
+ * @brief Function that checks the extent addresses of a table served by the catalog cache against the rows of the
+ * AK_relation system table
+ * @param tblName table name
+ * @param num_extents expected number of extents
+ * @return 1 if the addresses match the catalog rows, 0 otherwise
+ */
+static int AK_catalog_cache_test_check(char *tblName, int num_extents)
+{
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_table_cursor *cursor;
+    struct list_node *row;
+    int n = 0, from, to, ok = 1;
+
+    cursor = AK_table_cursor_open("AK_relation");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (strcmp(AK_GetNth_L2(2, row)->data, tblName) != 0)
+            continue;
+        memcpy(&from, AK_GetNth_L2(3, row)->data, sizeof (int));
+        memcpy(&to, AK_GetNth_L2(4, row)->data, sizeof (int));
+        if (n >= MAX_EXTENTS_IN_SEGMENT || addresses->address_from[n] != from || addresses->address_to[n] != to)
+            ok = 0;
+        n++;
+    }
+    AK_table_cursor_close(cursor);
+    if (n != num_extents || (n < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[n] != 0))
+        ok = 0;
+    AK_free(addresses);
+    return ok;
+}
+
+/**
+ * @brief Function for testing the catalog cache. Checks the schema and extents served for a table after it is created,
+ * extended, has an attribute renamed and is deleted, then compares the lookup rate with and without the cache.
+ * @return test result
+ */
+TestResult AK_catalog_cache_test()
+{
+    char *tblName = "catalog_cache_test";
+    int num_lookups = 20000;
+    int i, num, success = 0, failed = 0;
+    unsigned long version;
+    double start, rates[2];
+    AK_header header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "weight", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    AK_header *head;
+    table_addresses *addresses;
+    AK_PRO;
+
+    version = AK_catalog_version();
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header);
+    if (AK_catalog_version() != version && AK_num_attr(tblName) == 3 && AK_get_attr_index(tblName, "weight") == 2
+            && AK_get_attr_index(tblName, "height") == EXIT_WARNING && AK_get_table_obj_id(tblName) > 0
+            && AK_catalog_cache_test_check(tblName, 1)) {
+        printf("Created table %s is in the catalog cache\n", tblName);
+        success++;
+    } else {
+        printf("AK_catalog_cache_test: ERROR. Wrong catalog entry of the created table %s.\n", tblName);
+        failed++;
+    }
+
+    AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_catalog_cache_test_check(tblName, 2)) {
+        printf("New extent of table %s is in the catalog cache\n", tblName);
+        success++;
+    } else {
+        printf("AK_catalog_cache_test: ERROR. Wrong extents of table %s after AK_init_new_extent.\n", tblName);
+        failed++;
+    }
+
+    AK_rename(tblName, "name", tblName, "full_name");
+    head = AK_get_header(tblName);
+    if (AK_get_attr_index(tblName, "full_name") == 1 && AK_get_attr_index(tblName, "name") == EXIT_WARNING
+            && head != NULL && strcmp(head[1].att_name, "full_name") == 0) {
+        printf("Renamed attribute of table %s is in the catalog cache\n", tblName);
+        success++;
+    } else {
+        printf("AK_catalog_cache_test: ERROR. Wrong header of table %s after AK_rename.\n", tblName);
+        failed++;
+    }
+    if (head != NULL)
+        AK_free(head);
+
+    //the same lookups with the entry dropped before each one read the catalog like before the cache
+    for (i = 0; i < 2; i++) {
+        num = i == 0 ? num_lookups / 10 : num_lookups;
+        start = TEST_time_ms();
+        while (num-- > 0) {
+            if (i == 0)
+                AK_catalog_invalidate(tblName);
+            addresses = AK_get_table_addresses(tblName);
+            AK_free(addresses);
+            if (AK_num_attr(tblName) != 3 || AK_get_attr_index(tblName, "weight") != 2)
+                break;
+        }
+        rates[i] = (i == 0 ? num_lookups / 10 : num_lookups) / ((TEST_time_ms() - start) / 1000.0);
+        if (num < 0)
+            success++;
+        else {
+            printf("AK_catalog_cache_test: ERROR. Wrong schema of table %s during the lookups.\n", tblName);
+            failed++;
+        }
+    }
+    printf("\nTable lookups per second (addresses, number of attributes and attribute index)\n");
+    printf("%-16s %12.0f\n%-16s %12.0f\n", "catalog scan", rates[0], "catalog cache", rates[1]);
+    printf("catalog cache: %d entries, %lu hits, %lu misses\n\n", catalog_cache->num_entries, catalog_cache->hits,
+            catalog_cache->misses);
+
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    addresses = AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0 && AK_num_attr(tblName) == EXIT_WARNING
+            && AK_get_table_obj_id(tblName) == EXIT_ERROR && AK_get_header(tblName) == 0) {
+        printf("Deleted table %s is not in the catalog cache\n", tblName);
+        success++;
+    } else {
+        printf("AK_catalog_cache_test: ERROR. Deleted table %s is still in the catalog cache.\n", tblName);
+        failed++;
+    }
+    AK_free(addresses);
+
+    AK_EPI;
+    return TEST_result(success, failed);
+}
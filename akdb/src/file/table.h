@@ -39,6 +39,46 @@
 
 
 
+/**
+ * @struct AK_table_cursor
+ * @brief Forward cursor over the rows of a table. The block the cursor is positioned in stays pinned in the cache.
+ */
+typedef struct {
+    /// extents of the table
+    table_addresses *addresses;
+    /// index of the current extent
+    int extent;
+    /// address of the current block
+    int block;
+    /// tuple_dict index of the next row in the current block
+    int tuple;
+    int num_attr;
+    /// current block, NULL after the last block
+    AK_mem_block *mem_block;
+    /// row returned by AK_table_cursor_next, reused for every row
+    struct list_node *row;
+} AK_table_cursor;
+
+/**
+ * @struct AK_table_writer
+ * @brief Sequential row writer for a table. Rows are appended block after block, the block being filled stays pinned in the cache.
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    /// extents of the table
+    table_addresses *addresses;
+    /// index of the current extent
+    int extent;
+    /// address of the current block
+    int block;
+    int num_attr;
+    /// fill limits of a block, the same ones AK_insert_row uses
+    int max_free_space;
+    int max_tuple_dict;
+    /// current block, NULL until the first row is written
+    AK_mem_block *mem_block;
+} AK_table_writer;
+
 struct AK_create_table_struct {
 	char name[MAX_ATT_NAME];
 	int type;
@@ -155,6 +195,62 @@ struct list_node * AK_get_row(int num, char * tblName);
  */
 struct list_node *AK_get_tuple(int row, int column, char *tblName);
 
+/**
+ * @brief  Function that opens a forward cursor over the rows of a table. The cursor reads every block of the table
+ * once, in extent order, and keeps the block it is positioned in pinned in the cache.
+ * @param *tblName table name
+ * @return table cursor, NULL if the table has no extents
+ */
+AK_table_cursor *AK_table_cursor_open(char *tblName);
+
+/**
+ * @brief  Function that fetches the next row of a table cursor. The returned list belongs to the cursor: it is
+ * overwritten by the next call and freed by AK_table_cursor_close, so the caller must not free it.
+ * @param *cursor table cursor, may be NULL
+ * @return row values list, NULL when there are no more rows
+ */
+struct list_node *AK_table_cursor_next(AK_table_cursor *cursor);
+
+/**
+ * @brief  Function that closes a table cursor, releases its block and frees the row list
+ * @param *cursor table cursor, may be NULL
+ * @return No return value
+ */
+void AK_table_cursor_close(AK_table_cursor *cursor);
+
+/**
+ * @brief  Function that opens a sequential writer on a table. It is meant for tables that are filled by a single
+ * operation (operator results, temp segments), rows skip the redo log and the reference check done by AK_insert_row.
+ * @param *tblName table name
+ * @return table writer, NULL if the table has no extents
+ */
+AK_table_writer *AK_table_writer_open(char *tblName);
+
+/**
+ * @brief  Function that appends a row given as arrays of values to a table. A new extent is allocated when the last block is full.
+ * @param *writer table writer
+ * @param *type types of the values in header order
+ * @param *size sizes of the values
+ * @param **data values
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row could not be written
+ */
+int AK_table_writer_append_values(AK_table_writer *writer, int *type, int *size, char **data);
+
+/**
+ * @brief  Function that appends a row to a table. A new extent is allocated when the last block is full.
+ * @param *writer table writer
+ * @param *row row values in header order, like the rows returned by AK_table_cursor_next
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row could not be written
+ */
+int AK_table_writer_append(AK_table_writer *writer, struct list_node *row);
+
+/**
+ * @brief  Function that closes a table writer and releases its block
+ * @param *writer table writer, may be NULL
+ * @return No return value
+ */
+void AK_table_writer_close(AK_table_writer *writer);
+
 /**
  * @author Matija Šestak.
  * @brief  Function that converts tuple value to string
@@ -267,5 +363,7 @@ TestResult AK_table_test() ;
  */
 int AK_rename(char *old_table_name, char *old_attr, char *new_table_name, char *new_attr);
 TestResult AK_op_rename_test() ;
+TestResult AK_table_cursor_benchmark();
+TestResult AK_catalog_cache_test();
 
 #endif
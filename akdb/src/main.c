@@ -30,6 +30,7 @@
 #include "auxi/configuration.h"
 // Disk management
 #include "dm/dbman.h"
+#include "dm/page.h"
 // Memory management
 #include "mm/memoman.h"
 // File management
@@ -37,6 +38,7 @@
 #include "file/files.h"
 #include "file/filesearch.h"
 #include "file/filesort.h"
+#include "file/bulk_load.h"
 #include "file/table.h"
 #include "file/test.h"
 #include "file/sequence.h"
@@ -51,6 +53,10 @@
 #include "rel/intersect.h"
 #include "rel/nat_join.h"
 #include "rel/theta_join.h"
+#include "rel/hash_join.h"
+#include "rel/merge_join.h"
+#include "rel/iterator.h"
+#include "rel/set_op.h"
 #include "rel/projection.h"
 #include "rel/selection.h"
 #include "rel/union.h"
@@ -104,27 +110,38 @@ function fun[] = {
 //-------
 {"dm: AK_allocationbit", &AK_allocationbit_test}, //dm/dbman.c
 {"dm: AK_allocationtable", &AK_allocationtable_test}, //dm/dbman.c
+{"dm: AK_blocktable_flush", &AK_blocktable_flush_test}, //dm/dbman.c
+{"dm: AK_allocation_set", &AK_allocation_set_test}, //dm/dbman.c
 {"dm: AK_thread_safe_block_access", &AK_thread_safe_block_access_test}, //dm/dbman.c
+{"dm: AK_block_io_benchmark", &AK_block_io_benchmark}, //dm/dbman.c
+{"dm: AK_startup_benchmark", &AK_startup_benchmark}, //dm/dbman.c
+{"dm: AK_page", &AK_page_test}, //dm/page.c
 //file:
 //---------
 {"file: AK_id", &AK_id_test}, //file/id.c
 {"file: AK_lo", &AK_lo_test}, //file/blobs.c
 {"file: AK_files_test", &AK_files_test}, //file/files.c
 {"file: AK_fileio_test", &AK_fileio_test}, //file/fileio.c
+{"file: AK_fsm", &AK_fsm_test}, //file/fileio.c
+{"file: AK_bulk_load", &AK_bulk_load_test}, //file/bulk_load.c
 {"file: AK_op_rename", &AK_op_rename_test}, //file/table.c
 {"file: AK_filesort", &AK_filesort_test}, //file/filesort.c
 {"file: AK_filesearch", &AK_filesearch_test}, //file/filesearch.c
 {"file: AK_sequence", &AK_sequence_test}, //file/sequence.c 
 {"file: AK_op_table", &AK_table_test}, //file/table.c
+{"file: AK_table_cursor_benchmark", &AK_table_cursor_benchmark}, //file/table.c
+{"file: AK_catalog_cache", &AK_catalog_cache_test}, //file/table.c
 //file/idx:
 //-------------
 {"idx: AK_bitmap", &AK_bitmap_test}, //file/idx/bitmap.c
 {"idx: AK_btree", &AK_btree_test}, //file/idx/btree.c
 {"idx: AK_hash", &AK_hash_test}, //file/idx/hash.c
+{"idx: AK_hash_benchmark", &AK_hash_benchmark}, //file/idx/hash.c
 //mm:
 //-------
 {"mm: AK_memoman", &AK_memoman_test}, //mm/memoman.c
 {"mm: AK_block", &AK_memoman_test2}, //mm/memoman.c
+{"mm: AK_cache_concurrency", &AK_cache_concurrency_test}, //mm/memoman.c
 //opti:
 //---------
 {"opti: AK_rel_eq_assoc", &AK_rel_eq_assoc_test}, //opti/rel_eq_assoc.c
@@ -142,9 +159,15 @@ function fun[] = {
 {"rel: AK_op_selection", &AK_op_selection_test}, //rel/selection.c
 {"rel: AK_op_selection_pattern", &AK_op_selection_test_pattern}, //rel/selection.c with pattern match selections
 {"rel: AK_expression_check_test" , &AK_expression_check_test},
+{"rel: AK_expression_check_benchmark", &AK_expression_check_benchmark}, //rel/expression_check.c
 {"rel: AK_op_difference", &AK_op_difference_test}, //rel/difference.c
 {"rel: AK_op_projection", &AK_op_projection_test}, //rel/projection.c
 {"rel: AK_op_theta_join", &AK_op_theta_join_test}, //rel/theta_join.c
+{"rel: AK_hash_join", &AK_hash_join_test}, //rel/hash_join.c
+{"rel: AK_merge_join", &AK_merge_join_test}, //rel/merge_join.c
+{"rel: AK_iterator", &AK_iterator_test}, //rel/iterator.c
+{"rel: AK_iterator_batch_benchmark", &AK_iterator_batch_benchmark}, //rel/iterator.c
+{"rel: AK_set_op", &AK_set_op_test}, //rel/set_op.c
 //sql:
 //--------
 {"sql: AK_command", &AK_test_command}, //sql/command.c
@@ -188,6 +211,17 @@ int main(int argc, char * argv[])
     else if((argc == 3) && !strcmp(argv[1], "test") && !strcmp(argv[2], "show"))
 		//if we write ./akdb test test or show, the inputed will start and show
         show_test();
+    else if((argc == 4) && !strcmp(argv[1], "convert"))
+    {
+        //if we write ./akdb convert old.db new.db, the old DB file will be rewritten in the page format
+        AK_inflate_config();
+        if (AK_convert_db_file(argv[2], argv[3]) == EXIT_ERROR)
+        {
+            AK_destroy_critical_section(dbmanFileLock);
+            AK_EPI;
+            return ( EXIT_ERROR );
+        }
+    }
     else
     {
         printf( "KALASHNIKOV DB %s - STARTING\n\n", AK_version );
@@ -291,6 +325,7 @@ void help()
     printf("alltest - runs all tests at once\n");
     printf("test [test_id] - run akdb in testing mode\n");
     printf("test show - displays available tests\n");
+    printf("convert [old_file] [new_file] - converts a DB file to the page format\n");
     AK_EPI;
 }
 
@@ -348,7 +383,7 @@ void choose_test()
         printf("Test: ");
         scanf("%d", &ans);
         if(!ans) exit( EXIT_SUCCESS );
-        while(ans<0 || ans>52)
+        while(ans<0 || ans>(int)(sizeof(fun)/sizeof(fun[0])))
         {
             printf("\nTest: ");
             scanf("%d", &ans);
@@ -433,16 +468,16 @@ void testing (){
     while(ans<allTests){
 
         
-        if (ans==11||ans==10)
+        if (fun[ans].func == &AK_op_rename_test || fun[ans].func == &AK_fileio_test)
             {
                 AK_create_test_tables();
                 set_catalog_constraints();
             
             } 
-          if (ans==15)
+          if (fun[ans].func == &AK_table_test)
             {
               for ( i; i < 1; i++ ) {
-                  failedTests[i] = 15; 
+                  failedTests[i] = ans; 
                }
                i++;
                 ans++; //number of function
@@ -450,7 +485,11 @@ void testing (){
                 continue;
             }  
 
-             if (ans==14||ans==25||ans==34||ans==37||ans==42||ans==44||ans==45||ans==47||ans==49)
+             if (fun[ans].func == &AK_sequence_test || fun[ans].func == &AK_query_optimization_test ||
+                fun[ans].func == &AK_op_difference_test || fun[ans].func == &AK_test_command ||
+                fun[ans].func == &AK_trigger_test || fun[ans].func == &AK_function_test ||
+                fun[ans].func == &AK_privileges_test || fun[ans].func == &AK_constraint_between_test ||
+                fun[ans].func == &AK_constraint_names_test)
             {
                 //14 AK_btree_create -SIGSEGV
                 //25 AK_update_row_from_block -SIGSEGV
@@ -25,21 +25,90 @@
 #include "../dm/dbman.h"
 
 /**
-  * @author Nikola Bakoš, Matija Šestak(revised)
-  * @brief Function that caches a block into the memory.
+  * @brief Function that returns the hash table bucket of a block address
   * @param num block number (address)
-  * @param mem_block address of memmory block
-  * @return EXIT_SUCCESS if the block has been successfully read into memory, EXIT_ERROR otherwise
+  * @return pointer to the head of the bucket chain
  */
+static AK_mem_block **AK_cache_bucket(int num)
+{
+	return &db_cache->bucket[(unsigned int) num & (db_cache->num_buckets - 1)];
+}
 
-int AK_cache_block(int num, AK_mem_block *mem_block)
+/**
+  * @brief Function that returns the lock of the hash table partition a block address belongs to
+  * @param num block number (address)
+  * @return partition lock
+ */
+static pthread_mutex_t *AK_cache_partition_lock(int num)
+{
+	unsigned int bucket = (unsigned int) num & (db_cache->num_buckets - 1);
+	return &db_cache->partition_lock[bucket & (AK_CACHE_PARTITIONS - 1)];
+}
+
+/**
+  * @brief Function that finds a block in the cache hash table. The caller holds the partition lock of the address.
+  * @param num block number (address)
+  * @return cached block or NULL if the block is not cached
+ */
+static AK_mem_block *AK_cache_find(int num)
+{
+	AK_mem_block *mem_block = *AK_cache_bucket(num);
+
+	while (mem_block != NULL && mem_block->address != num)
+		mem_block = mem_block->next_in_bucket;
+	return mem_block;
+}
+
+/**
+  * @brief Function that registers a memory block in the cache hash table under a block address.
+  * The caller holds the replace lock and the partition lock of the address.
+  * @param mem_block memory block that is not registered
+  * @param num block number (address)
+ */
+static void AK_cache_register(AK_mem_block *mem_block, int num)
+{
+	AK_mem_block **bucket = AK_cache_bucket(num);
+
+	mem_block->address = num;
+	mem_block->next_in_bucket = *bucket;
+	*bucket = mem_block;
+}
+
+/**
+  * @brief Function that removes a memory block from the cache hash table.
+  * The caller holds the replace lock and the partition lock of the block address.
+  * @param mem_block registered memory block
+ */
+static void AK_cache_unregister(AK_mem_block *mem_block)
+{
+	AK_mem_block **link = AK_cache_bucket(mem_block->address);
+
+	while (*link != NULL && *link != mem_block)
+		link = &(*link)->next_in_bucket;
+	if (*link != NULL)
+		*link = mem_block->next_in_bucket;
+	mem_block->next_in_bucket = NULL;
+	mem_block->address = -1;
+}
+
+/**
+  * @brief Function that reads a block from disk into a memory block, replacing the block it held.
+  * The caller holds the memory block exclusively.
+  * @param num block number (address)
+  * @param mem_block memory block
+  * @return EXIT_SUCCESS if the block has been read, EXIT_ERROR otherwise
+ */
+static int AK_cache_read(int num, AK_mem_block *mem_block)
 {
 	unsigned long timestamp;
 	AK_block *block_cache;
 	AK_block *block_cache_old;
-	AK_PRO;
+
 	/// read the block from the given address
 	block_cache = AK_read_block(num);
+	if (block_cache == NULL)
+		return EXIT_ERROR;
+
 	block_cache_old = mem_block->block;
 	mem_block->block = block_cache;
 	mem_block->dirty = BLOCK_CLEAN; /// set dirty bit in mem_block struct
@@ -48,25 +117,82 @@ int AK_cache_block(int num, AK_mem_block *mem_block)
 	mem_block->timestamp_read = timestamp; /// set timestamp_read
 	mem_block->timestamp_last_change = timestamp; /// set timestamp_last_change
 
-	if(sizeof(block_cache) == NULL)
+	AK_free(block_cache_old);
+	return EXIT_SUCCESS;
+}
+
+/**
+  * @brief Function that looks up a block in the cache hash table without reading it from disk
+  * @param num block number (address)
+  * @return cached block or NULL if the block is not cached
+ */
+AK_mem_block *AK_cache_lookup(int num)
+{
+	AK_mem_block *mem_block;
+	pthread_mutex_t *lock = AK_cache_partition_lock(num);
+
+	pthread_mutex_lock(lock);
+	mem_block = AK_cache_find(num);
+	pthread_mutex_unlock(lock);
+	return mem_block;
+}
+
+/**
+  * @author Nikola Bakoš, Matija Šestak(revised)
+  * @brief Function that caches a block into the memory. The memory block is moved to the
+  * hash table bucket of its new address.
+  * @param num block number (address)
+  * @param mem_block address of memmory block
+  * @return EXIT_SUCCESS if the block has been successfully read into memory, EXIT_ERROR otherwise
+ */
+
+int AK_cache_block(int num, AK_mem_block *mem_block)
+{
+	pthread_mutex_t *lock;
+	AK_PRO;
+
+	/// a memory block that already holds a block is registered under the old address
+	pthread_mutex_lock(&db_cache->replace_lock);
+	if (mem_block->address != -1)
+	{
+		lock = AK_cache_partition_lock(mem_block->address);
+		pthread_mutex_lock(lock);
+		AK_cache_unregister(mem_block);
+		pthread_mutex_unlock(lock);
+	}
+	pthread_mutex_unlock(&db_cache->replace_lock);
+
+	pthread_rwlock_wrlock(&mem_block->latch);
+	if (AK_cache_read(num, mem_block) == EXIT_ERROR)
 	{
+		pthread_rwlock_unlock(&mem_block->latch);
 		AK_EPI;
 		return EXIT_ERROR;
 	}
+	pthread_rwlock_unlock(&mem_block->latch);
+
+	lock = AK_cache_partition_lock(num);
+	pthread_mutex_lock(&db_cache->replace_lock);
+	pthread_mutex_lock(lock);
+	mem_block->referenced = 1;
+	AK_cache_register(mem_block, num);
+	pthread_mutex_unlock(lock);
+	pthread_mutex_unlock(&db_cache->replace_lock);
 
-	AK_free(block_cache_old);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
 
 /**
   * @author Markus Schatten, Matija Šestak(revised)
-  * @brief Function that initializes the global cache memory (variable db_cache)
+  * @brief Function that initializes the global cache memory (variable db_cache). The number of cached
+  * blocks is read from the configuration (CACHE_MEMORY_BLOCKS); the first blocks of the DB file are
+  * cached right away and the remaining memory blocks are filled on demand.
   * @return EXIT_SUCCESS if the cache memory has been initialized, EXIT_ERROR otherwise
  */
 int AK_cache_AK_malloc()
 {
-	int i;
+	int i, preload;
 	AK_PRO;
 	if ((db_cache = (AK_db_cache *) AK_malloc(sizeof(AK_db_cache))) == NULL)
 	{
@@ -74,12 +200,46 @@ int AK_cache_AK_malloc()
 		return EXIT_ERROR;
 	}
 
-	db_cache->next_replace = -1;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	db_cache->size = CACHE_MEMORY_BLOCKS;
+	if (db_cache->size < 1)
+		db_cache->size = MAX_CACHE_MEMORY;
+	db_cache->used = 0;
+	db_cache->next_replace = 0;
+	db_cache->hits = db_cache->misses = db_cache->evictions = 0;
+	pthread_mutex_init(&db_cache->replace_lock, NULL);
+	for (i = 0; i < AK_CACHE_PARTITIONS; i++)
+		pthread_mutex_init(&db_cache->partition_lock[i], NULL);
+
+	/// twice as many buckets as memory blocks keeps the chains short
+	db_cache->num_buckets = 1;
+	while (db_cache->num_buckets < 2 * db_cache->size)
+		db_cache->num_buckets <<= 1;
+
+	db_cache->cache = (AK_mem_block **) AK_calloc(db_cache->size, sizeof(AK_mem_block *));
+	db_cache->bucket = (AK_mem_block **) AK_calloc(db_cache->num_buckets, sizeof(AK_mem_block *));
+	if (db_cache->cache == NULL || db_cache->bucket == NULL)
+	{
+		printf("AK_cache_AK_malloc: ERROR. Cannot allocate cache of %d blocks\n", db_cache->size);
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
+	for (i = 0; i < db_cache->size; i++)
 	{
-		db_cache->cache[ i ] = (AK_mem_block *) AK_malloc(sizeof(AK_mem_block));
-		db_cache->cache[ i ]->block = (AK_block *) AK_malloc(sizeof(AK_block));
+		db_cache->cache[ i ] = (AK_mem_block *) AK_calloc(1, sizeof(AK_mem_block));
+		db_cache->cache[ i ]->dirty = BLOCK_CLEAN;
+		db_cache->cache[ i ]->timestamp_read = -1;
+		db_cache->cache[ i ]->timestamp_last_change = -1;
+		db_cache->cache[ i ]->address = -1;
+		pthread_rwlock_init(&db_cache->cache[ i ]->latch, NULL);
+	}
+
+	preload = db_cache->size;
+	if (preload > AK_allocationbit->last_initialized)
+		preload = AK_allocationbit->last_initialized;
 
+	for (i = 0; i < preload; i++)
+	{
 		if ((AK_cache_block(i, db_cache->cache[ i ])) == EXIT_ERROR)
 		{
 			AK_EPI;
@@ -87,6 +247,7 @@ int AK_cache_AK_malloc()
 		}
 		//printf( "Cached block %d with address %d\n", i,  &db_cache->cache[ i ]->block->address );
 	}
+	db_cache->used = preload;
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -339,6 +500,13 @@ int AK_memoman_init()
 		return EXIT_ERROR;
 	}
 
+	if (AK_catalog_cache_init() == EXIT_ERROR)
+	{
+		printf("AK_memoman_init: ERROR. AK_catalog_cache_init() failed.\n");
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+
 
 	printf("AK_memoman_init: Memory manager initialized...\n");
 	AK_EPI;
@@ -350,132 +518,310 @@ int AK_memoman_init()
 /**
   * @author Tomislav Fotak, updated by Matija Šestak, Antonio Martinović
   * @brief Function that reads a block from the memory. If the block is cached, returns the cached block. Else uses AK_cache_block to read the block
-		to cache and then returns it.
+		to cache and then returns it. Cached blocks are found through the cache hash table, the memory block for a
+		new block is given by AK_release_oldest_cache_block. The returned block is not pinned, concurrent users
+		should use AK_pin_block instead.
   * @param num block number (address)
   * @return segment start address
  */
 AK_mem_block *AK_get_block(int num)
 {
-	int i = 0;
-	int free_pos = 0;
-	int first_AK_free_mem_block = -1;
+	AK_mem_block *mem_block;
 	AK_PRO;
 
-	/* search cache for already-cached block */
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	mem_block = AK_pin_block(num);
+	if (mem_block == NULL)
 	{
-		if (db_cache->cache[i]->block->address == num)
-		{
-			/// found cached! we're done here
-			AK_EPI;
+		/// no cache for you
+		AK_EPI;
+		exit(EXIT_ERROR);
+	}
+	AK_unpin_block(mem_block);
 
-			return db_cache->cache[i];
-		}
+	AK_EPI;
+	return mem_block;
+}
 
-	}
+/**
+ * @brief Function that takes a memory block out of the replacement. While the cache is not full, the first
+ * empty memory block is taken, otherwise the CLOCK hand looks for an unpinned block that has not been accessed
+ * since the hand last passed it. A dirty victim is written to disk while it is still registered, so a concurrent
+ * reader can never read the stale copy from disk.
+ * @return index of the taken memory block, which is pinned once and not registered; EXIT_ERROR if every block is pinned
+ */
+static int AK_claim_cache_block()
+{
+	int index;
+	int pinned;
+	int clean;
+	AK_mem_block *mem_block;
+	AK_mem_block *victim;
+	pthread_mutex_t *lock;
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	for (;;)
 	{
-		/// while looking for block we also want to find an empty block
-		/// in case that the actual block is not found
-		/// then there is no need to run through the blocks twice
-		if (first_AK_free_mem_block == -1 && db_cache->cache[i]->timestamp_read == -1)
+		pthread_mutex_lock(&db_cache->replace_lock);
+		/// while the cache is not full there is nothing to replace
+		if (db_cache->used < db_cache->size)
 		{
-			first_AK_free_mem_block = i;
+			index = db_cache->used++;
+			db_cache->cache[index]->pin_count = 1;
+			pthread_mutex_unlock(&db_cache->replace_lock);
+			return index;
 		}
 
-	}
+		/// the hand clears reference bits as it goes, so it stops within two rounds unless all blocks are pinned
+		victim = NULL;
+		clean = 1;
+		for (pinned = 0; victim == NULL && pinned < db_cache->size; )
+		{
+			index = db_cache->next_replace;
+			mem_block = db_cache->cache[index];
+			db_cache->next_replace = (index + 1) % db_cache->size;
 
-	if (first_AK_free_mem_block != -1)
-	{
-		if (AK_cache_block(num, db_cache->cache[ first_AK_free_mem_block ]) == EXIT_SUCCESS)
+			if (mem_block->address == -1)
+			{
+				/// a block that lost a concurrent read of the same address is free right away
+				if (mem_block->pin_count == 0)
+				{
+					mem_block->pin_count = 1;
+					victim = mem_block;
+				}
+				else
+					pinned++;
+				continue;
+			}
+
+			lock = AK_cache_partition_lock(mem_block->address);
+			pthread_mutex_lock(lock);
+			if (mem_block->pin_count > 0)
+				pinned++;
+			else if (mem_block->referenced)
+			{
+				mem_block->referenced = 0;
+				pinned = 0;
+			}
+			else
+			{
+				mem_block->pin_count = 1;
+				clean = mem_block->dirty != BLOCK_DIRTY;
+				if (clean)
+				{
+					AK_cache_unregister(mem_block);
+					db_cache->evictions++;
+				}
+				victim = mem_block;
+			}
+			pthread_mutex_unlock(lock);
+		}
+		pthread_mutex_unlock(&db_cache->replace_lock);
+
+		if (victim == NULL)
 		{
-			/// created new cache block for specified address
-			AK_EPI;
+			printf("AK_claim_cache_block: ERROR. All %d cached blocks are pinned\n", db_cache->size);
+			return EXIT_ERROR;
+		}
+		if (clean)
+			return index;
 
-			return db_cache->cache[first_AK_free_mem_block];
+		pthread_rwlock_rdlock(&victim->latch);
+		if (AK_write_block(victim->block) != EXIT_SUCCESS)
+		{
+			pthread_rwlock_unlock(&victim->latch);
+			AK_unpin_block(victim);
+			return EXIT_ERROR;
+		}
+		/// block is clean after successfuly writing it to disk
+		victim->dirty = BLOCK_CLEAN;
+		pthread_rwlock_unlock(&victim->latch);
+
+		pthread_mutex_lock(&db_cache->replace_lock);
+		lock = AK_cache_partition_lock(victim->address);
+		pthread_mutex_lock(lock);
+		/// somebody else started using the block while it was written, it stays cached
+		clean = victim->pin_count == 1 && victim->dirty != BLOCK_DIRTY;
+		if (clean)
+		{
+			AK_cache_unregister(victim);
+			db_cache->evictions++;
 		}
+		else
+			victim->pin_count--;
+		pthread_mutex_unlock(lock);
+		pthread_mutex_unlock(&db_cache->replace_lock);
+
+		if (clean)
+			return index;
 	}
+}
+
+/**
+ * @brief Function that reads a block into the cache and pins it, so it cannot be replaced until it is unpinned.
+ * Only one thread reads a missing block from disk; the others wait on its latch until the block is read.
+ * @param num block number (address)
+ * @return pinned cached block, NULL if no memory block could be freed
+ */
+AK_mem_block *AK_pin_block(int num)
+{
+	int index;
+	AK_mem_block *mem_block;
+	AK_mem_block *free_block;
+	pthread_mutex_t *lock = AK_cache_partition_lock(num);
+	AK_PRO;
 
-	/// no free cache blocks found, we need to clear some now
-	free_pos = AK_release_oldest_cache_block();
+	/* search cache for already-cached block */
+	pthread_mutex_lock(lock);
+	mem_block = AK_cache_find(num);
+	if (mem_block != NULL)
+	{
+		mem_block->pin_count++;
+		mem_block->referenced = 1;
+		pthread_mutex_unlock(lock);
+		__sync_fetch_and_add(&db_cache->hits, 1);
+
+		/// wait until the block is read if somebody is still reading it
+		pthread_rwlock_rdlock(&mem_block->latch);
+		pthread_rwlock_unlock(&mem_block->latch);
+		AK_EPI;
+		return mem_block;
+	}
+	pthread_mutex_unlock(lock);
+	__sync_fetch_and_add(&db_cache->misses, 1);
 
-	if(free_pos == EXIT_ERROR)
+	/// returns an empty memory block while there is one, otherwise clears some now
+	index = AK_claim_cache_block();
+	if (index == EXIT_ERROR)
 	{
-		/// no cache for you
 		AK_EPI;
-		exit(EXIT_ERROR);
+		return NULL;
 	}
+	free_block = db_cache->cache[index];
 
-	if (AK_cache_block(num, db_cache->cache[ free_pos ]) == EXIT_SUCCESS)
+	pthread_mutex_lock(&db_cache->replace_lock);
+	pthread_mutex_lock(lock);
+	mem_block = AK_cache_find(num);
+	if (mem_block != NULL)
 	{
+		/// another thread cached the block in the meantime, the claimed memory block stays free
+		mem_block->pin_count++;
+		mem_block->referenced = 1;
+		free_block->pin_count = 0;
+		pthread_mutex_unlock(lock);
+		pthread_mutex_unlock(&db_cache->replace_lock);
+
+		pthread_rwlock_rdlock(&mem_block->latch);
+		pthread_rwlock_unlock(&mem_block->latch);
 		AK_EPI;
-		return db_cache->cache[ free_pos ];
+		return mem_block;
 	}
 
+	/// the block is registered before it is read so concurrent requests wait for this read
+	pthread_rwlock_wrlock(&free_block->latch);
+	free_block->referenced = 1;
+	AK_cache_register(free_block, num);
+	pthread_mutex_unlock(lock);
+	pthread_mutex_unlock(&db_cache->replace_lock);
+
+	if (AK_cache_read(num, free_block) == EXIT_ERROR)
+	{
+		pthread_rwlock_unlock(&free_block->latch);
+		AK_unpin_block(free_block);
+		AK_EPI;
+		return NULL;
+	}
+	pthread_rwlock_unlock(&free_block->latch);
 
 	AK_EPI;
-	return NULL;
+	return free_block;
 }
 
 /**
- * @author Antonio Martinović
- * @brief Functions that flushes the oldest block to disk and recalculates the next block to remove
- * @return index of flushed cache block
+ * @brief Function that releases a pin taken with AK_pin_block
+ * @param mem_block pinned cached block
  */
-int AK_release_oldest_cache_block() {
-	int i;
-	int min = 0;
-	int block_written;
-	int oldest_block = db_cache->next_replace;
-	AK_block *data_block;
-
-	AK_PRO;
+void AK_unpin_block(AK_mem_block *mem_block)
+{
+	pthread_mutex_t *lock = AK_cache_partition_lock(mem_block->address);
 
-	if (oldest_block == -1) {
-		for (i = 0; i < MAX_CACHE_MEMORY; i++)
-		{
+	pthread_mutex_lock(lock);
+	mem_block->pin_count--;
+	pthread_mutex_unlock(lock);
+}
 
-			if (db_cache->cache[i]->timestamp_read != -1 &&
-				db_cache->cache[i]->timestamp_read < db_cache->cache[ min ]->timestamp_read)
-			{
-				min = i;
-			}
-		}
-		oldest_block = min;
-	}
+/**
+ * @brief Function that latches a pinned cached block
+ * @param mem_block pinned cached block
+ * @param mode AK_LATCH_SHARED for reading, AK_LATCH_EXCLUSIVE for changing the block
+ */
+void AK_latch_block(AK_mem_block *mem_block, int mode)
+{
+	if (mode == AK_LATCH_EXCLUSIVE)
+		pthread_rwlock_wrlock(&mem_block->latch);
+	else
+		pthread_rwlock_rdlock(&mem_block->latch);
+}
 
+/**
+ * @brief Function that releases the latch taken with AK_latch_block
+ * @param mem_block latched cached block
+ */
+void AK_unlatch_block(AK_mem_block *mem_block)
+{
+	pthread_rwlock_unlock(&mem_block->latch);
+}
 
-	if (db_cache->cache[oldest_block]->dirty == BLOCK_DIRTY)
-	{
-		data_block = db_cache->cache[oldest_block]->block;
-		block_written = AK_write_block(data_block);
-		/// if block form cache can not be writed to DB file -> EXIT_ERROR
-		if (block_written != EXIT_SUCCESS)
-		{
-			AK_EPI;
-			return EXIT_ERROR;
-		}
-		/// block is clean after successfuly writing it to disk
-		db_cache->cache[oldest_block]->dirty = BLOCK_CLEAN;
-	}
+/**
+ * @brief Function that replaces the cached copy of a block with the block written straight to the DB file.
+ * Extent allocation and deletion write blocks without going through the cache, a stale dirty copy would
+ * otherwise be flushed over the block later.
+ * @param block block as written to the DB file
+ */
+void AK_cache_refresh_block(AK_block *block)
+{
+	AK_mem_block *mem_block;
+	pthread_mutex_t *lock;
+
+	if (db_cache == NULL || db_cache->bucket == NULL)
+		return;
+
+	lock = AK_cache_partition_lock(block->address);
+	pthread_mutex_lock(lock);
+	mem_block = AK_cache_find(block->address);
+	if (mem_block != NULL)
+		mem_block->pin_count++;
+	pthread_mutex_unlock(lock);
+	if (mem_block == NULL)
+		return;
+
+	pthread_rwlock_wrlock(&mem_block->latch);
+	memcpy(mem_block->block, block, sizeof (AK_block));
+	mem_block->dirty = BLOCK_CLEAN;
+	pthread_rwlock_unlock(&mem_block->latch);
+	AK_unpin_block(mem_block);
+}
 
-	db_cache->cache[oldest_block]->timestamp_read = clock();
+/**
+ * @author Antonio Martinović
+ * @brief Functions that picks the next block to replace with the CLOCK algorithm, flushes it to disk if dirty
+ * and moves the clock hand past it. Blocks accessed since the hand last passed them get a second chance and
+ * pinned blocks are skipped. While the cache is not full, the first empty memory block is returned instead.
+ * The returned memory block is no longer registered in the cache hash table.
+ * @return index of flushed cache block, EXIT_ERROR if every block is pinned
+ */
+int AK_release_oldest_cache_block() {
+	int index;
 
-	min = 0;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	AK_PRO;
+	index = AK_claim_cache_block();
+	if (index != EXIT_ERROR)
 	{
-		if (db_cache->cache[i]->timestamp_read != -1 &&
-			db_cache->cache[i]->timestamp_read < db_cache->cache[ min ]->timestamp_read)
-		{
-			min = i;
-		}
+		pthread_mutex_lock(&db_cache->replace_lock);
+		db_cache->cache[index]->pin_count = 0;
+		pthread_mutex_unlock(&db_cache->replace_lock);
 	}
-	db_cache->next_replace = min;
-
 	AK_EPI;
 
-	return oldest_block;
+	return index;
 }
 
 /**
@@ -502,17 +848,20 @@ int AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
 int AK_refresh_cache()
 {
 	int i;
-	AK_block *new_block;
-	AK_block *old_block;
+	AK_mem_block *mem_block;
 
 	AK_PRO;
-	for (i = 0; i < MAX_CACHE_MEMORY; i++)
+	for (i = 0; i < db_cache->used; i++)
 	{
-		new_block = AK_read_block(db_cache->cache[i]->block->address);
-		old_block = db_cache->cache[i]->block;
-		db_cache->cache[i]->block = new_block;
-		AK_free(old_block);
+		mem_block = db_cache->cache[i];
+		if (mem_block->address == -1)
+			continue;
+		pthread_rwlock_wrlock(&mem_block->latch);
+		AK_cache_read(mem_block->address, mem_block);
+		pthread_rwlock_unlock(&mem_block->latch);
 	}
+	//the blocks on disk may hold another catalog
+	AK_catalog_invalidate_all();
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
@@ -555,93 +904,580 @@ table_addresses *AK_get_segment_addresses(char * segmentName)
 	return addresses;
 }
 
+/**
+ * @brief Function for getting the addresses of a segment from the system table its type is registered in. Index
+ * segments are looked up in AK_index first, hash indexes are registered in AK_relation.
+ * @param segmentName segment name
+ * @param type segment type
+ * @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
+ */
+table_addresses *AK_get_segment_addresses_by_type(char *segmentName, int type)
+{
+	table_addresses *addresses;
+	AK_PRO;
+
+	if (type == SEGMENT_TYPE_INDEX)
+	{
+		addresses = AK_get_index_segment_addresses(segmentName);
+		if (addresses->address_from[0] != 0)
+		{
+			AK_EPI;
+			return addresses;
+		}
+		AK_free(addresses);
+	}
+	addresses = AK_get_segment_addresses(segmentName);
+	AK_EPI;
+	return addresses;
+}
+
 /**
 * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
-* @brief Function for getting addresses of some table
+* @brief Function for getting addresses of some table. The addresses are served from the catalog cache.
 * @param tableName table name that you search for
 * @param segmentName segment name
 * @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
 */
 table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmentName)
 {
-	int i = 0;
-	int AK_freeVar = 0;
-	int address_sys;
-	AK_mem_block *mem_block;
+	table_addresses *addresses;
 
 	AK_PRO;
-
 	AK_dbg_messg(HIGH, MEMO_MAN,"get_segment_addresses: Serching for %s table \n", tableName);
-	address_sys = AK_get_system_table_address(tableName);
-	mem_block = AK_get_block(address_sys);
-	table_addresses * addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
+	addresses = (table_addresses *) AK_malloc(sizeof (table_addresses));
+	AK_catalog_get_addresses(tableName, segmentName, addresses);
+	AK_EPI;
+	return addresses;
+}
+
+/**
+ * @brief Function that computes the FNV-1a hash of a segment name
+ * @param name segment name
+ * @return hash of the name
+ */
+static unsigned int AK_catalog_hash(char *name)
+{
+	unsigned int hash = 2166136261u;
 
-	for (AK_freeVar = 0; AK_freeVar < MAX_EXTENTS_IN_SEGMENT; AK_freeVar++)
+	while (*name)
 	{
-		addresses->address_from[AK_freeVar] = 0;
-		addresses->address_to[AK_freeVar] = 0;
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619u;
 	}
-	char name[MAX_VARCHAR_LENGTH];
-	int address_from;
-	int address_to;
-	int j = 0;
-	for (i = 0; i < DATA_BLOCK_SIZE; i++)
-	{
-		if (mem_block->block->tuple_dict[i].type == FREE_INT)
-			break;
-		if ( (mem_block->block->last_tuple_dict_id) <= i )
-			break;
-		i++;
-		memcpy(name, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		name[ mem_block->block->tuple_dict[i].size] = '\0';
-		i++;
-		memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		i++;
-		memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), mem_block->block->tuple_dict[i].size);
-		//if found the table that addresses we need
-		if (strcmp(name, segmentName) == 0)
-		{
-			addresses->address_from[j] = address_from;
-			addresses->address_to[j] = address_to;
-			j++;
-			AK_dbg_messg(HIGH, MEMO_MAN, "get_segment_addresses(%s): Found addresses of searching segment: %d , %d \n", name, address_from, address_to);
-		}
+	return hash;
+}
 
+/**
+ * @brief Function that appends an extent read from a catalog row to a catalog entry
+ * @param entry catalog entry
+ * @param obj_id obj_id of the row, kept from the first row only
+ * @param address_from start address of the extent
+ * @param address_to end address of the extent
+ */
+static void AK_catalog_add_extent(AK_catalog_entry *entry, int obj_id, int address_from, int address_to)
+{
+	if (entry->num_extents == 0)
+		entry->obj_id = obj_id;
+	if (entry->num_extents < MAX_EXTENTS_IN_SEGMENT)
+	{
+		entry->addresses.address_from[entry->num_extents] = address_from;
+		entry->addresses.address_to[entry->num_extents] = address_to;
+		entry->num_extents++;
 	}
-	AK_EPI;
-	return addresses;
 }
 
 /**
- * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
- * @brief Function that gets the address of a system table by name
- * @param name of system table
- * @return table address
+ * @brief Function that finds a cached catalog entry, the catalog cache lock has to be held
+ * @param sys_table system catalog table of the segment
+ * @param name segment name
+ * @param hash hash of the name
+ * @return catalog entry, NULL if it is not cached
  */
-int AK_get_system_table_address(const char *name) {
-	int i;
-	int data_adr = 0;
-	int data_size = 0;
-	int address_sys;
-	char name_sys[MAX_ATT_NAME];
+static AK_catalog_entry *AK_catalog_find(char *sys_table, char *name, unsigned int hash)
+{
+	AK_catalog_entry *entry;
 
-	AK_PRO;
+	for (entry = catalog_cache->bucket[hash & (catalog_cache->num_buckets - 1)]; entry != NULL; entry = entry->next)
+		if (entry->hash == hash && strcmp(entry->name, name) == 0 && strcmp(entry->sys_table, sys_table) == 0)
+			return entry;
+	return NULL;
+}
 
-	AK_mem_block *mem_block = AK_get_block(0);
+/**
+ * @brief Function that creates an empty catalog entry and adds it to the cache, the catalog cache lock has to be
+ * held. The hash table is doubled when it holds more entries than buckets.
+ * @param sys_table system catalog table of the segment
+ * @param name segment name
+ * @param hash hash of the name
+ * @return new catalog entry
+ */
+static AK_catalog_entry *AK_catalog_add(char *sys_table, char *name, unsigned int hash)
+{
+	AK_catalog_entry *entry, *next;
+	AK_catalog_entry **bucket;
+	int i, num_buckets;
 
-	for (i = 0; i < DATA_BLOCK_SIZE; i++)
+	if (catalog_cache->num_entries >= catalog_cache->num_buckets)
 	{
-		memset(name_sys, 0, MAX_ATT_NAME);
-		if (mem_block->block->tuple_dict[i].address == FREE_INT)
+		num_buckets = catalog_cache->num_buckets * 2;
+		bucket = (AK_catalog_entry **) AK_calloc(num_buckets, sizeof (AK_catalog_entry *));
+		for (i = 0; i < catalog_cache->num_buckets; i++)
 		{
-			break;
+			for (entry = catalog_cache->bucket[i]; entry != NULL; entry = next)
+			{
+				next = entry->next;
+				entry->next = bucket[entry->hash & (num_buckets - 1)];
+				bucket[entry->hash & (num_buckets - 1)] = entry;
+			}
 		}
+		AK_free(catalog_cache->bucket);
+		catalog_cache->bucket = bucket;
+		catalog_cache->num_buckets = num_buckets;
+	}
 
-		data_adr = mem_block->block->tuple_dict[i].address;
-		data_size = mem_block->block->tuple_dict[i].size;
-		memcpy(name_sys, mem_block->block->data + data_adr, data_size);
-		i++;
-		data_adr = mem_block->block->tuple_dict[i].address;
+	entry = (AK_catalog_entry *) AK_calloc(1, sizeof (AK_catalog_entry));
+	strncpy(entry->sys_table, sys_table, MAX_VARCHAR_LENGTH - 1);
+	strncpy(entry->name, name, MAX_VARCHAR_LENGTH - 1);
+	entry->hash = hash;
+	entry->num_attr = -1;
+	entry->next = catalog_cache->bucket[hash & (catalog_cache->num_buckets - 1)];
+	catalog_cache->bucket[hash & (catalog_cache->num_buckets - 1)] = entry;
+	catalog_cache->num_entries++;
+	return entry;
+}
+
+/**
+ * @brief Function that reads the rows of a system catalog table. The system table is filled block by block
+ * (AK_find_AK_free_space), so its rows end at the first empty block.
+ * @param sys_table system catalog table (AK_relation or AK_index)
+ * @param name segment name whose rows are appended to single; NULL to add the rows of all segments to the catalog
+ * cache, which has to be locked
+ * @param single catalog entry for the rows of name
+ */
+static void AK_catalog_scan(char *sys_table, char *name, AK_catalog_entry *single)
+{
+	int i, block, num_attr;
+	int address_sys;
+	int obj_id, address_from, address_to;
+	char row_name[MAX_VARCHAR_LENGTH];
+	AK_mem_block *mem_block;
+	AK_catalog_entry *entry;
+	unsigned int hash;
+
+	address_sys = AK_get_system_table_address(sys_table);
+	for (block = address_sys; block < address_sys + INITIAL_EXTENT_SIZE; block++)
+	{
+		mem_block = AK_get_block(block);
+		if (mem_block == NULL || mem_block->block->AK_free_space == 0)
+			break;
+		//AK_index rows also hold the indexed table and attribute after the four columns read here
+		for (num_attr = 0; num_attr < MAX_ATTRIBUTES && mem_block->block->header[num_attr].att_name[0] != '\0'; num_attr++)
+			;
+		if (num_attr < 4)
+			break;
+		for (i = 0; i + 3 < DATA_BLOCK_SIZE; i += num_attr)
+		{
+			if (mem_block->block->tuple_dict[i].type == FREE_INT)
+				break;
+			if (mem_block->block->last_tuple_dict_id <= i)
+				break;
+			obj_id = address_from = address_to = 0;
+			if (mem_block->block->tuple_dict[i].size == sizeof (int))
+				memcpy(&obj_id, &(mem_block->block->data[mem_block->block->tuple_dict[i].address]), sizeof (int));
+			memcpy(row_name, &(mem_block->block->data[mem_block->block->tuple_dict[i + 1].address]), mem_block->block->tuple_dict[i + 1].size);
+			row_name[mem_block->block->tuple_dict[i + 1].size] = '\0';
+			memcpy(&address_from, &(mem_block->block->data[mem_block->block->tuple_dict[i + 2].address]), mem_block->block->tuple_dict[i + 2].size);
+			memcpy(&address_to, &(mem_block->block->data[mem_block->block->tuple_dict[i + 3].address]), mem_block->block->tuple_dict[i + 3].size);
+
+			if (name != NULL)
+			{
+				if (strcmp(row_name, name) == 0)
+					AK_catalog_add_extent(single, obj_id, address_from, address_to);
+				continue;
+			}
+			//deleted rows have an empty name
+			if (row_name[0] == '\0')
+				continue;
+			hash = AK_catalog_hash(row_name);
+			entry = AK_catalog_find(sys_table, row_name, hash);
+			if (entry == NULL)
+				entry = AK_catalog_add(sys_table, row_name, hash);
+			AK_catalog_add_extent(entry, obj_id, address_from, address_to);
+		}
+	}
+}
+
+/**
+ * @brief Function that looks up the catalog entry of a segment and locks the catalog cache; it has to be followed by
+ * AK_catalog_release. On a miss the entry is read from the system catalog and cached. Before the catalog cache is
+ * initialized the entry is read into tmp instead.
+ * @param sys_table system catalog table of the segment
+ * @param name segment name
+ * @param tmp catalog entry used when there is no catalog cache
+ * @return catalog entry, NULL if the segment does not exist
+ */
+static AK_catalog_entry *AK_catalog_lookup(char *sys_table, char *name, AK_catalog_entry *tmp)
+{
+	AK_catalog_entry *entry;
+	unsigned int hash;
+
+	if (catalog_cache == NULL)
+	{
+		memset(tmp, 0, sizeof (AK_catalog_entry));
+		tmp->num_attr = -1;
+		AK_catalog_scan(sys_table, name, tmp);
+		return tmp->num_extents > 0 ? tmp : NULL;
+	}
+
+	hash = AK_catalog_hash(name);
+	pthread_mutex_lock(&catalog_cache->lock);
+	entry = AK_catalog_find(sys_table, name, hash);
+	if (entry != NULL)
+	{
+		catalog_cache->hits++;
+		return entry;
+	}
+
+	catalog_cache->misses++;
+	memset(tmp, 0, sizeof (AK_catalog_entry));
+	AK_catalog_scan(sys_table, name, tmp);
+	//segments that do not exist are not cached, the next lookup scans the catalog again
+	if (tmp->num_extents == 0)
+		return NULL;
+	entry = AK_catalog_add(sys_table, name, hash);
+	entry->obj_id = tmp->obj_id;
+	entry->num_extents = tmp->num_extents;
+	memcpy(&entry->addresses, &tmp->addresses, sizeof (table_addresses));
+	return entry;
+}
+
+/**
+ * @brief Function that ends the use of an entry returned by AK_catalog_lookup
+ * @param tmp catalog entry passed to AK_catalog_lookup
+ */
+static void AK_catalog_release(AK_catalog_entry *tmp)
+{
+	if (catalog_cache == NULL)
+	{
+		if (tmp->header != NULL)
+			AK_free(tmp->header);
+		return;
+	}
+	pthread_mutex_unlock(&catalog_cache->lock);
+}
+
+/**
+ * @brief Function that reads the header of a cached segment from its first block, if it has not been read yet
+ * @param entry catalog entry
+ * @return number of attributes, EXIT_WARNING if the segment has no extents
+ */
+static int AK_catalog_schema(AK_catalog_entry *entry)
+{
+	AK_mem_block *mem_block;
+	int num_attr = 0;
+
+	if (entry->addresses.address_from[0] == 0)
+		return EXIT_WARNING;
+	if (entry->num_attr >= 0)
+		return entry->num_attr;
+
+	mem_block = AK_get_block(entry->addresses.address_from[0]);
+	while (num_attr < MAX_ATTRIBUTES && strcmp(mem_block->block->header[num_attr].att_name, "\0") != 0)
+		num_attr++;
+	entry->header = (AK_header *) AK_calloc(num_attr > 0 ? num_attr : 1, sizeof (AK_header));
+	memcpy(entry->header, mem_block->block->header, num_attr * sizeof (AK_header));
+	entry->num_attr = num_attr;
+	return num_attr;
+}
+
+/**
+ * @brief Function that frees a catalog entry
+ * @param entry catalog entry
+ */
+static void AK_catalog_free_entry(AK_catalog_entry *entry)
+{
+	if (entry->header != NULL)
+		AK_free(entry->header);
+	AK_free(entry);
+}
+
+/**
+ * @brief Function that initializes the system catalog cache (variable catalog_cache) and loads the entries of all
+ * tables and indexes from the AK_relation and AK_index system tables
+ * @return EXIT_SUCCESS if the catalog cache has been initialized, EXIT_ERROR otherwise
+ */
+int AK_catalog_cache_init()
+{
+	AK_PRO;
+	if (catalog_cache != NULL)
+	{
+		AK_catalog_invalidate_all();
+	}
+	else
+	{
+		catalog_cache = (AK_catalog_cache *) AK_calloc(1, sizeof (AK_catalog_cache));
+		if (catalog_cache == NULL)
+		{
+			AK_EPI;
+			return EXIT_ERROR;
+		}
+		catalog_cache->num_buckets = AK_CATALOG_BUCKETS;
+		catalog_cache->bucket = (AK_catalog_entry **) AK_calloc(AK_CATALOG_BUCKETS, sizeof (AK_catalog_entry *));
+		if (catalog_cache->bucket == NULL)
+		{
+			AK_free(catalog_cache);
+			catalog_cache = NULL;
+			AK_EPI;
+			return EXIT_ERROR;
+		}
+		pthread_mutex_init(&catalog_cache->lock, NULL);
+	}
+
+	pthread_mutex_lock(&catalog_cache->lock);
+	AK_catalog_scan("AK_relation", NULL, NULL);
+	AK_catalog_scan("AK_index", NULL, NULL);
+	AK_dbg_messg(LOW, MEMO_MAN, "AK_catalog_cache_init: %d catalog entries loaded\n", catalog_cache->num_entries);
+	pthread_mutex_unlock(&catalog_cache->lock);
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Function that drops the cached catalog entries of a table or index. It has to be called after every change
+ * of the catalog rows or of the header of the segment.
+ * @param name name of the table or index
+ */
+void AK_catalog_invalidate(char *name)
+{
+	AK_catalog_entry **link, *entry;
+	unsigned int hash;
+
+	AK_PRO;
+	if (catalog_cache == NULL || name == NULL)
+	{
+		AK_EPI;
+		return;
+	}
+	hash = AK_catalog_hash(name);
+	pthread_mutex_lock(&catalog_cache->lock);
+	link = &catalog_cache->bucket[hash & (catalog_cache->num_buckets - 1)];
+	while ((entry = *link) != NULL)
+	{
+		if (entry->hash == hash && strcmp(entry->name, name) == 0)
+		{
+			*link = entry->next;
+			AK_catalog_free_entry(entry);
+			catalog_cache->num_entries--;
+		}
+		else
+			link = &entry->next;
+	}
+	catalog_cache->version++;
+	pthread_mutex_unlock(&catalog_cache->lock);
+	AK_EPI;
+}
+
+/**
+ * @brief Function that drops all cached catalog entries
+ */
+void AK_catalog_invalidate_all()
+{
+	AK_catalog_entry *entry, *next;
+	int i;
+
+	AK_PRO;
+	if (catalog_cache == NULL)
+	{
+		AK_EPI;
+		return;
+	}
+	pthread_mutex_lock(&catalog_cache->lock);
+	for (i = 0; i < catalog_cache->num_buckets; i++)
+	{
+		for (entry = catalog_cache->bucket[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			AK_catalog_free_entry(entry);
+		}
+		catalog_cache->bucket[i] = NULL;
+	}
+	catalog_cache->num_entries = 0;
+	catalog_cache->version++;
+	pthread_mutex_unlock(&catalog_cache->lock);
+	AK_EPI;
+}
+
+/**
+ * @brief Function that returns the version of the catalog cache, which changes whenever entries are invalidated
+ * @return catalog cache version
+ */
+unsigned long AK_catalog_version()
+{
+	unsigned long version = 0;
+
+	AK_PRO;
+	if (catalog_cache != NULL)
+	{
+		pthread_mutex_lock(&catalog_cache->lock);
+		version = catalog_cache->version;
+		pthread_mutex_unlock(&catalog_cache->lock);
+	}
+	AK_EPI;
+	return version;
+}
+
+/**
+ * @brief Function that copies the extent addresses of a table or index from the catalog cache
+ * @param sys_table system catalog table of the segment (AK_relation or AK_index)
+ * @param name name of the table or index
+ * @param addresses extent addresses, all zero if the segment does not exist
+ * @return EXIT_SUCCESS if the segment exists, EXIT_WARNING otherwise
+ */
+int AK_catalog_get_addresses(char *sys_table, char *name, table_addresses *addresses)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	int result = EXIT_WARNING;
+
+	AK_PRO;
+	memset(addresses, 0, sizeof (table_addresses));
+	entry = AK_catalog_lookup(sys_table, name, &tmp);
+	if (entry != NULL)
+	{
+		memcpy(addresses->address_from, entry->addresses.address_from, entry->num_extents * sizeof (int));
+		memcpy(addresses->address_to, entry->addresses.address_to, entry->num_extents * sizeof (int));
+		result = EXIT_SUCCESS;
+	}
+	AK_catalog_release(&tmp);
+	AK_EPI;
+	return result;
+}
+
+/**
+ * @brief Function that returns the obj_id of a table from the catalog cache
+ * @param name table name
+ * @return obj_id of the table, EXIT_ERROR if there is no table with that name
+ */
+int AK_catalog_get_obj_id(char *name)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	int obj_id = EXIT_ERROR;
+
+	AK_PRO;
+	entry = AK_catalog_lookup("AK_relation", name, &tmp);
+	if (entry != NULL)
+		obj_id = entry->obj_id;
+	AK_catalog_release(&tmp);
+	AK_EPI;
+	return obj_id;
+}
+
+/**
+ * @brief Function that returns the number of attributes of a table from the catalog cache
+ * @param name table name
+ * @return number of attributes, EXIT_WARNING if the table has no extents
+ */
+int AK_catalog_get_num_attr(char *name)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	int num_attr = EXIT_WARNING;
+
+	AK_PRO;
+	entry = AK_catalog_lookup("AK_relation", name, &tmp);
+	if (entry != NULL)
+		num_attr = AK_catalog_schema(entry);
+	AK_catalog_release(&tmp);
+	AK_EPI;
+	return num_attr;
+}
+
+/**
+ * @brief Function that returns a copy of the table header from the catalog cache
+ * @param name table name
+ * @return header of the table allocated with AK_calloc, NULL if the table has no extents
+ */
+AK_header *AK_catalog_get_header(char *name)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	AK_header *header = NULL;
+	int num_attr;
+
+	AK_PRO;
+	entry = AK_catalog_lookup("AK_relation", name, &tmp);
+	if (entry != NULL && (num_attr = AK_catalog_schema(entry)) >= 0)
+	{
+		header = (AK_header *) AK_calloc(num_attr, sizeof (AK_header));
+		memcpy(header, entry->header, num_attr * sizeof (AK_header));
+	}
+	AK_catalog_release(&tmp);
+	AK_EPI;
+	return header;
+}
+
+/**
+ * @brief Function that returns the zero-based index of an attribute from the catalog cache
+ * @param name table name
+ * @param attr attribute name
+ * @return index of the attribute, EXIT_WARNING if the table or the attribute does not exist
+ */
+int AK_catalog_get_attr_index(char *name, char *attr)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	int num_attr, i;
+	int index = EXIT_WARNING;
+
+	AK_PRO;
+	entry = AK_catalog_lookup("AK_relation", name, &tmp);
+	if (entry != NULL && (num_attr = AK_catalog_schema(entry)) >= 0)
+	{
+		for (i = 0; i < num_attr; i++)
+		{
+			if (strcmp(entry->header[i].att_name, attr) == 0)
+			{
+				index = i;
+				break;
+			}
+		}
+	}
+	AK_catalog_release(&tmp);
+	AK_EPI;
+	return index;
+}
+
+/**
+ * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
+ * @brief Function that gets the address of a system table by name
+ * @param name of system table
+ * @return table address
+ */
+int AK_get_system_table_address(const char *name) {
+	int i;
+	int data_adr = 0;
+	int data_size = 0;
+	int address_sys;
+	char name_sys[MAX_ATT_NAME];
+
+	AK_PRO;
+
+	AK_mem_block *mem_block = AK_get_block(0);
+
+	for (i = 0; i < DATA_BLOCK_SIZE; i++)
+	{
+		memset(name_sys, 0, MAX_ATT_NAME);
+		if (mem_block->block->tuple_dict[i].address == FREE_INT)
+		{
+			break;
+		}
+
+		data_adr = mem_block->block->tuple_dict[i].address;
+		data_size = mem_block->block->tuple_dict[i].size;
+		memcpy(name_sys, mem_block->block->data + data_adr, data_size);
+		i++;
+		data_adr = mem_block->block->tuple_dict[i].address;
 		data_size = mem_block->block->tuple_dict[i].size;
 		memcpy(&address_sys, mem_block->block->data + data_adr, sizeof(int));
 
@@ -687,77 +1523,90 @@ table_addresses *AK_get_index_addresses(char * index)
 }
 
 /**
-  * @author Matija Novak, updated by Matija Šestak( function now uses caching)
-  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
-  * @param address addresses of extents
-  * @return address of the block to write in
+ * @brief Function that looks for a block with room for a row, starting at a given block. Blocks marked full in the
+ * free-space map are skipped without reading them. The map only lags behind blocks that were filled without
+ * AK_fsm_update, so a candidate block is checked and marked full if it turns out to be full.
+ * @param addresses addresses of extents
+ * @param start block to start at, the blocks before it are taken to be full; the first block if it is not in an extent
+ * @return address of the block to write in, EXIT_ERROR if every block is full
  */
-int AK_find_AK_free_space(table_addresses * addresses)
+static int AK_fsm_search(table_addresses *addresses, int start)
 {
 	AK_mem_block *mem_block;
-	int from = 0, to = 0, j = 0, i = 0;
-	AK_PRO;
-	AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: Searching for block that has AK_free space < 500 \n");
+	int j, block;
 
-	for (j = 0; j < MAX_EXTENTS_IN_SEGMENT; j++)
+	for (j = 0; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++)
+		if (start >= addresses->address_from[j] && start < addresses->address_to[j])
+			break;
+	if (j == MAX_EXTENTS_IN_SEGMENT || addresses->address_from[j] == 0)
 	{
-		if (addresses->address_from != 0)
-		{
-			from = addresses->address_from[j];
-			to = addresses->address_to[j];
-
-			//searching block
-			for (i = from; i <= to; i++)
-			{
-				mem_block = AK_get_block(i);
-				int AK_free_space_on = mem_block->block->AK_free_space;
-
-				AK_dbg_messg(HIGH, MEMO_MAN, "find_AK_free_space: FREE SPACE %d\n", mem_block->block->AK_free_space);
+		j = 0;
+		start = addresses->address_from[0];
+	}
 
-				if ((AK_free_space_on < MAX_FREE_SPACE_SIZE) &&
-					(mem_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE))  //found AK_free block to write
-				{
-					AK_EPI;
-					return i;
-				}
-			}
+	block = start;
+	while (j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0)
+	{
+		if (block >= addresses->address_to[j])
+		{
+			if (++j < MAX_EXTENTS_IN_SEGMENT)
+				block = addresses->address_from[j];
+			continue;
 		}
-		else 
+		if (block < DB_FILE_BLOCKS_NUM_EX && AK_allocationbit->fsm[block] != AK_FSM_FULL)
 		{
-			AK_EPI;
-			return EXIT_ERROR;
+			mem_block = AK_get_block(block);
+			if (AK_fsm_fill_class(mem_block->block) != AK_FSM_FULL)
+				return block;
+			AK_fsm_update(mem_block->block);
 		}
+		block++;
 	}
+	return EXIT_ERROR;
+}
 
-	//I cant call function from memoman must consider another solution to place these functions
-	int adr = -1;
-
-	//need to create new extent
-	printf("\nAK_find_AK_free_space: Creating new extent\n");
-
-	int old_size = 0;
-	int new_size = 0;
-
-	for (i = 0; i < MAX_EXTENTS_IN_SEGMENT; i++)
-	{
-		if (addresses->address_from[i] == 0)
-			break;
-		new_size = addresses->address_to[i] - addresses->address_from[i];
-		if (new_size > old_size) //find largest extent
-			old_size = new_size;
-	}
+/**
+  * @author Matija Novak, updated by Matija Šestak( function now uses caching)
+  * @brief Function that finds AK_free space in some block betwen block addresses, using the free-space map
+  * @param addresses addresses of extents
+  * @return address of the block to write in, EXIT_ERROR if every block is full and the segment needs a new extent,
+  * 0 if the segment has no extents
+ */
+int AK_find_AK_free_space(table_addresses * addresses)
+{
+	int address;
+	AK_PRO;
+	address = 0;
+	if (addresses->address_from[0] != 0)
+		address = AK_fsm_search(addresses, addresses->address_from[0]);
+	AK_EPI;
+	return address;
+}
 
-	old_size++;
+/**
+ * @brief Function that finds the block of a table the next row goes into. The search starts at the block found the
+ * last time, which is kept in the catalog cache, so filling a table does not read its full blocks again.
+ * @param table table name
+ * @return address of the block to write in, EXIT_ERROR if every block is full and the table needs a new extent,
+ * 0 if the table has no extents
+ */
+int AK_find_table_free_space(char *table)
+{
+	AK_catalog_entry tmp;
+	AK_catalog_entry *entry;
+	int address = 0;
 
-	if ( (adr = AK_new_extent(1, old_size, SEGMENT_TYPE_TABLE , mem_block->block->header) ) == EXIT_ERROR)
+	AK_PRO;
+	entry = AK_catalog_lookup("AK_relation", table, &tmp);
+	if (entry != NULL)
 	{
-		printf("AK_find_AK_free_space: Could not allocate the new extent\n");
-		AK_EPI;
-		return EXIT_ERROR;
+		address = AK_fsm_search(&entry->addresses, entry->free_block);
+		if (address != EXIT_ERROR)
+			entry->free_block = address;
 	}
-
+	AK_catalog_release(&tmp);
 	AK_EPI;
-	return adr;
+	return address;
 }
 
 /**
@@ -779,7 +1628,7 @@ int AK_init_new_extent(char *table_name, int extent_type)
 
 	int old_size = 0;
 	int new_size = 0;
-	table_addresses *addresses = (table_addresses *) AK_get_segment_addresses(table_name);
+	table_addresses *addresses = AK_get_segment_addresses_by_type(table_name, extent_type);
 	int block_address = addresses->address_from[0]; //before 1
 	int block_written;
 
@@ -847,6 +1696,7 @@ int AK_init_new_extent(char *table_name, int extent_type)
 	AK_Insert_New_Element(TYPE_INT, &start_address, sys_table, "start_address", row_root);
 	AK_Insert_New_Element(TYPE_INT, &end_address, sys_table, "end_address", row_root);
 	AK_insert_row(row_root);
+	AK_catalog_invalidate(table_name);
 	AK_EPI;
 	return start_address;
 }
@@ -860,14 +1710,15 @@ int AK_flush_cache()
 {
 	int i = 0;
 	int block_written;
-	AK_block *data_block;
+	AK_mem_block *mem_block;
 	AK_PRO;
-	while (i < MAX_CACHE_MEMORY)
+	while (i < db_cache->used)
 	{
-		if (db_cache->cache[i]->dirty == BLOCK_DIRTY)
+		mem_block = db_cache->cache[i];
+		if (mem_block->block != NULL && mem_block->dirty == BLOCK_DIRTY)
 		{
-			data_block = db_cache->cache[i]->block;
-			block_written = AK_write_block(data_block);
+			pthread_rwlock_rdlock(&mem_block->latch);
+			block_written = AK_write_block(mem_block->block);
 			/// if block form cache can not be writed to DB file -> EXIT_ERROR
 			if (block_written != EXIT_SUCCESS)
 			{
@@ -875,7 +1726,8 @@ int AK_flush_cache()
 				exit(EXIT_ERROR);
 			}
 			/// block is clean after successfuly writing it to disk
-			db_cache->cache[i]->dirty = BLOCK_CLEAN;
+			mem_block->dirty = BLOCK_CLEAN;
+			pthread_rwlock_unlock(&mem_block->latch);
 		}
 		i++;
 	}
@@ -883,17 +1735,34 @@ int AK_flush_cache()
 	return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that prints cache size and hit/miss/eviction counters
+ */
+void AK_print_cache_statistics()
+{
+	unsigned long requests;
+	AK_PRO;
+	requests = db_cache->hits + db_cache->misses;
+	printf("Cache: %d of %d blocks used (%lu KiB)\n", db_cache->used, db_cache->size,
+		   (unsigned long) db_cache->size * sizeof(AK_block) / 1024);
+	printf("Cache: %lu hits, %lu misses, %lu evictions, hit ratio %.2f%%\n", db_cache->hits, db_cache->misses,
+		   db_cache->evictions, requests ? 100.0 * db_cache->hits / requests : 0.0);
+	AK_EPI;
+}
+
 TestResult AK_memoman_test()
 {
 	int success=0;
 	int failed=0;
 	int i;
 	int released_block;
-	int min = 0;
-	int ok = 0;
+	int victim;
+	int expected_used;
+	unsigned long hits, misses;
+	AK_mem_block *mem_block;
 	AK_PRO;
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for (i = 0; i < db_cache->used; i++) {
 		printf("Block: %d \t l_address: %d \t c_address: %x\t last_read: %i\t last_change %i\t\n", i,
 			   db_cache->cache[i]->block->address, &db_cache->cache[i]->block, &db_cache->cache[i]->timestamp_read,
 			   db_cache->cache[i]->timestamp_last_change);
@@ -908,61 +1777,92 @@ TestResult AK_memoman_test()
 		
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
-//        printf("\nINDEX: %i oldest is %i, current is %i, comparison %s\n",i, db_cache->cache[ min ]->timestamp_read,
-//               db_cache->cache[ i ]->timestamp_read,
-//               db_cache->cache[i]->timestamp_read < db_cache->cache[ min ]->timestamp_read ? "true" : "false");
-
-		if (db_cache->cache[i]->timestamp_read != -1 &&
-			db_cache->cache[i]->timestamp_read < db_cache->cache[ min ]->timestamp_read)
-		{
-			min = i;
-		}
-	}
-
-	if(AK_allocationbit->last_allocated == db_cache->next_replace)
+	expected_used = db_cache->size < AK_allocationbit->last_initialized ? db_cache->size : AK_allocationbit->last_initialized;
+	if(db_cache->used < expected_used)
 	{
-		printf("\nTEST FAILED! Next block to replace can not be last allocated block, is %i, should be %i\n",
-			   AK_allocationbit->last_allocated, min);
+		printf("\nTEST FAILED! Cache should hold %i blocks, holds %i\n", expected_used, db_cache->used);
 		failed++;
 	}else
 	{
 		success++;
 	}
-	
 
-	if(min != db_cache->next_replace)
+	if(AK_allocationbit->last_allocated == db_cache->next_replace)
 	{
-		printf("\nTEST FAILED! next_replace is not set to oldest block, is %i, should be %i\n",
-			   db_cache->next_replace, min);
+		printf("\nTEST FAILED! Next block to replace can not be last allocated block, is %i\n",
+			   AK_allocationbit->last_allocated);
 		failed++;
 	}else
 	{
 		success++;
 	}
-	
 
-	released_block = AK_release_oldest_cache_block();
+	// every cached block has to be found through the hash table
+	for (i = 0; i < db_cache->used; i++) {
+		if(AK_cache_lookup(db_cache->cache[i]->block->address) != db_cache->cache[i])
+		{
+			printf("\nTEST FAILED! block %i is not found in the cache hash table\n", db_cache->cache[i]->block->address);
+			failed++;
+		}
+	}
+	success++;
 
-	if(released_block != min)
+	// a cached block is a hit, an uncached one a miss
+	hits = db_cache->hits;
+	misses = db_cache->misses;
+	mem_block = AK_get_block(db_cache->cache[0]->block->address);
+	if(mem_block != db_cache->cache[0] || db_cache->hits != hits + 1 || db_cache->misses != misses)
 	{
-		printf("\nTEST FAILED! released block not oldest, is %i, should be %i\n", released_block, min);
+		printf("\nTEST FAILED! cached block was not a cache hit\n");
 		failed++;
 	}else
 	{
 		success++;
 	}
-	
+
+	if(db_cache->used == db_cache->size)
+	{
+		// the CLOCK hand gives a second chance to referenced blocks
+		victim = db_cache->next_replace;
+		for (i = 0; i < db_cache->size; i++) {
+			if(!db_cache->cache[(db_cache->next_replace + i) % db_cache->size]->referenced)
+			{
+				victim = (db_cache->next_replace + i) % db_cache->size;
+				break;
+			}
+		}
+
+		released_block = AK_release_oldest_cache_block();
+
+		if(released_block != victim)
+		{
+			printf("\nTEST FAILED! released block is not the first unreferenced one, is %i, should be %i\n", released_block, victim);
+			failed++;
+		}else
+		{
+			success++;
+		}
+
+		if(db_cache->next_replace != (released_block + 1) % db_cache->size)
+		{
+			printf("\nTEST FAILED! clock hand did not move past released block, is %i, should be %i\n",
+				   db_cache->next_replace, (released_block + 1) % db_cache->size);
+			failed++;
+		}else
+		{
+			success++;
+		}
+	}
 
 	// randomly setting 5 blocks to dirty state to ensure AK_flush_cache() has something to do
 	for(i = 0; i < 5; i++)
 	{
-		AK_mem_block_modify(db_cache->cache[rand()%MAX_CACHE_MEMORY], BLOCK_DIRTY);
+		AK_mem_block_modify(db_cache->cache[rand()%db_cache->used], BLOCK_DIRTY);
 	}
 
 	AK_flush_cache();
 
-	for(i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for(i = 0; i < db_cache->used; i++) {
 		if(db_cache->cache[i]->dirty != BLOCK_CLEAN)
 		{
 			printf("\nTEST FAILED! block %i has not been flushed to disk\n", i);
@@ -975,6 +1875,7 @@ TestResult AK_memoman_test()
 		
 	}
 
+	AK_print_cache_statistics();
 	//printf("\nTEST PASSED!\n");
 	AK_EPI;
 	return TEST_result(success,failed);
@@ -1010,7 +1911,7 @@ TestResult AK_memoman_test2()
 		//select a random block from range 0 to last block allocated on disk
 		read_block = rand() % AK_allocationbit->last_allocated;
 		ok = 1;
-		for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+		for (i = 0; i < db_cache->used; i++) {
 			if(db_cache->cache[i]->block->address == read_block) {
 				ok = 0;
 				break;
@@ -1020,7 +1921,7 @@ TestResult AK_memoman_test2()
 		if(ok) break;
 	}
 
-	for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+	for (i = 0; i < db_cache->used; i++) {
 		if(db_cache->cache[i]->block->address == read_block) {
 			printf("\nTEST FAILED! block with address %i already cached at position %i\n", read_block, i);
 			failed++;
@@ -1063,3 +1964,164 @@ TestResult AK_memoman_test2()
 	AK_EPI;
 	return TEST_result(success,failed);
 }
+
+/**
+ * @brief Number of block requests every thread makes in AK_cache_concurrency_test
+ */
+#define AK_CACHE_STRESS_REQUESTS 2000
+
+/**
+ * @brief Arguments of a thread in AK_cache_concurrency_test
+ */
+typedef struct {
+	/// seed of the thread's random addresses
+	unsigned int seed;
+	/// blocks 0 - range-1 are requested
+	int range;
+	/// number of exclusive holders of every block, checked by all threads
+	int *writers;
+	/// number of requests that found a replaced or concurrently changed block
+	int errors;
+} AK_cache_stress_args;
+
+/**
+ * @brief Thread of AK_cache_concurrency_test. Pins random blocks and checks that a pinned block keeps its
+ * address; every eighth request changes the block under the exclusive latch, the others read it under the
+ * shared latch and check that no writer holds it.
+ * @param arguments AK_cache_stress_args of the thread
+ */
+static void *AK_cache_stress_thread(void *arguments)
+{
+	AK_cache_stress_args *args = (AK_cache_stress_args *) arguments;
+	AK_mem_block *mem_block;
+	int i, num;
+
+	for (i = 0; i < AK_CACHE_STRESS_REQUESTS; i++)
+	{
+		num = rand_r(&args->seed) % args->range;
+		mem_block = AK_pin_block(num);
+		if (mem_block == NULL)
+		{
+			args->errors++;
+			continue;
+		}
+
+		if (i % 8 == 0)
+		{
+			AK_latch_block(mem_block, AK_LATCH_EXCLUSIVE);
+			if (++args->writers[num] != 1)
+				args->errors++;
+			/// the change is undone before the latch is released, so the block is never dirty
+			mem_block->block->AK_free_space ^= 1;
+			if (mem_block->block->address != num)
+				args->errors++;
+			mem_block->block->AK_free_space ^= 1;
+			args->writers[num]--;
+			AK_unlatch_block(mem_block);
+		}
+		else
+		{
+			AK_latch_block(mem_block, AK_LATCH_SHARED);
+			if (mem_block->block->address != num || args->writers[num] != 0)
+				args->errors++;
+			AK_unlatch_block(mem_block);
+		}
+
+		if (mem_block->address != num)
+			args->errors++;
+		AK_unpin_block(mem_block);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Stress test of concurrent cache access in the manner of AK_thread_safe_block_access_test. First checks that
+ * a pinned block survives a full round of replacements, then 1, 2, 4 and 8 threads request random blocks from a
+ * range larger than the cache, so blocks are constantly replaced while other threads hold them. Prints the
+ * throughput for every number of threads.
+ */
+TestResult AK_cache_concurrency_test()
+{
+	int success = 0;
+	int failed = 0;
+	int i, t, threads_num, range, errors;
+	int *writers;
+	double start, elapsed;
+	unsigned long misses;
+	pthread_t threads[8];
+	AK_cache_stress_args args[8];
+	AK_mem_block *pinned;
+	AK_PRO;
+
+	range = 4 * db_cache->size;
+	if (range > AK_allocationbit->last_initialized)
+		range = AK_allocationbit->last_initialized;
+	printf("Cache of %d blocks, requests over blocks 0 - %d\n", db_cache->size, range - 1);
+
+	// a pinned block is skipped by the CLOCK hand, no matter how many other blocks are read
+	pinned = AK_pin_block(0);
+	for (i = 0; i < range; i++)
+		AK_get_block(i);
+	if (pinned == NULL || AK_cache_lookup(0) != pinned || pinned->block->address != 0)
+	{
+		printf("\nTEST FAILED! pinned block 0 has been replaced\n");
+		failed++;
+	}
+	else
+	{
+		success++;
+	}
+	if (pinned != NULL)
+		AK_unpin_block(pinned);
+
+	writers = (int *) AK_calloc(range, sizeof(int));
+	printf("threads\trequests/s\tmisses\terrors\n");
+	for (threads_num = 1; threads_num <= 8; threads_num *= 2)
+	{
+		misses = db_cache->misses;
+		start = TEST_time_ms();
+		for (t = 0; t < threads_num; t++)
+		{
+			args[t].seed = t + 1;
+			args[t].range = range;
+			args[t].writers = writers;
+			args[t].errors = 0;
+			pthread_create(&threads[t], NULL, AK_cache_stress_thread, &args[t]);
+		}
+		errors = 0;
+		for (t = 0; t < threads_num; t++)
+		{
+			pthread_join(threads[t], NULL);
+			errors += args[t].errors;
+		}
+		elapsed = TEST_time_ms() - start;
+
+		printf("%d\t%.0f\t\t%lu\t%d\n", threads_num, threads_num * AK_CACHE_STRESS_REQUESTS / (elapsed / 1000.0),
+			   db_cache->misses - misses, errors);
+		if (errors)
+		{
+			printf("\nTEST FAILED! %d requests with %d threads found a wrong block\n", errors, threads_num);
+			failed++;
+		}
+		else
+		{
+			success++;
+		}
+	}
+	AK_free(writers);
+
+	// no pins may be left behind
+	for (i = 0; i < db_cache->used; i++)
+	{
+		if (db_cache->cache[i]->pin_count != 0)
+		{
+			printf("\nTEST FAILED! block %i is still pinned %i times\n", i, db_cache->cache[i]->pin_count);
+			failed++;
+		}
+	}
+	success++;
+
+	AK_print_cache_statistics();
+	AK_EPI;
+	return TEST_result(success, failed);
+}
@@ -23,13 +23,37 @@
 #include "../auxi/test.h"
 #include "../dm/dbman.h"
 #include "../auxi/mempro.h"
+#include <pthread.h>
+
+/**
+ * @def AK_CACHE_PARTITIONS
+ * @brief number of partitions of the cache hash table; each partition is guarded by its own lock (power of two)
+ */
+#define AK_CACHE_PARTITIONS 16
+
+/**
+ * @def AK_LATCH_SHARED
+ * @brief latch mode for reading a cached block, any number of threads can hold it at the same time
+ */
+#define AK_LATCH_SHARED 0
+/**
+ * @def AK_LATCH_EXCLUSIVE
+ * @brief latch mode for changing a cached block, held by a single thread
+ */
+#define AK_LATCH_EXCLUSIVE 1
+
+/**
+ * @def AK_CATALOG_BUCKETS
+ * @brief initial number of buckets of the catalog cache hash table (power of two), doubled when it fills up
+ */
+#define AK_CATALOG_BUCKETS 256
 
 /**
   * @author Unknown
   * @struct AK_mem_block
   * @brief Structure that defines a block of data in memory
  */
-typedef struct {
+typedef struct AK_mem_block_struct {
     /// pointer to block from DB file
     AK_block * block;
     /// dirty bit (BLOCK_CLEAN if unchanged; BLOCK_DIRTY if changed but not yet written to file)
@@ -38,6 +62,17 @@ typedef struct {
     unsigned long timestamp_read;
     /// timestamp when the block has lastly been changed
     unsigned long timestamp_last_change;
+    /// reference bit for the CLOCK replacement (set on access, cleared when the clock hand passes)
+    int referenced;
+    /// address the block is registered under in the cache hash table, -1 if it is not registered
+    int address;
+    /// next cached block whose address falls into the same bucket of the cache hash table
+    struct AK_mem_block_struct * next_in_bucket;
+    /// number of users holding the block; a pinned block is never replaced
+    /// (guarded by the partition lock of address, or by the replace lock while the block is not registered)
+    int pin_count;
+    /// shared/exclusive latch over the block contents; held exclusively while the block is read from disk
+    pthread_rwlock_t latch;
 } AK_mem_block;
 
 /**
@@ -46,10 +81,29 @@ typedef struct {
   * @brief Structure that defines global cache memory
  */
 typedef struct {
-    /// last recently read blocks
-    AK_mem_block * cache[ MAX_CACHE_MEMORY ];
-    /// next cached block to be replaced (0 - MAX_CACHE_MEMORY-1); depends on caching algorithm
+    /// cached blocks (frames)
+    AK_mem_block ** cache;
+    /// number of frames, read from CACHE_MEMORY_BLOCKS when the cache is allocated
+    int size;
+    /// number of frames that hold a block; frames [used, size) are still empty
+    int used;
+    /// position of the CLOCK hand, the next cached block considered for replacement (0 - size-1)
     int next_replace;
+    /// hash table from block address to the cached block (chained through next_in_bucket)
+    AK_mem_block ** bucket;
+    /// number of buckets in the hash table (power of two)
+    int num_buckets;
+    /// number of AK_get_block calls served from the cache
+    unsigned long hits;
+    /// number of AK_get_block calls that had to read the block from disk
+    unsigned long misses;
+    /// number of cached blocks replaced to make room for another block
+    unsigned long evictions;
+    /// locks over the hash table partitions, bucket i belongs to partition i % AK_CACHE_PARTITIONS;
+    /// they guard the bucket chains, pin counts and reference bits
+    pthread_mutex_t partition_lock[AK_CACHE_PARTITIONS];
+    /// lock over the CLOCK hand and the number of used frames, taken before any partition lock
+    pthread_mutex_t replace_lock;
 } AK_db_cache;
 
 /**
@@ -152,6 +206,55 @@ typedef struct {
     AK_query_mem_result * result;
 } AK_query_mem;
 
+/**
+  * @struct AK_catalog_entry
+  * @brief Structure that defines a cached system catalog entry of a table or an index
+ */
+typedef struct AK_catalog_entry {
+    /// system catalog table the entry was read from (AK_relation or AK_index)
+    char sys_table[MAX_VARCHAR_LENGTH];
+    /// name of the table or index
+    char name[MAX_VARCHAR_LENGTH];
+    /// hash of the name
+    unsigned int hash;
+    /// obj_id from the first catalog row of the segment
+    int obj_id;
+    /// number of extents in addresses
+    int num_extents;
+    /// start and end addresses of the extents, in the order of the catalog rows
+    table_addresses addresses;
+    /// number of attributes, -1 until the header is read from the first block
+    int num_attr;
+    /// header of the first block (num_attr attributes), NULL until it is read
+    AK_header *header;
+    /// block the last row was written to, the blocks before it are full (0 if unknown)
+    int free_block;
+    /// next entry in the same bucket
+    struct AK_catalog_entry *next;
+} AK_catalog_entry;
+
+/**
+  * @struct AK_catalog_cache
+  * @brief Structure that defines the in-memory cache of the system catalog. Entries are looked up by name, filled
+  * from the system catalog on a miss and dropped when DDL changes the segment.
+ */
+typedef struct {
+    /// hash table from segment name to the catalog entry (chained through next)
+    AK_catalog_entry ** bucket;
+    /// number of buckets in the hash table (power of two)
+    int num_buckets;
+    /// number of cached entries
+    int num_entries;
+    /// incremented whenever entries are invalidated, so callers can tell whether something they derived is stale
+    unsigned long version;
+    /// number of lookups served from the cache
+    unsigned long hits;
+    /// number of lookups that had to scan the system catalog
+    unsigned long misses;
+    /// lock over the whole cache
+    pthread_mutex_t lock;
+} AK_catalog_cache;
+
 /**
  * @var db_cache
  * @brief Variable that defines the db cache
@@ -167,6 +270,11 @@ AK_redo_log * redo_log;
  * @brief Variable that defines the global query memory
  */
 AK_query_mem * query_mem;
+/**
+ * @var catalog_cache
+ * @brief Variable that defines the system catalog cache
+ */
+AK_catalog_cache * catalog_cache;
 
 /**
   * @author Mario Novoselec
@@ -240,12 +348,51 @@ int AK_memoman_init();
   * @return segment start address
  */
 AK_mem_block *AK_get_block(int num);
+/**
+ * @brief Function that reads a block into the cache and pins it, so it cannot be replaced until it is unpinned.
+ * The returned block is fully read; its contents have to be accessed under the block latch.
+ * @param num block number (address)
+ * @return pinned cached block
+ */
+AK_mem_block *AK_pin_block(int num);
+/**
+ * @brief Function that releases a pin taken with AK_pin_block
+ * @param mem_block pinned cached block
+ */
+void AK_unpin_block(AK_mem_block *mem_block);
+/**
+ * @brief Function that latches a pinned cached block
+ * @param mem_block pinned cached block
+ * @param mode AK_LATCH_SHARED for reading, AK_LATCH_EXCLUSIVE for changing the block
+ */
+void AK_latch_block(AK_mem_block *mem_block, int mode);
+/**
+ * @brief Function that releases the latch taken with AK_latch_block
+ * @param mem_block latched cached block
+ */
+void AK_unlatch_block(AK_mem_block *mem_block);
 /**
  * @author Antonio Martinović
- * @brief Functions that flushes the oldest block to disk and recalculates the next block to remove
- * @return index of flushed cache block
+ * @brief Functions that picks the next block to replace with the CLOCK algorithm, flushes it to disk if dirty
+ * and moves the clock hand past it. Pinned blocks are skipped.
+ * @return index of flushed cache block, EXIT_ERROR if every block is pinned
  */
 int AK_release_oldest_cache_block();
+/**
+ * @brief Function that replaces the cached copy of a block with the block written straight to the DB file
+ * @param block block as written to the DB file
+ */
+void AK_cache_refresh_block(AK_block *block);
+/**
+ * @brief Function that looks up a block in the cache hash table without reading it from disk
+ * @param num block number (address)
+ * @return cached block or NULL if the block is not cached
+ */
+AK_mem_block *AK_cache_lookup(int num);
+/**
+ * @brief Function that prints cache size and hit/miss/eviction counters
+ */
+void AK_print_cache_statistics();
 /**
  * @author Alen Novosel.
  * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly.
@@ -260,13 +407,21 @@ int AK_refresh_cache();
 
 /**
 * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
-* @brief Function for getting addresses of some table
+* @brief Function for getting addresses of some table. The addresses are served from the catalog cache.
 * @param tableName table name that you search for
 * @param segmentName segment name
 * @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
 */
 table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmentName);
 
+/**
+ * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
+ * @brief Function that gets the address of a system table by name
+ * @param name of system table
+ * @return table address
+ */
+int AK_get_system_table_address(const char *name);
+
 /**
  * @Author Antonio Martinović
  * @brief Function for getting a index segment address
@@ -276,6 +431,15 @@ table_addresses *AK_get_segment_addresses_internal(char *tableName, char *segmen
 table_addresses *AK_get_segment_addresses(char * segmentName);
 table_addresses *AK_get_index_segment_addresses(char * segmentName);
 
+/**
+ * @brief Function for getting the addresses of a segment from the system table its type is registered in. Index
+ * segments are looked up in AK_index first, hash indexes are registered in AK_relation.
+ * @param segmentName segment name
+ * @param type segment type
+ * @return structure table_addresses witch contains start and end adresses of table extents, when form and to are 0 you are on the end of addresses
+ */
+table_addresses *AK_get_segment_addresses_by_type(char *segmentName, int type);
+
 /**
   * @author Mislav Čakarić
   * @brief Function for getting addresses of some table
@@ -294,12 +458,22 @@ table_addresses *AK_get_index_addresses(char * index);
 
 /**
   * @author Matija Novak, updated by Matija Šestak( function now uses caching)
-  * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
-  * @param address addresses of extents
-  * @return address of the block to write in
+  * @brief Function that finds AK_free space in some block betwen block addresses, using the free-space map
+  * @param addresses addresses of extents
+  * @return address of the block to write in, EXIT_ERROR if every block is full and the segment needs a new extent,
+  * 0 if the segment has no extents
  */
 int AK_find_AK_free_space(table_addresses * addresses);
 
+/**
+ * @brief Function that finds the block of a table the next row goes into. The search starts at the block found the
+ * last time, which is kept in the catalog cache, so filling a table does not read its full blocks again.
+ * @param table table name
+ * @return address of the block to write in, EXIT_ERROR if every block is full and the table needs a new extent,
+ * 0 if the table has no extents
+ */
+int AK_find_table_free_space(char *table);
+
 /**
  * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić
  * @brief Function that extends the segment
@@ -321,7 +495,72 @@ int AK_init_new_extent(char *table_name, int extent_type);
  * @return EXIT_SUCCESS
  */
 int AK_flush_cache();
+
+/**
+ * @brief Function that initializes the system catalog cache (variable catalog_cache) and loads the entries of all
+ * tables and indexes from the AK_relation and AK_index system tables
+ * @return EXIT_SUCCESS if the catalog cache has been initialized, EXIT_ERROR otherwise
+ */
+int AK_catalog_cache_init();
+
+/**
+ * @brief Function that drops the cached catalog entries of a table or index. It has to be called after every change
+ * of the catalog rows or of the header of the segment.
+ * @param name name of the table or index
+ */
+void AK_catalog_invalidate(char *name);
+
+/**
+ * @brief Function that drops all cached catalog entries
+ */
+void AK_catalog_invalidate_all();
+
+/**
+ * @brief Function that returns the version of the catalog cache, which changes whenever entries are invalidated
+ * @return catalog cache version
+ */
+unsigned long AK_catalog_version();
+
+/**
+ * @brief Function that copies the extent addresses of a table or index from the catalog cache
+ * @param sys_table system catalog table of the segment (AK_relation or AK_index)
+ * @param name name of the table or index
+ * @param addresses extent addresses, all zero if the segment does not exist
+ * @return EXIT_SUCCESS if the segment exists, EXIT_WARNING otherwise
+ */
+int AK_catalog_get_addresses(char *sys_table, char *name, table_addresses *addresses);
+
+/**
+ * @brief Function that returns the obj_id of a table from the catalog cache
+ * @param name table name
+ * @return obj_id of the table, EXIT_ERROR if there is no table with that name
+ */
+int AK_catalog_get_obj_id(char *name);
+
+/**
+ * @brief Function that returns the number of attributes of a table from the catalog cache
+ * @param name table name
+ * @return number of attributes, EXIT_WARNING if the table has no extents
+ */
+int AK_catalog_get_num_attr(char *name);
+
+/**
+ * @brief Function that returns a copy of the table header from the catalog cache
+ * @param name table name
+ * @return header of the table allocated with AK_calloc, NULL if the table has no extents
+ */
+AK_header *AK_catalog_get_header(char *name);
+
+/**
+ * @brief Function that returns the zero-based index of an attribute from the catalog cache
+ * @param name table name
+ * @param attr attribute name
+ * @return index of the attribute, EXIT_WARNING if the table or the attribute does not exist
+ */
+int AK_catalog_get_attr_index(char *name, char *attr);
+
 TestResult AK_memoman_test();
 TestResult AK_memoman_test2();
+TestResult AK_cache_concurrency_test();
 
 #endif
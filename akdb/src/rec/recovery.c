@@ -61,7 +61,10 @@
 
     for(i = 0; i < redo_log->number; i++) {
         if(redo_log->command_recovery[i].finished != 1) {
-            AK_recovery_insert_row(redo_log->command_recovery[i].table_name, i);
+            if(redo_log->command_recovery[i].operation == BULK_INSERT)
+                AK_recovery_bulk_rollback(i);
+            else
+                AK_recovery_insert_row(redo_log->command_recovery[i].table_name, i);
 	}
     }
     
@@ -72,6 +75,38 @@
     AK_EPI;
 }
 
+/**
+ * @brief Function that undoes an unfinished bulk load entry. The load only appends to a block, so the
+ * rows it wrote are the tuples from the logged index to the end of the block.
+ * @param commandNumber - number of the redo log entry
+ * @return no value
+ */
+void AK_recovery_bulk_rollback(int commandNumber){
+    AK_PRO;
+    int address = atoi(redo_log->command_recovery[commandNumber].arguments[0]);
+    int first = atoi(redo_log->command_recovery[commandNumber].arguments[1]);
+    int i;
+
+    printf("AK_recovery: found unfinished bulk load of %s, clearing block %d from tuple %d\n",
+           redo_log->command_recovery[commandNumber].table_name, address, first);
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(address);
+    AK_block *block = mem_block->block;
+    if (first > 0 && block->tuple_dict[first].type != FREE_INT)
+        block->AK_free_space = block->tuple_dict[first].address;
+    else if (first == 0)
+        block->AK_free_space = 0;
+    for (i = first; i < DATA_BLOCK_SIZE; i++) {
+        block->tuple_dict[i].type = FREE_INT;
+        block->tuple_dict[i].address = FREE_INT;
+        block->tuple_dict[i].size = FREE_INT;
+    }
+    block->last_tuple_dict_id = (first > 0) ? first - 1 : 0;
+    AK_fsm_update(block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    redo_log->command_recovery[commandNumber].finished = 1;
+    AK_EPI;
+}
+
 /** 
  * Function is given the table name with desired data that should be
  * inserted inside. By using the table name, function retrieves table 
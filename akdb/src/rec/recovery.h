@@ -39,6 +39,14 @@
  */
 void AK_recover_archive_log(char* fileName);
 
+/**
+ * @brief Function that undoes an unfinished bulk load entry. The load only appends to a block, so the
+ * rows it wrote are the tuples from the logged index to the end of the block.
+ * @param commandNumber - number of the redo log entry
+ * @return no value
+ */
+void AK_recovery_bulk_rollback(int commandNumber);
+
 /** 
  * Function is given the table name with desired data that should be
  * inserted inside. By using the table name, function retrieves table 
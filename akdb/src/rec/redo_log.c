@@ -60,7 +60,8 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
 
             case FREE_CHAR:
                 strncat(record, "null", 4);
-                attrs[i] = "null";
+                attrs[i] = (char*) AK_malloc(MAX_VARCHAR_LENGTH * sizeof(char));
+                strcpy(attrs[i], "null");
                 break;
             case TYPE_INT:
 				attrs[i] = (char*) AK_malloc(MAX_VARCHAR_LENGTH * sizeof(char));
@@ -109,6 +110,39 @@ void AK_redolog_commit() {
     }
 }
 
+/**
+ * @brief Function that adds one entry for a block filled by a bulk load. The entry stays unfinished until
+ * AK_redolog_commit, recovery then clears the rows the load wrote to the block.
+ * @param table table name
+ * @param block address of the block
+ * @param first_tuple first tuple_dict index written by the load
+ * @return index of the entry, EXIT_ERROR if there is no redo log
+ */
+int AK_add_to_redolog_bulk(char *table, int block, int first_tuple){
+    AK_PRO;
+    if (redo_log == NULL){
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    int n = redo_log->number;
+    if(n == MAX_REDO_LOG_ENTRIES){
+        AK_archive_log(-10);
+        n = 0;
+    }
+
+    AK_command_recovery_struct *entry = &redo_log->command_recovery[n];
+    memset(entry->table_name, '\0', MAX_VARCHAR_LENGTH);
+    strncpy(entry->table_name, table, MAX_VARCHAR_LENGTH - 1);
+    sprintf(entry->arguments[0], "%d", block);
+    sprintf(entry->arguments[1], "%d", first_tuple);
+    entry->operation = BULK_INSERT;
+    entry->finished = 0;
+    redo_log->number = n + 1;
+    AK_dbg_messg(HIGH, FILE_MAN, "AK_add_to_redolog_bulk: block %d of %s from tuple %d\n", block, table, first_tuple);
+    AK_EPI;
+    return n;
+}
+
 /**
  * @author Danko Bukovac
  * @brief Function that adds a new select to redolog, commented code with the new select from select.c,
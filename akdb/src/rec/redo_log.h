@@ -56,6 +56,16 @@ void AK_printout_redolog();
 
 void AK_redolog_commit();
 
+/**
+ * @brief Function that adds one entry for a block filled by a bulk load. The entry stays unfinished until
+ * AK_redolog_commit, recovery then clears the rows the load wrote to the block.
+ * @param table table name
+ * @param block address of the block
+ * @param first_tuple first tuple_dict index written by the load
+ * @return index of the entry, EXIT_ERROR if there is no redo log
+ */
+int AK_add_to_redolog_bulk(char *table, int block, int first_tuple);
+
 /**
  * @author Dražen Bandić
  * @brief Function that checks if the attribute contains '|', and if it does it replaces it with "\|"
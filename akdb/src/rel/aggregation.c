@@ -19,8 +19,6 @@
 
 #include "aggregation.h"
 
-extern search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int iNum_search_params);
-
 /**
  @author Dejan Frankovic
  @brief  Function that calculates how many attributes there are in the header with a while loop.
@@ -131,14 +129,519 @@ void AK_agg_input_fix(AK_agg_input *input) {
     AK_EPI;
 }
 
+/**
+ * @brief  Function that adds a value to a FNV-1a hash
+ * @param hash hash so far
+ * @param size size of the value
+ * @param data value
+ * @return new hash
+ */
+static unsigned int AK_agg_hash_value(unsigned int hash, int size, char *data) {
+    int i;
+
+    for (i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+    return (hash ^ 0xffu) * 16777619u;
+}
+
+/**
+ * @brief  Function that hashes the GROUP attributes of a row. Every partitioning level uses another seed, so the rows of a
+ *         spilled partition are spread again when it is partitioned.
+ * @param values values of the row
+ * @param plan resolved aggregation
+ * @param depth partitioning level
+ * @return hash of the group
+ */
+static unsigned int AK_agg_hash_group(AK_sort_value *values, AK_agg_plan *plan, int depth) {
+    unsigned int hash = (2166136261u ^ (unsigned int) depth) * 16777619u;
+    int k;
+
+    for (k = 0; k < plan->num_group; k++)
+        hash = AK_agg_hash_value(hash, values[plan->group[k]].size, values[plan->group[k]].data);
+    return hash;
+}
+
+/**
+ * @brief  Function that points an array of values to the values of a cursor row, the data stays in the row list
+ * @param row row returned by AK_table_cursor_next
+ * @param values array of at least num_attr elements
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_agg_row_values(struct list_node *row, AK_sort_value *values, int num_attr) {
+    struct list_node *el = AK_First_L2(row);
+    int i;
+
+    for (i = 0; i < num_attr && el != NULL; i++, el = el->next) {
+        values[i].type = el->type;
+        values[i].size = el->size;
+        values[i].data = el->data;
+    }
+}
+
+/**
+ * @brief  Function that allocates memory for a group from the chunks of a hash aggregation
+ * @param table hash aggregation table
+ * @param size number of bytes
+ * @return allocated memory, NULL if it does not fit a chunk
+ */
+static void *AK_agg_alloc(AK_agg_table *table, int size) {
+    AK_agg_chunk *chunk = table->chunks;
+    void *memory;
+
+    size = (size + 7) & ~7;
+    if (size > AK_AGG_ARENA_CHUNK)
+        return NULL;
+    if (chunk == NULL || chunk->used + size > AK_AGG_ARENA_CHUNK) {
+        chunk = (AK_agg_chunk *) AK_malloc(sizeof (AK_agg_chunk));
+        chunk->next = table->chunks;
+        chunk->used = 0;
+        table->chunks = chunk;
+    }
+    memory = chunk->data + chunk->used;
+    chunk->used += size;
+    table->used += size;
+    return memory;
+}
+
+/**
+ * @brief  Function that prepares an empty hash aggregation table
+ * @param table hash aggregation table
+ * @return No return value
+ */
+static void AK_agg_init_table(AK_agg_table *table) {
+    table->capacity = 1024;
+    table->num_groups = 0;
+    table->max_groups = 512;
+    table->slots = (AK_agg_group **) AK_calloc(table->capacity, sizeof (AK_agg_group *));
+    table->groups = (AK_agg_group **) AK_malloc(table->max_groups * sizeof (AK_agg_group *));
+    table->chunks = NULL;
+    table->used = 0;
+}
+
+/**
+ * @brief  Function that frees the groups of a hash aggregation
+ * @param table hash aggregation table
+ * @return No return value
+ */
+static void AK_agg_free_table(AK_agg_table *table) {
+    AK_agg_chunk *chunk, *next;
+
+    for (chunk = table->chunks; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        AK_free(chunk);
+    }
+    AK_free(table->slots);
+    AK_free(table->groups);
+}
+
+/**
+ * @brief  Function that finds the group of a row with linear probing
+ * @param table hash aggregation table
+ * @param values values of the row
+ * @param plan resolved aggregation
+ * @param hash hash of the group
+ * @param position set to the slot of the group, or to the free slot the group would be put in
+ * @return group, NULL if the row has a new group
+ */
+static AK_agg_group *AK_agg_find(AK_agg_table *table, AK_sort_value *values, AK_agg_plan *plan, unsigned int hash, int *position) {
+    int mask = table->capacity - 1;
+    int pos = hash & mask;
+    AK_agg_group *group;
+    AK_sort_value *el;
+    int k;
+
+    while ((group = table->slots[pos]) != NULL) {
+        if (group->hash == hash) {
+            for (k = 0; k < plan->num_group; k++) {
+                el = &values[plan->group[k]];
+                if (group->key[k].size != el->size || memcmp(group->key[k].data, el->data, el->size) != 0)
+                    break;
+            }
+            if (k == plan->num_group) {
+                *position = pos;
+                return group;
+            }
+        }
+        pos = (pos + 1) & mask;
+    }
+    *position = pos;
+    return NULL;
+}
+
+/**
+ * @brief  Function that doubles the number of slots of a hash aggregation table
+ * @param table hash aggregation table
+ * @return No return value
+ */
+static void AK_agg_grow(AK_agg_table *table) {
+    int capacity = table->capacity * 2;
+    AK_agg_group **slots = (AK_agg_group **) AK_calloc(capacity, sizeof (AK_agg_group *));
+    int i, pos;
+
+    for (i = 0; i < table->num_groups; i++) {
+        pos = table->groups[i]->hash & (capacity - 1);
+        while (slots[pos] != NULL)
+            pos = (pos + 1) & (capacity - 1);
+        slots[pos] = table->groups[i];
+    }
+    AK_free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+}
+
+/**
+ * @brief  Function that adds a new group to a hash aggregation table
+ * @param table hash aggregation table
+ * @param values values of the first row of the group
+ * @param plan resolved aggregation
+ * @param hash hash of the group
+ * @param position free slot returned by AK_agg_find
+ * @return group, NULL if the key is too large
+ */
+static AK_agg_group *AK_agg_insert(AK_agg_table *table, AK_sort_value *values, AK_agg_plan *plan, unsigned int hash, int position) {
+    int size = sizeof (AK_agg_group) + plan->num_group * sizeof (AK_sort_value) + plan->num_out * sizeof (AK_agg_slot);
+    AK_agg_group *group;
+    char *data;
+    int k;
+
+    for (k = 0; k < plan->num_group; k++)
+        size += values[plan->group[k]].size + 1;
+    if ((group = (AK_agg_group *) AK_agg_alloc(table, size)) == NULL)
+        return NULL;
+
+    group->hash = hash;
+    group->slots = (AK_agg_slot *) (group + 1);
+    group->key = (AK_sort_value *) (group->slots + plan->num_out);
+    memset(group->slots, 0, plan->num_out * sizeof (AK_agg_slot));
+    data = (char *) (group->key + plan->num_group);
+    for (k = 0; k < plan->num_group; k++) {
+        group->key[k].type = values[plan->group[k]].type;
+        group->key[k].size = values[plan->group[k]].size;
+        group->key[k].data = data;
+        memcpy(data, values[plan->group[k]].data, group->key[k].size);
+        data[group->key[k].size] = '\0';
+        data += group->key[k].size + 1;
+    }
+
+    if (table->num_groups == table->max_groups) {
+        table->max_groups *= 2;
+        table->groups = (AK_agg_group **) AK_realloc(table->groups, table->max_groups * sizeof (AK_agg_group *));
+    }
+    table->groups[table->num_groups++] = group;
+    table->slots[position] = group;
+    if (table->num_groups * 2 > table->capacity)
+        AK_agg_grow(table);
+    return group;
+}
+
+/**
+ * @brief  Function that keeps the smaller or the larger value in a MIN or MAX slot
+ * @param table hash aggregation table, the value is copied into its chunks
+ * @param slot slot of the group
+ * @param task AGG_TASK_MIN or AGG_TASK_MAX
+ * @param type type of the attribute
+ * @param data value
+ * @param size size of the value
+ * @return EXIT_SUCCESS, EXIT_ERROR if the value is too large
+ */
+static int AK_agg_update_extreme(AK_agg_table *table, AK_agg_slot *slot, int task, int type, char *data, int size) {
+    int cmp;
+
+    if (slot->count > 0) {
+        cmp = AK_sort_compare_values(type, data, size, slot->data, slot->size);
+        if ((task == AGG_TASK_MAX && cmp <= 0) || (task == AGG_TASK_MIN && cmp >= 0))
+            return EXIT_SUCCESS;
+    }
+    if (size > slot->capacity) {
+        if ((slot->data = (char *) AK_agg_alloc(table, size)) == NULL)
+            return EXIT_ERROR;
+        slot->capacity = size;
+    }
+    memcpy(slot->data, data, size);
+    slot->size = size;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that adds a row to the slots of its group
+ * @param table hash aggregation table, MIN and MAX values are kept in its chunks
+ * @param group group of the row
+ * @param values values of the row
+ * @param plan resolved aggregation
+ * @return EXIT_SUCCESS, EXIT_ERROR if a value is too large
+ */
+static int AK_agg_update(AK_agg_table *table, AK_agg_group *group, AK_sort_value *values, AK_agg_plan *plan) {
+    AK_agg_slot *slot;
+    AK_sort_value *el;
+    int inttemp, i;
+    float floattemp;
+    double doubletemp;
+
+    for (i = 0; i < plan->num_out; i++) {
+        slot = &group->slots[i];
+        el = &values[plan->column[i]];
+        switch (plan->task[i]) {
+            case AGG_TASK_SUM:
+                //no break is intentional
+            case AGG_TASK_AVG:
+                switch (plan->type[i]) {
+                    case TYPE_INT:
+                        memcpy(&inttemp, el->data, sizeof (int));
+                        slot->sum.i += inttemp;
+                        break;
+                    case TYPE_FLOAT:
+                        memcpy(&floattemp, el->data, sizeof (float));
+                        slot->sum.f += floattemp;
+                        break;
+                    case TYPE_NUMBER:
+                        memcpy(&doubletemp, el->data, sizeof (double));
+                        slot->sum.d += doubletemp;
+                        break;
+                }
+                break;
+
+            case AGG_TASK_MAX:
+                //no break is intentional
+            case AGG_TASK_MIN:
+                if (AK_agg_update_extreme(table, slot, plan->task[i], plan->type[i], el->data, el->size) == EXIT_ERROR)
+                    return EXIT_ERROR;
+                break;
+        }
+        slot->count++;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that adds the selected rows of a batch to the slots of their groups, a column at a time
+ * @param table hash aggregation table, MIN and MAX values are kept in its chunks
+ * @param groups group of every selected row, in the order of the selection vector
+ * @param batch batch with the rows
+ * @param plan resolved aggregation
+ * @return EXIT_SUCCESS, EXIT_ERROR if a value is too large
+ */
+static int AK_agg_update_batch(AK_agg_table *table, AK_agg_group **groups, AK_batch *batch, AK_agg_plan *plan) {
+    AK_batch_column *column;
+    int *sel = batch->sel;
+    int n = batch->num_sel;
+    int i, j;
+
+    for (i = 0; i < plan->num_out; i++) {
+        column = &batch->column[plan->column[i]];
+        switch (plan->task[i]) {
+            case AGG_TASK_SUM:
+                //no break is intentional
+            case AGG_TASK_AVG:
+                //values of another type (nulls) are summed from their first bytes, as the row path does
+                switch (plan->type[i]) {
+                    case TYPE_INT: {
+                        int *v = (int *) column->values;
+                        for (j = 0; j < n; j++)
+                            groups[j]->slots[i].sum.i += v[sel[j]];
+                        break;
+                    }
+                    case TYPE_FLOAT: {
+                        float *v = (float *) column->values;
+                        for (j = 0; j < n; j++)
+                            groups[j]->slots[i].sum.f += v[sel[j]];
+                        break;
+                    }
+                    case TYPE_NUMBER: {
+                        double *v = (double *) column->values;
+                        for (j = 0; j < n; j++)
+                            groups[j]->slots[i].sum.d += v[sel[j]];
+                        break;
+                    }
+                }
+                break;
+
+            case AGG_TASK_MAX:
+                //no break is intentional
+            case AGG_TASK_MIN:
+                for (j = 0; j < n; j++) {
+                    if (AK_agg_update_extreme(table, &groups[j]->slots[i], plan->task[i], plan->type[i],
+                            column->values + sel[j] * column->width, column->size[sel[j]]) == EXIT_ERROR)
+                        return EXIT_ERROR;
+                    groups[j]->slots[i].count++;
+                }
+                continue;
+        }
+        for (j = 0; j < n; j++)
+            groups[j]->slots[i].count++;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that copies the aggregated values of a group into a row list
+ * @param group group of a hash aggregation table
+ * @param plan resolved aggregation
+ * @param out_row row list of plan->num_out elements
+ * @return No return value
+ */
+static void AK_agg_group_values(AK_agg_group *group, AK_agg_plan *plan, struct list_node *out_row) {
+    AK_agg_slot *slot;
+    struct list_node *el;
+    float floattemp;
+    int i;
+
+    for (i = 0, el = AK_First_L2(out_row); i < plan->num_out; i++, el = el->next) {
+        slot = &group->slots[i];
+        el->type = plan->out_type[i];
+        memset(el->data, 0, sizeof (double));
+        switch (plan->task[i]) {
+            case AGG_TASK_GROUP:
+                el->size = group->key[plan->key[i]].size;
+                memcpy(el->data, group->key[plan->key[i]].data, el->size);
+                break;
+            case AGG_TASK_COUNT:
+                el->size = sizeof (int);
+                memcpy(el->data, &slot->count, sizeof (int));
+                break;
+            case AGG_TASK_SUM:
+                el->size = (plan->type[i] == TYPE_NUMBER) ? sizeof (double) : sizeof (int);
+                memcpy(el->data, &slot->sum, el->size);
+                break;
+            case AGG_TASK_AVG:
+                floattemp = 0;
+                if (slot->count > 0 && plan->type[i] == TYPE_INT)
+                    floattemp = (float) ((double) slot->sum.i / slot->count);
+                else if (slot->count > 0 && plan->type[i] == TYPE_FLOAT)
+                    floattemp = slot->sum.f / slot->count;
+                else if (slot->count > 0)
+                    floattemp = (float) (slot->sum.d / slot->count);
+                el->size = sizeof (float);
+                memcpy(el->data, &floattemp, sizeof (float));
+                break;
+            default:
+                if (slot->count > 0) {
+                    el->size = slot->size;
+                    memcpy(el->data, slot->data, slot->size);
+                } else
+                    el->size = (plan->type[i] == TYPE_NUMBER) ? sizeof (double) : (plan->type[i] == TYPE_VARCHAR ? 0 : sizeof (int));
+                break;
+        }
+        el->data[el->size] = '\0';
+    }
+}
+
+/**
+ * @brief  Function that writes the groups of a hash aggregation table in the order they were found
+ * @param table hash aggregation table
+ * @param plan resolved aggregation
+ * @param out_row row list of plan->num_out elements
+ * @param writer writer on the aggregated table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_agg_write(AK_agg_table *table, AK_agg_plan *plan, struct list_node *out_row, AK_table_writer *writer) {
+    int g;
+
+    for (g = 0; g < table->num_groups; g++) {
+        AK_agg_group_values(table->groups[g], plan, out_row);
+        if (AK_table_writer_append(writer, out_row) != EXIT_SUCCESS)
+            return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that aggregates a table, or a partition of it, into the aggregated table. Rows of groups that do not fit
+ *         the memory budget are written to partitions, which are aggregated recursively after the groups in memory are
+ *         written and are deleted afterwards.
+ * @param srcTable table or partition name
+ * @param aggTable name of the aggregated table, the partitions are named after it
+ * @param plan resolved aggregation
+ * @param memory memory budget for the groups in bytes
+ * @param depth partitioning level, 0 for the source table
+ * @param out_row row list of plan->num_out elements
+ * @param writer writer on the aggregated table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_agg_pass(char *srcTable, char *aggTable, AK_agg_plan *plan, long memory, int depth, struct list_node *out_row, AK_table_writer *writer) {
+    AK_table_writer *partitions[AK_AGG_MAX_PARTITIONS];
+    char names[AK_AGG_MAX_PARTITIONS][MAX_ATT_NAME];
+    AK_sort_value values[MAX_ATTRIBUTES];
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *src_header;
+    AK_table_cursor *cursor;
+    AK_agg_table table;
+    AK_agg_group *group;
+    struct list_node *row;
+    unsigned int hash;
+    int spilled = 0, result = EXIT_SUCCESS, position, size, k, p;
+
+    AK_agg_init_table(&table);
+    memset(partitions, 0, sizeof (partitions));
+
+    //without GROUP attributes there is exactly one group, also for an empty table
+    if (plan->num_group == 0) {
+        AK_agg_find(&table, values, plan, AK_agg_hash_group(values, plan, depth), &position);
+        AK_agg_insert(&table, values, plan, AK_agg_hash_group(values, plan, depth), position);
+    }
+
+    cursor = AK_table_cursor_open(srcTable);
+    while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+        AK_agg_row_values(row, values, plan->num_attr);
+        hash = AK_agg_hash_group(values, plan, depth);
+        if ((group = AK_agg_find(&table, values, plan, hash, &position)) == NULL) {
+            size = sizeof (AK_agg_group) + plan->num_out * sizeof (AK_agg_slot) + plan->num_group * sizeof (AK_sort_value);
+            for (k = 0; k < plan->num_group; k++)
+                size += values[plan->group[k]].size + 1;
+
+            if (depth < AK_AGG_MAX_DEPTH && table.num_groups > 0
+                    && table.used + size + (long) (table.capacity + table.max_groups) * sizeof (AK_agg_group *) > memory) {
+                p = (hash >> 16) % AK_AGG_MAX_PARTITIONS;
+                if (partitions[p] == NULL) {
+                    if (spilled == 0) {
+                        memset(header, 0, sizeof (header));
+                        src_header = AK_get_header(srcTable);
+                        memcpy(header, src_header, plan->num_attr * sizeof (AK_header));
+                        AK_free(src_header);
+                    }
+                    snprintf(names[p], MAX_ATT_NAME, "%s_agg_%d_%d", aggTable, depth + 1, p);
+                    if (AK_initialize_new_segment(names[p], SEGMENT_TYPE_TABLE, header) == EXIT_ERROR
+                            || (partitions[p] = AK_table_writer_open(names[p])) == NULL) {
+                        printf("AK_hash_aggregation: ERROR. Cannot create partition %s.\n", names[p]);
+                        result = EXIT_ERROR;
+                        break;
+                    }
+                }
+                spilled++;
+                result = AK_table_writer_append(partitions[p], row);
+                continue;
+            }
+            if ((group = AK_agg_insert(&table, values, plan, hash, position)) == NULL) {
+                result = EXIT_ERROR;
+                break;
+            }
+        }
+        result = AK_agg_update(&table, group, values, plan);
+    }
+    AK_table_cursor_close(cursor);
+
+    for (p = 0; p < AK_AGG_MAX_PARTITIONS; p++) {
+        if (partitions[p] != NULL)
+            AK_table_writer_close(partitions[p]);
+    }
+    if (result == EXIT_SUCCESS)
+        result = AK_agg_write(&table, plan, out_row, writer);
+    AK_agg_free_table(&table);
+
+    for (p = 0; p < AK_AGG_MAX_PARTITIONS; p++) {
+        if (partitions[p] == NULL)
+            continue;
+        if (result == EXIT_SUCCESS)
+            result = AK_agg_pass(names[p], aggTable, plan, memory, depth + 1, out_row, writer);
+        AK_delete_segment(names[p], SEGMENT_TYPE_TABLE);
+    }
+    return result;
+}
+
 /**
    @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
+   @brief Function that aggregates a given table by given attributes with a hash aggregation in the memory budget set by
+          aggregation:hash_aggregation_memory, see AK_hash_aggregation
    @param input input object with list of atributes by which we aggregate and types of aggregations
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
@@ -146,532 +649,345 @@ void AK_agg_input_fix(AK_agg_input *input) {
 
  */
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
-    int i, j;
+    int result;
     AK_PRO;
-    AK_agg_input_fix(input);
-    AK_header *att_root = (*input).attributes;
-    int *att_tasks = (*input).tasks;
-    int num_aggregations = (*input).counter;
-	AK_header *agg_head_ptr[MAX_ATTRIBUTES];
-    AK_header agg_head[MAX_ATTRIBUTES];
-    int agg_group_number = 0;
-    int inttemp = 0;
-    double doubletemp = 0;
-    float floattemp = 0;
+    result = AK_hash_aggregation(input, source_table, agg_table, HASH_AGGREGATION_MEMORY * 1024);
+    AK_EPI;
+    return result;
+}
 
+/**
+ * @brief  Function that resolves an aggregation against the header of the rows to aggregate and makes the header of the
+ *         aggregated rows
+ * @param input input object with list of atributes by which we aggregate and types of aggregations
+ * @param header header of the rows to aggregate
+ * @param num_attr number of attributes in header
+ * @param source name of the rows to aggregate, for messages
+ * @param plan resolved aggregation
+ * @param agg_head header of the aggregated rows, MAX_ATTRIBUTES + 1 elements
+ * @return EXIT_SUCCESS, EXIT_ERROR if an attribute does not exist or SUM or AVG is asked for an attribute that is not a number
+ */
+static int AK_agg_resolve(AK_agg_input *input, AK_header *header, int num_attr, char *source, AK_agg_plan *plan, AK_header *agg_head) {
+    AK_header *agg_head_ptr;
     char agg_h_name[MAX_ATT_NAME];
-    int agg_h_type;
-    char group_h_name[MAX_ATT_NAME];
-
-    AK_agg_value *needed_values = AK_malloc(sizeof (AK_agg_value) * num_aggregations);
-
-    char new_table[MAX_ATT_NAME];
-    sprintf(new_table, "_%s", agg_table);
+    int type, column, i;
+
+    memset(plan, 0, sizeof (AK_agg_plan));
+    memset(agg_head, 0, (MAX_ATTRIBUTES + 1) * sizeof (AK_header));
+    plan->num_attr = num_attr;
+
+    for (i = 0; i < (*input).counter; i++) {
+        if ((*input).tasks[i] == AGG_TASK_AVG_COUNT || (*input).tasks[i] == AGG_TASK_AVG_SUM)
+            continue;
+        for (column = 0; column < num_attr && strcmp(header[column].att_name, (*input).attributes[i].att_name) != 0; column++)
+            ;
+        if (column == num_attr) {
+            printf("AK_hash_aggregation: ERROR. Attribute %s does not exist in %s.\n", (*input).attributes[i].att_name, source);
+            return EXIT_ERROR;
+        }
+        type = (*input).attributes[i].type;
+        plan->column[plan->num_out] = column;
+        plan->task[plan->num_out] = (*input).tasks[i];
+        plan->type[plan->num_out] = type;
+        plan->out_type[plan->num_out] = type;
 
-    for (i = 0; i < num_aggregations; i++) 
-	{
-        agg_h_type = att_root[i].type;
-        switch (att_tasks[i]) {
+        switch ((*input).tasks[i]) {
             case AGG_TASK_GROUP:
-                strcpy(agg_h_name, att_root[i].att_name);
-                strcpy(group_h_name, att_root[i].att_name);
-                agg_group_number++;
+                strcpy(agg_h_name, (*input).attributes[i].att_name);
+                plan->key[plan->num_out] = plan->num_group;
+                plan->group[plan->num_group++] = column;
                 break;
             case AGG_TASK_COUNT:
-                sprintf(agg_h_name, "Cnt(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
+                sprintf(agg_h_name, "Cnt(%s)", (*input).attributes[i].att_name);
+                plan->out_type[plan->num_out] = TYPE_INT;
                 break;
             case AGG_TASK_SUM:
-                sprintf(agg_h_name, "Sum(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                sprintf(agg_h_name, "Sum(%s)", (*input).attributes[i].att_name);
                 break;
             case AGG_TASK_MAX:
-                sprintf(agg_h_name, "Max(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                sprintf(agg_h_name, "Max(%s)", (*input).attributes[i].att_name);
                 break;
             case AGG_TASK_MIN:
-                sprintf(agg_h_name, "Min(%s)", att_root[i].att_name);
-                if (agg_h_type != TYPE_INT && agg_h_type != TYPE_FLOAT && agg_h_type != TYPE_NUMBER)
-                    agg_h_type = TYPE_INT;
+                sprintf(agg_h_name, "Min(%s)", (*input).attributes[i].att_name);
                 break;
             case AGG_TASK_AVG:
-                sprintf(agg_h_name, "Avg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
-                break;
-            case AGG_TASK_AVG_COUNT:
-                sprintf(agg_h_name, "_cAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_INT;
-                break;
-            case AGG_TASK_AVG_SUM:
-                sprintf(agg_h_name, "_sAvg(%s)", att_root[i].att_name);
-                agg_h_type = TYPE_FLOAT;
+                sprintf(agg_h_name, "Avg(%s)", (*input).attributes[i].att_name);
+                plan->out_type[plan->num_out] = TYPE_FLOAT;
                 break;
+            default:
+                printf("AK_hash_aggregation: ERROR. Unknown aggregation task %d.\n", (*input).tasks[i]);
+                return EXIT_ERROR;
+        }
+        if (((*input).tasks[i] == AGG_TASK_SUM || (*input).tasks[i] == AGG_TASK_AVG)
+                && type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER) {
+            printf("AK_hash_aggregation: ERROR. Attribute %s is not a number.\n", (*input).attributes[i].att_name);
+            return EXIT_ERROR;
         }
-        needed_values[i].agg_task = att_tasks[i];
-        strcpy(needed_values[i].att_name, att_root[i].att_name);
-		agg_head_ptr[i] = AK_create_header(agg_h_name, agg_h_type, FREE_INT, FREE_CHAR, FREE_CHAR);
-        agg_head[i] = *(agg_head_ptr[i]);
+        agg_head_ptr = AK_create_header(agg_h_name, plan->out_type[plan->num_out], FREE_INT, FREE_CHAR, FREE_CHAR);
+        agg_head[plan->num_out] = *agg_head_ptr;
+        AK_free(agg_head_ptr);
+        plan->num_out++;
     }
+    return EXIT_SUCCESS;
+}
 
-    // removing rest of the unneeded attributes (where attribute id is greater than number of used aggregations)
-    for (i = num_aggregations; i < MAX_ATTRIBUTES; i++) 
-	{
-        memcpy(&agg_head[i], "\0", sizeof ( "\0"));
+/**
+   @brief Function that aggregates a table in one pass with a hash aggregation
+   @param input input object with list of atributes by which we aggregate and types of aggregations
+   @param source_table table name for the source table
+   @param agg_table table name for aggregated table, it is created by the function
+   @param memory memory budget for the groups in bytes
+   @return EXIT_SUCCESS, EXIT_ERROR if an attribute does not exist or SUM or AVG is asked for an attribute that is not a number
+ */
+int AK_hash_aggregation(AK_agg_input *input, char *source_table, char *agg_table, int memory) {
+    AK_PRO;
+    AK_header agg_head[MAX_ATTRIBUTES + 1];
+    AK_header *src_header;
+    AK_table_writer *writer;
+    AK_agg_plan plan;
+    struct list_node *out_row, *last;
+    char source[MAX_ATT_NAME + 6];
+    int num_attr, result, i;
+
+    num_attr = AK_num_attr(source_table);
+    if (num_attr <= 0 || (src_header = (AK_header *) AK_get_header(source_table)) == NULL) {
+        printf("AK_hash_aggregation: ERROR. Table %s does not exist.\n", source_table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    snprintf(source, sizeof (source), "table %s", source_table);
+    result = AK_agg_resolve(input, src_header, num_attr, source, &plan, agg_head);
+    AK_free(src_header);
+    if (result == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
     }
-    
-
-    int startAddress = AK_initialize_new_segment(new_table, SEGMENT_TYPE_TABLE, agg_head);
-
-    if (startAddress != EXIT_ERROR)
-        printf("\nTABLE %s CREATED!\n", new_table);
 
-    // this was an optimisation or something, so that sort works normally
-    //sort_segment(source_table,group_h_name);
+    if (AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg_head) == EXIT_ERROR || (writer = AK_table_writer_open(agg_table)) == NULL) {
+        printf("AK_hash_aggregation: ERROR. Cannot create table %s.\n", agg_table);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    printf("\nTABLE %s CREATED!\n", agg_table);
 
-    search_params search_parameters[agg_group_number];
-    search_result sresult;
-    j = 0;
+    out_row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&out_row);
+    for (i = 0, last = out_row; i < plan.num_out; i++, last = last->next)
+        last->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
 
+    result = AK_agg_pass(source_table, agg_table, &plan, memory, 0, out_row, writer);
 
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(source_table);
-    int num_attr = AK_num_attr(source_table);
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&out_row);
+    AK_free(out_row);
+    AK_EPI;
+    return result;
+}
 
-    int k, l, m, n, o, counter;
+/**
+ * @struct AK_agg_iterator_state
+ * @brief Structure that contains the state of an aggregation operator
+ */
+typedef struct {
+    AK_agg_plan plan;
+    AK_agg_table table;
+    /// batch of input rows, with the hash and the group of every selected row
+    AK_batch *batch;
+    unsigned int hash[AK_BATCH_SIZE];
+    AK_agg_group *group[AK_BATCH_SIZE];
+    /// aggregated values of the current group
+    struct list_node *out_row;
+    int position;
+    int open;
+} AK_agg_iterator_state;
+
+static void AK_agg_iterator_free(void *data) {
+    AK_agg_iterator_state *state = (AK_agg_iterator_state *) data;
+
+    if (state->open)
+        AK_agg_free_table(&state->table);
+    AK_batch_free(state->batch);
+    AK_DeleteAll_L3(&state->out_row);
+    AK_free(state->out_row);
+    AK_free(state);
+}
 
-    AK_block *temp;
-    AK_mem_block *mem_block;
+static void AK_agg_iterator_close(AK_iterator *iterator) {
+    AK_agg_iterator_state *state = (AK_agg_iterator_state *) iterator->state;
 
-    struct list_node * row_root = (struct list_node*) AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&row_root);
+    if (state->open)
+        AK_agg_free_table(&state->table);
+    state->open = 0;
+}
 
-    i = 0;
-    counter = 0;
+/**
+ * @brief  Function that hashes the GROUP attributes of the selected rows of a batch, a column at a time
+ * @param batch batch with the rows
+ * @param plan resolved aggregation
+ * @param hash set to the hash of every selected row, as AK_agg_hash_group computes it with depth 0
+ * @return No return value
+ */
+static void AK_agg_hash_batch(AK_batch *batch, AK_agg_plan *plan, unsigned int *hash) {
+    AK_batch_column *column;
+    int *sel = batch->sel;
+    int n = batch->num_sel;
+    int j, k;
+
+    for (j = 0; j < n; j++)
+        hash[j] = 2166136261u * 16777619u;
+    for (k = 0; k < plan->num_group; k++) {
+        column = &batch->column[plan->group[k]];
+        for (j = 0; j < n; j++)
+            hash[j] = AK_agg_hash_value(hash[j], column->size[sel[j]], column->values + sel[j] * column->width);
+    }
+}
 
-    while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            temp = (AK_block*) AK_read_block(j);
-            if ( temp->last_tuple_dict_id == 0 )
-            	break;
-            for (k = 0; k < temp->last_tuple_dict_id; k += num_attr) {
-                counter++;
-                n = 0;
-
-                //aggregation when no grouping is done will be executed separately to skip the unsorted search
-                if(agg_group_number == 0){
-                	for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-								switch (needed_values[m].agg_task) {
-									case AGG_TASK_COUNT:
-										//no break is intentional
-									case AGG_TASK_AVG_COUNT:
-										memcpy(needed_values[m].data, &counter, sizeof(int));
-										needed_values[m].data[sizeof(int)] = '\0';
-										break;
-
-									case AGG_TASK_MAX:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) < inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) < floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) < doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_MIN:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((int*)needed_values[m].data) > inttemp || counter == 1)
-													memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((float *)needed_values[m].data) > floattemp || counter == 1)
-													memcpy(needed_values[m].data, &floattemp, sizeof(float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												if (*((double *)needed_values[m].data) > doubletemp || counter == 1)
-													memcpy(needed_values[m].data, &doubletemp, sizeof(double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-										break;
-
-									case AGG_TASK_SUM:
-										//no break is intentional
-									case AGG_TASK_AVG_SUM:
-										switch (agg_head[m].type) {
-											case TYPE_INT:
-												memcpy(&inttemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												inttemp += *((int*) needed_values[m].data);
-												memcpy(needed_values[m].data, &inttemp, sizeof (int));
-												break;
-
-											case TYPE_FLOAT:
-												memcpy(&floattemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												floattemp += *((float *)needed_values[m].data);
-												memcpy(needed_values[m].data, &floattemp, sizeof (float));
-												break;
-
-											case TYPE_NUMBER:
-												memcpy(&doubletemp, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-												doubletemp += *((double*) needed_values[m].data);
-												memcpy(needed_values[m].data, &doubletemp, sizeof (double));
-												break;
-										}
-										needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-								}
-							}
-						}
-					}
-				}
-				else{
-
-					for (l = 0; l < num_attr; l++) {
-						for (m = 0; m < num_aggregations; m++) {
-							if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-
-								memcpy(needed_values[m].data, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-								needed_values[m].data[temp->tuple_dict[k + l].size] = '\0';
-
-								if (needed_values[m].agg_task == AGG_TASK_GROUP) {
-									search_parameters[n].iSearchType = SEARCH_PARTICULAR;
-									search_parameters[n].pData_lower = AK_malloc(temp->tuple_dict[k + l].size + 1);
-									memcpy(search_parameters[n].pData_lower, &(temp->data[temp->tuple_dict[k + l].address]), temp->tuple_dict[k + l].size);
-									((char *) search_parameters[n].pData_lower)[ temp->tuple_dict[k + l].size ] = '\0';
-									search_parameters[n].szAttribute = (temp->header[l].att_name);
-									n++;
-								}
-							}
-						}
-					}
-
-					sresult = AK_search_unsorted(new_table, search_parameters, agg_group_number);
-
-					if (sresult.iNum_tuple_addresses == 0) {
-						AK_DeleteAll_L3(&row_root);
-
-						for (l = 0; l < num_aggregations; l++) {
-							switch (needed_values[l].agg_task) {
-								case AGG_TASK_COUNT:
-									//no break is intentional
-								case AGG_TASK_AVG_COUNT:
-									inttemp = 1;
-									/**
-									 * THIS SINGLE LINE BELOW (memcpy) is the purpose of ALL evil in the world!
-									 * This line is the reason why test function prints one extra empty 
-									 * row with "nulls" at the end! Trust me! Comment it, and you will see - 
-									 * test function will not print extra row with nulls (but counts and averages 
-									 * in table will be all messed up!)
-									 * After two days of hard research, I still have not found what is the
-									 * reason behind printing extra row at the end! Fellow programmer,
-									 * if you really really want to solve this issue, arm yourself with
-									 * at least 2 liters of hot coffee!
-									 *
-									 * What this line does? What is the purpose of this line in the universe?
-									 * Well, fellow programmer, this line sets the initial count to 1.
-									 * That means if name "Ivan" is found, it will have count of 1
-									 * because, well, that's the first Ivan that is found!
-									 * If function finds another Ivan (which, actually, will happen),
-									 * this part of code will not handle it (other part of code will).
-									 *
-									 * That actually means that this little piece of code 
-									 * (this line below) only (and ONLY) sets count to 1! And besides that
-									 * causes every other evil in the world. :O
-									 *
-									 * P.S. The reason for that may be in linked list, or in AK_insert_row()
-									 * You'll have to check every piece of AKDB code to find cause!
-									 * I have found out that additional line is added when k == 25.
-									 * There may be problem in linked lists or in AK_insert_row function
-									 * or somewhere else. Who knows.
-									 *
-									 * If I didn't handle that last row (which has one attribute of size 0),
-									 * test would not pass!
-									 *
-									 * Good luck, fellow programmer!
-									 */
-									memcpy(needed_values[l].data, &inttemp, sizeof(int));
-									needed_values[l].data[sizeof (int) ] = '\0';
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root);
-									break;
-
-								case AGG_TASK_AVG:
-									//no break is intentional
-								case AGG_TASK_MAX:
-									//no break is intentional
-								case AGG_TASK_MIN:
-									//no break is intentional
-								case AGG_TASK_SUM:
-									//no break is intentional
-								case AGG_TASK_GROUP:
-									//no break is intentional
-								case AGG_TASK_AVG_SUM:
-									//no break is intentional
-								default:
-									AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root);
-							}
-
-						}
-                        //FILE  -  fix this!
-						AK_insert_row(row_root);
-
-					} else {
-						mem_block = AK_get_block(sresult.aiBlocks[0]);
-
-						for (l = 0; l < num_attr; l++) {
-							for (m = 0; m < num_aggregations; m++) {
-								if (strcmp(needed_values[m].att_name, temp->header[l].att_name) == 0) {
-									switch (needed_values[m].agg_task) {
-										case AGG_TASK_COUNT:
-											//no break is intentional
-										case AGG_TASK_AVG_COUNT:
-											inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address)) + 1;
-											memcpy(&mem_block->block->data[mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address], &inttemp, sizeof (int));
-											break;
-
-										case AGG_TASK_SUM:
-											//no break is intentional
-										case AGG_TASK_AVG_SUM:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int*) needed_values[m].data) + *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float*) needed_values[m].data) + *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double*) needed_values[m].data) + *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													break;
-											}
-											break;
-
-										case AGG_TASK_MAX:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) > inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) > floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) > doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_MIN:
-											switch (agg_head[m].type) {
-												case TYPE_INT:
-													inttemp = *((int *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((int*) needed_values[m].data) < inttemp) {
-														inttemp = *((int*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &inttemp, sizeof (int));
-													}
-													break;
-
-												case TYPE_FLOAT:
-													floattemp = *((float *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((float*) needed_values[m].data) < floattemp) {
-														floattemp = *((float*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-													}
-													break;
-
-												case TYPE_NUMBER:
-													doubletemp = *((double *) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address));
-													if (*((double*) needed_values[m].data) < doubletemp) {
-														doubletemp = *((double*) needed_values[m].data);
-														memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &doubletemp, sizeof (double));
-													}
-													break;
-											}
-											break;
-
-										case AGG_TASK_AVG:
-											inttemp = floattemp = -1;
-											for (o = 0; o < num_aggregations; o++) {
-												sprintf(agg_h_name, "_cAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													inttemp = *((int*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-												sprintf(agg_h_name, "_sAvg(%s)", needed_values[m].att_name);
-
-												if (strcmp(agg_h_name, mem_block->block->header[o].att_name) == 0) {
-													floattemp = *((float*) (mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + o].address));
-												}
-
-												if (inttemp != -1 && doubletemp != -1)
-													break;
-											}
-											floattemp = floattemp / (float) inttemp;
-											memcpy(mem_block->block->data + mem_block->block->tuple_dict[sresult.aiTuple_addresses[i] + m].address, &floattemp, sizeof (float));
-											break;
-
-										case AGG_TASK_GROUP:
-											break;
-									}
-								}
-							}
-						}
-						AK_deallocate_search_result(sresult);
-						
-						AK_DeleteAll_L3(&row_root);
-
-						for (l = 0; l<num_aggregations;l++) {
-							if (needed_values[l].agg_task == AGG_TASK_GROUP)
-							   inttemp = 1;
-							else
-								inttemp = 0;
-							AK_Insert_New_Element_For_Update(agg_head[l].type, needed_values[l].data, new_table, agg_head[l].att_name, row_root, inttemp);
-						}
-
-						//AK_update_delete_row_from_block(mem_block->block, row_root, 0);
-                        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-					}
-				}
+/**
+ * @brief  Function that drains the input of an aggregation operator by batches into the groups of a hash aggregation table
+ */
+static int AK_agg_iterator_open(AK_iterator *iterator) {
+    AK_agg_iterator_state *state = (AK_agg_iterator_state *) iterator->state;
+    AK_iterator *input = iterator->input[0];
+    AK_agg_plan *plan = &state->plan;
+    AK_batch *batch = state->batch;
+    AK_sort_value values[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int result, position, i, j;
+
+    if (AK_iterator_open(input) == EXIT_ERROR)
+        return EXIT_ERROR;
+    AK_agg_init_table(&state->table);
+    state->open = 1;
+    state->position = 0;
+
+    //without GROUP attributes there is exactly one group, also for an empty input
+    if (plan->num_group == 0) {
+        AK_agg_find(&state->table, values, plan, AK_agg_hash_group(values, plan, 0), &position);
+        AK_agg_insert(&state->table, values, plan, AK_agg_hash_group(values, plan, 0), position);
+    }
+    while ((result = AK_iterator_next_batch(input, batch)) > 0) {
+        AK_agg_hash_batch(batch, plan, state->hash);
+        for (j = 0; j < batch->num_sel; j++) {
+            AK_batch_row(batch, batch->sel[j], type, size, data);
+            for (i = 0; i < plan->num_group; i++) {
+                values[plan->group[i]].type = type[plan->group[i]];
+                values[plan->group[i]].size = size[plan->group[i]];
+                values[plan->group[i]].data = data[plan->group[i]];
             }
+            if ((state->group[j] = AK_agg_find(&state->table, values, plan, state->hash[j], &position)) == NULL
+                    && (state->group[j] = AK_agg_insert(&state->table, values, plan, state->hash[j], position)) == NULL)
+                break;
+        }
+        if (j < batch->num_sel || AK_agg_update_batch(&state->table, state->group, batch, plan) != EXIT_SUCCESS) {
+            result = EXIT_ERROR;
+            break;
         }
-        i++;
     }
+    AK_iterator_close(input);
+    if (result == EXIT_ERROR) {
+        AK_agg_iterator_close(iterator);
+        return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
+}
 
-    //if there is no grouping, we only need to insert one row into the table and we can insert it straight into the destination table
-    if(agg_group_number == 0)
-	{
+static int AK_agg_iterator_next(AK_iterator *iterator) {
+    AK_agg_iterator_state *state = (AK_agg_iterator_state *) iterator->state;
+    struct list_node *el;
+    int i;
 
-    	AK_header agg_head_final[MAX_ATTRIBUTES];
-    	j = 0;
+    if (state->position >= state->table.num_groups)
+        return 0;
+    AK_agg_group_values(state->table.groups[state->position++], &state->plan, state->out_row);
+    for (i = 0, el = AK_First_L2(state->out_row); i < iterator->num_attr; i++, el = el->next) {
+        iterator->type[i] = el->type;
+        iterator->size[i] = el->size;
+        iterator->data[i] = el->data;
+    }
+    return 1;
+}
 
-    	for (i = 0; i < num_aggregations; i++) {
-			if (agg_head[i].att_name[0] != '_') {
-				agg_head_final[j] = agg_head[i];
-				j++;
-			}
-		}
+AK_iterator *AK_aggregation_iterator(AK_iterator *input, AK_agg_input *agg) {
+    AK_header agg_head[MAX_ATTRIBUTES + 1];
+    AK_agg_iterator_state *state;
+    AK_iterator *iterator;
+    AK_PRO;
 
-    	startAddress = AK_initialize_new_segment(agg_table, SEGMENT_TYPE_TABLE, agg_head_final);
-
-		if (startAddress != EXIT_ERROR)
-			printf("\nTABLE %s CREATED!\n", agg_table);
-
-    	
-	AK_DeleteAll_L3(&row_root);
-
-		for (l = 0; l < num_aggregations; l++) 
-		{
-
-			switch (needed_values[l].agg_task) {
-
-				case AGG_TASK_AVG_SUM:
-					floattemp = *((float *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG_COUNT:
-					inttemp = *((int *)needed_values[l].data);
-					break;
-
-				case AGG_TASK_AVG:
-					floattemp = floattemp/inttemp;
-					memcpy(needed_values[l].data, &floattemp, sizeof(float));
-					needed_values[l].data[sizeof(float)] = '\0';
-					//no break is intentional
-				case AGG_TASK_COUNT:
-					//no break is intentional
-				case AGG_TASK_MAX:
-					//no break is intentional
-				case AGG_TASK_MIN:
-					//no break is intentional
-				case AGG_TASK_SUM:
-					//no break is intentional
-				default:
-					AK_Insert_New_Element(agg_head[l].type, needed_values[l].data, agg_table, agg_head[l].att_name, row_root);
-					break;
-			}
-		}
-		AK_insert_row(row_root);
+    if (input == NULL) {
+        AK_EPI;
+        return NULL;
     }
-    else
-	{
-		//TODO: move struct to .h
-	struct list_node * projection_att = (struct list_node*) AK_malloc(sizeof(struct list_node));
-	AK_Init_L3(&projection_att);
-
-	for (i = 0; i < num_aggregations; i++) 
-		{
-			if (agg_head[i].att_name[0] != '_') 
-			{
-				AK_InsertAtEnd_L3(TYPE_ATTRIBS, agg_head[i].att_name, strlen(agg_head[i].att_name), projection_att);
-
-			}
-		}
-
-		AK_projection(new_table, agg_table, projection_att,NULL);
+    state = (AK_agg_iterator_state *) AK_calloc(1, sizeof (AK_agg_iterator_state));
+    if (AK_agg_resolve(agg, input->header, input->num_attr, "the input", &state->plan, agg_head) == EXIT_ERROR) {
+        AK_free(state);
+        AK_iterator_free(input);
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_new(state->plan.num_out, agg_head);
+    state->batch = AK_iterator_batch(input);
+    state->out_row = AK_iterator_row_list(iterator, NULL);
+    iterator->state = state;
+    iterator->free_state = AK_agg_iterator_free;
+    iterator->input[0] = input;
+    iterator->open = AK_agg_iterator_open;
+    iterator->next = AK_agg_iterator_next;
+    iterator->close = AK_agg_iterator_close;
+    AK_EPI;
+    return iterator;
+}
 
-		
-		AK_DeleteAll_L3(&projection_att);
-		AK_free(projection_att);
+/**
+ * @brief  Function that checks a grouped aggregation of the agg_numbers table. Row i has g = i % groups and v = i, so group
+ *         g has rows g, g + groups, ... and its COUNT, SUM, MIN, MAX and AVG of v are known.
+ * @param tblName aggregated table name
+ * @param groups number of groups
+ * @param per_group number of rows per group
+ * @return 1 if the result is correct, 0 otherwise
+ */
+static int AK_aggregation_test_check(char *tblName, int groups, int per_group) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *row, *el;
+    char *seen = (char *) AK_calloc(groups, 1);
+    int rows = 0, errors = 0, first = 1, g, count, sum, min, max, i;
+    float avg;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            for (i = 0, el = AK_First_L2(row); i < 6 && el != NULL; i++, el = el->next)
+                values[i] = el;
+            first = 0;
+        }
+        memcpy(&g, values[0]->data, sizeof (int));
+        memcpy(&count, values[1]->data, sizeof (int));
+        memcpy(&sum, values[2]->data, sizeof (int));
+        memcpy(&min, values[3]->data, sizeof (int));
+        memcpy(&max, values[4]->data, sizeof (int));
+        memcpy(&avg, values[5]->data, sizeof (float));
+        if (g < 0 || g >= groups || seen[g] || count != per_group
+                || sum != per_group * g + groups * per_group * (per_group - 1) / 2 || min != g
+                || max != g + groups * (per_group - 1) || avg != (float) ((double) sum / per_group))
+            errors++;
+        else
+            seen[g] = 1;
+        rows++;
     }
-	AK_free(addresses);
-		
+    AK_table_cursor_close(cursor);
+    AK_free(seen);
 
-        //TODO replace this segment with AK_drop_table() once when it's done
-	addresses = (table_addresses*) AK_get_table_addresses(new_table);
-	i = 0;
-	while (addresses->address_from[i] != 0) 
-	{
-		AK_delete_extent(addresses->address_from[i], addresses->address_to[i]);
-		i++;
-	}
-	for (i = 0; i < num_aggregations; i++)
-		AK_free(agg_head_ptr[i]);
-    AK_free(needed_values);
-    AK_free(row_root);
-    AK_free(temp);
-	AK_free(addresses);
-    AK_EPI;
-    return EXIT_SUCCESS;
+    if (errors > 0 || rows != groups)
+        printf("AK_aggregation_test: %s has %d groups (expected %d), %d of them wrong\n", tblName, rows, groups, errors);
+    return errors == 0 && rows == groups;
 }
 
-//TODO: Needs description
+/**
+ * @brief  Function for testing the aggregation. The student table is grouped by first name and checked against the sums
+ *         computed here. A table of 20000 rows is then grouped into 1000 groups with the default memory budget and with a
+ *         budget that spills most of the groups into partitions, and aggregated without groups.
+ * @return test result
+ */
 TestResult AK_aggregation_test() {
     AK_PRO;
     printf("aggregation.c: Present!\n");
@@ -784,6 +1100,7 @@ TestResult AK_aggregation_test() {
 		min_weight_address;
 
 	int num_errors = 0;  // this will count number of errors
+	int success = 0, failed = 0;
 
 	float tmp_avg_weight, tmp_sum_weights,  // placeholders for temp data loaded from the block
 		  tmp_max_weight, tmp_min_weight;
@@ -883,6 +1200,98 @@ TestResult AK_aggregation_test() {
     } else {
     	printf("\nTEST FAILED! Number of errors: %d\n", num_errors);
     }
+    num_errors == 0 ? success++ : failed++;
+
+    /* grouping a larger table in memory and with spilled partitions */
+    AK_header numbers_head[3];
+    AK_table_writer *writer;
+    struct list_node *row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    struct list_node *g, *v;
+    char name[MAX_ATT_NAME];
+    double start, memory_ms, spill_ms;
+    int groups = 1000, per_group = 20, number, p;
+
+    memset(numbers_head, 0, sizeof (numbers_head));
+    numbers_head[0].type = TYPE_INT;
+    strcpy(numbers_head[0].att_name, "g");
+    numbers_head[1].type = TYPE_INT;
+    strcpy(numbers_head[1].att_name, "v");
+    AK_initialize_new_segment("agg_numbers", SEGMENT_TYPE_TABLE, numbers_head);
+    writer = AK_table_writer_open("agg_numbers");
+    AK_Init_L3(&row);
+    g = row->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    v = g->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    g->type = v->type = TYPE_INT;
+    g->size = v->size = sizeof (int);
+    for (i = 0; i < groups * per_group; i++) {
+        number = i % groups;
+        memcpy(g->data, &number, sizeof (int));
+        memcpy(v->data, &i, sizeof (int));
+        AK_table_writer_append(writer, row);
+    }
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+
+    AK_agg_input numbers;
+    AK_agg_input_init(&numbers);
+    AK_agg_input_add(numbers_head[0], AGG_TASK_GROUP, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_COUNT, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_SUM, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_MIN, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_MAX, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_AVG, &numbers);
+
+    start = TEST_time_ms();
+    if (AK_aggregation(&numbers, "agg_numbers", "agg_numbers_memory") == EXIT_SUCCESS)
+        AK_aggregation_test_check("agg_numbers_memory", groups, per_group) ? success++ : failed++;
+    else
+        failed++;
+    memory_ms = TEST_time_ms() - start;
+
+    //64 KB keeps about a quarter of the groups in memory, the rest is spilled
+    start = TEST_time_ms();
+    if (AK_hash_aggregation(&numbers, "agg_numbers", "agg_numbers_spill", 64 * 1024) == EXIT_SUCCESS)
+        AK_aggregation_test_check("agg_numbers_spill", groups, per_group) ? success++ : failed++;
+    else
+        failed++;
+    spill_ms = TEST_time_ms() - start;
+    for (p = 0; p < AK_AGG_MAX_PARTITIONS; p++) {
+        snprintf(name, MAX_ATT_NAME, "agg_numbers_spill_agg_1_%d", p);
+        if (AK_num_attr(name) > 0) {
+            printf("AK_aggregation_test: partition %s was not deleted\n", name);
+            failed++;
+        }
+    }
+
+    //without GROUP attributes the whole table is one row
+    AK_agg_input_init(&numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_COUNT, &numbers);
+    AK_agg_input_add(numbers_head[1], AGG_TASK_SUM, &numbers);
+    if (AK_aggregation(&numbers, "agg_numbers", "agg_numbers_total") == EXIT_SUCCESS) {
+        AK_table_cursor *cursor = AK_table_cursor_open("agg_numbers_total");
+        struct list_node *total = AK_table_cursor_next(cursor);
+        int count = -1, sum = -1;
+        if (total != NULL) {
+            memcpy(&count, AK_First_L2(total)->data, sizeof (int));
+            memcpy(&sum, AK_First_L2(total)->next->data, sizeof (int));
+        }
+        if (count == groups * per_group && sum == groups * per_group * (groups * per_group - 1) / 2 && AK_table_cursor_next(cursor) == NULL)
+            success++;
+        else {
+            printf("AK_aggregation_test: agg_numbers_total has COUNT %d and SUM %d\n", count, sum);
+            failed++;
+        }
+        AK_table_cursor_close(cursor);
+    } else
+        failed++;
+
+    printf("\nGrouping %d rows into %d groups: %.0f ms in memory, %.0f ms with 64 KB\n", groups * per_group, groups, memory_ms, spill_ms);
+    AK_delete_segment("agg_numbers_memory", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("agg_numbers_spill", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("agg_numbers_total", SEGMENT_TYPE_TABLE);
+    AK_delete_segment("agg_numbers", SEGMENT_TYPE_TABLE);
 
     AK_EPI;
+    return TEST_result(success, failed);
 }
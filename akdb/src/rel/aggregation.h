@@ -26,6 +26,7 @@
 #include "../file/filesearch.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "../file/filesort.h"
 
 #define AGG_TASK_GROUP 1
 #define AGG_TASK_COUNT 2
@@ -36,6 +37,24 @@
 #define AGG_TASK_AVG_COUNT 10 //used internaly
 #define AGG_TASK_AVG_SUM 11 //used internaly
 
+/**
+ * @def AK_AGG_MAX_PARTITIONS
+ * @brief Constant declaring the number of partitions the rows of groups that do not fit the memory budget are spilled into
+ */
+#define AK_AGG_MAX_PARTITIONS 8
+
+/**
+ * @def AK_AGG_MAX_DEPTH
+ * @brief Constant declaring how many times spilled rows are partitioned again before the memory budget is ignored
+ */
+#define AK_AGG_MAX_DEPTH 4
+
+/**
+ * @def AK_AGG_ARENA_CHUNK
+ * @brief Constant declaring the size of the memory chunks the groups of a hash aggregation are kept in
+ */
+#define AK_AGG_ARENA_CHUNK (256 * 1024)
+
 /**
   * @author Unknown
   * @struct AK_agg_value
@@ -57,6 +76,81 @@ typedef struct {
     int counter;
 } AK_agg_input;
 
+/**
+  * @struct AK_agg_plan
+  * @brief Structure that contains an aggregation with the attribute indexes resolved, AVG_COUNT and AVG_SUM tasks left out
+  */
+typedef struct {
+    /// number of attributes of the source table
+    int num_attr;
+    /// number of GROUP attributes and their indexes in the source table
+    int num_group;
+    int group[MAX_ATTRIBUTES];
+    /// number of attributes of the aggregated table
+    int num_out;
+    /// for every attribute of the aggregated table: its task, source attribute index, source type and type
+    int task[MAX_ATTRIBUTES];
+    int column[MAX_ATTRIBUTES];
+    int type[MAX_ATTRIBUTES];
+    int out_type[MAX_ATTRIBUTES];
+    /// for GROUP attributes, the index of the value in the group key
+    int key[MAX_ATTRIBUTES];
+} AK_agg_plan;
+
+/**
+  * @struct AK_agg_slot
+  * @brief Structure that contains the running value of one aggregation of a group
+  */
+typedef struct {
+    /// number of rows aggregated so far
+    int count;
+    /// running sum in the type of the aggregated attribute
+    union {
+        int i;
+        float f;
+        double d;
+    } sum;
+    /// current minimum or maximum value
+    char *data;
+    int size;
+    int capacity;
+} AK_agg_slot;
+
+/**
+  * @struct AK_agg_group
+  * @brief Structure that contains a group of a hash aggregation: its key values followed by a slot for every aggregation
+  */
+typedef struct {
+    unsigned int hash;
+    AK_sort_value *key;
+    AK_agg_slot *slots;
+} AK_agg_group;
+
+/**
+  * @struct AK_agg_chunk
+  * @brief Structure that contains a memory chunk of a hash aggregation
+  */
+typedef struct AK_agg_chunk {
+    struct AK_agg_chunk *next;
+    long used;
+    char data[AK_AGG_ARENA_CHUNK];
+} AK_agg_chunk;
+
+/**
+  * @struct AK_agg_table
+  * @brief Structure that contains the groups of a hash aggregation in an open addressing hash table, keyed by the group
+  *        attributes. Groups are also listed in the order they were found.
+  */
+typedef struct {
+    int capacity;
+    int num_groups;
+    int max_groups;
+    AK_agg_group **slots;
+    AK_agg_group **groups;
+    AK_agg_chunk *chunks;
+    long used;
+} AK_agg_table;
+
 /**
  @author Dejan Frankovic
  @brief  Function that calculates how many attributes there are in the header with a while loop.
@@ -109,12 +203,8 @@ void AK_agg_input_fix(AK_agg_input *input);
 
 /**
    @author Dejan Frankovic
-   @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
-          AGG_TASK_AVG_SUM are put on the beginning of the input object. Then for loop iterates through
-          input tasks and assignes the type of aggregation operation according to aggregation operation.
-	  New table has to be created. For loop goes through given table. GROUP operation is executed separately
-	  from other operations. Addresses of records are put in needed_values array and
-	  results are put in new table.
+   @brief Function that aggregates a given table by given attributes with a hash aggregation in the memory budget set by
+          aggregation:hash_aggregation_memory, see AK_hash_aggregation
    @param input input object with list of atributes by which we aggregate and types of aggregations
    @param source_table - table name for the source table
    @param agg_table  table name for aggregated table
@@ -122,6 +212,31 @@ void AK_agg_input_fix(AK_agg_input *input);
 
  */
 int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table);
+
+/**
+   @brief Function that aggregates a table in one pass. Attribute indexes are resolved once, every row is hashed on the
+          GROUP attributes and its group is looked up in an open addressing hash table that keeps a slot per aggregation
+          (COUNT, SUM, MIN, MAX and AVG). When the groups fill the memory budget, rows of groups that are not in memory are
+          spilled by hash into temp segments, which are aggregated the same way after the in-memory groups are written.
+          Without GROUP attributes the whole table is one group and one row is written even for an empty table.
+          Groups are written in the order they were first found, AVG_COUNT and AVG_SUM tasks are ignored.
+   @param input input object with list of atributes by which we aggregate and types of aggregations
+   @param source_table table name for the source table
+   @param agg_table table name for aggregated table, it is created by the function
+   @param memory memory budget for the groups in bytes
+   @return EXIT_SUCCESS, EXIT_ERROR if an attribute does not exist or SUM or AVG is asked for an attribute that is not a number
+ */
+int AK_hash_aggregation(AK_agg_input *input, char *source_table, char *agg_table, int memory);
+
+/**
+   @brief Function that aggregates the rows of an operator as AK_hash_aggregation aggregates a table. The input is drained
+          into the groups when the operator is opened and the groups are returned in the order they were first found.
+          The groups are kept in memory, they are not spilled.
+   @param input input operator, freed with the aggregation
+   @param agg input object with list of atributes by which we aggregate and types of aggregations
+   @return operator, NULL if input is NULL or the aggregation does not fit its header
+ */
+AK_iterator *AK_aggregation_iterator(AK_iterator *input, AK_agg_input *agg);
 TestResult AK_aggregation_test();
 
 #endif
@@ -23,15 +23,13 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 #include "../sql/drop.h"
 
 /**
  * @author Dino Laktašić
- * @brief  Function that produces a difference of the two tables. Table addresses are get through names of tables.
- *         Specially start addresses are taken from them. They are used to allocate blocks for them. It is checked whether
-           the tables have same table schemas. If not, it returns EXIT_ERROR. New segment for result of difference operation is
-           initialized. Function compares every block in extent of the first table with every block in extent of second table. If there 
-	   is a difference between their rows, they are put in dstTable.
+ * @brief  Function that produces a difference of the two tables with the same schema. Rows of the first table that are not
+ *         found in the second one are written once, see AK_hash_set_op.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
@@ -60,12 +60,16 @@ int AK_check_arithmetic_statement(struct list_node *el, const char *op, const ch
 		switch (el->type) {
 
 			case TYPE_INT:
+				AK_EPI;
 				return *(int *) a > *(int *) b;
 			case TYPE_FLOAT:
+				AK_EPI;
 				return *((float *) a) > *((float *) b);
 			case TYPE_NUMBER:
+				AK_EPI;
 				return *((double *) a) > *((double *) b);
 			case TYPE_VARCHAR:
+				AK_EPI;
 				return strcmp((const char *) a, (const char *) b) > 0;
 
 		}
@@ -75,12 +79,16 @@ int AK_check_arithmetic_statement(struct list_node *el, const char *op, const ch
 		switch (el->type) {
 
 			case TYPE_INT:
+				AK_EPI;
 				return *(int *) a <= *(int *) b;
 			case TYPE_FLOAT:
+				AK_EPI;
 				return *((float *) a) <= *((float *) b);
 			case TYPE_NUMBER:
+				AK_EPI;
 				return *((double *) a) <= *((double *) b);
 			case TYPE_VARCHAR:
+				AK_EPI;
 				return strcmp((const char *) a, (const char *) b) <= 0;
 
 		}
@@ -90,12 +98,16 @@ int AK_check_arithmetic_statement(struct list_node *el, const char *op, const ch
 		switch (el->type) {
 
 				case TYPE_INT:
+					AK_EPI;
 					return *(int *) a >= *(int *) b;
 				case TYPE_FLOAT:
+					AK_EPI;
 					return *((float *) a) >= *((float *) b);
 				case TYPE_NUMBER:
+					AK_EPI;
 					return *((double *) a) >= *((double *) b);
 				case TYPE_VARCHAR:
+					AK_EPI;
 					return strcmp((const char *) a, (const char *) b) >= 0;
 
 			}
@@ -168,6 +180,7 @@ int AK_check_arithmetic_statement(struct list_node *el, const char *op, const ch
 				return EXIT_ERROR;
 		}
 	}
+	AK_EPI;
 	return 0;
 }
 /**
@@ -504,6 +517,398 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     AK_EPI;
     return result;
 }
+/**
+ * @brief  Function that compiles a constant pattern of a compiled expression the same way AK_check_regex_expression does
+ * @param pattern pattern
+ * @param sensitive case insensitive indicator 1-case sensitive,0- case insensitive
+ * @param wildcards replaces SQL wildcard to correesponding POSIX regex charachter
+ * @return compiled regex, NULL if the pattern is not a valid regex
+ */
+static regex_t *AK_compile_expression_regex(const char *pattern, int sensitive, int wildcards) {
+    regex_t *regex = (regex_t *) AK_malloc(sizeof (regex_t));
+    char *expression = (char *) pattern;
+    char *result;
+    AK_PRO;
+
+    if (wildcards) {
+        result = AK_replace_wild_card(pattern, '%', ".*");
+        expression = AK_replace_wild_card(result, '_', ".");
+        AK_free(result);
+    }
+    if (regcomp(regex, expression, sensitive ? REG_EXTENDED : REG_ICASE)) {
+        printf("Could not compile regular expression, check your sintax.\n");
+        AK_free(regex);
+        regex = NULL;
+    }
+    if (wildcards)
+        AK_free(expression);
+    AK_EPI;
+    return regex;
+}
+
+/**
+ * @brief  Function that compiles a logical expression in postfix notation for the given table header. Attribute names are
+ *         resolved to attribute indexes, operators to opcodes and constant LIKE, SIMILAR TO and regex patterns are compiled once.
+ * @param expr list with the logical expression in postfix notation
+ * @param header header of the table the expression is checked against
+ * @param num_attr number of attributes in the header
+ * @return compiled expression, NULL if the expression uses an operator or attribute the compiled form does not support,
+ *         in that case AK_check_if_row_satisfies_expression has to be used
+ */
+AK_compiled_expression *AK_compile_expression(struct list_node *expr, AK_header *header, int num_attr) {
+    AK_compiled_expression *compiled;
+    AK_expression_instruction *instruction;
+    struct list_node *el;
+    int i, num_elements = 0, values = 0, results = 0, supported = 1;
+    AK_PRO;
+
+    if (expr == NULL || AK_First_L2(expr) == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    for (el = AK_First_L2(expr); el; el = el->next)
+        num_elements++;
+
+    compiled = (AK_compiled_expression *) AK_calloc(1, sizeof (AK_compiled_expression));
+    compiled->instructions = (AK_expression_instruction *) AK_calloc(num_elements, sizeof (AK_expression_instruction));
+    compiled->values = (AK_expression_value *) AK_calloc(num_elements, sizeof (AK_expression_value));
+    compiled->results = (char *) AK_calloc(num_elements, sizeof (char));
+
+    for (el = AK_First_L2(expr); el && supported; el = el->next) {
+        instruction = &compiled->instructions[compiled->num_instructions++];
+
+        if (el->type == TYPE_ATTRIBS) {
+            for (i = 0; i < num_attr && strcmp(el->data, header[i].att_name) != 0; i++);
+            if (i == num_attr) {
+                AK_dbg_messg(MIDDLE, REL_OP, "Expression ckeck was not able to find column: %s\n", el->data);
+                supported = 0;
+            }
+            instruction->opcode = AK_EXPR_ATTRIBUTE;
+            instruction->column = i;
+            values++;
+        } else if (el->type == TYPE_OPERATOR) {
+            instruction->opcode = AK_EXPR_COMPARE;
+            if (strcmp(el->data, "=") == 0)
+                instruction->comparison = AK_EXPR_EQ;
+            else if (strcmp(el->data, "<>") == 0)
+                instruction->comparison = AK_EXPR_NE;
+            else if (strcmp(el->data, "<") == 0)
+                instruction->comparison = AK_EXPR_LT;
+            else if (strcmp(el->data, ">") == 0)
+                instruction->comparison = AK_EXPR_GT;
+            else if (strcmp(el->data, "<=") == 0)
+                instruction->comparison = AK_EXPR_LE;
+            else if (strcmp(el->data, ">=") == 0)
+                instruction->comparison = AK_EXPR_GE;
+            else if (strcmp(el->data, "BETWEEN") == 0)
+                instruction->opcode = AK_EXPR_BETWEEN;
+            else if (strcmp(el->data, "AND") == 0)
+                instruction->opcode = AK_EXPR_AND;
+            else if (strcmp(el->data, "OR") == 0)
+                instruction->opcode = AK_EXPR_OR;
+            else {
+                instruction->opcode = AK_EXPR_MATCH;
+                if (strcmp(el->data, "LIKE") == 0 || strcmp(el->data, "~~") == 0 || strcmp(el->data, "SIMILAR TO") == 0) {
+                    instruction->sensitive = 1;
+                    instruction->wildcards = 1;
+                } else if (strcmp(el->data, "ILIKE") == 0 || strcmp(el->data, "~~*") == 0) {
+                    instruction->wildcards = 1;
+                } else if (strcmp(el->data, "~") == 0) {
+                    instruction->sensitive = 1;
+                } else if (strcmp(el->data, "~*") != 0) {
+                    //arithmetic operators produce values, which only the interpreter handles
+                    supported = 0;
+                }
+            }
+
+            switch (instruction->opcode) {
+                case AK_EXPR_COMPARE:
+                case AK_EXPR_MATCH:
+                    supported = supported && values >= 2;
+                    values -= 2;
+                    results++;
+                    break;
+                case AK_EXPR_BETWEEN:
+                    supported = values >= 3;
+                    values -= 3;
+                    results++;
+                    break;
+                default:
+                    supported = results >= 2;
+                    results--;
+            }
+
+            if (supported && instruction->opcode == AK_EXPR_MATCH && (instruction - 1)->opcode == AK_EXPR_CONSTANT) {
+                instruction->regex = AK_compile_expression_regex((instruction - 1)->data, instruction->sensitive, instruction->wildcards);
+                instruction->invalid = instruction->regex == NULL;
+            }
+        } else {
+            instruction->opcode = AK_EXPR_CONSTANT;
+            instruction->type = el->type;
+            instruction->size = MAX_VARCHAR_LENGTH;
+            memcpy(instruction->data, el->data, MAX_VARCHAR_LENGTH);
+            instruction->data[MAX_VARCHAR_LENGTH - 1] = '\0';
+            values++;
+        }
+    }
+
+    if (!supported || results == 0) {
+        AK_free_compiled_expression(compiled);
+        AK_EPI;
+        return NULL;
+    }
+    AK_EPI;
+    return compiled;
+}
+
+/**
+ * @brief  Function that reads a numeric operand of a compiled expression
+ * @param value operand
+ * @return value of the operand
+ */
+static double AK_expression_value_number(AK_expression_value *value) {
+    int i;
+    float f;
+    double d;
+
+    switch (value->type) {
+        case TYPE_INT:
+            memcpy(&i, value->data, sizeof (int));
+            return i;
+        case TYPE_FLOAT:
+            memcpy(&f, value->data, sizeof (float));
+            return f;
+        default:
+            memcpy(&d, value->data, sizeof (double));
+            return d;
+    }
+}
+
+/**
+ * @brief  Function that compares two operands of a compiled expression in the type of the right operand, like
+ *         AK_check_arithmetic_statement does. Numbers of different types are compared as doubles. Strings are compared
+ *         without copying them, a value stored in a block is not terminated by '\0'.
+ * @param a left operand
+ * @param b right operand
+ * @return negative value, zero or positive value if a is less than, equal to or greater than b
+ */
+static int AK_compare_expression_values(AK_expression_value *a, AK_expression_value *b) {
+    int a_numeric = a->type == TYPE_INT || a->type == TYPE_FLOAT || a->type == TYPE_NUMBER;
+    int b_numeric = b->type == TYPE_INT || b->type == TYPE_FLOAT || b->type == TYPE_NUMBER;
+    int ia, ib, la, lb, result;
+    float fa, fb;
+    double da, db;
+
+    if (a_numeric && b_numeric && a->type != b->type) {
+        da = AK_expression_value_number(a);
+        db = AK_expression_value_number(b);
+        return (da > db) - (da < db);
+    }
+
+    switch (b->type) {
+        case TYPE_INT:
+            memcpy(&ia, a->data, sizeof (int));
+            memcpy(&ib, b->data, sizeof (int));
+            return (ia > ib) - (ia < ib);
+        case TYPE_FLOAT:
+            memcpy(&fa, a->data, sizeof (float));
+            memcpy(&fb, b->data, sizeof (float));
+            return (fa > fb) - (fa < fb);
+        case TYPE_NUMBER:
+            memcpy(&da, a->data, sizeof (double));
+            memcpy(&db, b->data, sizeof (double));
+            return (da > db) - (da < db);
+        default:
+            la = strnlen(a->data, a->size);
+            lb = strnlen(b->data, b->size);
+            result = memcmp(a->data, b->data, la < lb ? la : lb);
+            return result ? result : la - lb;
+    }
+}
+
+/**
+ * @brief  Function that copies an operand of a compiled expression to a string
+ * @param value operand
+ * @param string buffer of MAX_VARCHAR_LENGTH characters
+ * @return the string
+ */
+static char *AK_expression_value_string(AK_expression_value *value, char *string) {
+    int size = strnlen(value->data, value->size < MAX_VARCHAR_LENGTH ? value->size : MAX_VARCHAR_LENGTH - 1);
+
+    memcpy(string, value->data, size);
+    string[size] = '\0';
+    return string;
+}
+
+/**
+ * @brief  Function that evaluates a compiled expression on a tuple in a block or on a row of values
+ * @param compiled compiled expression
+ * @param block block of the tuple, NULL if the values are given in arrays
+ * @param tuple tuple dictionary index of the first attribute of the tuple
+ * @param split number of attributes read from the first block
+ * @param block2 block of the second part of the tuple, NULL if there is none
+ * @param tuple2 tuple dictionary index of the first attribute of the second part
+ * @param type types of the values of the row when block is NULL
+ * @param size sizes of the values
+ * @param data values
+ * @return 1 if the tuple satisfies the expression, 0 otherwise
+ */
+static int AK_evaluate_compiled_expression(AK_compiled_expression *compiled, AK_block *block, int tuple, int split, AK_block *block2,
+        int tuple2, int *type, int *size, char **data) {
+    AK_expression_instruction *instruction;
+    AK_expression_value *a, *b, *c;
+    AK_expression_value *values = compiled->values;
+    char *results = compiled->results;
+    char value[MAX_VARCHAR_LENGTH], pattern[MAX_VARCHAR_LENGTH];
+    int i, id, comparison, num_values = 0, num_results = 0;
+    AK_block *source;
+
+    for (i = 0; i < compiled->num_instructions; i++) {
+        instruction = &compiled->instructions[i];
+
+        switch (instruction->opcode) {
+            case AK_EXPR_ATTRIBUTE:
+                if (block == NULL) {
+                    a = &values[num_values++];
+                    a->type = type[instruction->column];
+                    a->size = size[instruction->column];
+                    a->data = data[instruction->column];
+                    break;
+                }
+                if (instruction->column < split) {
+                    source = block;
+                    id = tuple + instruction->column;
+                } else {
+                    source = block2;
+                    id = tuple2 + instruction->column - split;
+                }
+                a = &values[num_values++];
+                a->type = AK_tuple_type(source, id);
+                a->size = AK_tuple_size(source, id);
+                a->data = (const char *) AK_tuple_data(source, id);
+                break;
+            case AK_EXPR_CONSTANT:
+                a = &values[num_values++];
+                a->type = instruction->type;
+                a->size = instruction->size;
+                a->data = instruction->data;
+                break;
+            case AK_EXPR_COMPARE:
+                b = &values[--num_values];
+                a = &values[--num_values];
+                comparison = AK_compare_expression_values(a, b);
+                switch (instruction->comparison) {
+                    case AK_EXPR_EQ:
+                        results[num_results++] = comparison == 0;
+                        break;
+                    case AK_EXPR_NE:
+                        results[num_results++] = comparison != 0;
+                        break;
+                    case AK_EXPR_LT:
+                        results[num_results++] = comparison < 0;
+                        break;
+                    case AK_EXPR_GT:
+                        results[num_results++] = comparison > 0;
+                        break;
+                    case AK_EXPR_LE:
+                        results[num_results++] = comparison <= 0;
+                        break;
+                    default:
+                        results[num_results++] = comparison >= 0;
+                }
+                break;
+            case AK_EXPR_BETWEEN:
+                b = &values[--num_values];
+                a = &values[--num_values];
+                c = &values[--num_values];
+                results[num_results++] = AK_compare_expression_values(c, a) >= 0 && AK_compare_expression_values(c, b) <= 0;
+                break;
+            case AK_EXPR_AND:
+                num_results--;
+                results[num_results - 1] = results[num_results - 1] && results[num_results];
+                break;
+            case AK_EXPR_OR:
+                num_results--;
+                results[num_results - 1] = results[num_results - 1] || results[num_results];
+                break;
+            case AK_EXPR_MATCH:
+                b = &values[--num_values];
+                a = &values[--num_values];
+                AK_expression_value_string(a, value);
+                if (instruction->regex != NULL)
+                    results[num_results++] = regexec(instruction->regex, value, 0, NULL, 0) != REG_NOMATCH;
+                else if (instruction->invalid)
+                    results[num_results++] = 0;
+                else
+                    results[num_results++] = AK_check_regex_expression(value, AK_expression_value_string(b, pattern),
+                            instruction->sensitive, instruction->wildcards);
+                break;
+        }
+    }
+    return results[num_results - 1];
+}
+
+/**
+ * @brief  Function that checks whether a tuple satisfies a compiled expression. The attribute values are read in place from
+ *         the tuple dictionary and data of the block. Attributes from index split on are read from the second block, which is
+ *         used for tuples of two tables (joins).
+ * @param compiled compiled expression
+ * @param block block of the tuple
+ * @param tuple tuple dictionary index of the first attribute of the tuple
+ * @param split number of attributes read from the first block
+ * @param block2 block of the second part of the tuple, NULL if there is none
+ * @param tuple2 tuple dictionary index of the first attribute of the second part
+ * @return 1 if the tuple satisfies the expression, 0 otherwise
+ */
+int AK_check_compiled_expression(AK_compiled_expression *compiled, AK_block *block, int tuple, int split, AK_block *block2, int tuple2) {
+    int result;
+    AK_PRO;
+    result = AK_evaluate_compiled_expression(compiled, block, tuple, split, block2, tuple2, NULL, NULL, NULL);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that checks whether a row given by the arrays of its values satisfies a compiled expression
+ * @param compiled compiled expression
+ * @param type types of the values in the order of the header the expression was compiled for
+ * @param size sizes of the values
+ * @param data values
+ * @return 1 if the row satisfies the expression, 0 otherwise
+ */
+int AK_check_compiled_values(AK_compiled_expression *compiled, int *type, int *size, char **data) {
+    int result;
+    AK_PRO;
+    result = AK_evaluate_compiled_expression(compiled, NULL, 0, 0, NULL, 0, type, size, data);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that frees a compiled expression
+ * @param compiled compiled expression, may be NULL
+ * @return No return value
+ */
+void AK_free_compiled_expression(AK_compiled_expression *compiled) {
+    int i;
+    AK_PRO;
+
+    if (compiled == NULL) {
+        AK_EPI;
+        return;
+    }
+    for (i = 0; i < compiled->num_instructions; i++) {
+        if (compiled->instructions[i].regex != NULL) {
+            regfree(compiled->instructions[i].regex);
+            AK_free(compiled->instructions[i].regex);
+        }
+    }
+    AK_free(compiled->instructions);
+    AK_free(compiled->values);
+    AK_free(compiled->results);
+    AK_free(compiled);
+    AK_EPI;
+}
 //TODO: Add description
 TestResult AK_expression_check_test()
 {
@@ -548,3 +953,151 @@ TestResult AK_expression_check_test()
     AK_EPI;
     return TEST_result(successful, 5-successful);
 }
+
+/**
+ * @brief  Benchmark of compiled expressions against AK_check_if_row_satisfies_expression. A few expressions are checked
+ *         on every row of table student, by the interpreter on row lists (built once, before timing) and by the compiled form
+ *         in place on the blocks. Both have to agree on every row.
+ * @return TestResult
+ */
+TestResult AK_expression_check_benchmark()
+{
+    char *tblName = "student";
+    int num_attr = AK_num_attr(tblName);
+    int num_rows = AK_get_num_records(tblName);
+    int num_passes = 50;
+    AK_header *header = AK_get_header(tblName);
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_mem_block *mem_blocks[MAX_EXTENTS_IN_SEGMENT];
+    AK_mem_block **row_block = (AK_mem_block **) AK_calloc(num_rows + 1, sizeof (AK_mem_block *));
+    int *row_tuple = (int *) AK_calloc(num_rows + 1, sizeof (int));
+    struct list_node **rows = (struct list_node **) AK_calloc(num_rows + 1, sizeof (struct list_node *));
+    struct list_node *expr[4];
+    AK_compiled_expression *compiled;
+    const char *expr_text[4] = {
+        "year > 2005 AND weight < 90.0",
+        "year BETWEEN 2000 AND 2006",
+        "firstname LIKE '%in%'",
+        "mbr = 35907 OR year < 2002"
+    };
+    int i, j, k, l, e, pass, count = 0, num_blocks = 0, success = 0, failed = 0;
+    int year = 2005, low = 2000, high = 2006, mbr = 35907, early = 2002, matched;
+    float weight = 90.0;
+    char pattern[MAX_VARCHAR_LENGTH] = "%in%";
+    char data[MAX_VARCHAR_LENGTH];
+    double start, interpreted, compiled_time;
+    AK_PRO;
+
+    for (e = 0; e < 4; e++) {
+        expr[e] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&expr[e]);
+    }
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight", sizeof ("weight"), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &weight, sizeof (float), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr[0]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr[0]);
+
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr[1]);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &low, sizeof (int), expr[1]);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &high, sizeof (int), expr[1]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr[1]);
+
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), expr[2]);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, pattern, strlen(pattern) + 1, expr[2]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "LIKE", sizeof ("LIKE"), expr[2]);
+
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &mbr, sizeof (int), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &early, sizeof (int), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr[3]);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr[3]);
+
+    //the blocks of the table stay pinned, so the compiled form can read them during the whole benchmark
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i] && num_blocks < MAX_EXTENTS_IN_SEGMENT; j++) {
+            AK_mem_block *mem_block = AK_pin_block(j);
+            if (mem_block == NULL)
+                break;
+            if (mem_block->block->last_tuple_dict_id == 0) {
+                AK_unpin_block(mem_block);
+                break;
+            }
+            mem_blocks[num_blocks++] = mem_block;
+            for (k = 0; k + num_attr <= DATA_BLOCK_SIZE && count < num_rows; k += num_attr) {
+                if (AK_tuple_size(mem_block->block, k) <= 0)
+                    continue;
+                rows[count] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+                AK_Init_L3(&rows[count]);
+                for (l = 0; l < num_attr; l++) {
+                    AK_tuple_copy(mem_block->block, k + l, data);
+                    AK_Insert_New_Element(AK_tuple_type(mem_block->block, k + l), data, tblName, header[l].att_name, rows[count]);
+                }
+                row_block[count] = mem_block;
+                row_tuple[count] = k;
+                count++;
+            }
+        }
+    }
+
+    printf("\n%d passes over %d rows of table %s (expressions checked per second)\n", num_passes, count, tblName);
+    printf("%-32s %14s %14s %8s\n", "expression", "interpreted", "compiled", "matches");
+    for (e = 0; e < 4; e++) {
+        compiled = AK_compile_expression(expr[e], header, num_attr);
+        if (compiled == NULL) {
+            printf("AK_expression_check_benchmark: Cannot compile %s\n", expr_text[e]);
+            failed++;
+            continue;
+        }
+
+        matched = 0;
+        for (i = 0; i < count; i++) {
+            if (AK_check_if_row_satisfies_expression(rows[i], expr[e])
+                    == AK_check_compiled_expression(compiled, row_block[i]->block, row_tuple[i], num_attr, NULL, 0))
+                success++;
+            else {
+                printf("AK_expression_check_benchmark: %s differs on row %d\n", expr_text[e], i);
+                failed++;
+            }
+            matched += AK_check_compiled_expression(compiled, row_block[i]->block, row_tuple[i], num_attr, NULL, 0);
+        }
+
+        start = TEST_time_ms();
+        for (pass = 0; pass < num_passes; pass++)
+            for (i = 0; i < count; i++)
+                AK_check_if_row_satisfies_expression(rows[i], expr[e]);
+        interpreted = TEST_time_ms() - start;
+
+        start = TEST_time_ms();
+        for (pass = 0; pass < num_passes; pass++)
+            for (i = 0; i < count; i++)
+                AK_check_compiled_expression(compiled, row_block[i]->block, row_tuple[i], num_attr, NULL, 0);
+        compiled_time = TEST_time_ms() - start;
+
+        printf("%-32s %14.0f %14.0f %8d\n", expr_text[e], num_passes * count / (interpreted / 1000.0),
+                num_passes * count / (compiled_time / 1000.0), matched);
+        AK_free_compiled_expression(compiled);
+    }
+
+    for (i = 0; i < count; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    for (i = 0; i < num_blocks; i++)
+        AK_unpin_block(mem_blocks[i]);
+    for (e = 0; e < 4; e++) {
+        AK_DeleteAll_L3(&expr[e]);
+        AK_free(expr[e]);
+    }
+    AK_free(rows);
+    AK_free(row_block);
+    AK_free(row_tuple);
+    AK_free(addresses);
+    AK_free(header);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
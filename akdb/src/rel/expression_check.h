@@ -25,6 +25,74 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include <regex.h>
+
+/**
+ * @brief Operations of a compiled expression. Operands are pushed on the value stack, comparisons
+ * and pattern matches pop their operands and push a result on the result stack, AND and OR combine results.
+ */
+#define AK_EXPR_ATTRIBUTE 0
+#define AK_EXPR_CONSTANT 1
+#define AK_EXPR_COMPARE 2
+#define AK_EXPR_BETWEEN 3
+#define AK_EXPR_AND 4
+#define AK_EXPR_OR 5
+#define AK_EXPR_MATCH 6
+
+/**
+ * @brief Comparison operators of AK_EXPR_COMPARE
+ */
+#define AK_EXPR_EQ 0
+#define AK_EXPR_NE 1
+#define AK_EXPR_LT 2
+#define AK_EXPR_GT 3
+#define AK_EXPR_LE 4
+#define AK_EXPR_GE 5
+
+/**
+ * @struct AK_expression_instruction
+ * @brief One step of a compiled expression
+ */
+typedef struct {
+    /// AK_EXPR_* operation
+    int opcode;
+    /// attribute index for AK_EXPR_ATTRIBUTE
+    int column;
+    /// AK_EXPR_EQ ... AK_EXPR_GE for AK_EXPR_COMPARE
+    int comparison;
+    /// type and value of an AK_EXPR_CONSTANT
+    int type;
+    int size;
+    char data[MAX_VARCHAR_LENGTH];
+    /// AK_EXPR_MATCH: case sensitivity and SQL wildcard translation as in AK_check_regex_expression
+    int sensitive;
+    int wildcards;
+    /// AK_EXPR_MATCH: pattern compiled once when it is a constant, NULL otherwise
+    regex_t *regex;
+    /// AK_EXPR_MATCH: set when the constant pattern is not a valid regex, such a match is always false
+    int invalid;
+} AK_expression_instruction;
+
+/**
+ * @struct AK_expression_value
+ * @brief Operand of a compiled expression, points into a block or into an instruction
+ */
+typedef struct {
+    int type;
+    int size;
+    const char *data;
+} AK_expression_value;
+
+/**
+ * @struct AK_compiled_expression
+ * @brief Postfix expression with attribute names resolved to attribute indexes and operators resolved to opcodes.
+ * The stacks are allocated once, so checking a tuple does not allocate memory.
+ */
+typedef struct {
+    int num_instructions;
+    AK_expression_instruction *instructions;
+    AK_expression_value *values;
+    char *results;
+} AK_compiled_expression;
 /*
 int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr);
@@ -70,6 +138,50 @@ int AK_check_regex_expression(const char *value,const char *expression,int sensi
 			  1 if string matches coresponding regex expression
 */
 int AK_check_regex_operator_expression(const char *value,const char *expression);
+
+/**
+ * @brief Function that compiles a logical expression in postfix notation for the given table header. Attribute names are
+ *        resolved to attribute indexes, operators to opcodes and constant LIKE, SIMILAR TO and regex patterns are compiled once.
+ * @param expr list with the logical expression in postfix notation
+ * @param header header of the table the expression is checked against
+ * @param num_attr number of attributes in the header
+ * @return compiled expression, NULL if the expression uses an operator or attribute the compiled form does not support,
+ *         in that case AK_check_if_row_satisfies_expression has to be used
+ */
+AK_compiled_expression *AK_compile_expression(struct list_node *expr, AK_header *header, int num_attr);
+
+/**
+ * @brief Function that checks whether a tuple satisfies a compiled expression. The attribute values are read in place from
+ *        the tuple dictionary and data of the block. Attributes from index split on are read from the second block, which is
+ *        used for tuples of two tables (joins).
+ * @param compiled compiled expression
+ * @param block block of the tuple
+ * @param tuple tuple dictionary index of the first attribute of the tuple
+ * @param split number of attributes read from the first block
+ * @param block2 block of the second part of the tuple, NULL if there is none
+ * @param tuple2 tuple dictionary index of the first attribute of the second part
+ * @return 1 if the tuple satisfies the expression, 0 otherwise
+ */
+int AK_check_compiled_expression(AK_compiled_expression *compiled, AK_block *block, int tuple, int split, AK_block *block2, int tuple2);
+
+/**
+ * @brief Function that checks whether a row given by the arrays of its values satisfies a compiled expression, used for rows
+ *        that are not kept in a block (rows streamed between the operators of a query plan)
+ * @param compiled compiled expression
+ * @param type types of the values in the order of the header the expression was compiled for
+ * @param size sizes of the values
+ * @param data values
+ * @return 1 if the row satisfies the expression, 0 otherwise
+ */
+int AK_check_compiled_values(AK_compiled_expression *compiled, int *type, int *size, char **data);
+
+/**
+ * @brief Function that frees a compiled expression
+ * @param compiled compiled expression, may be NULL
+ * @return No return value
+ */
+void AK_free_compiled_expression(AK_compiled_expression *compiled);
 TestResult AK_expression_check_test();
+TestResult AK_expression_check_benchmark();
 
 #endif /* CONSTRAINT_CHECKER_H_ */
@@ -0,0 +1,1085 @@
+/**
+@file hash_join.c Provides functions for the hash join operator
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "hash_join.h"
+#include "nat_join.h"
+#include "theta_join.h"
+#include "../file/idx/hash.h"
+
+/**
+ * @brief  Function that adds a value to a FNV-1a hash
+ * @param hash hash so far
+ * @param type type of the value
+ * @param size size of the value
+ * @param data value
+ * @return new hash
+ */
+static unsigned int AK_hash_join_hash_value(unsigned int hash, int type, int size, char *data) {
+    int i;
+
+    hash = (hash ^ (unsigned int) type) * 16777619u;
+    for (i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief  Function that hashes the key of a row read by a table cursor
+ * @param values values of the row
+ * @param keys indexes of the key values
+ * @param num_keys number of key values
+ * @return hash of the key
+ */
+static unsigned int AK_hash_join_hash_key(struct list_node **values, int *keys, int num_keys) {
+    unsigned int hash = 2166136261u;
+    int k;
+
+    for (k = 0; k < num_keys; k++)
+        hash = AK_hash_join_hash_value(hash, values[keys[k]]->type, values[keys[k]]->size, values[keys[k]]->data);
+    return hash;
+}
+
+/**
+ * @brief  Function that collects the values of a cursor row into an array. The cursor reuses its row list,
+ *         so this is done once per cursor.
+ * @param row row returned by AK_table_cursor_next
+ * @param values array of at least num_attr elements
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_hash_join_row_values(struct list_node *row, struct list_node **values, int num_attr) {
+    struct list_node *el = AK_First_L2(row);
+    int i;
+
+    for (i = 0; i < num_attr && el != NULL; i++, el = el->next)
+        values[i] = el;
+}
+
+/**
+ * @brief  Function that allocates memory for a build row from the chunks of a hash table
+ * @param table hash table
+ * @param size number of bytes
+ * @return allocated memory, NULL if the row does not fit a chunk
+ */
+static void *AK_hash_join_alloc(AK_hash_join_table *table, int size) {
+    AK_hash_join_chunk *chunk = table->chunks;
+    void *memory;
+
+    size = (size + 7) & ~7;
+    if (size > AK_HASH_JOIN_ARENA_CHUNK)
+        return NULL;
+    if (chunk == NULL || chunk->used + size > AK_HASH_JOIN_ARENA_CHUNK) {
+        chunk = (AK_hash_join_chunk *) AK_malloc(sizeof (AK_hash_join_chunk));
+        chunk->next = table->chunks;
+        chunk->used = 0;
+        table->chunks = chunk;
+    }
+    memory = chunk->data + chunk->used;
+    chunk->used += size;
+    return memory;
+}
+
+/**
+ * @brief  Function that doubles the number of buckets of a hash table
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_hash_join_grow(AK_hash_join_table *table) {
+    int num_buckets = table->num_buckets * 2;
+    AK_hash_join_row **buckets = (AK_hash_join_row **) AK_calloc(num_buckets, sizeof (AK_hash_join_row *));
+    AK_hash_join_row *row, *next;
+    int i;
+
+    for (i = 0; i < table->num_buckets; i++) {
+        for (row = table->buckets[i]; row != NULL; row = next) {
+            next = row->next;
+            row->next = buckets[row->hash & (num_buckets - 1)];
+            buckets[row->hash & (num_buckets - 1)] = row;
+        }
+    }
+    AK_free(table->buckets);
+    table->buckets = buckets;
+    table->num_buckets = num_buckets;
+}
+
+/**
+ * @brief  Function that copies a row given by arrays of types, sizes and values into a hash table
+ * @param table hash table
+ * @param type types of the values
+ * @param size sizes of the values
+ * @param data values
+ * @param num_attr number of attributes
+ * @param hash hash of the row key
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is too large
+ */
+static int AK_hash_join_insert_values(AK_hash_join_table *table, int *type, int *size, char **data, int num_attr, unsigned int hash) {
+    int bytes = sizeof (AK_hash_join_row) + num_attr * sizeof (AK_hash_join_value);
+    AK_hash_join_row *row;
+    char *copy;
+    int i;
+
+    for (i = 0; i < num_attr; i++)
+        bytes += size[i] + 1;
+    if ((row = (AK_hash_join_row *) AK_hash_join_alloc(table, bytes)) == NULL)
+        return EXIT_ERROR;
+
+    row->hash = hash;
+    row->values = (AK_hash_join_value *) (row + 1);
+    copy = (char *) (row->values + num_attr);
+    for (i = 0; i < num_attr; i++) {
+        row->values[i].type = type[i];
+        row->values[i].size = size[i];
+        row->values[i].data = copy;
+        memcpy(copy, data[i], size[i]);
+        copy[size[i]] = '\0';
+        copy += size[i] + 1;
+    }
+
+    if (table->num_rows >= table->num_buckets)
+        AK_hash_join_grow(table);
+    row->next = table->buckets[hash & (table->num_buckets - 1)];
+    table->buckets[hash & (table->num_buckets - 1)] = row;
+    table->num_rows++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that copies a cursor row into a hash table
+ * @param table hash table
+ * @param values values of the row
+ * @param num_attr number of attributes
+ * @param hash hash of the row key
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row is too large
+ */
+static int AK_hash_join_insert(AK_hash_join_table *table, struct list_node **values, int num_attr, unsigned int hash) {
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        type[i] = values[i]->type;
+        size[i] = values[i]->size;
+        data[i] = values[i]->data;
+    }
+    return AK_hash_join_insert_values(table, type, size, data, num_attr, hash);
+}
+
+/**
+ * @brief  Function that frees the buckets and the memory chunks of a hash table
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_hash_join_free_table(AK_hash_join_table *table) {
+    AK_hash_join_chunk *chunk, *next;
+
+    for (chunk = table->chunks; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        AK_free(chunk);
+    }
+    AK_free(table->buckets);
+}
+
+/**
+ * @brief  Function that estimates how much memory the rows of a table take in a hash table
+ * @param tblName table name
+ * @param num_attr number of attributes
+ * @return estimated number of bytes
+ */
+static long AK_hash_join_table_bytes(char *tblName, int num_attr) {
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    AK_mem_block *mem_block;
+    long bytes = 0, entries;
+    int i, j;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            mem_block = AK_get_block(j);
+            if (mem_block == NULL || mem_block->block->last_tuple_dict_id == 0)
+                break;
+            entries = mem_block->block->last_tuple_dict_id + 1;
+            bytes += mem_block->block->AK_free_space + entries * (sizeof (AK_hash_join_value) + 1)
+                    + entries / num_attr * sizeof (AK_hash_join_row);
+        }
+    }
+    AK_free(addresses);
+    return bytes;
+}
+
+/**
+ * @brief  Function that joins two tables (or two partitions of them) in memory. The hash table is built on the rows of
+ *         the build table and every row of the probe table is looked up in it.
+ * @param buildTable name of the table the hash table is built on
+ * @param probeTable name of the table that probes the hash table
+ * @param build_first 1 if the build table holds rows of the first join table, 0 if it holds rows of the second one
+ * @param num_attr number of attributes of the first and the second table
+ * @param keys indexes of the key attributes in the first and the second table
+ * @param num_keys number of key attributes
+ * @param num_out number of attributes of the join table
+ * @param out_table for every attribute of the join table, 0 if it comes from the first table and 1 if from the second
+ * @param out_column for every attribute of the join table, its index in the table it comes from
+ * @param out_row row list of num_out elements the join rows are built in
+ * @param writer writer on the join table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_pass(char *buildTable, char *probeTable, int build_first, int num_attr[2], int *keys[2], int num_keys,
+        int num_out, int *out_table, int *out_column, struct list_node *out_row, AK_table_writer *writer) {
+    int build = build_first ? 0 : 1;
+    int probe = 1 - build;
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *row, *el;
+    AK_hash_join_table table;
+    AK_hash_join_row *match;
+    AK_hash_join_value *value;
+    AK_table_cursor *cursor;
+    unsigned int hash;
+    int first = 1, result = EXIT_SUCCESS, k, c;
+
+    table.num_buckets = 1024;
+    table.num_rows = 0;
+    table.buckets = (AK_hash_join_row **) AK_calloc(table.num_buckets, sizeof (AK_hash_join_row *));
+    table.chunks = NULL;
+
+    cursor = AK_table_cursor_open(buildTable);
+    while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_hash_join_row_values(row, values, num_attr[build]);
+            first = 0;
+        }
+        hash = AK_hash_join_hash_key(values, keys[build], num_keys);
+        result = AK_hash_join_insert(&table, values, num_attr[build], hash);
+    }
+    AK_table_cursor_close(cursor);
+
+    if (table.num_rows > 0 && result == EXIT_SUCCESS) {
+        first = 1;
+        cursor = AK_table_cursor_open(probeTable);
+        while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+            if (first) {
+                AK_hash_join_row_values(row, values, num_attr[probe]);
+                first = 0;
+            }
+            hash = AK_hash_join_hash_key(values, keys[probe], num_keys);
+
+            for (match = table.buckets[hash & (table.num_buckets - 1)]; match != NULL; match = match->next) {
+                if (match->hash != hash)
+                    continue;
+                for (k = 0; k < num_keys; k++) {
+                    value = &match->values[keys[build][k]];
+                    el = values[keys[probe][k]];
+                    if (value->size != el->size || memcmp(value->data, el->data, el->size) != 0)
+                        break;
+                }
+                if (k < num_keys)
+                    continue;
+
+                for (c = 0, el = AK_First_L2(out_row); c < num_out; c++, el = el->next) {
+                    if (out_table[c] == build) {
+                        value = &match->values[out_column[c]];
+                        el->type = value->type;
+                        el->size = value->size;
+                        memcpy(el->data, value->data, value->size + 1);
+                    } else {
+                        el->type = values[out_column[c]]->type;
+                        el->size = values[out_column[c]]->size;
+                        memcpy(el->data, values[out_column[c]]->data, el->size + 1);
+                    }
+                }
+                if ((result = AK_table_writer_append(writer, out_row)) != EXIT_SUCCESS)
+                    break;
+            }
+        }
+        AK_table_cursor_close(cursor);
+    }
+
+    AK_hash_join_free_table(&table);
+    return result;
+}
+
+/**
+ * @brief  Function that compares row addresses by block and tuple, used to read the rows a hash index returned in block order
+ */
+static int AK_hash_join_compare_rows(const void *a, const void *b) {
+    const struct_add *x = a, *y = b;
+
+    if (x->addBlock != y->addBlock)
+        return (x->addBlock > y->addBlock) - (x->addBlock < y->addBlock);
+    return (x->indexTd > y->indexTd) - (x->indexTd < y->indexTd);
+}
+
+/**
+ * @brief  Function that joins two tables by looking the key of every row of one table up in a hash index of the other one
+ * @param indexName name of the hash index
+ * @param index_keys key attributes of the index in key order
+ * @param num_index_keys number of key attributes of the index, they are a subset of the join keys
+ * @param inner 0 if the index is on the first table, 1 if it is on the second one
+ * @param tables names of the first and the second table
+ * @param num_attr number of attributes of the first and the second table
+ * @param keys indexes of the key attributes in the first and the second table
+ * @param num_keys number of key attributes
+ * @param num_out number of attributes of the join table
+ * @param out_table for every attribute of the join table, 0 if it comes from the first table and 1 if from the second
+ * @param out_column for every attribute of the join table, its index in the table it comes from
+ * @param out_row row list of num_out elements the join rows are built in
+ * @param writer writer on the join table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_index(char *indexName, int *index_keys, int num_index_keys, int inner, char *tables[2], int num_attr[2],
+        int *keys[2], int num_keys, int num_out, int *out_table, int *out_column, struct list_node *out_row, AK_table_writer *writer) {
+    int outer = 1 - inner;
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *row, *el;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], probe[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    AK_table_cursor *cursor;
+    AK_mem_block *mem_block;
+    AK_block *block;
+    struct_add *rows;
+    int first = 1, result = EXIT_SUCCESS, count, tuple, i, k, c;
+
+    //the outer value of every index key
+    for (i = 0; i < num_index_keys; i++) {
+        for (k = 0; k < num_keys && keys[inner][k] != index_keys[i]; k++);
+        probe[i] = keys[outer][k];
+    }
+
+    cursor = AK_table_cursor_open(tables[outer]);
+    while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_hash_join_row_values(row, values, num_attr[outer]);
+            first = 0;
+        }
+        for (i = 0; i < num_index_keys; i++) {
+            type[i] = values[probe[i]]->type;
+            size[i] = values[probe[i]]->size;
+            data[i] = values[probe[i]]->data;
+        }
+        if ((count = AK_hash_probe(indexName, type, size, data, &rows)) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+        //rows are read in block order; entries of rows deleted or changed since they were indexed fail the key check
+        qsort(rows, count, sizeof (struct_add), AK_hash_join_compare_rows);
+        for (i = 0; i < count && result == EXIT_SUCCESS; i++) {
+            tuple = rows[i].indexTd;
+            if ((i > 0 && AK_hash_join_compare_rows(rows + i - 1, rows + i) == 0) || tuple < 0 || tuple + num_attr[inner] > DATA_BLOCK_SIZE)
+                continue;
+            mem_block = AK_pin_block(rows[i].addBlock);
+            AK_latch_block(mem_block, AK_LATCH_SHARED);
+            block = mem_block->block;
+            for (k = 0; k < num_keys; k++) {
+                el = values[keys[outer][k]];
+                c = tuple + keys[inner][k];
+                if (block->tuple_dict[c].type != el->type || block->tuple_dict[c].size != el->size
+                        || memcmp(block->data + block->tuple_dict[c].address, el->data, el->size) != 0)
+                    break;
+            }
+            if (k == num_keys) {
+                for (c = 0, el = AK_First_L2(out_row); c < num_out; c++, el = el->next) {
+                    if (out_table[c] == inner) {
+                        el->type = AK_tuple_type(block, tuple + out_column[c]);
+                        el->size = AK_tuple_size(block, tuple + out_column[c]);
+                        memcpy(el->data, AK_tuple_data(block, tuple + out_column[c]), el->size);
+                        el->data[el->size] = '\0';
+                    } else {
+                        el->type = values[out_column[c]]->type;
+                        el->size = values[out_column[c]]->size;
+                        memcpy(el->data, values[out_column[c]]->data, el->size + 1);
+                    }
+                }
+            }
+            AK_unlatch_block(mem_block);
+            AK_unpin_block(mem_block);
+            if (k == num_keys)
+                result = AK_table_writer_append(writer, out_row);
+        }
+        AK_free(rows);
+    }
+    AK_table_cursor_close(cursor);
+    return result;
+}
+
+/**
+ * @brief  Function that splits a table into partitions (temp segments) by the hash of the join key
+ * @param srcTable table name
+ * @param num_attr number of attributes of the table
+ * @param keys indexes of the key attributes
+ * @param num_keys number of key attributes
+ * @param num_partitions number of partitions
+ * @param names names of the partitions
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_partition(char *srcTable, int num_attr, int *keys, int num_keys, int num_partitions, char names[][MAX_ATT_NAME]) {
+    AK_table_writer *writers[AK_HASH_JOIN_MAX_PARTITIONS];
+    struct list_node *values[MAX_ATTRIBUTES];
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *src_header = AK_get_header(srcTable);
+    AK_table_cursor *cursor;
+    struct list_node *row;
+    int p, first = 1, result = EXIT_SUCCESS;
+
+    memset(header, 0, sizeof (header));
+    memcpy(header, src_header, num_attr * sizeof (AK_header));
+    AK_free(src_header);
+
+    for (p = 0; p < num_partitions; p++) {
+        if (AK_initialize_new_segment(names[p], SEGMENT_TYPE_TABLE, header) == EXIT_ERROR)
+            result = EXIT_ERROR;
+        writers[p] = (result == EXIT_SUCCESS) ? AK_table_writer_open(names[p]) : NULL;
+        if (writers[p] == NULL)
+            result = EXIT_ERROR;
+    }
+
+    cursor = (result == EXIT_SUCCESS) ? AK_table_cursor_open(srcTable) : NULL;
+    while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_hash_join_row_values(row, values, num_attr);
+            first = 0;
+        }
+        //the high bits pick the partition, the low ones are left for the buckets of the partition's hash table
+        p = (AK_hash_join_hash_key(values, keys, num_keys) >> 16) % num_partitions;
+        result = AK_table_writer_append(writers[p], row);
+    }
+    AK_table_cursor_close(cursor);
+
+    for (p = 0; p < num_partitions; p++)
+        AK_table_writer_close(writers[p]);
+    return result;
+}
+
+/**
+ * @brief  Function that makes an equi-join of two tables with a hash join. The hash table is built on the join key of the
+ *         smaller table and probed with the rows of the other one. When the build table does not fit the memory budget both
+ *         tables are first split by the hash of the key into temp segments (Grace hash join) and the partitions are joined
+ *         pair by pair. When the larger table has a hash index on some of the key attributes, the rows of the smaller one
+ *         are looked up in the index instead. Key values are equal when they have the same type, size and bytes.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the join table, it must already exist
+ * @param num_keys number of key attributes
+ * @param keys1 indexes of the key attributes in the first table
+ * @param keys2 indexes of the key attributes in the second table
+ * @param natural 1 if the join table has the attributes of the first table without the keys followed by the attributes of the
+ *        second table (natural join), 0 if it has all attributes of both tables (theta join)
+ * @param memory memory budget for the hash table in bytes
+ * @return EXIT_SUCCESS, EXIT_WARNING if the key types of the two tables differ, EXIT_ERROR otherwise
+ */
+int AK_hash_join(char *srcTable1, char *srcTable2, char *dstTable, int num_keys, int *keys1, int *keys2, int natural, int memory) {
+    AK_PRO;
+    char *tables[2] = { srcTable1, srcTable2 };
+    int *keys[2] = { keys1, keys2 };
+    int num_attr[2], out_table[2 * MAX_ATTRIBUTES], out_column[2 * MAX_ATTRIBUTES];
+    char names[2][AK_HASH_JOIN_MAX_PARTITIONS][MAX_ATT_NAME], indexName[MAX_VARCHAR_LENGTH];
+    int usable[MAX_ATTRIBUTES], index_keys[MAX_ATTRIBUTES], num_index_keys, inner;
+    AK_header *header[2];
+    struct list_node *out_row, *last;
+    AK_table_writer *writer;
+    long bytes[2];
+    int num_out = 0, num_partitions = 0, build, result = EXIT_SUCCESS, t, k, c, p;
+
+    num_attr[0] = AK_num_attr(srcTable1);
+    num_attr[1] = AK_num_attr(srcTable2);
+    if (num_attr[0] <= 0 || num_attr[1] <= 0 || num_keys <= 0 || num_keys > MAX_ATTRIBUTES) {
+        printf("AK_hash_join: ERROR. Table %s or %s does not exist.\n", srcTable1, srcTable2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    header[0] = AK_get_header(srcTable1);
+    header[1] = AK_get_header(srcTable2);
+    for (k = 0; k < num_keys; k++) {
+        if (keys1[k] < 0 || keys1[k] >= num_attr[0] || keys2[k] < 0 || keys2[k] >= num_attr[1]
+                || header[0][keys1[k]].type != header[1][keys2[k]].type)
+            result = EXIT_WARNING;
+    }
+    AK_free(header[0]);
+    AK_free(header[1]);
+
+    for (t = 0; t < 2; t++) {
+        for (c = 0; c < num_attr[t]; c++) {
+            for (k = 0; natural && t == 0 && k < num_keys && keys1[k] != c; k++);
+            if (!natural || t == 1 || k == num_keys) {
+                out_table[num_out] = t;
+                out_column[num_out++] = c;
+            }
+        }
+    }
+    if (num_out != AK_num_attr(dstTable))
+        result = EXIT_WARNING;
+
+    if (result != EXIT_SUCCESS || (writer = AK_table_writer_open(dstTable)) == NULL) {
+        AK_dbg_messg(LOW, REL_OP, "AK_hash_join: join of %s and %s can not be done with a hash join\n", srcTable1, srcTable2);
+        AK_EPI;
+        return (result == EXIT_SUCCESS) ? EXIT_ERROR : result;
+    }
+
+    out_row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&out_row);
+    for (c = 0, last = out_row; c < num_out; c++, last = last->next)
+        last->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+
+    //the smaller table is the build table, on a tie the second one so the result follows the order of the first
+    bytes[0] = AK_hash_join_table_bytes(srcTable1, num_attr[0]);
+    bytes[1] = AK_hash_join_table_bytes(srcTable2, num_attr[1]);
+    build = (bytes[0] < bytes[1]) ? 0 : 1;
+
+    //a hash index on the key of the larger table saves reading it, the rows of the other table are looked up in it
+    inner = 1 - build;
+    memset(usable, 0, sizeof (usable));
+    for (k = 0; k < num_keys; k++)
+        usable[keys[inner][k]] = 1;
+    num_index_keys = AK_hash_find_index(tables[inner], usable, indexName, index_keys);
+
+    if (num_index_keys > 0) {
+        AK_dbg_messg(LOW, REL_OP, "AK_hash_join: probing index %s with the rows of %s\n", indexName, tables[build]);
+        result = AK_hash_join_index(indexName, index_keys, num_index_keys, inner, tables, num_attr, keys, num_keys,
+                num_out, out_table, out_column, out_row, writer);
+    } else if (bytes[build] <= memory) {
+        result = AK_hash_join_pass(tables[build], tables[1 - build], build == 0, num_attr, keys, num_keys,
+                num_out, out_table, out_column, out_row, writer);
+    } else {
+        num_partitions = bytes[build] / (memory > 0 ? memory : 1) + 2;
+        if (num_partitions > AK_HASH_JOIN_MAX_PARTITIONS)
+            num_partitions = AK_HASH_JOIN_MAX_PARTITIONS;
+        AK_dbg_messg(LOW, REL_OP, "AK_hash_join: %ld bytes to build, splitting into %d partitions\n", bytes[build], num_partitions);
+
+        for (t = 0; t < 2; t++) {
+            for (p = 0; p < num_partitions; p++)
+                snprintf(names[t][p], MAX_ATT_NAME, "%s_hash_join_%d_%d", dstTable, t + 1, p);
+            if (result == EXIT_SUCCESS)
+                result = AK_hash_join_partition(tables[t], num_attr[t], keys[t], num_keys, num_partitions, names[t]);
+        }
+        for (p = 0; p < num_partitions && result == EXIT_SUCCESS; p++)
+            result = AK_hash_join_pass(names[build][p], names[1 - build][p], build == 0, num_attr, keys, num_keys,
+                    num_out, out_table, out_column, out_row, writer);
+
+        for (t = 0; t < 2; t++)
+            for (p = 0; p < num_partitions; p++)
+                if (AK_num_attr(names[t][p]) > 0)
+                    AK_delete_segment(names[t][p], SEGMENT_TYPE_TABLE);
+    }
+
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&out_row);
+    AK_free(out_row);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @struct AK_hash_join_iterator_state
+ * @brief Structure that contains the state of a hash join operator
+ */
+typedef struct {
+    int num_keys;
+    /// indexes of the key attributes in the left and the right input
+    int keys[2][MAX_ATTRIBUTES];
+    /// for every attribute of the join: input it comes from and its index there
+    int out_table[MAX_ATTRIBUTES];
+    int out_column[MAX_ATTRIBUTES];
+    /// hash table on the rows of the right input
+    AK_hash_join_table table;
+    /// batches of the right input while the hash table is built and of the left input while it is probed by batches
+    AK_batch *build;
+    AK_batch *probe;
+    /// key hashes of the selected rows of a batch
+    unsigned int hashes[AK_BATCH_SIZE];
+    /// next selected row of the probe batch and the row whose matches are being returned
+    int position;
+    int probe_row;
+    /// next build row to compare with the current left row
+    AK_hash_join_row *match;
+    unsigned int hash;
+    /// 1 while the left input is open
+    int probing;
+    int built;
+} AK_hash_join_iterator_state;
+
+/**
+ * @brief  Function that hashes the key of every selected row of a batch a column at a time, as AK_hash_join_hash_key
+ *         hashes the key of one row
+ * @param batch batch
+ * @param keys indexes of the key attributes
+ * @param num_keys number of key attributes
+ * @param hashes set to the hash of every selected row
+ * @return No return value
+ */
+static void AK_hash_join_hash_batch(AK_batch *batch, int *keys, int num_keys, unsigned int *hashes) {
+    AK_batch_column *column;
+    int *sel = batch->sel;
+    int n = batch->num_sel;
+    int j, k;
+
+    for (j = 0; j < n; j++)
+        hashes[j] = 2166136261u;
+    for (k = 0; k < num_keys; k++) {
+        column = &batch->column[keys[k]];
+        for (j = 0; j < n; j++)
+            hashes[j] = AK_hash_join_hash_value(hashes[j], column->value_type[sel[j]], column->size[sel[j]],
+                    column->values + sel[j] * column->width);
+    }
+}
+
+static void AK_hash_join_iterator_free(void *data) {
+    AK_hash_join_iterator_state *state = (AK_hash_join_iterator_state *) data;
+
+    if (state->built)
+        AK_hash_join_free_table(&state->table);
+    AK_batch_free(state->build);
+    AK_batch_free(state->probe);
+    AK_free(state);
+}
+
+static void AK_hash_join_iterator_close(AK_iterator *iterator) {
+    AK_hash_join_iterator_state *state = (AK_hash_join_iterator_state *) iterator->state;
+
+    if (state->probing)
+        AK_iterator_close(iterator->input[0]);
+    if (state->built)
+        AK_hash_join_free_table(&state->table);
+    state->probing = 0;
+    state->built = 0;
+}
+
+/**
+ * @brief  Function that builds the hash table of a hash join operator on the batches of its right input and opens the left one
+ */
+static int AK_hash_join_iterator_open(AK_iterator *iterator) {
+    AK_hash_join_iterator_state *state = (AK_hash_join_iterator_state *) iterator->state;
+    AK_iterator *right = iterator->input[1];
+    AK_batch *build = state->build;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int result, j;
+
+    if (AK_iterator_open(right) == EXIT_ERROR)
+        return EXIT_ERROR;
+    state->table.num_buckets = 1024;
+    state->table.num_rows = 0;
+    state->table.buckets = (AK_hash_join_row **) AK_calloc(state->table.num_buckets, sizeof (AK_hash_join_row *));
+    state->table.chunks = NULL;
+    state->built = 1;
+    while ((result = AK_iterator_next_batch(right, build)) > 0) {
+        AK_hash_join_hash_batch(build, state->keys[1], state->num_keys, state->hashes);
+        for (j = 0; j < build->num_sel; j++) {
+            AK_batch_row(build, build->sel[j], type, size, data);
+            if (AK_hash_join_insert_values(&state->table, type, size, data, right->num_attr, state->hashes[j]) != EXIT_SUCCESS)
+                break;
+        }
+        if (j < build->num_sel) {
+            result = EXIT_ERROR;
+            break;
+        }
+    }
+    AK_iterator_close(right);
+    if (result == EXIT_ERROR) {
+        AK_hash_join_iterator_close(iterator);
+        return EXIT_ERROR;
+    }
+
+    //without build rows there is nothing to join, the left input is not read
+    state->match = NULL;
+    state->position = 0;
+    AK_batch_reset(state->probe);
+    if (state->table.num_rows > 0) {
+        if (AK_iterator_open(iterator->input[0]) == EXIT_ERROR) {
+            AK_hash_join_iterator_close(iterator);
+            return EXIT_ERROR;
+        }
+        state->probing = 1;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int AK_hash_join_iterator_next(AK_iterator *iterator) {
+    AK_hash_join_iterator_state *state = (AK_hash_join_iterator_state *) iterator->state;
+    AK_iterator *left = iterator->input[0];
+    AK_hash_join_row *match;
+    AK_hash_join_value *value;
+    int result, k, c;
+
+    if (!state->probing)
+        return 0;
+    for (;;) {
+        if (state->match == NULL) {
+            if ((result = AK_iterator_next(left)) != 1)
+                return result;
+            //the same hash as AK_hash_join_hash_key over the values of the left row
+            state->hash = 2166136261u;
+            for (k = 0; k < state->num_keys; k++) {
+                c = state->keys[0][k];
+                state->hash = AK_hash_join_hash_value(state->hash, left->type[c], left->size[c], left->data[c]);
+            }
+            state->match = state->table.buckets[state->hash & (state->table.num_buckets - 1)];
+        }
+        while ((match = state->match) != NULL) {
+            state->match = match->next;
+            if (match->hash != state->hash)
+                continue;
+            for (k = 0; k < state->num_keys; k++) {
+                value = &match->values[state->keys[1][k]];
+                c = state->keys[0][k];
+                if (value->size != left->size[c] || memcmp(value->data, left->data[c], value->size) != 0)
+                    break;
+            }
+            if (k < state->num_keys)
+                continue;
+            for (c = 0; c < iterator->num_attr; c++) {
+                if (state->out_table[c] == 1) {
+                    value = &match->values[state->out_column[c]];
+                    iterator->type[c] = value->type;
+                    iterator->size[c] = value->size;
+                    iterator->data[c] = value->data;
+                } else {
+                    iterator->type[c] = left->type[state->out_column[c]];
+                    iterator->size[c] = left->size[state->out_column[c]];
+                    iterator->data[c] = left->data[state->out_column[c]];
+                }
+            }
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief  Function that probes the hash table of a hash join operator with batches of the left input. The key hashes of a
+ *         left batch are computed a column at a time, the join rows are appended to the output batch until it is full.
+ */
+static int AK_hash_join_iterator_next_batch(AK_iterator *iterator, AK_batch *batch) {
+    AK_hash_join_iterator_state *state = (AK_hash_join_iterator_state *) iterator->state;
+    AK_batch *probe = state->probe;
+    AK_hash_join_row *match;
+    AK_hash_join_value *value;
+    AK_batch_column *column;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], left_type[MAX_ATTRIBUTES], left_size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES], *left_data[MAX_ATTRIBUTES];
+    int result, row, k, c;
+
+    AK_batch_reset(batch);
+    if (!state->probing)
+        return 0;
+    while (batch->num_rows < AK_BATCH_SIZE) {
+        if (state->match == NULL) {
+            if (state->position == probe->num_sel) {
+                if ((result = AK_iterator_next_batch(iterator->input[0], probe)) <= 0) {
+                    if (result == EXIT_ERROR)
+                        return EXIT_ERROR;
+                    //the left input is not read after its last row
+                    AK_iterator_close(iterator->input[0]);
+                    state->probing = 0;
+                    break;
+                }
+                AK_hash_join_hash_batch(probe, state->keys[0], state->num_keys, state->hashes);
+                state->position = 0;
+            }
+            state->probe_row = probe->sel[state->position];
+            state->hash = state->hashes[state->position++];
+            state->match = state->table.buckets[state->hash & (state->table.num_buckets - 1)];
+            continue;
+        }
+        match = state->match;
+        state->match = match->next;
+        if (match->hash != state->hash)
+            continue;
+        row = state->probe_row;
+        for (k = 0; k < state->num_keys; k++) {
+            value = &match->values[state->keys[1][k]];
+            column = &probe->column[state->keys[0][k]];
+            if (value->size != column->size[row] || memcmp(value->data, column->values + row * column->width, value->size) != 0)
+                break;
+        }
+        if (k < state->num_keys)
+            continue;
+        AK_batch_row(probe, row, left_type, left_size, left_data);
+        for (c = 0; c < iterator->num_attr; c++) {
+            if (state->out_table[c] == 1) {
+                value = &match->values[state->out_column[c]];
+                type[c] = value->type;
+                size[c] = value->size;
+                data[c] = value->data;
+            } else {
+                type[c] = left_type[state->out_column[c]];
+                size[c] = left_size[state->out_column[c]];
+                data[c] = left_data[state->out_column[c]];
+            }
+        }
+        AK_batch_append(batch, type, size, data);
+    }
+    return batch->num_sel;
+}
+
+AK_iterator *AK_hash_join_iterator(AK_iterator *left, AK_iterator *right, struct list_node *att) {
+    AK_hash_join_iterator_state *state;
+    AK_iterator *iterator, *inputs[2] = { left, right };
+    AK_header header[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int num_out = 0, t, k, c;
+    AK_PRO;
+
+    if (left == NULL || right == NULL) {
+        AK_iterator_free(left);
+        AK_iterator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+    state = (AK_hash_join_iterator_state *) AK_calloc(1, sizeof (AK_hash_join_iterator_state));
+    for (el = AK_First_L2(att); el != NULL; el = AK_Next_L2(el)) {
+        if (state->num_keys == MAX_ATTRIBUTES
+                || (state->keys[0][state->num_keys] = AK_iterator_attribute(left, el->data)) < 0
+                || (state->keys[1][state->num_keys] = AK_iterator_attribute(right, el->data)) < 0
+                || left->header[state->keys[0][state->num_keys]].type != right->header[state->keys[1][state->num_keys]].type) {
+            printf("AK_hash_join_iterator: ERROR. Rows can not be joined on %s.\n", el->data);
+            state->num_keys = -1;
+            break;
+        }
+        state->num_keys++;
+    }
+    if (state->num_keys == 0)
+        printf("AK_hash_join_iterator: ERROR. No key attributes given.\n");
+
+    //as in a natural join: the left attributes without the keys, followed by the right attributes
+    for (t = 0; t < 2 && state->num_keys > 0; t++) {
+        for (c = 0; c < inputs[t]->num_attr; c++) {
+            for (k = 0; t == 0 && k < state->num_keys && state->keys[0][k] != c; k++);
+            if (t == 0 && k < state->num_keys)
+                continue;
+            if (num_out == MAX_ATTRIBUTES) {
+                printf("AK_hash_join_iterator: ERROR. The join has more than %d attributes.\n", MAX_ATTRIBUTES);
+                state->num_keys = -1;
+                break;
+            }
+            state->out_table[num_out] = t;
+            state->out_column[num_out] = c;
+            memcpy(&header[num_out++], &inputs[t]->header[c], sizeof (AK_header));
+        }
+    }
+    if (state->num_keys <= 0) {
+        AK_free(state);
+        AK_iterator_free(left);
+        AK_iterator_free(right);
+        AK_EPI;
+        return NULL;
+    }
+
+    iterator = AK_iterator_new(num_out, header);
+    state->build = AK_iterator_batch(right);
+    state->probe = AK_iterator_batch(left);
+    iterator->state = state;
+    iterator->free_state = AK_hash_join_iterator_free;
+    iterator->input[0] = left;
+    iterator->input[1] = right;
+    iterator->open = AK_hash_join_iterator_open;
+    iterator->next = AK_hash_join_iterator_next;
+    iterator->next_batch = AK_hash_join_iterator_next_batch;
+    iterator->close = AK_hash_join_iterator_close;
+    AK_EPI;
+    return iterator;
+}
+
+/**
+ * @brief  Function that creates and fills a table for the hash join test
+ * @param tblName table name
+ * @param second name and type of the second attribute
+ * @param type type of the second attribute
+ * @param n number of rows
+ * @param step the id of row i is i * step
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_hash_join_test_table(char *tblName, char *second, int type, int n, int step) {
+    AK_header header[3];
+    AK_table_writer *writer;
+    struct list_node *row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    struct list_node *id, *value;
+    int i, number, result = EXIT_SUCCESS;
+
+    memset(header, 0, sizeof (header));
+    header[0].type = TYPE_INT;
+    strcpy(header[0].att_name, "id");
+    header[1].type = type;
+    strcpy(header[1].att_name, second);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR || (writer = AK_table_writer_open(tblName)) == NULL) {
+        AK_free(row);
+        return EXIT_ERROR;
+    }
+
+    AK_Init_L3(&row);
+    id = row->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    value = id->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    id->type = TYPE_INT;
+    id->size = sizeof (int);
+    value->type = type;
+    for (i = 0; i < n && result == EXIT_SUCCESS; i++) {
+        number = i * step;
+        memcpy(id->data, &number, sizeof (int));
+        if (type == TYPE_VARCHAR) {
+            sprintf(value->data, "name%d", number);
+            value->size = strlen(value->data);
+        } else {
+            number *= 3;
+            memcpy(value->data, &number, sizeof (int));
+            value->size = sizeof (int);
+        }
+        result = AK_table_writer_append(writer, row);
+    }
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    return result;
+}
+
+/**
+ * @brief  Function that checks the result of a hash join test. The first table has ids 0 .. n-1 with names "name<id>",
+ *         the second one even ids with values 3 * id, so every even id below n must be found exactly once.
+ * @param tblName join table name
+ * @param n number of rows of the joined tables
+ * @param id_col index of the id attribute
+ * @param name_col index of the name attribute
+ * @param val_col index of the value attribute
+ * @return 1 if the result is correct, 0 otherwise
+ */
+static int AK_hash_join_test_check(char *tblName, int n, int id_col, int name_col, int val_col) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *row;
+    char *seen = (char *) AK_calloc(n, 1);
+    char name[MAX_VARCHAR_LENGTH];
+    int rows = 0, errors = 0, first = 1, id, val;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_hash_join_row_values(row, values, cursor->num_attr);
+            first = 0;
+        }
+        memcpy(&id, values[id_col]->data, sizeof (int));
+        memcpy(&val, values[val_col]->data, sizeof (int));
+        sprintf(name, "name%d", id);
+        if (id < 0 || id >= n || id % 2 != 0 || seen[id] || val != 3 * id || strcmp(values[name_col]->data, name) != 0)
+            errors++;
+        else
+            seen[id] = 1;
+        rows++;
+    }
+    AK_table_cursor_close(cursor);
+    AK_free(seen);
+
+    if (errors > 0 || rows != n / 2)
+        printf("AK_hash_join_test: %s has %d rows (expected %d), %d of them wrong\n", tblName, rows, n / 2, errors);
+    return errors == 0 && rows == n / 2;
+}
+
+/**
+ * @brief  Function for testing the hash join. Natural and equality theta joins of tables with 500, 5000 and 50000 rows
+ *         are checked and timed, together with a Grace hash join forced by a small memory budget. The nested loop join
+ *         is timed on the smallest tables, through constraints that are not an equi-join.
+ * @return test result
+ */
+TestResult AK_hash_join_test() {
+    AK_PRO;
+    int sizes[] = { 500, 5000, 50000 };
+    int num_sizes = sizeof (sizes) / sizeof (sizes[0]);
+    char left[MAX_ATT_NAME], right[MAX_ATT_NAME], dst[MAX_ATT_NAME], att1[MAX_ATT_NAME], att2[MAX_ATT_NAME];
+    double start, nested_ms = 0, theta_ms[3], natural_ms[3], grace_ms[3];
+    struct list_node *list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    int key = 0, success = 0, failed = 0, s, n, p;
+
+    printf("\n********** HASH JOIN TEST **********\n\n");
+    AK_Init_L3(&list);
+
+    for (s = 0; s < num_sizes; s++) {
+        n = sizes[s];
+        sprintf(left, "hash_join_left%d", n);
+        sprintf(right, "hash_join_right%d", n);
+        if (AK_hash_join_test_table(left, "name", TYPE_VARCHAR, n, 1) == EXIT_ERROR
+                || AK_hash_join_test_table(right, "value", TYPE_INT, n, 2) == EXIT_ERROR) {
+            printf("AK_hash_join_test: Cannot create tables with %d rows.\n", n);
+            failed++;
+            num_sizes = s;
+            break;
+        }
+        snprintf(att1, MAX_ATT_NAME, "%s.id", left);
+        snprintf(att2, MAX_ATT_NAME, "%s.id", right);
+
+        //SELECT * FROM left, right WHERE left.id = right.id
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, att1, strlen(att1) + 1, list);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, att2, strlen(att2) + 1, list);
+        AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), list);
+        sprintf(dst, "hash_join_theta%d", n);
+        start = TEST_time_ms();
+        AK_theta_join(left, right, dst, list);
+        theta_ms[s] = TEST_time_ms() - start;
+        AK_hash_join_test_check(dst, n, 0, 1, 3) ? success++ : failed++;
+        AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+        AK_DeleteAll_L3(&list);
+
+        //the same join written as left.id >= right.id AND left.id <= right.id is left to the nested loop
+        if (s == 0) {
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, att1, strlen(att1) + 1, list);
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, att2, strlen(att2) + 1, list);
+            AK_InsertAtEnd_L3(TYPE_OPERATOR, ">=", sizeof (">="), list);
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, att1, strlen(att1) + 1, list);
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, att2, strlen(att2) + 1, list);
+            AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=", sizeof ("<="), list);
+            AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), list);
+            sprintf(dst, "hash_join_nested%d", n);
+            start = TEST_time_ms();
+            AK_theta_join(left, right, dst, list);
+            nested_ms = TEST_time_ms() - start;
+            AK_hash_join_test_check(dst, n, 0, 1, 3) ? success++ : failed++;
+            AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+            AK_DeleteAll_L3(&list);
+        }
+
+        //SELECT * FROM left NATURAL JOIN right
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), list);
+        sprintf(dst, "hash_join_natural%d", n);
+        start = TEST_time_ms();
+        AK_join(left, right, dst, list);
+        natural_ms[s] = TEST_time_ms() - start;
+        AK_hash_join_test_check(dst, n, 1, 0, 2) ? success++ : failed++;
+        AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+        AK_DeleteAll_L3(&list);
+
+        //a budget of 16 bytes per row splits every input into a handful of partitions
+        sprintf(dst, "hash_join_grace%d", n);
+        AK_create_theta_join_header(left, right, dst);
+        start = TEST_time_ms();
+        AK_hash_join(left, right, dst, 1, &key, &key, 0, n * 16);
+        grace_ms[s] = TEST_time_ms() - start;
+        AK_hash_join_test_check(dst, n, 0, 1, 3) ? success++ : failed++;
+        for (p = 0; p < AK_HASH_JOIN_MAX_PARTITIONS; p++) {
+            snprintf(att1, MAX_ATT_NAME, "%s_hash_join_1_%d", dst, p);
+            if (AK_num_attr(att1) > 0) {
+                printf("AK_hash_join_test: partition %s was not deleted\n", att1);
+                failed++;
+            }
+        }
+        AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+        AK_delete_segment(left, SEGMENT_TYPE_TABLE);
+        AK_delete_segment(right, SEGMENT_TYPE_TABLE);
+    }
+
+    printf("\nJoin of two tables on id (ms, nested loop extrapolated from %d rows)\n", sizes[0]);
+    printf("%8s %14s %12s %14s %16s\n", "rows", "nested loop", "hash join", "natural join", "grace (16 B/row)");
+    for (s = 0; s < num_sizes; s++)
+        printf("%8d %14.0f %12.0f %14.0f %16.0f\n", sizes[s], nested_ms * ((double) sizes[s] / sizes[0]) * ((double) sizes[s] / sizes[0]),
+                theta_ms[s], natural_ms[s], grace_ms[s]);
+
+    AK_free(list);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
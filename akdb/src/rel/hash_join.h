@@ -0,0 +1,116 @@
+/**
+@file hash_join.h Header file that provides data structures, functions and defines for the hash join operator
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef HASH_JOIN
+#define HASH_JOIN
+
+#include "../auxi/test.h"
+#include "../auxi/configuration.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../auxi/mempro.h"
+#include "../sql/drop.h"
+#include "iterator.h"
+
+/**
+ * @def AK_HASH_JOIN_MAX_PARTITIONS
+ * @brief Constant declaring the maximum number of partitions a hash join input is split into
+ */
+#define AK_HASH_JOIN_MAX_PARTITIONS 64
+
+/**
+ * @def AK_HASH_JOIN_ARENA_CHUNK
+ * @brief Constant declaring the size of the memory chunks the build rows are copied into
+ */
+#define AK_HASH_JOIN_ARENA_CHUNK (256 * 1024)
+
+/**
+ * @struct AK_hash_join_value
+ * @brief Structure that defines one value of a row kept in the hash table
+ */
+typedef struct {
+    int type;
+    int size;
+    char *data;
+} AK_hash_join_value;
+
+/**
+ * @struct AK_hash_join_row
+ * @brief Structure that defines a build row in a hash table bucket, the values follow the structure in the same memory chunk
+ */
+typedef struct AK_hash_join_row {
+    struct AK_hash_join_row *next;
+    unsigned int hash;
+    AK_hash_join_value *values;
+} AK_hash_join_row;
+
+/**
+ * @struct AK_hash_join_chunk
+ * @brief Structure that defines a memory chunk of the hash table
+ */
+typedef struct AK_hash_join_chunk {
+    struct AK_hash_join_chunk *next;
+    long used;
+    char data[AK_HASH_JOIN_ARENA_CHUNK];
+} AK_hash_join_chunk;
+
+/**
+ * @struct AK_hash_join_table
+ * @brief Structure that defines the in-memory hash table built on the join key of the build relation
+ */
+typedef struct {
+    int num_buckets;
+    int num_rows;
+    AK_hash_join_row **buckets;
+    AK_hash_join_chunk *chunks;
+} AK_hash_join_table;
+
+/**
+ * @brief  Function that makes an equi-join of two tables with a hash join. The hash table is built on the join key of the
+ *         smaller table and probed with the rows of the other one. When the build table does not fit the memory budget both
+ *         tables are first split by the hash of the key into temp segments (Grace hash join) and the partitions are joined
+ *         pair by pair. Key values are equal when they have the same type, size and bytes.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the join table, it must already exist
+ * @param num_keys number of key attributes
+ * @param keys1 indexes of the key attributes in the first table
+ * @param keys2 indexes of the key attributes in the second table
+ * @param natural 1 if the join table has the attributes of the first table without the keys followed by the attributes of the
+ *        second table (natural join), 0 if it has all attributes of both tables (theta join)
+ * @param memory memory budget for the hash table in bytes
+ * @return EXIT_SUCCESS, EXIT_WARNING if the key types of the two tables differ, EXIT_ERROR otherwise
+ */
+int AK_hash_join(char *srcTable1, char *srcTable2, char *dstTable, int num_keys, int *keys1, int *keys2, int natural, int memory);
+
+/**
+ * @brief  Function that makes a natural join of the rows of two operators with a hash join. The hash table is built on the
+ *         right input when the operator is opened and is probed with the rows of the left input as they come, so the
+ *         join follows the order of the left input. The right input is kept in memory, it is not partitioned.
+ * @param left left input operator, freed with the join
+ * @param right right input operator, freed with the join
+ * @param att list of the key attributes, they must be in both inputs
+ * @return operator with the attributes of the left input without the keys followed by the attributes of the right input,
+ *         NULL if an input is NULL or the inputs can not be joined
+ */
+AK_iterator *AK_hash_join_iterator(AK_iterator *left, AK_iterator *right, struct list_node *att);
+
+TestResult AK_hash_join_test();
+
+#endif
@@ -24,24 +24,13 @@
 #include "../file/fileio.h"
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 #include "../sql/drop.h"
 
 /**
  * @author Dino Laktašić
- * @struct intersect_attr
- * @brief Structure defines intersect attribute
- */
-typedef struct {
-    /// type of attribute
-    int type;
-    /// attribute name
-    char att_name[ MAX_ATT_NAME ];
-} intersect_attr;
-
-/**
- * @author Dino Laktašić
- * @brief  Function that makes a intersect of the two tables. Intersect is implemented for working with multiple sets of data, i.e. duplicate 
-          tuples can be written in same table (intersect)
+ * @brief  Function that makes a intersect of the two tables with the same schema. Rows found in both tables are written once,
+ *         see AK_hash_set_op.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
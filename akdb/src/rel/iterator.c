@@ -0,0 +1,819 @@
+/**
+@file iterator.c Provides functions for the pipelined execution of query plans
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "iterator.h"
+#include "selection.h"
+#include "projection.h"
+#include "aggregation.h"
+#include "hash_join.h"
+#include "nat_join.h"
+#include "../file/filesort.h"
+#include "../sql/select.h"
+
+AK_iterator *AK_iterator_new(int num_attr, AK_header *header) {
+    AK_iterator *iterator;
+    AK_PRO;
+    iterator = (AK_iterator *) AK_calloc(1, sizeof (AK_iterator));
+    iterator->num_attr = num_attr;
+    if (header != NULL)
+        memcpy(iterator->header, header, num_attr * sizeof (AK_header));
+    AK_EPI;
+    return iterator;
+}
+
+int AK_iterator_open(AK_iterator *iterator) {
+    int result;
+    AK_PRO;
+    result = iterator->open(iterator);
+    AK_EPI;
+    return result;
+}
+
+int AK_iterator_next(AK_iterator *iterator) {
+    int result;
+    AK_PRO;
+    result = iterator->next(iterator);
+    AK_EPI;
+    return result;
+}
+
+void AK_iterator_close(AK_iterator *iterator) {
+    AK_PRO;
+    iterator->close(iterator);
+    AK_EPI;
+}
+
+void AK_iterator_free(AK_iterator *iterator) {
+    AK_PRO;
+    if (iterator != NULL) {
+        AK_iterator_free(iterator->input[0]);
+        AK_iterator_free(iterator->input[1]);
+        if (iterator->free_state != NULL)
+            iterator->free_state(iterator->state);
+        else
+            AK_free(iterator->state);
+        AK_free(iterator);
+    }
+    AK_EPI;
+}
+
+int AK_iterator_attribute(AK_iterator *iterator, char *name) {
+    int i;
+    AK_PRO;
+    for (i = 0; i < iterator->num_attr; i++) {
+        if (strcmp(iterator->header[i].att_name, name) == 0) {
+            AK_EPI;
+            return i;
+        }
+    }
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+AK_batch *AK_batch_new(int num_attr, AK_header *header) {
+    AK_batch *batch;
+    AK_batch_column *column;
+    int c;
+    AK_PRO;
+
+    batch = (AK_batch *) AK_calloc(1, sizeof (AK_batch));
+    batch->num_attr = num_attr;
+    for (c = 0; c < num_attr; c++) {
+        column = &batch->column[c];
+        column->type = header[c].type;
+        switch (column->type) {
+            case TYPE_INT:
+                column->width = sizeof (int);
+                break;
+            case TYPE_FLOAT:
+                column->width = sizeof (float);
+                break;
+            case TYPE_NUMBER:
+                column->width = sizeof (double);
+                break;
+            default:
+                column->width = MAX_VARCHAR_LENGTH;
+        }
+        //values first, so a numeric column stays aligned for its type
+        column->memory = (char *) AK_calloc(AK_BATCH_SIZE, column->width + 2 * sizeof (int));
+    }
+    AK_batch_reset(batch);
+    AK_EPI;
+    return batch;
+}
+
+void AK_batch_free(AK_batch *batch) {
+    int c;
+    AK_PRO;
+    if (batch != NULL) {
+        for (c = 0; c < batch->num_attr; c++)
+            AK_free(batch->column[c].memory);
+        AK_free(batch);
+    }
+    AK_EPI;
+}
+
+void AK_batch_reset(AK_batch *batch) {
+    AK_batch_column *column;
+    int c;
+    AK_PRO;
+    for (c = 0; c < batch->num_attr; c++) {
+        column = &batch->column[c];
+        column->values = column->memory;
+        column->size = (int *) (column->memory + AK_BATCH_SIZE * column->width);
+        column->value_type = column->size + AK_BATCH_SIZE;
+    }
+    batch->num_rows = 0;
+    batch->num_sel = 0;
+    AK_EPI;
+}
+
+void AK_batch_share_column(AK_batch *batch, int column, AK_batch *source, int source_column) {
+    AK_PRO;
+    batch->column[column].values = source->column[source_column].values;
+    batch->column[column].size = source->column[source_column].size;
+    batch->column[column].value_type = source->column[source_column].value_type;
+    AK_EPI;
+}
+
+int AK_batch_append(AK_batch *batch, int *type, int *size, char **data) {
+    AK_batch_column *column;
+    int row = batch->num_rows++, c, n;
+    AK_PRO;
+
+    for (c = 0; c < batch->num_attr; c++) {
+        column = &batch->column[c];
+        n = (size[c] < column->width) ? size[c] : column->width;
+        if (n < column->width && column->width <= (int) sizeof (double))
+            memset(column->values + row * column->width, 0, column->width);
+        memcpy(column->values + row * column->width, data[c], n);
+        column->size[row] = n;
+        column->value_type[row] = type[c];
+    }
+    batch->sel[batch->num_sel++] = row;
+    AK_EPI;
+    return row;
+}
+
+void AK_batch_row(AK_batch *batch, int row, int *type, int *size, char **data) {
+    AK_batch_column *column;
+    int c;
+    AK_PRO;
+    for (c = 0; c < batch->num_attr; c++) {
+        column = &batch->column[c];
+        type[c] = column->value_type[row];
+        size[c] = column->size[row];
+        data[c] = column->values + row * column->width;
+    }
+    AK_EPI;
+}
+
+AK_batch *AK_iterator_batch(AK_iterator *iterator) {
+    AK_batch *batch;
+    AK_PRO;
+    batch = AK_batch_new(iterator->num_attr, iterator->header);
+    AK_EPI;
+    return batch;
+}
+
+int AK_iterator_next_batch(AK_iterator *iterator, AK_batch *batch) {
+    int result = 1;
+    AK_PRO;
+
+    if (iterator->next_batch != NULL) {
+        result = iterator->next_batch(iterator, batch);
+        AK_EPI;
+        return result;
+    }
+    AK_batch_reset(batch);
+    while (batch->num_rows < AK_BATCH_SIZE && (result = iterator->next(iterator)) == 1)
+        AK_batch_append(batch, iterator->type, iterator->size, iterator->data);
+    AK_EPI;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : batch->num_sel;
+}
+
+struct list_node *AK_iterator_row_list(AK_iterator *iterator, char *table) {
+    struct list_node *row, *last;
+    int i;
+    AK_PRO;
+    row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&row);
+    for (i = 0, last = row; i < iterator->num_attr; i++, last = last->next) {
+        last->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+        strcpy(last->next->attribute_name, iterator->header[i].att_name);
+        if (table != NULL)
+            strncpy(last->next->table, table, MAX_ATT_NAME - 1);
+    }
+    AK_EPI;
+    return row;
+}
+
+void AK_iterator_row_values(AK_iterator *iterator, struct list_node *row) {
+    struct list_node *el;
+    int i;
+    AK_PRO;
+    for (i = 0, el = row->next; i < iterator->num_attr && el != NULL; i++, el = el->next) {
+        el->type = iterator->type[i];
+        el->size = iterator->size[i];
+        memcpy(el->data, iterator->data[i], iterator->size[i]);
+        if (iterator->size[i] < MAX_VARCHAR_LENGTH)
+            el->data[iterator->size[i]] = '\0';
+    }
+    AK_EPI;
+}
+
+/**
+ * @struct AK_scan_state
+ * @brief Structure that contains the state of a table scan
+ */
+typedef struct {
+    char table[MAX_ATT_NAME];
+    AK_table_cursor *cursor;
+} AK_scan_state;
+
+static int AK_scan_open(AK_iterator *iterator) {
+    AK_scan_state *state = (AK_scan_state *) iterator->state;
+
+    state->cursor = AK_table_cursor_open(state->table);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that points the current row of a scan to the values of the row the table cursor read, the cursor keeps
+ *         them until its next row
+ */
+static int AK_scan_next(AK_iterator *iterator) {
+    AK_scan_state *state = (AK_scan_state *) iterator->state;
+    struct list_node *row, *el;
+    int i;
+
+    if ((row = AK_table_cursor_next(state->cursor)) == NULL)
+        return 0;
+    for (i = 0, el = row->next; i < iterator->num_attr && el != NULL; i++, el = el->next) {
+        iterator->type[i] = el->type;
+        iterator->size[i] = el->size;
+        iterator->data[i] = el->data;
+    }
+    return 1;
+}
+
+static void AK_scan_close(AK_iterator *iterator) {
+    AK_scan_state *state = (AK_scan_state *) iterator->state;
+
+    AK_table_cursor_close(state->cursor);
+    state->cursor = NULL;
+}
+
+AK_iterator *AK_scan_iterator(char *tblName) {
+    AK_iterator *iterator;
+    AK_scan_state *state;
+    AK_header *header;
+    int num_attr;
+    AK_PRO;
+
+    if ((num_attr = AK_num_attr(tblName)) <= 0 || (header = (AK_header *) AK_get_header(tblName)) == NULL) {
+        printf("AK_scan_iterator: ERROR. Table %s does not exist.\n", tblName);
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_new(num_attr, header);
+    AK_free(header);
+    state = (AK_scan_state *) AK_calloc(1, sizeof (AK_scan_state));
+    strncpy(state->table, tblName, MAX_ATT_NAME - 1);
+    iterator->state = state;
+    iterator->open = AK_scan_open;
+    iterator->next = AK_scan_next;
+    iterator->close = AK_scan_close;
+    AK_EPI;
+    return iterator;
+}
+
+int AK_iterator_materialize(AK_iterator *iterator, char *tblName) {
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_table_writer *writer;
+    AK_batch *batch;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int count = 0, result, i;
+    AK_PRO;
+
+    memset(header, 0, sizeof (header));
+    memcpy(header, iterator->header, iterator->num_attr * sizeof (AK_header));
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR
+            || (writer = AK_table_writer_open(tblName)) == NULL) {
+        printf("AK_iterator_materialize: ERROR. Cannot create table %s.\n", tblName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    batch = AK_iterator_batch(iterator);
+    if ((result = AK_iterator_open(iterator)) == EXIT_SUCCESS) {
+        while (result != EXIT_ERROR && (result = AK_iterator_next_batch(iterator, batch)) > 0) {
+            for (i = 0; i < batch->num_sel; i++) {
+                AK_batch_row(batch, batch->sel[i], type, size, data);
+                if (AK_table_writer_append_values(writer, type, size, data) != EXIT_SUCCESS) {
+                    result = EXIT_ERROR;
+                    break;
+                }
+            }
+            count += i;
+        }
+        AK_iterator_close(iterator);
+    }
+    AK_batch_free(batch);
+    AK_table_writer_close(writer);
+    AK_EPI;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : count;
+}
+
+int AK_iterator_print(AK_iterator *iterator, char *title) {
+    struct list_node *row;
+    int len[MAX_ATTRIBUTES], length = 0, count = 0, result, i, k;
+    clock_t t = clock();
+    AK_PRO;
+
+    //rows are printed as they come, so the columns get the width of their name or of a typical value of their type
+    for (i = 0; i < iterator->num_attr; i++) {
+        len[i] = strlen(iterator->header[i].att_name);
+        k = (iterator->header[i].type == TYPE_VARCHAR) ? 20 : (iterator->header[i].type == TYPE_INT) ? 10 : 12;
+        if (len[i] < k)
+            len[i] = k;
+        length += len[i];
+    }
+    length += iterator->num_attr * TBL_BOX_OFFSET + 2 * iterator->num_attr + 1;
+
+    printf("Table: %s\n", title);
+    AK_print_row_spacer(len, length);
+    printf("\n|");
+    for (i = 0; i < iterator->num_attr; i++) {
+        k = (len[i] - (int) strlen(iterator->header[i].att_name) + TBL_BOX_OFFSET + 1);
+        printf("%-*s%-*s|", k / 2, " ", k / 2 + (int) strlen(iterator->header[i].att_name) + k % 2, iterator->header[i].att_name);
+    }
+    printf("\n");
+    AK_print_row_spacer(len, length);
+
+    row = AK_iterator_row_list(iterator, NULL);
+    if ((result = AK_iterator_open(iterator)) == EXIT_SUCCESS) {
+        while ((result = AK_iterator_next(iterator)) == 1) {
+            AK_iterator_row_values(iterator, row);
+            AK_print_row(len, row);
+            AK_print_row_spacer(len, length);
+            count++;
+        }
+        AK_iterator_close(iterator);
+    }
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+
+    t = clock() - t;
+    printf("\n%i rows found, duration: %f μs\n", count, ((double) t) / CLOCKS_PER_SEC * 1000);
+    AK_EPI;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : count;
+}
+
+/**
+ * @brief  Function that counts the rows of a plan
+ * @param iterator root operator of the plan
+ * @return number of rows, EXIT_ERROR on error
+ */
+static int AK_iterator_test_count(AK_iterator *iterator) {
+    int count = 0, result;
+
+    if (iterator == NULL || AK_iterator_open(iterator) == EXIT_ERROR)
+        return EXIT_ERROR;
+    while ((result = AK_iterator_next(iterator)) == 1)
+        count++;
+    AK_iterator_close(iterator);
+    return (result == EXIT_ERROR) ? EXIT_ERROR : count;
+}
+
+/**
+ * @brief  Function that counts the rows of a plan run by batches and sums one of its numeric attributes
+ * @param iterator root operator of the plan
+ * @param column index of the attribute that is summed
+ * @param sum set to the sum of the attribute
+ * @return number of rows, EXIT_ERROR on error
+ */
+static int AK_iterator_test_batches(AK_iterator *iterator, int column, double *sum) {
+    AK_batch *batch;
+    AK_batch_column *values;
+    int count = 0, result, row, i;
+
+    *sum = 0;
+    if (iterator == NULL || AK_iterator_open(iterator) == EXIT_ERROR)
+        return EXIT_ERROR;
+    batch = AK_iterator_batch(iterator);
+    values = &batch->column[column];
+    while ((result = AK_iterator_next_batch(iterator, batch)) > 0) {
+        for (i = 0; i < batch->num_sel; i++) {
+            row = batch->sel[i];
+            if (values->value_type[row] == TYPE_INT)
+                *sum += ((int *) values->values)[row];
+            else if (values->value_type[row] == TYPE_FLOAT)
+                *sum += ((float *) values->values)[row];
+            else if (values->value_type[row] == TYPE_NUMBER)
+                *sum += ((double *) values->values)[row];
+        }
+        count += batch->num_sel;
+    }
+    AK_iterator_close(iterator);
+    AK_batch_free(batch);
+    return (result == EXIT_ERROR) ? EXIT_ERROR : count;
+}
+
+/**
+ * @brief  Function that tests the operators of pipelined plans on the student table against the rows read with a table
+ *         cursor
+ * @return TestResult
+ */
+TestResult AK_iterator_test() {
+    struct list_node *condition, *attributes, *row;
+    AK_iterator *plan;
+    AK_table_cursor *cursor;
+    AK_agg_input agg;
+    AK_header *header;
+    char last[MAX_VARCHAR_LENGTH] = "";
+    int num_rows = 0, selected = 0, year, count, sum, result, i;
+    float weight, value;
+    double total;
+    int passed = 0, failed = 0;
+    AK_PRO;
+
+    //expected results from the rows of the table
+    cursor = AK_table_cursor_open("student");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        memcpy(&year, row->next->next->next->next->data, sizeof (int));
+        num_rows++;
+        selected += (year < 2008);
+    }
+    AK_table_cursor_close(cursor);
+    printf("student has %d rows, %d of them with year < 2008\n", num_rows, selected);
+
+    condition = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&condition);
+    year = 2008;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof ("year"), condition);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &year, sizeof (int), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), condition);
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+
+    printf("\nscan student\n");
+    plan = AK_scan_iterator("student");
+    if (num_rows > 0 && AK_iterator_test_count(plan) == num_rows && AK_iterator_test_count(plan) == num_rows) {
+        printf("OK, the plan can be run twice\n");
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+    AK_iterator_free(plan);
+
+    printf("\nselection year < 2008 on student\n");
+    plan = AK_selection_iterator("student", condition);
+    if (AK_iterator_test_count(plan) == selected) {
+        printf("OK, %d rows\n", selected);
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+    AK_iterator_free(plan);
+
+    printf("\nprojection firstname, weight+year of the selection sorted by firstname\n");
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), attributes);
+    plan = AK_sort_iterator(AK_selection_iterator("student", condition), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight+year", sizeof ("weight+year"), attributes);
+    plan = AK_projection_iterator(plan, attributes);
+    result = (plan != NULL && plan->num_attr == 2 && plan->header[1].type == TYPE_FLOAT
+            && AK_iterator_open(plan) == EXIT_SUCCESS);
+    for (i = 0; result && AK_iterator_next(plan) == 1; i++) {
+        //rows come by firstname and every sum of a weight and a year is above 2000
+        memcpy(&value, plan->data[1], sizeof (float));
+        if (AK_sort_compare_values(TYPE_VARCHAR, last, strlen(last), plan->data[0], plan->size[0]) > 0 || value < 2000)
+            result = 0;
+        memcpy(last, plan->data[0], plan->size[0]);
+        last[plan->size[0]] = '\0';
+    }
+    if (plan != NULL && result)
+        AK_iterator_close(plan);
+    if (result && i == selected) {
+        printf("OK, %d rows in order\n", i);
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+    if (plan != NULL)
+        AK_iterator_print(plan, "student");
+    AK_iterator_free(plan);
+
+    printf("\ncount and sum of weight by year of the selection\n");
+    header = (AK_header *) AK_get_header("student");
+    AK_agg_input_init(&agg);
+    AK_agg_input_add(header[3], AGG_TASK_GROUP, &agg);
+    AK_agg_input_add(header[3], AGG_TASK_COUNT, &agg);
+    AK_agg_input_add(header[4], AGG_TASK_SUM, &agg);
+    AK_free(header);
+    plan = AK_aggregation_iterator(AK_selection_iterator("student", condition), &agg);
+    count = 0;
+    weight = 0;
+    result = (plan != NULL && AK_iterator_open(plan) == EXIT_SUCCESS);
+    while (result && AK_iterator_next(plan) == 1) {
+        memcpy(&year, plan->data[0], sizeof (int));
+        memcpy(&sum, plan->data[1], sizeof (int));
+        memcpy(&value, plan->data[2], sizeof (float));
+        if (year >= 2008)
+            result = 0;
+        count += sum;
+        weight += value;
+    }
+    if (plan != NULL && result)
+        AK_iterator_close(plan);
+    if (result && count == selected && (selected == 0 || weight > 0)) {
+        printf("OK, %d rows in the groups\n", count);
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+    AK_iterator_free(plan);
+
+    printf("\nhash join of the selection with student on mbr\n");
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), attributes);
+    plan = AK_hash_join_iterator(AK_selection_iterator("student", condition), AK_scan_iterator("student"), attributes);
+    if (plan != NULL && plan->num_attr == 9 && strcmp(plan->header[4].att_name, "mbr") == 0
+            && AK_iterator_test_count(plan) == selected) {
+        printf("OK, %d rows\n", selected);
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+    AK_iterator_free(plan);
+
+    printf("\nthe same plans by batches\n");
+    plan = AK_selection_iterator("student", condition);
+    count = AK_iterator_test_batches(plan, 3, &total);
+    AK_iterator_free(plan);
+    result = (count == selected);
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof ("firstname"), attributes);
+    plan = AK_sort_iterator(AK_selection_iterator("student", condition), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "weight+year", sizeof ("weight+year"), attributes);
+    plan = AK_projection_iterator(plan, attributes);
+    //the sums of weight+year computed by rows and by batches must be the same
+    weight = 0;
+    if (plan != NULL && AK_iterator_open(plan) == EXIT_SUCCESS) {
+        while (AK_iterator_next(plan) == 1) {
+            memcpy(&value, plan->data[1], sizeof (float));
+            weight += value;
+        }
+        AK_iterator_close(plan);
+    }
+    result = result && AK_iterator_test_batches(plan, 1, &total) == selected && total - weight < 0.5 && weight - total < 0.5;
+    AK_iterator_free(plan);
+    plan = AK_aggregation_iterator(AK_selection_iterator("student", condition), &agg);
+    result = result && AK_iterator_test_batches(plan, 1, &total) >= 0 && (int) total == selected;
+    AK_iterator_free(plan);
+    AK_DeleteAll_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", sizeof ("mbr"), attributes);
+    plan = AK_hash_join_iterator(AK_selection_iterator("student", condition), AK_scan_iterator("student"), attributes);
+    result = result && AK_iterator_test_batches(plan, 0, &total) == selected;
+    AK_iterator_free(plan);
+    if (result) {
+        printf("OK, selection, projection, aggregation and hash join return the same rows\n");
+        passed++;
+    } else {
+        printf("FAILED\n");
+        failed++;
+    }
+
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    AK_DeleteAll_L3(&condition);
+    AK_free(condition);
+    AK_EPI;
+    return TEST_result(passed, failed);
+}
+
+/**
+ * @brief  Function that runs the plan of the batch benchmark and adds up its groups
+ * @param plan aggregation with the GROUP attribute, a SUM and a COUNT
+ * @param batches 1 to run the plan by batches, 0 to run it by rows
+ * @param sum sums of the groups
+ * @param count counts of the groups
+ * @return number of groups, EXIT_ERROR on error
+ */
+static int AK_iterator_benchmark_run(AK_iterator *plan, int batches, double *sum, int *count) {
+    AK_batch *batch = AK_iterator_batch(plan);
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    int groups = 0, result, group, number, i;
+    float value;
+
+    if (AK_iterator_open(plan) == EXIT_ERROR) {
+        AK_batch_free(batch);
+        return EXIT_ERROR;
+    }
+    for (;;) {
+        if (batches) {
+            if ((result = AK_iterator_next_batch(plan, batch)) <= 0)
+                break;
+        } else {
+            if ((result = AK_iterator_next(plan)) != 1)
+                break;
+            AK_batch_reset(batch);
+            AK_batch_append(batch, plan->type, plan->size, plan->data);
+        }
+        for (i = 0; i < batch->num_sel; i++, groups++) {
+            AK_batch_row(batch, batch->sel[i], type, size, data);
+            memcpy(&group, data[0], sizeof (int));
+            memcpy(&value, data[1], sizeof (float));
+            memcpy(&number, data[2], sizeof (int));
+            sum[group] = value;
+            count[group] = number;
+        }
+    }
+    AK_iterator_close(plan);
+    AK_batch_free(batch);
+    return (result == EXIT_ERROR) ? EXIT_ERROR : groups;
+}
+
+/**
+ * @brief  Function that compares the rows per second of a query on the list_node path, on operators run by rows and on
+ *         operators run by batches. The query is SELECT grp, SUM(v+w), COUNT(*) WHERE v < 500 AND w > 10 GROUP BY grp on a
+ *         table of 20000 rows; all three must give the same groups.
+ * @return TestResult
+ */
+TestResult AK_iterator_batch_benchmark() {
+    char *tblName = "iterator_batch_bench";
+    int num_rows = 20000, num_groups = 50, num_passes = 5;
+    AK_header header[MAX_ATTRIBUTES];
+    AK_header *bench_header;
+    AK_table_writer *writer;
+    AK_table_cursor *cursor;
+    AK_agg_input agg;
+    AK_iterator *plan;
+    struct list_node *row, *list, *el, *condition, *attributes;
+    double sum[3][50];
+    int count[3][50];
+    int i, p, mode, pass, v, grp, limit = 500, success = 0, failed = 0;
+    float w, low = 10.0;
+    double start, elapsed[3];
+    char name[MAX_VARCHAR_LENGTH];
+    const char *modes[3] = { "list_node rows", "operators by rows", "operators by batches" };
+    AK_PRO;
+
+    memset(header, 0, sizeof (header));
+    header[0].type = TYPE_INT;
+    strcpy(header[0].att_name, "id");
+    header[1].type = TYPE_INT;
+    strcpy(header[1].att_name, "grp");
+    header[2].type = TYPE_INT;
+    strcpy(header[2].att_name, "v");
+    header[3].type = TYPE_FLOAT;
+    strcpy(header[3].att_name, "w");
+    header[4].type = TYPE_VARCHAR;
+    strcpy(header[4].att_name, "name");
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR || (writer = AK_table_writer_open(tblName)) == NULL) {
+        printf("AK_iterator_batch_benchmark: ERROR. Cannot create table %s.\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&row);
+        grp = i % num_groups;
+        v = i % 1000;
+        w = (i % 100) * 0.5;
+        sprintf(name, "row%d", i);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &i, sizeof (int), row);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &grp, sizeof (int), row);
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &v, sizeof (int), row);
+        AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &w, sizeof (float), row);
+        AK_InsertAtEnd_L3(TYPE_VARCHAR, name, strlen(name), row);
+        if (AK_table_writer_append(writer, row) != EXIT_SUCCESS)
+            break;
+    }
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+
+    condition = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&condition);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "v", sizeof ("v"), condition);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &limit, sizeof (int), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), condition);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "w", sizeof ("w"), condition);
+    AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &low, sizeof (float), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), condition);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), condition);
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), attributes);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "v+w", sizeof ("v+w"), attributes);
+    bench_header = (AK_header *) AK_get_header(tblName);
+
+    //the list_node path: every row is rebuilt as a list with attribute names, checked by the expression interpreter
+    //and its values are read from the list
+    memset(sum, 0, sizeof (sum));
+    memset(count, 0, sizeof (count));
+    start = TEST_time_ms();
+    for (pass = 0; pass < num_passes; pass++) {
+        memset(sum[0], 0, sizeof (sum[0]));
+        memset(count[0], 0, sizeof (count[0]));
+        cursor = AK_table_cursor_open(tblName);
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
+            list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+            AK_Init_L3(&list);
+            for (i = 0, el = AK_First_L2(row); el != NULL; i++, el = el->next)
+                AK_Insert_New_Element(el->type, el->data, tblName, bench_header[i].att_name, list);
+            if (AK_check_if_row_satisfies_expression(list, condition)) {
+                el = AK_First_L2(list)->next;
+                memcpy(&grp, el->data, sizeof (int));
+                memcpy(&v, el->next->data, sizeof (int));
+                memcpy(&w, el->next->next->data, sizeof (float));
+                w += v;
+                sum[0][grp] += w;
+                count[0][grp]++;
+            }
+            AK_DeleteAll_L3(&list);
+            AK_free(list);
+        }
+        AK_table_cursor_close(cursor);
+    }
+    elapsed[0] = TEST_time_ms() - start;
+
+    for (mode = 1; mode < 3; mode++) {
+        plan = AK_projection_iterator(AK_selection_iterator(tblName, condition), attributes);
+        AK_agg_input_init(&agg);
+        if (plan != NULL) {
+            AK_agg_input_add(plan->header[0], AGG_TASK_GROUP, &agg);
+            AK_agg_input_add(plan->header[1], AGG_TASK_SUM, &agg);
+            AK_agg_input_add(plan->header[0], AGG_TASK_COUNT, &agg);
+            plan = AK_aggregation_iterator(plan, &agg);
+        }
+        if (plan == NULL) {
+            printf("AK_iterator_batch_benchmark: ERROR. Cannot make the plan.\n");
+            failed++;
+            elapsed[mode] = 0;
+            continue;
+        }
+        start = TEST_time_ms();
+        for (pass = 0; pass < num_passes; pass++) {
+            memset(sum[mode], 0, sizeof (sum[mode]));
+            memset(count[mode], 0, sizeof (count[mode]));
+            if (AK_iterator_benchmark_run(plan, mode == 2, sum[mode], count[mode]) != num_groups)
+                break;
+        }
+        elapsed[mode] = TEST_time_ms() - start;
+        if (pass < num_passes) {
+            printf("AK_iterator_batch_benchmark: ERROR. %s did not return %d groups.\n", modes[mode], num_groups);
+            failed++;
+        }
+        AK_iterator_free(plan);
+    }
+
+    for (mode = 1; mode < 3; mode++) {
+        for (p = 0; p < num_groups; p++) {
+            if (count[mode][p] == count[0][p] && sum[mode][p] - sum[0][p] < 0.5 && sum[0][p] - sum[mode][p] < 0.5)
+                success++;
+            else {
+                printf("AK_iterator_batch_benchmark: ERROR. Group %d of %s differs.\n", p, modes[mode]);
+                failed++;
+            }
+        }
+    }
+
+    printf("\n%d passes over %d rows of table %s\n", num_passes, num_rows, tblName);
+    printf("%-24s %14s %10s\n", "path", "rows/s", "ms");
+    for (mode = 0; mode < 3; mode++)
+        printf("%-24s %14.0f %10.1f\n", modes[mode], elapsed[mode] > 0 ? num_passes * num_rows / (elapsed[mode] / 1000.0) : 0, elapsed[mode]);
+
+    AK_free(bench_header);
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    AK_DeleteAll_L3(&condition);
+    AK_free(condition);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
@@ -0,0 +1,256 @@
+/**
+@file iterator.h Header file that provides data structures and functions for the pipelined execution of query plans
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ITERATOR
+#define ITERATOR
+
+//declared before the includes, headers of the operators are reached through them
+typedef struct AK_iterator AK_iterator;
+typedef struct AK_batch AK_batch;
+
+#include "../auxi/test.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @def AK_BATCH_SIZE
+ * @brief Constant declaring the number of rows in a batch
+ */
+#define AK_BATCH_SIZE 1024
+
+/**
+ * @struct AK_batch_column
+ * @brief Structure that defines the values of an attribute in a batch as a vector of its type
+ */
+typedef struct {
+    /// type of the attribute
+    int type;
+    /// bytes per value: the size of the number for TYPE_INT, TYPE_FLOAT and TYPE_NUMBER, MAX_VARCHAR_LENGTH otherwise
+    int width;
+    /// values, width bytes apart, so a numeric column is an array of int, float or double
+    char *values;
+    int *size;
+    /// type of every value, values stored with another type (nulls are the varchar "null") keep their first width bytes
+    int *value_type;
+    /// memory of the column, values, size and value_type may point into the column of another batch instead
+    char *memory;
+} AK_batch_column;
+
+/**
+ * @struct AK_batch
+ * @brief Structure that defines a batch of rows stored by columns. Operators that take batches work on whole columns;
+ * a filter only changes the selection vector, so the rows it leaves out stay in the columns.
+ */
+struct AK_batch {
+    int num_attr;
+    AK_batch_column column[MAX_ATTRIBUTES];
+    /// number of rows in the columns
+    int num_rows;
+    /// indexes of the selected rows in increasing order and their number
+    int num_sel;
+    int sel[AK_BATCH_SIZE];
+};
+
+/**
+ * @struct AK_iterator
+ * @brief Structure that defines an operator of a query plan with the open/next/close interface. A plan is a tree of
+ * operators; next asks the input operators for rows as it needs them, so rows stream through the plan in memory and
+ * only operators that must see all of their input before returning a row (sort, hash build) keep it.
+ */
+struct AK_iterator {
+    /// prepares the operator and its inputs, returns EXIT_SUCCESS or EXIT_ERROR
+    int (*open)(struct AK_iterator *iterator);
+    /// makes the next row the current row, returns 1, 0 after the last row or EXIT_ERROR
+    int (*next)(struct AK_iterator *iterator);
+    /// fills a batch made by AK_iterator_batch with the next rows, NULL if the rows are only returned one by one
+    int (*next_batch)(struct AK_iterator *iterator, AK_batch *batch);
+    /// releases what open and next took, the operator can be opened again
+    void (*close)(struct AK_iterator *iterator);
+    /// frees the state, may be NULL
+    void (*free_state)(void *state);
+    /// header of the rows the operator returns
+    int num_attr;
+    AK_header header[MAX_ATTRIBUTES];
+    /// current row, valid until the next call of next or close
+    int type[MAX_ATTRIBUTES];
+    int size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    /// input operators, NULL if there are fewer
+    struct AK_iterator *input[2];
+    /// state of the operator
+    void *state;
+};
+
+/**
+ * @brief Function that allocates an operator, the caller sets its functions, state and header
+ * @param num_attr number of attributes of the rows it returns
+ * @param header header of the rows, NULL to leave it empty
+ * @return operator
+ */
+AK_iterator *AK_iterator_new(int num_attr, AK_header *header);
+
+/**
+ * @brief Function that opens an operator
+ * @param iterator operator
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+int AK_iterator_open(AK_iterator *iterator);
+
+/**
+ * @brief Function that fetches the next row of an operator into iterator->type, size and data
+ * @param iterator operator
+ * @return 1 if there is a row, 0 after the last row, EXIT_ERROR on error
+ */
+int AK_iterator_next(AK_iterator *iterator);
+
+/**
+ * @brief Function that closes an operator
+ * @param iterator operator
+ * @return No return value
+ */
+void AK_iterator_close(AK_iterator *iterator);
+
+/**
+ * @brief Function that frees an operator and its inputs
+ * @param iterator operator, may be NULL
+ * @return No return value
+ */
+void AK_iterator_free(AK_iterator *iterator);
+
+/**
+ * @brief Function that finds an attribute in the header of an operator
+ * @param iterator operator
+ * @param name attribute name
+ * @return index of the attribute, EXIT_ERROR if there is no such attribute
+ */
+int AK_iterator_attribute(AK_iterator *iterator, char *name);
+
+/**
+ * @brief Function that copies the current row of an operator into a row list of num_attr elements, allocated once
+ * @param iterator operator
+ * @param row row list, its elements keep their attribute names
+ * @return No return value
+ */
+void AK_iterator_row_values(AK_iterator *iterator, struct list_node *row);
+
+/**
+ * @brief Function that allocates a row list with an element for every attribute of an operator
+ * @param iterator operator
+ * @param table table name the elements are given, may be NULL
+ * @return row list
+ */
+struct list_node *AK_iterator_row_list(AK_iterator *iterator, char *table);
+
+/**
+ * @brief Function that reads the rows of a table
+ * @param tblName table name
+ * @return operator, NULL if the table does not exist
+ */
+AK_iterator *AK_scan_iterator(char *tblName);
+
+/**
+ * @brief Function that allocates a batch for the rows of an operator
+ * @param iterator operator
+ * @return batch
+ */
+AK_batch *AK_iterator_batch(AK_iterator *iterator);
+
+/**
+ * @brief Function that fetches the next rows of an operator into a batch. Operators without next_batch fill it row by row.
+ *        A plan is run either with AK_iterator_next or with AK_iterator_next_batch between open and close, not with both.
+ * @param iterator operator
+ * @param batch batch made by AK_iterator_batch for the operator
+ * @return number of selected rows, 0 after the last row, EXIT_ERROR on error
+ */
+int AK_iterator_next_batch(AK_iterator *iterator, AK_batch *batch);
+
+/**
+ * @brief Function that allocates a batch
+ * @param num_attr number of attributes
+ * @param header header of the attributes
+ * @return batch
+ */
+AK_batch *AK_batch_new(int num_attr, AK_header *header);
+
+/**
+ * @brief Function that frees a batch
+ * @param batch batch, may be NULL
+ * @return No return value
+ */
+void AK_batch_free(AK_batch *batch);
+
+/**
+ * @brief Function that empties a batch, its columns get their own memory back
+ * @param batch batch
+ * @return No return value
+ */
+void AK_batch_reset(AK_batch *batch);
+
+/**
+ * @brief Function that makes a column of a batch show the values of a column of another batch, the values are not copied
+ * @param batch batch
+ * @param column index of the column
+ * @param source batch that keeps the values while they are used
+ * @param source_column index of the column in source
+ * @return No return value
+ */
+void AK_batch_share_column(AK_batch *batch, int column, AK_batch *source, int source_column);
+
+/**
+ * @brief Function that adds a row to a batch and selects it
+ * @param batch batch with fewer than AK_BATCH_SIZE rows
+ * @param type types of the values
+ * @param size sizes of the values
+ * @param data values
+ * @return index of the row
+ */
+int AK_batch_append(AK_batch *batch, int *type, int *size, char **data);
+
+/**
+ * @brief Function that points arrays to the values of a row of a batch
+ * @param batch batch
+ * @param row index of the row
+ * @param type types of the values
+ * @param size sizes of the values
+ * @param data set to the values in the batch
+ * @return No return value
+ */
+void AK_batch_row(AK_batch *batch, int row, int *type, int *size, char **data);
+
+/**
+ * @brief Function that runs a plan by batches and writes its rows to a new table with the sequential table writer
+ * @param iterator root operator of the plan
+ * @param tblName name of the table, it is created with the header of the operator
+ * @return number of rows, EXIT_ERROR on error
+ */
+int AK_iterator_materialize(AK_iterator *iterator, char *tblName);
+
+/**
+ * @brief Function that runs a plan and prints its rows as AK_print_table prints a table
+ * @param iterator root operator of the plan
+ * @param title name printed above the rows
+ * @return number of rows, EXIT_ERROR on error
+ */
+int AK_iterator_print(AK_iterator *iterator, char *title);
+
+TestResult AK_iterator_test();
+TestResult AK_iterator_batch_benchmark();
+
+#endif
@@ -0,0 +1,397 @@
+/**
+@file merge_join.c Provides functions for the sort-merge join operator
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "merge_join.h"
+#include "hash_join.h"
+#include "theta_join.h"
+
+/**
+ * @brief  Function that points the values of a row view to the current row of a table cursor
+ * @param row row returned by AK_table_cursor_next
+ * @param view values of the row
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_merge_join_view(struct list_node *row, AK_sort_value *view, int num_attr) {
+    struct list_node *el = AK_First_L2(row);
+    int i;
+
+    for (i = 0; i < num_attr && el != NULL; i++, el = el->next) {
+        view[i].type = el->type;
+        view[i].size = el->size;
+        view[i].data = el->data;
+    }
+}
+
+/**
+ * @brief  Function that compares the join keys of two rows
+ * @param num_keys number of key attributes
+ * @param types types of the key attributes
+ * @param a values of a row of the first table
+ * @param keys_a indexes of the key attributes in the first table
+ * @param b values of a row of the second table
+ * @param keys_b indexes of the key attributes in the second table
+ * @return negative value, zero or positive value if the key of a is less than, equal to or greater than the key of b
+ */
+static int AK_merge_join_compare(int num_keys, int *types, AK_sort_value *a, int *keys_a, AK_sort_value *b, int *keys_b) {
+    int k, result;
+
+    for (k = 0; k < num_keys; k++) {
+        result = AK_sort_compare_values(types[k], a[keys_a[k]].data, a[keys_a[k]].size, b[keys_b[k]].data, b[keys_b[k]].size);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Function that copies a row so it outlives the cursor it was read by
+ * @param view values of the row
+ * @param num_attr number of attributes
+ * @return copy of the values, the data follows them in the same allocation
+ */
+static AK_sort_value *AK_merge_join_copy(AK_sort_value *view, int num_attr) {
+    int size = num_attr * sizeof (AK_sort_value);
+    AK_sort_value *copy;
+    char *data;
+    int i;
+
+    for (i = 0; i < num_attr; i++)
+        size += view[i].size + 1;
+    copy = (AK_sort_value *) AK_malloc(size);
+    data = (char *) (copy + num_attr);
+    for (i = 0; i < num_attr; i++) {
+        copy[i].type = view[i].type;
+        copy[i].size = view[i].size;
+        copy[i].data = data;
+        memcpy(data, view[i].data, view[i].size);
+        data[view[i].size] = '\0';
+        data += view[i].size + 1;
+    }
+    return copy;
+}
+
+/**
+ * @brief  Function that makes an equi-join of two tables with a sort-merge join. Both tables are read in the order of the
+ *         join key and rows with equal keys are matched group by group, only the rows of the second table with the current
+ *         key are kept in memory. Tables that are not sorted on the key yet are first sorted into temp segments with an
+ *         external merge sort. The join table is ordered by the key.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the join table, it must already exist
+ * @param num_keys number of key attributes
+ * @param keys1 indexes of the key attributes in the first table
+ * @param keys2 indexes of the key attributes in the second table
+ * @param natural 1 if the join table has the attributes of the first table without the keys followed by the attributes of the
+ *        second table (natural join), 0 if it has all attributes of both tables (theta join)
+ * @param sorted 1 if both tables are already sorted ascending on their keys (for example read through an index), 0 if they
+ *        have to be sorted first
+ * @return EXIT_SUCCESS, EXIT_WARNING if the key types of the two tables differ, EXIT_ERROR otherwise
+ */
+int AK_merge_join(char *srcTable1, char *srcTable2, char *dstTable, int num_keys, int *keys1, int *keys2, int natural, int sorted) {
+    AK_PRO;
+    char *tables[2] = { srcTable1, srcTable2 };
+    int *keys[2] = { keys1, keys2 };
+    char names[2][MAX_ATT_NAME];
+    int num_attr[2], types[MAX_ATTRIBUTES], out_table[2 * MAX_ATTRIBUTES], out_column[2 * MAX_ATTRIBUTES];
+    AK_sort_value view[2][MAX_ATTRIBUTES], **group;
+    AK_header *header[2];
+    AK_sort_keys sort_keys;
+    AK_table_cursor *cursor[2];
+    AK_table_writer *writer;
+    struct list_node *row[2], *out_row, *el;
+    int num_out = 0, num_group = 0, max_group = 64, result = EXIT_SUCCESS, t, k, c, g;
+
+    num_attr[0] = AK_num_attr(srcTable1);
+    num_attr[1] = AK_num_attr(srcTable2);
+    if (num_attr[0] <= 0 || num_attr[1] <= 0 || num_keys <= 0 || num_keys > MAX_ATTRIBUTES) {
+        printf("AK_merge_join: ERROR. Table %s or %s does not exist.\n", srcTable1, srcTable2);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    header[0] = AK_get_header(srcTable1);
+    header[1] = AK_get_header(srcTable2);
+    for (k = 0; k < num_keys; k++) {
+        if (keys1[k] < 0 || keys1[k] >= num_attr[0] || keys2[k] < 0 || keys2[k] >= num_attr[1]
+                || header[0][keys1[k]].type != header[1][keys2[k]].type)
+            result = EXIT_WARNING;
+        else
+            types[k] = header[0][keys1[k]].type;
+    }
+    AK_free(header[0]);
+    AK_free(header[1]);
+
+    for (t = 0; t < 2; t++) {
+        for (c = 0; c < num_attr[t]; c++) {
+            for (k = 0; natural && t == 0 && k < num_keys && keys1[k] != c; k++);
+            if (!natural || t == 1 || k == num_keys) {
+                out_table[num_out] = t;
+                out_column[num_out++] = c;
+            }
+        }
+    }
+    if (num_out != AK_num_attr(dstTable))
+        result = EXIT_WARNING;
+
+    if (result != EXIT_SUCCESS || (writer = AK_table_writer_open(dstTable)) == NULL) {
+        AK_dbg_messg(LOW, REL_OP, "AK_merge_join: join of %s and %s can not be done with a merge join\n", srcTable1, srcTable2);
+        AK_EPI;
+        return (result == EXIT_SUCCESS) ? EXIT_ERROR : result;
+    }
+
+    //unsorted inputs are sorted ascending on the key into temp segments
+    for (t = 0; t < 2; t++) {
+        strcpy(names[t], tables[t]);
+        if (!sorted && result == EXIT_SUCCESS) {
+            snprintf(names[t], MAX_ATT_NAME, "%s_merge_join_%d", dstTable, t + 1);
+            sort_keys.num_keys = num_keys;
+            for (k = 0; k < num_keys; k++) {
+                sort_keys.column[k] = keys[t][k];
+                sort_keys.descending[k] = 0;
+            }
+            result = AK_external_sort(tables[t], names[t], &sort_keys, SORT_MEMORY * 1024);
+        }
+    }
+
+    out_row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&out_row);
+    for (c = 0, el = out_row; c < num_out; c++, el = el->next)
+        el->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    group = (AK_sort_value **) AK_malloc(max_group * sizeof (AK_sort_value *));
+
+    for (t = 0; t < 2; t++) {
+        cursor[t] = (result == EXIT_SUCCESS) ? AK_table_cursor_open(names[t]) : NULL;
+        if ((row[t] = AK_table_cursor_next(cursor[t])) != NULL)
+            AK_merge_join_view(row[t], view[t], num_attr[t]);
+    }
+
+    while (row[0] != NULL && row[1] != NULL && result == EXIT_SUCCESS) {
+        c = AK_merge_join_compare(num_keys, types, view[0], keys1, view[1], keys2);
+        if (c != 0) {
+            t = (c < 0) ? 0 : 1;
+            if ((row[t] = AK_table_cursor_next(cursor[t])) != NULL)
+                AK_merge_join_view(row[t], view[t], num_attr[t]);
+            continue;
+        }
+
+        //the rows of the second table with the current key
+        num_group = 0;
+        do {
+            if (num_group == max_group) {
+                max_group *= 2;
+                group = (AK_sort_value **) AK_realloc(group, max_group * sizeof (AK_sort_value *));
+            }
+            group[num_group++] = AK_merge_join_copy(view[1], num_attr[1]);
+            if ((row[1] = AK_table_cursor_next(cursor[1])) != NULL)
+                AK_merge_join_view(row[1], view[1], num_attr[1]);
+        } while (row[1] != NULL && AK_merge_join_compare(num_keys, types, view[0], keys1, view[1], keys2) == 0);
+
+        //are joined with every row of the first table with that key
+        do {
+            for (g = 0; g < num_group && result == EXIT_SUCCESS; g++) {
+                for (c = 0, el = AK_First_L2(out_row); c < num_out; c++, el = el->next) {
+                    AK_sort_value *value = (out_table[c] == 0) ? &view[0][out_column[c]] : &group[g][out_column[c]];
+                    el->type = value->type;
+                    el->size = value->size;
+                    memcpy(el->data, value->data, value->size + 1);
+                }
+                result = AK_table_writer_append(writer, out_row);
+            }
+            if ((row[0] = AK_table_cursor_next(cursor[0])) != NULL)
+                AK_merge_join_view(row[0], view[0], num_attr[0]);
+        } while (row[0] != NULL && result == EXIT_SUCCESS && AK_merge_join_compare(num_keys, types, view[0], keys1, group[0], keys2) == 0);
+
+        for (g = 0; g < num_group; g++)
+            AK_free(group[g]);
+    }
+
+    for (t = 0; t < 2; t++) {
+        AK_table_cursor_close(cursor[t]);
+        if (strcmp(names[t], tables[t]) != 0 && AK_num_attr(names[t]) > 0)
+            AK_delete_segment(names[t], SEGMENT_TYPE_TABLE);
+    }
+    AK_table_writer_close(writer);
+    AK_free(group);
+    AK_DeleteAll_L3(&out_row);
+    AK_free(out_row);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that creates and fills a table for the merge join test. The rows are written in a scrambled order of ids.
+ * @param tblName table name
+ * @param second name of the second attribute
+ * @param type type of the second attribute
+ * @param n number of rows
+ * @param pairs 1 if the table has two rows for every even id below n, 0 if it has one row for every id below n
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_merge_join_test_table(char *tblName, char *second, int type, int n, int pairs) {
+    AK_header header[3];
+    AK_table_writer *writer;
+    struct list_node *row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    struct list_node *id, *value;
+    int i, number, result = EXIT_SUCCESS;
+
+    memset(header, 0, sizeof (header));
+    header[0].type = TYPE_INT;
+    strcpy(header[0].att_name, "id");
+    header[1].type = type;
+    strcpy(header[1].att_name, second);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR || (writer = AK_table_writer_open(tblName)) == NULL) {
+        AK_free(row);
+        return EXIT_ERROR;
+    }
+
+    AK_Init_L3(&row);
+    id = row->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    value = id->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    id->type = TYPE_INT;
+    id->size = sizeof (int);
+    value->type = type;
+    for (i = 0; i < n && result == EXIT_SUCCESS; i++) {
+        //7919 is a prime, so i * 7919 % n visits every id below n once
+        number = (int) ((long) i * 7919 % n);
+        if (pairs)
+            number &= ~1;
+        memcpy(id->data, &number, sizeof (int));
+        if (type == TYPE_VARCHAR) {
+            sprintf(value->data, "name%d", number);
+            value->size = strlen(value->data);
+        } else {
+            number *= 3;
+            memcpy(value->data, &number, sizeof (int));
+            value->size = sizeof (int);
+        }
+        result = AK_table_writer_append(writer, row);
+    }
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    return result;
+}
+
+/**
+ * @brief  Function that checks the result of a merge join test. Every even id below n must be found twice, with the name
+ *         "name<id>" and the value 3 * id.
+ * @param tblName join table name
+ * @param n number of rows of the joined tables
+ * @param ordered 1 if the rows must be ordered by id
+ * @return 1 if the result is correct, 0 otherwise
+ */
+static int AK_merge_join_test_check(char *tblName, int n, int ordered) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    AK_sort_value view[MAX_ATTRIBUTES];
+    struct list_node *row;
+    int *seen = (int *) AK_calloc(n, sizeof (int));
+    char name[MAX_VARCHAR_LENGTH];
+    int rows = 0, errors = 0, previous = -1, id, id2, val, i;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        AK_merge_join_view(row, view, 4);
+        memcpy(&id, view[0].data, sizeof (int));
+        memcpy(&id2, view[2].data, sizeof (int));
+        memcpy(&val, view[3].data, sizeof (int));
+        sprintf(name, "name%d", id);
+        if (id < 0 || id >= n || id % 2 != 0 || id2 != id || val != 3 * id || strcmp(view[1].data, name) != 0
+                || (ordered && id < previous))
+            errors++;
+        else
+            seen[id]++;
+        previous = id;
+        rows++;
+    }
+    AK_table_cursor_close(cursor);
+
+    for (i = 0; i < n; i += 2)
+        if (seen[i] != 2)
+            errors++;
+    AK_free(seen);
+    if (errors > 0 || rows != n)
+        printf("AK_merge_join_test: %s has %d rows, %d of them wrong or missing\n", tblName, rows, errors);
+    return errors == 0 && rows == n;
+}
+
+/**
+ * @brief  Function for testing the sort-merge join. A table of n scrambled ids is joined with a table that has two rows for
+ *         every even id, first with the inputs sorted by the join, then on sorted copies of them, and compared with the hash join.
+ * @return TestResult
+ */
+TestResult AK_merge_join_test() {
+    AK_PRO;
+    char *left = "merge_join_left", *right = "merge_join_right";
+    char *left_sorted = "merge_join_left_sorted", *right_sorted = "merge_join_right_sorted";
+    char *dst[3] = { "merge_join_unsorted", "merge_join_sorted", "merge_join_hash" };
+    struct list_node *ordering = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    char name[MAX_ATT_NAME];
+    double start, ms[3];
+    int n = 10000, key = 0, success = 0, failed = 0, i;
+
+    printf("\n********** MERGE JOIN TEST **********\n\n");
+    AK_Init_L3(&ordering);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), ordering);
+
+    if (AK_merge_join_test_table(left, "name", TYPE_VARCHAR, n, 0) == EXIT_ERROR
+            || AK_merge_join_test_table(right, "value", TYPE_INT, n, 1) == EXIT_ERROR
+            || AK_sort_segment(left, left_sorted, ordering) == EXIT_ERROR
+            || AK_sort_segment(right, right_sorted, ordering) == EXIT_ERROR) {
+        printf("AK_merge_join_test: Cannot create tables with %d rows.\n", n);
+        AK_DeleteAll_L3(&ordering);
+        AK_free(ordering);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    for (i = 0; i < 3; i++) {
+        AK_create_theta_join_header(left, right, dst[i]);
+        start = TEST_time_ms();
+        if (i == 0)
+            AK_merge_join(left, right, dst[i], 1, &key, &key, 0, 0);
+        else if (i == 1)
+            AK_merge_join(left_sorted, right_sorted, dst[i], 1, &key, &key, 0, 1);
+        else
+            AK_hash_join(left, right, dst[i], 1, &key, &key, 0, HASH_JOIN_MEMORY * 1024);
+        ms[i] = TEST_time_ms() - start;
+        AK_merge_join_test_check(dst[i], n, i < 2) ? success++ : failed++;
+        AK_delete_segment(dst[i], SEGMENT_TYPE_TABLE);
+    }
+
+    for (i = 1; i <= 2; i++) {
+        snprintf(name, MAX_ATT_NAME, "%s_merge_join_%d", dst[0], i);
+        if (AK_num_attr(name) > 0) {
+            printf("AK_merge_join_test: sorted input %s was not deleted\n", name);
+            failed++;
+        }
+    }
+
+    printf("\nJoin of %d rows with %d rows on id (ms)\n", n, n);
+    printf("%28s %28s %12s\n", "merge join, sorting inputs", "merge join, sorted inputs", "hash join");
+    printf("%28.0f %28.0f %12.0f\n", ms[0], ms[1], ms[2]);
+
+    AK_delete_segment(left, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(right, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(left_sorted, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(right_sorted, SEGMENT_TYPE_TABLE);
+    AK_DeleteAll_L3(&ordering);
+    AK_free(ordering);
+    AK_EPI;
+    return TEST_result(success, failed);
+}
@@ -0,0 +1,52 @@
+/**
+@file merge_join.h Header file that provides functions and defines for the sort-merge join operator
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef MERGE_JOIN
+#define MERGE_JOIN
+
+#include "../auxi/test.h"
+#include "../auxi/configuration.h"
+#include "../file/table.h"
+#include "../file/filesort.h"
+#include "../file/fileio.h"
+#include "../auxi/mempro.h"
+#include "../sql/drop.h"
+
+/**
+ * @brief  Function that makes an equi-join of two tables with a sort-merge join. Both tables are read in the order of the
+ *         join key and rows with equal keys are matched group by group, only the rows of the second table with the current
+ *         key are kept in memory. Tables that are not sorted on the key yet are first sorted into temp segments with an
+ *         external merge sort. The join table is ordered by the key.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the join table, it must already exist
+ * @param num_keys number of key attributes
+ * @param keys1 indexes of the key attributes in the first table
+ * @param keys2 indexes of the key attributes in the second table
+ * @param natural 1 if the join table has the attributes of the first table without the keys followed by the attributes of the
+ *        second table (natural join), 0 if it has all attributes of both tables (theta join)
+ * @param sorted 1 if both tables are already sorted ascending on their keys (for example read through an index), 0 if they
+ *        have to be sorted first
+ * @return EXIT_SUCCESS, EXIT_WARNING if the key types of the two tables differ, EXIT_ERROR otherwise
+ */
+int AK_merge_join(char *srcTable1, char *srcTable2, char *dstTable, int num_keys, int *keys1, int *keys2, int natural, int sorted);
+
+TestResult AK_merge_join_test();
+
+#endif
@@ -129,7 +129,7 @@ void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_
 	    some_element = AK_First_L2(row_root);
 	    
             while (some_element != NULL) {
-                size = temp_block->tuple_dict[i].size;
+                size = AK_tuple_size(temp_block, i);
                 overflow = size + temp_block->tuple_dict[i].address;
 
                 //if isn't element in the list, and if data is correct, and size is not null
@@ -137,7 +137,7 @@ void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_
                         && (overflow < (temp_block->AK_free_space + 1)) && (overflow > -1)) {
                     
                     memset(data, '\0', MAX_VARCHAR_LENGTH);
-                    memcpy(data, temp_block->data + temp_block->tuple_dict[i].address, temp_block->tuple_dict[i].size);
+                    memcpy(data, AK_tuple_data(temp_block, i), AK_tuple_size(temp_block, i));
 
                     //if merge data is not equal
                     if (strcmp(some_element->data, data) != 0) {
@@ -157,9 +157,9 @@ void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_
             if ((not_in_list == 1) && (size != 0) && (overflow < temp_block->AK_free_space + 1) && (overflow > -1)) {
                 memset(data, '\0', MAX_VARCHAR_LENGTH);
                 //data[MAX_VARCHAR_LENGHT] = '\0';
-                memcpy(data, temp_block->data + temp_block->tuple_dict[i].address, temp_block->tuple_dict[i].size);
+                memcpy(data, AK_tuple_data(temp_block, i), AK_tuple_size(temp_block, i));
                 //insert data from second table to insert_list
-                AK_Insert_New_Element(temp_block->tuple_dict[i].type, data, new_table, temp_block->header[head].att_name, &row_root_insert);
+                AK_Insert_New_Element(AK_tuple_type(temp_block, i), data, new_table, temp_block->header[head].att_name, &row_root_insert);
             }
             not_in_list = 1;
             head++; //next header
@@ -213,7 +213,7 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, s
 
             //going through list of elements on which we merge
             while (list_elem != NULL) {
-                size = tbl1_temp_block->tuple_dict[i].size;
+                size = AK_tuple_size(tbl1_temp_block, i);
                 overflow = size + tbl1_temp_block->tuple_dict[i].address;
 
                 //if there is an element that we need, and it's correct we copy it
@@ -221,11 +221,11 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, s
                         && (overflow < (tbl1_temp_block->AK_free_space + 1)) && (overflow > -1)) {
                     memset(data, '\0', MAX_VARCHAR_LENGTH);
 
-                    memcpy(data, tbl1_temp_block->data + tbl1_temp_block->tuple_dict[i].address, tbl1_temp_block->tuple_dict[i].size);
+                    memcpy(data, AK_tuple_data(tbl1_temp_block, i), AK_tuple_size(tbl1_temp_block, i));
                     //insert element into list on which we compare
-                    AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, list_elem->data, row_root);
+                    AK_Insert_New_Element(AK_tuple_type(tbl1_temp_block, i), data, new_table, list_elem->data, row_root);
                     //insert element into list which we insert into join_table together with second table data
-                    AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, list_elem->data, row_root_insert);
+                    AK_Insert_New_Element(AK_tuple_type(tbl1_temp_block, i), data, new_table, list_elem->data, row_root_insert);
 
                     something_to_copy = 1;
                     not_in_list = 0;
@@ -238,8 +238,8 @@ void AK_copy_blocks_join(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block, s
             if ((not_in_list == 1) && (size != 0) && (overflow < tbl1_temp_block->AK_free_space + 1) && (overflow > -1)) {
                 memset(data, '\0', MAX_VARCHAR_LENGTH);
                 //data[MAX_VARCHAR_LENGHT] = '\0';
-                memcpy(data, tbl1_temp_block->data + tbl1_temp_block->tuple_dict[i].address, tbl1_temp_block->tuple_dict[i].size);
-                AK_Insert_New_Element(tbl1_temp_block->tuple_dict[i].type, data, new_table, tbl1_temp_block->header[head].att_name, row_root_insert);
+                memcpy(data, AK_tuple_data(tbl1_temp_block, i), AK_tuple_size(tbl1_temp_block, i));
+                AK_Insert_New_Element(AK_tuple_type(tbl1_temp_block, i), data, new_table, tbl1_temp_block->header[head].att_name, row_root_insert);
             }
             not_in_list = 1; //reset not_in_list
             head++; //next header
@@ -282,6 +282,27 @@ int AK_join(char *srcTable1, char * srcTable2, char * dstTable, struct list_node
         AK_create_join_block_header(startAddress1, startAddress2, dstTable, att);
 
         AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
+
+        //when every join attribute exists in both tables the join is done with a hash join
+        int num_keys = 0, keys1[MAX_ATTRIBUTES], keys2[MAX_ATTRIBUTES];
+        int result = EXIT_WARNING;
+        struct list_node *list_elem;
+
+        for (list_elem = AK_First_L2(att); list_elem != NULL && num_keys < MAX_ATTRIBUTES; list_elem = list_elem->next) {
+            keys1[num_keys] = AK_get_attr_index(srcTable1, list_elem->data);
+            keys2[num_keys] = AK_get_attr_index(srcTable2, list_elem->data);
+            if (keys1[num_keys] < 0 || keys2[num_keys] < 0)
+                break;
+            num_keys++;
+        }
+        if (list_elem == NULL && num_keys > 0)
+            result = AK_hash_join(srcTable1, srcTable2, dstTable, num_keys, keys1, keys2, 1, HASH_JOIN_MEMORY * 1024);
+        if (result != EXIT_WARNING) {
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return result;
+        }
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_join: start copying data\n");
 
         AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
@@ -44,7 +44,7 @@ int AK_product(char *srcTable1, char *srcTable2, char *dstTable)
 
 		register int i, j, k, m, n, o, u;
 
-		int address, type, size;
+		int type, size;
 
 		// will be needed later as a place to hold cell data
 		char celldata[MAX_VARCHAR_LENGTH];
@@ -193,16 +193,15 @@ void AK_product_procedure(char *srcTable1, char *srcTable2, char *dstTable, AK_h
 						for (o = 0; o < tbl2_temp_block->block->last_tuple_dict_id; o += num_att2)
 						{
 							/* now we just have to copy cell data from one and from another row */
-							int cellid, celltype, celladdress, cellsize;
+							int cellid, celltype, cellsize;
 							/* first table first */
 							for (u = 0; u < num_att1; u++)
 							{
 								cellid = k + u;
-								celltype = tbl1_temp_block->block->tuple_dict[cellid].type;
-								celladdress = tbl1_temp_block->block->tuple_dict[cellid].address;
-								cellsize = tbl1_temp_block->block->tuple_dict[cellid].size;
+								celltype = AK_tuple_type(tbl1_temp_block->block, cellid);
+								cellsize = AK_tuple_size(tbl1_temp_block->block, cellid);
 								memset(celldata, '\0', MAX_VARCHAR_LENGTH);
-								memcpy(celldata, &(tbl1_temp_block->block->data[celladdress]), cellsize);
+								memcpy(celldata, AK_tuple_data(tbl1_temp_block->block, cellid), cellsize);
 								if (celltype == TYPE_VARCHAR)
 								{
 									celldata[cellsize] = '\0';
@@ -216,11 +215,10 @@ void AK_product_procedure(char *srcTable1, char *srcTable2, char *dstTable, AK_h
 							for (u = 0; u < num_att2; u++)
 							{
 								cellid = o + u;
-								celltype = tbl2_temp_block->block->tuple_dict[cellid].type;
-								celladdress = tbl2_temp_block->block->tuple_dict[cellid].address;
-								cellsize = tbl2_temp_block->block->tuple_dict[cellid].size;
+								celltype = AK_tuple_type(tbl2_temp_block->block, cellid);
+								cellsize = AK_tuple_size(tbl2_temp_block->block, cellid);
 								memset(celldata, '\0', MAX_VARCHAR_LENGTH);
-								memcpy(celldata, &(tbl2_temp_block->block->data[celladdress]), cellsize);
+								memcpy(celldata, AK_tuple_data(tbl2_temp_block->block, cellid), cellsize);
 								if (celltype == TYPE_VARCHAR)
 								{
 									celldata[cellsize] = '\0';
@@ -230,20 +230,20 @@ void AK_copy_block_projection(AK_block *old_block, struct list_node *att, char *
 	    list_elem = (struct list_node *) AK_First_L2(att);
 
             while (list_elem != NULL) {
-                size = old_block->tuple_dict[i].size;
+                size = AK_tuple_size(old_block, i);
 
                 //used to check if the data is correct
-                int overflow = old_block->tuple_dict[i].size + old_block->tuple_dict[i].address;
+                int overflow = AK_tuple_size(old_block, i) + old_block->tuple_dict[i].address;
                 
                 //if the data is what we need, if the size is not null, and data is correct
                 if ((strcmp(list_elem->data, old_block->header[head].att_name) == 0) && (size != 0)
                         && (overflow < old_block->AK_free_space + 1) && (overflow > -1)) {
                     
                     memset(data, 0, MAX_VARCHAR_LENGTH);
-                    memcpy(data, old_block->data + old_block->tuple_dict[i].address, old_block->tuple_dict[i].size); //copy data
+                    memcpy(data, AK_tuple_data(old_block, i), AK_tuple_size(old_block, i)); //copy data
                    
                     //insert element to list to be inserted into new table
-                    AK_Insert_New_Element(old_block->tuple_dict[i].type, data, dstTable, list_elem->data, row_root); //ForUpdate 0
+                    AK_Insert_New_Element(AK_tuple_type(old_block, i), data, dstTable, list_elem->data, row_root); //ForUpdate 0
                     something_to_copy = 1;
 
                 
@@ -251,7 +251,7 @@ void AK_copy_block_projection(AK_block *old_block, struct list_node *att, char *
                         && (overflow < old_block->AK_free_space + 1) && (overflow > -1)){
 
                             memset(first->value, 0, MAX_VARCHAR_LENGTH);
-                            memcpy(first->value, old_block->data + old_block->tuple_dict[i].address, old_block->tuple_dict[i].size);
+                            memcpy(first->value, AK_tuple_data(old_block, i), AK_tuple_size(old_block, i));
 
                             char * exp = (char *) malloc(1 + strlen(list_elem->data));
                             strcpy(exp,list_elem->data);
@@ -261,18 +261,18 @@ void AK_copy_block_projection(AK_block *old_block, struct list_node *att, char *
                             first->type = old_block->header[head].type;
                             int cached_head = head;
                             int j=i;
-                            int size2 = old_block->tuple_dict[j].size;
+                            int size2 = AK_tuple_size(old_block, j);
                             int positionFirst = strstr(list_elem->data,old_block->header[head].att_name) - list_elem->data;                          
                             
                             //used to check if the data is correct
                             
-                            int overflow2 = old_block->tuple_dict[j].size + old_block->tuple_dict[j].address;
+                            int overflow2 = AK_tuple_size(old_block, j) + old_block->tuple_dict[j].address;
                             while(strcmp(old_block->header[cached_head].att_name,"")!=0){
                                 if((strstr(exp,old_block->header[cached_head].att_name)!=NULL)&& (size2 != 0)
                                 && (overflow2 < old_block->AK_free_space + 1) && (overflow2 > -1)){
                         
                                 memset(second->value, 0, MAX_VARCHAR_LENGTH);
-                                memcpy(second->value, old_block->data + old_block->tuple_dict[j].address, old_block->tuple_dict[j].size);
+                                memcpy(second->value, AK_tuple_data(old_block, j), AK_tuple_size(old_block, j));
                                 second->type = old_block->header[cached_head].type;
                                 int positionSecond = strstr(list_elem->data,old_block->header[cached_head].att_name) - list_elem->data;
                                
@@ -491,6 +491,341 @@ int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct
     AK_EPI;
 }
 
+/**
+ * @struct AK_projection_column
+ * @brief Structure that contains an attribute of a projection: an input attribute, or an arithmetic operation on two
+ *        input attributes
+ */
+typedef struct {
+    /// input attribute, the first operand of an operation
+    int first;
+    /// second operand, -1 if the attribute is copied
+    int second;
+    /// 1 if the second operand is written first in the expression
+    int swapped;
+    char op;
+    int type;
+} AK_projection_column;
+
+/**
+ * @struct AK_projection_state
+ * @brief Structure that contains the state of a projection operator
+ */
+typedef struct {
+    AK_projection_column columns[MAX_ATTRIBUTES];
+    /// values of the attributes computed by operations
+    char values[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+    /// batch of the input and the operands of an operation on it
+    AK_batch *batch;
+    double x[AK_BATCH_SIZE];
+    double y[AK_BATCH_SIZE];
+} AK_projection_state;
+
+/**
+ * @brief  Function that reads a numeric value as a double
+ * @param type type of the value
+ * @param data value
+ * @return value
+ */
+static double AK_projection_number(int type, char *data) {
+    int i;
+    float f;
+    double d;
+
+    switch (type) {
+        case TYPE_INT:
+            memcpy(&i, data, sizeof (int));
+            return i;
+        case TYPE_FLOAT:
+            memcpy(&f, data, sizeof (float));
+            return f;
+        case TYPE_NUMBER:
+            memcpy(&d, data, sizeof (double));
+            return d;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief  Function that computes an arithmetic operation of a projection on a row of its input, in the type
+ *         AK_determine_header_type gave the attribute
+ * @param column attribute of the projection
+ * @param type types of the values of the row
+ * @param size sizes of the values
+ * @param data values
+ * @param value buffer of MAX_VARCHAR_LENGTH bytes the result is written to
+ * @return size of the result
+ */
+static int AK_projection_compute(AK_projection_column *column, int *type, int *size, char **data, char *value) {
+    int a = column->swapped ? column->second : column->first, b = column->swapped ? column->first : column->second;
+    double x, y, d;
+    float f;
+    int i, j, r;
+
+    if (column->type == TYPE_VARCHAR) {
+        //text operands are only joined
+        i = (type[a] == TYPE_VARCHAR) ? size[a] : 0;
+        j = (type[b] == TYPE_VARCHAR && column->op == '+') ? size[b] : 0;
+        if (i + j >= MAX_VARCHAR_LENGTH)
+            j = MAX_VARCHAR_LENGTH - 1 - i;
+        memcpy(value, data[a], i);
+        memcpy(value + i, data[b], j);
+        value[i + j] = '\0';
+        return i + j;
+    }
+    if (column->type == TYPE_INT) {
+        i = (int) AK_projection_number(type[a], data[a]);
+        j = (int) AK_projection_number(type[b], data[b]);
+        r = (column->op == '+') ? i + j : (column->op == '-') ? i - j : (column->op == '*') ? i * j
+            : (j == 0) ? 0 : (column->op == '/') ? i / j : i % j;
+        memcpy(value, &r, sizeof (int));
+        return sizeof (int);
+    }
+    x = AK_projection_number(type[a], data[a]);
+    y = AK_projection_number(type[b], data[b]);
+    d = (column->op == '+') ? x + y : (column->op == '-') ? x - y : (column->op == '*') ? x * y : (y == 0) ? 0 : x / y;
+    if (column->type == TYPE_FLOAT) {
+        f = (float) d;
+        memcpy(value, &f, sizeof (float));
+        return sizeof (float);
+    }
+    memcpy(value, &d, sizeof (double));
+    return sizeof (double);
+}
+
+static int AK_projection_open(AK_iterator *iterator) {
+    return AK_iterator_open(iterator->input[0]);
+}
+
+static int AK_projection_next(AK_iterator *iterator) {
+    AK_projection_state *state = (AK_projection_state *) iterator->state;
+    AK_iterator *input = iterator->input[0];
+    AK_projection_column *column;
+    int result, i;
+
+    if ((result = AK_iterator_next(input)) != 1)
+        return result;
+    for (i = 0; i < iterator->num_attr; i++) {
+        column = &state->columns[i];
+        if (column->second < 0) {
+            iterator->type[i] = input->type[column->first];
+            iterator->size[i] = input->size[column->first];
+            iterator->data[i] = input->data[column->first];
+        } else {
+            iterator->type[i] = column->type;
+            iterator->size[i] = AK_projection_compute(column, input->type, input->size, input->data, state->values[i]);
+            iterator->data[i] = state->values[i];
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief  Function that reads an operand of an operation for every row of a batch as a double
+ * @param column column of the operand
+ * @param n number of rows
+ * @param out values of the rows
+ * @return No return value
+ */
+static void AK_projection_operand(AK_batch_column *column, int n, double *out) {
+    int r;
+
+    if (column->type == TYPE_INT) {
+        int *values = (int *) column->values;
+        for (r = 0; r < n; r++)
+            out[r] = values[r];
+    } else if (column->type == TYPE_FLOAT) {
+        float *values = (float *) column->values;
+        for (r = 0; r < n; r++)
+            out[r] = values[r];
+    } else if (column->type == TYPE_NUMBER) {
+        memcpy(out, column->values, n * sizeof (double));
+    } else {
+        memset(out, 0, n * sizeof (double));
+    }
+}
+
+/**
+ * @brief  Function that computes an arithmetic operation of a projection on every row of a batch. Numeric operations are
+ *         loops over the operand vectors; text and values of another type than their attribute are computed row by row
+ *         with AK_projection_compute.
+ * @param state projection state
+ * @param column attribute of the projection
+ * @param input batch of the input
+ * @param out column of the result
+ * @return No return value
+ */
+static void AK_projection_compute_batch(AK_projection_state *state, AK_projection_column *column, AK_batch *input,
+        AK_batch_column *out) {
+    int a = column->swapped ? column->second : column->first, b = column->swapped ? column->first : column->second;
+    int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+    char *data[MAX_ATTRIBUTES];
+    double *x = state->x, *y = state->y;
+    int n = input->num_rows, i, r;
+
+    if (column->type != TYPE_VARCHAR) {
+        AK_projection_operand(&input->column[a], n, x);
+        AK_projection_operand(&input->column[b], n, y);
+    }
+    if (column->type == TYPE_INT) {
+        int *v = (int *) out->values;
+        switch (column->op) {
+            case '+':
+                for (r = 0; r < n; r++)
+                    v[r] = (int) x[r] + (int) y[r];
+                break;
+            case '-':
+                for (r = 0; r < n; r++)
+                    v[r] = (int) x[r] - (int) y[r];
+                break;
+            case '*':
+                for (r = 0; r < n; r++)
+                    v[r] = (int) x[r] * (int) y[r];
+                break;
+            case '/':
+                for (r = 0; r < n; r++)
+                    v[r] = ((int) y[r] == 0) ? 0 : (int) x[r] / (int) y[r];
+                break;
+            default:
+                for (r = 0; r < n; r++)
+                    v[r] = ((int) y[r] == 0) ? 0 : (int) x[r] % (int) y[r];
+        }
+    } else if (column->type == TYPE_FLOAT || column->type == TYPE_NUMBER) {
+        switch (column->op) {
+            case '+':
+                for (r = 0; r < n; r++)
+                    x[r] = x[r] + y[r];
+                break;
+            case '-':
+                for (r = 0; r < n; r++)
+                    x[r] = x[r] - y[r];
+                break;
+            case '*':
+                for (r = 0; r < n; r++)
+                    x[r] = x[r] * y[r];
+                break;
+            default:
+                for (r = 0; r < n; r++)
+                    x[r] = (y[r] == 0) ? 0 : x[r] / y[r];
+        }
+        if (column->type == TYPE_FLOAT) {
+            float *v = (float *) out->values;
+            for (r = 0; r < n; r++)
+                v[r] = (float) x[r];
+        } else
+            memcpy(out->values, x, n * sizeof (double));
+    }
+    for (r = 0; r < n; r++) {
+        out->size[r] = out->width;
+        out->value_type[r] = column->type;
+    }
+
+    for (i = 0; i < input->num_sel; i++) {
+        r = input->sel[i];
+        if (column->type == TYPE_VARCHAR || input->column[a].value_type[r] != input->column[a].type
+                || input->column[b].value_type[r] != input->column[b].type) {
+            AK_batch_row(input, r, type, size, data);
+            out->size[r] = AK_projection_compute(column, type, size, data, out->values + r * out->width);
+        }
+    }
+}
+
+static int AK_projection_next_batch(AK_iterator *iterator, AK_batch *batch) {
+    AK_projection_state *state = (AK_projection_state *) iterator->state;
+    AK_projection_column *column;
+    AK_batch *input = state->batch;
+    int result, i;
+
+    if ((result = AK_iterator_next_batch(iterator->input[0], input)) <= 0)
+        return result;
+    AK_batch_reset(batch);
+    batch->num_rows = input->num_rows;
+    batch->num_sel = input->num_sel;
+    memcpy(batch->sel, input->sel, input->num_sel * sizeof (int));
+    for (i = 0; i < iterator->num_attr; i++) {
+        column = &state->columns[i];
+        //copied attributes show the column of the input batch
+        if (column->second < 0)
+            AK_batch_share_column(batch, i, input, column->first);
+        else
+            AK_projection_compute_batch(state, column, input, &batch->column[i]);
+    }
+    return batch->num_sel;
+}
+
+static void AK_projection_free(void *data) {
+    AK_projection_state *state = (AK_projection_state *) data;
+
+    AK_batch_free(state->batch);
+    AK_free(state);
+}
+
+static void AK_projection_close(AK_iterator *iterator) {
+    AK_iterator_close(iterator->input[0]);
+}
+
+AK_iterator *AK_projection_iterator(AK_iterator *input, struct list_node *att) {
+    AK_projection_state *state;
+    AK_projection_column *column;
+    AK_iterator *iterator;
+    AK_header *header;
+    struct list_node *el;
+    char exp[MAX_VARCHAR_LENGTH];
+    int num_out = 0, h, c;
+    AK_PRO;
+
+    if (input == NULL) {
+        AK_EPI;
+        return NULL;
+    }
+    iterator = AK_iterator_new(0, NULL);
+    state = (AK_projection_state *) AK_calloc(1, sizeof (AK_projection_state));
+
+    //attributes come in the order of the input header, as AK_create_block_header puts them; an operation goes where its
+    //first operand in the header is
+    for (h = 0; h < input->num_attr; h++) {
+        for (el = AK_First_L2(att); el != NULL && num_out < MAX_ATTRIBUTES; el = AK_Next_L2(el)) {
+            column = &state->columns[num_out];
+            if (strcmp(el->data, input->header[h].att_name) == 0) {
+                column->first = h;
+                column->second = -1;
+                memcpy(&iterator->header[num_out++], &input->header[h], sizeof (AK_header));
+                continue;
+            }
+            if (strstr(el->data, input->header[h].att_name) == NULL)
+                continue;
+            strncpy(exp, el->data, MAX_VARCHAR_LENGTH - 1);
+            exp[MAX_VARCHAR_LENGTH - 1] = '\0';
+            AK_remove_substring(exp, input->header[h].att_name);
+            for (c = h; c < input->num_attr && strstr(exp, input->header[c].att_name) == NULL; c++)
+                ;
+            if (c == input->num_attr || strpbrk(el->data, "+-/%*") == NULL)
+                continue;
+            column->first = h;
+            column->second = c;
+            column->swapped = strstr(el->data, input->header[c].att_name) < strstr(el->data, input->header[h].att_name);
+            column->op = AK_get_operator(el->data)[0];
+            column->type = AK_determine_header_type(input->header[h].type, input->header[c].type);
+            header = (AK_header *) AK_create_header(el->data, column->type, FREE_INT, FREE_CHAR, FREE_CHAR);
+            memcpy(&iterator->header[num_out++], header, sizeof (AK_header));
+            AK_free(header);
+        }
+    }
+
+    iterator->num_attr = num_out;
+    state->batch = AK_iterator_batch(input);
+    iterator->state = state;
+    iterator->free_state = AK_projection_free;
+    iterator->input[0] = input;
+    iterator->open = AK_projection_open;
+    iterator->next = AK_projection_next;
+    iterator->next_batch = AK_projection_next_batch;
+    iterator->close = AK_projection_close;
+    AK_EPI;
+    return iterator;
+}
+
 /**
  * @author Dino Laktašić, rewritten and optimized by Irena Ilišević to support ILIKE operator and perform usual projection 
  * @brief  Function for projection operation testing, tests usual projection functionality, projection when it is given aritmetic operation or expresson
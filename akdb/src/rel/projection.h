@@ -25,6 +25,7 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "iterator.h"
 
  struct AK_operand {
 	char value[MAX_VARCHAR_LENGTH];
@@ -127,6 +128,16 @@ char *AK_perform_operation(char *op,struct AK_operand *firstOperand, struct AK_o
  */
 int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct list_node *expr);
 
+/**
+ * @brief  Function that returns the given attributes of the rows of an operator. Attributes are resolved when the plan is
+ *         made and come in the order of the input header, as in AK_projection; an attribute like "weight+year" is an
+ *         arithmetic operation on two input attributes.
+ * @param input input operator, freed with the projection
+ * @param att list of attributes
+ * @return operator, NULL if input is NULL
+ */
+AK_iterator *AK_projection_iterator(AK_iterator *input, struct list_node *att);
+
 
 /**
  * @author Dino Laktašić, rewritten and optimized by Irena Ilišević to support ILIKE operator and perform usual projection 
@@ -18,9 +18,390 @@
  17 */
 
 #include "selection.h"
+#include "../file/idx/btree.h"
+#include "../file/idx/hash.h"
+#include "../file/idx/bitmap.h"
 
 
 
+/**
+ * @brief  Function that gives the size of the value of a constant of a compiled expression, which keeps every constant
+ *         in a buffer of MAX_VARCHAR_LENGTH bytes
+ * @param constant constant instruction
+ * @return size of the value
+ */
+static int AK_selection_constant_size(AK_expression_instruction *constant) {
+	switch (constant->type) {
+		case TYPE_INT:
+			return sizeof (int);
+		case TYPE_NUMBER:
+			return sizeof (double);
+		default:
+			return strnlen(constant->data, constant->size);
+	}
+}
+
+/**
+ * @brief  Function that reads the bounds of an attribute from a conjunct of a compiled expression: a comparison of
+ *         the attribute with a constant of its type or the attribute BETWEEN two such constants. Only types the
+ *         compiled expression compares in the order of the encoded values are taken.
+ * @param compiled compiled expression
+ * @param i index of the comparison instruction
+ * @param t_header header of the table
+ * @param range set to the bounds of the attribute
+ * @return index of the attribute, EXIT_ERROR if the instruction is not such a conjunct
+ */
+static int AK_selection_conjunct(AK_compiled_expression *compiled, int i, AK_header *t_header, AK_btree_range *range) {
+	AK_expression_instruction *op = compiled->instructions + i, *a, *b, *c;
+	unsigned char value[AK_BTREE_MAX_VALUE];
+	int column, comparison, length, type;
+
+	AK_btree_range_init(range);
+	if (op->opcode == AK_EXPR_COMPARE && i >= 2) {
+		a = op - 2;
+		b = op - 1;
+		comparison = op->comparison;
+		//a constant on the left turns the comparison around
+		if (a->opcode == AK_EXPR_CONSTANT && b->opcode == AK_EXPR_ATTRIBUTE) {
+			c = a;
+			a = b;
+			b = c;
+			comparison = (comparison == AK_EXPR_LT) ? AK_EXPR_GT : (comparison == AK_EXPR_GT) ? AK_EXPR_LT
+				: (comparison == AK_EXPR_LE) ? AK_EXPR_GE : (comparison == AK_EXPR_GE) ? AK_EXPR_LE : comparison;
+		}
+		if (a->opcode != AK_EXPR_ATTRIBUTE || b->opcode != AK_EXPR_CONSTANT || comparison == AK_EXPR_NE)
+			return EXIT_ERROR;
+		column = a->column;
+		type = t_header[column].type;
+		if (b->type != type || (type != TYPE_INT && type != TYPE_NUMBER && type != TYPE_VARCHAR)
+				|| (length = AK_btree_encode_value(type, b->data, AK_selection_constant_size(b), value)) == EXIT_ERROR)
+			return EXIT_ERROR;
+		if (comparison == AK_EXPR_EQ || comparison == AK_EXPR_GT || comparison == AK_EXPR_GE)
+			AK_btree_range_lower(range, value, length, comparison != AK_EXPR_GT);
+		if (comparison == AK_EXPR_EQ || comparison == AK_EXPR_LT || comparison == AK_EXPR_LE)
+			AK_btree_range_upper(range, value, length, comparison != AK_EXPR_LT);
+		return column;
+	}
+	if (op->opcode == AK_EXPR_BETWEEN && i >= 3) {
+		c = op - 3;
+		a = op - 2;
+		b = op - 1;
+		if (c->opcode != AK_EXPR_ATTRIBUTE || a->opcode != AK_EXPR_CONSTANT || b->opcode != AK_EXPR_CONSTANT)
+			return EXIT_ERROR;
+		column = c->column;
+		type = t_header[column].type;
+		if (a->type != type || b->type != type || (type != TYPE_INT && type != TYPE_NUMBER && type != TYPE_VARCHAR))
+			return EXIT_ERROR;
+		if ((length = AK_btree_encode_value(type, a->data, AK_selection_constant_size(a), value)) == EXIT_ERROR)
+			return EXIT_ERROR;
+		AK_btree_range_lower(range, value, length, 1);
+		if ((length = AK_btree_encode_value(type, b->data, AK_selection_constant_size(b), value)) == EXIT_ERROR)
+			return EXIT_ERROR;
+		AK_btree_range_upper(range, value, length, 1);
+		return column;
+	}
+	return EXIT_ERROR;
+}
+
+/**
+ * @brief  Function that chooses a B+tree index for a selection. The expression must be a conjunction; of the
+ *         indexed attributes it bounds, one compared for equality is taken first, then one bounded from both sides.
+ * @param compiled compiled expression
+ * @param srcTable source table name
+ * @param t_header header of the table
+ * @param num_attr number of attributes
+ * @param indexName buffer of MAX_VARCHAR_LENGTH characters the index name is copied to
+ * @param range set to the range of the indexed attribute
+ * @return 3 if the attribute is compared for equality, 2 if it is bounded from both sides, 1 if from one side,
+ *         0 if no index can be used
+ */
+static int AK_selection_index_range(AK_compiled_expression *compiled, char *srcTable, AK_header *t_header, int num_attr,
+		char *indexName, AK_btree_range *range) {
+	AK_btree_range ranges[MAX_ATTRIBUTES], conjunct;
+	char name[MAX_VARCHAR_LENGTH];
+	int bounded[MAX_ATTRIBUTES], i, column, score, best_score = 0;
+
+	for (i = 0; i < compiled->num_instructions; i++)
+		if (compiled->instructions[i].opcode == AK_EXPR_OR)
+			return 0;
+	for (i = 0; i < num_attr; i++) {
+		AK_btree_range_init(&ranges[i]);
+		bounded[i] = 0;
+	}
+	for (i = 0; i < compiled->num_instructions; i++) {
+		if ((column = AK_selection_conjunct(compiled, i, t_header, &conjunct)) == EXIT_ERROR)
+			continue;
+		if (conjunct.lower_length >= 0)
+			AK_btree_range_lower(&ranges[column], conjunct.lower, conjunct.lower_length, conjunct.lower_inclusive);
+		if (conjunct.upper_length >= 0)
+			AK_btree_range_upper(&ranges[column], conjunct.upper, conjunct.upper_length, conjunct.upper_inclusive);
+		bounded[column] = 1;
+	}
+	for (column = 0; column < num_attr; column++) {
+		if (!bounded[column])
+			continue;
+		score = (ranges[column].lower_length >= 0) + (ranges[column].upper_length >= 0);
+		if (score == 2 && AK_btree_compare(ranges[column].lower, ranges[column].lower_length, ranges[column].upper,
+				ranges[column].upper_length) == 0)
+			score = 3;
+		if (score > best_score && AK_btree_find_index(srcTable, column, name) == EXIT_SUCCESS) {
+			best_score = score;
+			strcpy(indexName, name);
+			*range = ranges[column];
+		}
+	}
+	return best_score;
+}
+
+/**
+ * @brief  Function that chooses a hash index for a selection. The expression must be a conjunction that compares
+ *         every key attribute of the index with a constant of its type for equality.
+ * @param compiled compiled expression
+ * @param srcTable source table name
+ * @param t_header header of the table
+ * @param indexName buffer of MAX_VARCHAR_LENGTH characters the index name is copied to
+ * @param key_constants set to the constants the key attributes are compared with, in the order of the keys
+ * @return number of keys, EXIT_WARNING if no hash index can be used
+ */
+static int AK_selection_hash_index(AK_compiled_expression *compiled, char *srcTable, AK_header *t_header, char *indexName,
+		AK_expression_instruction **key_constants) {
+	AK_expression_instruction *op, *a, *b, *c, *constants[MAX_ATTRIBUTES];
+	int usable[MAX_ATTRIBUTES], keys[MAX_ATTRIBUTES], num_keys, i, k;
+
+	memset(usable, 0, sizeof (usable));
+	for (i = 0; i < compiled->num_instructions; i++) {
+		op = compiled->instructions + i;
+		if (op->opcode == AK_EXPR_OR)
+			return EXIT_WARNING;
+		if (op->opcode != AK_EXPR_COMPARE || op->comparison != AK_EXPR_EQ || i < 2)
+			continue;
+		a = op - 2;
+		b = op - 1;
+		if (a->opcode == AK_EXPR_CONSTANT && b->opcode == AK_EXPR_ATTRIBUTE) {
+			c = a;
+			a = b;
+			b = c;
+		}
+		//FLOAT values are compared by their first bytes only, so equal values need not be equal in the index
+		if (a->opcode != AK_EXPR_ATTRIBUTE || b->opcode != AK_EXPR_CONSTANT || a->column >= MAX_ATTRIBUTES
+				|| b->type != t_header[a->column].type || (b->type != TYPE_INT && b->type != TYPE_NUMBER && b->type != TYPE_VARCHAR))
+			continue;
+		usable[a->column] = 1;
+		constants[a->column] = b;
+	}
+	if ((num_keys = AK_hash_find_index(srcTable, usable, indexName, keys)) <= 0)
+		return EXIT_WARNING;
+	for (k = 0; k < num_keys; k++)
+		key_constants[k] = constants[keys[k]];
+	return num_keys;
+}
+
+/**
+ * @brief  Function that looks the rows of a selection up in the hash index AK_selection_hash_index chooses
+ * @param compiled compiled expression
+ * @param srcTable source table name
+ * @param t_header header of the table
+ * @param rows set to the addresses of the rows the index returned
+ * @return number of rows, EXIT_WARNING if no hash index can be used
+ */
+static int AK_selection_hash_rows(AK_compiled_expression *compiled, char *srcTable, AK_header *t_header, struct_add **rows) {
+	AK_expression_instruction *constants[MAX_ATTRIBUTES];
+	char indexName[MAX_VARCHAR_LENGTH], *data[MAX_ATTRIBUTES];
+	int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES], num_keys, i, k;
+
+	if ((num_keys = AK_selection_hash_index(compiled, srcTable, t_header, indexName, constants)) == EXIT_WARNING)
+		return EXIT_WARNING;
+	for (k = 0; k < num_keys; k++) {
+		type[k] = constants[k]->type;
+		size[k] = AK_selection_constant_size(constants[k]);
+		data[k] = constants[k]->data;
+	}
+	if ((i = AK_hash_probe(indexName, type, size, data, rows)) == EXIT_ERROR)
+		return EXIT_WARNING;
+	return i;
+}
+
+/**
+ * @brief  Function that reads the rows of a selection from the bitmap indexes of the table. Comparisons of indexed
+ *         attributes are answered from the bitmaps of their values and combined as the expression says.
+ * @param compiled compiled expression
+ * @param srcTable source table name
+ * @param t_header header of the table
+ * @param rows set to the addresses of the rows the indexes returned
+ * @return number of rows, EXIT_WARNING if the bitmap indexes do not narrow the rows down
+ */
+static int AK_selection_bitmap_rows(AK_compiled_expression *compiled, char *srcTable, AK_header *t_header, struct_add **rows) {
+	AK_bitmap *bitmap = AK_bitmap_evaluate(srcTable, compiled, t_header, NULL);
+	int count;
+
+	if (bitmap == NULL)
+		return EXIT_WARNING;
+	count = AK_bitmap_rows(bitmap, rows);
+	AK_bitmap_free(bitmap);
+	return count;
+}
+
+/**
+ * @brief  Function that reads the rows of a selection by a path AK_selection_access_path chose
+ * @param path access path
+ * @param compiled compiled expression
+ * @param srcTable source table name
+ * @param t_header header of the table
+ * @param num_attr number of attributes
+ * @param rows set to the addresses of the rows the index returned
+ * @return number of rows, EXIT_WARNING if the table has to be scanned
+ */
+static int AK_selection_path_rows(AK_access_path *path, AK_compiled_expression *compiled, char *srcTable, AK_header *t_header,
+		int num_attr, struct_add **rows) {
+	char indexName[MAX_VARCHAR_LENGTH];
+	AK_btree_range range;
+	int num_rows;
+
+	switch (path->method) {
+		case AK_ACCESS_HASH:
+			return AK_selection_hash_rows(compiled, srcTable, t_header, rows);
+		case AK_ACCESS_BITMAP:
+			return AK_selection_bitmap_rows(compiled, srcTable, t_header, rows);
+		case AK_ACCESS_BTREE:
+			if (AK_selection_index_range(compiled, srcTable, t_header, num_attr, indexName, &range) == 0
+					|| (num_rows = AK_btree_search_range(indexName, &range, rows)) == EXIT_ERROR)
+				return EXIT_WARNING;
+			return num_rows;
+		default:
+			return EXIT_WARNING;
+	}
+}
+
+/**
+ * @brief  Function that chooses how the rows of a selection are read. Every index of the table that can answer the
+ *         expression is given an estimate of the rows it returns; the one returning the fewest is taken if they are
+ *         no more than AK_SELECTION_INDEX_LIMIT percent of the table, otherwise the table is scanned.
+ * @param srcTable source table name
+ * @param compiled compiled expression, NULL for a full scan
+ * @param t_header header of the table
+ * @param num_attr number of attributes
+ * @param path set to the chosen path
+ * @return AK_ACCESS_SCAN ... AK_ACCESS_BTREE
+ */
+static int AK_selection_access_path(char *srcTable, AK_compiled_expression *compiled, AK_header *t_header, int num_attr, AK_access_path *path) {
+	AK_expression_instruction *constants[MAX_ATTRIBUTES];
+	char indexName[MAX_VARCHAR_LENGTH];
+	AK_btree_range range;
+	AK_hash_meta hash_meta;
+	AK_btree_meta btree_meta;
+	AK_access_path best;
+	int num_keys, score, rows, estimate;
+	AK_PRO;
+
+	memset(path, 0, sizeof (AK_access_path));
+	path->method = AK_ACCESS_SCAN;
+	if (compiled == NULL) {
+		AK_EPI;
+		return AK_ACCESS_SCAN;
+	}
+	best.method = AK_ACCESS_SCAN;
+	best.index[0] = '\0';
+	best.estimated_rows = 0;
+
+	//an equality on a key of a hash index or a B+tree index is taken to return a tenth of the rows per key attribute,
+	//a range of a B+tree index a quarter of them if it is bounded from both sides and a third if from one
+	if ((num_keys = AK_selection_hash_index(compiled, srcTable, t_header, indexName, constants)) != EXIT_WARNING
+			&& AK_get_hash_info(indexName, &hash_meta) == EXIT_SUCCESS && hash_meta.built) {
+		for (estimate = hash_meta.num_entries; num_keys > 0 && estimate > 1; num_keys--)
+			estimate /= 10;
+		path->table_rows = hash_meta.num_entries;
+		best.method = AK_ACCESS_HASH;
+		strcpy(best.index, indexName);
+		best.estimated_rows = estimate;
+	}
+	//the bitmap indexes count the rows of the values they are asked for
+	if ((estimate = AK_bitmap_estimate(srcTable, compiled, t_header, &rows)) != EXIT_WARNING) {
+		if (rows > path->table_rows)
+			path->table_rows = rows;
+		if (best.method == AK_ACCESS_SCAN || estimate < best.estimated_rows) {
+			best.method = AK_ACCESS_BITMAP;
+			best.index[0] = '\0';
+			best.estimated_rows = estimate;
+		}
+	}
+	if ((score = AK_selection_index_range(compiled, srcTable, t_header, num_attr, indexName, &range)) > 0
+			&& AK_btree_get_meta(indexName, &btree_meta) == EXIT_SUCCESS && btree_meta.height > 0) {
+		estimate = btree_meta.num_entries / ((score == 3) ? 10 : (score == 2) ? 4 : 3);
+		if (btree_meta.num_entries > path->table_rows)
+			path->table_rows = btree_meta.num_entries;
+		if (best.method == AK_ACCESS_SCAN || estimate < best.estimated_rows) {
+			best.method = AK_ACCESS_BTREE;
+			strcpy(best.index, indexName);
+			best.estimated_rows = estimate;
+		}
+	}
+
+	path->estimated_rows = path->table_rows;
+	if (best.method != AK_ACCESS_SCAN
+			&& (long long) best.estimated_rows * 100 <= (long long) path->table_rows * AK_SELECTION_INDEX_LIMIT) {
+		path->method = best.method;
+		strcpy(path->index, best.index);
+		path->estimated_rows = best.estimated_rows;
+	}
+	AK_EPI;
+	return path->method;
+}
+
+/**
+ * @brief  Function that describes an access path in words
+ * @param srcTable source table name
+ * @param path access path
+ * @param text buffer of 3 * MAX_VARCHAR_LENGTH characters the description is written to
+ */
+static void AK_selection_describe_path(char *srcTable, AK_access_path *path, char *text) {
+	static const char *methods[] = {"full scan", "hash index probe", "bitmap index intersection", "B+tree range scan"};
+
+	if (path->index[0] != '\0')
+		snprintf(text, 3 * MAX_VARCHAR_LENGTH, "SELECTION ON %s: %s of %s, about %d of %d rows", srcTable, methods[path->method],
+				path->index, path->estimated_rows, path->table_rows);
+	else if (path->table_rows > 0)
+		snprintf(text, 3 * MAX_VARCHAR_LENGTH, "SELECTION ON %s: %s, about %d of %d rows", srcTable, methods[path->method],
+				path->estimated_rows, path->table_rows);
+	else
+		snprintf(text, 3 * MAX_VARCHAR_LENGTH, "SELECTION ON %s: %s", srcTable, methods[path->method]);
+}
+
+int AK_selection_explain(char *srcTable, struct list_node *expr, AK_access_path *path) {
+	AK_header *t_header;
+	AK_compiled_expression *compiled;
+	AK_access_path chosen;
+	char text[3 * MAX_VARCHAR_LENGTH];
+	int num_attr;
+	AK_PRO;
+
+	if ((t_header = (AK_header *) AK_get_header(srcTable)) == NULL) {
+		printf("AK_selection_explain: ERROR. Table %s does not exist.\n", srcTable);
+		AK_EPI;
+		return EXIT_ERROR;
+	}
+	num_attr = AK_num_attr(srcTable);
+	compiled = AK_compile_expression(expr, t_header, num_attr);
+	AK_selection_access_path(srcTable, compiled, t_header, num_attr, &chosen);
+	AK_selection_describe_path(srcTable, &chosen, text);
+	printf("EXPLAIN %s\n", text);
+	if (path != NULL)
+		*path = chosen;
+	AK_free_compiled_expression(compiled);
+	AK_free(t_header);
+	AK_EPI;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that compares row addresses by block and tuple, used to read the rows an index returned in block order
+ */
+static int AK_selection_compare_rows(const void *a, const void *b) {
+	const struct_add *x = a, *y = b;
+	if (x->addBlock != y->addBlock)
+		return (x->addBlock > y->addBlock) - (x->addBlock < y->addBlock);
+	return (x->indexTd > y->indexTd) - (x->indexTd < y->indexTd);
+}
+
 /**
  * @author Matija Šestak.
  * @brief  Function that which implements selection
@@ -69,39 +450,69 @@ int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
 		struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
 		AK_Init_L3(&row_root);
 		
-		int i, j, k, l, type, size, address;
-		char data[MAX_VARCHAR_LENGTH];
+		int i, j, k, l, type, size, num_rows;
+		char data[MAX_VARCHAR_LENGTH], text[3 * MAX_VARCHAR_LENGTH];
+		AK_access_path path;
+		struct_add *rows;
+		//the expression is compiled once and checked in place on the block, rows are only built for tuples that satisfy it
+		AK_compiled_expression *compiled = AK_compile_expression(expr, t_header, num_attr);
 
-		for (i = 0; src_addr->address_from[i] != 0; i++) {
+		AK_selection_access_path(srcTable, compiled, t_header, num_attr, &path);
+		AK_selection_describe_path(srcTable, &path, text);
+		AK_dbg_messg(LOW, REL_OP, "%s\n", text);
+		if ((num_rows = AK_selection_path_rows(&path, compiled, srcTable, t_header, num_attr, &rows)) != EXIT_WARNING) {
+			//rows are read in block order; entries of rows deleted or changed since they were indexed fail the checks
+			qsort(rows, num_rows, sizeof (struct_add), AK_selection_compare_rows);
+			for (i = 0; i < num_rows; i++) {
+				k = rows[i].indexTd;
+				if ((i > 0 && AK_selection_compare_rows(rows + i - 1, rows + i) == 0) || k < 0 || k + num_attr > DATA_BLOCK_SIZE)
+					continue;
+				AK_mem_block *temp = (AK_mem_block *) AK_get_block(rows[i].addBlock);
+				if (AK_tuple_size(temp->block, k) <= 0 || !AK_check_compiled_expression(compiled, temp->block, k, num_attr, NULL, 0))
+					continue;
 
-			for (j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
+				for (l = 0; l < num_attr; l++) {
+					type = AK_tuple_type(temp->block, k + l);
+					size = AK_tuple_copy(temp->block, k + l, data);
+					AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
+				}
+				AK_insert_row(row_root);
+				AK_DeleteAll_L3(&row_root);
+			}
+			AK_free(rows);
+		} else {
+			for (i = 0; src_addr->address_from[i] != 0; i++) {
 
-				AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
-				if (temp->block->last_tuple_dict_id == 0)
-					break;
-				for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
+				for (j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
 
-					if (temp->block->tuple_dict[k].type == FREE_INT)
+					AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
+					if (temp->block->last_tuple_dict_id == 0)
 						break;
+					for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
 
-					for (l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
-					}
+						if (AK_tuple_type(temp->block, k) == FREE_INT)
+							break;
 
-					if (AK_check_if_row_satisfies_expression(row_root, expr))
-						AK_insert_row(row_root);
+						if (compiled != NULL && !AK_check_compiled_expression(compiled, temp->block, k, num_attr, NULL, 0))
+							continue;
+
+						for (l = 0; l < num_attr; l++) {
+							type = AK_tuple_type(temp->block, k + l);
+							size = AK_tuple_copy(temp->block, k + l, data);
+							AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
+						}
+
+						if (compiled != NULL || AK_check_if_row_satisfies_expression(row_root, expr))
+							AK_insert_row(row_root);
 
 					
-					AK_DeleteAll_L3(&row_root);
+						AK_DeleteAll_L3(&row_root);
+					}
 				}
 			}
 		}
 
+		AK_free_compiled_expression(compiled);
 		AK_free(src_addr);
 		AK_free(t_header);
 		AK_free(row_root);
@@ -114,6 +525,407 @@ int AK_selection(char *srcTable, char *dstTable, struct list_node *expr) {
 	return EXIT_SUCCESS;
 }
 
+/**
+ * @struct AK_filter_state
+ * @brief Structure that contains the state of a filter operator
+ */
+typedef struct {
+	struct list_node *expr;
+	AK_compiled_expression *compiled;
+	/// row with attribute names for expressions the compiled form does not support
+	struct list_node *row;
+	/// operand and result stacks of an expression evaluated on whole batches, NULL if it is checked row by row
+	double *values;
+	char *results;
+} AK_filter_state;
+
+static void AK_filter_free(void *state) {
+	AK_filter_state *filter = (AK_filter_state *) state;
+
+	AK_free_compiled_expression(filter->compiled);
+	AK_free(filter->values);
+	AK_free(filter->results);
+	if (filter->row != NULL) {
+		AK_DeleteAll_L3(&filter->row);
+		AK_free(filter->row);
+	}
+	AK_free(filter);
+}
+
+static int AK_filter_open(AK_iterator *iterator) {
+	return AK_iterator_open(iterator->input[0]);
+}
+
+static int AK_filter_next(AK_iterator *iterator) {
+	AK_filter_state *state = (AK_filter_state *) iterator->state;
+	AK_iterator *input = iterator->input[0];
+	int result;
+
+	while ((result = AK_iterator_next(input)) == 1) {
+		if (state->compiled != NULL && !AK_check_compiled_values(state->compiled, input->type, input->size, input->data))
+			continue;
+		if (state->compiled == NULL) {
+			AK_iterator_row_values(input, state->row);
+			if (!AK_check_if_row_satisfies_expression(state->row, state->expr))
+				continue;
+		}
+		//the row of the input is passed on as it is
+		memcpy(iterator->type, input->type, sizeof (iterator->type));
+		memcpy(iterator->size, input->size, sizeof (iterator->size));
+		memcpy(iterator->data, input->data, sizeof (iterator->data));
+		return 1;
+	}
+	return result;
+}
+
+/**
+ * @brief  Function that tells whether a compiled expression can be evaluated on whole columns: its comparisons and BETWEENs
+ *         have numeric attributes and constants as operands
+ * @param compiled compiled expression
+ * @param header header the expression was compiled for
+ * @return 1 if it can, 0 otherwise
+ */
+static int AK_filter_vectorizable(AK_compiled_expression *compiled, AK_header *header) {
+	AK_expression_instruction *instruction;
+	int i, type;
+
+	for (i = 0; i < compiled->num_instructions; i++) {
+		instruction = &compiled->instructions[i];
+		type = (instruction->opcode == AK_EXPR_ATTRIBUTE) ? header[instruction->column].type : instruction->type;
+		if (instruction->opcode == AK_EXPR_MATCH
+				|| ((instruction->opcode == AK_EXPR_ATTRIBUTE || instruction->opcode == AK_EXPR_CONSTANT)
+					&& type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_NUMBER))
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Function that reads an operand of a vectorized expression for every row of a batch as a double. Numbers of
+ *         different types compare the same as doubles, as in AK_compare_expression_values.
+ * @param instruction AK_EXPR_ATTRIBUTE or AK_EXPR_CONSTANT instruction
+ * @param batch batch
+ * @param out values of the rows
+ * @return No return value
+ */
+static void AK_filter_operand(AK_expression_instruction *instruction, AK_batch *batch, double *out) {
+	AK_batch_column *column;
+	double constant;
+	int n = batch->num_rows, r;
+	int i;
+	float f;
+
+	if (instruction->opcode == AK_EXPR_CONSTANT) {
+		if (instruction->type == TYPE_INT) {
+			memcpy(&i, instruction->data, sizeof (int));
+			constant = i;
+		} else if (instruction->type == TYPE_FLOAT) {
+			memcpy(&f, instruction->data, sizeof (float));
+			constant = f;
+		} else
+			memcpy(&constant, instruction->data, sizeof (double));
+		for (r = 0; r < n; r++)
+			out[r] = constant;
+		return;
+	}
+	column = &batch->column[instruction->column];
+	if (column->type == TYPE_INT) {
+		int *values = (int *) column->values;
+		for (r = 0; r < n; r++)
+			out[r] = values[r];
+	} else if (column->type == TYPE_FLOAT) {
+		float *values = (float *) column->values;
+		for (r = 0; r < n; r++)
+			out[r] = values[r];
+	} else {
+		memcpy(out, column->values, n * sizeof (double));
+	}
+}
+
+/**
+ * @brief  Function that evaluates a vectorized expression on every row of a batch. The operands are read into vectors of
+ *         doubles and every comparison, BETWEEN, AND and OR is one loop over the rows.
+ * @param state filter state with the stacks of the expression
+ * @param batch batch
+ * @return No return value, the result of row r is state->results[r]
+ */
+static void AK_filter_evaluate_batch(AK_filter_state *state, AK_batch *batch) {
+	AK_expression_instruction *instruction;
+	double *a, *b, *c;
+	char *x, *y;
+	int n = batch->num_rows, num_values = 0, num_results = 0, i, r;
+
+	for (i = 0; i < state->compiled->num_instructions; i++) {
+		instruction = &state->compiled->instructions[i];
+		switch (instruction->opcode) {
+			case AK_EXPR_ATTRIBUTE:
+			case AK_EXPR_CONSTANT:
+				AK_filter_operand(instruction, batch, state->values + AK_BATCH_SIZE * num_values++);
+				break;
+			case AK_EXPR_COMPARE:
+				b = state->values + AK_BATCH_SIZE * --num_values;
+				a = state->values + AK_BATCH_SIZE * --num_values;
+				x = state->results + AK_BATCH_SIZE * num_results++;
+				switch (instruction->comparison) {
+					case AK_EXPR_EQ:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] == b[r];
+						break;
+					case AK_EXPR_NE:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] != b[r];
+						break;
+					case AK_EXPR_LT:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] < b[r];
+						break;
+					case AK_EXPR_GT:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] > b[r];
+						break;
+					case AK_EXPR_LE:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] <= b[r];
+						break;
+					default:
+						for (r = 0; r < n; r++)
+							x[r] = a[r] >= b[r];
+				}
+				break;
+			case AK_EXPR_BETWEEN:
+				b = state->values + AK_BATCH_SIZE * --num_values;
+				a = state->values + AK_BATCH_SIZE * --num_values;
+				c = state->values + AK_BATCH_SIZE * --num_values;
+				x = state->results + AK_BATCH_SIZE * num_results++;
+				for (r = 0; r < n; r++)
+					x[r] = (c[r] >= a[r]) & (c[r] <= b[r]);
+				break;
+			case AK_EXPR_AND:
+				y = state->results + AK_BATCH_SIZE * --num_results;
+				x = state->results + AK_BATCH_SIZE * (num_results - 1);
+				for (r = 0; r < n; r++)
+					x[r] &= y[r];
+				break;
+			case AK_EXPR_OR:
+				y = state->results + AK_BATCH_SIZE * --num_results;
+				x = state->results + AK_BATCH_SIZE * (num_results - 1);
+				for (r = 0; r < n; r++)
+					x[r] |= y[r];
+				break;
+		}
+	}
+}
+
+/**
+ * @brief  Function that leaves the rows of a batch that satisfy the expression of a filter in its selection vector. Rows
+ *         with a value of another type than its attribute (nulls) are checked one by one.
+ */
+static int AK_filter_next_batch(AK_iterator *iterator, AK_batch *batch) {
+	AK_filter_state *state = (AK_filter_state *) iterator->state;
+	AK_expression_instruction *instruction;
+	int type[MAX_ATTRIBUTES], size[MAX_ATTRIBUTES];
+	char *data[MAX_ATTRIBUTES];
+	int result, num_sel, i, j, r, keep;
+
+	while ((result = AK_iterator_next_batch(iterator->input[0], batch)) > 0) {
+		if (state->values != NULL)
+			AK_filter_evaluate_batch(state, batch);
+		for (i = 0, num_sel = 0; i < batch->num_sel; i++) {
+			r = batch->sel[i];
+			keep = -1;
+			if (state->values != NULL) {
+				keep = state->results[r];
+				for (j = 0; j < state->compiled->num_instructions; j++) {
+					instruction = &state->compiled->instructions[j];
+					if (instruction->opcode == AK_EXPR_ATTRIBUTE
+							&& batch->column[instruction->column].value_type[r] != batch->column[instruction->column].type)
+						keep = -1;
+				}
+			}
+			if (keep < 0) {
+				AK_batch_row(batch, r, type, size, data);
+				if (state->compiled != NULL)
+					keep = AK_check_compiled_values(state->compiled, type, size, data);
+				else {
+					memcpy(iterator->type, type, sizeof (type));
+					memcpy(iterator->size, size, sizeof (size));
+					memcpy(iterator->data, data, sizeof (data));
+					AK_iterator_row_values(iterator, state->row);
+					keep = AK_check_if_row_satisfies_expression(state->row, state->expr);
+				}
+			}
+			if (keep)
+				batch->sel[num_sel++] = r;
+		}
+		batch->num_sel = num_sel;
+		if (num_sel > 0)
+			return num_sel;
+	}
+	return result;
+}
+
+static void AK_filter_close(AK_iterator *iterator) {
+	AK_iterator_close(iterator->input[0]);
+}
+
+/**
+ * @brief  Function that returns the rows of an operator that satisfy an expression
+ * @param *input input operator, freed with the filter
+ * @param *expr list with posfix notation of the logical expression, it must stay valid while the filter is used
+ * @return operator, the input itself if expr is NULL
+ */
+AK_iterator *AK_filter_iterator(AK_iterator *input, struct list_node *expr) {
+	AK_iterator *iterator;
+	AK_filter_state *state;
+	AK_PRO;
+
+	if (input == NULL || expr == NULL) {
+		AK_EPI;
+		return input;
+	}
+	iterator = AK_iterator_new(input->num_attr, input->header);
+	state = (AK_filter_state *) AK_calloc(1, sizeof (AK_filter_state));
+	state->expr = expr;
+	state->compiled = AK_compile_expression(expr, input->header, input->num_attr);
+	if (state->compiled == NULL)
+		state->row = AK_iterator_row_list(input, expr->table);
+	else if (AK_filter_vectorizable(state->compiled, input->header)) {
+		state->values = (double *) AK_malloc(state->compiled->num_instructions * AK_BATCH_SIZE * sizeof (double));
+		state->results = (char *) AK_malloc(state->compiled->num_instructions * AK_BATCH_SIZE);
+	}
+	iterator->state = state;
+	iterator->free_state = AK_filter_free;
+	iterator->input[0] = input;
+	iterator->open = AK_filter_open;
+	iterator->next = AK_filter_next;
+	iterator->next_batch = AK_filter_next_batch;
+	iterator->close = AK_filter_close;
+	AK_EPI;
+	return iterator;
+}
+
+/**
+ * @struct AK_index_scan_state
+ * @brief Structure that contains the state of an operator reading the rows of a selection from an index
+ */
+typedef struct {
+	char table[MAX_ATT_NAME];
+	AK_compiled_expression *compiled;
+	AK_access_path path;
+	/// addresses of the rows the index returned, in block order, and the next one to read
+	struct_add *rows;
+	int num_rows;
+	int position;
+	/// values of the current row
+	char values[MAX_ATTRIBUTES][MAX_VARCHAR_LENGTH];
+} AK_index_scan_state;
+
+static void AK_index_scan_free(void *state) {
+	AK_index_scan_state *scan = (AK_index_scan_state *) state;
+
+	AK_free_compiled_expression(scan->compiled);
+	AK_free(scan->rows);
+	AK_free(scan);
+}
+
+static int AK_index_scan_open(AK_iterator *iterator) {
+	AK_index_scan_state *state = (AK_index_scan_state *) iterator->state;
+
+	state->position = 0;
+	state->num_rows = AK_selection_path_rows(&state->path, state->compiled, state->table, iterator->header, iterator->num_attr,
+			&state->rows);
+	if (state->num_rows == EXIT_WARNING) {
+		//the index went away since the plan was made
+		printf("AK_index_scan_open: ERROR. Index %s of table %s cannot be read.\n", state->path.index, state->table);
+		state->rows = NULL;
+		state->num_rows = 0;
+		return EXIT_ERROR;
+	}
+	qsort(state->rows, state->num_rows, sizeof (struct_add), AK_selection_compare_rows);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief  Function that reads the next row an index returned, the same checks as in AK_selection leave out entries of rows
+ *         deleted or changed since they were indexed
+ */
+static int AK_index_scan_next(AK_iterator *iterator) {
+	AK_index_scan_state *state = (AK_index_scan_state *) iterator->state;
+	AK_mem_block *mem_block;
+	int i, k, l, num_attr = iterator->num_attr;
+
+	while ((i = state->position++) < state->num_rows) {
+		k = state->rows[i].indexTd;
+		if ((i > 0 && AK_selection_compare_rows(state->rows + i - 1, state->rows + i) == 0) || k < 0 || k + num_attr > DATA_BLOCK_SIZE)
+			continue;
+		mem_block = (AK_mem_block *) AK_get_block(state->rows[i].addBlock);
+		if (AK_tuple_size(mem_block->block, k) <= 0 || !AK_check_compiled_expression(state->compiled, mem_block->block, k, num_attr, NULL, 0))
+			continue;
+		for (l = 0; l < num_attr; l++) {
+			iterator->type[l] = AK_tuple_type(mem_block->block, k + l);
+			iterator->size[l] = AK_tuple_copy(mem_block->block, k + l, state->values[l]);
+			iterator->data[l] = state->values[l];
+		}
+		return 1;
+	}
+	return 0;
+}
+
+static void AK_index_scan_close(AK_iterator *iterator) {
+	AK_index_scan_state *state = (AK_index_scan_state *) iterator->state;
+
+	AK_free(state->rows);
+	state->rows = NULL;
+	state->num_rows = 0;
+}
+
+/**
+ * @brief  Function that returns the rows of a table that satisfy an expression. The access path is chosen when the plan is
+ *         made, as for AK_selection: the rows an index returns are read in block order, otherwise the table is scanned
+ *         and filtered.
+ * @param *srcTable source table name
+ * @param *expr list with posfix notation of the logical expression, NULL for every row; it must stay valid while the
+ *        operator is used
+ * @return operator, NULL if the table does not exist
+ */
+AK_iterator *AK_selection_iterator(char *srcTable, struct list_node *expr) {
+	AK_iterator *iterator, *scan;
+	AK_index_scan_state *state;
+	AK_compiled_expression *compiled;
+	AK_access_path path;
+	char text[3 * MAX_VARCHAR_LENGTH];
+	AK_PRO;
+
+	if ((scan = AK_scan_iterator(srcTable)) == NULL || expr == NULL) {
+		AK_EPI;
+		return scan;
+	}
+	compiled = AK_compile_expression(expr, scan->header, scan->num_attr);
+	AK_selection_access_path(srcTable, compiled, scan->header, scan->num_attr, &path);
+	AK_selection_describe_path(srcTable, &path, text);
+	AK_dbg_messg(LOW, REL_OP, "%s\n", text);
+	if (path.method == AK_ACCESS_SCAN) {
+		AK_free_compiled_expression(compiled);
+		AK_EPI;
+		return AK_filter_iterator(scan, expr);
+	}
+
+	iterator = AK_iterator_new(scan->num_attr, scan->header);
+	AK_iterator_free(scan);
+	state = (AK_index_scan_state *) AK_calloc(1, sizeof (AK_index_scan_state));
+	strncpy(state->table, srcTable, MAX_ATT_NAME - 1);
+	state->compiled = compiled;
+	state->path = path;
+	iterator->state = state;
+	iterator->free_state = AK_index_scan_free;
+	iterator->open = AK_index_scan_open;
+	iterator->next = AK_index_scan_next;
+	iterator->close = AK_index_scan_close;
+	AK_EPI;
+	return iterator;
+}
+
+
 
 /**
  * @author Matija Šestak, updated by Dino Laktašić,Nikola Miljancic
@@ -455,7 +1267,7 @@ int AK_selection_op_rename(char *srcTable, char *dstTable, struct list_node *exp
 		struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
 		AK_Init_L3(&row_root);
 		
-		int i, j, k, l, type, size, address;
+		int i, j, k, l, type, size;
 		char data[MAX_VARCHAR_LENGTH];
 
 		for (i = 0; src_addr->address_from[i] != 0; i++) {
@@ -467,15 +1279,12 @@ int AK_selection_op_rename(char *srcTable, char *dstTable, struct list_node *exp
 					break;
 				for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
 
-					if (temp->block->tuple_dict[k].type == FREE_INT)
+					if (AK_tuple_type(temp->block, k) == FREE_INT)
 						break;
 
 					for (l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
+						type = AK_tuple_type(temp->block, k + l);
+						size = AK_tuple_copy(temp->block, k + l, data);
 						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
 					}
 
@@ -27,6 +27,49 @@
 #include "../auxi/configuration.h"
 #include "../file/files.h"
 #include "../auxi/mempro.h"
+#include "iterator.h"
+
+/**
+ * @def AK_ACCESS_SCAN
+ * @brief Constants naming the ways the rows of a selection are read: a full scan of the table, a probe of a hash
+ * index, the bitmap indexes of the table or a range of a B+tree index
+ */
+#define AK_ACCESS_SCAN 0
+#define AK_ACCESS_HASH 1
+#define AK_ACCESS_BITMAP 2
+#define AK_ACCESS_BTREE 3
+
+/**
+ * @def AK_SELECTION_INDEX_LIMIT
+ * @brief Constant declaring the percentage of the rows of a table up to which an index is read instead of the table
+ */
+#define AK_SELECTION_INDEX_LIMIT 50
+
+/**
+ * @struct AK_access_path
+ * @brief Structure that describes how the rows of a selection are read
+ */
+typedef struct {
+	/// AK_ACCESS_SCAN ... AK_ACCESS_BTREE
+	int method;
+	/// index the rows are read from, empty for a full scan and for the bitmap indexes
+	char index[MAX_VARCHAR_LENGTH];
+	/// rows of the table as its indexes count them, 0 if it has none
+	int table_rows;
+	/// rows the chosen path is expected to read
+	int estimated_rows;
+} AK_access_path;
+
+/**
+ * @brief  Function that prints the path a selection would read its rows by, like EXPLAIN. Every index of the table
+ *         that can answer the expression is given an estimate of the rows it returns; the one returning the fewest
+ *         is read if they are no more than AK_SELECTION_INDEX_LIMIT percent of the table, otherwise the table is scanned.
+ * @param *srcTable source table name
+ * @param *expr list with posfix notation of the logical expression
+ * @param *path set to the path if not NULL
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_selection_explain(char *srcTable, struct list_node *expr, AK_access_path *path);
 
 
 /**
@@ -38,6 +81,26 @@
  * @return EXIT_SUCCESS
  */
 int AK_selection(char *srcTable, char *dstTable, struct list_node *expr);
+
+/**
+ * @brief  Function that returns the rows of an operator that satisfy an expression. On batches, an expression that only
+ *         compares numeric attributes and constants is evaluated a column at a time.
+ * @param *input input operator, freed with the filter
+ * @param *expr list with posfix notation of the logical expression, it must stay valid while the filter is used
+ * @return operator, the input itself if expr is NULL
+ */
+AK_iterator *AK_filter_iterator(AK_iterator *input, struct list_node *expr);
+
+/**
+ * @brief  Function that returns the rows of a table that satisfy an expression. The access path is chosen when the plan is
+ *         made, as for AK_selection: the rows an index returns are read in block order, otherwise the table is scanned
+ *         and filtered.
+ * @param *srcTable source table name
+ * @param *expr list with posfix notation of the logical expression, NULL for every row; it must stay valid while the
+ *        operator is used
+ * @return operator, NULL if the table does not exist
+ */
+AK_iterator *AK_selection_iterator(char *srcTable, struct list_node *expr);
 TestResult AK_op_selection_test();
 TestResult AK_op_selection_test_pattern();
 
@@ -0,0 +1,609 @@
+/**
+@file set_op.c Provides functions for the hash based set operators UNION, INTERSECT and EXCEPT
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+
+#include "set_op.h"
+
+/**
+ * @brief  Function that collects the values of a cursor row into an array. The cursor reuses its row list,
+ *         so this is done once per cursor.
+ * @param row row returned by AK_table_cursor_next
+ * @param values array of at least num_attr elements
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_set_op_row_values(struct list_node *row, struct list_node **values, int num_attr) {
+    struct list_node *el = AK_First_L2(row);
+    int i;
+
+    for (i = 0; i < num_attr && el != NULL; i++, el = el->next)
+        values[i] = el;
+}
+
+/**
+ * @brief  Function that writes the size and the bytes of every value of a row into a buffer, the form rows are hashed,
+ *         compared and kept in
+ * @param values values of the row
+ * @param num_attr number of attributes
+ * @param buffer buffer of at least num_attr * (sizeof (int) + MAX_VARCHAR_LENGTH) bytes
+ * @return number of bytes written
+ */
+static int AK_set_op_serialize(struct list_node **values, int num_attr, char *buffer) {
+    int size = 0, i;
+
+    for (i = 0; i < num_attr; i++) {
+        memcpy(buffer + size, &values[i]->size, sizeof (int));
+        size += sizeof (int);
+        memcpy(buffer + size, values[i]->data, values[i]->size);
+        size += values[i]->size;
+    }
+    return size;
+}
+
+/**
+ * @brief  Function that hashes a serialized row with FNV-1a. Every partitioning level uses another seed, so the rows of a
+ *         partition are spread again when it is split.
+ * @param buffer serialized row
+ * @param size size of the serialized row
+ * @param depth partitioning level
+ * @return hash of the row
+ */
+static unsigned int AK_set_op_hash(char *buffer, int size, int depth) {
+    unsigned int hash = (2166136261u ^ (unsigned int) depth) * 16777619u;
+    int i;
+
+    for (i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char) buffer[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief  Function that allocates memory for a row from the chunks of a hash table
+ * @param table hash table
+ * @param size number of bytes
+ * @return allocated memory, NULL if the row does not fit a chunk
+ */
+static void *AK_set_op_alloc(AK_set_op_table *table, int size) {
+    AK_set_op_chunk *chunk = table->chunks;
+    void *memory;
+
+    size = (size + 7) & ~7;
+    if (size > AK_SET_OP_ARENA_CHUNK)
+        return NULL;
+    if (chunk == NULL || chunk->used + size > AK_SET_OP_ARENA_CHUNK) {
+        chunk = (AK_set_op_chunk *) AK_malloc(sizeof (AK_set_op_chunk));
+        chunk->next = table->chunks;
+        chunk->used = 0;
+        table->chunks = chunk;
+    }
+    memory = chunk->data + chunk->used;
+    chunk->used += size;
+    return memory;
+}
+
+/**
+ * @brief  Function that frees the buckets and the memory chunks of a hash table
+ * @param table hash table
+ * @return No return value
+ */
+static void AK_set_op_free_table(AK_set_op_table *table) {
+    AK_set_op_chunk *chunk, *next;
+
+    for (chunk = table->chunks; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        AK_free(chunk);
+    }
+    AK_free(table->buckets);
+}
+
+/**
+ * @brief  Function that finds a row in a hash table
+ * @param table hash table
+ * @param buffer serialized row
+ * @param size size of the serialized row
+ * @param hash hash of the row
+ * @return row, NULL if it is not in the table
+ */
+static AK_set_op_row *AK_set_op_find(AK_set_op_table *table, char *buffer, int size, unsigned int hash) {
+    AK_set_op_row *row;
+
+    for (row = table->buckets[hash & (table->num_buckets - 1)]; row != NULL; row = row->next) {
+        if (row->hash == hash && row->size == size && memcmp(row + 1, buffer, size) == 0)
+            return row;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Function that copies a row into a hash table, doubling the number of buckets when the table is full
+ * @param table hash table
+ * @param buffer serialized row
+ * @param size size of the serialized row
+ * @param hash hash of the row
+ * @return row, NULL if the row is too large
+ */
+static AK_set_op_row *AK_set_op_add(AK_set_op_table *table, char *buffer, int size, unsigned int hash) {
+    AK_set_op_row *row, *moved, *next, **buckets;
+    int i;
+
+    if ((row = (AK_set_op_row *) AK_set_op_alloc(table, sizeof (AK_set_op_row) + size)) == NULL)
+        return NULL;
+    row->hash = hash;
+    row->marked = 0;
+    row->size = size;
+    row->next_added = NULL;
+    memcpy(row + 1, buffer, size);
+
+    if (table->num_rows >= table->num_buckets) {
+        buckets = (AK_set_op_row **) AK_calloc(table->num_buckets * 2, sizeof (AK_set_op_row *));
+        for (i = 0; i < table->num_buckets; i++) {
+            for (moved = table->buckets[i]; moved != NULL; moved = next) {
+                next = moved->next;
+                moved->next = buckets[moved->hash & (table->num_buckets * 2 - 1)];
+                buckets[moved->hash & (table->num_buckets * 2 - 1)] = moved;
+            }
+        }
+        AK_free(table->buckets);
+        table->buckets = buckets;
+        table->num_buckets *= 2;
+    }
+    row->next = table->buckets[hash & (table->num_buckets - 1)];
+    table->buckets[hash & (table->num_buckets - 1)] = row;
+    if (table->last != NULL)
+        table->last->next_added = row;
+    else
+        table->first = row;
+    table->last = row;
+    table->num_rows++;
+    return row;
+}
+
+/**
+ * @brief  Function that writes a serialized row to the result table
+ * @param buffer serialized row
+ * @param types types of the attributes
+ * @param out_row row list of num_attr elements
+ * @param writer writer on the result table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_op_write(char *buffer, int *types, struct list_node *out_row, AK_table_writer *writer) {
+    struct list_node *el;
+    int c = 0;
+
+    for (el = AK_First_L2(out_row); el != NULL; el = el->next, c++) {
+        memcpy(&el->size, buffer, sizeof (int));
+        buffer += sizeof (int);
+        el->type = types[c];
+        memcpy(el->data, buffer, el->size);
+        el->data[el->size] = '\0';
+        buffer += el->size;
+    }
+    return AK_table_writer_append(writer, out_row);
+}
+
+/**
+ * @brief  Function that estimates how much memory the rows of a table take in a hash table
+ * @param tblName table name
+ * @param num_attr number of attributes
+ * @return estimated number of bytes
+ */
+static long AK_set_op_table_bytes(char *tblName, int num_attr) {
+    table_addresses *addresses = (table_addresses *) AK_get_table_addresses(tblName);
+    AK_mem_block *mem_block;
+    long bytes = 0, entries;
+    int i, j;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            mem_block = AK_get_block(j);
+            if (mem_block == NULL || mem_block->block->last_tuple_dict_id == 0)
+                break;
+            entries = mem_block->block->last_tuple_dict_id + 1;
+            bytes += mem_block->block->AK_free_space + entries * sizeof (int)
+                    + entries / num_attr * (sizeof (AK_set_op_row) + 2 * sizeof (AK_set_op_row *));
+        }
+    }
+    AK_free(addresses);
+    return bytes;
+}
+
+/**
+ * @brief  Function that splits a table into partitions (temp segments) by the hash of its rows
+ * @param srcTable table name
+ * @param num_attr number of attributes of the table
+ * @param depth partitioning level of the partitions
+ * @param names names of the partitions
+ * @param buffer buffer for serialized rows
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_op_partition(char *srcTable, int num_attr, int depth, char names[][MAX_ATT_NAME], char *buffer) {
+    AK_table_writer *writers[AK_SET_OP_MAX_PARTITIONS];
+    struct list_node *values[MAX_ATTRIBUTES];
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *src_header = AK_get_header(srcTable);
+    AK_table_cursor *cursor;
+    struct list_node *row;
+    int p, size, first = 1, result = EXIT_SUCCESS;
+
+    memset(header, 0, sizeof (header));
+    memcpy(header, src_header, num_attr * sizeof (AK_header));
+    AK_free(src_header);
+
+    for (p = 0; p < AK_SET_OP_MAX_PARTITIONS; p++) {
+        if (AK_initialize_new_segment(names[p], SEGMENT_TYPE_TABLE, header) == EXIT_ERROR)
+            result = EXIT_ERROR;
+        writers[p] = (result == EXIT_SUCCESS) ? AK_table_writer_open(names[p]) : NULL;
+        if (writers[p] == NULL)
+            result = EXIT_ERROR;
+    }
+
+    cursor = (result == EXIT_SUCCESS) ? AK_table_cursor_open(srcTable) : NULL;
+    while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_set_op_row_values(row, values, num_attr);
+            first = 0;
+        }
+        size = AK_set_op_serialize(values, num_attr, buffer);
+        //the high bits pick the partition, the low ones are left for the buckets of the partition's hash table
+        p = (AK_set_op_hash(buffer, size, depth - 1) >> 16) % AK_SET_OP_MAX_PARTITIONS;
+        result = AK_table_writer_append(writers[p], row);
+    }
+    AK_table_cursor_close(cursor);
+
+    for (p = 0; p < AK_SET_OP_MAX_PARTITIONS; p++)
+        AK_table_writer_close(writers[p]);
+    return result;
+}
+
+/**
+ * @brief  Function that makes a set operation of two tables (or two partitions of them). If the rows do not fit the memory
+ *         budget both are split into partitions, which are processed pair by pair and deleted afterwards.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the result table, the partitions are named after it
+ * @param op AK_SET_UNION, AK_SET_INTERSECT or AK_SET_EXCEPT
+ * @param num_attr number of attributes
+ * @param types types of the attributes
+ * @param memory memory budget for the hash table in bytes
+ * @param depth partitioning level, 0 for the source tables
+ * @param buffer buffer for serialized rows
+ * @param out_row row list of num_attr elements
+ * @param writer writer on the result table
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_op_pass(char *srcTable1, char *srcTable2, char *dstTable, int op, int num_attr, int *types, long memory, int depth,
+        char *buffer, struct list_node *out_row, AK_table_writer *writer) {
+    char *tables[2] = { srcTable1, srcTable2 };
+    char names[2][AK_SET_OP_MAX_PARTITIONS][MAX_ATT_NAME];
+    struct list_node *values[MAX_ATTRIBUTES];
+    AK_set_op_table table;
+    AK_set_op_row *found;
+    AK_table_cursor *cursor;
+    struct list_node *row;
+    unsigned int hash;
+    long bytes;
+    int result = EXIT_SUCCESS, first, size, t, p;
+
+    bytes = AK_set_op_table_bytes(srcTable1, num_attr);
+    if (op == AK_SET_UNION)
+        bytes += AK_set_op_table_bytes(srcTable2, num_attr);
+
+    if (bytes > memory && depth < AK_SET_OP_MAX_DEPTH) {
+        for (t = 0; t < 2 && result == EXIT_SUCCESS; t++) {
+            for (p = 0; p < AK_SET_OP_MAX_PARTITIONS; p++)
+                snprintf(names[t][p], MAX_ATT_NAME, "%s_set_op_%d_%d_%d", dstTable, depth + 1, t + 1, p);
+            result = AK_set_op_partition(tables[t], num_attr, depth + 1, names[t], buffer);
+        }
+        for (p = 0; p < AK_SET_OP_MAX_PARTITIONS; p++) {
+            if (result == EXIT_SUCCESS)
+                result = AK_set_op_pass(names[0][p], names[1][p], dstTable, op, num_attr, types, memory, depth + 1, buffer, out_row, writer);
+            for (t = 0; t < 2; t++) {
+                if (AK_num_attr(names[t][p]) > 0)
+                    AK_delete_segment(names[t][p], SEGMENT_TYPE_TABLE);
+            }
+        }
+        return result;
+    }
+
+    table.num_buckets = 1024;
+    table.num_rows = 0;
+    table.buckets = (AK_set_op_row **) AK_calloc(table.num_buckets, sizeof (AK_set_op_row *));
+    table.first = table.last = NULL;
+    table.chunks = NULL;
+
+    for (t = 0; t < 2 && result == EXIT_SUCCESS; t++) {
+        first = 1;
+        cursor = AK_table_cursor_open(tables[t]);
+        while (result == EXIT_SUCCESS && (row = AK_table_cursor_next(cursor)) != NULL) {
+            if (first) {
+                AK_set_op_row_values(row, values, num_attr);
+                first = 0;
+            }
+            size = AK_set_op_serialize(values, num_attr, buffer);
+            hash = AK_set_op_hash(buffer, size, depth);
+            found = AK_set_op_find(&table, buffer, size, hash);
+
+            if (t == 0 || op == AK_SET_UNION) {
+                //distinct rows of the first table, for UNION of both, are written as they are found
+                if (found == NULL) {
+                    if (AK_set_op_add(&table, buffer, size, hash) == NULL)
+                        result = EXIT_ERROR;
+                    else if (op == AK_SET_UNION)
+                        result = AK_set_op_write(buffer, types, out_row, writer);
+                }
+            } else if (found != NULL && !found->marked) {
+                found->marked = 1;
+                if (op == AK_SET_INTERSECT)
+                    result = AK_set_op_write(buffer, types, out_row, writer);
+            }
+        }
+        AK_table_cursor_close(cursor);
+    }
+
+    if (op == AK_SET_EXCEPT) {
+        for (found = table.first; found != NULL && result == EXIT_SUCCESS; found = found->next_added) {
+            if (!found->marked)
+                result = AK_set_op_write((char *) (found + 1), types, out_row, writer);
+        }
+    }
+
+    AK_set_op_free_table(&table);
+    return result;
+}
+
+/**
+ * @brief  Function that makes a set operation of two tables with the same schema by hashing whole rows
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @param op AK_SET_UNION, AK_SET_INTERSECT or AK_SET_EXCEPT
+ * @param memory memory budget for the hash table in bytes
+ * @return EXIT_SUCCESS, EXIT_ERROR if a table does not exist or the schemas differ
+ */
+int AK_hash_set_op(char *srcTable1, char *srcTable2, char *dstTable, int op, int memory) {
+    AK_PRO;
+    char *operator_name = (op == AK_SET_UNION) ? "Union" : ((op == AK_SET_INTERSECT) ? "Intersect" : "Difference");
+    table_addresses *src_addr1 = (table_addresses *) AK_get_table_addresses(srcTable1);
+    table_addresses *src_addr2 = (table_addresses *) AK_get_table_addresses(srcTable2);
+    AK_header header[MAX_ATTRIBUTES + 1];
+    AK_header *src_header;
+    AK_table_writer *writer;
+    struct list_node *out_row, *last;
+    int types[MAX_ATTRIBUTES];
+    int num_att = EXIT_ERROR, result, i;
+    char *buffer;
+
+    if (src_addr1->address_from[0] != 0 && src_addr2->address_from[0] != 0)
+        num_att = AK_check_tables_scheme(AK_get_block(src_addr1->address_from[0]), AK_get_block(src_addr2->address_from[0]), operator_name);
+    else
+        AK_dbg_messg(LOW, REL_OP, "\nAK_hash_set_op: Table/s doesn't exist!");
+    AK_free(src_addr1);
+    AK_free(src_addr2);
+    if (num_att == EXIT_ERROR || num_att <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(header, 0, sizeof (header));
+    src_header = AK_get_header(srcTable1);
+    memcpy(header, src_header, num_att * sizeof (AK_header));
+    AK_free(src_header);
+    for (i = 0; i < num_att; i++)
+        types[i] = header[i].type;
+
+    if (AK_initialize_new_segment(dstTable, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR || (writer = AK_table_writer_open(dstTable)) == NULL) {
+        printf("AK_hash_set_op: ERROR. Cannot create table %s.\n", dstTable);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    out_row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    AK_Init_L3(&out_row);
+    for (i = 0, last = out_row; i < num_att; i++, last = last->next)
+        last->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    buffer = (char *) AK_malloc(num_att * (sizeof (int) + MAX_VARCHAR_LENGTH));
+
+    result = AK_set_op_pass(srcTable1, srcTable2, dstTable, op, num_att, types, memory, 0, buffer, out_row, writer);
+
+    AK_table_writer_close(writer);
+    AK_free(buffer);
+    AK_DeleteAll_L3(&out_row);
+    AK_free(out_row);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @brief  Function that creates and fills a table for the set operator test. Row i has the id first + i / copies and the
+ *         name "name<id>", so every id is found copies times.
+ * @param tblName table name
+ * @param n number of rows
+ * @param first id of the first row
+ * @param copies number of rows with the same id
+ * @return EXIT_SUCCESS or EXIT_ERROR
+ */
+static int AK_set_op_test_table(char *tblName, int n, int first, int copies) {
+    AK_header header[3];
+    AK_table_writer *writer;
+    struct list_node *row = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    struct list_node *id, *name;
+    int i, number, result = EXIT_SUCCESS;
+
+    memset(header, 0, sizeof (header));
+    header[0].type = TYPE_INT;
+    strcpy(header[0].att_name, "id");
+    header[1].type = TYPE_VARCHAR;
+    strcpy(header[1].att_name, "name");
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, header) == EXIT_ERROR || (writer = AK_table_writer_open(tblName)) == NULL) {
+        AK_free(row);
+        return EXIT_ERROR;
+    }
+
+    AK_Init_L3(&row);
+    id = row->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    name = id->next = (struct list_node *) AK_calloc(1, sizeof (struct list_node));
+    id->type = TYPE_INT;
+    id->size = sizeof (int);
+    name->type = TYPE_VARCHAR;
+    for (i = 0; i < n && result == EXIT_SUCCESS; i++) {
+        number = first + i / copies;
+        memcpy(id->data, &number, sizeof (int));
+        sprintf(name->data, "name%d", number);
+        name->size = strlen(name->data);
+        result = AK_table_writer_append(writer, row);
+    }
+    AK_table_writer_close(writer);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    return result;
+}
+
+/**
+ * @brief  Function that checks the result of a set operator test: every id from low to high - 1 exactly once, with its name
+ * @param tblName result table name
+ * @param low first expected id
+ * @param high id after the last expected one
+ * @return 1 if the result is correct, 0 otherwise
+ */
+static int AK_set_op_test_check(char *tblName, int low, int high) {
+    AK_table_cursor *cursor = AK_table_cursor_open(tblName);
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *row;
+    char *seen = (char *) AK_calloc(high - low, 1);
+    char name[MAX_VARCHAR_LENGTH];
+    int rows = 0, errors = 0, first = 1, id;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
+        if (first) {
+            AK_set_op_row_values(row, values, cursor->num_attr);
+            first = 0;
+        }
+        memcpy(&id, values[0]->data, sizeof (int));
+        sprintf(name, "name%d", id);
+        if (id < low || id >= high || seen[id - low] || strcmp(values[1]->data, name) != 0)
+            errors++;
+        else
+            seen[id - low] = 1;
+        rows++;
+    }
+    AK_table_cursor_close(cursor);
+    AK_free(seen);
+
+    if (errors > 0 || rows != high - low)
+        printf("AK_set_op_test: %s has %d rows (expected %d), %d of them wrong\n", tblName, rows, high - low, errors);
+    return errors == 0 && rows == high - low;
+}
+
+/**
+ * @brief  Function for testing the hash based set operators. The first table has every id from 0 to n/2 - 1 twice, the second
+ *         one every id from n/4 to 3n/4 - 1 once. UNION, INTERSECT and EXCEPT of tables with 10000 and 50000 rows are checked
+ *         and timed, together with the partitioned EXCEPT forced by a small memory budget on the smaller tables. Larger tables
+ *         do not fit the default database file.
+ * @return test result
+ */
+TestResult AK_set_op_test() {
+    AK_PRO;
+    int sizes[] = { 10000, 50000 };
+    int num_sizes = sizeof (sizes) / sizeof (sizes[0]);
+    int ops[] = { AK_SET_UNION, AK_SET_INTERSECT, AK_SET_EXCEPT };
+    char *op_names[] = { "union", "intersect", "except" };
+    char left[MAX_ATT_NAME], right[MAX_ATT_NAME], dst[MAX_ATT_NAME], name[MAX_ATT_NAME];
+    double start, op_ms[2][4];
+    int low[3], high[3];
+    int success = 0, failed = 0, s, n, o, t, p;
+
+    printf("\n********** SET OPERATORS TEST **********\n\n");
+
+    for (s = 0; s < num_sizes; s++) {
+        n = sizes[s];
+        sprintf(left, "set_op_left%d", n);
+        sprintf(right, "set_op_right%d", n);
+        if (AK_set_op_test_table(left, n, 0, 2) == EXIT_ERROR || AK_set_op_test_table(right, n / 2, n / 4, 1) == EXIT_ERROR) {
+            printf("AK_set_op_test: Cannot create tables with %d rows.\n", n);
+            failed++;
+            num_sizes = s;
+            break;
+        }
+        low[0] = 0;
+        high[0] = 3 * n / 4;
+        low[1] = n / 4;
+        high[1] = n / 2;
+        low[2] = 0;
+        high[2] = n / 4;
+
+        for (o = 0; o < 3; o++) {
+            sprintf(dst, "set_op_%s%d", op_names[o], n);
+            start = TEST_time_ms();
+            if (AK_hash_set_op(left, right, dst, ops[o], HASH_SET_MEMORY * 1024) == EXIT_SUCCESS)
+                AK_set_op_test_check(dst, low[o], high[o]) ? success++ : failed++;
+            else
+                failed++;
+            op_ms[s][o] = TEST_time_ms() - start;
+            AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+        }
+
+        //a budget of 16 bytes per row splits both inputs into partitions
+        if (s > 0) {
+            AK_delete_segment(left, SEGMENT_TYPE_TABLE);
+            AK_delete_segment(right, SEGMENT_TYPE_TABLE);
+            continue;
+        }
+        sprintf(dst, "set_op_partitioned%d", n);
+        start = TEST_time_ms();
+        if (AK_hash_set_op(left, right, dst, AK_SET_EXCEPT, n * 16) == EXIT_SUCCESS)
+            AK_set_op_test_check(dst, low[2], high[2]) ? success++ : failed++;
+        else
+            failed++;
+        op_ms[s][3] = TEST_time_ms() - start;
+        for (t = 1; t <= 2; t++) {
+            for (p = 0; p < AK_SET_OP_MAX_PARTITIONS; p++) {
+                snprintf(name, MAX_ATT_NAME, "%s_set_op_1_%d_%d", dst, t, p);
+                if (AK_num_attr(name) > 0) {
+                    printf("AK_set_op_test: partition %s was not deleted\n", name);
+                    failed++;
+                }
+            }
+        }
+        AK_delete_segment(dst, SEGMENT_TYPE_TABLE);
+        AK_delete_segment(left, SEGMENT_TYPE_TABLE);
+        AK_delete_segment(right, SEGMENT_TYPE_TABLE);
+    }
+
+    //the tables that are not the same relation are rejected
+    if (AK_hash_set_op("professor", "student", "set_op_schema", AK_SET_UNION, HASH_SET_MEMORY * 1024) == EXIT_ERROR)
+        success++;
+    else {
+        printf("AK_set_op_test: UNION of tables with different schemas was not rejected\n");
+        AK_delete_segment("set_op_schema", SEGMENT_TYPE_TABLE);
+        failed++;
+    }
+
+    printf("\nSet operators on n rows and n/2 rows (ms)\n");
+    printf("%8s %10s %10s %10s %22s\n", "n", "union", "intersect", "except", "except (16 B/row)");
+    for (s = 0; s < num_sizes; s++) {
+        printf("%8d %10.0f %10.0f %10.0f", sizes[s], op_ms[s][0], op_ms[s][1], op_ms[s][2]);
+        if (s == 0)
+            printf(" %22.0f\n", op_ms[s][3]);
+        else
+            printf(" %22s\n", "-");
+    }
+
+    AK_EPI;
+    return TEST_result(success, failed);
+}
@@ -0,0 +1,120 @@
+/**
+@file set_op.h Header file that provides data structures, functions and defines for the hash based set operators
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef SET_OP
+#define SET_OP
+
+#include "../auxi/test.h"
+#include "../auxi/configuration.h"
+#include "../file/table.h"
+#include "../file/fileio.h"
+#include "../auxi/mempro.h"
+#include "../sql/drop.h"
+
+/**
+ * @def AK_SET_UNION
+ * @brief Constant declaring the UNION set operation, rows of both tables without duplicates
+ */
+#define AK_SET_UNION 1
+
+/**
+ * @def AK_SET_INTERSECT
+ * @brief Constant declaring the INTERSECT set operation, rows found in both tables without duplicates
+ */
+#define AK_SET_INTERSECT 2
+
+/**
+ * @def AK_SET_EXCEPT
+ * @brief Constant declaring the EXCEPT set operation, rows of the first table not found in the second one without duplicates
+ */
+#define AK_SET_EXCEPT 3
+
+/**
+ * @def AK_SET_OP_MAX_PARTITIONS
+ * @brief Constant declaring the number of partitions the inputs of a set operation are split into when they do not fit the memory budget
+ */
+#define AK_SET_OP_MAX_PARTITIONS 8
+
+/**
+ * @def AK_SET_OP_MAX_DEPTH
+ * @brief Constant declaring how many times partitions are split again before the memory budget is ignored
+ */
+#define AK_SET_OP_MAX_DEPTH 3
+
+/**
+ * @def AK_SET_OP_ARENA_CHUNK
+ * @brief Constant declaring the size of the memory chunks the rows of a set operation are copied into
+ */
+#define AK_SET_OP_ARENA_CHUNK (256 * 1024)
+
+/**
+ * @struct AK_set_op_row
+ * @brief Structure that defines a row in a hash table bucket. The row is kept as the size and the bytes of every value,
+ *        following the structure in the same memory chunk, so whole rows are compared with one memcmp.
+ */
+typedef struct AK_set_op_row {
+    struct AK_set_op_row *next;
+    /// next row in the order the rows were added
+    struct AK_set_op_row *next_added;
+    unsigned int hash;
+    /// 1 once the row has been found in the second table or written
+    int marked;
+    int size;
+} AK_set_op_row;
+
+/**
+ * @struct AK_set_op_chunk
+ * @brief Structure that defines a memory chunk of a set operation hash table
+ */
+typedef struct AK_set_op_chunk {
+    struct AK_set_op_chunk *next;
+    long used;
+    char data[AK_SET_OP_ARENA_CHUNK];
+} AK_set_op_chunk;
+
+/**
+ * @struct AK_set_op_table
+ * @brief Structure that defines the in-memory hash table of distinct rows of a set operation
+ */
+typedef struct {
+    int num_buckets;
+    int num_rows;
+    AK_set_op_row **buckets;
+    AK_set_op_row *first;
+    AK_set_op_row *last;
+    AK_set_op_chunk *chunks;
+} AK_set_op_table;
+
+/**
+ * @brief  Function that makes a set operation of two tables with the same schema by hashing whole rows. The distinct rows
+ *         of the first table (for UNION also of the second one) are kept in a hash table and the rows of the second table
+ *         are looked up in it. When the rows do not fit the memory budget both tables are first split by the hash of the row
+ *         into temp segments and the partitions are processed pair by pair. The result has no duplicate rows.
+ * @param srcTable1 name of the first table
+ * @param srcTable2 name of the second table
+ * @param dstTable name of the new table
+ * @param op AK_SET_UNION, AK_SET_INTERSECT or AK_SET_EXCEPT
+ * @param memory memory budget for the hash table in bytes
+ * @return EXIT_SUCCESS, EXIT_ERROR if a table does not exist or the schemas differ
+ */
+int AK_hash_set_op(char *srcTable1, char *srcTable2, char *dstTable, int op, int memory);
+
+TestResult AK_set_op_test();
+
+#endif
@@ -154,60 +154,105 @@ void AK_check_constraints(AK_block *tbl1_temp_block, AK_block *tbl2_temp_block,
     AK_dbg_messg(HIGH, REL_OP, "\n COPYING THETA JOIN");
 
     int tbl1_att, tbl2_att, tbl1_row, tbl2_row;
-    int address, size, type;
+    int size, type;
     char data[MAX_VARCHAR_LENGTH];
 
-    struct list_node *row_root_init = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row_root_full;
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
 
     AK_header *t_header = (AK_header *) AK_get_header(new_table);
+    //the constraints are checked in place on both blocks, rows are only built for matching pairs
+    AK_compiled_expression *compiled = AK_compile_expression(constraints, t_header, tbl1_num_att + tbl2_num_att);
 
-    AK_Init_L3(&row_root_init);
+    AK_Init_L3(&row_root);
 
     for (tbl1_row = 0; tbl1_row < DATA_BLOCK_SIZE; tbl1_row += tbl1_num_att){
 
-    	if (tbl1_temp_block->tuple_dict[tbl1_row].type == FREE_INT)
+    	if (AK_tuple_type(tbl1_temp_block, tbl1_row) == FREE_INT)
 			break;
 
-		for (tbl1_att = 0; tbl1_att < tbl1_num_att; tbl1_att++){
-			address = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].address;
-			size = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].size;
-			type = tbl1_temp_block->tuple_dict[tbl1_row + tbl1_att].type;
-			memset(data, 0, MAX_VARCHAR_LENGTH);
-			memcpy(data, &(tbl1_temp_block->data[address]), size);
-			AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att].att_name, row_root_init);
-		}
-
-
     	for (tbl2_row = 0; tbl2_row < DATA_BLOCK_SIZE; tbl2_row += tbl2_num_att){
 
-    		if (tbl2_temp_block->tuple_dict[tbl2_row].type == FREE_INT)
+    		if (AK_tuple_type(tbl2_temp_block, tbl2_row) == FREE_INT)
 				break;
 
-    		row_root_full = row_root_init;
+    		if (compiled != NULL && !AK_check_compiled_expression(compiled, tbl1_temp_block, tbl1_row, tbl1_num_att, tbl2_temp_block, tbl2_row))
+    			continue;
+
+    		for (tbl1_att = 0; tbl1_att < tbl1_num_att; tbl1_att++){
+				size = AK_tuple_size(tbl1_temp_block, tbl1_row + tbl1_att);
+				type = AK_tuple_type(tbl1_temp_block, tbl1_row + tbl1_att);
+				memset(data, 0, MAX_VARCHAR_LENGTH);
+				memcpy(data, AK_tuple_data(tbl1_temp_block, tbl1_row + tbl1_att), size);
+				AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att].att_name, row_root);
+			}
 
     		for (tbl2_att = 0; tbl2_att < tbl2_num_att; tbl2_att++){
-				address = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].address;
-				size = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].size;
-				type = tbl2_temp_block->tuple_dict[tbl2_row + tbl2_att].type;
+				size = AK_tuple_size(tbl2_temp_block, tbl2_row + tbl2_att);
+				type = AK_tuple_type(tbl2_temp_block, tbl2_row + tbl2_att);
 				memset(data, 0, MAX_VARCHAR_LENGTH);
-				memcpy(data, &(tbl2_temp_block->data[address]), size);
-				AK_Insert_New_Element(type, data, new_table, t_header[tbl1_att + tbl2_att].att_name, row_root_full);
+				memcpy(data, AK_tuple_data(tbl2_temp_block, tbl2_row + tbl2_att), size);
+				AK_Insert_New_Element(type, data, new_table, t_header[tbl1_num_att + tbl2_att].att_name, row_root);
 			}
 
-			if (AK_check_if_row_satisfies_expression(row_root_full, constraints)){
-    			AK_insert_row(row_root_full);
+			if (compiled != NULL || AK_check_if_row_satisfies_expression(row_root, constraints)){
+    			AK_insert_row(row_root);
 			}
-    	}
 
-    	
-    	AK_DeleteAll_L3(&row_root_init);
+    		AK_DeleteAll_L3(&row_root);
+    	}
     }
 
-    AK_free(row_root_init);
+    AK_free_compiled_expression(compiled);
+    AK_free(t_header);
+    AK_free(row_root);
     AK_EPI;
 }
 
+/**
+ * @brief  Function that finds the key attributes of a theta join whose constraints are equalities between an attribute of
+ *         the first table and an attribute of the second table, joined with AND
+ * @param constraints list of attributes, (in)equality and logical operators which are the conditions for the join in postfix notation
+ * @param t_header header of the theta join table
+ * @param tbl1_num_att number of attributes in the first table
+ * @param tbl2_num_att number of attributes in the second table
+ * @param keys1 indexes of the key attributes in the first table
+ * @param keys2 indexes of the key attributes in the second table
+ * @return number of key attributes, 0 if the constraints are not of that form
+ */
+static int AK_theta_join_equi_keys(struct list_node *constraints, AK_header *t_header, int tbl1_num_att, int tbl2_num_att, int *keys1, int *keys2) {
+    struct list_node *el;
+    //attribute indexes in the join header, -1 for an equality or a conjunction of equalities
+    int stack[2 * MAX_ATTRIBUTES];
+    int top = 0, num_keys = 0, a, b;
+
+    for (el = AK_First_L2(constraints); el != NULL; el = el->next) {
+        if (el->type == TYPE_ATTRIBS) {
+            for (a = 0; a < tbl1_num_att + tbl2_num_att && strcmp(t_header[a].att_name, el->data) != 0; a++);
+            if (a == tbl1_num_att + tbl2_num_att || top == 2 * MAX_ATTRIBUTES)
+                return 0;
+            stack[top++] = a;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "=") == 0) {
+            if (top < 2 || stack[top - 1] < 0 || stack[top - 2] < 0 || num_keys == MAX_ATTRIBUTES)
+                return 0;
+            a = (stack[top - 2] < stack[top - 1]) ? stack[top - 2] : stack[top - 1];
+            b = (stack[top - 2] < stack[top - 1]) ? stack[top - 1] : stack[top - 2];
+            if (a >= tbl1_num_att || b < tbl1_num_att)
+                return 0;
+            keys1[num_keys] = a;
+            keys2[num_keys++] = b - tbl1_num_att;
+            stack[top - 2] = -1;
+            top--;
+        } else if (el->type == TYPE_OPERATOR && strcmp(el->data, "AND") == 0) {
+            if (top < 2 || stack[top - 1] >= 0 || stack[top - 2] >= 0)
+                return 0;
+            top--;
+        } else {
+            return 0;
+        }
+    }
+    return (top == 1 && stack[0] < 0) ? num_keys : 0;
+}
+
 /**
  * @author Tomislav Mikulček,updated by Nikola Miljancic
  * @brief Function that creates a theta join betwen two tables on specified conditions. Names of the attibutes in the constraints parameter must be prefixed
@@ -238,6 +283,25 @@ int AK_theta_join(char *srcTable1, char * srcTable2, char * dstTable, struct lis
 	}
 
         AK_dbg_messg(LOW, REL_OP, "\nTABLE %s CREATED from %s and %s\n", dstTable, srcTable1, srcTable2);
+
+        //an equi-join is done with a hash join
+        int keys1[MAX_ATTRIBUTES], keys2[MAX_ATTRIBUTES];
+        int result = EXIT_WARNING;
+        AK_header *t_header = (AK_header *) AK_get_header(dstTable);
+        int num_keys = 0;
+        if (AK_num_attr(dstTable) == tbl1_num_att + tbl2_num_att)
+            num_keys = AK_theta_join_equi_keys(constraints, t_header, tbl1_num_att, tbl2_num_att, keys1, keys2);
+        AK_free(t_header);
+
+        if (num_keys > 0)
+            result = AK_hash_join(srcTable1, srcTable2, dstTable, num_keys, keys1, keys2, 0, HASH_JOIN_MEMORY * 1024);
+        if (result != EXIT_WARNING) {
+            AK_free(src_addr1);
+            AK_free(src_addr2);
+            AK_EPI;
+            return result;
+        }
+
 		AK_dbg_messg(MIDDLE, REL_OP, "\nAK_theta_join: start copying data\n");
 
         AK_mem_block *tbl1_temp_block, *tbl2_temp_block;
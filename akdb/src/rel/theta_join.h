@@ -23,6 +23,7 @@
 
 #include "../auxi/test.h"
 #include "expression_check.h"
+#include "hash_join.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 
@@ -24,10 +24,11 @@
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
+#include "set_op.h"
 
 /**
  * @author Dino Laktašić
- * @brief  Function that makes a union of two tables. 
+ * @brief  Function that makes a union of two tables with the same schema. Duplicate rows are written once, see AK_hash_set_op.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
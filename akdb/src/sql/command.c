@@ -31,14 +31,15 @@ int AK_command(command * commands, int commandNum) {
         switch(commands[i].id_command){
         case SELECT:
             printf("***SELECT***\n");
-            char *ext = "_selection_tmp_table";
-            char *dest_table = AK_malloc(strlen(ext) + strlen(commands[i].tblName)+1);
-            strcpy(dest_table, commands[i].tblName);
-            strcat(dest_table, ext);
-            if(AK_selection(commands[i].tblName, dest_table, (struct list_node*)commands[i].parameters) == EXIT_ERROR){ // print temp table inside the function
-        AK_EPI;
+            // the selected rows stream from the plan to the screen, no temp table is made
+            AK_add_to_redolog_select(SELECT, (struct list_node*)commands[i].parameters, commands[i].tblName);
+            AK_iterator *plan = AK_selection_iterator(commands[i].tblName, (struct list_node*)commands[i].parameters);
+            int printed = (plan == NULL) ? EXIT_ERROR : AK_iterator_print(plan, commands[i].tblName);
+            AK_iterator_free(plan);
+            if(printed == EXIT_ERROR){
+                AK_EPI;
                 return EXIT_ERROR;
-        }
+            }
 
             break;
             
@@ -27,8 +27,7 @@
  * @return EXIT_ERROR or EXIT_SUCCESS
  **/
 int AK_check_constraint_name(char *constraintName) {
-	int i, j;
-	int num_rows;
+	int i;
 
 	/**
 	 * Updated by Matej Lipovača
@@ -55,23 +54,20 @@ int AK_check_constraint_name(char *constraintName) {
 
 	for (i = 0; i < constraint_table_names_size; ++i)
 	{
-		num_rows = AK_get_num_records(constraint_table_names[i]);
+		AK_table_cursor *cursor = AK_table_cursor_open(constraint_table_names[i]);
 
-		for (j = 0; j < num_rows; ++j)
+		while ((row = AK_table_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(j, constraint_table_names[i]);
 			attribute = AK_GetNth_L2(3, row);
 			
 			if (strcmp(attribute->data, constraintName) == 0)
 			{
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
+				AK_table_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 		}
+		AK_table_cursor_close(cursor);
 	}
 		
 	//OTHER CONSTRAINTS ARE NOT YET IMPLEMENTED, COMPLETE THIS FUNCTION WHEN THAT HAPPENS!!!
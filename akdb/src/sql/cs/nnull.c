@@ -84,8 +84,6 @@ int AK_set_constraint_not_null(char* tableName, char* attName, char* constraintN
  * @return EXIT_ERROR or EXIT_SUCCESS
  **/
 int AK_check_constraint_not_null(char* tableName, char* attName, char* constraintName) {
-	int i;
-	int numRows;
 	int newConstraint;
 	int uniqueConstraintName;
 	struct list_node *row;
@@ -95,31 +93,24 @@ int AK_check_constraint_not_null(char* tableName, char* attName, char* constrain
 
 	AK_PRO;
 
-	numRows = AK_get_num_records(tableName);
+	int positionOfAtt = AK_get_attr_index(tableName, attName) + 1;
+	AK_table_cursor *cursor = AK_table_cursor_open(tableName);
 	
-	if(numRows > 0)
+	while((row = AK_table_cursor_next(cursor)) != NULL)
 	{
-		int positionOfAtt = AK_get_attr_index(tableName, attName) + 1;
+		attribute = AK_GetNth_L2(positionOfAtt, row);
 		
-		for(i=0; i<numRows; i++)
+		if((tupple_to_string_return=AK_tuple_to_string(attribute)) == NULL)
 		{
-			row = AK_get_row(i, tableName);
-			attribute = AK_GetNth_L2(positionOfAtt, row);
-			
-			if((tupple_to_string_return=AK_tuple_to_string(attribute)) == NULL)
-			{
-				printf("\nFAILURE!\nTable: %s\ncontains NULL sign and that would violate NOT NULL constraint which You would like to set on attribute: %s\n\n", tableName, attName);
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
-				AK_EPI;
-				return EXIT_ERROR;
-			}
-			else
-				AK_free(tupple_to_string_return);
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
+			printf("\nFAILURE!\nTable: %s\ncontains NULL sign and that would violate NOT NULL constraint which You would like to set on attribute: %s\n\n", tableName, attName);
+			AK_table_cursor_close(cursor);
+			AK_EPI;
+			return EXIT_ERROR;
 		}
+		else
+			AK_free(tupple_to_string_return);
 	}
+	AK_table_cursor_close(cursor);
 
 	uniqueConstraintName = AK_check_constraint_name(constraintName);
 
@@ -145,38 +136,31 @@ int AK_check_constraint_not_null(char* tableName, char* attName, char* constrain
  **/
 
 int AK_read_constraint_not_null(char* tableName, char* attName, char* newValue) {
-	int numRecords = AK_get_num_records("AK_constraints_not_null");
-
 	struct list_node *row;
 	struct list_node *attribute;
 	struct list_node *table;
-	int i;
 	
 	AK_PRO;
 
 	if(newValue == NULL) {
-		if(numRecords != 0) {
-			for (i = 0; i < numRecords; i++) 
+		AK_table_cursor *cursor = AK_table_cursor_open("AK_constraints_not_null");
+		while ((row = AK_table_cursor_next(cursor)) != NULL) 
+		{
+			attribute = AK_GetNth_L2(4, row);
+			
+			if(strcmp(attribute->data, attName) == 0) 
 			{
-				row = AK_get_row(i, "AK_constraints_not_null");
-				attribute = AK_GetNth_L2(4, row);
+				table = AK_GetNth_L2(2, row);
 				
-				if(strcmp(attribute->data, attName) == 0) 
+				if(strcmp(table->data, tableName) == 0) 
 				{
-					table = AK_GetNth_L2(2, row);
-					
-					if(strcmp(table->data, tableName) == 0) 
-					{
-						AK_DeleteAll_L3(&row);
-						AK_free(row);
-						AK_EPI;
-						return EXIT_ERROR;
-					}
+					AK_table_cursor_close(cursor);
+					AK_EPI;
+					return EXIT_ERROR;
 				}
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
-			}			
+			}
 		}
+		AK_table_cursor_close(cursor);
 	}
 
 	AK_EPI;
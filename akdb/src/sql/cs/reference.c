@@ -67,14 +67,13 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
  * @return AK_ref_item object with all neccessary information about the reference
  */
 AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
-    int i = 0;
-
     struct list_node *list;
     AK_ref_item reference;
     AK_PRO;
     reference.attributes_number = 0;
 
-    while ((list = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((list = AK_table_cursor_next(cursor)) != NULL) {
         if (strcmp(list->next->data, tableName) == 0 &&
                 strcmp(list->next->next->data, constraintName) == 0) {
             strcpy(reference.table, tableName);
@@ -85,8 +84,8 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
             memcpy(&reference.type, list->next->next->next->next->next->next->data, sizeof (int));
             reference.attributes_number++;
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return reference;
 }
@@ -100,12 +99,12 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
  * @return EXIT ERROR if check failed, EXIT_SUCCESS if referential integrity is ok
  */
 int AK_reference_check_attribute(char *tableName, char *attribute, char *value) {
-    int i;
     int att_index;
 
     struct list_node *list_row, *list_col;
     AK_PRO;
-    while ((list_row = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((list_row = AK_table_cursor_next(cursor)) != NULL) {
         if (strcmp(list_row->next->data, tableName) == 0 &&
                 strcmp(list_row->next->next->next->data, attribute) == 0) {
             att_index = AK_get_attr_index(list_row->next->next->next->next->data, list_row->next->next->next->next->next->data);
@@ -113,13 +112,14 @@ int AK_reference_check_attribute(char *tableName, char *attribute, char *value)
             while (strcmp(list_col->data, value) != 0) {
                 list_col = list_col->next;
                 if (list_col == NULL){
+                    AK_table_cursor_close(cursor);
 		    AK_EPI;
                     return EXIT_ERROR;
 		}
             }
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -135,27 +135,29 @@ int AK_reference_check_attribute(char *tableName, char *attribute, char *value)
 int AK_reference_check_if_update_needed(struct list_node *lista, int action) {
 
     struct list_node *temp;
-    int i = 0;
 
     struct list_node *row;
     AK_PRO;
-    while ((row = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         if (strcmp(row->next->next->next->next->data, lista->next->table) == 0) {
 	    temp = AK_First_L2(lista);
             while (temp != NULL) {
                 if (action == UPDATE && temp->constraint == 0 && strcmp(row->next->next->next->next->next->data, temp->attribute_name) == 0){
+                    AK_table_cursor_close(cursor);
 		    AK_EPI;
                     return EXIT_SUCCESS;
 		}
                 else if (action == DELETE && strcmp(row->next->next->next->next->next->data, temp->attribute_name) == 0){
+                    AK_table_cursor_close(cursor);
 		    AK_EPI;
                     return EXIT_SUCCESS;
 		}
 		temp = AK_Next_L2(temp);
             }
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return EXIT_ERROR;
 }
@@ -169,29 +171,30 @@ int AK_reference_check_if_update_needed(struct list_node *lista, int action) {
  */
 
 int AK_reference_check_restricion(struct list_node *lista, int action) {    
-    int i = 0;
-
     struct list_node *temp;
     struct list_node *row;
     AK_PRO;
-    while ((row = AK_get_row(i, "AK_reference")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         if (strcmp(row->next->next->next->next->data, lista->next->table) == 0) {
 
 	    temp = AK_First_L2(lista);
             while (temp != NULL) {
                 if (action == UPDATE && temp->constraint == 0 && memcmp(row->next->next->next->next->next->data, temp->attribute_name, row->next->next->next->next->next->size) == 0 && (int) * row->next->next->next->next->next->next->data == REF_TYPE_RESTRICT){
+                    AK_table_cursor_close(cursor);
 		    AK_EPI;
                     return EXIT_ERROR;
 		}
                 else if (action == DELETE && memcmp(row->next->next->next->next->next->data, temp->attribute_name, row->next->next->next->next->next->size) == 0 && (int) * row->next->next->next->next->next->next->data == REF_TYPE_RESTRICT){
+                    AK_table_cursor_close(cursor);
 		    AK_EPI;
                     return EXIT_ERROR;
 		}
 		temp = AK_Next_L2(temp);
             }
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
 
     AK_EPI;
     return EXIT_SUCCESS;
@@ -206,7 +209,7 @@ int AK_reference_check_restricion(struct list_node *lista, int action) {
  */
 
 int AK_reference_update(struct list_node *lista, int action) {
-    int parent_i, i, j, ref_i, con_num = 0;
+    int i, j, con_num = 0;
 
     struct list_node *parent_row;
     struct list_node *ref_row;
@@ -222,7 +225,8 @@ int AK_reference_update(struct list_node *lista, int action) {
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
 
-    while ((ref_row = AK_get_row(ref_i, "AK_reference")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((ref_row = AK_table_cursor_next(cursor)) != NULL) {
         if (strcmp(ref_row->next->next->next->next->data, lista->next->table) == 0) { // we're searching for PARENT table here
             for (j = 0; j < con_num; j++) {
                 if (strcmp(constraints[j], ref_row->next->next->data) == 0 && strcmp(child_tables[j], ref_row->next->data) == 0) {
@@ -235,8 +239,8 @@ int AK_reference_update(struct list_node *lista, int action) {
                 con_num++;
             }
         }
-        ref_i++;
     }
+    AK_table_cursor_close(cursor);
 
     struct list_node *expr;
     AK_Init_L3(&expr);
@@ -270,7 +274,8 @@ int AK_reference_update(struct list_node *lista, int action) {
     AK_print_table(tempTable);
 
     // browsing through affected rows..
-    while ((parent_row = AK_get_row(parent_i, tempTable)) != NULL) {
+    cursor = AK_table_cursor_open(tempTable);
+    while ((parent_row = AK_table_cursor_next(cursor)) != NULL) {
         for (i = 0; i < con_num; i++) {
             reference = AK_get_reference(child_tables[i], constraints[i]);
             
@@ -332,9 +337,8 @@ int AK_reference_update(struct list_node *lista, int action) {
                 AK_delete_row(row_root);
 
         }
-
-        parent_i++;
     }
+    AK_table_cursor_close(cursor);
 
     AK_delete_segment(tempTable, SEGMENT_TYPE_TABLE);
     AK_EPI;
@@ -369,7 +373,8 @@ int AK_reference_check_entry(struct list_node *lista) {
 	temp = AK_Next_L2(temp);
     }
 
-    while ((row = AK_get_row(i, "AK_reference")) != NULL) 
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_reference");
+    while ((row = AK_table_cursor_next(cursor)) != NULL)
 	{
         if (strcmp(row->next->data, lista->next->table) == 0) 
 		{
@@ -386,9 +391,8 @@ int AK_reference_check_entry(struct list_node *lista) {
                 con_num++;
             }
         }
-        i++;
-		AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     if (con_num == 0){
 	AK_EPI;
@@ -425,8 +429,8 @@ int AK_reference_check_entry(struct list_node *lista) {
         }
 
 
-        j = 0;
-        while ((row = AK_get_row(j, reference.parent)) != NULL) { // rows in parent table
+        cursor = AK_table_cursor_open(reference.parent);
+        while ((row = AK_table_cursor_next(cursor)) != NULL) { // rows in parent table
             success = 1;
             for (k = 0; k < reference.attributes_number; k++) { // attributes in reference
 		temp1 = AK_GetNth_L2(AK_get_attr_index(reference.parent, reference.parent_attributes[k]), row);
@@ -438,11 +442,12 @@ int AK_reference_check_entry(struct list_node *lista) {
                 }
             }
             if (success == 1) {
+                AK_table_cursor_close(cursor);
 		AK_EPI;
                 return EXIT_SUCCESS;
             }
-            j++;
         }
+        AK_table_cursor_close(cursor);
     }
     AK_EPI;
     return EXIT_ERROR;
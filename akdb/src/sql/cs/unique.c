@@ -64,16 +64,13 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 	
 	if(numRows > 0)
 	{
-		row = AK_get_row(0, tableName);
-		int numOfAttsInTable = AK_Size_L2(row);
+		int numOfAttsInTable = AK_num_attr(tableName);
 		int positionsOfAtts[numOfAttsInTable];
 		int numOfImpAttPos = 0;
 		char attNameCopy[MAX_VARCHAR_LENGTH];
 		char *nameOfOneAtt;
 		char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
 		char *key, *val;
-		AK_DeleteAll_L3(&row);
-		AK_free(row);
 		strncpy(attNameCopy, attName, sizeof(attNameCopy));
 
 		nameOfOneAtt = strtok(attNameCopy, SEPARATOR);
@@ -98,10 +95,9 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 			AK_EPI;
 			return EXIT_ERROR;
 		}
-		for(i=0; i<numRows-1; i++)
+		AK_table_cursor *cursor = AK_table_cursor_open(tableName);
+		for(i=0; i<numRows-1 && (row = AK_table_cursor_next(cursor)) != NULL; i++)
 		{
-			row = AK_get_row(i, tableName);
-				
 			match = 1;
 			for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
 			{
@@ -127,14 +123,12 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 			{
 				printf("\nFAILURE!\nExisting values in table: %s\nwould violate UNIQUE constraint which You would like to set on (combination of) attribute(s): %s\n\n", tableName, attName);
 				dictionary_del(dict);
-				AK_DeleteAll_L3(&row);
-				AK_free(row);
+				AK_table_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 		}
+		AK_table_cursor_close(cursor);
 	dictionary_del(dict);
 	}
 
@@ -219,18 +213,20 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		}
 	}
 
-	int numRecords = AK_get_num_records("AK_constraints_unique");
+	//only the first row is needed to know whether there are any UNIQUE constraints
+	AK_table_cursor *cursor = AK_table_cursor_open("AK_constraints_unique");
+	int numRecords = AK_table_cursor_next(cursor) != NULL;
+	AK_table_cursor_close(cursor);
 	
 	if(numRecords!=0 && (strcmpTableName!=0 || (strcmpTableName==0 && strcmpAttName==0)))
 	{
 		struct list_node *row;
 		struct list_node *attribute;
 		struct list_node *table;
-		int i;
 		
-		for(i=0; i<numRecords; i++)
+		cursor = AK_table_cursor_open("AK_constraints_unique");
+		while((row = AK_table_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(i, "AK_constraints_unique");
 			attribute = AK_GetNth_L2(4, row);
 			
 			if(strcmp(attribute->data, attName) == 0)
@@ -239,16 +235,8 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 				
 				if(strcmp(table->data, tableName) == 0)
 				{
-					int numRows = AK_get_num_records(table->data);
-					
-					if(numRows == 0)
-					{
-						AK_EPI;
-						return EXIT_SUCCESS;
-					}
-					
-					struct list_node *row2 = AK_get_row(0, table->data);
-					int numOfAttsInTable = AK_Size_L2(row2);
+					struct list_node *row2;
+					int numOfAttsInTable = AK_num_attr(table->data);
 					int positionsOfAtts[numOfAttsInTable];
 					int numOfImpAttPos = 0;
 					char attNameCopy[MAX_VARCHAR_LENGTH];
@@ -268,7 +256,6 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 						nameOfOneAtt = strtok(NULL, SEPARATOR);
 					}
 					
-					int h;
 					int impoIndexInArray;
 					int match;
 					int index = 0;
@@ -287,10 +274,9 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 					}
 
 					
-					for(h=0; h<numRows; h++)
+					AK_table_cursor *cursor2 = AK_table_cursor_open(table->data);
+					while((row2 = AK_table_cursor_next(cursor2)) != NULL)
 					{
-						row2 = AK_get_row(h, table->data);
-
 						match = 1;
 						
 						for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
@@ -309,32 +295,35 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 						
 						if(match == 1)
 						{
+							AK_table_cursor_close(cursor2);
+							AK_table_cursor_close(cursor);
 							AK_EPI;
 							return EXIT_ERROR;
 						}
 					}
+					AK_table_cursor_close(cursor2);
+					AK_table_cursor_close(cursor);
 					
 					AK_EPI;
 					return EXIT_SUCCESS;
 				}
 			}
 		}
+		AK_table_cursor_close(cursor);
 		
 		AK_EPI;
 		return EXIT_SUCCESS;
 	}
 	else if(numRecords !=0 && strcmpTableName==0 && strcmpAttName!=0)
 	{
-		struct list_node *row = AK_get_row(0, tableName);
-		int numOfAttsInTable = AK_Size_L2(row);
+		struct list_node *row;
+		int numOfAttsInTable = AK_num_attr(tableName);
 		int positionsOfAtts[numOfAttsInTable];
 		int numOfImpAttPos = 0;
 		char attNameCopy[MAX_VARCHAR_LENGTH];
 		char *nameOfOneAtt;
 		char namesOfAtts[numOfAttsInTable][MAX_VARCHAR_LENGTH];
 		struct list_node *attribute2;
-		AK_DeleteAll_L3(&row);
-		AK_free(row);
 		
 		strncpy(attNameCopy, attName, sizeof(attNameCopy));
 
@@ -348,7 +337,6 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 			nameOfOneAtt = strtok(NULL, SEPARATOR);
 		}
 		
-		int h;
 		int impoIndexInArray;
 		int match;
 		int index = 0;
@@ -366,12 +354,9 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 		value2 = strtok(NULL, "");
 		strncpy(values[index], value2+strlen(SEPARATOR)-1, sizeof(values[index]));
 
-		int numRows = AK_get_num_records(tableName);
-
-		for(h=0; h<numRows; h++)
+		cursor = AK_table_cursor_open(tableName);
+		while((row = AK_table_cursor_next(cursor)) != NULL)
 		{
-			row = AK_get_row(h, tableName);
-
 			match = 1;
 			
 			for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(match==1); impoIndexInArray++)
@@ -390,14 +375,14 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 				else
 					AK_free(tuple_to_string_return);
 			}
-			AK_DeleteAll_L3(&row);
-			AK_free(row);
 			if(match == 1)
 			{
+				AK_table_cursor_close(cursor);
 				AK_EPI;
 				return EXIT_ERROR;
 			}
 		}
+		AK_table_cursor_close(cursor);
 		
 		AK_EPI;
 		return EXIT_SUCCESS;
@@ -450,6 +450,7 @@ void AK_drop_help_function(char *tblName, char *sys_table) {
     AK_Update_Existing_Element(TYPE_VARCHAR, tblName, sys_table, "name", row_root);
 
     AK_delete_row(row_root);
+    AK_catalog_invalidate(tblName);
     AK_free(addresses);
     AK_free(addresses2);
 
@@ -465,21 +466,18 @@ void AK_drop_help_function(char *tblName, char *sys_table) {
  */
 int AK_if_exist(char *tblName, char *sys_table) {
     AK_PRO;
-    int num_rows = AK_get_num_records(sys_table);
-    int a;
-	struct list_node *el;
-    for (a = 0; a < num_rows; a++) 
+    AK_table_cursor *cursor = AK_table_cursor_open(sys_table);
+	struct list_node *row;
+    while ((row = AK_table_cursor_next(cursor)) != NULL) 
 	{
-        el = AK_get_tuple(a, 1, sys_table);
-        if (!strcmp(tblName, el->data)) 
+        if (!strcmp(tblName, AK_GetNth_L2(2, row)->data)) 
 		{
-			AK_DeleteAll_L3(&el);
-			AK_free(el);
+			AK_table_cursor_close(cursor);
+			AK_EPI;
             return 1; // exist
         }
-		AK_DeleteAll_L3(&el);
-		AK_free(el);
     }
+	AK_table_cursor_close(cursor);
     AK_EPI;
     return 0; // not exist
 }
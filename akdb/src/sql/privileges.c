@@ -67,17 +67,17 @@ int AK_user_get_id(char *username) {
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, username) == 0) {
             i = (int) * row->next->data;
-            AK_free(row);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return i;
         }
-        i++;
     }
-    AK_free(row);
+    AK_table_cursor_close(cursor);
 
     AK_EPI;
     return EXIT_ERROR;
@@ -91,30 +91,26 @@ int AK_user_get_id(char *username) {
  * @return check 0 if false or 1 if true
  */
 int AK_user_check_pass(char *username, int *password) {
-    int i = 0;
     int check = 0;
     struct list_node *row;
     
     AK_PRO;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
        struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, username) == 0) {                                 
             elem_in_strcmp = AK_GetNth_L2(3, row);
                              
             if (strcmp(elem_in_strcmp->data, &password) == 0) {
                 check = 1;
-                AK_free(elem_in_strcmp);
-                AK_free(row);
+                AK_table_cursor_close(cursor);
                 AK_EPI;                
                 return check;
             }
         }   
-             
-        i++;        
     }
-
-    AK_free(row);   
+    AK_table_cursor_close(cursor);
 
     AK_EPI;
     return check;
@@ -209,17 +205,17 @@ int AK_group_get_id(char *name) {
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_group")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_group");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *elem_in_strcmp = AK_GetNth_L2(2, row);
         if (strcmp(elem_in_strcmp->data, name) == 0) {
             i = (int) * row->next->data;
-            AK_free(row);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return i;
         }
-        i++;
     }
-    AK_free(row);
+    AK_table_cursor_close(cursor);
 
     AK_EPI;
     return EXIT_ERROR;
@@ -358,11 +354,11 @@ int AK_revoke_privilege_user(char *username, char *table, char *right) {
     if (strcmp(right, "ALL") == 0) {
         struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
         AK_Init_L3(&row_root);
-        int i = 0;
 
         struct list_node *row;
 
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+        AK_table_cursor *cursor = AK_table_cursor_open("AK_user_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
             struct list_node *obj_id = AK_GetNth_L2(1, row);
             struct list_node *user_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -372,19 +368,18 @@ int AK_revoke_privilege_user(char *username, char *table, char *right) {
                 AK_Update_Existing_Element(TYPE_INT, &id, "AK_user_right", "obj_id", row_root);
                 result = AK_delete_row(row_root);
             }
-            i++;
 
             AK_DeleteAll_L3(&row_root);
-            AK_free(row);
         }
+        AK_table_cursor_close(cursor);
         printf("Revoked all privileges for user '%s' under ID %d on table '%s'!\n", username, user_id, table);
     } else {
         struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
         AK_Init_L3(&row_root);
-        int i = 0;
         struct list_node *row;
 
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+        AK_table_cursor *cursor = AK_table_cursor_open("AK_user_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
             struct list_node *obj_id = AK_GetNth_L2(1, row);
             struct list_node *user_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -395,11 +390,10 @@ int AK_revoke_privilege_user(char *username, char *table, char *right) {
                 AK_Update_Existing_Element(TYPE_INT, &id, "AK_user_right", "obj_id", row_root);
                 result = AK_delete_row(row_root);
             }
-            i++;
 
             AK_DeleteAll_L3(&row_root);
-            AK_free(row);
         }
+        AK_table_cursor_close(cursor);
         printf("Revoked privilege to %s data for user '%s' under ID %d on table '%s'!\n", right, username, user_id, table);
     }
 
@@ -432,21 +426,20 @@ int AK_revoke_all_privileges_user(char *username) {
 
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
-    int i = 0;
 
     struct list_node *row;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_right");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *user = AK_GetNth_L2(2, row);
         if ((int) *user->data == user_id) {
             AK_Update_Existing_Element(TYPE_INT, &user_id, "AK_user_right", "user_id", row_root);
             result = AK_delete_row(row_root);
         }
-        i++;
 
         AK_DeleteAll_L3(&row_root);
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     printf("Revoked all privileges for user '%s' under ID %d!\n", username, user_id);
 
@@ -546,11 +539,11 @@ int AK_revoke_privilege_group(char *groupname, char *table, char *right) {
     if (strcmp(right, "ALL") == 0) {
         struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
         AK_Init_L3(&row_root);
-        int i = 0;
 
         struct list_node *row;
 
-        while ((row = (struct list_node *) AK_get_row(i, "AK_group_right")) != NULL) {
+        AK_table_cursor *cursor = AK_table_cursor_open("AK_group_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
             struct list_node *obj_id = AK_GetNth_L2(1, row);
             struct list_node *group_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -561,20 +554,19 @@ int AK_revoke_privilege_group(char *groupname, char *table, char *right) {
                 result = AK_delete_row(row_root);
             }
 
-            i++;
 
             AK_DeleteAll_L3(&row_root);
-            AK_free(row);
         }
+        AK_table_cursor_close(cursor);
         printf("Revoked all privileges for group '%s' under ID %d on table '%s' under ID %d!\n", groupname, group_id, table, table_id);
     } else {
         struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
         AK_Init_L3(&row_root);
-        int i = 0;
 
         struct list_node *row;
 
-        while ((row = (struct list_node *) AK_get_row(i, "AK_group_right")) != NULL) {
+        AK_table_cursor *cursor = AK_table_cursor_open("AK_group_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
             struct list_node *obj_id = AK_GetNth_L2(1, row);
             struct list_node *group_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -586,11 +578,10 @@ int AK_revoke_privilege_group(char *groupname, char *table, char *right) {
                 result = AK_delete_row(row_root);
             }
 
-            i++;
 
             AK_DeleteAll_L3(&row_root);
-            AK_free(row);
         }
+        AK_table_cursor_close(cursor);
         printf("Revoked privilege to %s data for group '%s' under ID %d on table '%s' under ID %d!\n", right, groupname, group_id, table, table_id);
     }
 
@@ -623,22 +614,21 @@ int AK_revoke_all_privileges_group(char *groupname) {
 
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
-    int i = 0;
 
     struct list_node *row;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_group_right")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_group_right");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *group = AK_GetNth_L2(2, row);
         if ((int) *group->data == group_id) {
             AK_Update_Existing_Element(TYPE_INT, &group_id, "AK_group_right", "group_id", row_root);
             printf("Revoked all privilege for group '%s' under ID %d!\n\n", groupname, group_id);
             result = AK_delete_row(row_root);
         }
-        i++;
 
         AK_DeleteAll_L3(&row_root);
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     if (result == EXIT_ERROR) {
         AK_EPI;
@@ -661,7 +651,6 @@ int AK_add_user_to_group(char *user, char *group) {
     AK_PRO;
     int user_id = AK_user_get_id(user);
     int group_id = AK_group_get_id(group);
-    int i = 0;
     struct list_node *row;
 
     if (group_id == EXIT_ERROR || user_id == EXIT_ERROR) {
@@ -670,16 +659,18 @@ int AK_add_user_to_group(char *user, char *group) {
         return EXIT_ERROR;
     }
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_group");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
 
         // if user is already in group, return error
         if (user_id == (int) *row->next->data) {
             printf("User '%s' under ID %d is already a member of group '%s' under ID %d!\n", user, user_id, group, group_id);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return EXIT_ERROR;
         }
-        i++;
     }
+    AK_table_cursor_close(cursor);
 
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
@@ -708,7 +699,6 @@ int AK_remove_user_from_all_groups(char *user) {
     AK_Init_L3(&row_root);
 
     int user_id = AK_user_get_id(user);
-    int i = 0;
     int result;
 
     if (user_id == EXIT_ERROR) {
@@ -719,22 +709,23 @@ int AK_remove_user_from_all_groups(char *user) {
 
     struct list_node *row;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_group");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *user = AK_GetNth_L2(1, row);
         if (user_id == (int) *user->data) {
             AK_Update_Existing_Element(TYPE_INT, &user_id, "AK_user_group", "user_id", row_root);
             result = AK_delete_row(row_root);
             if (result == EXIT_ERROR) {
                 printf("User '%s' under ID %d isn't a member of any group!\n", user, user_id);
+                AK_table_cursor_close(cursor);
                 AK_EPI;
                 return EXIT_ERROR;
             }
         }
-        i++;
 
         AK_DeleteAll_L3(&row_root);
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     printf("User '%s' under ID %d is removed from all groups!\n", user, user_id);
     AK_EPI;
@@ -754,7 +745,6 @@ int AK_remove_all_users_from_group(char *group) {
     AK_Init_L3(&row_root);
 
     int group_id = AK_group_get_id(group);
-    int i = 0;
     int result;
 
     if (group_id == EXIT_ERROR) {
@@ -765,22 +755,23 @@ int AK_remove_all_users_from_group(char *group) {
 
     struct list_node *row;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_group");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *group = AK_GetNth_L2(2, row);
         if (group_id == (int) *group->data) {
             AK_Update_Existing_Element(TYPE_INT, &group_id, "AK_user_group", "group_id", row_root);
             result = AK_delete_row(row_root);
         }
-        i++;
         if (result == EXIT_ERROR) {
             printf("Group '%s' under ID %d doesn't contain any users!", group, group_id);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return EXIT_ERROR;
         }
 
         AK_DeleteAll_L3(&row_root);
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     AK_free(row_root);
     printf("Users deleted from group '%s' under ID %d!\n", group, group_id);
@@ -788,6 +779,29 @@ int AK_remove_all_users_from_group(char *group) {
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Function that collects the groups the given user belongs to, in one pass over AK_user_group
+ * @param user_id ID of the user
+ * @param groups array of at least AK_MAX_USER_GROUPS elements for group IDs
+ * @return number of groups
+ */
+static int AK_user_get_groups(int user_id, int groups[]) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_group");
+    struct list_node *row;
+    int number_of_groups = 0;
+
+    while ((row = AK_table_cursor_next(cursor)) != NULL && number_of_groups < AK_MAX_USER_GROUPS) {
+        struct list_node *user = AK_GetNth_L2(1, row);
+        if (user_id == (int) * user->data) {
+            struct list_node *group = AK_GetNth_L2(2, row);
+            groups[number_of_groups] = (int) * group->data;
+            number_of_groups++;
+        }
+    }
+    AK_table_cursor_close(cursor);
+    return number_of_groups;
+}
+
 /**
  * @author Kristina Takač, updated by Marko Flajšek
  * @brief Function that checks whether the given user has a right for the given operation on the given table
@@ -803,7 +817,7 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
     int i = 0;
     int number_of_groups = 0;
     int has_right = 0;
-    int groups[100];
+    int groups[AK_MAX_USER_GROUPS];
 
     if (table_id == EXIT_ERROR || user_id == EXIT_ERROR) {
         printf("Invalid table name or username!\n");
@@ -812,12 +826,14 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
     }
 
     struct list_node *row;
+    AK_table_cursor *cursor;
 
     if (strcmp(privilege, "ALL") == 0) {
 
         int checking_privileges[4] = {0, 0, 0, 0};
         char found_privilege[10];
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+        cursor = AK_table_cursor_open("AK_user_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
 
             struct list_node *username_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
@@ -834,9 +850,8 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
                 if (strcmp(found_privilege, "SELECT") == 0)
                     checking_privileges[3] = 1;
             }
-            i++;
-            AK_free(row);
         }
+        AK_table_cursor_close(cursor);
         for (i = 0; i < 4; i++) {
             if (checking_privileges[i] == 1) {
                 has_right = 1;
@@ -851,61 +866,49 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
             return EXIT_SUCCESS;
         }
 
-        i = 0;
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
-            while ((row = (AK_list *) AK_get_row(i, "AK_user_group")) != NULL) {
-                struct list_node *user = AK_GetNth_L2(1, row);
-                if (user_id == (int) * user->data) {
-                    struct list_node *group = AK_GetNth_L2(2, row);
-                    groups[number_of_groups] = (int) * group->data;
-                    number_of_groups++;
-                }
-                i++;
-                AK_free(row);
-            }
-            // set "flags" to 0
-            checking_privileges[0] = 0;
-            checking_privileges[1] = 0;
-            checking_privileges[2] = 0;
-            checking_privileges[3] = 0;
+        number_of_groups = AK_user_get_groups(user_id, groups);
+        // set "flags" to 0
+        checking_privileges[0] = 0;
+        checking_privileges[1] = 0;
+        checking_privileges[2] = 0;
+        checking_privileges[3] = 0;
+        cursor = AK_table_cursor_open("AK_group_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
+            struct list_node *group_elem = AK_GetNth_L2(2, row);
+            struct list_node *table_elem = AK_GetNth_L2(3, row);
+            struct list_node *privilege_elem = AK_GetNth_L2(4, row);
+
             for (i = 0; i < number_of_groups; i++) {
-                int j = 0;
-                while ((row = (AK_list *) AK_get_row(j, "AK_group_right")) != NULL) {
-                    struct list_node *group_elem = AK_GetNth_L2(2, row);
-                    struct list_node *table_elem = AK_GetNth_L2(3, row);
-                    struct list_node *privilege_elem = AK_GetNth_L2(4, row);
-
-                    if ((groups[i] == (int) * group_elem->data) && (table_id == (int) * table_elem->data)) {
-                        strcpy(found_privilege, privilege_elem->data);
-                        if (strcmp(found_privilege, "UPDATE") == 0)
-                            checking_privileges[0] = 1;
-                        if (strcmp(found_privilege, "DELETE") == 0)
-                            checking_privileges[1] = 1;
-                        if (strcmp(found_privilege, "INSERT") == 0)
-                            checking_privileges[2] = 1;
-                        if (strcmp(found_privilege, "SELECT") == 0)
-                            checking_privileges[3] = 1;
-                    }
-                    j++;
-                    AK_free(row);
+                if ((groups[i] == (int) * group_elem->data) && (table_id == (int) * table_elem->data)) {
+                    strcpy(found_privilege, privilege_elem->data);
+                    if (strcmp(found_privilege, "UPDATE") == 0)
+                        checking_privileges[0] = 1;
+                    if (strcmp(found_privilege, "DELETE") == 0)
+                        checking_privileges[1] = 1;
+                    if (strcmp(found_privilege, "INSERT") == 0)
+                        checking_privileges[2] = 1;
+                    if (strcmp(found_privilege, "SELECT") == 0)
+                        checking_privileges[3] = 1;
                 }
             }
-            for (i = 0; i < 4; i++) {
-                if (checking_privileges[i] == 1) {
-                    has_right = 1;
-                } else {
-                    has_right = 0;
-                    break;
-                }
-            }
-            if (has_right == 1) {
-                printf("User '%s' under ID %d has all privileges in the '%s' table under ID %d!", username, user_id, table, table_id);
-                AK_EPI;
-                return EXIT_SUCCESS;
+        }
+        AK_table_cursor_close(cursor);
+        for (i = 0; i < 4; i++) {
+            if (checking_privileges[i] == 1) {
+                has_right = 1;
+            } else {
+                has_right = 0;
+                break;
             }
         }
+        if (has_right == 1) {
+            printf("User '%s' under ID %d has all privileges in the '%s' table under ID %d!", username, user_id, table, table_id);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
     } else {        
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {           
+        cursor = AK_table_cursor_open("AK_user_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
             struct list_node *username_elem = AK_GetNth_L2(2, row);
             struct list_node *table_elem = AK_GetNth_L2(3, row);
             struct list_node *privilege_elem = AK_GetNth_L2(4, row);                
@@ -914,41 +917,29 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
 
                 has_right = 1;
                 printf("User '%s' under ID %d has the right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);                
+                AK_table_cursor_close(cursor);
                 AK_EPI;
                 return EXIT_SUCCESS;
             }
-            i++;
-            AK_free(row);
         }
-        i = 0;
-        while ((row = (struct list_node *) AK_get_row(i, "AK_user_group")) != NULL) {
-            struct list_node *user = AK_GetNth_L2(1, row);
-
-            if (user_id == (int) * user->data) {
-                struct list_node *group = AK_GetNth_L2(2, row);
-                groups[number_of_groups] = (int) * group->data;
-                number_of_groups++;
-            }
-            i++;
-            AK_free(row);
-        }
-        for (i = 0; i < number_of_groups; i++) {
-            int j = 0;
-
-            while ((row = (struct list_node *) AK_get_row(j, "AK_group_right")) != NULL) {
-                struct list_node *groups_elem = AK_GetNth_L2(2, row);
-                struct list_node *table_elem = AK_GetNth_L2(3, row);
-                struct list_node *privilege_elem = AK_GetNth_L2(4, row);
+        AK_table_cursor_close(cursor);
+        number_of_groups = AK_user_get_groups(user_id, groups);
+        cursor = AK_table_cursor_open("AK_group_right");
+        while ((row = AK_table_cursor_next(cursor)) != NULL) {
+            struct list_node *groups_elem = AK_GetNth_L2(2, row);
+            struct list_node *table_elem = AK_GetNth_L2(3, row);
+            struct list_node *privilege_elem = AK_GetNth_L2(4, row);
+            for (i = 0; i < number_of_groups; i++) {
                 if ((groups[i] == (int) * groups_elem->data) && (table_id == (int) * table_elem->data) && (strcmp(privilege_elem->data, privilege) == 0)) {
                     has_right = 1;
                     printf("User '%s' under ID %d has the right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);
+                    AK_table_cursor_close(cursor);
                     AK_EPI;
                     return EXIT_SUCCESS;
                 }
-                j++;
-                AK_free(row);
             }
         }
+        AK_table_cursor_close(cursor);
     }
 
     printf("User '%s' under ID %d has no right to %s data in the '%s' table under ID %d!", username, user_id, privilege, table, table_id);
@@ -965,7 +956,6 @@ int AK_check_privilege(char *username, char *table, char *privilege) {
 int AK_check_user_privilege(char *user) {
     AK_PRO;
     int user_id = AK_user_get_id(user);
-    int i = 0;
 
     if (user_id == EXIT_ERROR) {
         printf("Invalid username!\n");
@@ -976,30 +966,31 @@ int AK_check_user_privilege(char *user) {
     struct list_node *row;
     int privilege = 0;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_user_right")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_user_right");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *user_elem = AK_GetNth_L2(2, row);
         if ((int) *user_elem->data == user_id) {
             privilege = 1;
             printf("User '%s' under ID %d has some privileges!", user, user_id);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        i++;
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
-    int j = 0;
-    while ((row = (struct list_node *) AK_get_row(j, "AK_user_group")) != NULL) {
+    cursor = AK_table_cursor_open("AK_user_group");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *user_elem = AK_GetNth_L2(1, row);
         if ((int) *user_elem->data == user_id) {
             privilege = 1;
             printf("User '%s' under ID %d belongs to some group!", user, user_id);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        j++;
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     if (privilege == 0) {
         printf("User '%s' under ID %d hasn't got any privileges!", user, user_id);
@@ -1020,7 +1011,6 @@ int AK_check_user_privilege(char *user) {
 int AK_check_group_privilege(char *group) {
     AK_PRO;
     int group_id = AK_group_get_id(group);
-    int i = 0;
 
     if (group_id == EXIT_ERROR) {
         printf("Invalid group name or username!\n");
@@ -1031,17 +1021,18 @@ int AK_check_group_privilege(char *group) {
     struct list_node *row;
     int privilege = 0;
 
-    while ((row = (struct list_node *) AK_get_row(i, "AK_group_right")) != NULL) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_group_right");
+    while ((row = AK_table_cursor_next(cursor)) != NULL) {
         struct list_node *group_elem = AK_GetNth_L2(2, row);
         if ((int) *group_elem->data == group_id) {
             privilege = 1;
             printf("Group '%s' under ID %d has some privileges!", group, group_id);
+            AK_table_cursor_close(cursor);
             AK_EPI;
             return EXIT_SUCCESS;
         }
-        i++;
-        AK_free(row);
     }
+    AK_table_cursor_close(cursor);
 
     if (privilege == 0) {
         printf("Group '%s' under ID %d hasn't got any privileges!", group, group_id);
@@ -26,6 +26,10 @@
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
 
+/**
+ * @brief Maximum number of groups of a user checked by AK_check_privilege
+ */
+#define AK_MAX_USER_GROUPS 100
 
 /**
  * @author Kristina Takač.
@@ -20,8 +20,9 @@
 #include "../mm/memoman.h"
 
 /**
- * @author Filip Žmuk
- * @brief Function that implements SELECT relational operator
+ * @author Filip Žmuk, updated as a pipelined plan
+ * @brief Function that implements SELECT relational operator. The selection, sort and projection run as one plan of
+ *        operators and the rows stream between them, only the sort keeps its input; no temp tables are made.
  * @param srcTable - original table that is used for selection
  * @param destTable - table that contains the result
  * @param condition - condition for selection
@@ -31,80 +32,29 @@
  */
 int AK_select(char *srcTable, char *destTable, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
 {
-    struct list_node *attribute;
+    AK_iterator *plan;
+    int result;
     AK_PRO;
 
-    //create help table name for selection
-    char selection_table[MAX_ATT_NAME] = "";
-    strcat(selection_table, srcTable);
+    if (condition != NULL)
+        AK_add_to_redolog_select(SELECT, condition, srcTable);
 
-    if(condition != NULL)
-    {
-        strcat(selection_table, "__selection");
-
-        //select required rows
-        if (AK_selection(srcTable, selection_table, condition) != EXIT_SUCCESS)
-        {
-            AK_EPI;
-            return EXIT_ERROR;
-        }
-    }
-
-    // create copy of attributes
-    struct list_node *projectionAttributes = (struct list_node *)AK_malloc(sizeof(struct list_node));
-    AK_Init_L3(&projectionAttributes);
-    for (attribute = AK_First_L2(attributes); attribute; attribute = AK_Next_L2(attribute))
-    {
-        AK_InsertAtEnd_L3(TYPE_ATTRIBS, attribute->data, strlen(attribute->data), projectionAttributes);
-    }
-
-
-    //create help table name for sorting
-    char sorted_table[ MAX_ATT_NAME ] = "";
-    strcat(sorted_table, selection_table);
-    //sort required rows
+    //select required rows, sort them before the projection so they can be ordered by any attribute, then project them
+    plan = AK_selection_iterator(srcTable, condition);
     if (ordering != NULL)
+        plan = AK_sort_iterator(plan, ordering);
+    plan = AK_projection_iterator(plan, attributes);
+    if (plan == NULL)
     {
-        strcat(sorted_table, "__sorted");
-        if (AK_sort_segment(selection_table, sorted_table, ordering) != EXIT_SUCCESS)
-        {
-            AK_DeleteAll_L3(&projectionAttributes);
-            AK_free(projectionAttributes);
-            AK_EPI;
-            return EXIT_ERROR;
-        }
-    }
-
-    //project required rows
-    if (AK_projection(sorted_table, destTable, projectionAttributes, NULL) != EXIT_SUCCESS)
-    {
-        AK_DeleteAll_L3(&projectionAttributes);
-        AK_free(projectionAttributes);
         AK_EPI;
         return EXIT_ERROR;
     }
 
-    // free temp tables
-    if(strcmp(srcTable, selection_table) != 0)
-    {
-        AK_delete_segment(selection_table, SEGMENT_TYPE_TABLE);
-        if(strcmp(selection_table, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
-    }
-    else
-    {
-        if(strcmp(srcTable, sorted_table) != 0)
-        {
-            AK_delete_segment(sorted_table, SEGMENT_TYPE_TABLE);
-        }
-    }
-
-    AK_DeleteAll_L3(&projectionAttributes);
-    AK_free(projectionAttributes);
+    result = AK_iterator_materialize(plan, destTable);
+    AK_iterator_free(plan);
+    AK_dbg_messg(LOW, REL_OP, "AK_select: %d rows written to %s\n", result, destTable);
     AK_EPI;
-    return EXIT_SUCCESS;
+    return (result == EXIT_ERROR) ? EXIT_ERROR : EXIT_SUCCESS;
 }
 
 /**
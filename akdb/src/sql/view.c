@@ -27,13 +27,13 @@
  * @return EXIT_ERROR if the name already exists or name
  */
 char* AK_check_view_name(char *name){
-	int i = 0;
 	char *result;
     
     struct list_node *row;
     AK_PRO;
     
-    while ((row = (struct list_node*)AK_get_row(i++, "AK_view"))) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_view");
+    while ((row = AK_table_cursor_next(cursor))) {
         struct list_node *name_elem = AK_GetNth_L2(2,row);
         if (strcmp(name_elem->data, name) == 0) {
             result = (char*)(EXIT_ERROR);
@@ -43,6 +43,7 @@ char* AK_check_view_name(char *name){
             result = name;
         }
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return result;
 }
@@ -54,18 +55,21 @@ char* AK_check_view_name(char *name){
  * @return View's id or EXIT_ERROR
  */
 int AK_get_view_obj_id(char *name) {
-    int id, i = 0;
+    int id;
     
     struct list_node *row;
     AK_PRO;
-    while ((row = (struct list_node*)AK_get_row(i++, "AK_view"))) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_view");
+    while ((row = AK_table_cursor_next(cursor))) {
         struct list_node *name_elem = AK_GetNth_L2(2,row);
         if (!strcmp(name_elem->data, name)) {
             memcpy(&id, row->next->data, sizeof(int));
+            AK_table_cursor_close(cursor);
 	    AK_EPI;
             return id;
         }
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return EXIT_ERROR;
 }
@@ -77,21 +81,25 @@ int AK_get_view_obj_id(char *name) {
  * @return query string or EXIT_ERROR
  */
 char* AK_get_view_query(char *name){
-   int i = 0;
    char *query;
     
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node*)AK_get_row(i++, "AK_view"))) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_view");
+    while ((row = AK_table_cursor_next(cursor))) {
         struct list_node *name_elem = AK_GetNth_L2(2,row);
         if (!strcmp(name_elem->data, name)) {
             struct list_node *query_elem = AK_GetNth_L2(3,row);
-            query = query_elem->data;
+            // the row belongs to the cursor, so the query is copied
+            query = (char *) AK_malloc(query_elem->size + 1);
+            strcpy(query, query_elem->data);
+            AK_table_cursor_close(cursor);
 	    AK_EPI;
 	    return query;
         }
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return (char*)(EXIT_ERROR);
 }
@@ -103,21 +111,25 @@ char* AK_get_view_query(char *name){
  * @return rel_exp string or EXIT_ERROR
  */
 char* AK_get_rel_exp(char *name){
-   int i = 0;
    char *rel_exp;
    
     struct list_node *row;
     AK_PRO;
 
-    while ((row = (struct list_node*)AK_get_row(i++, "AK_view"))) {
+    AK_table_cursor *cursor = AK_table_cursor_open("AK_view");
+    while ((row = AK_table_cursor_next(cursor))) {
         struct list_node *name_elem = AK_GetNth_L2(2,row);
         if (!strcmp(name_elem->data, name)) {
             struct list_node *rel_exp_elem = AK_GetNth_L2(3,row);
-            rel_exp = rel_exp_elem->data;
+            // the row belongs to the cursor, so the expression is copied
+            rel_exp = (char *) AK_malloc(rel_exp_elem->size + 1);
+            strcpy(rel_exp, rel_exp_elem->data);
+            AK_table_cursor_close(cursor);
 	    AK_EPI;
 	    return rel_exp;
         }
     }
+    AK_table_cursor_close(cursor);
     AK_EPI;
     return (char*)(EXIT_ERROR);
 }
@@ -184,24 +196,25 @@ int AK_view_remove_by_obj_id(int obj_id) {
  * @return error or success
  */
 int AK_view_rename(char *name, char *new_name){
-   int result = 0, i = 0;
+   int result = 0;
    int view_id;
-   char *query;
-   char *rel_exp;
+   char query[MAX_VARCHAR_LENGTH];
+   char *rel_exp = query;
    
    struct list_node *row;
    AK_PRO;
    
-   while ((row = (struct list_node *)AK_get_row(i++, "AK_view"))) {
+   AK_table_cursor *cursor = AK_table_cursor_open("AK_view");
+   while ((row = AK_table_cursor_next(cursor))) {
        struct list_node *name_elem = AK_GetNth_L2(2,row);
         if (!strcmp(name_elem->data, name)) {
             struct list_node *view_elem = AK_GetNth_L2(1,row);
             struct list_node *query_rel_exp_elem = AK_GetNth_L2(3,row);
             memcpy(&view_id, view_elem->data, sizeof(int));
-            query = query_rel_exp_elem->data;
-	    rel_exp = query_rel_exp_elem->data;
+            strcpy(query, query_rel_exp_elem->data);
         }
     }
+    AK_table_cursor_close(cursor);
     if(AK_check_view_name(new_name) == EXIT_ERROR){
         AK_EPI;
         return EXIT_ERROR;
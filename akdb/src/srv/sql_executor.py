@@ -596,6 +596,40 @@ class Insert_into_command:
             return False
         return False
 
+# copy_command
+# defines the structure of the COPY command which bulk loads a CSV file into a table:
+# COPY table FROM 'file.csv' [WITH HEADER] [DELIMITER ';']
+
+
+class Copy_command:
+
+    copy_regex = r"^(?i)copy\s+([a-zA-Z0-9_]+)\s+from\s+'([^']+)'(\s+with\s+header)?(\s+delimiter\s+'(.)')?\s*;?\s*$"
+    pattern = None
+    matcher = None
+
+    # matches method
+    # checks whether given input matches copy command syntax
+    def matches(self, inp):
+        self.pattern = re.compile(self.copy_regex)
+        self.matcher = self.pattern.match(inp)
+        return self.matcher if self.matcher is not None else None
+
+    # execute method
+    # loads the rows of the file with AK_bulk_load_csv and returns the number of loaded rows
+    def execute(self, expr):
+        table_name = str(self.matcher.group(1))
+        file_name = str(self.matcher.group(2))
+        header = 1 if self.matcher.group(3) is not None else 0
+        delimiter = str(self.matcher.group(5)) if self.matcher.group(5) is not None else ","
+        if (ak47.AK_table_exist(table_name) == 0):
+            print "Error: table '" + table_name + "' does not exist"
+            return False
+        loaded = ak47.AK_bulk_load_csv(table_name, file_name, delimiter, header)
+        if loaded == ak47.EXIT_ERROR:
+            print "Error: cannot load file '" + file_name + "' into table '" + table_name + "'"
+            return False
+        return "COPY " + str(loaded)
+
 #
 '''
 ## create group command
@@ -1075,6 +1109,7 @@ class sql_executor:
     create_index_command = Create_index_command()
     create_trigger_command = Create_trigger_command()
     insert_into_command = Insert_into_command()
+    copy_command = Copy_command()
     #create_group_command = Create_group_command()
     grant_command = Grant_command()
     select_command = Select_command()
@@ -1083,7 +1118,7 @@ class sql_executor:
 
     # add command instances to the commands array
     commands = [print_command, table_details_command, table_exists_command, create_sequence_command, create_table_command,
-                create_index_command, create_trigger_command, insert_into_command, grant_command, select_command, update_command, drop_command, print_system_table_command]
+                create_index_command, create_trigger_command, insert_into_command, copy_command, grant_command, select_command, update_command, drop_command, print_system_table_command]
 
     # commands for input
     # checks whether received command matches any of the defined commands for kalashnikovdb,
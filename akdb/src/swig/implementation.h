@@ -26,6 +26,7 @@
 #include "../file/id.c"
 #include "../file/fileio.c"
 #include "../file/filesort.c"
+#include "../file/bulk_load.c"
 #include "../file/sequence.c"
 #include "../file/idx/index.c"
 #include "../file/idx/btree.c"
@@ -47,10 +48,14 @@
 #include "../sql/privileges.c"
 #include "../sql/function.c"
 #include "../dm/dbman.c"
+#include "../dm/page.c"
 #include "../rel/union.c"
 #include "../rel/aggregation.c"
 #include "../rel/product.c"
 #include "../rel/expression_check.c"
+#include "../rel/hash_join.c"
+#include "../rel/merge_join.c"
+#include "../rel/set_op.c"
 #include "../rel/nat_join.c"
 #include "../rel/theta_join.c"
 #include "../rel/selection.c"
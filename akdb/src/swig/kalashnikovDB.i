@@ -260,6 +260,8 @@ Everything in the %{ ... %} block is simply copied verbatim to the resulting wra
 
 %include "../dm/dbman.h"
 %include "../dm/dbman.c"
+%include "../dm/page.h"
+%include "../dm/page.c"
 extern table_addresses *AK_get_segment_addresses(char * segmentName);
 
 
@@ -292,6 +294,8 @@ extern void AK_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 %include "../file/filesearch.h"
 %include "../file/fileio.c"
 %include "../file/fileio.h"
+%include "../file/bulk_load.c"
+%include "../file/bulk_load.h"
 %include "../file/files.c"
 %include "../file/files.h"
 
@@ -314,6 +318,14 @@ extern void AK_Insert_NewelementAd(int addBlock, int indexTd, char *attName, ele
 %include "../rel/projection.c"
 %include "../rel/projection.h"
 
+%include "../rel/hash_join.c"
+%include "../rel/hash_join.h"
+%include "../rel/merge_join.c"
+%include "../rel/merge_join.h"
+%include "../rel/iterator.c"
+%include "../rel/iterator.h"
+%include "../rel/set_op.c"
+%include "../rel/set_op.h"
 %include "../rel/nat_join.c"
 %include "../rel/nat_join.h"
 %include "../rel/intersect.c"